@@ -22,6 +22,34 @@
 #include "vtkPoints.h"
 #include "vtkDataSet.h"
 #include "vtkMath.h"
+#include "vtkSMPTools.h"
+
+namespace
+{
+// Fills a cell bounds array in parallel. vtkDataSet::GetCellBounds() is
+// thread safe once it has been called from a single thread, which the
+// caller is responsible for.
+class vtkCellBoundsFunctor
+{
+public:
+  vtkDataSet *DataSet;
+  double (*Bounds)[6];
+
+  vtkCellBoundsFunctor(vtkDataSet *ds, double (*bounds)[6]) :
+    DataSet(ds), Bounds(bounds)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType cellId=begin; cellId<end; cellId++)
+      {
+      this->DataSet->GetCellBounds(cellId, this->Bounds[cellId]);
+      }
+  }
+};
+}
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 vtkAbstractCellLocator::vtkAbstractCellLocator()
@@ -49,11 +77,21 @@ bool vtkAbstractCellLocator::StoreCellBounds()
   // Allocate space for cell bounds storage, then fill
   vtkIdType numCells = this->DataSet->GetNumberOfCells();
   this->CellBounds = new double [numCells][6];
-  for (vtkIdType j=0; j<numCells; j++)
+  this->ComputeCellBounds(this->CellBounds);
+  return true;
+}
+//----------------------------------------------------------------------------
+void vtkAbstractCellLocator::ComputeCellBounds(double (*bounds)[6])
+{
+  vtkIdType numCells = this->DataSet->GetNumberOfCells();
+  if (numCells < 1)
     {
-    this->DataSet->GetCellBounds(j, CellBounds[j]);
+    return;
     }
-  return true;
+  // The first call builds any lazily constructed cell structures of the
+  // dataset (e.g. vtkPolyData::BuildCells()), so it must be serial.
+  this->DataSet->GetCellBounds(0, bounds[0]);
+  vtkSMPTools::For(1, numCells, vtkCellBoundsFunctor(this->DataSet, bounds));
 }
 //----------------------------------------------------------------------------
 void vtkAbstractCellLocator::FreeCellBounds()
@@ -112,6 +112,9 @@ public:
   // Description:
   // Return intersection point (if any) AND the cell which was intersected by
   // the finite line. The cell is returned as a cell id and as a generic cell.
+  // As for FindCell(), vtkCellLocator and vtkCellTreeLocator only use the
+  // supplied cell as scratch space once built, so this signature may be
+  // called concurrently with one cell per thread.
   virtual int IntersectWithLine(
     double p1[3], double p2[3], double tol, double& t, double x[3],
     double pcoords[3], int &subId, vtkIdType &cellId, vtkGenericCell *cell);
@@ -230,6 +233,10 @@ public:
   // Find the cell containing a given point. returns -1 if no cell found
   // the cell parameters are copied into the supplied variables, a cell must
   // be provided to store the information.
+  // Once the locator has been built, locators implementing this method
+  // (vtkCellLocator, vtkCellTreeLocator) only use the supplied cell and
+  // weights as scratch space, so it may be called concurrently from several
+  // threads as long as each thread provides its own cell and weights.
   virtual vtkIdType FindCell(
     double x[3], double tol2, vtkGenericCell *GenCell,
     double pcoords[3], double *weights);
@@ -253,6 +260,13 @@ protected:
   virtual bool StoreCellBounds();
   virtual void FreeCellBounds();
 
+//BTX
+  // Description:
+  // Compute the bounds of every cell of the dataset into the supplied
+  // array (which must hold NumberOfCells entries) using vtkSMPTools.
+  void ComputeCellBounds(double (*bounds)[6]);
+//ETX
+
   int NumberOfCellsPerNode;
   int RetainCellLists;
   int CacheCellBounds;
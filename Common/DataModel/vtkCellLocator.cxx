@@ -20,8 +20,12 @@
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
 #include "vtkBox.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 
 #include <math.h>
+#include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkCellLocator);
 
@@ -56,6 +60,85 @@ inline int vtkNeighborCells::InsertNextPoint(int *x)
   return id/3;
 }
 
+//----------------------------------------------------------------------------
+// Computes, for a range of cells, the (i,j,k) range of leaf octants that
+// the bounding box of each cell overlaps. Used to bin cells in parallel
+// while building the locator.
+namespace
+{
+class vtkCellLocatorBinCells
+{
+public:
+  const double (*CellBounds)[6];
+  int (*Octants)[6];
+  const double *Bounds;
+  const double *H;
+  double HTol[3];
+  int NumberOfDivisions;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for (vtkIdType cellId=begin; cellId<end; cellId++)
+      {
+      const double *boundsPtr = this->CellBounds[cellId];
+      int *ijkMin = this->Octants[cellId];
+      int *ijkMax = ijkMin + 3;
+      for (int i=0; i<3; i++)
+        {
+        ijkMin[i] = static_cast<int>(
+          (boundsPtr[2*i] - this->Bounds[2*i] - this->HTol[i])/ this->H[i]);
+        ijkMax[i] = static_cast<int>(
+          (boundsPtr[2*i+1] - this->Bounds[2*i] + this->HTol[i]) / this->H[i]);
+
+        if (ijkMin[i] < 0)
+          {
+          ijkMin[i] = 0;
+          }
+        if (ijkMax[i] >= this->NumberOfDivisions)
+          {
+          ijkMax[i] = this->NumberOfDivisions-1;
+          }
+        }
+      }
+  }
+};
+}
+
+//----------------------------------------------------------------------------
+// The cells visited by the current line query of a thread. Like
+// CellHasBeenVisited, the marks are only cleared when the query number
+// rolls over.
+class vtkCellLocatorQueryMarks
+{
+public:
+  vtkCellLocatorQueryMarks() : QueryNumber(0) {}
+
+  unsigned char NewQuery(vtkIdType numCells)
+  {
+    if (static_cast<vtkIdType>(this->Visited.size()) != numCells)
+      {
+      this->Visited.assign(numCells, 0);
+      this->QueryNumber = 0;
+      }
+    this->QueryNumber++;
+    if (this->QueryNumber == 0)
+      {
+      std::fill(this->Visited.begin(), this->Visited.end(), 0);
+      this->QueryNumber++;    // can't use 0 as a marker
+      }
+    return this->QueryNumber;
+  }
+
+  std::vector<unsigned char> Visited;
+  unsigned char QueryNumber;
+};
+
+class vtkCellLocatorVisitedCells
+{
+public:
+  vtkSMPThreadLocal<vtkCellLocatorQueryMarks> Marks;
+};
+
 //----------------------------------------------------------------------------
 // Construct with automatic computation of divisions, averaging
 // 25 cells per bucket.
@@ -67,6 +150,7 @@ vtkCellLocator::vtkCellLocator()
   this->Tree                 = NULL;
   this->CellHasBeenVisited   = NULL;
   this->QueryNumber          = 0;
+  this->VisitedCells         = NULL;
   this->NumberOfDivisions    = 1;
   this->H[0] = this->H[1] = this->H[2] = 1.0;
 
@@ -91,6 +175,8 @@ vtkCellLocator::~vtkCellLocator()
 
   delete [] this->CellHasBeenVisited;
   this->CellHasBeenVisited = NULL;
+  delete this->VisitedCells;
+  this->VisitedCells = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -148,6 +234,15 @@ void vtkCellLocator::ComputeOctantBounds(int i, int j, int k)
   this->OctantBounds[5] = this->OctantBounds[4] + H[2];
 }
 
+//----------------------------------------------------------------------------
+static bool vtkCellLocator_InsideWithTolerance(const double bounds[6],
+                                               const double x[3], double tol)
+{
+  return ( bounds[0]-tol <= x[0] && x[0] <= bounds[1]+tol &&
+           bounds[2]-tol <= x[1] && x[1] <= bounds[3]+tol &&
+           bounds[4]-tol <= x[2] && x[2] <= bounds[5]+tol );
+}
+
 //----------------------------------------------------------------------------
 // Return intersection point (if any) AND the cell which was intersected by
 // finite line
@@ -174,8 +269,20 @@ int vtkCellLocator::IntersectWithLine(double a0[3], double a1[3], double tol,
   double stopDist, currDist;
   double deltaT, pDistance, minPDistance=1.0e38;
   double length, maxLength=0.0;
+  double octantBounds[6];
 
   this->BuildLocatorIfNeeded();
+  if (!this->VisitedCells)
+    {
+    return 0;
+    }
+
+  // The cells already tested are marked in storage local to the calling
+  // thread, so that concurrent queries of a built locator do not interfere.
+  vtkCellLocatorQueryMarks &marks = this->VisitedCells->Marks.Local();
+  unsigned char queryNumber =
+    marks.NewQuery(this->DataSet->GetNumberOfCells());
+  unsigned char *visited = &marks.Visited[0];
 
   // convert the line into i,j,k coordinates
   tMax = 0.0;
@@ -213,16 +320,6 @@ int vtkCellLocator::IntersectWithLine(double a0[3], double a1[3], double tol,
     leafStart = this->NumberOfOctants - this->NumberOfDivisions*prod;
     bestCellId = -1;
 
-    // Clear the array that indicates whether we have visited this cell.
-    // The array is only cleared when the query number rolls over.  This
-    // saves a number of calls to memset.
-    this->QueryNumber++;
-    if (this->QueryNumber == 0)
-      {
-      this->ClearCellHasBeenVisited();
-      this->QueryNumber++;    // can't use 0 as a marker
-      }
-
     // set up curr and stop dist
     currDist = 0;
     for (i = 0; i < 3; i++)
@@ -255,14 +352,18 @@ int vtkCellLocator::IntersectWithLine(double a0[3], double a1[3], double tol,
       {
       if (this->Tree[idx])
         {
-        this->ComputeOctantBounds(pos[0]-1,pos[1]-1,pos[2]-1);
+        for (i=0; i < 3; i++)
+          {
+          octantBounds[2*i] = this->Bounds[2*i] + (pos[i]-1)*this->H[i];
+          octantBounds[2*i+1] = octantBounds[2*i] + this->H[i];
+          }
         for (tMax = VTK_DOUBLE_MAX, cellId=0;
         cellId < this->Tree[idx]->GetNumberOfIds(); cellId++)
           {
           cId = this->Tree[idx]->GetId(cellId);
-          if (this->CellHasBeenVisited[cId] != this->QueryNumber)
+          if (visited[cId] != queryNumber)
             {
-            this->CellHasBeenVisited[cId] = this->QueryNumber;
+            visited[cId] = queryNumber;
             int hitCellBounds = 0;
 
             // check whether we intersect the cell bounds
@@ -287,9 +388,9 @@ int vtkCellLocator::IntersectWithLine(double a0[3], double a1[3], double tol,
               this->DataSet->GetCell(cId, cell);
               if (cell->IntersectWithLine(a0, a1, tol, t, x, pcoords, subId) )
                 {
-                if ( ! this->IsInOctantBounds(x, tol) )
+                if ( ! vtkCellLocator_InsideWithTolerance(octantBounds, x, tol) )
                   {
-                  this->CellHasBeenVisited[cId] = 0; //mark the cell non-visited
+                  visited[cId] = 0; //mark the cell non-visited
                   }
                 else
                   {
@@ -307,7 +408,7 @@ int vtkCellLocator::IntersectWithLine(double a0[3], double a1[3], double tol,
                   } //if within current parametric range
                 } // if intersection
               } // if (hitCellBounds)
-            } // if (!this->CellHasBeenVisited[cId])
+            } // if (cell not yet visited)
           }
         }
 
@@ -322,7 +423,9 @@ int vtkCellLocator::IntersectWithLine(double a0[3], double a1[3], double tol,
           dist[loop] = (1.0 - hitPosition[loop] + pos[loop])/direction3[loop];
           if (dist[loop] == 0)
             {
-            dist[loop] = 1.0/direction3[loop];
+            // the line passed through an edge or a corner of the octant,
+            // so it enters the neighbor along this axis right away
+            dist[loop] = 0.01/direction3[loop];
             }
           if (dist[loop] < 0)
             {
@@ -1198,16 +1301,15 @@ void vtkCellLocator::ForceBuildLocator()
 //
 void vtkCellLocator::BuildLocatorInternal()
 {
-  double *bounds, length, cellBounds[6], *boundsPtr;
+  double *bounds, length;
   vtkIdType numCells;
   int ndivs, product;
-  int i, j, k, ijkMin[3], ijkMax[3];
+  int i, j, k, *ijkMin, *ijkMax;
   vtkIdType cellId, idx;
   int parentOffset;
   vtkIdList *octant;
   int numCellsPerBucket = this->NumberOfCellsPerNode;
   int prod, numOctants;
-  double hTol[3];
 
   vtkDebugMacro( << "Subdividing octree..." );
 
@@ -1268,54 +1370,57 @@ void vtkCellLocator::BuildLocatorInternal()
   this->CellHasBeenVisited = new unsigned char [ numCells ];
   this->ClearCellHasBeenVisited();
   this->QueryNumber = 0;
+  delete this->VisitedCells;
+  this->VisitedCells = new vtkCellLocatorVisitedCells;
 
+  //  The cell bounds are computed in parallel. They are kept around only
+  //  when CacheCellBounds is on.
+  //
+  double (*cellBounds)[6];
   if (this->CacheCellBounds)
     {
     this->StoreCellBounds();
+    cellBounds = this->CellBounds;
+    }
+  else
+    {
+    cellBounds = new double [numCells][6];
+    this->ComputeCellBounds(cellBounds);
     }
 
   //  Compute width of leaf octant in three directions
   //
+  vtkCellLocatorBinCells binner;
   for (i=0; i<3; i++)
     {
     this->H[i] = (this->Bounds[2*i+1] - this->Bounds[2*i]) / ndivs;
-    hTol[i] = this->H[i]/100.0;
+    binner.HTol[i] = this->H[i]/100.0;
+    }
+
+  //  Find the range of leaf octants overlapped by each cell, in parallel.
+  //
+  int (*cellOctants)[6] = new int [numCells][6];
+  binner.CellBounds = cellBounds;
+  binner.Octants = cellOctants;
+  binner.Bounds = this->Bounds;
+  binner.H = this->H;
+  binner.NumberOfDivisions = ndivs;
+  vtkSMPTools::For(0, numCells, binner);
+
+  if (cellBounds != this->CellBounds)
+    {
+    delete [] cellBounds;
     }
 
-  //  Insert each cell into the appropriate octant.  Make sure cell
-  //  falls within octant.
+  //  Insert each cell into the appropriate octant. This is done serially
+  //  so that the cell lists are ordered by increasing cell id.
   //
   parentOffset = numOctants - (ndivs * ndivs * ndivs);
   product = ndivs * ndivs;
-  boundsPtr = cellBounds;
   for (cellId=0; cellId<numCells; cellId++)
     {
-    if (this->CellBounds)
-      {
-      boundsPtr = this->CellBounds[cellId];
-      }
-    else
-      {
-      this->DataSet->GetCellBounds(cellId, cellBounds);
-      }
-
-    // find min/max locations of bounding box
-    for (i=0; i<3; i++)
-      {
-      ijkMin[i] = static_cast<int>(
-        (boundsPtr[2*i] - this->Bounds[2*i] - hTol[i])/ this->H[i]);
-      ijkMax[i] = static_cast<int>(
-        (boundsPtr[2*i+1] - this->Bounds[2*i] + hTol[i]) / this->H[i]);
-
-      if (ijkMin[i] < 0)
-        {
-        ijkMin[i] = 0;
-        }
-      if (ijkMax[i] >= ndivs)
-        {
-        ijkMax[i] = ndivs-1;
-        }
-      }
+    ijkMin = cellOctants[cellId];
+    ijkMax = ijkMin + 3;
 
     // each octant between min/max point may have cell in it
     for ( k = ijkMin[2]; k <= ijkMax[2]; k++ )
@@ -1341,6 +1446,8 @@ void vtkCellLocator::BuildLocatorInternal()
 
     } //for all cells
 
+  delete [] cellOctants;
+
   this->BuildTime.Modified();
 }
 
@@ -1945,7 +2052,9 @@ void vtkCellLocator::FindCellsAlongLine(double p1[3], double p2[3], double vtkNo
           dist[loop] = (1.0 - hitPosition[loop] + pos[loop])/direction3[loop];
           if (dist[loop] == 0)
             {
-            dist[loop] = 1.0/direction3[loop];
+            // the line passed through an edge or a corner of the octant,
+            // so it enters the neighbor along this axis right away
+            dist[loop] = 0.01/direction3[loop];
             }
           if (dist[loop] < 0)
             {
@@ -39,6 +39,7 @@
 #include "vtkAbstractCellLocator.h"
 
 class vtkNeighborCells;
+class vtkCellLocatorVisitedCells;
 
 class VTKCOMMONDATAMODEL_EXPORT vtkCellLocator : public vtkAbstractCellLocator
 {
@@ -256,6 +257,7 @@ protected:
   vtkNeighborCells *Buckets;
   unsigned char *CellHasBeenVisited;
   unsigned char QueryNumber;
+  vtkCellLocatorVisitedCells *VisitedCells; // per-thread marks for queries
 
   void ComputeOctantBounds(int i, int j, int k);
   double OctantBounds[6]; //the bounds of the current octant
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkThreadedImageAlgorithm.h"
 
+#include "vtkAtomicInt.h"
 #include "vtkCellData.h"
 #include "vtkCommand.h"
 #include "vtkDataArray.h"
@@ -23,14 +24,24 @@
 #include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+bool vtkThreadedImageAlgorithm::GlobalDefaultEnableSMP = false;
 
 //----------------------------------------------------------------------------
 vtkThreadedImageAlgorithm::vtkThreadedImageAlgorithm()
 {
   this->Threader = vtkMultiThreader::New();
   this->NumberOfThreads = this->Threader->GetNumberOfThreads();
+
+  this->EnableSMP = vtkThreadedImageAlgorithm::GlobalDefaultEnableSMP;
+  this->SplitMode = SLAB;
+  this->DesiredBytesPerPiece = 65536;
+  this->MinimumPieceSize[0] = 16;
+  this->MinimumPieceSize[1] = 1;
+  this->MinimumPieceSize[2] = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -45,6 +56,26 @@ void vtkThreadedImageAlgorithm::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "EnableSMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+  os << indent << "SplitMode: "
+     << (this->SplitMode == SLAB ? "Slab\n" :
+         (this->SplitMode == BEAM ? "Beam\n" : "Block\n"));
+  os << indent << "DesiredBytesPerPiece: "
+     << this->DesiredBytesPerPiece << "\n";
+  os << indent << "MinimumPieceSize: " << this->MinimumPieceSize[0] << " "
+     << this->MinimumPieceSize[1] << " " << this->MinimumPieceSize[2] << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedImageAlgorithm::SetGlobalDefaultEnableSMP(bool enable)
+{
+  vtkThreadedImageAlgorithm::GlobalDefaultEnableSMP = enable;
+}
+
+//----------------------------------------------------------------------------
+bool vtkThreadedImageAlgorithm::GetGlobalDefaultEnableSMP()
+{
+  return vtkThreadedImageAlgorithm::GlobalDefaultEnableSMP;
 }
 
 struct vtkImageThreadStruct
@@ -76,6 +107,11 @@ int vtkThreadedImageAlgorithm::SplitExtent(int splitExt[6],
                 << startExt[4] << ", " << startExt[5] << "), "
                 << num << " of " << total);
 
+  if (this->EnableSMP)
+    {
+    return this->SplitExtentSMP(splitExt, startExt, num, total);
+    }
+
   // start with same extent
   memcpy(splitExt, startExt, 6 * sizeof(int));
 
@@ -121,22 +157,12 @@ int vtkThreadedImageAlgorithm::SplitExtent(int splitExt[6],
 }
 
 
-// this mess is really a simple function. All it does is call
-// the ThreadedExecute method after setting the correct
-// extent for this thread. Its just a pain to calculate
-// the correct extent.
-static VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
+// Get the extent to split among the threads: the update extent of the
+// output port the request came from or, for the filters without output,
+// the update extent of the first connected input. Return 0 if there is none.
+static int vtkThreadedImageAlgorithmGetExtent(vtkImageThreadStruct *str,
+                                              int ext[6])
 {
-  vtkImageThreadStruct *str;
-  int ext[6], splitExt[6], total;
-  int threadId, threadCount;
-
-  threadId = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->ThreadID;
-  threadCount = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->NumberOfThreads;
-
-  str = static_cast<vtkImageThreadStruct *>
-    (static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
-
   // if we have an output
   if (str->Filter->GetNumberOfOutputPorts())
     {
@@ -148,39 +174,50 @@ static VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *ar
     // update directly, for now an error
     if (outputPort == -1)
       {
-      return VTK_THREAD_RETURN_VALUE;
+      return 0;
       }
 
     // get the update extent from the output port
     vtkInformation *outInfo =
       str->OutputsInfo->GetInformationObject(outputPort);
-    int updateExtent[6];
-    outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(),
-                 updateExtent);
-    memcpy(ext,updateExtent, sizeof(int)*6);
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), ext);
+    return 1;
     }
-  else
+
+  // if there is no output, then use UE from input, use the first input
+  for (int inPort = 0; inPort < str->Filter->GetNumberOfInputPorts(); ++inPort)
     {
-    // if there is no output, then use UE from input, use the first input
-    int inPort;
-    for (inPort = 0; inPort < str->Filter->GetNumberOfInputPorts(); ++inPort)
-      {
-      if (str->Filter->GetNumberOfInputConnections(inPort))
-        {
-        int updateExtent[6];
-        str->InputsInfo[inPort]
-          ->GetInformationObject(0)
-          ->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(),
-                updateExtent);
-        memcpy(ext,updateExtent, sizeof(int)*6);
-        break;
-        }
-      }
-    if (inPort >= str->Filter->GetNumberOfInputPorts())
+    if (str->Filter->GetNumberOfInputConnections(inPort))
       {
-      return VTK_THREAD_RETURN_VALUE;
+      str->InputsInfo[inPort]
+        ->GetInformationObject(0)
+        ->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), ext);
+      return 1;
       }
     }
+  return 0;
+}
+
+// this mess is really a simple function. All it does is call
+// the ThreadedExecute method after setting the correct
+// extent for this thread. Its just a pain to calculate
+// the correct extent.
+static VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
+{
+  vtkImageThreadStruct *str;
+  int ext[6], splitExt[6], total;
+  int threadId, threadCount;
+
+  threadId = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->ThreadID;
+  threadCount = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->NumberOfThreads;
+
+  str = static_cast<vtkImageThreadStruct *>
+    (static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
+
+  if (!vtkThreadedImageAlgorithmGetExtent(str, ext))
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
 
   // execute the actual method with appropriate extent
   // first find out how many pieces extent can be split into.
@@ -210,6 +247,195 @@ static VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *ar
   return VTK_THREAD_RETURN_VALUE;
 }
 
+//----------------------------------------------------------------------------
+// Functor for the SMP execution: ThreadedRequestData is called on each
+// piece of the range, the pieces being given by the (possibly overridden)
+// SplitExtent method. The threadId is the index of the SMP thread, given
+// out in the order in which the threads get their first piece.
+class vtkThreadedImageAlgorithmFunctor
+{
+public:
+  vtkImageThreadStruct *Str;
+  int Extent[6];
+  int Total;
+  vtkSMPThreadLocal<int> *ThreadIds;
+  vtkAtomicInt<vtkTypeInt32> *NumberOfThreadIds;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    int &threadId = this->ThreadIds->Local();
+    if (threadId < 0)
+      {
+      threadId = ++(*this->NumberOfThreadIds) - 1;
+      }
+    for (vtkIdType piece = begin; piece < end; ++piece)
+      {
+      int splitExt[6];
+      this->Str->Filter->SplitExtent(
+        splitExt, const_cast<int *>(this->Extent), static_cast<int>(piece),
+        this->Total);
+      if (splitExt[1] < splitExt[0] ||
+          splitExt[3] < splitExt[2] ||
+          splitExt[5] < splitExt[4])
+        {
+        continue;
+        }
+      this->Str->Filter->ThreadedRequestData(
+        this->Str->Request, this->Str->InputsInfo, this->Str->OutputsInfo,
+        this->Str->Inputs, this->Str->Outputs, splitExt, threadId);
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Find how many times the extent must be split along the axes allowed by
+// splitMode to get at least the given number of pieces, without making
+// them smaller than minSize samples, dividing the largest pieces first.
+static void vtkThreadedImageAlgorithmSplitPieces(
+  const int extent[6], int splitMode, const int minSize[3],
+  int numberOfPieces, int pieces[3])
+{
+  vtkIdType size[3];
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    size[axis] = extent[2*axis+1] - extent[2*axis] + 1;
+    pieces[axis] = 1;
+    }
+
+  bool allowed[3] = { true, true, true };
+  if (splitMode == vtkThreadedImageAlgorithm::BEAM)
+    {
+    allowed[0] = false;
+    }
+  else if (splitMode == vtkThreadedImageAlgorithm::SLAB)
+    {
+    // only the slowest varying axis that can be split
+    int slabAxis = 2;
+    while (slabAxis > 0 && size[slabAxis] <= 1)
+      {
+      --slabAxis;
+      }
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      allowed[axis] = (axis == slabAxis);
+      }
+    }
+
+  vtkIdType count = 1;
+  while (count < numberOfPieces)
+    {
+    // split the axis along which the pieces are the largest
+    int splitAxis = -1;
+    double largest = 0;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      int minimum = (minSize[axis] > 1 ? minSize[axis] : 1);
+      double pieceSize = static_cast<double>(size[axis])/pieces[axis];
+      if (allowed[axis] && size[axis]/(pieces[axis] + 1) >= minimum &&
+          pieceSize > largest)
+        {
+        splitAxis = axis;
+        largest = pieceSize;
+        }
+      }
+    if (splitAxis < 0)
+      {
+      break;
+      }
+    count = count/pieces[splitAxis]*(pieces[splitAxis] + 1);
+    pieces[splitAxis]++;
+    }
+}
+
+//----------------------------------------------------------------------------
+// When EnableSMP is on, the extent is split according to SplitMode and
+// MinimumPieceSize into at most "total" pieces, numbered along x first.
+int vtkThreadedImageAlgorithm::SplitExtentSMP(int splitExt[6],
+                                             const int startExt[6],
+                                             int num, int total)
+{
+  int pieces[3];
+  vtkThreadedImageAlgorithmSplitPieces(
+    startExt, this->SplitMode, this->MinimumPieceSize, total, pieces);
+
+  int index = num;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    int n = pieces[axis];
+    int i = index % n;
+    index /= n;
+    vtkIdType size = startExt[2*axis+1] - startExt[2*axis] + 1;
+    splitExt[2*axis] = startExt[2*axis] + static_cast<int>(size*i/n);
+    splitExt[2*axis+1] = startExt[2*axis] +
+      static_cast<int>(size*(i + 1)/n) - 1;
+    }
+
+  return pieces[0]*pieces[1]*pieces[2];
+}
+
+//----------------------------------------------------------------------------
+// Execute ThreadedRequestData on many small pieces with vtkSMPTools. The
+// pieces are processed in groups, so that the progress can be reported and
+// the execution aborted from the calling thread between the groups.
+static void vtkThreadedImageAlgorithmSMPExecute(
+  vtkThreadedImageAlgorithm *self, vtkImageThreadStruct *str)
+{
+  vtkThreadedImageAlgorithmFunctor functor;
+  functor.Str = str;
+  int *ext = functor.Extent;
+  if (!vtkThreadedImageAlgorithmGetExtent(str, ext) ||
+      ext[1] < ext[0] || ext[3] < ext[2] || ext[5] < ext[4])
+    {
+    return;
+    }
+
+  // the size of the samples of the data being split
+  vtkImageData *data = 0;
+  if (str->Outputs)
+    {
+    data = str->Outputs[0];
+    }
+  else if (str->Inputs && str->Inputs[0])
+    {
+    data = str->Inputs[0][0];
+    }
+  int bytesPerSample = 1;
+  if (data && data->GetPointData()->GetScalars())
+    {
+    bytesPerSample = data->GetScalarSize()*data->GetNumberOfScalarComponents();
+    }
+
+  // the number of pieces of at most DesiredBytesPerPiece bytes
+  double bytes = static_cast<double>(bytesPerSample)*
+    (ext[1] - ext[0] + 1)*(ext[3] - ext[2] + 1)*(ext[5] - ext[4] + 1);
+  double maxBytes = static_cast<double>(self->GetDesiredBytesPerPiece());
+  double total = ceil(bytes/(maxBytes > 1 ? maxBytes : 1));
+  functor.Total = static_cast<int>(total < VTK_INT_MAX ? total : VTK_INT_MAX);
+
+  // the pieces that can actually be made, given by the subclass
+  int splitExt[6];
+  vtkIdType numberOfPieces = self->SplitExtent(splitExt, ext, 0, functor.Total);
+
+  vtkSMPThreadLocal<int> threadIds(-1);
+  vtkAtomicInt<vtkTypeInt32> numberOfThreadIds(0);
+  functor.ThreadIds = &threadIds;
+  functor.NumberOfThreadIds = &numberOfThreadIds;
+
+  vtkIdType groupSize = numberOfPieces/20 + 1;
+  vtkIdType minGroupSize = 4*self->GetNumberOfThreads();
+  groupSize = (groupSize > minGroupSize ? groupSize : minGroupSize);
+  for (vtkIdType begin = 0; begin < numberOfPieces; begin += groupSize)
+    {
+    if (self->GetAbortExecute())
+      {
+      break;
+      }
+    vtkIdType end = begin + groupSize;
+    end = (end < numberOfPieces ? end : numberOfPieces);
+    vtkSMPTools::For(begin, end, functor);
+    self->UpdateProgress(static_cast<double>(end)/numberOfPieces);
+    }
+}
 
 //----------------------------------------------------------------------------
 // This is the superclasses style of Execute method.  Convert it into
@@ -283,13 +509,20 @@ int vtkThreadedImageAlgorithm::RequestData(
     this->CopyAttributeData(str.Inputs[0][0],str.Outputs[0],inputVector);
     }
 
-  this->Threader->SetNumberOfThreads(this->NumberOfThreads);
-  this->Threader->SetSingleMethod(vtkThreadedImageAlgorithmThreadedExecute, &str);
-
   // always shut off debugging to avoid threading problems with GetMacros
   int debug = this->Debug;
   this->Debug = 0;
-  this->Threader->SingleMethodExecute();
+  if (this->EnableSMP)
+    {
+    vtkThreadedImageAlgorithmSMPExecute(this, &str);
+    }
+  else
+    {
+    this->Threader->SetNumberOfThreads(this->NumberOfThreads);
+    this->Threader->SetSingleMethod(
+      vtkThreadedImageAlgorithmThreadedExecute, &str);
+    this->Threader->SingleMethodExecute();
+    }
   this->Debug = debug;
 
   // free up the arrays
@@ -19,6 +19,12 @@
 // into smaller extents so that the vtkImageData limits are observed. It
 // also provides support for multithreading. If you don't need any of this
 // functionality, consider using vtkSimpleImageToImageAlgorithm instead.
+//
+// By default the update extent is split into one piece per thread, and the
+// pieces are executed by a vtkMultiThreader. When EnableSMP is on, it is
+// instead split into many small pieces (slabs, beams or blocks of about
+// DesiredBytesPerPiece bytes) that are scheduled with vtkSMPTools, which
+// balances the load better and reuses the threads of the SMP backend.
 // .SECTION See also
 // vtkSimpleImageToImageAlgorithm
 
@@ -59,8 +65,61 @@ public:
   vtkSetClampMacro( NumberOfThreads, int, 1, VTK_MAX_THREADS );
   vtkGetMacro( NumberOfThreads, int );
 
+  // Description:
+  // Enable or disable the SMP execution. When it is on, the update extent
+  // is split by SplitExtent into pieces of about DesiredBytesPerPiece bytes,
+  // and ThreadedRequestData is called concurrently through vtkSMPTools once
+  // per piece. The threadId is then the index of the SMP thread that
+  // executes the piece, which is less than the number of threads of the
+  // SMP backend but may exceed NumberOfThreads, so subclasses that
+  // accumulate results in storage sized by NumberOfThreads must keep it
+  // off. The progress is reported between groups of pieces. The initial
+  // value is the global default, which is off.
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+
+  // Description:
+  // Set the default value of EnableSMP for the filters created afterwards.
+  static void SetGlobalDefaultEnableSMP(bool enable);
+  static bool GetGlobalDefaultEnableSMP();
+
+  //BTX
+  enum SplitModeEnum
+  {
+    SLAB = 0,
+    BEAM = 1,
+    BLOCK = 2
+  };
+  //ETX
+
+  // Description:
+  // Set the shape of the pieces in the SMP execution: slabs are split
+  // along the slowest varying axis only (and are contiguous in memory),
+  // beams are made of whole rows, blocks are split along all three axes.
+  // The default is SLAB.
+  vtkSetClampMacro(SplitMode, int, SLAB, BLOCK);
+  vtkGetMacro(SplitMode, int);
+  void SetSplitModeToSlab() { this->SetSplitMode(SLAB); }
+  void SetSplitModeToBeam() { this->SetSplitMode(BEAM); }
+  void SetSplitModeToBlock() { this->SetSplitMode(BLOCK); }
+
+  // Description:
+  // The size of the pieces in the SMP execution: the extent is split until
+  // the pieces of the first output (or of the first input, for the filters
+  // without output) hold at most DesiredBytesPerPiece bytes, without making
+  // them smaller than MinimumPieceSize along any axis. The defaults are
+  // 65536 bytes and 16x1x1.
+  vtkSetMacro(DesiredBytesPerPiece, vtkIdType);
+  vtkGetMacro(DesiredBytesPerPiece, vtkIdType);
+  vtkSetVector3Macro(MinimumPieceSize, int);
+  vtkGetVector3Macro(MinimumPieceSize, int);
+
   // Description:
   // Putting this here until I merge graphics and imaging streaming.
+  // With EnableSMP on, this is called for every piece of the SMP execution,
+  // and the default implementation splits the extent according to
+  // SplitMode and MinimumPieceSize rather than along one axis.
   virtual int SplitExtent(int splitExt[6], int startExt[6],
                           int num, int total);
 
@@ -71,6 +130,16 @@ protected:
   vtkMultiThreader *Threader;
   int NumberOfThreads;
 
+  bool EnableSMP;
+  int SplitMode;
+  vtkIdType DesiredBytesPerPiece;
+  int MinimumPieceSize[3];
+
+  // Description:
+  // The split done by SplitExtent when EnableSMP is on.
+  int SplitExtentSMP(int splitExt[6], const int startExt[6],
+                     int num, int total);
+
   // Description:
   // This is called by the superclass.
   // This is the method you should override.
@@ -79,6 +148,8 @@ protected:
                           vtkInformationVector* outputVector);
 
 private:
+  static bool GlobalDefaultEnableSMP;
+
   vtkThreadedImageAlgorithm(const vtkThreadedImageAlgorithm&);  // Not implemented.
   void operator=(const vtkThreadedImageAlgorithm&);  // Not implemented.
 };
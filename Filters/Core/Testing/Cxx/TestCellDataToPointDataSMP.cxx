@@ -0,0 +1,289 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellDataToPointDataSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks vtkCellDataToPointData and vtkPointDataToCellData against
+// averages computed from the point cells and the cell points, for double
+// and integer arrays, on a polydata and an unstructured grid (whose cells
+// are walked without links) and on an image (whose point cells are
+// gathered). Bit arrays, and the string arrays of the image and of the
+// polydata, are interpolated too.
+
+#include "vtkBitArray.h"
+#include "vtkCellData.h"
+#include "vtkCellDataToPointData.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPointDataToCellData.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkStringArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <vector>
+
+namespace
+{
+void AddArrays(vtkDataSetAttributes* data, vtkIdType numTuples)
+{
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(numTuples);
+  vtkNew<vtkIntArray> ints;
+  ints->SetName("Ints");
+  ints->SetNumberOfTuples(numTuples);
+  for (vtkIdType i = 0; i < numTuples; i++)
+    {
+    vectors->SetTuple3(i, vtkMath::Random(-1.0, 1.0),
+                       vtkMath::Random(-1.0, 1.0), vtkMath::Random(0.0, 5.0));
+    ints->SetValue(i, static_cast<int>(vtkMath::Random(-100.0, 100.0)));
+    }
+  data->AddArray(vectors.GetPointer());
+  data->AddArray(ints.GetPointer());
+}
+
+// The average of the given tuples of an array, as the filters compute it:
+// by summing and dividing when walking the cells, with weights otherwise.
+double Average(vtkDataArray* array, vtkIdList* ids, int comp, bool walk)
+{
+  vtkIdType n = ids->GetNumberOfIds();
+  double sum = 0.0;
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    double value = array->GetComponent(ids->GetId(i), comp);
+    sum += walk ? value : (1.0 / n) * value;
+    }
+  if (walk && n > 0)
+    {
+    sum /= n;
+    }
+  if (array->GetDataType() == VTK_INT)
+    {
+    sum = static_cast<int>(sum >= 0.0 ? sum + 0.5 : sum - 0.5);
+    }
+  return sum;
+}
+
+bool CheckArray(vtkDataArray* result, vtkDataArray* source, vtkDataSet* input,
+                bool toPoints, bool walk, const char* name)
+{
+  vtkIdType numTuples =
+    toPoints ? input->GetNumberOfPoints() : input->GetNumberOfCells();
+  if (!result || result->GetNumberOfTuples() != numTuples ||
+      result->GetNumberOfComponents() != source->GetNumberOfComponents() ||
+      result->GetDataType() != source->GetDataType())
+    {
+    cerr << name << ": missing " << source->GetName() << endl;
+    return false;
+    }
+  vtkNew<vtkIdList> ids;
+  for (vtkIdType i = 0; i < numTuples; i++)
+    {
+    if (toPoints)
+      {
+      input->GetPointCells(i, ids.GetPointer());
+      }
+    else
+      {
+      input->GetCellPoints(i, ids.GetPointer());
+      }
+    for (int c = 0; c < source->GetNumberOfComponents(); c++)
+      {
+      double expected = Average(source, ids.GetPointer(), c, walk);
+      if (fabs(result->GetComponent(i, c) - expected) >
+          1e-12 * (1.0 + fabs(expected)))
+        {
+        cerr << name << ": wrong " << source->GetName() << " "
+             << result->GetComponent(i, c) << " instead of " << expected
+             << " for tuple " << i << endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+int TestDataSet(vtkDataSet* input, bool walk, const char* name)
+{
+  AddArrays(input->GetCellData(), input->GetNumberOfCells());
+  AddArrays(input->GetPointData(), input->GetNumberOfPoints());
+
+  vtkNew<vtkCellDataToPointData> c2p;
+  c2p->SetInputData(input);
+  c2p->Update();
+  vtkPointData* points = c2p->GetOutput()->GetPointData();
+  vtkCellData* cells = input->GetCellData();
+  if (!CheckArray(points->GetArray("Vectors"), cells->GetArray("Vectors"),
+                  input, true, walk, name) ||
+      !CheckArray(points->GetArray("Ints"), cells->GetArray("Ints"),
+                  input, true, walk, name))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // the cell data is averaged with weights
+  vtkNew<vtkPointDataToCellData> p2c;
+  p2c->SetInputData(input);
+  p2c->Update();
+  cells = p2c->GetOutput()->GetCellData();
+  points = input->GetPointData();
+  if (!CheckArray(cells->GetArray("Vectors"), points->GetArray("Vectors"),
+                  input, false, false, name) ||
+      !CheckArray(cells->GetArray("Ints"), points->GetArray("Ints"),
+                  input, false, false, name))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+// Bit arrays are interpolated by vtkBitArray::InterpolateTuple().
+int TestBits(vtkDataSet* input, bool toPoints, const char* name)
+{
+  vtkIdType numSource =
+    toPoints ? input->GetNumberOfCells() : input->GetNumberOfPoints();
+  vtkNew<vtkBitArray> bits;
+  bits->SetName("Bits");
+  bits->SetNumberOfTuples(numSource);
+  for (vtkIdType i = 0; i < numSource; i++)
+    {
+    bits->SetValue(i, 1);
+    }
+  vtkDataArray* result;
+  vtkNew<vtkCellDataToPointData> c2p;
+  vtkNew<vtkPointDataToCellData> p2c;
+  if (toPoints)
+    {
+    input->GetCellData()->AddArray(bits.GetPointer());
+    c2p->SetInputData(input);
+    c2p->Update();
+    result = c2p->GetOutput()->GetPointData()->GetArray("Bits");
+    input->GetCellData()->RemoveArray("Bits");
+    }
+  else
+    {
+    input->GetPointData()->AddArray(bits.GetPointer());
+    p2c->SetInputData(input);
+    p2c->Update();
+    result = p2c->GetOutput()->GetCellData()->GetArray("Bits");
+    input->GetPointData()->RemoveArray("Bits");
+    }
+  vtkIdType numTuples =
+    toPoints ? input->GetNumberOfPoints() : input->GetNumberOfCells();
+  if (!vtkBitArray::SafeDownCast(result) ||
+      result->GetNumberOfTuples() != numTuples)
+    {
+    cerr << name << ": bits were not interpolated" << endl;
+    return EXIT_FAILURE;
+    }
+  vtkNew<vtkIdList> ids;
+  vtkNew<vtkBitArray> expected;
+  expected->SetNumberOfTuples(1);
+  std::vector<double> weights;
+  for (vtkIdType i = 0; i < numTuples; i++)
+    {
+    if (toPoints)
+      {
+      input->GetPointCells(i, ids.GetPointer());
+      }
+    else
+      {
+      input->GetCellPoints(i, ids.GetPointer());
+      }
+    weights.assign(ids->GetNumberOfIds(), 1.0 / ids->GetNumberOfIds());
+    expected->InterpolateTuple(0, ids.GetPointer(), bits.GetPointer(),
+                               &weights[0]);
+    if (result->GetComponent(i, 0) != expected->GetComponent(0, 0))
+      {
+      cerr << name << ": wrong bit for tuple " << i << endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+int TestStrings(vtkDataSet* input, const char* name)
+{
+  vtkNew<vtkStringArray> strings;
+  strings->SetName("Strings");
+  strings->SetNumberOfValues(input->GetNumberOfCells());
+  for (vtkIdType i = 0; i < input->GetNumberOfCells(); i++)
+    {
+    strings->SetValue(i, "cell");
+    }
+  input->GetCellData()->AddArray(strings.GetPointer());
+  vtkNew<vtkCellDataToPointData> c2p;
+  c2p->SetInputData(input);
+  c2p->Update();
+  vtkStringArray* pointStrings = vtkStringArray::SafeDownCast(
+    c2p->GetOutput()->GetPointData()->GetAbstractArray("Strings"));
+  if (!pointStrings ||
+      pointStrings->GetNumberOfValues() != input->GetNumberOfPoints() ||
+      pointStrings->GetValue(input->GetNumberOfPoints() - 1) != "cell")
+    {
+    cerr << name << ": strings were not interpolated" << endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int TestCellDataToPointDataSMP(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  vtkMath::RandomSeed(1234);
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(40);
+  sphere->SetPhiResolution(30);
+  sphere->Update();
+  vtkNew<vtkPolyData> polyData;
+  polyData->DeepCopy(sphere->GetOutput());
+  if (TestDataSet(polyData.GetPointer(), true, "PolyData") != EXIT_SUCCESS ||
+      TestBits(polyData.GetPointer(), true, "PolyData") != EXIT_SUCCESS ||
+      TestBits(polyData.GetPointer(), false, "PolyData") != EXIT_SUCCESS ||
+      TestStrings(polyData.GetPointer(), "PolyData") != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(12, 10, 8);
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputData(image.GetPointer());
+  tetrahedra->Update();
+  vtkNew<vtkUnstructuredGrid> grid;
+  grid->DeepCopy(tetrahedra->GetOutput());
+  if (TestDataSet(grid.GetPointer(), true, "UnstructuredGrid") !=
+      EXIT_SUCCESS ||
+      TestBits(grid.GetPointer(), true, "UnstructuredGrid") != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  if (TestDataSet(image.GetPointer(), false, "Image") != EXIT_SUCCESS ||
+      TestBits(image.GetPointer(), true, "Image") != EXIT_SUCCESS ||
+      TestBits(image.GetPointer(), false, "Image") != EXIT_SUCCESS ||
+      TestStrings(image.GetPointer(), "Image") != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
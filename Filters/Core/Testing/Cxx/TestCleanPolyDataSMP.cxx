@@ -0,0 +1,246 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCleanPolyDataSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkCleanPolyData gives the same output when coincident points
+// are found by sorting (exact merging, the default) as when they are found
+// with a vtkPointLocator, for verts, lines, polys and strips that degenerate
+// when their points are merged. Also checks that points with NaN
+// coordinates are kept apart while the other points are merged.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCleanPolyData.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPointLocator.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace
+{
+bool CompareArrays(vtkDataArray* a1, vtkDataArray* a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return false;
+    }
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int j = 0; j < a1->GetNumberOfComponents(); j++)
+      {
+      if (a1->GetComponent(i, j) != a2->GetComponent(i, j))
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+bool CompareCells(vtkCellArray* c1, vtkCellArray* c2)
+{
+  vtkIdType n1 = c1 ? c1->GetNumberOfCells() : 0;
+  vtkIdType n2 = c2 ? c2->GetNumberOfCells() : 0;
+  if (n1 != n2)
+    {
+    return false;
+    }
+  if (n1 == 0)
+    {
+    return true;
+    }
+  return c1->GetNumberOfConnectivityEntries() ==
+    c2->GetNumberOfConnectivityEntries() &&
+    std::equal(c1->GetPointer(),
+               c1->GetPointer() + c1->GetNumberOfConnectivityEntries(),
+               c2->GetPointer());
+}
+
+int CompareOutputs(vtkPolyData* input, int convert, const char* mode)
+{
+  vtkNew<vtkCleanPolyData> sorted;
+  sorted->SetInputData(input);
+  sorted->SetConvertLinesToPoints(convert);
+  sorted->SetConvertPolysToLines(convert);
+  sorted->SetConvertStripsToPolys(convert);
+  sorted->Update();
+
+  vtkNew<vtkPointLocator> locator;
+  vtkNew<vtkCleanPolyData> located;
+  located->SetInputData(input);
+  located->SetLocator(locator.GetPointer());
+  located->SetConvertLinesToPoints(convert);
+  located->SetConvertPolysToLines(convert);
+  located->SetConvertStripsToPolys(convert);
+  located->Update();
+
+  vtkPolyData* o1 = sorted->GetOutput();
+  vtkPolyData* o2 = located->GetOutput();
+  if (o1->GetNumberOfPoints() == 0 ||
+      o1->GetNumberOfPoints() >= input->GetNumberOfPoints() ||
+      o1->GetNumberOfPoints() != o2->GetNumberOfPoints() ||
+      !CompareArrays(o1->GetPoints()->GetData(), o2->GetPoints()->GetData()))
+    {
+    cerr << mode << ": points differ" << endl;
+    return EXIT_FAILURE;
+    }
+  if (!CompareCells(o1->GetVerts(), o2->GetVerts()) ||
+      !CompareCells(o1->GetLines(), o2->GetLines()) ||
+      !CompareCells(o1->GetPolys(), o2->GetPolys()) ||
+      !CompareCells(o1->GetStrips(), o2->GetStrips()))
+    {
+    cerr << mode << ": cells differ" << endl;
+    return EXIT_FAILURE;
+    }
+  if (!CompareArrays(o1->GetPointData()->GetArray("PointIds"),
+                     o2->GetPointData()->GetArray("PointIds")) ||
+      !CompareArrays(o1->GetCellData()->GetArray("CellIds"),
+                     o2->GetCellData()->GetArray("CellIds")))
+    {
+    cerr << mode << ": attributes differ" << endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+void InsertCells(vtkCellArray* cells, vtkIdTypeArray* cellIds, int numCells,
+                 int minSize, vtkIdType numPts)
+{
+  vtkIdType pts[8];
+  for (int i = 0; i < numCells; i++)
+    {
+    int npts = minSize + i % 4;
+    for (int j = 0; j < npts; j++)
+      {
+      // repeat points, and use few points for some cells, so that cells
+      // degenerate
+      if (i % 5 == 0 && j > 0)
+        {
+        pts[j] = pts[j-1];
+        }
+      else
+        {
+        pts[j] = static_cast<vtkIdType>(
+          vtkMath::Random(0.0, i % 3 == 0 ? 20.0 : numPts - 1.0));
+        }
+      }
+    cells->InsertNextCell(npts, pts);
+    cellIds->InsertNextValue(cellIds->GetNumberOfTuples());
+    }
+}
+
+int CheckNaN()
+{
+  // every tenth point has a NaN coordinate, the others are on a grid
+  const vtkIdType numPts = 20000;
+  const double nan = vtkMath::Nan();
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  vtkNew<vtkCellArray> verts;
+  std::set<std::vector<double> > distinct;
+  vtkIdType numNaN = 0;
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    std::vector<double> x(3);
+    for (int j = 0; j < 3; j++)
+      {
+      x[j] = floor(vtkMath::Random(0.0, 10.0));
+      }
+    if (i % 10 == 0)
+      {
+      x[i % 3] = nan;
+      numNaN++;
+      }
+    else
+      {
+      distinct.insert(x);
+      }
+    points->InsertNextPoint(x[0], x[1], x[2]);
+    verts->InsertNextCell(1, &i);
+    }
+
+  vtkNew<vtkPolyData> input;
+  input->SetPoints(points.GetPointer());
+  input->SetVerts(verts.GetPointer());
+  vtkNew<vtkCleanPolyData> clean;
+  clean->SetInputData(input.GetPointer());
+  clean->Update();
+
+  vtkIdType expected = static_cast<vtkIdType>(distinct.size()) + numNaN;
+  if (clean->GetOutput()->GetNumberOfPoints() != expected)
+    {
+    cerr << "NaN: " << clean->GetOutput()->GetNumberOfPoints()
+         << " points instead of " << expected << endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int TestCleanPolyDataSMP(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  // Points on a coarse grid, so that many of them coincide. There are
+  // enough of them to be sorted in several chunks.
+  const vtkIdType numPts = 150000;
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  vtkNew<vtkDoubleArray> pointIds;
+  pointIds->SetName("PointIds");
+  vtkMath::RandomSeed(4321);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    points->InsertNextPoint(floor(vtkMath::Random(0.0, 40.0)),
+                            floor(vtkMath::Random(0.0, 40.0)),
+                            floor(vtkMath::Random(0.0, 40.0)));
+    pointIds->InsertNextValue(i);
+    }
+
+  vtkNew<vtkIdTypeArray> cellIds;
+  cellIds->SetName("CellIds");
+  vtkNew<vtkCellArray> verts;
+  InsertCells(verts.GetPointer(), cellIds.GetPointer(), 2000, 1, numPts);
+  vtkNew<vtkCellArray> lines;
+  InsertCells(lines.GetPointer(), cellIds.GetPointer(), 5000, 2, numPts);
+  vtkNew<vtkCellArray> polys;
+  InsertCells(polys.GetPointer(), cellIds.GetPointer(), 10000, 3, numPts);
+  vtkNew<vtkCellArray> strips;
+  InsertCells(strips.GetPointer(), cellIds.GetPointer(), 5000, 3, numPts);
+
+  vtkNew<vtkPolyData> input;
+  input->SetPoints(points.GetPointer());
+  input->SetVerts(verts.GetPointer());
+  input->SetLines(lines.GetPointer());
+  input->SetPolys(polys.GetPointer());
+  input->SetStrips(strips.GetPointer());
+  input->GetPointData()->AddArray(pointIds.GetPointer());
+  input->GetCellData()->AddArray(cellIds.GetPointer());
+
+  if (CompareOutputs(input.GetPointer(), 1, "Convert") != EXIT_SUCCESS ||
+      CompareOutputs(input.GetPointer(), 0, "NoConvert") != EXIT_SUCCESS ||
+      CheckNaN() != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
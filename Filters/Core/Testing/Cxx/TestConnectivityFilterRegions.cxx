@@ -0,0 +1,232 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestConnectivityFilterRegions.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the regions found by vtkConnectivityFilter and
+// vtkPolyDataConnectivityFilter in three spheres, the first two of which
+// are joined by a line, in all the extraction modes, with and without
+// scalar connectivity.
+
+#include "vtkAppendPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkConnectivityFilter.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataConnectivityFilter.h"
+#include "vtkSphereSource.h"
+#include "vtkUnstructuredGrid.h"
+
+namespace
+{
+bool Check(const char* name, const char* what, vtkIdType value,
+           vtkIdType expected)
+{
+  if (value != expected)
+    {
+    cerr << name << ": " << what << " " << value << " instead of "
+         << expected << endl;
+    return false;
+    }
+  return true;
+}
+
+// The point region ids of all the regions, expected to be 0 for the first
+// two spheres and 1 for the last one.
+bool CheckPointRegions(const char* name, vtkPointSet* output)
+{
+  vtkDataArray* regionIds = output->GetPointData()->GetArray("RegionId");
+  if (!regionIds)
+    {
+    cerr << name << ": no RegionId array" << endl;
+    return false;
+    }
+  for (vtkIdType i = 0; i < output->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    output->GetPoint(i, x);
+    if (regionIds->GetComponent(i, 0) != (x[0] > 4.5 ? 1 : 0))
+      {
+      cerr << name << ": wrong region id for point " << i << endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template <class TFilter>
+bool TestFilter(const char* name, vtkPolyData* input, const vtkIdType n[3])
+{
+  vtkNew<TFilter> connectivity;
+  connectivity->SetInputData(input);
+  connectivity->ColorRegionsOn();
+
+  // The line and the first two spheres, then the last sphere. All the
+  // points are used, and keep their order.
+  connectivity->SetExtractionModeToAllRegions();
+  connectivity->Update();
+  vtkPointSet* output = connectivity->GetOutput();
+  if (!Check(name, "regions", connectivity->GetNumberOfExtractedRegions(), 2) ||
+      !Check(name, "cells", output->GetNumberOfCells(), 1 + n[0] + n[1] + n[2]) ||
+      !Check(name, "points", output->GetNumberOfPoints(),
+             input->GetNumberOfPoints()) ||
+      !CheckPointRegions(name, output))
+    {
+    return false;
+    }
+  for (vtkIdType i = 0; i < input->GetNumberOfPoints(); i++)
+    {
+    double x[3], y[3];
+    input->GetPoint(i, x);
+    output->GetPoint(i, y);
+    if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2])
+      {
+      cerr << name << ": point " << i << " moved" << endl;
+      return false;
+      }
+    }
+
+  connectivity->SetExtractionModeToLargestRegion();
+  connectivity->Update();
+  if (!Check(name, "largest region cells", output->GetNumberOfCells(),
+             1 + n[0] + n[1]))
+    {
+    return false;
+    }
+
+  connectivity->SetExtractionModeToSpecifiedRegions();
+  connectivity->InitializeSpecifiedRegionList();
+  connectivity->AddSpecifiedRegion(1);
+  connectivity->Update();
+  if (!Check(name, "specified region cells", output->GetNumberOfCells(), n[2]))
+    {
+    return false;
+    }
+
+  // The seeds are the last cell, and the middle point (on the second sphere).
+  connectivity->SetExtractionModeToCellSeededRegions();
+  connectivity->InitializeSeedList();
+  connectivity->AddSeed(input->GetNumberOfCells() - 1);
+  connectivity->Update();
+  if (!Check(name, "cell seeded cells", output->GetNumberOfCells(), n[2]))
+    {
+    return false;
+    }
+  connectivity->SetExtractionModeToPointSeededRegions();
+  connectivity->InitializeSeedList();
+  connectivity->AddSeed(input->GetNumberOfPoints() / 2);
+  connectivity->Update();
+  if (!Check(name, "point seeded cells", output->GetNumberOfCells(),
+             1 + n[0] + n[1]))
+    {
+    return false;
+    }
+  connectivity->SetExtractionModeToClosestPointRegion();
+  connectivity->SetClosestPoint(7.0, 0.0, 0.0);
+  connectivity->Update();
+  if (!Check(name, "closest point cells", output->GetNumberOfCells(), n[2]))
+    {
+    return false;
+    }
+
+  // With the x coordinate as scalars, the cells of the last two spheres
+  // are not connected: each is a region of its own, and the line only
+  // joins the first sphere.
+  connectivity->ScalarConnectivityOn();
+  connectivity->SetScalarRange(-1.0, 1.8);
+  connectivity->SetExtractionModeToAllRegions();
+  connectivity->Update();
+  if (!Check(name, "scalar regions", connectivity->GetNumberOfExtractedRegions(),
+             1 + n[1] + n[2]))
+    {
+    return false;
+    }
+  connectivity->SetExtractionModeToLargestRegion();
+  connectivity->Update();
+  if (!Check(name, "scalar largest region cells", output->GetNumberOfCells(),
+             1 + n[0]))
+    {
+    return false;
+    }
+  connectivity->SetExtractionModeToCellSeededRegions();
+  connectivity->InitializeSeedList();
+  connectivity->AddSeed(0);
+  connectivity->AddSeed(input->GetNumberOfCells() - 1);
+  connectivity->Update();
+  if (!Check(name, "scalar cell seeded cells", output->GetNumberOfCells(),
+             2 + n[0]))
+    {
+    return false;
+    }
+
+  return true;
+}
+}
+
+int TestConnectivityFilterRegions(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  const int resolutions[3][2] = { { 8, 6 }, { 16, 10 }, { 10, 8 } };
+  vtkNew<vtkAppendPolyData> append;
+  vtkIdType n[3];
+  vtkIdType firstPoint[3];
+  vtkIdType numPts = 0;
+  for (int i = 0; i < 3; i++)
+    {
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetCenter(3.0 * i, 0.0, 0.0);
+    sphere->SetThetaResolution(resolutions[i][0]);
+    sphere->SetPhiResolution(resolutions[i][1]);
+    sphere->Update();
+    n[i] = sphere->GetOutput()->GetNumberOfCells();
+    firstPoint[i] = numPts;
+    numPts += sphere->GetOutput()->GetNumberOfPoints();
+    append->AddInputConnection(sphere->GetOutputPort());
+    }
+  append->Update();
+
+  // Join the first two spheres by a line (the first cell), and use the x
+  // coordinates as scalars.
+  vtkNew<vtkPolyData> input;
+  input->DeepCopy(append->GetOutput());
+  vtkNew<vtkCellArray> lines;
+  vtkIdType line[2] = { firstPoint[0], firstPoint[1] };
+  lines->InsertNextCell(2, line);
+  input->SetLines(lines.GetPointer());
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetNumberOfTuples(input->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < input->GetNumberOfPoints(); i++)
+    {
+    scalars->SetValue(i, input->GetPoint(i)[0]);
+    }
+  input->GetPointData()->SetScalars(scalars.GetPointer());
+
+  if (input->GetNumberOfPoints() / 2 < firstPoint[1] ||
+      input->GetNumberOfPoints() / 2 >= firstPoint[2])
+    {
+    cerr << "The middle point is not on the second sphere" << endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!TestFilter<vtkConnectivityFilter>("vtkConnectivityFilter",
+                                         input.GetPointer(), n) ||
+      !TestFilter<vtkPolyDataConnectivityFilter>(
+        "vtkPolyDataConnectivityFilter", input.GetPointer(), n))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDelaunaySpatialSort.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkSpatialSort orders random points so that consecutive
+// points are close, and that vtkDelaunay2D and vtkDelaunay3D give the same
+// triangulation of random points (which is unique) when inserting them in
+// this order as in the input order.
+
+#include "vtkDelaunay2D.h"
+#include "vtkDelaunay3D.h"
+#include "vtkIdList.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSpatialSort.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace
+{
+// The cells of a dataset, as sorted point ids.
+std::set<std::vector<vtkIdType> > GetCells(vtkDataSet* dataSet)
+{
+  std::set<std::vector<vtkIdType> > cells;
+  vtkNew<vtkIdList> ptIds;
+  for (vtkIdType i = 0; i < dataSet->GetNumberOfCells(); i++)
+    {
+    dataSet->GetCellPoints(i, ptIds.GetPointer());
+    std::vector<vtkIdType> cell(ptIds->GetPointer(0),
+                                ptIds->GetPointer(0) + ptIds->GetNumberOfIds());
+    std::sort(cell.begin(), cell.end());
+    cells.insert(cell);
+    }
+  return cells;
+}
+
+// The length of the path through the points in the given order.
+double PathLength(vtkPoints* points, vtkIdList* order)
+{
+  double length = 0.0, x[3], y[3];
+  for (vtkIdType i = 1; i < order->GetNumberOfIds(); i++)
+    {
+    points->GetPoint(order->GetId(i - 1), x);
+    points->GetPoint(order->GetId(i), y);
+    length += sqrt(vtkMath::Distance2BetweenPoints(x, y));
+    }
+  return length;
+}
+
+bool CheckOrder(vtkPoints* points, vtkIdList* order, const char* name)
+{
+  vtkIdType numPts = points->GetNumberOfPoints();
+  std::vector<bool> found(numPts, false);
+  for (vtkIdType i = 0; i < order->GetNumberOfIds(); i++)
+    {
+    vtkIdType id = order->GetId(i);
+    if (id < 0 || id >= numPts || found[id])
+      {
+      cerr << name << ": not a permutation of the points" << endl;
+      return false;
+      }
+    found[id] = true;
+    }
+  if (order->GetNumberOfIds() != numPts)
+    {
+    cerr << name << ": wrong number of ids" << endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int TestDelaunaySpatialSort(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  vtkMath::RandomSeed(4321);
+  const vtkIdType numPts = 20000;
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    points->SetPoint(i, vtkMath::Random(0.0, 10.0), vtkMath::Random(0.0, 5.0),
+                     vtkMath::Random(0.0, 1.0));
+    }
+
+  // The Hilbert order goes through neighbor points; the BRIO one through
+  // neighbor points in each of its rounds.
+  vtkNew<vtkIdList> inputOrder;
+  inputOrder->SetNumberOfIds(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    inputOrder->SetId(i, i);
+    }
+  vtkNew<vtkIdList> hilbertOrder;
+  vtkSpatialSort::HilbertSort(points.GetPointer(), 2, hilbertOrder.GetPointer());
+  vtkNew<vtkIdList> brioOrder;
+  vtkSpatialSort::BRIOSort(points.GetPointer(), 3, brioOrder.GetPointer());
+  if (!CheckOrder(points.GetPointer(), hilbertOrder.GetPointer(), "Hilbert") ||
+      !CheckOrder(points.GetPointer(), brioOrder.GetPointer(), "BRIO"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A point with a NaN coordinate is still ordered with the others.
+  vtkNew<vtkPoints> nanPoints;
+  nanPoints->DeepCopy(points.GetPointer());
+  nanPoints->SetPoint(17, vtkMath::Nan(), 1.0, vtkMath::Nan());
+  vtkNew<vtkIdList> nanOrder;
+  vtkSpatialSort::BRIOSort(nanPoints.GetPointer(), 3, nanOrder.GetPointer());
+  if (!CheckOrder(nanPoints.GetPointer(), nanOrder.GetPointer(), "NaN"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  double inputLength = PathLength(points.GetPointer(), inputOrder.GetPointer());
+  double hilbertLength =
+    PathLength(points.GetPointer(), hilbertOrder.GetPointer());
+  double brioLength = PathLength(points.GetPointer(), brioOrder.GetPointer());
+  cout << "Path lengths: input " << inputLength << ", Hilbert "
+       << hilbertLength << ", BRIO " << brioLength << endl;
+  if (hilbertLength > 0.1 * inputLength || brioLength > 0.2 * inputLength)
+    {
+    cerr << "The points are not sorted spatially" << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkPolyData> input;
+  input->SetPoints(points.GetPointer());
+  vtkNew<vtkTimerLog> timer;
+
+  vtkNew<vtkDelaunay2D> delaunay2D;
+  delaunay2D->SetInputData(input.GetPointer());
+  timer->StartTimer();
+  delaunay2D->Update();
+  timer->StopTimer();
+  double inputTime = timer->GetElapsedTime();
+  std::set<std::vector<vtkIdType> > expected =
+    GetCells(delaunay2D->GetOutput());
+  delaunay2D->SpatialSortOn();
+  timer->StartTimer();
+  delaunay2D->Update();
+  timer->StopTimer();
+  cout << "vtkDelaunay2D: " << expected.size() << " triangles in "
+       << inputTime << "s, " << timer->GetElapsedTime()
+       << "s with spatial sort" << endl;
+  if (GetCells(delaunay2D->GetOutput()) != expected)
+    {
+    cerr << "vtkDelaunay2D: different triangles with spatial sort" << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkPoints> points3D;
+  points3D->SetNumberOfPoints(2000);
+  for (vtkIdType i = 0; i < points3D->GetNumberOfPoints(); i++)
+    {
+    points3D->SetPoint(i, points->GetPoint(i));
+    }
+  vtkNew<vtkPolyData> input3D;
+  input3D->SetPoints(points3D.GetPointer());
+  vtkNew<vtkDelaunay3D> delaunay3D;
+  delaunay3D->SetInputData(input3D.GetPointer());
+  timer->StartTimer();
+  delaunay3D->Update();
+  timer->StopTimer();
+  inputTime = timer->GetElapsedTime();
+  expected = GetCells(delaunay3D->GetOutput());
+  delaunay3D->SpatialSortOn();
+  timer->StartTimer();
+  delaunay3D->Update();
+  timer->StopTimer();
+  cout << "vtkDelaunay3D: " << expected.size() << " tetrahedra in "
+       << inputTime << "s, " << timer->GetElapsedTime()
+       << "s with spatial sort" << endl;
+  if (GetCells(delaunay3D->GetOutput()) != expected)
+    {
+    cerr << "vtkDelaunay3D: different tetrahedra with spatial sort" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
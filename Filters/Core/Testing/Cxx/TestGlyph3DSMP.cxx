@@ -0,0 +1,228 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestGlyph3DSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkGlyph3D gives the same output when the glyphs are
+// generated in parallel (thread safe arrays) and when they are generated on
+// the calling thread. The latter is forced by adding a vtkBitArray, which
+// cannot be written concurrently, to the input point data.
+
+#include "vtkBitArray.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkGlyph3D.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkTransform.h"
+
+#include <algorithm>
+
+namespace
+{
+bool CompareArrays(vtkDataArray* a1, vtkDataArray* a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return false;
+    }
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int j = 0; j < a1->GetNumberOfComponents(); j++)
+      {
+      double v1 = a1->GetComponent(i, j);
+      double v2 = a2->GetComponent(i, j);
+      if (fabs(v1 - v2) > 1e-4 * (1.0 + fabs(v1)))
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+bool CompareData(vtkDataSetAttributes* serial, vtkDataSetAttributes* parallel)
+{
+  for (int i = 0; i < serial->GetNumberOfArrays(); i++)
+    {
+    vtkDataArray* array = serial->GetArray(i);
+    if (!array || vtkBitArray::SafeDownCast(array))
+      {
+      continue;
+      }
+    if (!CompareArrays(array, parallel->GetArray(array->GetName())))
+      {
+      cerr << "Array " << array->GetName() << " differs" << endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+int CompareOutputs(vtkGlyph3D* glyph, vtkPolyData* input,
+                   vtkPolyData* serialInput, const char* mode)
+{
+  glyph->SetInputData(serialInput);
+  glyph->Update();
+  vtkNew<vtkPolyData> serial;
+  serial->DeepCopy(glyph->GetOutput());
+
+  glyph->SetInputData(input);
+  glyph->Update();
+  vtkPolyData* parallel = glyph->GetOutput();
+
+  if (serial->GetNumberOfPoints() == 0 ||
+      serial->GetNumberOfPoints() != parallel->GetNumberOfPoints() ||
+      serial->GetNumberOfCells() != parallel->GetNumberOfCells())
+    {
+    cerr << mode << ": output sizes differ" << endl;
+    return EXIT_FAILURE;
+    }
+  if (!CompareArrays(serial->GetPoints()->GetData(),
+                     parallel->GetPoints()->GetData()))
+    {
+    cerr << mode << ": points differ" << endl;
+    return EXIT_FAILURE;
+    }
+  vtkCellArray* serialPolys = serial->GetPolys();
+  vtkCellArray* parallelPolys = parallel->GetPolys();
+  if (serialPolys->GetNumberOfConnectivityEntries() !=
+      parallelPolys->GetNumberOfConnectivityEntries() ||
+      !std::equal(serialPolys->GetPointer(),
+                  serialPolys->GetPointer() +
+                  serialPolys->GetNumberOfConnectivityEntries(),
+                  parallelPolys->GetPointer()))
+    {
+    cerr << mode << ": cells differ" << endl;
+    return EXIT_FAILURE;
+    }
+  if (!CompareData(serial->GetPointData(), parallel->GetPointData()) ||
+      !CompareData(serial->GetCellData(), parallel->GetCellData()))
+    {
+    cerr << mode << ": attributes differ" << endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int TestGlyph3DSMP(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  const vtkIdType numPts = 500;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  vtkNew<vtkFloatArray> extra;
+  extra->SetName("Extra");
+  extra->SetNumberOfComponents(2);
+
+  vtkMath::RandomSeed(1234);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    points->InsertNextPoint(vtkMath::Random(-10.0, 10.0),
+                            vtkMath::Random(-10.0, 10.0),
+                            vtkMath::Random(-10.0, 10.0));
+    if (i % 50 == 0)
+      {
+      // vectors along x, which are special cased by the orientation
+      vectors->InsertNextTuple3(i % 100 == 0 ? -2.0 : 2.0, 0.0, 0.0);
+      }
+    else
+      {
+      vectors->InsertNextTuple3(vtkMath::Random(-1.0, 1.0),
+                                vtkMath::Random(-1.0, 1.0),
+                                vtkMath::Random(-1.0, 1.0));
+      }
+    scalars->InsertNextValue(vtkMath::Random(0.0, 2.0));
+    extra->InsertNextTuple2(i, -i);
+    }
+
+  vtkNew<vtkPolyData> input;
+  input->SetPoints(points.GetPointer());
+  input->GetPointData()->SetVectors(vectors.GetPointer());
+  input->GetPointData()->SetScalars(scalars.GetPointer());
+  input->GetPointData()->AddArray(extra.GetPointer());
+
+  vtkNew<vtkBitArray> bits;
+  bits->SetName("Bits");
+  bits->SetNumberOfTuples(numPts);
+  vtkNew<vtkPolyData> serialInput;
+  serialInput->ShallowCopy(input.GetPointer());
+  serialInput->GetPointData()->AddArray(bits.GetPointer());
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(8);
+  sphere->SetPhiResolution(6);
+
+  vtkNew<vtkTransform> sourceTransform;
+  sourceTransform->Translate(0.5, 0.0, 0.0);
+  sourceTransform->Scale(1.0, 0.5, 0.5);
+
+  vtkNew<vtkGlyph3D> glyph;
+  glyph->SetSourceConnection(sphere->GetOutputPort());
+  glyph->GeneratePointIdsOn();
+  glyph->FillCellDataOn();
+  glyph->SetScaleFactor(0.5);
+
+  glyph->SetScaleModeToScaleByVector();
+  glyph->SetColorModeToColorByScale();
+  if (CompareOutputs(glyph.GetPointer(), input.GetPointer(),
+                     serialInput.GetPointer(), "ScaleByVector") !=
+      EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  glyph->SetScaleModeToScaleByScalar();
+  glyph->SetColorModeToColorByScalar();
+  glyph->SetSourceTransform(sourceTransform.GetPointer());
+  if (CompareOutputs(glyph.GetPointer(), input.GetPointer(),
+                     serialInput.GetPointer(), "ScaleByScalar") !=
+      EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  glyph->SetScaleModeToScaleByVectorComponents();
+  glyph->SetColorModeToColorByVector();
+  glyph->ClampingOn();
+  glyph->SetRange(-0.5, 1.0);
+  if (CompareOutputs(glyph.GetPointer(), input.GetPointer(),
+                     serialInput.GetPointer(), "ScaleByVectorComponents") !=
+      EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  glyph->ClampingOff();
+  glyph->ScalingOff();
+  glyph->SetVectorModeToVectorRotationOff();
+  if (CompareOutputs(glyph.GetPointer(), input.GetPointer(),
+                     serialInput.GetPointer(), "ScalingOff") !=
+      EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
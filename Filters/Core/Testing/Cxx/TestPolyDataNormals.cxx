@@ -0,0 +1,103 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPolyDataNormals.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the point normals computed by vtkPolyDataNormals on a cube, whose
+// edges are all split, and on a sphere, with and without the consistency
+// traversal.
+
+#include "vtkCleanPolyData.h"
+#include "vtkCubeSource.h"
+#include "vtkDataArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataNormals.h"
+#include "vtkSphereSource.h"
+
+int TestPolyDataNormals(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  // A cube with shared corners: splitting makes one point per face corner,
+  // each with the normal of its face.
+  vtkNew<vtkCubeSource> cube;
+  vtkNew<vtkCleanPolyData> clean;
+  clean->SetInputConnection(cube->GetOutputPort());
+  clean->Update();
+  clean->GetOutput()->GetPointData()->SetNormals(NULL);
+  if (clean->GetOutput()->GetNumberOfPoints() != 8)
+    {
+    cerr << "Unexpected cube" << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputData(clean->GetOutput());
+  normals->Update();
+  vtkPolyData* output = normals->GetOutput();
+  vtkDataArray* pointNormals = output->GetPointData()->GetNormals();
+  if (output->GetNumberOfPoints() != 24 || !pointNormals)
+    {
+    cerr << "Wrong number of split points: " << output->GetNumberOfPoints()
+         << endl;
+    return EXIT_FAILURE;
+    }
+  double n[3], x[3];
+  for (vtkIdType i = 0; i < output->GetNumberOfPoints(); i++)
+    {
+    pointNormals->GetTuple(i, n);
+    output->GetPoint(i, x);
+    int axis = (fabs(n[0]) > 0.5) ? 0 : (fabs(n[1]) > 0.5 ? 1 : 2);
+    // the normal is along one axis, pointing out of the cube
+    if (fabs(fabs(n[axis]) - 1.0) > 1e-6 || n[axis] * x[axis] <= 0.0)
+      {
+      cerr << "Wrong cube normal at point " << i << ": " << n[0] << " "
+           << n[1] << " " << n[2] << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A sphere: the normals are close to radial, whether or not the polygons
+  // are traversed to make their ordering consistent.
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(32);
+  sphere->SetPhiResolution(32);
+  sphere->Update();
+  sphere->GetOutput()->GetPointData()->SetNormals(NULL);
+  normals->SetInputData(sphere->GetOutput());
+  for (int consistency = 0; consistency < 2; consistency++)
+    {
+    normals->SetConsistency(consistency);
+    normals->Update();
+    output = normals->GetOutput();
+    pointNormals = output->GetPointData()->GetNormals();
+    if (output->GetNumberOfPoints() != sphere->GetOutput()->GetNumberOfPoints())
+      {
+      cerr << "Sphere points were split" << endl;
+      return EXIT_FAILURE;
+      }
+    for (vtkIdType i = 0; i < output->GetNumberOfPoints(); i++)
+      {
+      pointNormals->GetTuple(i, n);
+      output->GetPoint(i, x);
+      vtkMath::Normalize(x);
+      if (vtkMath::Dot(n, x) < 0.99)
+        {
+        cerr << "Wrong sphere normal at point " << i << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestProbeFilterLocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkProbeFilter gives the same results with a cell locator
+// prototype (parallel probing, cached locator) as with vtkDataSet::FindCell,
+// including when the source attributes or points change between updates,
+// and that the locator is only rebuilt when the points change.
+
+#include "vtkCellLocator.h"
+#include "vtkCharArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkImageDataToPointSet.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkProbeFilter.h"
+#include "vtkStructuredGrid.h"
+
+namespace
+{
+// A cell locator that counts how many times it has been built. The probe
+// filter builds instances of it from the prototype with NewInstance().
+class vtkCountingCellLocator : public vtkCellLocator
+{
+public:
+  static vtkCountingCellLocator *New();
+  vtkTypeMacro(vtkCountingCellLocator, vtkCellLocator);
+
+  virtual void BuildLocatorInternal()
+  {
+    NumberOfBuilds++;
+    this->Superclass::BuildLocatorInternal();
+  }
+
+  static int NumberOfBuilds;
+};
+
+int vtkCountingCellLocator::NumberOfBuilds = 0;
+vtkStandardNewMacro(vtkCountingCellLocator);
+
+bool CheckBuilds(int expected)
+{
+  if (vtkCountingCellLocator::NumberOfBuilds != expected)
+    {
+    cerr << "The locator was built " << vtkCountingCellLocator::NumberOfBuilds
+         << " times instead of " << expected << endl;
+    return false;
+    }
+  return true;
+}
+
+// Set a linear field on the source, which interpolation reproduces exactly.
+void SetField(vtkDataSet* source, double scale)
+{
+  vtkNew<vtkDoubleArray> field;
+  field->SetName("Field");
+  field->SetNumberOfTuples(source->GetNumberOfPoints());
+  double x[3];
+  for (vtkIdType i = 0; i < source->GetNumberOfPoints(); i++)
+    {
+    source->GetPoint(i, x);
+    field->SetValue(i, scale * (x[0] + 2.0 * x[1] + 3.0 * x[2]));
+    }
+  source->GetPointData()->AddArray(field.GetPointer());
+  source->Modified();
+}
+
+int CheckProbe(vtkProbeFilter* probe, double scale, double shift,
+               vtkIdType expectedValid)
+{
+  probe->Update();
+  vtkDataSet* output = probe->GetOutput();
+  vtkDataArray* field = output->GetPointData()->GetArray("Field");
+  vtkCharArray* mask = vtkCharArray::SafeDownCast(
+    output->GetPointData()->GetArray(probe->GetValidPointMaskArrayName()));
+  if (!field || !mask)
+    {
+    cerr << "Missing output arrays" << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkIdType numValid = 0;
+  double x[3];
+  for (vtkIdType i = 0; i < output->GetNumberOfPoints(); i++)
+    {
+    if (!mask->GetValue(i))
+      {
+      continue;
+      }
+    numValid++;
+    output->GetPoint(i, x);
+    double expected =
+      scale * ((x[0] - shift) + 2.0 * x[1] + 3.0 * x[2]);
+    if (fabs(field->GetTuple1(i) - expected) > 1e-6)
+      {
+      cerr << "Wrong value at point " << i << ": " << field->GetTuple1(i)
+           << " instead of " << expected << endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (numValid != expectedValid ||
+      numValid != probe->GetValidPoints()->GetNumberOfTuples())
+    {
+    cerr << "Wrong number of valid points: " << numValid << " instead of "
+         << expectedValid << endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int TestProbeFilterLocator(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(11, 11, 11);
+
+  vtkNew<vtkImageDataToPointSet> toPointSet;
+  toPointSet->SetInputData(image.GetPointer());
+  toPointSet->Update();
+  vtkNew<vtkStructuredGrid> source;
+  source->DeepCopy(toPointSet->GetOutput());
+  SetField(source.GetPointer(), 1.0);
+
+  // Scattered probe points, some of them outside of the source.
+  const vtkIdType numPts = 5000;
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    points->SetPoint(i,
+                     -1.0 + 12.0 * ((i * 37) % numPts) / numPts,
+                     -1.0 + 12.0 * ((i * 53) % numPts) / numPts,
+                     -1.0 + 12.0 * ((i * 71) % numPts) / numPts);
+    }
+  vtkNew<vtkPolyData> input;
+  input->SetPoints(points.GetPointer());
+
+  vtkNew<vtkProbeFilter> reference;
+  reference->SetInputData(input.GetPointer());
+  reference->SetSourceData(source.GetPointer());
+  reference->Update();
+  vtkIdType numValid = reference->GetValidPoints()->GetNumberOfTuples();
+  if (numValid == 0 || numValid == numPts)
+    {
+    cerr << "Unexpected number of valid points: " << numValid << endl;
+    return EXIT_FAILURE;
+    }
+  if (CheckProbe(reference.GetPointer(), 1.0, 0.0, numValid) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkCountingCellLocator> locator;
+  vtkNew<vtkProbeFilter> probe;
+  probe->SetInputData(input.GetPointer());
+  probe->SetSourceData(source.GetPointer());
+  probe->SetCellLocatorPrototype(locator.GetPointer());
+  if (CheckProbe(probe.GetPointer(), 1.0, 0.0, numValid) != EXIT_SUCCESS ||
+      !CheckBuilds(1))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Only the attributes change: the locator is reused.
+  SetField(source.GetPointer(), 2.0);
+  if (CheckProbe(probe.GetPointer(), 2.0, 0.0, numValid) != EXIT_SUCCESS ||
+      !CheckBuilds(1))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A new source object sharing the points and cells of the previous one,
+  // as with the time steps of a static mesh: the locator is reused.
+  vtkNew<vtkStructuredGrid> nextSource;
+  nextSource->ShallowCopy(source.GetPointer());
+  SetField(nextSource.GetPointer(), 3.0);
+  probe->SetSourceData(nextSource.GetPointer());
+  if (CheckProbe(probe.GetPointer(), 3.0, 0.0, numValid) != EXIT_SUCCESS ||
+      !CheckBuilds(1))
+    {
+    return EXIT_FAILURE;
+    }
+  probe->SetSourceData(source.GetPointer());
+
+  // The points move (the field moves with them): the locator must be
+  // rebuilt.
+  vtkPoints* sourcePoints = source->GetPoints();
+  double x[3];
+  for (vtkIdType i = 0; i < sourcePoints->GetNumberOfPoints(); i++)
+    {
+    sourcePoints->GetPoint(i, x);
+    x[0] += 0.5;
+    sourcePoints->SetPoint(i, x);
+    }
+  sourcePoints->Modified();
+  reference->Update();
+  numValid = reference->GetValidPoints()->GetNumberOfTuples();
+  if (CheckProbe(reference.GetPointer(), 2.0, 0.5, numValid) != EXIT_SUCCESS ||
+      CheckProbe(probe.GetPointer(), 2.0, 0.5, numValid) != EXIT_SUCCESS ||
+      !CheckBuilds(2))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestQuadricClusteringSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks vtkQuadricClustering on a tilted plane, whose points must stay on
+// the plane and whose triangles must match the bins of their points, and on
+// a sphere binned with 2048^3 divisions (which are only stored when
+// visited), whose triangles must then all be kept.
+
+#include "vtkCellArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPlaneSource.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkQuadricClustering.h"
+#include "vtkSphereSource.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace
+{
+// The bin of a point, computed as the filter does.
+vtkIdType HashPoint(const double x[3], const double bounds[6],
+                    const int divs[3])
+{
+  vtkIdType binId = 0;
+  vtkIdType sliceSize = 1;
+  for (int i = 0; i < 3; i++)
+    {
+    double binSize = (bounds[2*i+1] - bounds[2*i]) / divs[i];
+    double step = binSize > 0.0 ? 1.0 / binSize : 0.0;
+    int coord = static_cast<int>((x[i] - bounds[2*i]) * step);
+    coord = std::min(std::max(coord, 0), divs[i] - 1);
+    binId += coord * sliceSize;
+    sliceSize *= divs[i];
+    }
+  return binId;
+}
+
+// Checks the number of output points and triangles of the filter against
+// the bins of the input triangles.
+bool CheckTopology(vtkPolyData* input, vtkPolyData* output, const int divs[3],
+                   bool preventDuplicates)
+{
+  double bounds[6];
+  input->GetBounds(bounds);
+  std::set<vtkIdType> bins;
+  std::set<std::vector<vtkIdType> > triangles;
+  vtkIdType numTriangles = 0;
+  vtkIdType npts, *pts;
+  vtkCellArray* polys = input->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); )
+    {
+    std::vector<vtkIdType> tri(3);
+    for (int i = 0; i < 3; i++)
+      {
+      tri[i] = HashPoint(input->GetPoint(pts[i]), bounds, divs);
+      bins.insert(tri[i]);
+      }
+    if (tri[0] != tri[1] && tri[0] != tri[2] && tri[1] != tri[2])
+      {
+      numTriangles++;
+      std::sort(tri.begin(), tri.end());
+      triangles.insert(tri);
+      }
+    }
+  if (preventDuplicates)
+    {
+    numTriangles = static_cast<vtkIdType>(triangles.size());
+    }
+
+  if (output->GetNumberOfPoints() != static_cast<vtkIdType>(bins.size()) ||
+      output->GetNumberOfPolys() != numTriangles)
+    {
+    cerr << "Wrong output: " << output->GetNumberOfPoints() << " points and "
+         << output->GetNumberOfPolys() << " triangles instead of "
+         << bins.size() << " and " << numTriangles << endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int TestQuadricClusteringSMP(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  // A tilted plane: the optimal points of the bins are on the plane.
+  vtkNew<vtkPlaneSource> plane;
+  plane->SetOrigin(0.0, 0.0, 0.0);
+  plane->SetPoint1(4.0, 1.0, 0.5);
+  plane->SetPoint2(-1.0, 3.0, 2.0);
+  plane->SetResolution(60, 50);
+  plane->Update();
+  vtkNew<vtkPolyData> triangles;
+  triangles->DeepCopy(plane->GetOutput());
+  vtkCellArray* quads = triangles->GetPolys();
+  vtkNew<vtkCellArray> polys;
+  vtkIdType npts, *pts;
+  for (quads->InitTraversal(); quads->GetNextCell(npts, pts); )
+    {
+    vtkIdType tri1[3] = { pts[0], pts[1], pts[2] };
+    vtkIdType tri2[3] = { pts[0], pts[2], pts[3] };
+    polys->InsertNextCell(3, tri1);
+    polys->InsertNextCell(3, tri2);
+    }
+  triangles->SetPolys(polys.GetPointer());
+
+  double normal[3], center[3];
+  plane->GetNormal(normal);
+  plane->GetCenter(center);
+
+  int divs[3] = { 17, 13, 11 };
+  vtkNew<vtkQuadricClustering> clustering;
+  clustering->SetInputData(triangles.GetPointer());
+  clustering->AutoAdjustNumberOfDivisionsOff();
+  clustering->SetNumberOfDivisions(divs);
+  for (int prevent = 0; prevent < 2; prevent++)
+    {
+    clustering->SetPreventDuplicateCells(prevent);
+    clustering->Update();
+    vtkPolyData* output = clustering->GetOutput();
+    if (!CheckTopology(triangles.GetPointer(), output, divs, prevent != 0))
+      {
+      return EXIT_FAILURE;
+      }
+    for (vtkIdType i = 0; i < output->GetNumberOfPoints(); i++)
+      {
+      double x[3];
+      output->GetPoint(i, x);
+      double distance = (x[0] - center[0]) * normal[0] +
+        (x[1] - center[1]) * normal[1] + (x[2] - center[2]) * normal[2];
+      if (fabs(distance) > 1e-5)
+        {
+        cerr << "Point " << i << " is off the plane by " << distance << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // A sphere binned very finely: each point gets its own bin, and the
+  // triangles are those of the input, with points close to the input ones.
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(80);
+  sphere->SetPhiResolution(60);
+  sphere->Update();
+  vtkPolyData* input = sphere->GetOutput();
+  clustering->SetInputConnection(sphere->GetOutputPort());
+  clustering->SetNumberOfDivisions(2048, 2048, 2048);
+  clustering->PreventDuplicateCellsOn();
+  clustering->Update();
+  vtkPolyData* output = clustering->GetOutput();
+  if (output->GetNumberOfPoints() != input->GetNumberOfPoints() ||
+      output->GetNumberOfPolys() != input->GetNumberOfPolys())
+    {
+    cerr << "Wrong fine output: " << output->GetNumberOfPoints()
+         << " points and " << output->GetNumberOfPolys() << " triangles"
+         << endl;
+    return EXIT_FAILURE;
+    }
+  double bounds[6];
+  input->GetBounds(bounds);
+  double radius = 0.0;
+  for (int i = 0; i < 3; i++)
+    {
+    double binSize = (bounds[2*i+1] - bounds[2*i]) / 2048;
+    radius += binSize * binSize;
+    }
+  radius = sqrt(radius) / 2.0 + 1e-6;
+  vtkIdType *outPts;
+  vtkCellArray* inPolys = input->GetPolys();
+  vtkCellArray* outPolys = output->GetPolys();
+  inPolys->InitTraversal();
+  outPolys->InitTraversal();
+  while (inPolys->GetNextCell(npts, pts) && outPolys->GetNextCell(npts, outPts))
+    {
+    for (int i = 0; i < 3; i++)
+      {
+      if (sqrt(vtkMath::Distance2BetweenPoints(input->GetPoint(pts[i]),
+                                               output->GetPoint(outPts[i]))) >
+          radius)
+        {
+        cerr << "Point " << outPts[i] << " is too far from input point "
+             << pts[i] << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestQuadricDecimationBlocks.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkQuadricDecimation reaches the target reduction of a
+// closed surface when decimating it by blocks, that the decimated surface
+// stays closed (the seams between the blocks being decimated too), and that
+// its distance to the input surface is close to the one of a single pass,
+// with and without the attribute error metric.
+
+#include "vtkCellLocator.h"
+#include "vtkElevationFilter.h"
+#include "vtkFeatureEdges.h"
+#include "vtkGenericCell.h"
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkQuadricDecimation.h"
+#include "vtkSphereSource.h"
+
+#include <algorithm>
+
+namespace
+{
+// The maximum distance of the output points to the input surface.
+double Distance(vtkPolyData* input, vtkPolyData* output)
+{
+  vtkNew<vtkCellLocator> locator;
+  locator->SetDataSet(input);
+  locator->BuildLocator();
+  vtkNew<vtkGenericCell> cell;
+  double maxDistance = 0.0;
+  for (vtkIdType i = 0; i < output->GetNumberOfPoints(); i++)
+    {
+    double closest[3], distance2;
+    vtkIdType cellId;
+    int subId;
+    locator->FindClosestPoint(output->GetPoint(i), closest, cell.GetPointer(),
+                              cellId, subId, distance2);
+    maxDistance = std::max(maxDistance, sqrt(distance2));
+    }
+  return maxDistance;
+}
+
+bool IsClosed(vtkPolyData* surface)
+{
+  vtkNew<vtkFeatureEdges> edges;
+  edges->SetInputData(surface);
+  edges->BoundaryEdgesOn();
+  edges->NonManifoldEdgesOn();
+  edges->FeatureEdgesOff();
+  edges->ManifoldEdgesOff();
+  edges->Update();
+  return edges->GetOutput()->GetNumberOfCells() == 0;
+}
+}
+
+int TestQuadricDecimationBlocks(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  // A sphere stretched along x, so that the blocks are not all alike.
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(120);
+  sphere->SetPhiResolution(80);
+  vtkNew<vtkElevationFilter> elevation;
+  elevation->SetInputConnection(sphere->GetOutputPort());
+  elevation->Update();
+  vtkNew<vtkPolyData> input;
+  input->DeepCopy(elevation->GetOutput());
+  for (vtkIdType i = 0; i < input->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    input->GetPoint(i, x);
+    x[0] *= 2.0;
+    input->GetPoints()->SetPoint(i, x);
+    }
+
+  const double targetReduction = 0.9;
+  vtkNew<vtkQuadricDecimation> decimation;
+  decimation->SetInputData(input.GetPointer());
+  decimation->SetTargetReduction(targetReduction);
+  for (int attributes = 0; attributes < 2; attributes++)
+    {
+    decimation->SetAttributeErrorMetric(attributes);
+    decimation->SetBlockDivisions(1, 1, 1);
+    decimation->Update();
+    double singleDistance = Distance(input.GetPointer(),
+                                     decimation->GetOutput());
+
+    decimation->SetBlockDivisions(3, 2, 2);
+    decimation->Update();
+    vtkPolyData* output = decimation->GetOutput();
+    double blockDistance = Distance(input.GetPointer(), output);
+    cout << "AttributeErrorMetric " << attributes << ": "
+         << input->GetNumberOfPolys() << " triangles decimated to "
+         << output->GetNumberOfPolys() << " (reduction "
+         << decimation->GetActualReduction() << "), distance "
+         << blockDistance << " instead of " << singleDistance << endl;
+
+    if (fabs(decimation->GetActualReduction() - targetReduction) > 0.01)
+      {
+      cerr << "Wrong reduction " << decimation->GetActualReduction() << endl;
+      return EXIT_FAILURE;
+      }
+    if (!IsClosed(output))
+      {
+      cerr << "The blocks were not stitched together" << endl;
+      return EXIT_FAILURE;
+      }
+    if (blockDistance > 2.0 * singleDistance + 1e-3)
+      {
+      cerr << "The decimation by blocks is too coarse" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
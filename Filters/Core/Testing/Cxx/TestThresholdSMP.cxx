@@ -0,0 +1,193 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestThresholdSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkThreshold copies the cells satisfying the criterion, in
+// order, with the points they use (in increasing id order), their data and
+// the face stream of the polyhedra.
+
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkThreshold.h"
+#include "vtkUnstructuredGrid.h"
+
+namespace
+{
+// A row of n cubes along x, every other one being a polyhedron, with the
+// cube index as cell scalars and the x coordinate as point data.
+void MakeCubes(vtkUnstructuredGrid* grid, int n)
+{
+  vtkNew<vtkPoints> points;
+  for (int i = 0; i <= n; i++)
+    {
+    points->InsertNextPoint(i, 0, 0);
+    points->InsertNextPoint(i, 1, 0);
+    points->InsertNextPoint(i, 1, 1);
+    points->InsertNextPoint(i, 0, 1);
+    }
+  grid->SetPoints(points.GetPointer());
+  grid->Allocate(n);
+  vtkNew<vtkDoubleArray> cellScalars;
+  cellScalars->SetName("index");
+  vtkNew<vtkIdList> faces;
+  for (int i = 0; i < n; i++)
+    {
+    vtkIdType v[8];
+    for (int j = 0; j < 4; j++)
+      {
+      v[j] = 4 * i + j;
+      v[j + 4] = 4 * (i + 1) + j;
+      }
+    if (i % 2)
+      {
+      vtkIdType stream[] = { 6, 4, v[0], v[3], v[2], v[1],
+                             4, v[4], v[5], v[6], v[7],
+                             4, v[0], v[1], v[5], v[4],
+                             4, v[1], v[2], v[6], v[5],
+                             4, v[2], v[3], v[7], v[6],
+                             4, v[3], v[0], v[4], v[7] };
+      faces->Reset();
+      for (size_t j = 0; j < sizeof(stream) / sizeof(stream[0]); j++)
+        {
+        faces->InsertNextId(stream[j]);
+        }
+      grid->InsertNextCell(VTK_POLYHEDRON, faces.GetPointer());
+      }
+    else
+      {
+      vtkIdType hex[8] = { v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7] };
+      grid->InsertNextCell(VTK_HEXAHEDRON, 8, hex);
+      }
+    cellScalars->InsertNextValue(i);
+    }
+  grid->GetCellData()->SetScalars(cellScalars.GetPointer());
+  vtkNew<vtkDoubleArray> x;
+  x->SetName("x");
+  x->SetNumberOfTuples(grid->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); i++)
+    {
+    x->SetValue(i, grid->GetPoint(i)[0]);
+    }
+  grid->GetPointData()->AddArray(x.GetPointer());
+}
+}
+
+int TestThresholdSMP(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  const int n = 1000;
+  vtkNew<vtkUnstructuredGrid> input;
+  MakeCubes(input.GetPointer(), n);
+
+  // Keep the cubes 100 to 199.
+  vtkNew<vtkThreshold> threshold;
+  threshold->SetInputData(input.GetPointer());
+  threshold->SetInputArrayToProcess(0, 0, 0,
+    vtkDataObject::FIELD_ASSOCIATION_CELLS, vtkDataSetAttributes::SCALARS);
+  threshold->ThresholdBetween(100, 199);
+  threshold->Update();
+  vtkUnstructuredGrid* output = threshold->GetOutput();
+  if (output->GetNumberOfCells() != 100 || output->GetNumberOfPoints() != 404)
+    {
+    cerr << "Wrong output size: " << output->GetNumberOfCells() << " cells, "
+         << output->GetNumberOfPoints() << " points" << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkDataArray* index = output->GetCellData()->GetScalars();
+  vtkDataArray* x = output->GetPointData()->GetArray("x");
+  if (!index || !x)
+    {
+    cerr << "Missing output data" << endl;
+    return EXIT_FAILURE;
+    }
+
+  // The points keep their input order, and their data.
+  double previous = -1;
+  for (vtkIdType i = 0; i < output->GetNumberOfPoints(); i++)
+    {
+    double p[3];
+    output->GetPoint(i, p);
+    if (p[0] < previous || x->GetComponent(i, 0) != p[0])
+      {
+      cerr << "Wrong point " << i << endl;
+      return EXIT_FAILURE;
+      }
+    previous = p[0];
+    }
+
+  vtkNew<vtkIdList> ptIds;
+  for (vtkIdType i = 0; i < output->GetNumberOfCells(); i++)
+    {
+    int cube = 100 + static_cast<int>(i);
+    int type = (cube % 2) ? VTK_POLYHEDRON : VTK_HEXAHEDRON;
+    if (index->GetComponent(i, 0) != cube || output->GetCellType(i) != type)
+      {
+      cerr << "Wrong cell " << i << endl;
+      return EXIT_FAILURE;
+      }
+    output->GetCellPoints(i, ptIds.GetPointer());
+    if (ptIds->GetNumberOfIds() != 8)
+      {
+      cerr << "Wrong number of points for cell " << i << endl;
+      return EXIT_FAILURE;
+      }
+    for (vtkIdType j = 0; j < 8; j++)
+      {
+      double px = output->GetPoint(ptIds->GetId(j))[0];
+      if (px != cube && px != cube + 1)
+        {
+        cerr << "Wrong point of cell " << i << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    if (type == VTK_POLYHEDRON)
+      {
+      output->GetFaceStream(i, ptIds.GetPointer());
+      if (ptIds->GetNumberOfIds() != 31 || ptIds->GetId(0) != 6)
+        {
+        cerr << "Wrong face stream for cell " << i << endl;
+        return EXIT_FAILURE;
+        }
+      // The first face is at the smallest x.
+      for (vtkIdType j = 2; j < 6; j++)
+        {
+        if (output->GetPoint(ptIds->GetId(j))[0] != cube)
+          {
+          cerr << "Wrong face of cell " << i << endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  // With point scalars, all the points of the kept cells must satisfy the
+  // criterion.
+  threshold->SetInputArrayToProcess(0, 0, 0,
+    vtkDataObject::FIELD_ASSOCIATION_POINTS, "x");
+  threshold->ThresholdBetween(10.5, 20);
+  threshold->Update();
+  if (output->GetNumberOfCells() != 9 || output->GetNumberOfPoints() != 40)
+    {
+    cerr << "Wrong output size with point scalars: "
+         << output->GetNumberOfCells() << " cells, "
+         << output->GetNumberOfPoints() << " points" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
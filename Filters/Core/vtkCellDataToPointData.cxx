@@ -16,22 +16,247 @@
 
 #include "vtkCellData.h"
 #include "vtkCell.h"
+#include "vtkDataArray.h"
+#include "vtkDataArrayRound.h"
 #include "vtkDataSet.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
-#include "vtkNew.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
-#include "vtkUnsignedIntArray.h"
-#include "vtkUnstructuredGrid.h"
 
 #include <algorithm>
-#include <functional>
+#include <vector>
 
 vtkStandardNewMacro(vtkCellDataToPointData);
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Averages, at each point, the data of the cells using the point. Used for
+// the datasets whose point cells are computed rather than stored in links.
+template <class T>
+class vtkCellDataToPointDataGather
+{
+public:
+  vtkDataSet* Input;
+  const T* Source;
+  T* Destination;
+  int NumberOfComponents;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellIds;
+  vtkSMPThreadLocal<std::vector<double> > Sum;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList* cellIds = this->CellIds.Local();
+    std::vector<double>& sum = this->Sum.Local();
+    int ncomps = this->NumberOfComponents;
+    sum.resize(ncomps);
+    for (vtkIdType ptId = begin; ptId < end; ++ptId)
+      {
+      this->Input->GetPointCells(ptId, cellIds);
+      vtkIdType numCells = cellIds->GetNumberOfIds();
+      double weight = numCells > 0 ? 1.0 / numCells : 0.0;
+      std::fill(sum.begin(), sum.end(), 0.0);
+      for (vtkIdType j = 0; j < numCells; ++j)
+        {
+        const T* src = this->Source + cellIds->GetId(j)*ncomps;
+        for (int c = 0; c < ncomps; ++c)
+          {
+          sum[c] += weight * static_cast<double>(src[c]);
+          }
+        }
+      T* dst = this->Destination + ptId*ncomps;
+      for (int c = 0; c < ncomps; ++c)
+        {
+        vtkDataArrayRound(sum[c], dst + c);
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// The points split in blocks, and the range of the cells using the points
+// of each block: the points of block b are b*BlockSize to
+// (b+1)*BlockSize-1, their cells are among CellBegin[b] to CellEnd[b]-1.
+// Cells and points numbered alike (which they usually are) give narrow
+// ranges.
+struct vtkCellDataToPointDataBlocks
+{
+  vtkIdType NumberOfPoints;
+  vtkIdType BlockSize;
+  std::vector<vtkIdType> CellBegin;
+  std::vector<vtkIdType> CellEnd;
+
+  void Build(vtkDataSet* input, vtkIdType numBlocks)
+  {
+    vtkIdType ncells = input->GetNumberOfCells();
+    this->NumberOfPoints = input->GetNumberOfPoints();
+    this->BlockSize = (this->NumberOfPoints + numBlocks - 1) / numBlocks;
+    numBlocks = (this->NumberOfPoints + this->BlockSize - 1) / this->BlockSize;
+    this->CellBegin.assign(numBlocks, ncells);
+    this->CellEnd.assign(numBlocks, 0);
+    vtkIdList* pids = vtkIdList::New();
+    for (vtkIdType cid = 0; cid < ncells; ++cid)
+      {
+      input->GetCellPoints(cid, pids);
+      for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
+        {
+        vtkIdType block = pids->GetId(i) / this->BlockSize;
+        this->CellBegin[block] = std::min(this->CellBegin[block], cid);
+        this->CellEnd[block] = cid + 1;
+        }
+      }
+    pids->Delete();
+  }
+};
+
+//----------------------------------------------------------------------------
+// Averages, at each point, the data of the cells using the point. The
+// cells of a block of points are walked, and their data is added to the
+// sums and counts of the points of the block only, so that each point is
+// only written by the thread processing its block.
+template <class T>
+class vtkCellDataToPointDataScatter
+{
+public:
+  vtkDataSet* Input;
+  const vtkCellDataToPointDataBlocks* Blocks;
+  const T* Source;
+  T* Destination;
+  int NumberOfComponents;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+  vtkSMPThreadLocal<std::vector<double> > Sum;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Count;
+
+  void operator()(vtkIdType beginBlock, vtkIdType endBlock)
+  {
+    vtkIdList* cellPts = this->CellPoints.Local();
+    std::vector<double>& sum = this->Sum.Local();
+    std::vector<vtkIdType>& count = this->Count.Local();
+    int ncomps = this->NumberOfComponents;
+    vtkIdType blockSize = this->Blocks->BlockSize;
+    for (vtkIdType block = beginBlock; block < endBlock; ++block)
+      {
+      vtkIdType firstPt = block * blockSize;
+      vtkIdType numPts =
+        std::min(blockSize, this->Blocks->NumberOfPoints - firstPt);
+      sum.assign(numPts*ncomps, 0.0);
+      count.assign(numPts, 0);
+      for (vtkIdType cid = this->Blocks->CellBegin[block];
+           cid < this->Blocks->CellEnd[block]; ++cid)
+        {
+        this->Input->GetCellPoints(cid, cellPts);
+        const T* src = this->Source + cid*ncomps;
+        for (vtkIdType i = 0, I = cellPts->GetNumberOfIds(); i < I; ++i)
+          {
+          // unsigned, to test both ends of the block at once
+          vtkTypeUInt64 pt =
+            static_cast<vtkTypeUInt64>(cellPts->GetId(i) - firstPt);
+          if (pt < static_cast<vtkTypeUInt64>(numPts))
+            {
+            count[pt]++;
+            double* ptSum = &sum[pt*ncomps];
+            for (int c = 0; c < ncomps; ++c)
+              {
+              ptSum[c] += static_cast<double>(src[c]);
+              }
+            }
+          }
+        }
+      T* dst = this->Destination + firstPt*ncomps;
+      for (vtkIdType pt = 0; pt < numPts; ++pt)
+        {
+        for (int c = 0; c < ncomps; ++c, ++dst)
+          {
+          // guard against divide by zero
+          vtkDataArrayRound(
+            count[pt] > 0 ? sum[pt*ncomps+c] / count[pt] : 0.0, dst);
+          }
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// The cells using each point, for the arrays that are interpolated
+// serially: the cells of point i are Cells[Offsets[i]] to
+// Cells[Offsets[i+1]-1].
+struct vtkCellDataToPointDataPointCells
+{
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> Cells;
+
+  void Build(vtkDataSet* input)
+  {
+    vtkIdType npoints = input->GetNumberOfPoints();
+    vtkIdType ncells = input->GetNumberOfCells();
+    vtkIdList* pids = vtkIdList::New();
+    this->Offsets.assign(npoints + 1, 0);
+    for (vtkIdType cid = 0; cid < ncells; ++cid)
+      {
+      input->GetCellPoints(cid, pids);
+      for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
+        {
+        this->Offsets[pids->GetId(i) + 1]++;
+        }
+      }
+    for (vtkIdType pid = 0; pid < npoints; ++pid)
+      {
+      this->Offsets[pid + 1] += this->Offsets[pid];
+      }
+    this->Cells.resize(this->Offsets[npoints]);
+    std::vector<vtkIdType> next(this->Offsets.begin(), this->Offsets.end() - 1);
+    for (vtkIdType cid = 0; cid < ncells; ++cid)
+      {
+      input->GetCellPoints(cid, pids);
+      for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
+        {
+        this->Cells[next[pids->GetId(i)]++] = cid;
+        }
+      }
+    pids->Delete();
+  }
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkCellDataToPointDataGatherArray(vtkDataSet* input,
+                                       vtkDataArray* srcarray,
+                                       vtkDataArray* dstarray)
+{
+  vtkCellDataToPointDataGather<T> gather;
+  gather.Input = input;
+  gather.Source = static_cast<T*>(srcarray->GetVoidPointer(0));
+  gather.Destination = static_cast<T*>(dstarray->GetVoidPointer(0));
+  gather.NumberOfComponents = srcarray->GetNumberOfComponents();
+  vtkSMPTools::For(0, input->GetNumberOfPoints(), gather);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkCellDataToPointDataScatterArray(
+  vtkDataSet* input, const vtkCellDataToPointDataBlocks* blocks,
+  vtkDataArray* srcarray, vtkDataArray* dstarray)
+{
+  vtkCellDataToPointDataScatter<T> scatter;
+  scatter.Input = input;
+  scatter.Blocks = blocks;
+  scatter.Source = static_cast<T*>(srcarray->GetVoidPointer(0));
+  scatter.Destination = static_cast<T*>(dstarray->GetVoidPointer(0));
+  scatter.NumberOfComponents = srcarray->GetNumberOfComponents();
+  vtkSMPTools::For(
+    0, static_cast<vtkIdType>(blocks->CellBegin.size()), scatter);
+}
+}
+
 //----------------------------------------------------------------------------
 // Instantiate object so that cell data is not passed to output.
 vtkCellDataToPointData::vtkCellDataToPointData()
@@ -39,8 +264,6 @@ vtkCellDataToPointData::vtkCellDataToPointData()
   this->PassCellData = 0;
 }
 
-#define VTK_MAX_CELLS_PER_POINT 4096
-
 //----------------------------------------------------------------------------
 int vtkCellDataToPointData::RequestData(
   vtkInformation*,
@@ -57,35 +280,25 @@ int vtkCellDataToPointData::RequestData(
 
   vtkDebugMacro(<<"Mapping cell data to point data");
 
-  // Special traversal algorithm for unstructured grid
-  if (input->IsA("vtkUnstructuredGrid"))
+  // Special traversal algorithm for unstructured grid and polydata, which
+  // does not build the cell links
+  if (input->IsA("vtkUnstructuredGrid") || input->IsA("vtkPolyData"))
     {
-    return this->RequestDataForUnstructuredGrid(0, inputVector, outputVector);
+    return this->RequestDataForUnstructuredData(0, inputVector, outputVector);
     }
 
-  vtkIdType cellId, ptId;
-  vtkIdType numCells, numPts;
+  vtkIdType ptId, numPts;
   vtkCellData *inPD=input->GetCellData();
   vtkPointData *outPD=output->GetPointData();
-  vtkIdList *cellIds;
-  double weight;
-  double *weights;
-
-  vtkDebugMacro(<<"Mapping cell data to point data");
 
   // First, copy the input to the output as a starting point
   output->CopyStructure( input );
 
-  cellIds = vtkIdList::New();
-  cellIds->Allocate(VTK_MAX_CELLS_PER_POINT);
-
   if ( (numPts=input->GetNumberOfPoints()) < 1 )
     {
     vtkDebugMacro(<<"No input point data!");
-    cellIds->Delete();
     return 1;
     }
-  weights = new double[VTK_MAX_CELLS_PER_POINT];
 
   // Pass the point data first. The fields and attributes
   // which also exist in the cell data of the input will
@@ -96,32 +309,64 @@ int vtkCellDataToPointData::RequestData(
 
   // notice that inPD and outPD are vtkCellData and vtkPointData; respectively.
   // It's weird, but it works.
-  outPD->InterpolateAllocate(inPD,numPts);
+  vtkDataSetAttributes::FieldList cfl(1);
+  cfl.InitializeFieldList(inPD);
+  outPD->InterpolateAllocate(cfl, numPts, numPts);
+
+  // GetPointCells() is only thread safe once it has been called from a
+  // single thread.
+  vtkIdList *cellIds = vtkIdList::New();
+  input->GetPointCells(0, cellIds);
+  std::vector<double> weights;
 
-  int abort=0;
-  vtkIdType progressInterval=numPts/20 + 1;
-  for (ptId=0; ptId < numPts && !abort; ptId++)
+  for (int fid = 0, nfields = cfl.GetNumberOfFields(); fid < nfields; ++fid)
     {
-    if ( !(ptId % progressInterval) )
+    // update progress and check for an abort request.
+    this->UpdateProgress((fid+1.)/nfields);
+    if (this->GetAbortExecute())
       {
-      this->UpdateProgress(static_cast<double>(ptId)/numPts);
-      abort = GetAbortExecute();
+      break;
       }
 
-    input->GetPointCells(ptId, cellIds);
-    numCells = cellIds->GetNumberOfIds();
-    if ( numCells > 0 && numCells < VTK_MAX_CELLS_PER_POINT )
+    int const dstid = cfl.GetFieldIndex(fid);
+    int const srcid = cfl.GetDSAIndex(0,fid);
+    if  (srcid < 0 || dstid < 0)
       {
-      weight = 1.0 / numCells;
-      for (cellId=0; cellId < numCells; cellId++)
+      continue;
+      }
+
+    vtkAbstractArray* const srcarray = inPD->GetAbstractArray(srcid);
+    vtkAbstractArray* const dstarray = outPD->GetAbstractArray(dstid);
+    dstarray->SetNumberOfTuples(numPts);
+
+    vtkDataArray* const srcdata = vtkDataArray::SafeDownCast(srcarray);
+    vtkDataArray* const dstdata = vtkDataArray::SafeDownCast(dstarray);
+    if (srcdata && dstdata && srcdata->GetDataType() == dstdata->GetDataType())
+      {
+      bool done = true;
+      switch (srcdata->GetDataType())
+        {
+        vtkTemplateMacro(vtkCellDataToPointDataGatherArray<VTK_TT>(
+                           input, srcdata, dstdata));
+        default:
+          done = false;
+        }
+      if (done)
         {
-        weights[cellId] = weight;
+        continue;
         }
-      outPD->InterpolatePoint(inPD, ptId, cellIds, weights);
       }
-    else
+
+    // Other arrays (e.g. bits or strings) are interpolated serially.
+    for (ptId=0; ptId < numPts; ptId++)
       {
-      outPD->NullPoint(ptId);
+      input->GetPointCells(ptId, cellIds);
+      vtkIdType numCells = cellIds->GetNumberOfIds();
+      if (numCells > 0)
+        {
+        weights.assign(numCells, 1.0 / numCells);
+        dstarray->InterpolateTuple(ptId, cellIds, srcarray, &weights[0]);
+        }
       }
     }
 
@@ -133,7 +378,6 @@ int vtkCellDataToPointData::RequestData(
   output->GetCellData()->PassData(input->GetCellData());
 
   cellIds->Delete();
-  delete [] weights;
 
   return 1;
 }
@@ -147,61 +391,14 @@ void vtkCellDataToPointData::PrintSelf(ostream& os, vtkIndent indent)
 }
 
 //----------------------------------------------------------------------------
-// Helper template function that implement the major part of the algorighm
-// which will be expanded by the vtkTemplateMacro. The template function is
-// provided so that coverage test can cover this function.
-namespace
-{
-  template <typename T>
-  void __spread (vtkUnstructuredGrid* const src, vtkUnsignedIntArray* const num,
-             vtkDataArray* const srcarray, vtkDataArray* const dstarray,
-             vtkIdType ncells, vtkIdType npoints, vtkIdType ncomps)
-  {
-    T const* const srcptr = static_cast<T const*>(srcarray->GetVoidPointer(0));
-    T      * const dstptr = static_cast<T      *>(dstarray->GetVoidPointer(0));
-
-    // zero initialization
-    std::fill_n(dstptr, npoints*ncomps, T(0));
-
-    // accumulate
-    T const* srcbeg = srcptr;
-    vtkNew<vtkIdList> pids;
-    for (vtkIdType cid = 0; cid < ncells; ++cid, srcbeg += ncomps)
-      {
-      src->GetCellPoints(cid, pids.GetPointer());
-      for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
-        {
-        T* const dstbeg = dstptr + pids->GetId(i)*ncomps;
-        // accumulate cell data to point data <==> point_data += cell_data
-        std::transform(srcbeg,srcbeg+ncomps,dstbeg,dstbeg,std::plus<T>());
-        }
-      }
-
-    // average
-    T* dstbeg = dstptr;
-    for (vtkIdType pid = 0; pid < npoints; ++pid, dstbeg += ncomps)
-      {
-      // guard against divide by zero
-      if (unsigned int const denum = num->GetValue(pid))
-        {
-        // divide point data by the number of cells using it <==>
-        // point_data /= denum
-        std::transform(dstbeg, dstbeg+ncomps, dstbeg,
-          std::bind2nd(std::divides<T>(), denum));
-        }
-      }
-  }
-}
-
-//----------------------------------------------------------------------------
-int vtkCellDataToPointData::RequestDataForUnstructuredGrid
+int vtkCellDataToPointData::RequestDataForUnstructuredData
   (vtkInformation*,
    vtkInformationVector** inputVector,
    vtkInformationVector* outputVector)
 {
-  vtkUnstructuredGrid* const src = vtkUnstructuredGrid::SafeDownCast(
+  vtkDataSet* const src = vtkDataSet::SafeDownCast(
     inputVector[0]->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT()));
-  vtkUnstructuredGrid* const dst = vtkUnstructuredGrid::SafeDownCast(
+  vtkDataSet* const dst = vtkDataSet::SafeDownCast(
     outputVector->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT()));
 
   vtkIdType const ncells  = src->GetNumberOfCells ();
@@ -212,23 +409,6 @@ int vtkCellDataToPointData::RequestDataForUnstructuredGrid
     return 1;
     }
 
-  // count the number of cells associated with each point
-  vtkSmartPointer<vtkUnsignedIntArray> num
-    = vtkSmartPointer<vtkUnsignedIntArray>::New();
-  num->SetNumberOfComponents(1);
-  num->SetNumberOfTuples(npoints);
-  std::fill_n(num->GetPointer(0), npoints, 0u);
-  vtkNew<vtkIdList> pids;
-  for (vtkIdType cid = 0; cid < ncells; ++cid)
-    {
-    src->GetCellPoints(cid, pids.GetPointer());
-    for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
-      {
-      vtkIdType const pid = pids->GetId(i);
-      num->SetValue(pid, num->GetValue(pid)+1);
-      }
-    }
-
   // First, copy the input to the output as a starting point
   dst->CopyStructure(src);
   vtkPointData* const opd = dst->GetPointData();
@@ -244,10 +424,12 @@ int vtkCellDataToPointData::RequestDataForUnstructuredGrid
   vtkSmartPointer<vtkCellData> clean = vtkSmartPointer<vtkCellData>::New();
   clean->PassData(src->GetCellData());
 
-  // Remove all fields that are not a data array.
+  // Remove all fields that are not a data array from an unstructured grid.
+  // They are interpolated, serially, for a polydata.
   for (vtkIdType fid = clean->GetNumberOfArrays(); fid--;)
     {
-    if (!clean->GetAbstractArray(fid)->IsA("vtkDataArray"))
+    if (!clean->GetAbstractArray(fid)->IsA("vtkDataArray") &&
+        src->IsA("vtkUnstructuredGrid"))
       {
       clean->RemoveArray(fid);
       }
@@ -258,6 +440,17 @@ int vtkCellDataToPointData::RequestDataForUnstructuredGrid
   cfl.InitializeFieldList(clean);
   opd->InterpolateAllocate(cfl, npoints, npoints);
 
+  // The cell ranges of the blocks of points, shared by all the fields. A
+  // few blocks per thread balance the load.
+  vtkCellDataToPointDataBlocks blocks;
+  blocks.Build(src, std::min(
+    npoints, 4 * static_cast<vtkIdType>(
+      vtkMultiThreader::GetGlobalDefaultNumberOfThreads())));
+
+  vtkCellDataToPointDataPointCells pointCells;
+  vtkIdList *cellIds = NULL;
+  std::vector<double> weights;
+
   for (int fid = 0, nfields = cfl.GetNumberOfFields(); fid < nfields; ++fid)
     {
     // update progress and check for an abort request.
@@ -276,25 +469,54 @@ int vtkCellDataToPointData::RequestDataForUnstructuredGrid
       continue;
       }
 
-    vtkCellData * const srccelldata  = clean;
-    vtkPointData* const dstpointdata = dst->GetPointData();
+    vtkAbstractArray* const srcarray = clean->GetAbstractArray(srcid);
+    vtkAbstractArray* const dstarray = opd->GetAbstractArray(dstid);
+    dstarray->SetNumberOfTuples(npoints);
 
-    if (!srccelldata || !dstpointdata)
+    vtkDataArray* const srcdata = vtkDataArray::SafeDownCast(srcarray);
+    vtkDataArray* const dstdata = vtkDataArray::SafeDownCast(dstarray);
+    if (srcdata && dstdata && srcdata->GetDataType() == dstdata->GetDataType())
       {
-      continue;
+      bool done = true;
+      switch (srcdata->GetDataType())
+        {
+        vtkTemplateMacro(vtkCellDataToPointDataScatterArray<VTK_TT>(
+                           src, &blocks, srcdata, dstdata));
+        default:
+          done = false;
+        }
+      if (done)
+        {
+        continue;
+        }
       }
 
-    vtkDataArray* const srcarray = srccelldata ->GetArray(srcid);
-    vtkDataArray* const dstarray = dstpointdata->GetArray(dstid);
-    dstarray->SetNumberOfTuples(npoints);
-
-    vtkIdType const ncomps = srcarray->GetNumberOfComponents();
-    switch (srcarray->GetDataType())
+    // Other arrays (e.g. bits or strings) are interpolated serially, from
+    // the cells of each point, which are only stored for them.
+    if (!cellIds)
       {
-      vtkTemplateMacro
-        (__spread<VTK_TT>(src,num,srcarray,dstarray,ncells,npoints,ncomps));
+      cellIds = vtkIdList::New();
+      pointCells.Build(src);
+      }
+    for (vtkIdType pid = 0; pid < npoints; ++pid)
+      {
+      vtkIdType first = pointCells.Offsets[pid];
+      vtkIdType numCells = pointCells.Offsets[pid+1] - first;
+      if (numCells > 0)
+        {
+        cellIds->SetNumberOfIds(numCells);
+        std::copy(pointCells.Cells.begin() + first,
+                  pointCells.Cells.begin() + first + numCells,
+                  cellIds->GetPointer(0));
+        weights.assign(numCells, 1.0 / numCells);
+        dstarray->InterpolateTuple(pid, cellIds, srcarray, &weights[0]);
+        }
       }
     }
+  if (cellIds)
+    {
+    cellIds->Delete();
+    }
 
   if (!this->PassCellData)
     {
@@ -305,4 +527,3 @@ int vtkCellDataToPointData::RequestDataForUnstructuredGrid
 
   return 1;
 }
-
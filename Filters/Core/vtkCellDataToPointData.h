@@ -18,7 +18,9 @@
 // specified per cell) into point data (i.e., data specified at cell
 // points). The method of transformation is based on averaging the data
 // values of all cells using a particular point. Optionally, the input cell
-// data can be passed through to the output as well.
+// data can be passed through to the output as well. The data arrays are
+// averaged in parallel; for unstructured grids and polydata, this is done
+// by walking the cells, without building the cell links.
 
 // .SECTION Caveats
 // This filter is an abstract filter, that is, the output is an abstract type
@@ -61,8 +63,10 @@ protected:
                           vtkInformationVector** inputVector,
                           vtkInformationVector* outputVector);
 
-  // Special traversal algorithm for unstructured grid
-  int RequestDataForUnstructuredGrid
+  // Special traversal algorithm for unstructured grid and polydata, which
+  // adds the data of the cells to the sums of their points, block of
+  // points by block of points, and does not build the cell links.
+  int RequestDataForUnstructuredData
     (vtkInformation*, vtkInformationVector**, vtkInformationVector*);
 
   int PassCellData;
@@ -0,0 +1,514 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellSubsetExtractor.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCellSubsetExtractor.h"
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <vector>
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Return true if tuples of the array can be read and written concurrently
+// (at distinct tuples for writing).
+bool vtkCellSubsetExtractorIsThreadSafe(vtkAbstractArray *array)
+{
+  return vtkDataArray::SafeDownCast(array) &&
+    array->GetDataType() != VTK_BIT && array->HasStandardMemoryLayout();
+}
+
+bool vtkCellSubsetExtractorIsThreadSafe(vtkDataSetAttributes *dsa)
+{
+  for (int i = 0; i < dsa->GetNumberOfArrays(); i++)
+    {
+    if (!vtkCellSubsetExtractorIsThreadSafe(dsa->GetAbstractArray(i)))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Marks the points used by the flagged cells. Cells sharing a point may
+// mark it concurrently, but they all write the same value.
+class vtkCellSubsetMarkPoints
+{
+public:
+  vtkDataSet *Input;
+  const signed char *CellFlags;
+  unsigned char *Used;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPoints.Local();
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      if (this->CellFlags[cellId] > 0)
+        {
+        this->Input->GetCellPoints(cellId, cellPts);
+        for (vtkIdType i = 0; i < cellPts->GetNumberOfIds(); i++)
+          {
+          this->Used[cellPts->GetId(i)] = 1;
+          }
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Inverts the point map, giving the input id of each output point.
+class vtkCellSubsetInvertPointMap
+{
+public:
+  const vtkIdType *PointMap;
+  vtkIdType *SourceIds;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType ptId = begin; ptId < end; ptId++)
+      {
+      if (this->PointMap[ptId] >= 0)
+        {
+        this->SourceIds[this->PointMap[ptId]] = ptId;
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Copies the coordinates and data of the output points.
+class vtkCellSubsetCopyPoints
+{
+public:
+  vtkDataSet *Input;
+  const vtkIdType *SourceIds;
+  vtkPoints *OutPoints;
+  vtkPointData *InPD;
+  vtkPointData *OutPD;
+  vtkDataSetAttributes::FieldList *PointList;
+  vtkIdTypeArray *OriginalIds;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double x[3];
+    for (vtkIdType ptId = begin; ptId < end; ptId++)
+      {
+      vtkIdType srcId = this->SourceIds[ptId];
+      this->Input->GetPoint(srcId, x);
+      this->OutPoints->SetPoint(ptId, x);
+      this->OutPD->CopyData(*this->PointList, this->InPD, 0, srcId, ptId);
+      if (this->OriginalIds)
+        {
+        this->OriginalIds->SetValue(ptId, srcId);
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Computes the connectivity size of the flagged cells (number of points),
+// and the size of the face stream of the polyhedra.
+class vtkCellSubsetCountCells
+{
+public:
+  vtkDataSet *Input;
+  vtkUnstructuredGrid *Polyhedra;
+  const signed char *CellFlags;
+  vtkIdType *Sizes;
+  vtkIdType *FaceSizes;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPoints.Local();
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      if (this->CellFlags[cellId] <= 0)
+        {
+        this->Sizes[cellId] = 0;
+        continue;
+        }
+      this->Input->GetCellPoints(cellId, cellPts);
+      this->Sizes[cellId] = cellPts->GetNumberOfIds();
+      if (!this->Polyhedra)
+        {
+        continue;
+        }
+      this->FaceSizes[cellId] = 0;
+      if (this->Polyhedra->GetCellType(cellId) == VTK_POLYHEDRON)
+        {
+        const vtkIdType *faces = this->Polyhedra->GetFaces(cellId);
+        vtkIdType size = 1;
+        for (vtkIdType i = 0; i < faces[0]; i++)
+          {
+          size += 1 + faces[size];
+          }
+        this->FaceSizes[cellId] = size;
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Writes the flagged cells at their output id, with their data. Offsets
+// and FaceOffsets give the location of each cell in the connectivity and
+// in the face stream of the output.
+class vtkCellSubsetCopyCells
+{
+public:
+  vtkDataSet *Input;
+  vtkUnstructuredGrid *Polyhedra;
+  const signed char *CellFlags;
+  const vtkIdType *PointMap;
+  const vtkIdType *NewIds;
+  const vtkIdType *Offsets;
+  const vtkIdType *FaceOffsets;
+  vtkIdType *Connectivity;
+  vtkIdType *Locations;
+  unsigned char *Types;
+  vtkIdType *Faces;
+  vtkIdType *FaceLocations;
+  vtkCellData *InCD;
+  vtkCellData *OutCD;
+  vtkDataSetAttributes::FieldList *CellList;
+  vtkIdTypeArray *OriginalIds;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPoints.Local();
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      if (this->CellFlags[cellId] <= 0)
+        {
+        continue;
+        }
+      vtkIdType newId = this->NewIds[cellId];
+      vtkIdType loc = this->Offsets[cellId];
+      this->Input->GetCellPoints(cellId, cellPts);
+      vtkIdType npts = cellPts->GetNumberOfIds();
+      vtkIdType *conn = this->Connectivity + loc;
+      *conn++ = npts;
+      for (vtkIdType i = 0; i < npts; i++)
+        {
+        conn[i] = this->PointMap[cellPts->GetId(i)];
+        }
+      this->Locations[newId] = loc;
+      this->Types[newId] =
+        static_cast<unsigned char>(this->Input->GetCellType(cellId));
+
+      if (this->Polyhedra)
+        {
+        this->FaceLocations[newId] = -1;
+        if (this->Types[newId] == VTK_POLYHEDRON)
+          {
+          const vtkIdType *faces = this->Polyhedra->GetFaces(cellId);
+          vtkIdType *newFaces = this->Faces + this->FaceOffsets[cellId];
+          this->FaceLocations[newId] = this->FaceOffsets[cellId];
+          vtkIdType nfaces = *faces++;
+          *newFaces++ = nfaces;
+          for (vtkIdType i = 0; i < nfaces; i++)
+            {
+            vtkIdType nfacePts = *faces++;
+            *newFaces++ = nfacePts;
+            for (vtkIdType j = 0; j < nfacePts; j++)
+              {
+              *newFaces++ = this->PointMap[*faces++];
+              }
+            }
+          }
+        }
+
+      this->OutCD->CopyData(*this->CellList, this->InCD, 0, cellId, newId);
+      if (this->OriginalIds)
+        {
+        this->OriginalIds->SetValue(newId, cellId);
+        }
+      }
+  }
+};
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellSubsetExtractor::MapPoints(vtkDataSet *input,
+                                            const signed char *cellFlags,
+                                            const signed char *pointFlags,
+                                            vtkIdType *pointMap)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkIdType ptId, numNewPts = 0;
+
+  if (pointFlags)
+    {
+    for (ptId = 0; ptId < numPts; ptId++)
+      {
+      pointMap[ptId] = (pointFlags[ptId] > 0 ? numNewPts++ : -1);
+      }
+    return numNewPts;
+    }
+
+  std::vector<unsigned char> used(numPts, 0);
+  if (numCells > 0 && numPts > 0)
+    {
+    // Build the cells (of vtkPolyData) before they are used concurrently.
+    vtkIdList *cellPts = vtkIdList::New();
+    input->GetCellPoints(0, cellPts);
+    cellPts->Delete();
+
+    vtkCellSubsetMarkPoints marker;
+    marker.Input = input;
+    marker.CellFlags = cellFlags;
+    marker.Used = &used[0];
+    vtkSMPTools::For(0, numCells, marker);
+    }
+  for (ptId = 0; ptId < numPts; ptId++)
+    {
+    pointMap[ptId] = (used[ptId] ? numNewPts++ : -1);
+    }
+  return numNewPts;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellSubsetExtractor::CopyPoints(vtkDataSet *input,
+                                        const vtkIdType *pointMap,
+                                        vtkIdType numNewPts,
+                                        vtkPoints *newPoints,
+                                        vtkPointData *outPD,
+                                        vtkIdTypeArray *originalPointIds)
+{
+  // The attributes are copied through FieldLists, which (unlike
+  // CopyData(vtkDataSetAttributes*, ...)) can be used concurrently.
+  vtkPointData *inPD = input->GetPointData();
+  vtkDataSetAttributes::FieldList pointList(1);
+  pointList.InitializeFieldList(inPD);
+  outPD->CopyAllocate(pointList, numNewPts);
+  for (int i = 0; i < outPD->GetNumberOfArrays(); i++)
+    {
+    outPD->GetAbstractArray(i)->SetNumberOfTuples(numNewPts);
+    }
+  newPoints->SetNumberOfPoints(numNewPts);
+  if (originalPointIds)
+    {
+    originalPointIds->SetNumberOfTuples(numNewPts);
+    }
+  if (numNewPts == 0)
+    {
+    return;
+    }
+
+  std::vector<vtkIdType> sourceIds(numNewPts);
+  vtkCellSubsetInvertPointMap inverter;
+  inverter.PointMap = pointMap;
+  inverter.SourceIds = &sourceIds[0];
+  vtkSMPTools::For(0, input->GetNumberOfPoints(), inverter);
+
+  vtkCellSubsetCopyPoints copier;
+  copier.Input = input;
+  copier.SourceIds = &sourceIds[0];
+  copier.OutPoints = newPoints;
+  copier.InPD = inPD;
+  copier.OutPD = outPD;
+  copier.PointList = &pointList;
+  copier.OriginalIds = originalPointIds;
+
+  vtkPointSet *inputPointSet = vtkPointSet::SafeDownCast(input);
+  if (vtkCellSubsetExtractorIsThreadSafe(inPD) &&
+      vtkCellSubsetExtractorIsThreadSafe(outPD) &&
+      vtkCellSubsetExtractorIsThreadSafe(newPoints->GetData()) &&
+      (!inputPointSet || !inputPointSet->GetPoints() ||
+       vtkCellSubsetExtractorIsThreadSafe(inputPointSet->GetPoints()->GetData())))
+    {
+    vtkSMPTools::For(0, numNewPts, copier);
+    }
+  else
+    {
+    copier(0, numNewPts);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellSubsetExtractor::CopyCells(vtkDataSet *input,
+                                            const signed char *cellFlags,
+                                            const vtkIdType *pointMap,
+                                            vtkUnstructuredGrid *output,
+                                            vtkIdTypeArray *originalCellIds)
+{
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkIdType cellId;
+
+  // Only the polyhedra of an unstructured grid have a face stream.
+  vtkUnstructuredGrid *polyhedra = vtkUnstructuredGrid::SafeDownCast(input);
+  if (polyhedra && !polyhedra->GetFaces())
+    {
+    polyhedra = NULL;
+    }
+
+  // First pass: the size of each cell.
+  std::vector<vtkIdType> offsets(numCells > 0 ? numCells : 1);
+  std::vector<vtkIdType> faceOffsets(polyhedra ? numCells : 1);
+  if (numCells > 0)
+    {
+    // Build the cells (of vtkPolyData) before they are used concurrently.
+    vtkIdList *cellPts = vtkIdList::New();
+    input->GetCellPoints(0, cellPts);
+    cellPts->Delete();
+
+    vtkCellSubsetCountCells counter;
+    counter.Input = input;
+    counter.Polyhedra = polyhedra;
+    counter.CellFlags = cellFlags;
+    counter.Sizes = &offsets[0];
+    counter.FaceSizes = &faceOffsets[0];
+    vtkSMPTools::For(0, numCells, counter);
+    }
+
+  // Number the output cells, and turn the sizes into offsets.
+  std::vector<vtkIdType> newIds(numCells > 0 ? numCells : 1);
+  vtkIdType numNewCells = 0, connSize = 0, facesSize = 0;
+  for (cellId = 0; cellId < numCells; cellId++)
+    {
+    if (cellFlags[cellId] <= 0)
+      {
+      newIds[cellId] = -1;
+      continue;
+      }
+    newIds[cellId] = numNewCells++;
+    vtkIdType size = offsets[cellId];
+    offsets[cellId] = connSize;
+    connSize += size + 1;
+    if (polyhedra)
+      {
+      size = faceOffsets[cellId];
+      faceOffsets[cellId] = facesSize;
+      facesSize += size;
+      }
+    }
+
+  // Allocate the output at its exact size.
+  vtkIdTypeArray *connectivity = vtkIdTypeArray::New();
+  connectivity->SetNumberOfValues(connSize);
+  vtkCellArray *cells = vtkCellArray::New();
+  cells->SetCells(numNewCells, connectivity);
+  connectivity->Delete();
+  vtkIdTypeArray *locations = vtkIdTypeArray::New();
+  locations->SetNumberOfValues(numNewCells);
+  vtkUnsignedCharArray *types = vtkUnsignedCharArray::New();
+  types->SetNumberOfValues(numNewCells);
+  vtkIdTypeArray *faces = NULL;
+  vtkIdTypeArray *faceLocations = NULL;
+  if (polyhedra && facesSize > 0)
+    {
+    faces = vtkIdTypeArray::New();
+    faces->SetNumberOfValues(facesSize);
+    faceLocations = vtkIdTypeArray::New();
+    faceLocations->SetNumberOfValues(numNewCells);
+    }
+  else
+    {
+    polyhedra = NULL;
+    }
+
+  vtkCellData *inCD = input->GetCellData();
+  vtkCellData *outCD = output->GetCellData();
+  vtkDataSetAttributes::FieldList cellList(1);
+  cellList.InitializeFieldList(inCD);
+  outCD->CopyAllocate(cellList, numNewCells);
+  for (int i = 0; i < outCD->GetNumberOfArrays(); i++)
+    {
+    outCD->GetAbstractArray(i)->SetNumberOfTuples(numNewCells);
+    }
+  if (originalCellIds)
+    {
+    originalCellIds->SetNumberOfTuples(numNewCells);
+    }
+
+  // Second pass: write the cells.
+  if (numNewCells > 0)
+    {
+    vtkCellSubsetCopyCells copier;
+    copier.Input = input;
+    copier.Polyhedra = polyhedra;
+    copier.CellFlags = cellFlags;
+    copier.PointMap = pointMap;
+    copier.NewIds = &newIds[0];
+    copier.Offsets = &offsets[0];
+    copier.FaceOffsets = &faceOffsets[0];
+    copier.Connectivity = connectivity->GetPointer(0);
+    copier.Locations = locations->GetPointer(0);
+    copier.Types = types->GetPointer(0);
+    copier.Faces = faces ? faces->GetPointer(0) : NULL;
+    copier.FaceLocations = faceLocations ? faceLocations->GetPointer(0) : NULL;
+    copier.InCD = inCD;
+    copier.OutCD = outCD;
+    copier.CellList = &cellList;
+    copier.OriginalIds = originalCellIds;
+    if (vtkCellSubsetExtractorIsThreadSafe(inCD) &&
+        vtkCellSubsetExtractorIsThreadSafe(outCD))
+      {
+      vtkSMPTools::For(0, numCells, copier);
+      }
+    else
+      {
+      copier(0, numCells);
+      }
+    }
+
+  output->SetCells(types, locations, cells, faceLocations, faces);
+  types->Delete();
+  locations->Delete();
+  cells->Delete();
+  if (faces)
+    {
+    faces->Delete();
+    faceLocations->Delete();
+    }
+
+  return numNewCells;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellSubsetExtractor::Extract(vtkDataSet *input,
+                                     const signed char *cellFlags,
+                                     vtkPoints *newPoints,
+                                     vtkUnstructuredGrid *output,
+                                     vtkIdTypeArray *originalCellIds,
+                                     vtkIdTypeArray *originalPointIds)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  std::vector<vtkIdType> pointMap(numPts > 0 ? numPts : 1);
+  vtkIdType numNewPts = vtkCellSubsetExtractor::MapPoints(
+    input, cellFlags, NULL, &pointMap[0]);
+  vtkCellSubsetExtractor::CopyPoints(input, &pointMap[0], numNewPts,
+    newPoints, output->GetPointData(), originalPointIds);
+  output->SetPoints(newPoints);
+  vtkCellSubsetExtractor::CopyCells(input, cellFlags, &pointMap[0], output,
+    originalCellIds);
+}
@@ -0,0 +1,91 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCellSubsetExtractor.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkCellSubsetExtractor - A utility class copying a subset of cells into an unstructured grid
+// .SECTION Description
+//  This is a simple utility class used by the filters extracting a subset
+//  of the cells (or points) of a dataset into a vtkUnstructuredGrid, such
+//  as vtkThreshold, vtkExtractCells and vtkExtractSelectedIds. The cells
+//  and points to keep are given by flags (positive meaning kept). Instead
+//  of inserting the cells, points and attributes one at a time, it counts
+//  the output cells and connectivity, numbers them with prefix sums, and
+//  writes the connectivity, points and attributes into output arrays of the
+//  exact size. Both passes are run in parallel using vtkSMPTools (the
+//  attributes being copied serially when some of their arrays cannot be
+//  written concurrently).
+//
+//  The output points are numbered in increasing order of their input ids,
+//  and the output cells in increasing order of theirs.
+// .SECTION See Also
+// vtkThreshold vtkExtractCells vtkExtractSelectedIds
+
+#ifndef __vtkCellSubsetExtractor_h
+#define __vtkCellSubsetExtractor_h
+
+#include "vtkFiltersCoreModule.h" // For export macro
+#include "vtkType.h" //for vtkIdType
+
+class vtkDataSet;
+class vtkIdTypeArray;
+class vtkPointData;
+class vtkPoints;
+class vtkUnstructuredGrid;
+
+class VTKFILTERSCORE_EXPORT vtkCellSubsetExtractor
+{
+public:
+  // Description:
+  // Map the points of the input whose flag is positive or, when pointFlags
+  // is NULL, the points used by the cells whose flag is positive, to their
+  // new ids in increasing id order. The other points are mapped to -1.
+  // Return the number of mapped points.
+  static vtkIdType MapPoints(vtkDataSet *input, const signed char *cellFlags,
+                             const signed char *pointFlags,
+                             vtkIdType *pointMap);
+
+  // Description:
+  // Copy the mapped points, and their data into outPD (which is allocated
+  // following its copy flags), into newPoints. Their input ids are stored
+  // into originalPointIds if it is not NULL.
+  static void CopyPoints(vtkDataSet *input, const vtkIdType *pointMap,
+                         vtkIdType numNewPts, vtkPoints *newPoints,
+                         vtkPointData *outPD,
+                         vtkIdTypeArray *originalPointIds = 0);
+
+  // Description:
+  // Set as the cells of output the cells of the input whose flag is
+  // positive, with their point ids mapped through pointMap, and copy their
+  // data (following the copy flags of the output cell data). Their input
+  // ids are stored into originalCellIds if it is not NULL. Return the
+  // number of output cells.
+  static vtkIdType CopyCells(vtkDataSet *input, const signed char *cellFlags,
+                             const vtkIdType *pointMap,
+                             vtkUnstructuredGrid *output,
+                             vtkIdTypeArray *originalCellIds = 0);
+
+  // Description:
+  // Copy into output the cells whose flag is positive and the points they
+  // use, with their data. The data type of newPoints is kept; newPoints is
+  // set as the points of output.
+  static void Extract(vtkDataSet *input, const signed char *cellFlags,
+                      vtkPoints *newPoints, vtkUnstructuredGrid *output,
+                      vtkIdTypeArray *originalCellIds = 0,
+                      vtkIdTypeArray *originalPointIds = 0);
+
+private:
+  vtkCellSubsetExtractor(); // Not implemented.
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkCellSubsetExtractor.h
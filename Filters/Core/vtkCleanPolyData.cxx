@@ -22,11 +22,323 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkIncrementalPointLocator.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkCleanPolyData);
 
+namespace
+{
+// Orders point ids by coordinates, then by id, so that coincident points
+// are contiguous and sorted by id. NaN coordinates are ordered after all
+// the numbers and are equivalent to each other, so that the ordering stays
+// a strict weak ordering.
+class vtkCleanPolyDataPointLess
+{
+public:
+  const double* Coords;
+
+  bool operator()(vtkIdType a, vtkIdType b) const
+  {
+    const double* xa = this->Coords + 3*a;
+    const double* xb = this->Coords + 3*b;
+    for (int i=0; i < 3; i++)
+      {
+      if (xa[i] < xb[i])
+        {
+        return true;
+        }
+      if (xb[i] < xa[i])
+        {
+        return false;
+        }
+      bool nanA = (xa[i] != xa[i]);
+      bool nanB = (xb[i] != xb[i]);
+      if (nanA != nanB)
+        {
+        return nanB;
+        }
+      }
+    return a < b;
+  }
+};
+
+// Sorts fixed size chunks of the ids.
+class vtkCleanPolyDataSortChunks
+{
+public:
+  vtkIdType* Ids;
+  vtkIdType NumberOfIds;
+  vtkIdType ChunkSize;
+  vtkCleanPolyDataPointLess Less;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType chunk=begin; chunk < end; chunk++)
+      {
+      vtkIdType first = chunk * this->ChunkSize;
+      vtkIdType last = std::min(first + this->ChunkSize, this->NumberOfIds);
+      std::sort(this->Ids + first, this->Ids + last, this->Less);
+      }
+  }
+};
+
+// Merges pairs of adjacent sorted runs of Width ids into Output.
+class vtkCleanPolyDataMergeRuns
+{
+public:
+  const vtkIdType* Input;
+  vtkIdType* Output;
+  vtkIdType NumberOfIds;
+  vtkIdType Width;
+  vtkCleanPolyDataPointLess Less;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType pair=begin; pair < end; pair++)
+      {
+      vtkIdType first = 2 * pair * this->Width;
+      vtkIdType middle = std::min(first + this->Width, this->NumberOfIds);
+      vtkIdType last = std::min(middle + this->Width, this->NumberOfIds);
+      std::merge(this->Input + first, this->Input + middle,
+                 this->Input + middle, this->Input + last,
+                 this->Output + first, this->Less);
+      }
+  }
+};
+
+// Parallel merge sort of the point ids: chunks are sorted concurrently,
+// then merged pairwise, each round of merges running concurrently.
+void vtkCleanPolyDataSortPoints(const double* coords, vtkIdType numPts,
+                                std::vector<vtkIdType>& ids)
+{
+  const vtkIdType chunkSize = 65536;
+  ids.resize(numPts);
+  for (vtkIdType i=0; i < numPts; i++)
+    {
+    ids[i] = i;
+    }
+  vtkCleanPolyDataPointLess less;
+  less.Coords = coords;
+
+  vtkCleanPolyDataSortChunks sorter;
+  sorter.Ids = &ids[0];
+  sorter.NumberOfIds = numPts;
+  sorter.ChunkSize = chunkSize;
+  sorter.Less = less;
+  vtkIdType numChunks = (numPts + chunkSize - 1) / chunkSize;
+  vtkSMPTools::For(0, numChunks, 1, sorter);
+
+  if (numChunks > 1)
+    {
+    std::vector<vtkIdType> tmp(numPts);
+    vtkCleanPolyDataMergeRuns merger;
+    merger.NumberOfIds = numPts;
+    merger.Less = less;
+    vtkIdType* input = &ids[0];
+    vtkIdType* output = &tmp[0];
+    for (vtkIdType width=chunkSize; width < numPts; width *= 2)
+      {
+      merger.Input = input;
+      merger.Output = output;
+      merger.Width = width;
+      vtkSMPTools::For(0, (numPts + 2*width - 1) / (2*width), 1, merger);
+      std::swap(input, output);
+      }
+    if (input != &ids[0])
+      {
+      std::copy(input, input + numPts, ids.begin());
+      }
+    }
+}
+
+// Return true if tuples of the array can be read and written concurrently
+// (at distinct tuples for writing).
+bool vtkCleanPolyDataIsThreadSafe(vtkAbstractArray* array)
+{
+  return vtkDataArray::SafeDownCast(array) &&
+    array->GetDataType() != VTK_BIT && array->HasStandardMemoryLayout();
+}
+
+bool vtkCleanPolyDataIsThreadSafe(vtkDataSetAttributes* dsa)
+{
+  for (int i=0; i < dsa->GetNumberOfArrays(); i++)
+    {
+    if (!vtkCleanPolyDataIsThreadSafe(dsa->GetAbstractArray(i)))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// Kinds of cells, in the order of the cell ids of vtkPolyData.
+enum
+{
+  CLEAN_VERTS = 0,
+  CLEAN_LINES,
+  CLEAN_POLYS,
+  CLEAN_STRIPS,
+  CLEAN_DROPPED = -1
+};
+
+// Renumbers the points of a cell of the given kind and removes its
+// consecutive duplicate points. Returns the kind of cell it becomes, with
+// the same rules as the locator based implementation.
+int vtkCleanPolyDataMapCell(int kind, vtkIdType npts, const vtkIdType* pts,
+                            const vtkIdType* pointMap, int convertLines,
+                            int convertPolys, int convertStrips,
+                            vtkIdType* updatedPts, vtkIdType& numNewPts)
+{
+  numNewPts = 0;
+  for (vtkIdType i=0; i < npts; i++)
+    {
+    vtkIdType ptId = pointMap[pts[i]];
+    if (kind == CLEAN_VERTS || i == 0 || ptId != updatedPts[numNewPts-1])
+      {
+      updatedPts[numNewPts++] = ptId;
+      }
+    }
+  switch (kind)
+    {
+    case CLEAN_VERTS:
+      return numNewPts > 0 ? CLEAN_VERTS : CLEAN_DROPPED;
+    case CLEAN_LINES:
+      if (numNewPts > 1 || !convertLines)
+        {
+        return CLEAN_LINES;
+        }
+      return numNewPts == 1 ? CLEAN_VERTS : CLEAN_DROPPED;
+    case CLEAN_POLYS:
+      if (numNewPts > 2 && updatedPts[0] == updatedPts[numNewPts-1])
+        {
+        numNewPts--;
+        }
+      if (numNewPts > 2 || !convertPolys)
+        {
+        return CLEAN_POLYS;
+        }
+      if (numNewPts == 2 || !convertLines)
+        {
+        return CLEAN_LINES;
+        }
+      return numNewPts == 1 ? CLEAN_VERTS : CLEAN_DROPPED;
+    default:
+      if (numNewPts > 3 || !convertStrips)
+        {
+        return CLEAN_STRIPS;
+        }
+      if (numNewPts == 3 || !convertPolys)
+        {
+        return CLEAN_POLYS;
+        }
+      if (numNewPts == 2 || !convertLines)
+        {
+        return CLEAN_LINES;
+        }
+      return numNewPts == 1 ? CLEAN_VERTS : CLEAN_DROPPED;
+    }
+}
+
+// The input cells of one kind, with the output location of each cell.
+struct vtkCleanPolyDataCells
+{
+  vtkCellArray* Cells;
+  std::vector<vtkIdType> Offsets; // of each cell in the connectivity
+  std::vector<vtkIdType> FirstCellId; // input id of the first cell
+  std::vector<signed char> OutKind;
+  std::vector<vtkIdType> OutSize;
+  std::vector<vtkIdType> OutCellId; // rank among the output cells of OutKind
+  std::vector<vtkIdType> OutOffset; // in the output connectivity
+};
+
+// Classifies the cells of one kind (first pass), or writes them to the
+// output (second pass, once the output locations are known).
+class vtkCleanPolyDataRewriteCells
+{
+public:
+  vtkCleanPolyDataCells* Cells;
+  int Kind;
+  const vtkIdType* PointMap;
+  int ConvertLines;
+  int ConvertPolys;
+  int ConvertStrips;
+  int MaxCellSize;
+  bool Write;
+  vtkIdType* OutConnectivity[4];
+  vtkIdType OutCellBase[4];
+  vtkCellData* InCD;
+  vtkCellData* OutCD;
+  vtkDataSetAttributes::FieldList* CellList;
+  vtkIdType FirstCellId;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<vtkIdType> updatedPts(this->MaxCellSize > 0 ?
+                                      this->MaxCellSize : 1);
+    const vtkIdType* conn = this->Cells->Cells->GetPointer();
+    vtkIdType numNewPts;
+    for (vtkIdType cellId=begin; cellId < end; cellId++)
+      {
+      const vtkIdType* cell = conn + this->Cells->Offsets[cellId];
+      int outKind = vtkCleanPolyDataMapCell(this->Kind, cell[0], cell + 1,
+        this->PointMap, this->ConvertLines, this->ConvertPolys,
+        this->ConvertStrips, &updatedPts[0], numNewPts);
+      if (!this->Write)
+        {
+        this->Cells->OutKind[cellId] = static_cast<signed char>(outKind);
+        this->Cells->OutSize[cellId] = numNewPts;
+        continue;
+        }
+      if (outKind == CLEAN_DROPPED)
+        {
+        continue;
+        }
+      vtkIdType* out = this->OutConnectivity[outKind] +
+        this->Cells->OutOffset[cellId];
+      *out++ = numNewPts;
+      std::copy(updatedPts.begin(), updatedPts.begin() + numNewPts, out);
+      if (this->OutCD)
+        {
+        this->OutCD->CopyData(*this->CellList, this->InCD, 0,
+                              this->FirstCellId + cellId,
+                              this->OutCellBase[outKind] +
+                              this->Cells->OutCellId[cellId]);
+        }
+      }
+  }
+};
+
+// Copies the coordinates and data of the points used by the output.
+class vtkCleanPolyDataCopyPoints
+{
+public:
+  const vtkIdType* SourceIds;
+  const double* Coords;
+  vtkPoints* OutPoints;
+  vtkPointData* InPD;
+  vtkPointData* OutPD;
+  vtkDataSetAttributes::FieldList* PointList;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType ptId=begin; ptId < end; ptId++)
+      {
+      vtkIdType srcId = this->SourceIds[ptId];
+      this->OutPoints->SetPoint(ptId, this->Coords + 3*srcId);
+      if (this->OutPD)
+        {
+        this->OutPD->CopyData(*this->PointList, this->InPD, 0, srcId, ptId);
+        }
+      }
+  }
+};
+}
+
 //---------------------------------------------------------------------------
 // Specify a spatial locator for speeding the search process. By
 // default an instance of vtkPointLocator is used.
@@ -138,6 +450,27 @@ int vtkCleanPolyData::RequestData(
     vtkDebugMacro(<<"No data to Operate On!");
     return 1;
     }
+
+  // Coincident points can be found by sorting them when they are merged
+  // exactly, i.e. with a vtkMergePoints locator.
+  int outputType = inPts->GetDataType();
+  if (this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
+    {
+    outputType = VTK_FLOAT;
+    }
+  else if (this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+    {
+    outputType = VTK_DOUBLE;
+    }
+  double tol = this->ToleranceIsAbsolute ? this->AbsoluteTolerance :
+    this->Tolerance*input->GetLength();
+  if ( (outputType == VTK_FLOAT || outputType == VTK_DOUBLE) &&
+       (!this->PointMerging ||
+        (tol == 0.0 &&
+         (!this->Locator || this->Locator->IsA("vtkMergePoints")))) )
+    {
+    return this->CleanBySorting(input, output);
+    }
   vtkIdType *updatedPts = new vtkIdType[input->GetMaxCellSize()];
 
   vtkIdType numNewPts;
@@ -594,6 +927,308 @@ int vtkCleanPolyData::RequestData(
   return 1;
 }
 
+//--------------------------------------------------------------------------
+int vtkCleanPolyData::CleanBySorting(vtkPolyData *input, vtkPolyData *output)
+{
+  vtkPoints *inPts = input->GetPoints();
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType ptId;
+  double x[3], newx[3];
+
+  // Operate on the points, and round them to the precision of the output
+  // since that is the precision points are compared at.
+  vtkPoints *newPts = inPts->NewInstance();
+  if(this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
+    {
+    newPts->SetDataType(inPts->GetDataType());
+    }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
+    {
+    newPts->SetDataType(VTK_FLOAT);
+    }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+    {
+    newPts->SetDataType(VTK_DOUBLE);
+    }
+  bool singlePrecision = (newPts->GetDataType() == VTK_FLOAT);
+  std::vector<double> coords(3*numPts);
+  vtkIdType progressInterval = numPts/20 + 1;
+  for (ptId=0; ptId < numPts; ptId++)
+    {
+    if ( !(ptId % progressInterval) && this->GetAbortExecute() )
+      {
+      newPts->Delete();
+      return 1;
+      }
+    inPts->GetPoint(ptId, x);
+    this->OperateOnPoint(x, newx);
+    double* coord = &coords[3*ptId];
+    for (int i=0; i < 3; i++)
+      {
+      coord[i] = singlePrecision ? static_cast<float>(newx[i]) : newx[i];
+      }
+    }
+
+  // Each point is represented by the coincident point with the smallest id,
+  // found by sorting the points.
+  std::vector<vtkIdType> representative(numPts);
+  if (this->PointMerging)
+    {
+    std::vector<vtkIdType> sortedIds;
+    vtkCleanPolyDataSortPoints(&coords[0], numPts, sortedIds);
+    vtkIdType rep = sortedIds[0];
+    for (vtkIdType i=0; i < numPts; i++)
+      {
+      ptId = sortedIds[i];
+      const double* x0 = &coords[3*rep];
+      const double* x1 = &coords[3*ptId];
+      if (x0[0] != x1[0] || x0[1] != x1[1] || x0[2] != x1[2])
+        {
+        rep = ptId;
+        }
+      representative[ptId] = rep;
+      }
+    }
+  else
+    {
+    for (ptId=0; ptId < numPts; ptId++)
+      {
+      representative[ptId] = ptId;
+      }
+    }
+  this->UpdateProgress(0.25);
+  if ( this->GetAbortExecute() )
+    {
+    newPts->Delete();
+    return 1;
+    }
+
+  // Number the output points in the order they are first used by the cells
+  // (verts, lines, polys then strips), as when inserting them in a
+  // locator, and find the offset of each cell.
+  vtkCleanPolyDataCells cells[4];
+  cells[CLEAN_VERTS].Cells = input->GetVerts();
+  cells[CLEAN_LINES].Cells = input->GetLines();
+  cells[CLEAN_POLYS].Cells = input->GetPolys();
+  cells[CLEAN_STRIPS].Cells = input->GetStrips();
+
+  std::vector<vtkIdType> pointMap(numPts, -1);
+  std::vector<vtkIdType> sourceIds;
+  sourceIds.reserve(numPts);
+  int kind;
+  for (kind=0; kind < 4; kind++)
+    {
+    vtkCellArray* cellArray = cells[kind].Cells;
+    vtkIdType numCells = cellArray->GetNumberOfCells();
+    cells[kind].Offsets.resize(numCells);
+    const vtkIdType* conn = cellArray->GetPointer();
+    vtkIdType loc = 0;
+    for (vtkIdType cellId=0; cellId < numCells; cellId++)
+      {
+      cells[kind].Offsets[cellId] = loc;
+      vtkIdType npts = conn[loc++];
+      for (vtkIdType i=0; i < npts; i++, loc++)
+        {
+        vtkIdType rep = representative[conn[loc]];
+        if (pointMap[rep] < 0)
+          {
+          pointMap[rep] = static_cast<vtkIdType>(sourceIds.size());
+          sourceIds.push_back(conn[loc]);
+          }
+        }
+      }
+    }
+  vtkIdType numNewPts = static_cast<vtkIdType>(sourceIds.size());
+  for (ptId=0; ptId < numPts; ptId++)
+    {
+    pointMap[ptId] = pointMap[representative[ptId]];
+    }
+  std::vector<vtkIdType>().swap(representative);
+
+  // Classify the cells, then locate them in the output: the output cells
+  // of each kind keep the order of the input cells.
+  vtkCleanPolyDataRewriteCells rewriter;
+  rewriter.PointMap = &pointMap[0];
+  rewriter.ConvertLines = this->ConvertLinesToPoints;
+  rewriter.ConvertPolys = this->ConvertPolysToLines;
+  rewriter.ConvertStrips = this->ConvertStripsToPolys;
+  rewriter.MaxCellSize = input->GetMaxCellSize();
+  rewriter.Write = false;
+  for (kind=0; kind < 4; kind++)
+    {
+    vtkIdType numCells = cells[kind].Cells->GetNumberOfCells();
+    cells[kind].OutKind.resize(numCells);
+    cells[kind].OutSize.resize(numCells);
+    rewriter.Cells = &cells[kind];
+    rewriter.Kind = kind;
+    vtkSMPTools::For(0, numCells, rewriter);
+    }
+
+  vtkIdType numOutCells[4] = {0, 0, 0, 0};
+  vtkIdType outConnSize[4] = {0, 0, 0, 0};
+  for (kind=0; kind < 4; kind++)
+    {
+    vtkCleanPolyDataCells& kindCells = cells[kind];
+    vtkIdType numCells = kindCells.Cells->GetNumberOfCells();
+    kindCells.OutCellId.resize(numCells);
+    kindCells.OutOffset.resize(numCells);
+    for (vtkIdType cellId=0; cellId < numCells; cellId++)
+      {
+      int outKind = kindCells.OutKind[cellId];
+      if (outKind != CLEAN_DROPPED)
+        {
+        kindCells.OutCellId[cellId] = numOutCells[outKind]++;
+        kindCells.OutOffset[cellId] = outConnSize[outKind];
+        outConnSize[outKind] += kindCells.OutSize[cellId] + 1;
+        }
+      }
+    }
+  this->UpdateProgress(0.5);
+
+  // Allocate the output. The attributes are copied through FieldLists,
+  // which (unlike CopyData(vtkDataSetAttributes*, ...)) can be used
+  // concurrently.
+  vtkPointData *inputPD = input->GetPointData();
+  vtkCellData  *inputCD = input->GetCellData();
+  vtkPointData *outputPD = output->GetPointData();
+  vtkCellData  *outputCD = output->GetCellData();
+  vtkDataSetAttributes::FieldList pointList(1);
+  pointList.InitializeFieldList(inputPD);
+  outputPD->CopyAllocate(pointList, numNewPts);
+  vtkDataSetAttributes::FieldList cellList(1);
+  cellList.InitializeFieldList(inputCD);
+  vtkIdType totalOutCells = numOutCells[0] + numOutCells[1] +
+    numOutCells[2] + numOutCells[3];
+  outputCD->CopyAllocate(cellList, totalOutCells);
+
+  int i;
+  for (i=0; i < outputPD->GetNumberOfArrays(); i++)
+    {
+    outputPD->GetAbstractArray(i)->SetNumberOfTuples(numNewPts);
+    }
+  for (i=0; i < outputCD->GetNumberOfArrays(); i++)
+    {
+    outputCD->GetAbstractArray(i)->SetNumberOfTuples(totalOutCells);
+    }
+  bool threadSafePD = vtkCleanPolyDataIsThreadSafe(inputPD) &&
+    vtkCleanPolyDataIsThreadSafe(outputPD);
+  bool threadSafeCD = vtkCleanPolyDataIsThreadSafe(inputCD) &&
+    vtkCleanPolyDataIsThreadSafe(outputCD);
+
+  newPts->SetNumberOfPoints(numNewPts);
+  vtkCleanPolyDataCopyPoints copier;
+  copier.SourceIds = sourceIds.empty() ? NULL : &sourceIds[0];
+  copier.Coords = &coords[0];
+  copier.OutPoints = newPts;
+  copier.InPD = inputPD;
+  copier.OutPD = threadSafePD ? outputPD : NULL;
+  copier.PointList = &pointList;
+  vtkSMPTools::For(0, numNewPts, copier);
+  if (!threadSafePD)
+    {
+    for (ptId=0; ptId < numNewPts; ptId++)
+      {
+      outputPD->CopyData(pointList, inputPD, 0, sourceIds[ptId], ptId);
+      }
+    }
+
+  vtkCellArray* newCells[4];
+  for (kind=0; kind < 4; kind++)
+    {
+    newCells[kind] = NULL;
+    if (numOutCells[kind] > 0 || cells[kind].Cells->GetNumberOfCells() > 0)
+      {
+      newCells[kind] = vtkCellArray::New();
+      rewriter.OutConnectivity[kind] =
+        newCells[kind]->WritePointer(numOutCells[kind], outConnSize[kind]);
+      }
+    }
+  rewriter.OutCellBase[CLEAN_VERTS] = 0;
+  for (kind=1; kind < 4; kind++)
+    {
+    rewriter.OutCellBase[kind] =
+      rewriter.OutCellBase[kind-1] + numOutCells[kind-1];
+    }
+  rewriter.Write = true;
+  rewriter.InCD = inputCD;
+  rewriter.OutCD = threadSafeCD ? outputCD : NULL;
+  rewriter.CellList = &cellList;
+  rewriter.FirstCellId = 0;
+  for (kind=0; kind < 4; kind++)
+    {
+    this->UpdateProgress(0.5 + 0.125*kind);
+    if ( this->GetAbortExecute() )
+      {
+      // Keep the cells of the kinds that have been written, as the locator
+      // based implementation does.
+      for (int k=kind; k < 4; k++)
+        {
+        if (newCells[k])
+          {
+          newCells[k]->Delete();
+          newCells[k] = NULL;
+          }
+        }
+      for (i=0; i < outputCD->GetNumberOfArrays(); i++)
+        {
+        outputCD->GetAbstractArray(i)->SetNumberOfTuples(
+          rewriter.OutCellBase[kind]);
+        }
+      break;
+      }
+    vtkCleanPolyDataCells& kindCells = cells[kind];
+    vtkIdType numCells = kindCells.Cells->GetNumberOfCells();
+    rewriter.Cells = &kindCells;
+    rewriter.Kind = kind;
+    vtkSMPTools::For(0, numCells, rewriter);
+    if (!threadSafeCD)
+      {
+      for (vtkIdType cellId=0; cellId < numCells; cellId++)
+        {
+        int outKind = kindCells.OutKind[cellId];
+        if (outKind != CLEAN_DROPPED)
+          {
+          outputCD->CopyData(cellList, inputCD, 0,
+                             rewriter.FirstCellId + cellId,
+                             rewriter.OutCellBase[outKind] +
+                             kindCells.OutCellId[cellId]);
+          }
+        }
+      }
+    rewriter.FirstCellId += numCells;
+    }
+
+  vtkDebugMacro(<<"Removed " << numPts - numNewPts << " points");
+
+  output->SetPoints(newPts);
+  newPts->Delete();
+  if (newCells[CLEAN_VERTS])
+    {
+    output->SetVerts(newCells[CLEAN_VERTS]);
+    }
+  if (newCells[CLEAN_LINES])
+    {
+    output->SetLines(newCells[CLEAN_LINES]);
+    }
+  if (newCells[CLEAN_POLYS])
+    {
+    output->SetPolys(newCells[CLEAN_POLYS]);
+    }
+  if (newCells[CLEAN_STRIPS])
+    {
+    output->SetStrips(newCells[CLEAN_STRIPS]);
+    }
+  for (kind=0; kind < 4; kind++)
+    {
+    if (newCells[kind])
+      {
+      newCells[kind]->Delete();
+      }
+    }
+
+  return 1;
+}
+
 //--------------------------------------------------------------------------
 // Method manages creation of locators. It takes into account the potential
 // change of tolerance (zero to non-zero).
@@ -169,6 +169,13 @@ protected:
   virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
   virtual int RequestUpdateExtent(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
 
+  // Description:
+  // Clean the input without a locator, in parallel: coincident points are
+  // found by sorting them and the cells are rewritten concurrently. Used
+  // when points are not merged, or merged exactly (zero tolerance and a
+  // vtkMergePoints locator), which gives the same output as the locator.
+  int CleanBySorting(vtkPolyData *input, vtkPolyData *output);
+
   int   PointMerging;
   double Tolerance;
   double AbsoluteTolerance;
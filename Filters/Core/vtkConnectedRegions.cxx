@@ -0,0 +1,386 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkConnectedRegions.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkConnectedRegions.h"
+
+#include "vtkDataArray.h"
+#include "vtkDataSet.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Flags the cells whose point scalars meet the range. The scalars are
+// compared in single precision, as the connectivity filters always did.
+class vtkConnectedRegionsCriterion
+{
+public:
+  vtkDataSet *Input;
+  vtkDataArray *Scalars;
+  double Range[2];
+  bool Full;
+  unsigned char *Connected;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPoints.Local();
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      this->Input->GetCellPoints(cellId, cellPts);
+      double range[2] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+      for (vtkIdType i = 0; i < cellPts->GetNumberOfIds(); i++)
+        {
+        double s = static_cast<float>(
+          this->Scalars->GetComponent(cellPts->GetId(i), 0));
+        range[0] = std::min(range[0], s);
+        range[1] = std::max(range[1], s);
+        }
+      if (this->Full)
+        {
+        this->Connected[cellId] =
+          (range[0] >= this->Range[0] && range[1] <= this->Range[1]);
+        }
+      else
+        {
+        this->Connected[cellId] =
+          (range[1] >= this->Range[0] && range[0] <= this->Range[1]);
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Flags the cells using one of the seed points.
+class vtkConnectedRegionsSeedPoints
+{
+public:
+  vtkDataSet *Input;
+  const unsigned char *SeedPoints;
+  unsigned char *SeedCells;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPoints.Local();
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      this->Input->GetCellPoints(cellId, cellPts);
+      for (vtkIdType i = 0; i < cellPts->GetNumberOfIds(); i++)
+        {
+        if (this->SeedPoints[cellPts->GetId(i)])
+          {
+          this->SeedCells[cellId] = 1;
+          break;
+          }
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Labels the seed cells, and the connected cells whose set of points was
+// reached by a seed cell.
+class vtkConnectedRegionsSeeded
+{
+public:
+  vtkDataSet *Input;
+  const vtkIdType *Parent;
+  const unsigned char *Connected;
+  const unsigned char *SeedCells;
+  const unsigned char *Reached;
+  vtkIdType *CellRegions;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPoints.Local();
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      bool inRegion = (this->SeedCells[cellId] != 0);
+      if (!inRegion && this->Connected[cellId])
+        {
+        this->Input->GetCellPoints(cellId, cellPts);
+        inRegion = (cellPts->GetNumberOfIds() > 0 &&
+                    this->Reached[this->Parent[cellPts->GetId(0)]]);
+        }
+      this->CellRegions[cellId] = (inRegion ? 0 : -1);
+      }
+  }
+};
+}
+
+//----------------------------------------------------------------------------
+vtkConnectedRegions::vtkConnectedRegions(vtkDataSet *input,
+                                         vtkDataArray *scalars,
+                                         const double range[2], bool full)
+{
+  this->Input = input;
+  this->NumberOfPoints = input->GetNumberOfPoints();
+  this->NumberOfCells = input->GetNumberOfCells();
+  this->PointIds = vtkIdList::New();
+  this->PointIds->Allocate(8);
+
+  // Make sure that the cells are built before accessing them from several
+  // threads.
+  if (this->NumberOfCells > 0)
+    {
+    input->GetCellPoints(0, this->PointIds);
+    }
+
+  this->Connected.resize(this->NumberOfCells, 1);
+  if (scalars && this->NumberOfCells > 0)
+    {
+    vtkConnectedRegionsCriterion criterion;
+    criterion.Input = input;
+    criterion.Scalars = scalars;
+    criterion.Range[0] = range[0];
+    criterion.Range[1] = range[1];
+    criterion.Full = full;
+    criterion.Connected = &this->Connected[0];
+    vtkSMPTools::For(0, this->NumberOfCells, criterion);
+    }
+
+  // Merge the points of each connected cell, then make every point point
+  // to its root.
+  this->Parent.resize(this->NumberOfPoints, -1);
+  for (vtkIdType cellId = 0; cellId < this->NumberOfCells; cellId++)
+    {
+    if (this->Connected[cellId])
+      {
+      input->GetCellPoints(cellId, this->PointIds);
+      vtkIdType npts = this->PointIds->GetNumberOfIds();
+      for (vtkIdType i = 0; i < npts; i++)
+        {
+        vtkIdType ptId = this->PointIds->GetId(i);
+        if (this->Parent[ptId] < 0)
+          {
+          this->Parent[ptId] = ptId;
+          }
+        if (i > 0)
+          {
+          this->Merge(this->PointIds->GetId(0), ptId);
+          }
+        }
+      }
+    }
+  for (vtkIdType ptId = 0; ptId < this->NumberOfPoints; ptId++)
+    {
+    if (this->Parent[ptId] >= 0)
+      {
+      this->Parent[ptId] = this->Parent[this->Parent[ptId]];
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkConnectedRegions::~vtkConnectedRegions()
+{
+  this->PointIds->Delete();
+}
+
+//----------------------------------------------------------------------------
+// The parent of a point is never larger than the point, so that the root of
+// a set is its smallest point. Paths are halved while looking for it.
+vtkIdType vtkConnectedRegions::Find(vtkIdType ptId)
+{
+  while (this->Parent[ptId] != ptId)
+    {
+    this->Parent[ptId] = this->Parent[this->Parent[ptId]];
+    ptId = this->Parent[ptId];
+    }
+  return ptId;
+}
+
+//----------------------------------------------------------------------------
+void vtkConnectedRegions::Merge(vtkIdType ptId1, vtkIdType ptId2)
+{
+  ptId1 = this->Find(ptId1);
+  ptId2 = this->Find(ptId2);
+  if (ptId1 < ptId2)
+    {
+    this->Parent[ptId2] = ptId1;
+    }
+  else
+    {
+    this->Parent[ptId1] = ptId2;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkConnectedRegions::LabelAllRegions(vtkIdType *cellRegions,
+                                               vtkIdTypeArray *regionSizes)
+{
+  // A connected cell gets the region of its set, which is numbered when
+  // first reached. A cell which is not connected starts a new region, to
+  // which the sets of its points not numbered yet belong too.
+  std::vector<vtkIdType> setRegions(this->NumberOfPoints, -1);
+  std::vector<vtkIdType> sizes;
+  for (vtkIdType cellId = 0; cellId < this->NumberOfCells; cellId++)
+    {
+    this->Input->GetCellPoints(cellId, this->PointIds);
+    vtkIdType npts = this->PointIds->GetNumberOfIds();
+    vtkIdType regionId;
+    if (this->Connected[cellId] && npts > 0)
+      {
+      vtkIdType root = this->Parent[this->PointIds->GetId(0)];
+      if (setRegions[root] < 0)
+        {
+        setRegions[root] = static_cast<vtkIdType>(sizes.size());
+        sizes.push_back(0);
+        }
+      regionId = setRegions[root];
+      }
+    else
+      {
+      regionId = static_cast<vtkIdType>(sizes.size());
+      sizes.push_back(0);
+      for (vtkIdType i = 0; i < npts; i++)
+        {
+        vtkIdType root = this->Parent[this->PointIds->GetId(i)];
+        if (root >= 0 && setRegions[root] < 0)
+          {
+          setRegions[root] = regionId;
+          }
+        }
+      }
+    cellRegions[cellId] = regionId;
+    sizes[regionId]++;
+    }
+
+  vtkIdType numRegions = static_cast<vtkIdType>(sizes.size());
+  regionSizes->SetNumberOfValues(numRegions);
+  for (vtkIdType regionId = 0; regionId < numRegions; regionId++)
+    {
+    regionSizes->SetValue(regionId, sizes[regionId]);
+    }
+  return numRegions;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkConnectedRegions::LabelSeededRegion(vtkIdList *seeds,
+                                                 bool pointSeeds,
+                                                 vtkIdType *cellRegions)
+{
+  if (this->NumberOfCells < 1)
+    {
+    return 0;
+    }
+
+  std::vector<unsigned char> seedCells(this->NumberOfCells, 0);
+  if (pointSeeds)
+    {
+    std::vector<unsigned char> seedPoints(this->NumberOfPoints, 0);
+    for (vtkIdType i = 0; i < seeds->GetNumberOfIds(); i++)
+      {
+      vtkIdType ptId = seeds->GetId(i);
+      if (ptId >= 0 && ptId < this->NumberOfPoints)
+        {
+        seedPoints[ptId] = 1;
+        }
+      }
+    vtkConnectedRegionsSeedPoints seedPointCells;
+    seedPointCells.Input = this->Input;
+    seedPointCells.SeedPoints = &seedPoints[0];
+    seedPointCells.SeedCells = &seedCells[0];
+    vtkSMPTools::For(0, this->NumberOfCells, seedPointCells);
+    }
+  else
+    {
+    for (vtkIdType i = 0; i < seeds->GetNumberOfIds(); i++)
+      {
+      vtkIdType cellId = seeds->GetId(i);
+      if (cellId >= 0 && cellId < this->NumberOfCells)
+        {
+        seedCells[cellId] = 1;
+        }
+      }
+    }
+
+  // The sets of the points of the seed cells are in the region.
+  std::vector<unsigned char> reached(this->NumberOfPoints, 0);
+  for (vtkIdType cellId = 0; cellId < this->NumberOfCells; cellId++)
+    {
+    if (seedCells[cellId])
+      {
+      this->Input->GetCellPoints(cellId, this->PointIds);
+      for (vtkIdType i = 0; i < this->PointIds->GetNumberOfIds(); i++)
+        {
+        vtkIdType root = this->Parent[this->PointIds->GetId(i)];
+        if (root >= 0)
+          {
+          reached[root] = 1;
+          }
+        }
+      }
+    }
+
+  vtkConnectedRegionsSeeded label;
+  label.Input = this->Input;
+  label.Parent = &this->Parent[0];
+  label.Connected = &this->Connected[0];
+  label.SeedCells = &seedCells[0];
+  label.Reached = &reached[0];
+  label.CellRegions = cellRegions;
+  vtkSMPTools::For(0, this->NumberOfCells, label);
+
+  return static_cast<vtkIdType>(
+    this->NumberOfCells - std::count(cellRegions,
+                                     cellRegions + this->NumberOfCells, -1));
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkConnectedRegions::MapPoints(const vtkIdType *cellRegions,
+                                         vtkIdType *pointMap,
+                                         vtkIdTypeArray *pointRegions)
+{
+  // Store the smallest region of each point in the map first.
+  std::fill(pointMap, pointMap + this->NumberOfPoints, -1);
+  for (vtkIdType cellId = 0; cellId < this->NumberOfCells; cellId++)
+    {
+    vtkIdType regionId = cellRegions[cellId];
+    if (regionId >= 0)
+      {
+      this->Input->GetCellPoints(cellId, this->PointIds);
+      for (vtkIdType i = 0; i < this->PointIds->GetNumberOfIds(); i++)
+        {
+        vtkIdType &pointRegion = pointMap[this->PointIds->GetId(i)];
+        if (pointRegion < 0 || regionId < pointRegion)
+          {
+          pointRegion = regionId;
+          }
+        }
+      }
+    }
+
+  vtkIdType numMappedPts = 0;
+  for (vtkIdType ptId = 0; ptId < this->NumberOfPoints; ptId++)
+    {
+    vtkIdType regionId = pointMap[ptId];
+    if (regionId >= 0)
+      {
+      pointRegions->SetValue(numMappedPts, regionId);
+      pointMap[ptId] = numMappedPts++;
+      }
+    }
+  return numMappedPts;
+}
@@ -0,0 +1,99 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkConnectedRegions.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkConnectedRegions - A utility class labeling the connected cells of a dataset
+// .SECTION Description
+//  This is a simple utility class used by the connectivity filters to
+//  label the regions of cells sharing points. Instead of growing each
+//  region through the point-cell links, it merges the points of the cells
+//  with a union-find (disjoint set) structure over the points, so that it
+//  only needs one id per point and one flag per cell. The scalar criterion
+//  of the cells and the seeded labeling are computed in parallel (using
+//  vtkSMPTools).
+//
+//  A cell connects to its neighbors through its points if it meets the
+//  scalar criterion. A cell which does not meet it still starts a region
+//  of its own (in the order of the cells) or joins the seeded region,
+//  together with the connected cells using its points.
+// .SECTION See Also
+// vtkConnectivityFilter vtkPolyDataConnectivityFilter
+
+#ifndef __vtkConnectedRegions_h
+#define __vtkConnectedRegions_h
+
+#include "vtkType.h" //for vtkIdType
+
+#include <vector> //for the member variables
+
+class vtkDataArray;
+class vtkDataSet;
+class vtkIdList;
+class vtkIdTypeArray;
+
+class vtkConnectedRegions
+{
+public:
+  // Description:
+  // Merge the points of the connected cells of the input. When scalars are
+  // given, a cell is connected if the scalars of its points (their first
+  // component) meet the range: if their range overlaps it, or if it
+  // contains all of them when full is true.
+  vtkConnectedRegions(vtkDataSet *input, vtkDataArray *scalars,
+                      const double range[2], bool full);
+  ~vtkConnectedRegions();
+
+  // Description:
+  // Label all the cells, the regions being numbered in the order of their
+  // first cell. The region of each cell is stored in cellRegions, and the
+  // number of cells of each region in regionSizes. Return the number of
+  // regions.
+  vtkIdType LabelAllRegions(vtkIdType *cellRegions,
+                            vtkIdTypeArray *regionSizes);
+
+  // Description:
+  // Label with region 0 the seed cells (or the cells using the seed points
+  // when pointSeeds is true) and the cells connected to them, and with -1
+  // the other cells. Invalid seed ids are ignored. Return the number of
+  // cells of the region.
+  vtkIdType LabelSeededRegion(vtkIdList *seeds, bool pointSeeds,
+                              vtkIdType *cellRegions);
+
+  // Description:
+  // Number the points used by the labeled cells in increasing id order
+  // (the other points are mapped to -1), and store in pointRegions, at the
+  // new id of each point, the smallest region of the cells using it.
+  // Return the number of mapped points.
+  vtkIdType MapPoints(const vtkIdType *cellRegions, vtkIdType *pointMap,
+                      vtkIdTypeArray *pointRegions);
+
+private:
+  vtkIdType Find(vtkIdType ptId);
+  void Merge(vtkIdType ptId1, vtkIdType ptId2);
+
+  vtkDataSet *Input;
+  vtkIdType NumberOfPoints;
+  vtkIdType NumberOfCells;
+  vtkIdList *PointIds;
+
+  // The root of the set of each point, which is its smallest point id, or
+  // -1 for the points used by no connected cell.
+  std::vector<vtkIdType> Parent;
+  std::vector<unsigned char> Connected;
+
+  vtkConnectedRegions(const vtkConnectedRegions&);  // Not implemented.
+  void operator=(const vtkConnectedRegions&);  // Not implemented.
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkConnectedRegions.h
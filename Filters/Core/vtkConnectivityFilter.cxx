@@ -16,8 +16,8 @@
 
 #include "vtkCell.h"
 #include "vtkCellData.h"
+#include "vtkConnectedRegions.h"
 #include "vtkDataSet.h"
-#include "vtkFloatArray.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -44,12 +44,6 @@ vtkConnectivityFilter::vtkConnectivityFilter()
 
   this->ClosestPoint[0] = this->ClosestPoint[1] = this->ClosestPoint[2] = 0.0;
 
-  this->CellScalars = vtkFloatArray::New();
-  this->CellScalars->Allocate(8);
-
-  this->NeighborCellPointIds = vtkIdList::New();
-  this->NeighborCellPointIds->Allocate(8);
-
   this->Seeds = vtkIdList::New();
   this->SpecifiedRegionIds = vtkIdList::New();
 
@@ -62,8 +56,6 @@ vtkConnectivityFilter::vtkConnectivityFilter()
 vtkConnectivityFilter::~vtkConnectivityFilter()
 {
   this->RegionSizes->Delete();
-  this->CellScalars->Delete();
-  this->NeighborCellPointIds->Delete();
   this->Seeds->Delete();
   this->SpecifiedRegionIds->Delete();
 }
@@ -83,11 +75,11 @@ int vtkConnectivityFilter::RequestData(
   vtkUnstructuredGrid *output = vtkUnstructuredGrid::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType numPts, numCells, cellId, newCellId, i, j, pt;
+  vtkIdType numPts, numCells, cellId, newCellId, i;
   vtkPoints *newPts;
   int id;
-  int maxCellsInRegion;
-  int largestRegionId = 0;
+  vtkIdType maxCellsInRegion;
+  vtkIdType largestRegionId = 0;
   vtkPointData *pd=input->GetPointData(), *outputPD=output->GetPointData();
   vtkCellData *cd=input->GetCellData(), *outputCD=output->GetCellData();
 
@@ -122,15 +114,7 @@ int vtkConnectivityFilter::RequestData(
   //
   this->RegionSizes->Reset();
   this->Visited = new vtkIdType[numCells];
-  for ( i=0; i < numCells; i++ )
-    {
-    this->Visited[i] = -1;
-    }
   this->PointMap = new vtkIdType[numPts];
-  for ( i=0; i < numPts; i++ )
-    {
-    this->PointMap[i] = -1;
-    }
 
   this->NewScalars = vtkIdTypeArray::New();
   this->NewScalars->SetName("RegionId");
@@ -166,21 +150,17 @@ int vtkConnectivityFilter::RequestData(
 
   newPts->Allocate(numPts);
 
-  // Traverse all cells marking those visited.  Each new search
-  // starts a new connected region. Connected region grows
-  // using a connected wave propagation.
+  // Merge the points of the connected cells into sets. Each region holds
+  // the sets reached from its first cell (or from the seeds).
   //
-  this->Wave = vtkIdList::New();
-  this->Wave->Allocate(numPts/4+1,numPts);
-  this->Wave2 = vtkIdList::New();
-  this->Wave2->Allocate(numPts/4+1,numPts);
+  vtkConnectedRegions regions(input, this->InScalars, this->ScalarRange,
+                              false);
+  this->UpdateProgress (0.5);
 
   this->PointNumber = 0;
   this->RegionNumber = 0;
   maxCellsInRegion = 0;
 
-  this->CellIds = vtkIdList::New();
-  this->CellIds->Allocate(8, VTK_CELL_SIZE);
   this->PointIds = vtkIdList::New();
   this->PointIds->Allocate(8, VTK_CELL_SIZE);
 
@@ -188,61 +168,30 @@ int vtkConnectivityFilter::RequestData(
   this->ExtractionMode != VTK_EXTRACT_CELL_SEEDED_REGIONS &&
   this->ExtractionMode != VTK_EXTRACT_CLOSEST_POINT_REGION )
     { //visit all cells marking with region number
-    for (cellId=0; cellId < numCells; cellId++)
+    this->RegionNumber = regions.LabelAllRegions(this->Visited,
+                                                 this->RegionSizes);
+    for (i=0; i < this->RegionNumber; i++)
       {
-      if ( cellId && !(cellId % 5000) )
+      if ( this->RegionSizes->GetValue(i) > maxCellsInRegion )
         {
-        this->UpdateProgress (0.1 + 0.8*cellId/numCells);
-        }
-
-      if ( this->Visited[cellId] < 0 )
-        {
-        this->NumCellsInRegion = 0;
-        this->Wave->InsertNextId(cellId);
-        this->TraverseAndMark (input);
-
-        if ( this->NumCellsInRegion > maxCellsInRegion )
-          {
-          maxCellsInRegion = this->NumCellsInRegion;
-          largestRegionId = this->RegionNumber;
-          }
-
-        this->RegionSizes->InsertValue(this->RegionNumber++,
-                                       this->NumCellsInRegion);
-        this->Wave->Reset();
-        this->Wave2->Reset();
+        maxCellsInRegion = this->RegionSizes->GetValue(i);
+        largestRegionId = i;
         }
       }
     }
   else // regions have been seeded, everything considered in same region
     {
-    this->NumCellsInRegion = 0;
+    vtkIdType numCellsInRegion = 0;
 
     if ( this->ExtractionMode == VTK_EXTRACT_POINT_SEEDED_REGIONS )
       {
-      for (i=0; i < this->Seeds->GetNumberOfIds(); i++)
-        {
-        pt = this->Seeds->GetId(i);
-        if ( pt >= 0 )
-          {
-          input->GetPointCells(pt,this->CellIds);
-          for (j=0; j < this->CellIds->GetNumberOfIds(); j++)
-            {
-            this->Wave->InsertNextId(this->CellIds->GetId(j));
-            }
-          }
-        }
+      numCellsInRegion = regions.LabelSeededRegion(this->Seeds, true,
+                                                   this->Visited);
       }
     else if ( this->ExtractionMode == VTK_EXTRACT_CELL_SEEDED_REGIONS )
       {
-      for (i=0; i < this->Seeds->GetNumberOfIds(); i++)
-        {
-        cellId = this->Seeds->GetId(i);
-        if ( cellId >= 0 )
-          {
-          this->Wave->InsertNextId(cellId);
-          }
-        }
+      numCellsInRegion = regions.LabelSeededRegion(this->Seeds, false,
+                                                   this->Visited);
       }
     else if ( this->ExtractionMode == VTK_EXTRACT_CLOSEST_POINT_REGION )
       {//loop over points, find closest one
@@ -258,23 +207,28 @@ int vtkConnectivityFilter::RequestData(
           minDist2 = dist2;
           }
         }
-      input->GetPointCells(minId,this->CellIds);
-      for (j=0; j < this->CellIds->GetNumberOfIds(); j++)
-        {
-        this->Wave->InsertNextId(this->CellIds->GetId(j));
-        }
+      vtkIdList *closestPointSeed = vtkIdList::New();
+      closestPointSeed->InsertNextId(minId);
+      numCellsInRegion = regions.LabelSeededRegion(closestPointSeed, true,
+                                                   this->Visited);
+      closestPointSeed->Delete();
       }
-    this->UpdateProgress (0.5);
 
-    //mark all seeded regions
-    this->TraverseAndMark (input);
-    this->RegionSizes->InsertValue(this->RegionNumber,this->NumCellsInRegion);
-    this->UpdateProgress (0.9);
+    this->RegionSizes->InsertValue(this->RegionNumber,numCellsInRegion);
+    }
+  this->UpdateProgress (0.8);
+
+  // Number the points of the visited cells, and send down the region ids.
+  //
+  this->PointNumber = regions.MapPoints(this->Visited, this->PointMap,
+                                        this->NewScalars);
+  for (cellId=0; cellId < numCells; cellId++)
+    {
+    this->NewCellScalars->SetValue(cellId, this->Visited[cellId]);
     }
+  this->UpdateProgress (0.9);
 
   vtkDebugMacro (<<"Extracted " << this->RegionNumber << " region(s)");
-  this->Wave->Delete();
-  this->Wave2->Delete();
 
   // Now that points and cells have been marked, traverse these lists pulling
   // everything that has been visited.
@@ -417,7 +371,6 @@ int vtkConnectivityFilter::RequestData(
   delete [] this->Visited;
   delete [] this->PointMap;
   this->PointIds->Delete();
-  this->CellIds->Delete();
   output->Squeeze();
   vtkDataArray* outScalars = 0;
   if (this->ColorRegions && (outScalars=output->GetPointData()->GetScalars()))
@@ -438,91 +391,12 @@ int vtkConnectivityFilter::RequestData(
   return 1;
 }
 
-
-// Mark current cell as visited and assign region number.  Note:
-// traversal occurs across shared vertices.
-//
-void vtkConnectivityFilter::TraverseAndMark (vtkDataSet *input)
+#ifndef VTK_LEGACY_REMOVE
+void vtkConnectivityFilter::TraverseAndMark(vtkDataSet *)
 {
-  vtkIdType i, j, k, cellId, numIds, ptId, numPts, numCells;
-  vtkIdList *tmpWave;
-
-  while ( (numIds=this->Wave->GetNumberOfIds()) > 0 )
-    {
-    for ( i=0; i < numIds; i++ )
-      {
-      cellId = this->Wave->GetId(i);
-      if ( this->Visited[cellId] < 0 )
-        {
-        this->NewCellScalars->SetValue(cellId, this->RegionNumber);
-        this->Visited[cellId] = this->RegionNumber;
-        this->NumCellsInRegion++;
-        input->GetCellPoints(cellId, this->PointIds);
-
-        numPts = this->PointIds->GetNumberOfIds();
-        for (j=0; j < numPts; j++)
-          {
-          if ( this->PointMap[ptId=this->PointIds->GetId(j)] < 0 )
-            {
-            this->PointMap[ptId] = this->PointNumber++;
-            this->NewScalars->SetValue(this->PointMap[ptId],
-                                       this->RegionNumber);
-            }
-
-          input->GetPointCells(ptId,this->CellIds);
-
-          // check connectivity criterion (geometric + scalar)
-          numCells = this->CellIds->GetNumberOfIds();
-          for (k=0; k < numCells; k++)
-            {
-            cellId = this->CellIds->GetId(k);
-            if ( this->InScalars )
-              {
-              int numScalars, ii;
-              double s, range[2];
-
-              input->GetCellPoints(cellId, this->NeighborCellPointIds);
-              numScalars = this->NeighborCellPointIds->GetNumberOfIds();
-              this->CellScalars->SetNumberOfComponents(this->InScalars->GetNumberOfComponents());
-              this->CellScalars->SetNumberOfTuples(numScalars);
-              this->InScalars->GetTuples(this->NeighborCellPointIds,
-                                         this->CellScalars);
-              range[0] = VTK_DOUBLE_MAX; range[1] = -VTK_DOUBLE_MAX;
-              for (ii=0; ii < numScalars;  ii++)
-                {
-                s = this->CellScalars->GetComponent(ii,0);
-                if ( s < range[0] )
-                  {
-                  range[0] = s;
-                  }
-                if ( s > range[1] )
-                  {
-                  range[1] = s;
-                  }
-                }
-              if ( range[1] >= this->ScalarRange[0] &&
-                   range[0] <= this->ScalarRange[1] )
-                {
-                this->Wave2->InsertNextId(cellId);
-                }
-              }
-            else
-              {
-              this->Wave2->InsertNextId(cellId);
-              }
-            }//for all cells using this point
-          }//for all points of this cell
-        }//if cell not yet visited
-      }//for all cells in this wave
-
-    tmpWave = this->Wave;
-    this->Wave = this->Wave2;
-    this->Wave2 = tmpWave;
-    tmpWave->Reset();
-    } //while wave is not empty
-
-  return;
+  VTK_LEGACY_BODY(vtkConnectivityFilter::TraverseAndMark, "VTK 6.2");
 }
+#endif
 
 // Obtain the number of connected regions.
 int vtkConnectivityFilter::GetNumberOfExtractedRegions()
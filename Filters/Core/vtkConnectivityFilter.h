@@ -40,6 +40,10 @@
 // connectivity will pull out all voxels "containing" the anatomical
 // structure. These voxels can then be contoured or processed by other
 // visualization filters.
+//
+// The regions are labeled by vtkConnectedRegions, so the point-cell links
+// of the input dataset are not built, which matters for large volumes. The
+// output points keep the order of the input points.
 
 // .SECTION See Also
 // vtkPolyDataConnectivityFilter
@@ -58,7 +62,6 @@
 #define VTK_EXTRACT_CLOSEST_POINT_REGION 6
 
 class vtkDataArray;
-class vtkFloatArray;
 class vtkIdList;
 class vtkIdTypeArray;
 class vtkIntArray;
@@ -172,24 +175,21 @@ protected:
   int ScalarConnectivity;
   double ScalarRange[2];
 
-  void TraverseAndMark(vtkDataSet *input);
+  // Description:
+  // Deprecated: the regions are now labeled by vtkConnectedRegions, and
+  // this method does nothing.
+  VTK_LEGACY(void TraverseAndMark(vtkDataSet *input));
 
 private:
   // used to support algorithm execution
-  vtkFloatArray *CellScalars;
-  vtkIdList *NeighborCellPointIds;
   vtkIdType *Visited;
   vtkIdType *PointMap;
   vtkIdTypeArray *NewScalars;
   vtkIdTypeArray *NewCellScalars;
   vtkIdType RegionNumber;
   vtkIdType PointNumber;
-  vtkIdType NumCellsInRegion;
   vtkDataArray *InScalars;
-  vtkIdList *Wave;
-  vtkIdList *Wave2;
   vtkIdList *PointIds;
-  vtkIdList *CellIds;
 private:
   vtkConnectivityFilter(const vtkConnectivityFilter&);  // Not implemented.
   void operator=(const vtkConnectivityFilter&);  // Not implemented.
@@ -0,0 +1,49 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkDataArrayRound.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkDataArrayRound - Convert an interpolated value to an array type.
+// .SECTION Description
+// vtkDataArrayRound() converts a value computed in double precision, such
+// as an average of tuples, to the value type of an array. Integer types are
+// clamped to their range and rounded, as vtkDataArray::InterpolateTuple()
+// does; floating point types are not rounded. This header is private to
+// the filters that average attributes and is not installed.
+
+#ifndef __vtkDataArrayRound_h
+#define __vtkDataArrayRound_h
+
+#include "vtkTypeTraits.h"
+
+#include <algorithm>
+
+template <class T>
+inline void vtkDataArrayRound(double val, T* retVal)
+{
+  val = std::max(val, static_cast<double>(vtkTypeTraits<T>::Min()));
+  val = std::min(val, static_cast<double>(vtkTypeTraits<T>::Max()));
+  *retVal = static_cast<T>((val>=0.0)?(val + 0.5):(val - 0.5));
+}
+
+inline void vtkDataArrayRound(double val, double* retVal)
+{
+  *retVal = val;
+}
+
+inline void vtkDataArrayRound(double val, float* retVal)
+{
+  *retVal = static_cast<float>(val);
+}
+
+#endif
+// VTK-HeaderTest-Exclude: vtkDataArrayRound.h
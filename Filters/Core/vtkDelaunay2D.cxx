@@ -25,6 +25,7 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSpatialSort.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTriangle.h"
 #include "vtkTransform.h"
@@ -42,6 +43,7 @@ vtkDelaunay2D::vtkDelaunay2D()
   this->Offset = 1.0;
   this->Transform = NULL;
   this->ProjectionPlaneMode = VTK_DELAUNAY_XY_PLANE;
+  this->SpatialSort = 0;
 
   // optional 2nd input
   this->SetNumberOfInputPorts(2);
@@ -295,7 +297,7 @@ int vtkDelaunay2D::RequestData(
   vtkPolyData *output = vtkPolyData::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType numPoints, i;
+  vtkIdType numPoints, i, insertId;
   vtkIdType numTriangles = 0;
   vtkIdType ptId, tri[4], nei[3];
   vtkIdType p1 = 0;
@@ -317,6 +319,7 @@ int vtkDelaunay2D::RequestData(
   double n1[3], n2[3];
   int *triUse = NULL;
   double *bounds;
+  vtkIdList *order = NULL;
 
   vtkDebugMacro(<<"Generating 2D Delaunay triangulation");
 
@@ -399,6 +402,14 @@ int vtkDelaunay2D::RequestData(
     tPoints = NULL;
     }
 
+  // Insert the points in a spatially coherent order, so that each point is
+  // found by a short walk from the triangle of the previous one.
+  if (this->SpatialSort)
+    {
+    order = vtkIdList::New();
+    vtkSpatialSort::BRIOSort(points, 2, order);
+    }
+
   bounds = points->GetBounds();
   center[0] = (bounds[0]+bounds[1])/2.0;
   center[1] = (bounds[2]+bounds[3])/2.0;
@@ -447,8 +458,9 @@ int vtkDelaunay2D::RequestData(
   // satisfy criterion have their edges swapped. This continues recursively
   // until all triangles have been shown to be Delaunay.
   //
-  for (ptId=0; ptId < numPoints; ptId++)
+  for (insertId=0; insertId < numPoints; insertId++)
     {
+    ptId = (order ? order->GetId(insertId) : insertId);
     this->GetPoint(ptId,x);
     nei[0] = (-1); //where we are coming from...nowhere initially
 
@@ -526,13 +538,15 @@ int vtkDelaunay2D::RequestData(
 
     else
       {
-      tri[0] = 0; //no triangle found
+      // no triangle found; with sorted points, the next walk starts from
+      // one of the last triangles created rather than from the first one
+      tri[0] = (order ? this->Mesh->GetNumberOfCells() - 1 : 0);
       }
 
-    if ( ! (ptId % 1000) )
+    if ( ! (insertId % 1000) )
       {
       vtkDebugMacro(<<"point #" << ptId);
-      this->UpdateProgress (static_cast<double>(ptId)/numPoints);
+      this->UpdateProgress (static_cast<double>(insertId)/numPoints);
       if (this->GetAbortExecute())
         {
         break;
@@ -541,6 +555,11 @@ int vtkDelaunay2D::RequestData(
 
     }//for all points
 
+  if (order)
+    {
+    order->Delete();
+    }
+
   vtkDebugMacro(<<"Triangulated " << numPoints <<" points, "
                 << this->NumberOfDuplicatePoints
                 << " of which were duplicates");
@@ -1459,4 +1478,6 @@ void vtkDelaunay2D::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Offset: " << this->Offset << "\n";
   os << indent << "Bounding Triangulation: "
      << (this->BoundingTriangulation ? "On\n" : "Off\n");
+  os << indent << "Spatial Sort: "
+     << (this->SpatialSort ? "On\n" : "Off\n");
 }
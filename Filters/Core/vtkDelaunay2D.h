@@ -113,6 +113,11 @@
 // multiplier used to control the size of the initial triangulation. The
 // larger the offset value, the more likely you will generate a convex hull;
 // but the more likely you are to see numerical problems.
+//
+// The points are inserted one at a time into a single mesh, so the
+// triangulation itself is serial, even with SpatialSort on (only the
+// ordering of the points is computed in parallel). There is no parallel
+// divide-and-conquer triangulation.
 
 // .SECTION See Also
 // vtkDelaunay3D vtkTransformFilter vtkGaussianSplatter
@@ -196,6 +201,18 @@ public:
   vtkGetMacro(BoundingTriangulation,int);
   vtkBooleanMacro(BoundingTriangulation,int);
 
+  // Description:
+  // Boolean controls whether the points are inserted in a spatially coherent
+  // order (a biased randomized insertion order sorted along a Hilbert
+  // curve, see vtkSpatialSort) instead of the order of the input. The
+  // search of the triangle containing each point then starts close to it, which
+  // speeds up the triangulation of large unorganized point sets. (Points
+  // arranged on a regular lattice may then be triangulated differently.)
+  // Off by default.
+  vtkSetMacro(SpatialSort,int);
+  vtkGetMacro(SpatialSort,int);
+  vtkBooleanMacro(SpatialSort,int);
+
   // Description:
   // Set / get the transform which is applied to points to generate a
   // 2D problem.  This maps a 3D dataset into a 2D dataset where
@@ -226,6 +243,7 @@ protected:
   double Tolerance;
   int BoundingTriangulation;
   double Offset;
+  int SpatialSort;
 
   vtkAbstractTransform *Transform;
 
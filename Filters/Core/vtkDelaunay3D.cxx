@@ -23,6 +23,7 @@
 #include "vtkPointData.h"
 #include "vtkPointLocator.h"
 #include "vtkPolyData.h"
+#include "vtkSpatialSort.h"
 #include "vtkTetra.h"
 #include "vtkTriangle.h"
 #include "vtkUnstructuredGrid.h"
@@ -146,6 +147,7 @@ vtkDelaunay3D::vtkDelaunay3D()
   this->BoundingTriangulation = 0;
   this->Offset = 2.5;
   this->OutputPointsPrecision = DEFAULT_PRECISION;
+  this->SpatialSort = 0;
   this->Locator = NULL;
   this->TetraArray = NULL;
 
@@ -435,7 +437,7 @@ int vtkDelaunay3D::RequestData(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
   vtkIdType numPoints, numTetras, i;
-  vtkIdType ptId;
+  vtkIdType ptId, insertId;
   vtkPoints *inPoints;
   vtkPoints *points;
   vtkUnstructuredGrid *Mesh;
@@ -443,6 +445,7 @@ int vtkDelaunay3D::RequestData(
   vtkIdType npts;
   vtkIdType *tetraPts, pts[4];
   vtkIdList *cells, *holeTetras;
+  vtkIdList *order = NULL;
   double center[3], tol;
   char *tetraUse;
 
@@ -493,16 +496,24 @@ int vtkDelaunay3D::RequestData(
   // of tetra cause tetra to be deleted, leaving a void with bounding
   // faces. Combination of point and each face is used to form new
   // tetrahedra.
-  for (ptId=0; ptId < numPoints; ptId++)
+  // With a spatially coherent order, the tetrahedra around the closest
+  // inserted point are close to the point to insert.
+  if (this->SpatialSort)
     {
+    order = vtkIdList::New();
+    vtkSpatialSort::BRIOSort(inPoints, 3, order);
+    }
+  for (insertId=0; insertId < numPoints; insertId++)
+    {
+    ptId = (order ? order->GetId(insertId) : insertId);
     inPoints->GetPoint(ptId,x);
 
     this->InsertPoint(Mesh, points, ptId, x, holeTetras);
 
-    if ( ! (ptId % 250) )
+    if ( ! (insertId % 250) )
       {
       vtkDebugMacro(<<"point #" << ptId);
-      this->UpdateProgress (static_cast<double>(ptId)/numPoints);
+      this->UpdateProgress (static_cast<double>(insertId)/numPoints);
       if (this->GetAbortExecute())
         {
         break;
@@ -511,6 +522,11 @@ int vtkDelaunay3D::RequestData(
 
     }//for all points
 
+  if (order)
+    {
+    order->Delete();
+    }
+
   this->EndPointInsertion();
 
   vtkDebugMacro(<<"Triangulated " << numPoints <<" points, "
@@ -1045,6 +1061,8 @@ void vtkDelaunay3D::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Offset: " << this->Offset << "\n";
   os << indent << "Bounding Triangulation: "
      << (this->BoundingTriangulation ? "On\n" : "Off\n");
+  os << indent << "Spatial Sort: "
+     << (this->SpatialSort ? "On\n" : "Off\n");
 
   if ( this->Locator )
     {
@@ -166,6 +166,18 @@ public:
   vtkGetMacro(BoundingTriangulation,int);
   vtkBooleanMacro(BoundingTriangulation,int);
 
+  // Description:
+  // Boolean controls whether the points are inserted in a spatially coherent
+  // order (a biased randomized insertion order sorted along a Hilbert
+  // curve, see vtkSpatialSort) instead of the order of the input. The
+  // search of the tetrahedron containing each point then starts close to it, which
+  // speeds up the triangulation of large unorganized point sets. (Points
+  // arranged on a regular lattice may then be triangulated differently.)
+  // Off by default.
+  vtkSetMacro(SpatialSort,int);
+  vtkGetMacro(SpatialSort,int);
+  vtkBooleanMacro(SpatialSort,int);
+
   // Description:
   // Set / get a spatial locator for merging points. By default,
   // an instance of vtkPointLocator is used.
@@ -235,6 +247,7 @@ protected:
   double Tolerance;
   int BoundingTriangulation;
   double Offset;
+  int SpatialSort;
   int OutputPointsPrecision;
 
   vtkIncrementalPointLocator *Locator;  //help locate points faster
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkGlyph3D.h"
 
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCell.h"
 #include "vtkFloatArray.h"
@@ -26,6 +27,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
@@ -33,9 +35,392 @@
 #include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkGlyph3D);
 vtkCxxSetObjectMacro(vtkGlyph3D, SourceTransform, vtkTransform);
 
+namespace
+{
+// Return true if tuples of the array can be read and written concurrently
+// (at distinct tuples for writing).
+bool vtkGlyph3DIsThreadSafe(vtkAbstractArray* array)
+{
+  return vtkDataArray::SafeDownCast(array) &&
+    array->GetDataType() != VTK_BIT && array->HasStandardMemoryLayout();
+}
+
+// What the generated scalars hold.
+enum
+{
+  GLYPH_SCALARS_NONE = 0,
+  GLYPH_SCALARS_SCALE,
+  GLYPH_SCALARS_COPY,
+  GLYPH_SCALARS_MAGNITUDE
+};
+
+// The geometry of a source, converted to doubles once (with the source
+// transform applied) for all the glyphs that use it.
+struct vtkGlyph3DSourceData
+{
+  vtkGlyph3DSourceData()
+    : Source(NULL), NumberOfPoints(0), NumberOfCells(0),
+      NumberOfTCoordComponents(0), Cells(NULL), CellsKind(-1),
+      NumberOfCellsKinds(0) {}
+
+  vtkPolyData* Source;
+  vtkIdType NumberOfPoints;
+  vtkIdType NumberOfCells;
+  std::vector<double> Points;
+  std::vector<double> Normals;
+  std::vector<double> TCoords;
+  int NumberOfTCoordComponents;
+  vtkCellArray* Cells; // verts, lines, polys or strips, if not mixed
+  int CellsKind;
+  int NumberOfCellsKinds;
+};
+
+void vtkGlyph3DPrepareSource(vtkPolyData* source, vtkTransform* transform,
+                             bool normals, bool tcoords,
+                             vtkGlyph3DSourceData& data)
+{
+  data.Source = source;
+  data.NumberOfPoints = source->GetNumberOfPoints();
+  data.NumberOfCells = source->GetNumberOfCells();
+
+  vtkPoints* points = source->GetPoints();
+  vtkNew<vtkPoints> transformedPoints;
+  if (transform && points)
+    {
+    transformedPoints->SetDataTypeToDouble();
+    transform->TransformPoints(points, transformedPoints.GetPointer());
+    points = transformedPoints.GetPointer();
+    }
+  data.Points.resize(3*data.NumberOfPoints);
+  for (vtkIdType i=0; i < data.NumberOfPoints; i++)
+    {
+    points->GetPoint(i, &data.Points[3*i]);
+    }
+
+  vtkDataArray* sourceNormals = source->GetPointData()->GetNormals();
+  if (normals && sourceNormals)
+    {
+    data.Normals.resize(3*data.NumberOfPoints);
+    for (vtkIdType i=0; i < data.NumberOfPoints; i++)
+      {
+      double* n = &data.Normals[3*i];
+      n[0] = n[1] = n[2] = 0.0;
+      sourceNormals->GetTuple(i, n);
+      }
+    }
+
+  vtkDataArray* sourceTCoords = source->GetPointData()->GetTCoords();
+  if (tcoords && sourceTCoords)
+    {
+    int numComps = sourceTCoords->GetNumberOfComponents();
+    data.NumberOfTCoordComponents = numComps;
+    data.TCoords.resize(numComps*data.NumberOfPoints);
+    for (vtkIdType i=0; i < data.NumberOfPoints; i++)
+      {
+      sourceTCoords->GetTuple(i, &data.TCoords[numComps*i]);
+      }
+    }
+
+  vtkCellArray* cellArrays[4] = { source->GetVerts(), source->GetLines(),
+                                  source->GetPolys(), source->GetStrips() };
+  for (int i=0; i < 4; i++)
+    {
+    if (cellArrays[i]->GetNumberOfCells() > 0)
+      {
+      data.Cells = cellArrays[i];
+      data.CellsKind = i;
+      data.NumberOfCellsKinds++;
+      }
+    }
+}
+
+// Generates the glyphs of a range of the points to glyph. Each glyph gets
+// its own block of output points, cells and connectivity, located from
+// offsets computed beforehand, so that all the output arrays can be sized
+// up front and written concurrently. The transform of each glyph
+// (orientation, scale and translation) is computed directly as a 3x4
+// matrix and applied to the source geometry in doubles.
+class vtkGlyph3DGlyphPoints
+{
+public:
+  vtkGlyph3D* Self;
+  vtkDataSet* Input;
+  const vtkIdType* GlyphPoints;
+  const int* GlyphSources; // the source of each glyph, NULL for source 0
+  const vtkIdType* PointOffsets;
+  const vtkIdType* CellOffsets;
+  const vtkIdType* ConnectivityOffsets;
+  const vtkGlyph3DSourceData* Sources;
+  vtkDataArray* ScaleScalars;
+  vtkDataArray* ColorScalars;
+  vtkDataArray* Vectors;
+  double Den;
+
+  float* OutPoints;
+  float* OutNormals;
+  float* OutVectors;
+  float* OutTCoords;
+  int ScalarsMode;
+  vtkDataArray* OutScalars;
+  float* OutScalarValues;
+  vtkIdType* OutPointIds;
+  vtkIdType* OutConnectivity; // NULL when the cells are inserted serially
+
+  vtkPointData* InPD;
+  vtkPointData* OutPD;
+  vtkCellData* OutCD;
+  vtkDataSetAttributes::FieldList* PointList;
+  vtkDataSetAttributes::FieldList* CellList;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double x[3], v[3], vMag = 0.0, s = 0.0, scale[3], n[3], m[3][4];
+    double range[2];
+    this->Self->GetRange(range);
+    const int scaleMode = this->Self->GetScaleMode();
+    v[0] = v[1] = v[2] = 0.0;
+
+    for (vtkIdType glyphId=begin; glyphId < end; glyphId++)
+      {
+      vtkIdType inPtId = this->GlyphPoints[glyphId];
+      const vtkGlyph3DSourceData& source =
+        this->Sources[this->GlyphSources ? this->GlyphSources[glyphId] : 0];
+      const vtkIdType numPts = source.NumberOfPoints;
+      const vtkIdType numCells = source.NumberOfCells;
+      vtkIdType ptIncr = this->PointOffsets[glyphId];
+      vtkIdType cellIncr = this->CellOffsets[glyphId];
+
+      // Get the scalar and vector data
+      scale[0] = scale[1] = scale[2] = 1.0;
+      if (this->ScaleScalars)
+        {
+        s = this->ScaleScalars->GetComponent(inPtId, 0);
+        if (scaleMode == VTK_SCALE_BY_SCALAR ||
+            scaleMode == VTK_DATA_SCALING_OFF)
+          {
+          scale[0] = scale[1] = scale[2] = s;
+          }
+        }
+      if (this->Vectors)
+        {
+        v[0] = v[1] = v[2] = 0.0;
+        this->Vectors->GetTuple(inPtId, v);
+        vMag = vtkMath::Norm(v);
+        if (scaleMode == VTK_SCALE_BY_VECTORCOMPONENTS)
+          {
+          scale[0] = v[0];
+          scale[1] = v[1];
+          scale[2] = v[2];
+          }
+        else if (scaleMode == VTK_SCALE_BY_VECTOR)
+          {
+          scale[0] = scale[1] = scale[2] = vMag;
+          }
+        }
+
+      // Clamp data scale if enabled
+      if (this->Self->GetClamping())
+        {
+        for (int i=0; i < 3; i++)
+          {
+          scale[i] = (scale[i] < range[0] ? range[0] :
+                      (scale[i] > range[1] ? range[1] : scale[i]));
+          scale[i] = (scale[i] - range[0]) / this->Den;
+          }
+        }
+
+      // Generated scalars, set before the scale factor is applied.
+      switch (this->ScalarsMode)
+        {
+        case GLYPH_SCALARS_SCALE:
+          std::fill(this->OutScalarValues + ptIncr,
+                    this->OutScalarValues + ptIncr + numPts,
+                    static_cast<float>(scale[0]));
+          break;
+        case GLYPH_SCALARS_COPY:
+          for (vtkIdType i=0; i < numPts; i++)
+            {
+            this->OutScalars->SetTuple(ptIncr+i, inPtId, this->ColorScalars);
+            }
+          break;
+        case GLYPH_SCALARS_MAGNITUDE:
+          std::fill(this->OutScalarValues + ptIncr,
+                    this->OutScalarValues + ptIncr + numPts,
+                    static_cast<float>(vMag));
+          break;
+        }
+
+      // scale data if appropriate
+      if (this->Self->GetScaling())
+        {
+        for (int i=0; i < 3; i++)
+          {
+          if (scaleMode == VTK_DATA_SCALING_OFF)
+            {
+            scale[i] = this->Self->GetScaleFactor();
+            }
+          else
+            {
+            scale[i] *= this->Self->GetScaleFactor();
+            }
+          if (scale[i] == 0.0)
+            {
+            scale[i] = 1.0e-10;
+            }
+          }
+        }
+      else
+        {
+        scale[0] = scale[1] = scale[2] = 1.0;
+        }
+
+      // Rotation by 180 degrees about the bisector of the x axis and the
+      // vector: R = 2 n n^T - I.
+      double r[3][3] = { {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0} };
+      if (this->Vectors && this->Self->GetOrient() && vMag > 0.0)
+        {
+        if (v[1] == 0.0 && v[2] == 0.0)
+          {
+          if (v[0] < 0.0)
+            {
+            r[0][0] = r[2][2] = -1.0;
+            }
+          }
+        else
+          {
+          n[0] = (v[0] + vMag) / 2.0;
+          n[1] = v[1] / 2.0;
+          n[2] = v[2] / 2.0;
+          vtkMath::Normalize(n);
+          for (int i=0; i < 3; i++)
+            {
+            for (int j=0; j < 3; j++)
+              {
+              r[i][j] = 2.0 * n[i] * n[j] - (i == j ? 1.0 : 0.0);
+              }
+            }
+          }
+        }
+
+      this->Input->GetPoint(inPtId, x);
+      for (int i=0; i < 3; i++)
+        {
+        for (int j=0; j < 3; j++)
+          {
+          m[i][j] = r[i][j] * scale[j];
+          }
+        m[i][3] = x[i];
+        }
+
+      // Points
+      const double* p = (numPts > 0 ? &source.Points[0] : NULL);
+      float* outP = this->OutPoints + 3*ptIncr;
+      for (vtkIdType i=0; i < numPts; i++, p += 3, outP += 3)
+        {
+        outP[0] = static_cast<float>(
+          m[0][0]*p[0] + m[0][1]*p[1] + m[0][2]*p[2] + m[0][3]);
+        outP[1] = static_cast<float>(
+          m[1][0]*p[0] + m[1][1]*p[1] + m[1][2]*p[2] + m[1][3]);
+        outP[2] = static_cast<float>(
+          m[2][0]*p[0] + m[2][1]*p[1] + m[2][2]*p[2] + m[2][3]);
+        }
+
+      // Normals are transformed by the inverse transpose of R S, which is
+      // R S^-1 since R is symmetric and orthogonal.
+      if (this->OutNormals && numPts > 0)
+        {
+        const double* sn = &source.Normals[0];
+        float* outN = this->OutNormals + 3*ptIncr;
+        for (vtkIdType i=0; i < numPts; i++, sn += 3, outN += 3)
+          {
+          double ns[3] = { sn[0] / scale[0], sn[1] / scale[1],
+                           sn[2] / scale[2] };
+          for (int k=0; k < 3; k++)
+            {
+            n[k] = r[k][0]*ns[0] + r[k][1]*ns[1] + r[k][2]*ns[2];
+            }
+          vtkMath::Normalize(n);
+          outN[0] = static_cast<float>(n[0]);
+          outN[1] = static_cast<float>(n[1]);
+          outN[2] = static_cast<float>(n[2]);
+          }
+        }
+
+      if (this->OutVectors)
+        {
+        float* outV = this->OutVectors + 3*ptIncr;
+        for (vtkIdType i=0; i < numPts; i++, outV += 3)
+          {
+          outV[0] = static_cast<float>(v[0]);
+          outV[1] = static_cast<float>(v[1]);
+          outV[2] = static_cast<float>(v[2]);
+          }
+        }
+
+      if (this->OutTCoords)
+        {
+        int numComps = source.NumberOfTCoordComponents;
+        vtkIdType numValues = numPts * numComps;
+        float* outT = this->OutTCoords + ptIncr*numComps;
+        for (vtkIdType i=0; i < numValues; i++)
+          {
+          outT[i] = static_cast<float>(source.TCoords[i]);
+          }
+        }
+
+      if (this->OutPointIds)
+        {
+        std::fill(this->OutPointIds + ptIncr, this->OutPointIds + ptIncr +
+                  numPts, inPtId);
+        }
+
+      // Topology, with the point ids offset to this glyph's block.
+      if (this->OutConnectivity && source.Cells)
+        {
+        const vtkIdType* src = source.Cells->GetPointer();
+        const vtkIdType* srcEnd =
+          src + source.Cells->GetNumberOfConnectivityEntries();
+        vtkIdType* dst = this->OutConnectivity +
+          this->ConnectivityOffsets[glyphId];
+        while (src < srcEnd)
+          {
+          vtkIdType npts = *src++;
+          *dst++ = npts;
+          for (vtkIdType i=0; i < npts; i++)
+            {
+            *dst++ = *src++ + ptIncr;
+            }
+          }
+        }
+
+      // Copy point data from source (if possible)
+      if (this->InPD)
+        {
+        for (vtkIdType i=0; i < numPts; i++)
+          {
+          this->OutPD->CopyData(*this->PointList, this->InPD, 0, inPtId,
+                                ptIncr+i);
+          }
+        if (this->OutCD)
+          {
+          for (vtkIdType i=0; i < numCells; i++)
+            {
+            this->OutCD->CopyData(*this->CellList, this->InPD, 0, inPtId,
+                                  cellIncr+i);
+            }
+          }
+        }
+      }
+  }
+};
+}
+
 //----------------------------------------------------------------------------
 // Construct object with scaling on, scaling mode is by scalar value,
 // scale factor = 1.0, the range is (0,1), orient geometry is on, and
@@ -130,45 +515,34 @@ bool vtkGlyph3D::Execute(
   vtkUniformGrid* inputUG = vtkUniformGrid::SafeDownCast(input);
 
   vtkPointData *pd;
+  vtkDataSetAttributes::FieldList ptList(1);
+  vtkDataSetAttributes::FieldList cellList(1);
   vtkDataArray *inSScalars; // Scalars for Scaling
   vtkDataArray *inCScalars; // Scalars for Coloring
   vtkDataArray *inVectors;
+  vtkDataArray *array3D = NULL;
   unsigned char* inGhostLevels=0;
-  vtkDataArray *inNormals, *sourceNormals = NULL;
-  vtkDataArray *sourceTCoords = NULL;
+  vtkDataArray *inNormals;
   vtkIdType numPts, numSourcePts, numSourceCells, inPtId, i;
-  vtkPoints *sourcePts = NULL;
-  vtkSmartPointer<vtkPoints> transformedSourcePts = vtkSmartPointer<vtkPoints>::New();
   vtkPoints *newPts;
   vtkDataArray *newScalars=NULL;
   vtkDataArray *newVectors=NULL;
   vtkDataArray *newNormals=NULL;
   vtkDataArray *newTCoords = NULL;
-  double x[3], v[3], vNew[3], s = 0.0, vMag = 0.0, value, tc[3];
-  vtkTransform *trans = vtkTransform::New();
+  double x[3], v[3], value;
   vtkNew<vtkIdList> pointIdList;
-  vtkIdList *cellPts;
-  int npts;
-  vtkIdList *pts;
-  vtkIdType ptIncr, cellIncr, cellId;
+  vtkNew<vtkIdList> pts;
   int haveVectors, haveNormals, haveTCoords = 0;
-  double scalex,scaley,scalez, den;
+  double den;
   vtkPointData* outputPD = output->GetPointData();
   vtkCellData* outputCD = output->GetCellData();
   int numberOfSources = this->GetNumberOfInputConnections(1);
   vtkPolyData *defaultSource = NULL;
   vtkIdTypeArray *pointIds=0;
   vtkPolyData *source = this->GetSource(0, sourceVector);
-  vtkNew<vtkIdList> srcPointIdList;
-  vtkNew<vtkIdList> dstPointIdList;
-  vtkNew<vtkIdList> srcCellIdList;
-  vtkNew<vtkIdList> dstCellIdList;
 
   vtkDebugMacro(<<"Generating glyphs");
 
-  pts = vtkIdList::New();
-  pts->Allocate(VTK_CELL_SIZE);
-
   pd = input->GetPointData();
   inSScalars = this->GetInputArrayToProcess(0, input);
   inVectors = this->GetInputArrayToProcess(1, input);
@@ -199,8 +573,6 @@ bool vtkGlyph3D::Execute(
   if (numPts < 1)
     {
     vtkDebugMacro(<<"No points to glyph!");
-    pts->Delete();
-    trans->Delete();
     return true;
     }
 
@@ -215,6 +587,12 @@ bool vtkGlyph3D::Execute(
         (this->VectorMode == VTK_USE_NORMAL && inNormals != NULL)) )
     {
     haveVectors = 1;
+    array3D = this->VectorMode == VTK_USE_NORMAL? inNormals : inVectors;
+    if(array3D->GetNumberOfComponents()>3)
+      {
+      vtkErrorMacro(<<"vtkDataArray "<<array3D->GetName()<<" has more than 3 components.\n");
+      return false;
+      }
     }
   else
     {
@@ -229,8 +607,6 @@ bool vtkGlyph3D::Execute(
     if ( !source )
       {
       vtkErrorMacro(<<"Indexing on but don't have data to index with");
-      pts->Delete();
-      trans->Delete();
       return true;
       }
     else
@@ -266,6 +642,8 @@ bool vtkGlyph3D::Execute(
     source = defaultSource;
     }
 
+  // The sources, with their geometry converted once for all the glyphs.
+  std::vector<vtkGlyph3DSourceData> sources;
   if ( this->IndexMode != VTK_INDEXING_OFF )
     {
     pd = NULL;
@@ -283,53 +661,46 @@ bool vtkGlyph3D::Execute(
           {
           numSourceCells = source->GetNumberOfCells();
           }
-        if ( !(sourceNormals = source->GetPointData()->GetNormals()) )
+        if ( !source->GetPointData()->GetNormals() )
           {
           haveNormals = 0;
           }
         }
       }
+    sources.resize(numberOfSources);
+    for (i=0; i < numberOfSources; i++)
+      {
+      source = this->GetSource(i, sourceVector);
+      if ( source != NULL )
+        {
+        vtkGlyph3DPrepareSource(source, this->SourceTransform,
+                                haveNormals != 0, false, sources[i]);
+        }
+      }
     }
   else
     {
-    sourcePts = source->GetPoints();
-    numSourcePts = sourcePts->GetNumberOfPoints();
+    numSourcePts = source->GetNumberOfPoints();
     numSourceCells = source->GetNumberOfCells();
-
-    sourceNormals = source->GetPointData()->GetNormals();
-    if ( sourceNormals )
-      {
-      haveNormals = 1;
-      }
-    else
-      {
-      haveNormals = 0;
-      }
-
-    sourceTCoords = source->GetPointData()->GetTCoords();
-    if (sourceTCoords)
-      {
-      haveTCoords = 1;
-      }
-    else
-      {
-      haveTCoords = 0;
-      }
-
-    // Prepare to copy output.
+    haveNormals = (source->GetPointData()->GetNormals() != NULL);
+    haveTCoords = (source->GetPointData()->GetTCoords() != NULL);
+    sources.resize(1);
+    vtkGlyph3DPrepareSource(source, this->SourceTransform,
+                            haveNormals != 0, haveTCoords != 0, sources[0]);
+
+    // Prepare to copy output. The field lists map the input arrays to
+    // the output arrays without the shared iterator of CopyData(), so
+    // that the glyphs can copy their data concurrently.
     pd = input->GetPointData();
-    outputPD->CopyAllocate(pd,numPts*numSourcePts);
+    ptList.InitializeFieldList(pd);
+    outputPD->CopyAllocate(ptList,numPts*numSourcePts);
     if (this->FillCellData)
       {
-      outputCD->CopyAllocate(pd,numPts*numSourceCells);
+      cellList.InitializeFieldList(pd);
+      outputCD->CopyAllocate(cellList,numPts*numSourceCells);
       }
     }
 
-  srcPointIdList->SetNumberOfIds(numSourcePts);
-  dstPointIdList->SetNumberOfIds(numSourcePts);
-  srcCellIdList->SetNumberOfIds(numSourceCells);
-  dstCellIdList->SetNumberOfIds(numSourceCells);
-
   newPts = vtkPoints::New();
   newPts->Allocate(numPts*numSourcePts);
   if ( this->GeneratePointIds )
@@ -380,136 +751,47 @@ bool vtkGlyph3D::Execute(
   if (haveTCoords)
     {
     newTCoords = vtkFloatArray::New();
-    int numComps = sourceTCoords->GetNumberOfComponents();
+    int numComps = sources[0].NumberOfTCoordComponents;
     newTCoords->SetNumberOfComponents(numComps);
     newTCoords->Allocate(numComps*numPts*numSourcePts);
     newTCoords->SetName("TCoords");
     }
 
-  // Setting up for calls to PolyData::InsertNextCell()
-  if (this->IndexMode != VTK_INDEXING_OFF )
-    {
-    output->Allocate(3*numPts*numSourceCells,numPts*numSourceCells);
-    }
-  else
-    {
-    output->Allocate(source,
-                     3*numPts*numSourceCells, numPts*numSourceCells);
-    }
-
-  transformedSourcePts->SetDataTypeToDouble();
-  transformedSourcePts->Allocate(numSourcePts);
-
-  // Traverse all Input points, transforming Source points and copying
-  // point attributes.
-  //
-  ptIncr=0;
-  cellIncr=0;
+  // Select the points to glyph and, when indexing, the source of each of
+  // them. This is done serially: IsPointVisible() may be overridden and is
+  // not required to be thread safe.
+  std::vector<vtkIdType> glyphPoints;
+  std::vector<int> glyphSources;
+  glyphPoints.reserve(numPts);
   for (inPtId=0; inPtId < numPts; inPtId++)
     {
-    scalex = scaley = scalez = 1.0;
-    if ( ! (inPtId % 10000) )
-      {
-      this->UpdateProgress(static_cast<double>(inPtId)/numPts);
-      if (this->GetAbortExecute())
-        {
-        break;
-        }
-      }
-
-    // Get the scalar and vector data
-    if ( inSScalars )
-      {
-      s = inSScalars->GetComponent(inPtId, 0);
-      if ( this->ScaleMode == VTK_SCALE_BY_SCALAR ||
-           this->ScaleMode == VTK_DATA_SCALING_OFF )
-        {
-        scalex = scaley = scalez = s;
-        }
-      }
-
-    if ( haveVectors )
-      {
-      vtkDataArray *array3D = this->VectorMode == VTK_USE_NORMAL? inNormals : inVectors;
-      if(array3D->GetNumberOfComponents()>3)
-        {
-        vtkErrorMacro(<<"vtkDataArray "<<array3D->GetName()<<" has more than 3 components.\n");
-        pts->Delete();
-        trans->Delete();
-        if(newPts)
-          {
-          newPts->Delete();
-          }
-        if(newVectors)
-          {
-          newVectors->Delete();
-          }
-        return false;
-        }
-
-      v[0] = 0;
-      v[1] = 0;
-      v[2] = 0;
-      array3D->GetTuple(inPtId, v);
-      vMag = vtkMath::Norm(v);
-      if ( this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS )
-        {
-        scalex = v[0];
-        scaley = v[1];
-        scalez = v[2];
-        }
-      else if ( this->ScaleMode == VTK_SCALE_BY_VECTOR )
-        {
-        scalex = scaley = scalez = vMag;
-        }
-      }
-
-    // Clamp data scale if enabled
-    if ( this->Clamping )
-      {
-      scalex = (scalex < this->Range[0] ? this->Range[0] :
-                (scalex > this->Range[1] ? this->Range[1] : scalex));
-      scalex = (scalex - this->Range[0]) / den;
-      scaley = (scaley < this->Range[0] ? this->Range[0] :
-                (scaley > this->Range[1] ? this->Range[1] : scaley));
-      scaley = (scaley - this->Range[0]) / den;
-      scalez = (scalez < this->Range[0] ? this->Range[0] :
-                (scalez > this->Range[1] ? this->Range[1] : scalez));
-      scalez = (scalez - this->Range[0]) / den;
-      }
-
     // Compute index into table of glyphs
+    int index = 0;
     if ( this->IndexMode != VTK_INDEXING_OFF )
       {
+      value = 0.0;
       if ( this->IndexMode == VTK_INDEXING_BY_SCALAR )
         {
-        value = s;
+        value = inSScalars->GetComponent(inPtId, 0);
         }
-      else
+      else if ( haveVectors )
         {
-        value = vMag;
+        v[0] = v[1] = v[2] = 0.0;
+        array3D->GetTuple(inPtId, v);
+        value = vtkMath::Norm(v);
         }
 
-      int index = static_cast<int>((value - this->Range[0])*numberOfSources / den);
+      index = static_cast<int>((value - this->Range[0])*numberOfSources / den);
       index = (index < 0 ? 0 :
               (index >= numberOfSources ? (numberOfSources-1) : index));
 
-      source = this->GetSource(index, sourceVector);
-      if ( source != NULL )
+      // Make sure we're not indexing into empty glyph
+      if ( sources[index].Source == NULL )
         {
-        sourcePts = source->GetPoints();
-        sourceNormals = source->GetPointData()->GetNormals();
-        numSourcePts = sourcePts->GetNumberOfPoints();
-        numSourceCells = source->GetNumberOfCells();
+        continue;
         }
       }
 
-    // Make sure we're not indexing into empty glyph
-    if ( !source )
-      {
-      continue;
-      }
-
     // Check ghost points.
     // If we are processing a piece, we do not want to duplicate
     // glyphs on the borders.  The corrct check here is:
@@ -535,165 +817,240 @@ bool vtkGlyph3D::Execute(
       continue;
       }
 
-    // Now begin copying/transforming glyph
-    trans->Identity();
-
-    // Copy all topology (transformation independent)
-    for (cellId=0; cellId < numSourceCells; cellId++)
+    glyphPoints.push_back(inPtId);
+    if ( this->IndexMode != VTK_INDEXING_OFF )
       {
-      source->GetCellPoints(cellId, pointIdList.GetPointer());
-      cellPts = pointIdList.GetPointer();
-      npts = cellPts->GetNumberOfIds();
-      for (pts->Reset(), i=0; i < npts; i++)
-        {
-        pts->InsertId(i, cellPts->GetId(i) + ptIncr);
-        }
-      output->InsertNextCell(source->GetCellType(cellId), pts);
+      glyphSources.push_back(index);
       }
+    }
 
-    // translate Source to Input point
-    input->GetPoint(inPtId, x);
-    trans->Translate(x[0], x[1], x[2]);
+  // Locate the block of output points, cells and connectivity of each
+  // glyph. When the cells of the sources are all of one kind, the output
+  // cells are in the order in which InsertNextCell() would put them, and
+  // the connectivity is written by the glyphs directly.
+  vtkIdType numGlyphs = static_cast<vtkIdType>(glyphPoints.size());
+  std::vector<vtkIdType> pointOffsets(numGlyphs+1, 0);
+  std::vector<vtkIdType> cellOffsets(numGlyphs+1, 0);
+  std::vector<vtkIdType> connectivityOffsets(numGlyphs+1, 0);
+  for (vtkIdType glyphId=0; glyphId < numGlyphs; glyphId++)
+    {
+    const vtkGlyph3DSourceData& data =
+      sources[glyphSources.empty() ? 0 : glyphSources[glyphId]];
+    pointOffsets[glyphId+1] = pointOffsets[glyphId] + data.NumberOfPoints;
+    cellOffsets[glyphId+1] = cellOffsets[glyphId] + data.NumberOfCells;
+    connectivityOffsets[glyphId+1] = connectivityOffsets[glyphId] +
+      (data.Cells ? data.Cells->GetNumberOfConnectivityEntries() : 0);
+    }
+  vtkIdType numOutPts = pointOffsets[numGlyphs];
+  vtkIdType numOutCells = cellOffsets[numGlyphs];
 
-    if ( haveVectors )
+  int cellsKind = -1;
+  bool insertCells = false;
+  for (i=0; i < static_cast<vtkIdType>(sources.size()); i++)
+    {
+    if (sources[i].NumberOfCellsKinds > 1 ||
+        (sources[i].Cells && cellsKind >= 0 &&
+         sources[i].CellsKind != cellsKind))
       {
-      // Copy Input vector
-      for (i=0; i < numSourcePts; i++)
-        {
-        newVectors->InsertTuple(i+ptIncr, v);
-        }
-      if (this->Orient && (vMag > 0.0))
-        {
-        // if there is no y or z component
-        if ( v[1] == 0.0 && v[2] == 0.0 )
-          {
-          if (v[0] < 0) //just flip x if we need to
-            {
-            trans->RotateWXYZ(180.0,0,1,0);
-            }
-          }
-        else
-          {
-          vNew[0] = (v[0]+vMag) / 2.0;
-          vNew[1] = v[1] / 2.0;
-          vNew[2] = v[2] / 2.0;
-          trans->RotateWXYZ(180.0,vNew[0],vNew[1],vNew[2]);
-          }
-        }
+      insertCells = true;
       }
-
-    if (haveTCoords)
+    else if (sources[i].Cells)
       {
-      for (i = 0; i < numSourcePts; i++)
-        {
-        sourceTCoords->GetTuple(i, tc);
-        newTCoords->InsertTuple(i+ptIncr, tc);
-        }
+      cellsKind = sources[i].CellsKind;
       }
+    }
+
+  // The glyphs are generated concurrently when all the input arrays can
+  // be read concurrently.
+  bool parallel = true;
+  for (i=0; pd && parallel && i < pd->GetNumberOfArrays(); i++)
+    {
+    parallel = vtkGlyph3DIsThreadSafe(pd->GetAbstractArray(i));
+    }
+  vtkDataArray* inArrays[4] = { inSScalars, inCScalars, inVectors,
+                                inNormals };
+  for (i=0; parallel && i < 4; i++)
+    {
+    parallel = (!inArrays[i] || vtkGlyph3DIsThreadSafe(inArrays[i]));
+    }
 
-    // determine scale factor from scalars if appropriate
-    // Copy scalar value
-    if (inSScalars && (this->ColorMode == VTK_COLOR_BY_SCALE))
+  // Size all the outputs up front so that the glyphs only write to them.
+  newPts->SetNumberOfPoints(numOutPts);
+  for (i=0; i < outputPD->GetNumberOfArrays(); i++)
+    {
+    outputPD->GetAbstractArray(i)->SetNumberOfTuples(numOutPts);
+    }
+  for (i=0; this->FillCellData && i < outputCD->GetNumberOfArrays(); i++)
+    {
+    outputCD->GetAbstractArray(i)->SetNumberOfTuples(numOutCells);
+    }
+  vtkDataArray* newArrays[4] = { newScalars, newVectors, newNormals,
+                                 newTCoords };
+  for (i=0; i < 4; i++)
+    {
+    if (newArrays[i])
       {
-      for (i=0; i < numSourcePts; i++)
-        {
-        newScalars->InsertTuple(i+ptIncr, &scalex); // = scaley = scalez
-        }
+      newArrays[i]->SetNumberOfTuples(numOutPts);
       }
-    else if (inCScalars && (this->ColorMode == VTK_COLOR_BY_SCALAR))
-      {
-      for (i=0; i < numSourcePts; i++)
-        {
-        outputPD->CopyTuple(inCScalars, newScalars, inPtId, ptIncr+i);
-        }
-      }
-    if (haveVectors && this->ColorMode == VTK_COLOR_BY_VECTOR)
+    }
+
+  vtkIdTypeArray* connectivity = NULL;
+  if (insertCells)
+    {
+    // Setting up for calls to PolyData::InsertNextCell()
+    if (this->IndexMode != VTK_INDEXING_OFF )
       {
-      for (i=0; i < numSourcePts; i++)
-        {
-        newScalars->InsertTuple(i+ptIncr, &vMag);
-        }
+      output->Allocate(3*numPts*numSourceCells,numPts*numSourceCells);
       }
-
-    // scale data if appropriate
-    if ( this->Scaling )
+    else
       {
-      if ( this->ScaleMode == VTK_DATA_SCALING_OFF )
-        {
-        scalex = scaley = scalez = this->ScaleFactor;
-        }
-      else
-        {
-        scalex *= this->ScaleFactor;
-        scaley *= this->ScaleFactor;
-        scalez *= this->ScaleFactor;
-        }
-
-      if ( scalex == 0.0 )
-        {
-        scalex = 1.0e-10;
-        }
-      if ( scaley == 0.0 )
-        {
-        scaley = 1.0e-10;
-        }
-      if ( scalez == 0.0 )
-        {
-        scalez = 1.0e-10;
-        }
-      trans->Scale(scalex,scaley,scalez);
+      output->Allocate(source,
+                       3*numPts*numSourceCells, numPts*numSourceCells);
       }
+    }
+  else if (cellsKind >= 0)
+    {
+    connectivity = vtkIdTypeArray::New();
+    connectivity->SetNumberOfValues(connectivityOffsets[numGlyphs]);
+    }
 
-    // multiply points and normals by resulting matrix
-    if (this->SourceTransform)
+  vtkGlyph3DGlyphPoints glypher;
+  glypher.Self = this;
+  glypher.Input = input;
+  glypher.GlyphPoints = numGlyphs > 0 ? &glyphPoints[0] : NULL;
+  glypher.GlyphSources = glyphSources.empty() ? NULL : &glyphSources[0];
+  glypher.PointOffsets = &pointOffsets[0];
+  glypher.CellOffsets = &cellOffsets[0];
+  glypher.ConnectivityOffsets = &connectivityOffsets[0];
+  glypher.Sources = &sources[0];
+  glypher.ScaleScalars = inSScalars;
+  glypher.ColorScalars = inCScalars;
+  glypher.Vectors = haveVectors ? array3D : NULL;
+  glypher.Den = den;
+  glypher.OutPoints =
+    static_cast<vtkFloatArray*>(newPts->GetData())->GetPointer(0);
+  glypher.OutNormals = newNormals ?
+    static_cast<vtkFloatArray*>(newNormals)->GetPointer(0) : NULL;
+  glypher.OutVectors = newVectors ?
+    static_cast<vtkFloatArray*>(newVectors)->GetPointer(0) : NULL;
+  glypher.OutTCoords = newTCoords ?
+    static_cast<vtkFloatArray*>(newTCoords)->GetPointer(0) : NULL;
+  glypher.ScalarsMode = GLYPH_SCALARS_NONE;
+  glypher.OutScalars = newScalars;
+  glypher.OutScalarValues = NULL;
+  if (newScalars)
+    {
+    if (this->ColorMode == VTK_COLOR_BY_SCALAR)
       {
-      transformedSourcePts->Reset();
-      this->SourceTransform->TransformPoints(sourcePts, transformedSourcePts);
-      trans->TransformPoints(transformedSourcePts, newPts);
+      glypher.ScalarsMode = GLYPH_SCALARS_COPY;
       }
     else
       {
-      trans->TransformPoints(sourcePts,newPts);
+      glypher.ScalarsMode = this->ColorMode == VTK_COLOR_BY_SCALE ?
+        GLYPH_SCALARS_SCALE : GLYPH_SCALARS_MAGNITUDE;
+      glypher.OutScalarValues =
+        static_cast<vtkFloatArray*>(newScalars)->GetPointer(0);
       }
+    }
+  glypher.OutPointIds = pointIds ? pointIds->GetPointer(0) : NULL;
+  glypher.OutConnectivity = connectivity ? connectivity->GetPointer(0) : NULL;
+  glypher.InPD = pd;
+  glypher.OutPD = outputPD;
+  glypher.OutCD = this->FillCellData ? outputCD : NULL;
+  glypher.PointList = &ptList;
+  glypher.CellList = &cellList;
+
+  if (numGlyphs > 0)
+    {
+    // GetPoint() is only thread safe once it has been called from a
+    // single thread.
+    input->GetPoint(glyphPoints[0], x);
+    }
 
-    if ( haveNormals )
+  // Generate the glyphs a range at a time, so that progress is reported
+  // and the execution can be aborted.
+  vtkIdType progressInterval = numGlyphs/20 + 1;
+  vtkIdType glyphId = 0;
+  while (glyphId < numGlyphs && !this->GetAbortExecute())
+    {
+    this->UpdateProgress(static_cast<double>(glyphId)/numGlyphs);
+    vtkIdType endId = std::min(glyphId + progressInterval, numGlyphs);
+    if (parallel)
       {
-      trans->TransformNormals(sourceNormals,newNormals);
+      vtkSMPTools::For(glyphId, endId, glypher);
+      }
+    else
+      {
+      glypher(glyphId, endId);
       }
 
-    // Copy point data from source (if possible)
-    if ( pd )
+    // Copy all topology (transformation independent)
+    for (; insertCells && glyphId < endId; glyphId++)
       {
-      for (i = 0; i < numSourcePts; ++i)
+      const vtkGlyph3DSourceData& data =
+        sources[glyphSources.empty() ? 0 : glyphSources[glyphId]];
+      vtkIdType ptIncr = pointOffsets[glyphId];
+      for (vtkIdType cellId=0; cellId < data.NumberOfCells; cellId++)
         {
-        srcPointIdList->SetId(i, inPtId);
-        dstPointIdList->SetId(i, ptIncr + i);
-        }
-      outputPD->CopyData(pd, srcPointIdList.GetPointer(),
-                         dstPointIdList.GetPointer());
-      if (this->FillCellData)
-        {
-        for (i = 0; i < numSourceCells; ++i)
+        data.Source->GetCellPoints(cellId, pointIdList.GetPointer());
+        vtkIdType npts = pointIdList->GetNumberOfIds();
+        for (pts->Reset(), i=0; i < npts; i++)
           {
-          srcCellIdList->SetId(i, inPtId);
-          dstCellIdList->SetId(i, cellIncr + i);
+          pts->InsertId(i, pointIdList->GetId(i) + ptIncr);
           }
-        outputCD->CopyData(pd, srcCellIdList.GetPointer(),
-                           dstCellIdList.GetPointer());
+        output->InsertNextCell(data.Source->GetCellType(cellId),
+                               pts.GetPointer());
         }
       }
+    glyphId = endId;
+    }
 
-    // If point ids are to be generated, do it here
-    if ( this->GeneratePointIds )
+  // When aborted, keep the glyphs that have been generated.
+  if (glyphId < numGlyphs)
+    {
+    newPts->SetNumberOfPoints(pointOffsets[glyphId]);
+    for (i=0; i < outputPD->GetNumberOfArrays(); i++)
+      {
+      outputPD->GetAbstractArray(i)->SetNumberOfTuples(pointOffsets[glyphId]);
+      }
+    for (i=0; this->FillCellData && i < outputCD->GetNumberOfArrays(); i++)
       {
-      for (i=0; i < numSourcePts; i++)
+      outputCD->GetAbstractArray(i)->SetNumberOfTuples(cellOffsets[glyphId]);
+      }
+    for (i=0; i < 4; i++)
+      {
+      if (newArrays[i])
         {
-        pointIds->InsertNextValue(inPtId);
+        newArrays[i]->SetNumberOfTuples(pointOffsets[glyphId]);
         }
       }
+    if (connectivity)
+      {
+      connectivity->SetNumberOfValues(connectivityOffsets[glyphId]);
+      }
+    }
 
-    ptIncr += numSourcePts;
-    cellIncr += numSourceCells;
+  if (connectivity)
+    {
+    vtkCellArray* newCells = vtkCellArray::New();
+    newCells->SetCells(cellOffsets[glyphId], connectivity);
+    connectivity->Delete();
+    switch (cellsKind)
+      {
+      case 0:
+        output->SetVerts(newCells);
+        break;
+      case 1:
+        output->SetLines(newCells);
+        break;
+      case 2:
+        output->SetPolys(newCells);
+        break;
+      case 3:
+        output->SetStrips(newCells);
+        break;
+      }
+    newCells->Delete();
     }
 
   // Update ourselves and release memory
@@ -727,8 +1084,6 @@ bool vtkGlyph3D::Execute(
     }
 
   output->Squeeze();
-  trans->Delete();
-  pts->Delete();
 
   return true;
 }
@@ -65,6 +65,10 @@
 // color scalars by using the SetInputArrayToProcess methods in
 // vtkAlgorithm. The first array is scalars, the next vectors, the next
 // normals and finally color scalars.
+//
+// The glyphs are written directly into preallocated output arrays. They
+// are generated in parallel with vtkSMPTools when the input point data only
+// holds numeric arrays, and on the calling thread otherwise.
 
 // .SECTION See Also
 // vtkTensorGlyph
@@ -15,15 +15,84 @@
 #include "vtkPointDataToCellData.h"
 
 #include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataArrayRound.h"
 #include "vtkDataSet.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkPointDataToCellData);
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Averages, for each cell, the data of its points. Each cell is only
+// written by the thread processing it.
+template <class T>
+class vtkPointDataToCellDataAverage
+{
+public:
+  vtkDataSet* Input;
+  const T* Source;
+  T* Destination;
+  int NumberOfComponents;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+  vtkSMPThreadLocal<std::vector<double> > Sum;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList* cellPts = this->CellPoints.Local();
+    std::vector<double>& sum = this->Sum.Local();
+    int ncomps = this->NumberOfComponents;
+    sum.resize(ncomps);
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+      this->Input->GetCellPoints(cellId, cellPts);
+      vtkIdType numPts = cellPts->GetNumberOfIds();
+      double weight = numPts > 0 ? 1.0 / numPts : 0.0;
+      std::fill(sum.begin(), sum.end(), 0.0);
+      for (vtkIdType j = 0; j < numPts; ++j)
+        {
+        const T* src = this->Source + cellPts->GetId(j)*ncomps;
+        for (int c = 0; c < ncomps; ++c)
+          {
+          sum[c] += weight * static_cast<double>(src[c]);
+          }
+        }
+      T* dst = this->Destination + cellId*ncomps;
+      for (int c = 0; c < ncomps; ++c)
+        {
+        vtkDataArrayRound(sum[c], dst + c);
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkPointDataToCellDataAverageArray(vtkDataSet* input,
+                                        vtkDataArray* srcarray,
+                                        vtkDataArray* dstarray)
+{
+  vtkPointDataToCellDataAverage<T> average;
+  average.Input = input;
+  average.Source = static_cast<T*>(srcarray->GetVoidPointer(0));
+  average.Destination = static_cast<T*>(dstarray->GetVoidPointer(0));
+  average.NumberOfComponents = srcarray->GetNumberOfComponents();
+  vtkSMPTools::For(0, input->GetNumberOfCells(), average);
+}
+}
+
 //----------------------------------------------------------------------------
 // Instantiate object so that point data is not passed to output.
 vtkPointDataToCellData::vtkPointDataToCellData()
@@ -45,14 +114,10 @@ int vtkPointDataToCellData::RequestData(
   vtkDataSet *input = vtkDataSet::SafeDownCast(
     inInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType cellId, ptId;
-  vtkIdType numCells, numPts;
+  vtkIdType cellId, numCells;
   vtkPointData *inPD=input->GetPointData();
   vtkCellData *outCD=output->GetCellData();
-  int maxCellSize=input->GetMaxCellSize();
   vtkIdList *cellPts;
-  double weight;
-  double *weights;
 
   vtkDebugMacro(<<"Mapping point data to cell data");
 
@@ -64,10 +129,6 @@ int vtkPointDataToCellData::RequestData(
     vtkDebugMacro(<<"No input cells!");
     return 1;
     }
-  weights=new double[maxCellSize];
-
-  cellPts = vtkIdList::New();
-  cellPts->Allocate(maxCellSize);
 
   // Pass the cell data first. The fields and attributes
   // which also exist in the point data of the input will
@@ -78,28 +139,65 @@ int vtkPointDataToCellData::RequestData(
 
   // notice that inPD and outCD are vtkPointData and vtkCellData; respectively.
   // It's weird, but it works.
-  outCD->InterpolateAllocate(inPD,numCells);
+  vtkDataSetAttributes::FieldList pfl(1);
+  pfl.InitializeFieldList(inPD);
+  outCD->InterpolateAllocate(pfl, numCells, numCells);
+
+  // GetCellPoints() is only thread safe once it has been called from a
+  // single thread, which builds the cells of a polydata.
+  cellPts = vtkIdList::New();
+  cellPts->Allocate(input->GetMaxCellSize());
+  input->GetCellPoints(0, cellPts);
+  std::vector<double> weights;
 
-  int abort=0;
-  vtkIdType progressInterval=numCells/20 + 1;
-  for (cellId=0; cellId < numCells && !abort; cellId++)
+  for (int fid = 0, nfields = pfl.GetNumberOfFields(); fid < nfields; ++fid)
     {
-    if ( !(cellId % progressInterval) )
+    // update progress and check for an abort request.
+    this->UpdateProgress((fid+1.)/nfields);
+    if (this->GetAbortExecute())
       {
-      this->UpdateProgress((double)cellId/numCells);
-      abort = GetAbortExecute();
+      break;
+      }
+
+    int const dstid = pfl.GetFieldIndex(fid);
+    int const srcid = pfl.GetDSAIndex(0,fid);
+    if  (srcid < 0 || dstid < 0)
+      {
+      continue;
+      }
+
+    vtkAbstractArray* const srcarray = inPD->GetAbstractArray(srcid);
+    vtkAbstractArray* const dstarray = outCD->GetAbstractArray(dstid);
+    dstarray->SetNumberOfTuples(numCells);
+
+    vtkDataArray* const srcdata = vtkDataArray::SafeDownCast(srcarray);
+    vtkDataArray* const dstdata = vtkDataArray::SafeDownCast(dstarray);
+    if (srcdata && dstdata && srcdata->GetDataType() == dstdata->GetDataType())
+      {
+      bool done = true;
+      switch (srcdata->GetDataType())
+        {
+        vtkTemplateMacro(vtkPointDataToCellDataAverageArray<VTK_TT>(
+                           input, srcdata, dstdata));
+        default:
+          done = false;
+        }
+      if (done)
+        {
+        continue;
+        }
       }
 
-    input->GetCellPoints(cellId, cellPts);
-    numPts = cellPts->GetNumberOfIds();
-    if ( numPts > 0 )
+    // Other arrays (e.g. bits or strings) are interpolated serially.
+    for (cellId=0; cellId < numCells; cellId++)
       {
-      weight = 1.0 / numPts;
-      for (ptId=0; ptId < numPts; ptId++)
+      input->GetCellPoints(cellId, cellPts);
+      vtkIdType numPts = cellPts->GetNumberOfIds();
+      if ( numPts > 0 )
         {
-        weights[ptId] = weight;
+        weights.assign(numPts, 1.0 / numPts);
+        dstarray->InterpolateTuple(cellId, cellPts, srcarray, &weights[0]);
         }
-      outCD->InterpolatePoint(inPD, cellId, cellPts, weights);
       }
     }
 
@@ -111,7 +209,6 @@ int vtkPointDataToCellData::RequestData(
   output->GetPointData()->PassData(input->GetPointData());
 
   cellPts->Delete();
-  delete [] weights;
 
   return 1;
 }
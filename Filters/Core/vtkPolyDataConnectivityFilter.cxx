@@ -17,7 +17,7 @@
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCell.h"
-#include "vtkFloatArray.h"
+#include "vtkConnectedRegions.h"
 #include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
@@ -43,26 +43,21 @@ vtkPolyDataConnectivityFilter::vtkPolyDataConnectivityFilter()
 
   this->ClosestPoint[0] = this->ClosestPoint[1] = this->ClosestPoint[2] = 0.0;
 
-  this->CellScalars = vtkFloatArray::New();
-  this->CellScalars->Allocate(8);
-
-  this->NeighborCellPointIds = vtkIdList::New();
-  this->NeighborCellPointIds->Allocate(8);
-
   this->Seeds = vtkIdList::New();
   this->SpecifiedRegionIds = vtkIdList::New();
 
   this->MarkVisitedPointIds = 0;
   this->VisitedPointIds = vtkIdList::New();
 
+  this->InScalars = NULL;
+  this->Mesh = NULL;
+
   this->OutputPointsPrecision = DEFAULT_PRECISION;
 }
 
 vtkPolyDataConnectivityFilter::~vtkPolyDataConnectivityFilter()
 {
   this->RegionSizes->Delete();
-  this->CellScalars->Delete();
-  this->NeighborCellPointIds->Delete();
   this->Seeds->Delete();
   this->SpecifiedRegionIds->Delete();
   this->VisitedPointIds->Delete();
@@ -83,13 +78,11 @@ int vtkPolyDataConnectivityFilter::RequestData(
   vtkPolyData *output = vtkPolyData::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType cellId, newCellId, i, pt;
-  int j;
+  vtkIdType cellId, newCellId, i;
   vtkIdType numPts, numCells;
   vtkPoints *inPts;
   vtkPoints *newPts;
-  vtkIdType *cells, *pts, npts, id, n;
-  unsigned short ncells;
+  vtkIdType *pts, npts, id, n;
   vtkIdType maxCellsInRegion;
   vtkIdType largestRegionId = 0;
   vtkPointData *pd=input->GetPointData(), *outputPD=output->GetPointData();
@@ -135,7 +128,7 @@ int vtkPolyDataConnectivityFilter::RequestData(
   //
   this->Mesh = vtkPolyData::New();
   this->Mesh->CopyStructure(input);
-  this->Mesh->BuildLinks();
+  this->Mesh->BuildCells();
   this->UpdateProgress(0.10);
 
   // Remove all visited point ids
@@ -145,19 +138,12 @@ int vtkPolyDataConnectivityFilter::RequestData(
   //
   this->RegionSizes->Reset();
   this->Visited = new vtkIdType[numCells];
-  for ( i=0; i < numCells; i++ )
-    {
-    this->Visited[i] = -1;
-    }
   this->PointMap = new vtkIdType[numPts];
-  for ( i=0; i < numPts; i++ )
-    {
-    this->PointMap[i] = -1;
-    }
 
-  this->NewScalars = vtkIdTypeArray::New();
-  this->NewScalars->SetName("RegionId");
-  this->NewScalars->SetNumberOfTuples(numPts);
+  vtkIdTypeArray *newScalars = vtkIdTypeArray::New();
+  newScalars->SetName("RegionId");
+  newScalars->SetNumberOfTuples(numPts);
+  this->NewScalars = newScalars;
   newPts = vtkPoints::New();
 
   // Set the desired precision for the points in the output.
@@ -176,21 +162,17 @@ int vtkPolyDataConnectivityFilter::RequestData(
 
   newPts->Allocate(numPts);
 
-  // Traverse all cells marking those visited.  Each new search
-  // starts a new connected region. Connected region grows
-  // using a connected wave propagation.
+  // Merge the points of the connected cells into sets. Each region holds
+  // the sets reached from its first cell (or from the seeds).
   //
-  this->Wave = vtkIdList::New();
-  this->Wave->Allocate(numPts/4+1,numPts);
-  this->Wave2 = vtkIdList::New();
-  this->Wave2->Allocate(numPts/4+1,numPts);
+  vtkConnectedRegions regions(this->Mesh, this->InScalars, this->ScalarRange,
+                              this->FullScalarConnectivity != 0);
+  this->UpdateProgress (0.5);
 
   this->PointNumber = 0;
   this->RegionNumber = 0;
   maxCellsInRegion = 0;
 
-  this->CellIds = vtkIdList::New();
-  this->CellIds->Allocate(8, VTK_CELL_SIZE);
   this->PointIds = vtkIdList::New();
   this->PointIds->Allocate(8, VTK_CELL_SIZE);
 
@@ -198,66 +180,35 @@ int vtkPolyDataConnectivityFilter::RequestData(
   this->ExtractionMode != VTK_EXTRACT_CELL_SEEDED_REGIONS &&
   this->ExtractionMode != VTK_EXTRACT_CLOSEST_POINT_REGION )
     { //visit all cells marking with region number
-    for (cellId=0; cellId < numCells; cellId++)
+    this->RegionNumber = regions.LabelAllRegions(this->Visited,
+                                                 this->RegionSizes);
+    for (i=0; i < this->RegionNumber; i++)
       {
-      if ( cellId && !(cellId % 5000) )
+      if ( this->RegionSizes->GetValue(i) > maxCellsInRegion )
         {
-        this->UpdateProgress (0.1 + 0.8*cellId/numCells);
+        maxCellsInRegion = this->RegionSizes->GetValue(i);
+        largestRegionId = i;
         }
-
-      if ( this->Visited[cellId] < 0 )
-        {
-        this->NumCellsInRegion = 0;
-        this->Wave->InsertNextId(cellId);
-        this->TraverseAndMark ();
-
-        if ( this->NumCellsInRegion > maxCellsInRegion )
-          {
-          maxCellsInRegion = this->NumCellsInRegion;
-          largestRegionId = this->RegionNumber;
-          }
-
-        this->RegionSizes->InsertValue(this->RegionNumber++,
-                                       this->NumCellsInRegion);
-        this->Wave->Reset();
-        this->Wave2->Reset();
-       }
       }
     }
   else // regions have been seeded, everything considered in same region
     {
-    this->NumCellsInRegion = 0;
+    vtkIdType numCellsInRegion = 0;
 
     if ( this->ExtractionMode == VTK_EXTRACT_POINT_SEEDED_REGIONS )
       {
-      for (i=0; i < this->Seeds->GetNumberOfIds(); i++)
-        {
-        pt = this->Seeds->GetId(i);
-        if ( pt >= 0 )
-          {
-          this->Mesh->GetPointCells(pt,ncells,cells);
-          for (j=0; j < ncells; j++)
-            {
-            this->Wave->InsertNextId(cells[j]);
-            }
-          }
-        }
+      numCellsInRegion = regions.LabelSeededRegion(this->Seeds, true,
+                                                   this->Visited);
       }
     else if ( this->ExtractionMode == VTK_EXTRACT_CELL_SEEDED_REGIONS )
       {
-      for (i=0; i < this->Seeds->GetNumberOfIds(); i++)
-        {
-        cellId = this->Seeds->GetId(i);
-        if ( cellId >= 0 )
-          {
-          this->Wave->InsertNextId(cellId);
-          }
-        }
+      numCellsInRegion = regions.LabelSeededRegion(this->Seeds, false,
+                                                   this->Visited);
       }
     else if ( this->ExtractionMode == VTK_EXTRACT_CLOSEST_POINT_REGION )
       {//loop over points, find closest one
       double minDist2, dist2, x[3];
-      int minId = 0;
+      vtkIdType minId = 0;
       for (minDist2=VTK_DOUBLE_MAX, i=0; i<numPts; i++)
         {
         inPts->GetPoint(i,x);
@@ -268,23 +219,24 @@ int vtkPolyDataConnectivityFilter::RequestData(
           minDist2 = dist2;
           }
         }
-      this->Mesh->GetPointCells(minId,ncells,cells);
-      for (j=0; j < ncells; j++)
-        {
-        this->Wave->InsertNextId(cells[j]);
-        }
+      vtkIdList *closestPointSeed = vtkIdList::New();
+      closestPointSeed->InsertNextId(minId);
+      numCellsInRegion = regions.LabelSeededRegion(closestPointSeed, true,
+                                                   this->Visited);
+      closestPointSeed->Delete();
       }
-    this->UpdateProgress (0.5);
 
-    //mark all seeded regions
-    this->TraverseAndMark ();
-    this->RegionSizes->InsertValue(this->RegionNumber,this->NumCellsInRegion);
-    this->UpdateProgress (0.9);
+    this->RegionSizes->InsertValue(this->RegionNumber,numCellsInRegion);
     }//else extracted seeded cells
+  this->UpdateProgress (0.8);
+
+  // Number the points of the visited cells.
+  //
+  this->PointNumber = regions.MapPoints(this->Visited, this->PointMap,
+                                        newScalars);
+  this->UpdateProgress (0.9);
 
   vtkDebugMacro (<<"Extracted " << this->RegionNumber << " region(s)");
-  this->Wave->Delete();
-  this->Wave2->Delete();
 
   // Now that points and cells have been marked, traverse these lists pulling
   // everything that has been visited.
@@ -439,8 +391,8 @@ int vtkPolyDataConnectivityFilter::RequestData(
   delete [] this->Visited;
   delete [] this->PointMap;
   this->Mesh->Delete();
+  this->Mesh = NULL;
   output->Squeeze();
-  this->CellIds->Delete();
   this->PointIds->Delete();
 
   int num = this->GetNumberOfExtractedRegions();
@@ -456,121 +408,44 @@ int vtkPolyDataConnectivityFilter::RequestData(
   return 1;
 }
 
-// Mark current cell as visited and assign region number.  Note:
-// traversal occurs across shared vertices.
-//
-void vtkPolyDataConnectivityFilter::TraverseAndMark ()
+#ifndef VTK_LEGACY_REMOVE
+// --------------------------------------------------------------------------
+void vtkPolyDataConnectivityFilter::TraverseAndMark()
 {
-  vtkIdType cellId, ptId, numIds, i;
-  int j, k;
-  vtkIdType *pts, *cells, npts;
-  vtkIdList *tmpWave;
-  unsigned short ncells;
-
-  while ( (numIds=this->Wave->GetNumberOfIds()) > 0 )
-    {
-    for ( i=0; i < numIds; i++ )
-      {
-      cellId = this->Wave->GetId(i);
-      if ( this->Visited[cellId] < 0 )
-        {
-        this->Visited[cellId] = this->RegionNumber;
-        this->NumCellsInRegion++;
-        this->Mesh->GetCellPoints(cellId, npts, pts);
-
-        for (j=0; j < npts; j++)
-          {
-          if ( this->PointMap[ptId=pts[j]] < 0 )
-            {
-            this->PointMap[ptId] = this->PointNumber++;
-            vtkIdTypeArray::SafeDownCast(this->NewScalars)->SetValue(
-              this->PointMap[ptId], this->RegionNumber);
-            }
-
-          this->Mesh->GetPointCells(ptId,ncells,cells);
-
-          // check connectivity criterion (geometric + scalar)
-          for (k=0; k < ncells; k++)
-            {
-            cellId = cells[k];
-            if ( this->InScalars )
-              {
-              if (this->IsScalarConnected(cellId))
-                {
-                this->Wave2->InsertNextId(cellId);
-                }
-              }
-            else
-              {
-              this->Wave2->InsertNextId(cellId);
-              }
-            }//for all cells using this point
-          }//for all points of this cell
-        }//if cell not yet visited
-      }//for all cells in this wave
-
-    tmpWave = this->Wave;
-    this->Wave = this->Wave2;
-    this->Wave2 = tmpWave;
-    tmpWave->Reset();
-    } //while wave is not empty
-
-  return;
+  VTK_LEGACY_BODY(vtkPolyDataConnectivityFilter::TraverseAndMark, "VTK 6.2");
 }
 
 // --------------------------------------------------------------------------
+// The criterion of vtkConnectedRegions, for the mesh being processed.
 int vtkPolyDataConnectivityFilter::IsScalarConnected( vtkIdType cellId )
 {
-  double s;
-
-  this->Mesh->GetCellPoints(cellId, this->NeighborCellPointIds);
-  const int numScalars = this->NeighborCellPointIds->GetNumberOfIds();
-
-  this->CellScalars->SetNumberOfTuples(numScalars);
-  this->InScalars->GetTuples(this->NeighborCellPointIds,
-                             this->CellScalars);
-
-  double range[2] = {VTK_DOUBLE_MAX, VTK_DOUBLE_MIN};
-
-  // Loop through the cell points.
-  for (int ii=0; ii < numScalars;  ii++)
+  VTK_LEGACY_BODY(vtkPolyDataConnectivityFilter::IsScalarConnected, "VTK 6.2");
+  if ( !this->Mesh || !this->InScalars )
     {
-    s = this->CellScalars->GetComponent(ii, 0);
-    if ( s < range[0] )
-      {
-      range[0] = s;
-      }
-    if ( s > range[1] )
-      {
-      range[1] = s;
-      }
+    return 1;
     }
 
-  // Check if the scalars lie within the user supplied scalar range.
-
-  if ( this->FullScalarConnectivity )
+  // the scalars are compared in single precision, as they were when they
+  // were copied to a vtkFloatArray
+  vtkIdType npts, *pts;
+  this->Mesh->GetCellPoints(cellId, npts, pts);
+  double range[2] = {VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX};
+  for (vtkIdType i = 0; i < npts; i++)
     {
-    // All points in this cell must lie in the user supplied scalar range
-    // for this cell to qualify as being connected.
-    if (range[0] >= this->ScalarRange[0] &&
-        range[1] <= this->ScalarRange[1])
-      {
-      return 1;
-      }
+    double s = static_cast<float>(this->InScalars->GetComponent(pts[i], 0));
+    range[0] = (s < range[0] ? s : range[0]);
+    range[1] = (s > range[1] ? s : range[1]);
     }
-  else
+
+  if ( this->FullScalarConnectivity )
     {
-    // Any point from this cell must lie is the user supplied scalar range
-    // for this cell to qualify as being connected
-    if ( range[1] >= this->ScalarRange[0] &&
-         range[0] <= this->ScalarRange[1] )
-      {
-      return 1;
-      }
+    return (range[0] >= this->ScalarRange[0] &&
+            range[1] <= this->ScalarRange[1]);
     }
-
-  return 0;
+  return (range[1] >= this->ScalarRange[0] &&
+          range[0] <= this->ScalarRange[1]);
 }
+#endif
 
 // --------------------------------------------------------------------------
 // Obtain the number of connected regions.
@@ -41,6 +41,10 @@
 // This use of ScalarConnectivity is particularly useful for selecting cells
 // for later processing.
 //
+// The regions are labeled by vtkConnectedRegions from the cells of the
+// polygonal data alone; its point-cell links are not built. The extracted
+// points and cells keep their input order.
+//
 // .SECTION See Also
 // vtkConnectivityFilter
 
@@ -198,28 +202,27 @@ protected:
   int ScalarConnectivity;
   int FullScalarConnectivity;
 
-  // Does this cell qualify as being scalar connected ?
-  int IsScalarConnected( vtkIdType cellId );
+  // Description:
+  // Deprecated: does this cell qualify as being scalar connected ?  The
+  // criterion is now evaluated by vtkConnectedRegions.
+  VTK_LEGACY(int IsScalarConnected(vtkIdType cellId));
 
   double ScalarRange[2];
 
-  void TraverseAndMark();
+  // Description:
+  // Deprecated: the regions are now labeled by vtkConnectedRegions, and
+  // this method does nothing.
+  VTK_LEGACY(void TraverseAndMark());
 
   // used to support algorithm execution
-  vtkDataArray *CellScalars;
-  vtkIdList *NeighborCellPointIds;
   vtkIdType *Visited;
   vtkIdType *PointMap;
   vtkDataArray *NewScalars;
   vtkIdType RegionNumber;
   vtkIdType PointNumber;
-  vtkIdType NumCellsInRegion;
   vtkDataArray *InScalars;
   vtkPolyData *Mesh;
-  vtkIdList *Wave;
-  vtkIdList *Wave2;
   vtkIdList *PointIds;
-  vtkIdList *CellIds;
   vtkIdList *VisitedPointIds;
 
   int MarkVisitedPointIds;
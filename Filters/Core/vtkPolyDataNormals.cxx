@@ -24,11 +24,344 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangleStrip.h"
 #include "vtkPriorityQueue.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkPolyDataNormals);
 
+namespace
+{
+// Return the index of cellId in the list of cells, or -1.
+inline int vtkPolyDataNormalsFindCell(vtkIdType cellId,
+                                      const vtkIdType* cells, int ncells)
+{
+  for (int i=0; i < ncells; i++)
+    {
+    if (cells[i] == cellId)
+      {
+      return i;
+      }
+    }
+  return -1;
+}
+
+// Mark the polygons around a vertex: each polygon using ptId is labeled
+// (in regions, in the order of the point's cell links) with the region of
+// edge-connected polygons it belongs to. Regions are separated by feature
+// edges, boundary and non-manifold edges. Each of the N regions but the
+// first needs a duplicate (split) point. Returns N.
+//
+// Only the mesh links and the given id list are used, so that points can
+// be processed concurrently.
+int vtkPolyDataNormalsMarkRegions(vtkPolyData* mesh, const float* polyNormals,
+                                  double cosAngle, vtkIdType ptId,
+                                  vtkIdList* cellIds, int* regions)
+{
+  int i,j;
+
+  // Get the cells using this point and make sure that we have to do something
+  unsigned short ncells;
+  vtkIdType *cells;
+  mesh->GetPointCells(ptId,ncells,cells);
+  if ( ncells <= 1 )
+    {
+    for (i=0; i < ncells; i++)
+      {
+      regions[i] = 0;
+      }
+    return ncells; //point does not need to be further disconnected
+    }
+
+  // Start moving around the "cycle" of points using the point. Label
+  // each subregion of cells connected to this point that are connected
+  // (and not separated by a feature edge) with a given region number.
+  //
+  // Start by initializing the cells as unvisited
+  for (i=0; i<ncells; i++)
+    {
+    regions[i] = -1;
+    }
+
+  // Loop over all cells and mark the region that each is in.
+  //
+  vtkIdType numPts;
+  vtkIdType *pts;
+  int numRegions = 0;
+  vtkIdType spot, neiPt[2], nei, cellId, neiCellId;
+  int neiIdx;
+  const float *thisNormal, *neiNormal;
+  for (j=0; j<ncells; j++) //for all cells connected to point
+    {
+    if ( regions[j] < 0 ) //for all unvisited cells
+      {
+      regions[j] = numRegions;
+      //okay, mark all the cells connected to this seed cell and using ptId
+      mesh->GetCellPoints(cells[j],numPts,pts);
+
+      //find the two edges
+      for (spot=0; spot < numPts; spot++)
+        {
+        if ( pts[spot] == ptId )
+          {
+          break;
+          }
+        }
+
+      if ( spot == 0 )
+        {
+        neiPt[0] = pts[spot+1];
+        neiPt[1] = pts[numPts-1];
+        }
+      else if ( spot == (numPts-1) )
+        {
+        neiPt[0] = pts[spot-1];
+        neiPt[1] = pts[0];
+        }
+      else
+        {
+        neiPt[0] = pts[spot+1];
+        neiPt[1] = pts[spot-1];
+        }
+
+      for (i=0; i<2; i++) //for each of the two edges of the seed cell
+        {
+        cellId = cells[j];
+        nei = neiPt[i];
+        while ( cellId >= 0 ) //while we can grow this region
+          {
+          mesh->GetCellEdgeNeighbors(cellId,ptId,nei,cellIds);
+          if ( cellIds->GetNumberOfIds() == 1 &&
+               (neiIdx=vtkPolyDataNormalsFindCell(
+                 (neiCellId=cellIds->GetId(0)), cells, ncells)) >= 0 &&
+               regions[neiIdx] < 0 )
+            {
+            thisNormal = polyNormals + 3*cellId;
+            neiNormal = polyNormals + 3*neiCellId;
+
+            if ( static_cast<double>(thisNormal[0])*neiNormal[0] +
+                 static_cast<double>(thisNormal[1])*neiNormal[1] +
+                 static_cast<double>(thisNormal[2])*neiNormal[2] > cosAngle )
+              {
+              //visit and arrange to visit next edge neighbor
+              regions[neiIdx] = numRegions;
+              cellId = neiCellId;
+              mesh->GetCellPoints(cellId,numPts,pts);
+
+              for (spot=0; spot < numPts; spot++)
+                {
+                if ( pts[spot] == ptId )
+                  {
+                  break;
+                  }
+                }
+
+              if (spot == 0)
+                {
+                nei = (pts[spot+1] != nei ? pts[spot+1] : pts[numPts-1]);
+                }
+              else if (spot == (numPts-1))
+                {
+                nei = (pts[spot-1] != nei ? pts[spot-1] : pts[0]);
+                }
+              else
+                {
+                nei = (pts[spot+1] != nei ? pts[spot+1] : pts[spot-1]);
+                }
+
+              }//if not separated by edge angle
+            else
+              {
+              cellId = -1; //separated by edge angle
+              }
+            }//if can move to edge neighbor
+          else
+            {
+            cellId = -1;//separated by previous visit, boundary, or non-manifold
+            }
+          }//while visit wave is propagating
+        }//for each of the two edges of the starting cell
+      numRegions++;
+      }//if cell is unvisited
+    }//for all cells connected to point ptId
+
+  return numRegions;
+}
+
+// Computes the normal of each polygon.
+class vtkPolyDataNormalsPolyNormals
+{
+public:
+  vtkPolyData* Mesh;
+  vtkPoints* Points;
+  float* Normals;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType npts, *pts;
+    double n[3];
+    for (vtkIdType cellId=begin; cellId < end; cellId++)
+      {
+      this->Mesh->GetCellPoints(cellId, npts, pts);
+      vtkPolygon::ComputeNormal(this->Points, npts, pts, n);
+      float* normal = this->Normals + 3*cellId;
+      normal[0] = static_cast<float>(n[0]);
+      normal[1] = static_cast<float>(n[1]);
+      normal[2] = static_cast<float>(n[2]);
+      }
+  }
+};
+
+// Labels the polygons around each point with their region (see
+// vtkPolyDataNormalsMarkRegions()).
+class vtkPolyDataNormalsMarkPoints
+{
+public:
+  vtkPolyData* Mesh;
+  const float* PolyNormals;
+  double CosAngle;
+  const vtkIdType* LinkOffsets;
+  int* Regions;
+  int* NumberOfRegions;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellIds;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList* cellIds = this->CellIds.Local();
+    for (vtkIdType ptId=begin; ptId < end; ptId++)
+      {
+      this->NumberOfRegions[ptId] = vtkPolyDataNormalsMarkRegions(
+        this->Mesh, this->PolyNormals, this->CosAngle, ptId, cellIds,
+        this->Regions + this->LinkOffsets[ptId]);
+      }
+  }
+};
+
+// Replaces the points of the polygons that are not in the first region
+// around them by their split point. Each polygon is only modified by the
+// thread processing it.
+class vtkPolyDataNormalsSplitPolys
+{
+public:
+  vtkPolyData* OldMesh;
+  vtkPolyData* NewMesh;
+  const vtkIdType* LinkOffsets;
+  const int* Regions;
+  const int* NumberOfRegions;
+  const vtkIdType* SplitOffsets;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType npts, *pts, *cells;
+    unsigned short ncells;
+    for (vtkIdType cellId=begin; cellId < end; cellId++)
+      {
+      this->NewMesh->GetCellPoints(cellId, npts, pts);
+      for (vtkIdType i=0; i < npts; i++)
+        {
+        vtkIdType ptId = pts[i];
+        if (this->NumberOfRegions[ptId] <= 1)
+          {
+          continue;
+          }
+        this->OldMesh->GetPointCells(ptId, ncells, cells);
+        int idx = vtkPolyDataNormalsFindCell(cellId, cells, ncells);
+        int region = this->Regions[this->LinkOffsets[ptId] + idx];
+        if (region > 0)
+          {
+          pts[i] = this->SplitOffsets[ptId] + region - 1;
+          }
+        }
+      }
+  }
+};
+
+// Averages the normals of the polygons around each (possibly split) point.
+// The polygons are gathered from the links of the original point, so each
+// output normal is only written by the thread processing its original
+// point, and sums in the same order as a serial traversal of the polygons.
+class vtkPolyDataNormalsPointNormals
+{
+public:
+  vtkPolyData* Mesh;
+  const float* PolyNormals;
+  const vtkIdType* LinkOffsets;
+  const int* Regions;
+  const int* NumberOfRegions;
+  const vtkIdType* SplitOffsets;
+  float* Normals;
+  double FlipDirection;
+
+  vtkSMPThreadLocal<std::vector<double> > Sums;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<double>& sums = this->Sums.Local();
+    vtkIdType *cells;
+    unsigned short ncells;
+    for (vtkIdType ptId=begin; ptId < end; ptId++)
+      {
+      this->Mesh->GetPointCells(ptId, ncells, cells);
+      int numRegions = 1;
+      if (this->SplitOffsets && this->NumberOfRegions[ptId] > 1)
+        {
+        numRegions = this->NumberOfRegions[ptId];
+        }
+      sums.assign(3*numRegions, 0.0);
+      for (int j=0; j < ncells; j++)
+        {
+        const float* polyNormal = this->PolyNormals + 3*cells[j];
+        double* sum = &sums[0];
+        if (numRegions > 1)
+          {
+          sum += 3*this->Regions[this->LinkOffsets[ptId] + j];
+          }
+        sum[0] += polyNormal[0];
+        sum[1] += polyNormal[1];
+        sum[2] += polyNormal[2];
+        }
+      for (int r=0; r < numRegions; r++)
+        {
+        double* sum = &sums[3*r];
+        double length = vtkMath::Norm(sum);
+        if (length != 0.0)
+          {
+          length = this->FlipDirection / length;
+          }
+        vtkIdType id = r == 0 ? ptId : this->SplitOffsets[ptId] + r - 1;
+        float* normal = this->Normals + 3*id;
+        normal[0] = static_cast<float>(sum[0] * length);
+        normal[1] = static_cast<float>(sum[1] * length);
+        normal[2] = static_cast<float>(sum[2] * length);
+        }
+      }
+  }
+};
+
+// Runs the functor over the range [0, n) in chunks, updating the progress
+// of the filter from progressBegin to progressEnd and checking for an
+// abort between the chunks.
+template<class Functor>
+void vtkPolyDataNormalsFor(vtkAlgorithm *self, vtkIdType n, Functor &functor,
+                           double progressBegin, double progressEnd)
+{
+  vtkIdType chunk = n/20 + 1;
+  for (vtkIdType begin = 0; begin < n && !self->GetAbortExecute();
+       begin += chunk)
+    {
+    self->UpdateProgress(progressBegin +
+      (progressEnd - progressBegin)*static_cast<double>(begin)/n);
+    vtkSMPTools::For(begin, (n - begin > chunk ? begin + chunk : n), functor);
+    }
+}
+}
+
 // Construct with feature angle=30, splitting and consistency turned on,
 // flipNormals turned off, and non-manifold traversal turned on.
 vtkPolyDataNormals::vtkPolyDataNormals()
@@ -67,10 +400,8 @@ int vtkPolyDataNormals::RequestData(
 
   int j;
   vtkIdType npts = 0;
-  vtkIdType i;
   vtkIdType *pts = 0;
   vtkIdType numNewPts;
-  double polyNormal[3], vertNormal[3], length;
   double flipDirection=1.0;
   vtkIdType numPolys, numStrips;
   vtkIdType cellId;
@@ -95,7 +426,6 @@ int vtkPolyDataNormals::RequestData(
     return 1;
     }
 
-
   // If there is nothing to do, pass the data through
   if ( (this->ComputePointNormals == 0 && this->ComputeCellNormals == 0) ||
        (numPolys < 1 && numStrips < 1) )
@@ -161,7 +491,7 @@ int vtkPolyDataNormals::RequestData(
 
   // The visited array keeps track of which polygons have been visited.
   //
-  if ( this->Consistency || this->Splitting || this->AutoOrientNormals )
+  if ( this->Consistency || this->AutoOrientNormals )
     {
     this->Visited = new int[numPolys];
     memset(this->Visited, VTK_CELL_NOT_VISITED, numPolys*sizeof(int));
@@ -317,20 +647,30 @@ int vtkPolyDataNormals::RequestData(
   this->PolyNormals->SetName("Normals");
   this->PolyNormals->SetNumberOfTuples(numPolys);
 
-  for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts);
-       cellId++ )
+  // vtkPoints::GetPoint() is only thread safe once it has been called from
+  // a single thread.
+  inPts->GetPoint(0, n);
+  vtkPolyDataNormalsPolyNormals polyNormals;
+  polyNormals.Mesh = this->NewMesh;
+  polyNormals.Points = inPts;
+  polyNormals.Normals = this->PolyNormals->GetPointer(0);
+  vtkPolyDataNormalsFor(this, numPolys, polyNormals, 0.333, 0.5);
+
+  this->UpdateProgress(0.5);
+
+  // Offsets of the points in a flat array of their cell links.
+  std::vector<vtkIdType> linkOffsets(numPts+1);
+  linkOffsets[0] = 0;
+  unsigned short ncells;
+  vtkIdType *cells;
+  for (ptId=0; ptId < numPts; ptId++)
     {
-    if ((cellId % 1000) == 0)
-      {
-      this->UpdateProgress (0.333 + 0.333 * (double) cellId / (double) numPolys);
-      if (this->GetAbortExecute())
-        {
-        break;
-        }
-      }
-    vtkPolygon::ComputeNormal(inPts, npts, pts, n);
-    this->PolyNormals->SetTuple(cellId,n);
+    this->OldMesh->GetPointCells(ptId, ncells, cells);
+    linkOffsets[ptId+1] = linkOffsets[ptId] + ncells;
     }
+  std::vector<int> regions;
+  std::vector<int> numberOfRegions;
+  std::vector<vtkIdType> splitOffsets;
 
   // Split mesh if sharp features
   if ( this->Splitting )
@@ -343,19 +683,53 @@ int vtkPolyDataNormals::RequestData(
     //  Splitting will create new points.  We have to create index array
     // to map new points into old points.
     //
-    this->Map = vtkIdList::New();
-    this->Map->SetNumberOfIds(numPts);
-    for (i=0; i < numPts; i++)
+    // The polygons around each point are first labeled with the region
+    // they belong to, which determines how many times the point is split.
+    // The split points are numbered in point order, after the input points.
+    regions.resize(linkOffsets[numPts]);
+    numberOfRegions.resize(numPts);
+    vtkPolyDataNormalsMarkPoints markPoints;
+    markPoints.Mesh = this->OldMesh;
+    markPoints.PolyNormals = this->PolyNormals->GetPointer(0);
+    markPoints.CosAngle = this->CosAngle;
+    markPoints.LinkOffsets = &linkOffsets[0];
+    markPoints.Regions = regions.empty() ? NULL : &regions[0];
+    markPoints.NumberOfRegions = &numberOfRegions[0];
+    vtkPolyDataNormalsFor(this, numPts, markPoints, 0.5, 0.65);
+
+    splitOffsets.resize(numPts);
+    numNewPts = numPts;
+    for (ptId=0; ptId < numPts; ptId++)
       {
-      this->Map->SetId(i,i);
+      splitOffsets[ptId] = numNewPts;
+      if (numberOfRegions[ptId] > 1)
+        {
+        numNewPts += numberOfRegions[ptId] - 1;
+        }
       }
 
+    this->Map = vtkIdList::New();
+    this->Map->SetNumberOfIds(numNewPts);
     for (ptId=0; ptId < numPts; ptId++)
       {
-      this->MarkAndSplit(ptId);
-      }//for all input points
+      this->Map->SetId(ptId,ptId);
+      for (j=1; j < numberOfRegions[ptId]; j++)
+        {
+        this->Map->SetId(splitOffsets[ptId] + j - 1, ptId);
+        }
+      }
 
-    numNewPts = this->Map->GetNumberOfIds();
+    if (numNewPts > numPts)
+      {
+      vtkPolyDataNormalsSplitPolys splitPolys;
+      splitPolys.OldMesh = this->OldMesh;
+      splitPolys.NewMesh = this->NewMesh;
+      splitPolys.LinkOffsets = &linkOffsets[0];
+      splitPolys.Regions = &regions[0];
+      splitPolys.NumberOfRegions = &numberOfRegions[0];
+      splitPolys.SplitOffsets = &splitOffsets[0];
+      vtkPolyDataNormalsFor(this, numPolys, splitPolys, 0.65, 0.75);
+      }
 
     vtkDebugMacro(<<"Created " << numNewPts-numPts << " new points");
 
@@ -405,7 +779,7 @@ int vtkPolyDataNormals::RequestData(
     outPD->PassData(pd);
     }
 
-  if ( this->Consistency || this->Splitting )
+  if ( this->Consistency || this->AutoOrientNormals )
     {
     delete [] this->Visited;
     this->CellIds->Delete();
@@ -425,43 +799,26 @@ int vtkPolyDataNormals::RequestData(
   newNormals->SetNumberOfComponents(3);
   newNormals->SetNumberOfTuples(numNewPts);
   newNormals->SetName("Normals");
-  n[0] = n[1] = n[2] = 0.0;
-  for (i=0; i < numNewPts; i++)
-    {
-    newNormals->SetTuple(i,n);
-    }
 
   if (this->ComputePointNormals)
     {
-    for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts);
-          cellId++ )
-      {
-      this->PolyNormals->GetTuple(cellId, polyNormal);
-
-      for (i=0; i < npts; i++)
-        {
-        newNormals->GetTuple(pts[i], vertNormal);
-        for (j=0; j < 3; j++)
-          {
-          n[j] = vertNormal[j] + polyNormal[j];
-          }
-        newNormals->SetTuple(pts[i],n);
-        }
-      }
-
-    for (i=0; i < numNewPts; i++)
-      {
-      newNormals->GetTuple(i, vertNormal);
-      length = vtkMath::Norm(vertNormal);
-      if (length != 0.0)
-        {
-        for (j=0; j < 3; j++)
-          {
-          n[j] = vertNormal[j] / length * flipDirection;
-          }
-        }
-      newNormals->SetTuple(i,n);
-      }
+    vtkPolyDataNormalsPointNormals pointNormals;
+    pointNormals.Mesh = this->OldMesh;
+    pointNormals.PolyNormals = this->PolyNormals->GetPointer(0);
+    pointNormals.LinkOffsets = &linkOffsets[0];
+    pointNormals.Regions = regions.empty() ? NULL : &regions[0];
+    pointNormals.NumberOfRegions =
+      numberOfRegions.empty() ? NULL : &numberOfRegions[0];
+    pointNormals.SplitOffsets =
+      splitOffsets.empty() ? NULL : &splitOffsets[0];
+    pointNormals.Normals = newNormals->GetPointer(0);
+    pointNormals.FlipDirection = flipDirection;
+    vtkPolyDataNormalsFor(this, numPts, pointNormals, 0.80, 1.0);
+    }
+  else
+    {
+    float* normals = newNormals->GetPointer(0);
+    std::fill(normals, normals + 3*numNewPts, 0.0f);
     }
 
   //  Update ourselves.  If no new nodes have been created (i.e., no
@@ -577,167 +934,6 @@ void vtkPolyDataNormals::TraverseAndOrder (void)
   return;
 }
 
-//
-//  Mark polygons around vertex.  Create new vertex (if necessary) and
-//  replace (i.e., split mesh).
-//
-void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
-{
-  int i,j;
-
-  // Get the cells using this point and make sure that we have to do something
-  unsigned short ncells;
-  vtkIdType *cells;
-  this->OldMesh->GetPointCells(ptId,ncells,cells);
-  if ( ncells <= 1 )
-    {
-    return; //point does not need to be further disconnected
-    }
-
-  // Start moving around the "cycle" of points using the point. Label
-  // each point as requiring a visit. Then label each subregion of cells
-  // connected to this point that are connected (and not separated by
-  // a feature edge) with a given region number. For each N regions
-  // created, N-1 duplicate (split) points are created. The split point
-  // replaces the current point ptId in the polygons connectivity array.
-  //
-  // Start by initializing the cells as unvisited
-  for (i=0; i<ncells; i++)
-    {
-    this->Visited[cells[i]] = -1;
-    }
-
-  // Loop over all cells and mark the region that each is in.
-  //
-  vtkIdType numPts;
-  vtkIdType *pts;
-  int numRegions = 0;
-  vtkIdType spot, neiPt[2], nei, cellId, neiCellId;
-  double thisNormal[3], neiNormal[3];
-  for (j=0; j<ncells; j++) //for all cells connected to point
-    {
-    if ( this->Visited[cells[j]] < 0 ) //for all unvisited cells
-      {
-      this->Visited[cells[j]] = numRegions;
-      //okay, mark all the cells connected to this seed cell and using ptId
-      this->OldMesh->GetCellPoints(cells[j],numPts,pts);
-
-      //find the two edges
-      for (spot=0; spot < numPts; spot++)
-        {
-        if ( pts[spot] == ptId )
-          {
-          break;
-          }
-        }
-
-      if ( spot == 0 )
-        {
-        neiPt[0] = pts[spot+1];
-        neiPt[1] = pts[numPts-1];
-        }
-      else if ( spot == (numPts-1) )
-        {
-        neiPt[0] = pts[spot-1];
-        neiPt[1] = pts[0];
-        }
-      else
-        {
-        neiPt[0] = pts[spot+1];
-        neiPt[1] = pts[spot-1];
-        }
-
-      for (i=0; i<2; i++) //for each of the two edges of the seed cell
-        {
-        cellId = cells[j];
-        nei = neiPt[i];
-        while ( cellId >= 0 ) //while we can grow this region
-          {
-          this->OldMesh->GetCellEdgeNeighbors(cellId,ptId,nei,this->CellIds);
-          if ( this->CellIds->GetNumberOfIds() == 1 &&
-               this->Visited[(neiCellId=this->CellIds->GetId(0))] < 0 )
-            {
-            this->PolyNormals->GetTuple(cellId, thisNormal);
-            this->PolyNormals->GetTuple(neiCellId, neiNormal);
-
-            if ( vtkMath::Dot(thisNormal,neiNormal) > CosAngle )
-              {
-              //visit and arrange to visit next edge neighbor
-              this->Visited[neiCellId] = numRegions;
-              cellId = neiCellId;
-              this->OldMesh->GetCellPoints(cellId,numPts,pts);
-
-              for (spot=0; spot < numPts; spot++)
-                {
-                if ( pts[spot] == ptId )
-                  {
-                  break;
-                  }
-                }
-
-              if (spot == 0)
-                {
-                nei = (pts[spot+1] != nei ? pts[spot+1] : pts[numPts-1]);
-                }
-              else if (spot == (numPts-1))
-                {
-                nei = (pts[spot-1] != nei ? pts[spot-1] : pts[0]);
-                }
-              else
-                {
-                nei = (pts[spot+1] != nei ? pts[spot+1] : pts[spot-1]);
-                }
-
-              }//if not separated by edge angle
-            else
-              {
-              cellId = -1; //separated by edge angle
-              }
-            }//if can move to edge neighbor
-          else
-            {
-            cellId = -1;//separated by previous visit, boundary, or non-manifold
-            }
-          }//while visit wave is propagating
-        }//for each of the two edges of the starting cell
-      numRegions++;
-      }//if cell is unvisited
-    }//for all cells connected to point ptId
-
-  if ( numRegions <=1 )
-    {
-    return; //a single region, no splitting ever required
-    }
-
-  // Okay, for all cells not in the first region, the ptId is
-  // replaced with a new ptId, which is a duplicate of the first
-  // point, but disconnected topologically.
-  //
-  vtkIdType lastId = this->Map->GetNumberOfIds();
-  vtkIdType replacementPoint;
-  for (j=0; j<ncells; j++)
-    {
-    if (this->Visited[cells[j]] > 0 ) //replace point if splitting needed
-      {
-      replacementPoint = lastId + this->Visited[cells[j]] - 1;
-
-      this->Map->InsertId(replacementPoint, ptId);
-
-      this->NewMesh->GetCellPoints(cells[j],numPts,pts);
-      for (i=0; i < numPts; i++)
-        {
-        if ( pts[i] == ptId )
-          {
-          pts[i] = replacementPoint; // this is very nasty! direct write!
-          break;
-          }
-        }//replace ptId with split point
-      }//if not in first regions and requiring splitting
-    }//for all cells connected to ptId
-
-  return;
-}
-
 void vtkPolyDataNormals::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
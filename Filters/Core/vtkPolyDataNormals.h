@@ -35,7 +35,8 @@
 // The algorithm works by determining normals for each polygon and then
 // averaging them at shared points. When sharp edges are present, the edges
 // are split and new points generated to prevent blurry edges (due to
-// Gouraud shading).
+// Gouraud shading). The polygon normals, the splitting and the averaging
+// at the points are computed in parallel with vtkSMPTools.
 
 // .SECTION Caveats
 // Normals are computed only for polygons and triangle strips. Normals are
@@ -80,7 +81,10 @@ public:
   vtkBooleanMacro(Splitting,int);
 
   // Description:
-  // Turn on/off the enforcement of consistent polygon ordering.
+  // Turn on/off the enforcement of consistent polygon ordering. The
+  // traversal of the polygons this requires is the only serial part of the
+  // filter: turn it off when the ordering is known to be consistent, e.g.
+  // when the same deforming mesh is processed at every time step.
   vtkSetMacro(Consistency,int);
   vtkGetMacro(Consistency,int);
   vtkBooleanMacro(Consistency,int);
@@ -168,10 +172,6 @@ private:
   // checked and properly ordered polygons.
   void TraverseAndOrder(void);
 
-  // Check the point id give to see whether it lies on a feature
-  // edge. If so, split the point (i.e., duplicate it) to topologically
-  // separate the mesh.
-  void MarkAndSplit(vtkIdType ptId);
 
 private:
   vtkPolyDataNormals(const vtkPolyDataNormals&);  // Not implemented.
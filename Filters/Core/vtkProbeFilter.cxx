@@ -14,9 +14,12 @@
 =========================================================================*/
 #include "vtkProbeFilter.h"
 
+#include "vtkAbstractCellLocator.h"
 #include "vtkCell.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCharArray.h"
+#include "vtkGenericCell.h"
 #include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
@@ -24,17 +27,188 @@
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 vtkStandardNewMacro(vtkProbeFilter);
+vtkCxxSetObjectMacro(vtkProbeFilter, CellLocatorPrototype,
+                     vtkAbstractCellLocator);
 
 class vtkProbeFilter::vtkVectorOfArrays :
   public std::vector<vtkDataArray*>
 {
 };
 
+namespace
+{
+// Probing status of the points, used by the parallel probing.
+enum
+{
+  PROBE_SKIPPED = 0, // already probed by a previous source
+  PROBE_HIT,
+  PROBE_MISSED
+};
+
+typedef std::vector<std::pair<vtkDataArray*, vtkDataArray*> >
+  vtkProbeFilterArrayPairs;
+
+// Probes a range of points. Each thread has its own cell and weights; the
+// output arrays must have been sized beforehand so that they are only
+// written to (at distinct tuples), never resized.
+class vtkProbeFilterProbePoints
+{
+public:
+  vtkDataSet* Input;
+  vtkDataSet* Source;
+  vtkAbstractCellLocator* Locator;
+  vtkPointData* SourcePD;
+  vtkPointData* OutPD;
+  vtkDataSetAttributes::FieldList* PointList;
+  int SrcIdx;
+  vtkProbeFilterArrayPairs* CellArrays;
+  unsigned char* Status;
+  double Tol2;
+  int MaxCellSize;
+
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+  vtkSMPThreadLocal<std::vector<double> > Weights;
+
+  void Initialize()
+  {
+    this->Weights.Local().resize(this->MaxCellSize);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkGenericCell* cell = this->Cell.Local();
+    double* weights = &this->Weights.Local()[0];
+    double x[3], pcoords[3], closestPoint[3], dist2;
+    int subId;
+
+    for (vtkIdType ptId=begin; ptId < end; ptId++)
+      {
+      if (this->Status[ptId] == PROBE_SKIPPED)
+        {
+        continue;
+        }
+      this->Input->GetPoint(ptId, x);
+
+      vtkIdType cellId;
+      if (this->Locator)
+        {
+        cellId = this->Locator->FindCell(x, this->Tol2, cell, pcoords,
+                                         weights);
+        }
+      else
+        {
+        cellId = this->Source->FindCell(x, NULL, cell, -1, this->Tol2,
+                                        subId, pcoords, weights);
+        if (cellId >= 0)
+          {
+          this->Source->GetCell(cellId, cell);
+          }
+        }
+
+      // Same check as the serial path: reject points found with the
+      // dataset wide tolerance that are too far from the cell.
+      if (cellId >= 0)
+        {
+        cell->EvaluatePosition(x, closestPoint, subId, pcoords, dist2,
+                               weights);
+        if (dist2 > cell->GetLength2() * 0.01)
+          {
+          cellId = -1;
+          }
+        }
+
+      if (cellId < 0)
+        {
+        this->Status[ptId] = PROBE_MISSED;
+        continue;
+        }
+
+      this->OutPD->InterpolatePoint((*this->PointList), this->SourcePD,
+                                    this->SrcIdx, ptId, cell->PointIds,
+                                    weights);
+      vtkProbeFilterArrayPairs::iterator iter;
+      for (iter = this->CellArrays->begin();
+           iter != this->CellArrays->end(); ++iter)
+        {
+        iter->second->SetTuple(ptId, cellId, iter->first);
+        }
+      this->Status[ptId] = PROBE_HIT;
+      }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+// Return true if tuples of the array can be read and written concurrently
+// (at distinct tuples for writing).
+bool vtkProbeFilterIsThreadSafe(vtkAbstractArray* array)
+{
+  return array && vtkDataArray::SafeDownCast(array) &&
+    array->GetDataType() != VTK_BIT && array->HasStandardMemoryLayout();
+}
+
+// Return the time at which the geometry (points and connectivity) of a
+// point set was last modified, as opposed to its attributes.
+unsigned long vtkProbeFilterGetGeometryMTime(vtkPointSet* ps)
+{
+  unsigned long mtime = ps->GetPoints() ? ps->GetPoints()->GetMTime() : 0;
+  if (vtkUnstructuredGrid* ug = vtkUnstructuredGrid::SafeDownCast(ps))
+    {
+    if (ug->GetCells())
+      {
+      mtime = std::max(mtime, ug->GetCells()->GetMTime());
+      }
+    if (ug->GetCellTypesArray())
+      {
+      mtime = std::max(mtime, ug->GetCellTypesArray()->GetMTime());
+      }
+    }
+  else if (vtkPolyData* pd = vtkPolyData::SafeDownCast(ps))
+    {
+    vtkCellArray* cells[4] =
+      { pd->GetVerts(), pd->GetLines(), pd->GetPolys(), pd->GetStrips() };
+    for (int i=0; i < 4; i++)
+      {
+      if (cells[i])
+        {
+        mtime = std::max(mtime, cells[i]->GetMTime());
+        }
+      }
+    }
+  return mtime;
+}
+
+// Return the object holding the connectivity of a point set, if any.
+vtkObject* vtkProbeFilterGetCells(vtkPointSet* ps)
+{
+  if (vtkUnstructuredGrid* ug = vtkUnstructuredGrid::SafeDownCast(ps))
+    {
+    return ug->GetCells();
+    }
+  else if (vtkPolyData* pd = vtkPolyData::SafeDownCast(ps))
+    {
+    return pd->GetPolys();
+    }
+  return NULL;
+}
+}
+
 //----------------------------------------------------------------------------
 vtkProbeFilter::vtkProbeFilter()
 {
@@ -56,6 +230,11 @@ vtkProbeFilter::vtkProbeFilter()
   this->PassCellArrays = 0;
   this->PassPointArrays = 0;
   this->PassFieldArrays = 1;
+
+  this->CellLocatorPrototype = 0;
+  this->CellLocator = 0;
+  this->CellLocatorPoints = 0;
+  this->CellLocatorCells = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -70,6 +249,12 @@ vtkProbeFilter::~vtkProbeFilter()
 
   delete this->PointList;
   delete this->CellList;
+
+  this->SetCellLocatorPrototype(0);
+  if (this->CellLocator)
+    {
+    this->CellLocator->Delete();
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -237,6 +422,66 @@ void vtkProbeFilter::Probe(vtkDataSet *input, vtkDataSet *source,
   this->ProbeEmptyPoints(input, 0, source, output);
 }
 
+//----------------------------------------------------------------------------
+vtkAbstractCellLocator* vtkProbeFilter::GetSourceCellLocator(
+  vtkDataSet *source)
+{
+  vtkPointSet* ps = vtkPointSet::SafeDownCast(source);
+  if (!this->CellLocatorPrototype || !ps || ps->GetNumberOfCells() < 1)
+    {
+    return NULL;
+    }
+
+  if (this->CellLocator &&
+      strcmp(this->CellLocator->GetClassName(),
+             this->CellLocatorPrototype->GetClassName()) != 0)
+    {
+    this->CellLocator->Delete();
+    this->CellLocator = NULL;
+    }
+  if (!this->CellLocator)
+    {
+    this->CellLocator = this->CellLocatorPrototype->NewInstance();
+    }
+
+  // The locator only depends on the geometry of the source. A new source
+  // object sharing the points and cells of the previous one (e.g. the next
+  // time step of a static mesh) can use the same search structure. The
+  // pointers are only compared: a deleted and reallocated object would have
+  // been modified after the locator was built.
+  vtkObject* points = ps->GetPoints();
+  vtkObject* cells = vtkProbeFilterGetCells(ps);
+  unsigned long buildTime = this->CellLocator->GetBuildTime();
+  if (this->CellLocator->GetDataSet() && buildTime > 0 &&
+      points == this->CellLocatorPoints && cells == this->CellLocatorCells &&
+      vtkProbeFilterGetGeometryMTime(ps) < buildTime &&
+      this->CellLocatorPrototype->GetMTime() < buildTime)
+    {
+    vtkDebugMacro("Reusing the source cell locator");
+    this->CellLocator->SetDataSet(source);
+    return this->CellLocator;
+    }
+
+  vtkAbstractCellLocator* prototype = this->CellLocatorPrototype;
+  this->CellLocator->SetAutomatic(prototype->GetAutomatic());
+  this->CellLocator->SetMaxLevel(prototype->GetMaxLevel());
+  this->CellLocator->SetTolerance(prototype->GetTolerance());
+  this->CellLocator->SetNumberOfCellsPerNode(
+    prototype->GetNumberOfCellsPerNode());
+  this->CellLocator->SetCacheCellBounds(prototype->GetCacheCellBounds());
+  this->CellLocator->LazyEvaluationOff();
+  this->CellLocator->UseExistingSearchStructureOff();
+  this->CellLocator->SetDataSet(source);
+  // The locator would otherwise not be rebuilt if only the attributes of
+  // the previous source it was built on changed.
+  this->CellLocator->Modified();
+  this->CellLocator->BuildLocator();
+  this->CellLocatorPoints = points;
+  this->CellLocatorCells = cells;
+
+  return this->CellLocator;
+}
+
 //----------------------------------------------------------------------------
 void vtkProbeFilter::ProbeEmptyPoints(vtkDataSet *input,
   int srcIdx,
@@ -297,79 +542,200 @@ void vtkProbeFilter::ProbeEmptyPoints(vtkDataSet *input,
   // Don't go below epsilon for a double
   tol2 = (tol2 < VTK_DBL_EPSILON) ? VTK_DBL_EPSILON : tol2;
 
-  // Loop over all input points, interpolating source data
-  //
-  int abort=0;
-  vtkIdType progressInterval=numPts/20 + 1;
-  for (ptId=0; ptId < numPts && !abort; ptId++)
+  vtkAbstractCellLocator* locator = this->GetSourceCellLocator(source);
+
+  // Points can be probed in parallel when the cells are found through a
+  // cell locator or analytically (image data), as long as all the arrays
+  // can be accessed concurrently.
+  vtkProbeFilterArrayPairs cellArrays;
+  bool parallel = (locator != NULL || source->IsA("vtkImageData"));
+  for (int i=0; parallel && i < outPD->GetNumberOfArrays(); i++)
+    {
+    parallel = vtkProbeFilterIsThreadSafe(outPD->GetAbstractArray(i));
+    }
+  for (int i=0; parallel && i < pd->GetNumberOfArrays(); i++)
     {
-    if ( !(ptId % progressInterval) )
+    parallel = vtkProbeFilterIsThreadSafe(pd->GetAbstractArray(i));
+    }
+  vtkVectorOfArrays::iterator iter;
+  for (iter = this->CellArrays->begin();
+       parallel && iter != this->CellArrays->end(); ++iter)
+    {
+    vtkDataArray* inArray = cd->GetArray((*iter)->GetName());
+    if (inArray)
       {
-      this->UpdateProgress(static_cast<double>(ptId)/numPts);
-      abort = GetAbortExecute();
+      parallel = vtkProbeFilterIsThreadSafe(inArray) &&
+        inArray->GetDataType() == (*iter)->GetDataType() &&
+        inArray->GetNumberOfComponents() == (*iter)->GetNumberOfComponents();
+      cellArrays.push_back(std::make_pair(inArray, *iter));
       }
+    }
 
-    if (maskArray[ptId] == static_cast<char>(1))
+  if (parallel && numPts > 0)
+    {
+    // Size the output arrays up front so that the threads only write to
+    // them.
+    for (int i=0; i < outPD->GetNumberOfArrays(); i++)
       {
-      // skip points which have already been probed with success.
-      // This is helpful for multiblock dataset probing.
-      continue;
+      vtkAbstractArray* array = outPD->GetAbstractArray(i);
+      if (array->GetNumberOfTuples() < numPts)
+        {
+        array->SetNumberOfTuples(numPts);
+        }
       }
 
-    // Get the xyz coordinate of the point in the input dataset
-    input->GetPoint(ptId, x);
+    vtkUnsignedCharArray* status = vtkUnsignedCharArray::New();
+    status->SetNumberOfTuples(numPts);
+    for (ptId=0; ptId < numPts; ptId++)
+      {
+      status->SetValue(ptId, maskArray[ptId] == static_cast<char>(1) ?
+                       PROBE_SKIPPED : PROBE_MISSED);
+      }
 
-    // Find the cell that contains xyz and get it
-    vtkIdType cellId = source->FindCell(x,NULL,-1,tol2,subId,pcoords,weights);
-    if (cellId >= 0)
+    // These are only thread safe once they have been called from a single
+    // thread.
+    input->GetPoint(0, x);
+    if (source->GetNumberOfCells() > 0)
       {
-      cell = source->GetCell(cellId);
-      // If we found a cell, let's make sure that the point is within
-      // a certain size of the cell when it is slightly outside.
-      // The tolerance check above is based on the bounds of the whole
-      // dataset which may be significantly larger than the cell. When
-      // that happens, even a small tolerance may lead to finding a cell
-      // when the point is significantly outside that cell. This check
-      // is based on the cell's size. The tolerance here is significantly
-      // larger, 1/10 the size of the cell.
-      double dist2;
-      double closestPoint[3];
-      cell->EvaluatePosition(x, closestPoint, subId,
-                             pcoords, dist2, weights);
-      if (dist2 > cell->GetLength2() * 0.01)
-        {
-        cell = 0;
-        }
+      vtkGenericCell* cell0 = vtkGenericCell::New();
+      source->GetCell(0, cell0);
+      cell0->Delete();
       }
-    else
+
+    vtkProbeFilterProbePoints probe;
+    probe.Input = input;
+    probe.Source = source;
+    probe.Locator = locator;
+    probe.SourcePD = pd;
+    probe.OutPD = outPD;
+    probe.PointList = this->PointList;
+    probe.SrcIdx = srcIdx;
+    probe.CellArrays = &cellArrays;
+    probe.Status = status->GetPointer(0);
+    probe.Tol2 = tol2;
+    probe.MaxCellSize = mcs > 0 ? mcs : 1;
+
+    // The points are probed in parallel, a range of points at a time, so
+    // that progress is reported and the execution can be aborted.
+    vtkIdType progressInterval=numPts/20 + 1;
+    for (ptId=0; ptId < numPts && !this->GetAbortExecute();
+         ptId += progressInterval)
       {
-      cell = 0;
+      this->UpdateProgress(static_cast<double>(ptId)/numPts);
+      vtkIdType endId = ptId + progressInterval;
+      vtkSMPTools::For(ptId, (endId < numPts ? endId : numPts), probe);
       }
-    if (cell)
+
+    // Record the results in point order, as the serial path does.
+    unsigned char* statusArray = status->GetPointer(0);
+    for (ptId=0; ptId < numPts; ptId++)
       {
-      // Interpolate the point data
-      outPD->InterpolatePoint((*this->PointList), pd, srcIdx, ptId,
-        cell->PointIds, weights);
-      this->ValidPoints->InsertNextValue(ptId);
-      this->NumberOfValidPoints++;
-      vtkVectorOfArrays::iterator iter;
-      for (iter = this->CellArrays->begin(); iter != this->CellArrays->end();
-        ++iter)
+      if (statusArray[ptId] == PROBE_HIT)
         {
-        vtkDataArray* inArray = cd->GetArray((*iter)->GetName());
-        if (inArray)
-          {
-          outPD->CopyTuple(inArray, *iter, cellId, ptId);
-          }
+        this->ValidPoints->InsertNextValue(ptId);
+        this->NumberOfValidPoints++;
+        maskArray[ptId] = static_cast<char>(1);
+        }
+      else if (statusArray[ptId] == PROBE_MISSED && this->UseNullPoint)
+        {
+        outPD->NullPoint(ptId);
         }
-      maskArray[ptId] = static_cast<char>(1);
       }
-    else
+    status->Delete();
+
+    this->UpdateProgress(1.0);
+    }
+  else
+    {
+    vtkGenericCell* genericCell = locator ? vtkGenericCell::New() : NULL;
+
+    // Loop over all input points, interpolating source data
+    //
+    int abort=0;
+    vtkIdType progressInterval=numPts/20 + 1;
+    for (ptId=0; ptId < numPts && !abort; ptId++)
       {
-      if (this->UseNullPoint)
+      if ( !(ptId % progressInterval) )
         {
-        outPD->NullPoint(ptId);
+        this->UpdateProgress(static_cast<double>(ptId)/numPts);
+        abort = GetAbortExecute();
+        }
+
+      if (maskArray[ptId] == static_cast<char>(1))
+        {
+        // skip points which have already been probed with success.
+        // This is helpful for multiblock dataset probing.
+        continue;
+        }
+
+      // Get the xyz coordinate of the point in the input dataset
+      input->GetPoint(ptId, x);
+
+      // Find the cell that contains xyz and get it
+      vtkIdType cellId;
+      if (locator)
+        {
+        cellId = locator->FindCell(x,tol2,genericCell,pcoords,weights);
+        cell = genericCell;
+        }
+      else
+        {
+        cellId = source->FindCell(x,NULL,-1,tol2,subId,pcoords,weights);
+        cell = cellId >= 0 ? source->GetCell(cellId) : 0;
+        }
+      if (cellId >= 0)
+        {
+        // If we found a cell, let's make sure that the point is within
+        // a certain size of the cell when it is slightly outside.
+        // The tolerance check above is based on the bounds of the whole
+        // dataset which may be significantly larger than the cell. When
+        // that happens, even a small tolerance may lead to finding a cell
+        // when the point is significantly outside that cell. This check
+        // is based on the cell's size. The tolerance here is significantly
+        // larger, 1/10 the size of the cell.
+        double dist2;
+        double closestPoint[3];
+        cell->EvaluatePosition(x, closestPoint, subId,
+                               pcoords, dist2, weights);
+        if (dist2 > cell->GetLength2() * 0.01)
+          {
+          cell = 0;
+          }
         }
+      else
+        {
+        cell = 0;
+        }
+      if (cell)
+        {
+        // Interpolate the point data
+        outPD->InterpolatePoint((*this->PointList), pd, srcIdx, ptId,
+          cell->PointIds, weights);
+        this->ValidPoints->InsertNextValue(ptId);
+        this->NumberOfValidPoints++;
+        for (iter = this->CellArrays->begin(); iter != this->CellArrays->end();
+          ++iter)
+          {
+          vtkDataArray* inArray = cd->GetArray((*iter)->GetName());
+          if (inArray)
+            {
+            outPD->CopyTuple(inArray, *iter, cellId, ptId);
+            }
+          }
+        maskArray[ptId] = static_cast<char>(1);
+        }
+      else
+        {
+        if (this->UseNullPoint)
+          {
+          outPD->NullPoint(ptId);
+          }
+        }
+      }
+
+    if (genericCell)
+      {
+      genericCell->Delete();
       }
     }
 
@@ -529,4 +895,6 @@ void vtkProbeFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ValidPoints: " << this->ValidPoints << "\n";
   os << indent << "PassFieldArrays: "
      << (this->PassFieldArrays? "On" : " Off") << "\n";
+  os << indent << "CellLocatorPrototype: "
+     << this->CellLocatorPrototype << "\n";
 }
@@ -39,6 +39,7 @@
 #include "vtkDataSetAlgorithm.h"
 #include "vtkDataSetAttributes.h" // needed for vtkDataSetAttributes::FieldList
 
+class vtkAbstractCellLocator;
 class vtkIdTypeArray;
 class vtkCharArray;
 class vtkMaskPoints;
@@ -102,6 +103,18 @@ public:
   vtkBooleanMacro(PassFieldArrays, int);
   vtkGetMacro(PassFieldArrays, int);
 
+  // Description:
+  // Set/Get the prototype cell locator used to find the source cells when
+  // the source is a vtkPointSet. When set, a locator of the same type is
+  // built on the source and kept by the filter: later executions reuse it
+  // as long as the source geometry (points and cells) has not been
+  // modified, which is typically the case when only the attributes change
+  // from one time step to the next. Using a cell locator also lets the
+  // points be probed in parallel with vtkSMPTools.
+  // By default no prototype is set and vtkDataSet::FindCell() is used.
+  virtual void SetCellLocatorPrototype(vtkAbstractCellLocator*);
+  vtkGetObjectMacro(CellLocatorPrototype, vtkAbstractCellLocator);
+
 //BTX
 protected:
   vtkProbeFilter();
@@ -146,6 +159,13 @@ protected:
   void ProbeEmptyPoints(vtkDataSet *input, int srcIdx, vtkDataSet *source,
     vtkDataSet *output);
 
+  // Description:
+  // Return a cell locator built on source, or NULL if no
+  // CellLocatorPrototype is set or source is not a vtkPointSet. The locator
+  // built by a previous call is returned as is when the geometry of source
+  // did not change since then.
+  vtkAbstractCellLocator* GetSourceCellLocator(vtkDataSet *source);
+
   char* ValidPointMaskArrayName;
   vtkIdTypeArray *ValidPoints;
   vtkCharArray* MaskPoints;
@@ -159,12 +179,19 @@ protected:
 
   vtkDataSetAttributes::FieldList* CellList;
   vtkDataSetAttributes::FieldList* PointList;
+
+  vtkAbstractCellLocator* CellLocatorPrototype;
 private:
   vtkProbeFilter(const vtkProbeFilter&);  // Not implemented.
   void operator=(const vtkProbeFilter&);  // Not implemented.
 
   class vtkVectorOfArrays;
   vtkVectorOfArrays* CellArrays;
+
+  // The cached locator and what it was built on.
+  vtkAbstractCellLocator* CellLocator;
+  vtkObject* CellLocatorPoints;
+  vtkObject* CellLocatorCells;
 //ETX
 };
 
@@ -16,6 +16,7 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkCellType.h"
 #include "vtkExecutive.h"
 #include "vtkFeatureEdges.h"
 #include "vtkInformation.h"
@@ -24,20 +25,735 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSimpleCriticalSection.h"
 #include "vtkTimerLog.h"
 #include "vtkTriangle.h"
+#include <vtksys/hash_map.hxx> // sparse storage of the visited bins
 #include <vtksys/hash_set.hxx> // keep track of inserted triangles
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkQuadricClustering);
 
 //----------------------------------------------------------------------------
-// PIMPLd STL set for keeping track of inserted cells
 struct vtkQuadricClusteringIdTypeHash {
   size_t operator()(vtkIdType val) const { return static_cast<size_t>(val); }
 };
-class vtkQuadricClusteringCellSet : public vtksys::hash_set<vtkIdType, vtkQuadricClusteringIdTypeHash> {};
-typedef vtkQuadricClusteringCellSet::iterator vtkQuadricClusteringCellSetIterator;
 
+//----------------------------------------------------------------------------
+// PIMPLd STL set for keeping track of inserted cells.  A triangle is
+// identified by the ids of its bins, in increasing order.
+struct vtkQuadricClusteringTriangle
+{
+  vtkIdType Ids[3];
+
+  bool operator==(const vtkQuadricClusteringTriangle& other) const
+    {
+    return this->Ids[0] == other.Ids[0] && this->Ids[1] == other.Ids[1] &&
+      this->Ids[2] == other.Ids[2];
+    }
+};
+struct vtkQuadricClusteringTriangleHash {
+  size_t operator()(const vtkQuadricClusteringTriangle& tri) const
+    {
+    size_t hash = static_cast<size_t>(tri.Ids[0]);
+    hash = hash * 1000003 + static_cast<size_t>(tri.Ids[1]);
+    return hash * 1000003 + static_cast<size_t>(tri.Ids[2]);
+    }
+};
+class vtkQuadricClusteringCellSet : public vtksys::hash_set<vtkQuadricClusteringTriangle, vtkQuadricClusteringTriangleHash> {};
+
+//----------------------------------------------------------------------------
+// PIMPLd STL map of the visited bins, by bin id.  Only the bins that are
+// visited are stored, so that very fine binnings can be used.  The elements
+// of the map are never moved, so pointers to the bins stay valid as bins
+// are added.
+class vtkQuadricClusteringBinMap : public vtksys::hash_map<vtkIdType, vtkQuadricClustering::PointQuadric, vtkQuadricClusteringIdTypeHash> {};
+typedef vtkQuadricClusteringBinMap::iterator vtkQuadricClusteringBinMapIterator;
+typedef vtkQuadricClusteringBinMap::mapped_type vtkQuadricClusteringBin;
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Add the quadric of a cell of the given dimension to a bin.  Points
+// supercede segments, which supercede triangles: the quadric of the bin is
+// cleared out when a lower dimensional cell is added to it, and the cells of
+// higher dimension are then ignored.
+void AddBinQuadric(vtkQuadricClusteringBin& bin, int dimension,
+                   const double quadric[9])
+{
+  int i;
+  if (bin.Dimension > dimension)
+    {
+    bin.Dimension = static_cast<unsigned char>(dimension);
+    for (i = 0; i < 9; i++)
+      {
+      bin.Quadric[i] = 0.0;
+      }
+    }
+  if (bin.Dimension == dimension)
+    {
+    for (i = 0; i < 9; i++)
+      {
+      bin.Quadric[i] += (quadric[i] * 100000000.0);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Merge the quadric accumulated in a bin (by another thread) into a bin.
+void MergeBinQuadric(vtkQuadricClusteringBin& bin,
+                     const vtkQuadricClusteringBin& other)
+{
+  int i;
+  if (bin.Dimension > other.Dimension)
+    {
+    bin.Dimension = other.Dimension;
+    for (i = 0; i < 9; i++)
+      {
+      bin.Quadric[i] = other.Quadric[i];
+      }
+    }
+  else if (bin.Dimension == other.Dimension)
+    {
+    for (i = 0; i < 9; i++)
+      {
+      bin.Quadric[i] += other.Quadric[i];
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// The error function is the volume (squared) of the tetrahedron formed by the
+// triangle and the point.  We ignore constant factors across all coefficents,
+// and the constant coefficient.
+void ComputeTriangleQuadric(double *pt0, double *pt1, double *pt2,
+                            double quadric[9])
+{
+  double quadric4x4[4][4];
+
+  vtkTriangle::ComputeQuadric(pt0, pt1, pt2, quadric4x4);
+  quadric[0] = quadric4x4[0][0];
+  quadric[1] = quadric4x4[0][1];
+  quadric[2] = quadric4x4[0][2];
+  quadric[3] = quadric4x4[0][3];
+  quadric[4] = quadric4x4[1][1];
+  quadric[5] = quadric4x4[1][2];
+  quadric[6] = quadric4x4[1][3];
+  quadric[7] = quadric4x4[2][2];
+  quadric[8] = quadric4x4[2][3];
+}
+
+//----------------------------------------------------------------------------
+// The error function is the square of the area of the triangle formed by the
+// edge and the point.  We ignore constants across all terms.
+// Returns false if the points of the edge are coincident.
+bool ComputeEdgeQuadric(const double *pt0, const double *pt1, double q[9])
+{
+  double length2, tmp;
+  double d[3];
+  double m[3];  // The mid point of the segement.(p1 or p2 could be used also).
+  double md;    // The dot product of m and d.
+
+  // Compute quadric for line segment.
+  // Line segment quadric is the area (squared) of the triangle (seg,pt)
+  // Compute the direction vector of the segment.
+  d[0] = pt1[0] - pt0[0];
+  d[1] = pt1[1] - pt0[1];
+  d[2] = pt1[2] - pt0[2];
+
+  // Compute the length^2 of the line segement.
+  length2 = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+
+  if (length2 == 0.0)
+    { // Coincident points.  Avoid divide by zero.
+    return false;
+    }
+
+  // Normalize the direction vector.
+  tmp = 1.0 / sqrt(length2);
+  d[0] = d[0] * tmp;
+  d[1] = d[1] * tmp;
+  d[2] = d[2] * tmp;
+
+  // Compute the mid point of the segment.
+  m[0] = 0.5 * (pt1[0] + pt0[0]);
+  m[1] = 0.5 * (pt1[1] + pt0[1]);
+  m[2] = 0.5 * (pt1[2] + pt0[2]);
+
+  // Compute dot(m, d);
+  md = m[0]*d[0] + m[1]*d[1] + m[2]*d[2];
+
+  // We save nine coefficients of the error function cooresponding to:
+  // 0: Px^2
+  // 1: PxPy
+  // 2: PxPz
+  // 3: Px
+  // 4: Py^2
+  // 5: PyPz
+  // 6: Py
+  // 7: Pz^2
+  // 8: Pz
+  // We ignore the constant because it disappears with the derivative.
+  q[0] = length2*(1.0 - d[0]*d[0]);
+  q[1] = -length2*(d[0]*d[1]);
+  q[2] = -length2*(d[0]*d[2]);
+  q[3] = length2*(d[0]*md - m[0]);
+  q[4] = length2*(1.0 - d[1]*d[1]);
+  q[5] = -length2*(d[1]*d[2]);
+  q[6] = length2*(d[1]*md - m[1]);
+  q[7] = length2*(1.0 - d[2]*d[2]);
+  q[8] = length2*(d[2]*md - m[2]);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// The error function is the length (point to vert) squared.
+// We ignore constants across all terms.
+void ComputeVertexQuadric(const double *pt, double q[9])
+{
+  // The nine coefficients are ordered as for the edges.
+  q[0] = 1.0;
+  q[1] = 0.0;
+  q[2] = 0.0;
+  q[3] = -pt[0];
+  q[4] = 1.0;
+  q[5] = 0.0;
+  q[6] = -pt[1];
+  q[7] = 1.0;
+  q[8] = -pt[2];
+}
+}
+
+//----------------------------------------------------------------------------
+// PIMPLd bin ids of the points, computed in parallel, so that each point is
+// hashed once rather than once for each cell that uses it.  They are kept
+// until other points, or modified points, are used.
+class vtkQuadricClusteringPointBins
+{
+public:
+  vtkQuadricClusteringPointBins() : Self(NULL), Points(NULL), MTime(0) {}
+
+  // Return the bin id of each of the points.
+  const vtkIdType *GetBinIds(vtkQuadricClustering *self, vtkPoints *points)
+  {
+    vtkIdType numPts = points->GetNumberOfPoints();
+    if (points != this->Points || points->GetMTime() != this->MTime ||
+        numPts != static_cast<vtkIdType>(this->BinIds.size()))
+      {
+      this->Self = self;
+      this->Points = points;
+      this->MTime = points->GetMTime();
+      this->BinIds.resize(numPts);
+      vtkSMPTools::For(0, numPts, *this);
+      }
+    return (numPts > 0 ? &this->BinIds[0] : NULL);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double pt[3];
+    for (vtkIdType ptId = begin; ptId < end; ptId++)
+      {
+      this->Points->GetPoint(ptId, pt);
+      this->BinIds[ptId] = this->Self->HashPoint(pt);
+      }
+  }
+
+private:
+  vtkQuadricClustering *Self;
+  vtkPoints *Points;
+  unsigned long MTime;
+  std::vector<vtkIdType> BinIds;
+};
+
+//----------------------------------------------------------------------------
+// The cells of a cell array of one type (VTK_VERTEX, VTK_LINE, VTK_POLYGON
+// or VTK_TRIANGLE_STRIP), and the primitives (vertices, segments or
+// triangles) that they are made of.  The quadrics of the primitives are
+// accumulated in parallel, and the bins of the primitives are then found
+// in parallel, one batch of cells at a time, for the serial generation of
+// the output.
+class vtkQuadricClusteringCells
+{
+public:
+  vtkQuadricClusteringCells(vtkQuadricClustering *self, vtkCellArray *cells,
+                            vtkPoints *points, int cellType);
+
+  vtkIdType GetNumberOfCells()
+  {
+    return static_cast<vtkIdType>(this->Locations.size());
+  }
+
+  // Accumulate the quadrics of the primitives into the bins.
+  void Accumulate();
+
+  // Get the range of the primitives of a cell.  The bins of the primitives
+  // of the batch of cells that starts with the cell are found if needed,
+  // so the cells must be visited in order.
+  void GetPrimitives(vtkIdType cellId, vtkIdType& first, vtkIdType& last);
+
+  // Get the bins of a primitive of the current batch.  Returns false if
+  // the primitive is ignored (e.g. a segment with coincident points).
+  bool GetBins(vtkIdType primId, vtkIdType *binIds,
+               vtkQuadricClusteringBin **bins)
+  {
+    vtkQuadricClusteringBinMap::value_type **entries =
+      &this->BatchBins[this->PrimitiveSize*(primId - this->BatchOffset)];
+    if (entries[0] == NULL)
+      {
+      return false;
+      }
+    for (int i = 0; i < this->PrimitiveSize; i++)
+      {
+      binIds[i] = entries[i]->first;
+      bins[i] = &entries[i]->second;
+      }
+    return true;
+  }
+
+  // Whether the triangles that do not traverse three bins are ignored.
+  bool IsIgnored(const vtkIdType *binIds) const
+  {
+    return (this->PrimitiveSize == 3 && !this->UseInternalTriangles &&
+            (binIds[0] == binIds[1] || binIds[0] == binIds[2] ||
+             binIds[1] == binIds[2]));
+  }
+
+  const vtkIdType *Cells;
+  vtkPoints *Points;
+  int CellType;
+  int PrimitiveSize;
+  int UseInternalTriangles;
+  const vtkIdType *BinIds;
+  vtkQuadricClusteringBinMap *Bins;
+  // The location of each cell, and the index of its first primitive.
+  std::vector<vtkIdType> Locations;
+  std::vector<vtkIdType> Offsets;
+  // The bins of the primitives of the current batch of cells.
+  vtkIdType BatchBegin;
+  vtkIdType BatchEnd;
+  vtkIdType BatchOffset;
+  std::vector<vtkQuadricClusteringBinMap::value_type *> BatchBins;
+};
+
+namespace
+{
+// The number of bins that a thread accumulates before merging them into
+// the bins of the filter, so that the per-thread maps stay small.
+const size_t vtkQuadricClusteringMaxLocalBins = 65536;
+
+// The number of cells of a batch for the generation of the output.
+const vtkIdType vtkQuadricClusteringBatchSize = 65536;
+
+//----------------------------------------------------------------------------
+// Accumulates the quadrics of the cells in per-thread maps of the visited
+// bins, and merges them into the bins of the filter.
+class vtkQuadricClusteringAccumulator
+{
+public:
+  vtkQuadricClusteringAccumulator(vtkQuadricClusteringCells *cells)
+    : Cells(cells)
+  {
+  }
+
+  void Initialize()
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkQuadricClusteringBinMap& bins = this->Bins.Local();
+    const vtkIdType *binIds = this->Cells->BinIds;
+    vtkPoints *points = this->Cells->Points;
+    double pts[3][3], quadric[9];
+    vtkIdType ids[3];
+    vtkIdType j;
+    int odd;  // Used to flip order of every other triangle in a strip.
+
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      const vtkIdType *cell = this->Cells->Cells +
+        this->Cells->Locations[cellId];
+      vtkIdType numPts = cell[0];
+      const vtkIdType *ptIds = cell + 1;
+
+      switch (this->Cells->CellType)
+        {
+        case VTK_VERTEX:
+          // Can there be poly vertices?
+          for (j = 0; j < numPts; ++j)
+            {
+            points->GetPoint(ptIds[j], pts[0]);
+            ComputeVertexQuadric(pts[0], quadric);
+            AddBinQuadric(bins[binIds[ptIds[j]]], 0, quadric);
+            }
+          break;
+
+        case VTK_LINE:
+          if (numPts == 0)
+            {
+            break;
+            }
+          points->GetPoint(ptIds[0], pts[0]);
+          // This internal loop handles line strips.
+          for (j = 1; j < numPts; ++j)
+            {
+            points->GetPoint(ptIds[j], pts[1]);
+            if (ComputeEdgeQuadric(pts[0], pts[1], quadric))
+              {
+              AddBinQuadric(bins[binIds[ptIds[j-1]]], 1, quadric);
+              AddBinQuadric(bins[binIds[ptIds[j]]], 1, quadric);
+              }
+            pts[0][0] = pts[1][0];
+            pts[0][1] = pts[1][1];
+            pts[0][2] = pts[1][2];
+            }
+          break;
+
+        case VTK_POLYGON:
+          if (numPts == 0)
+            {
+            break;
+            }
+          points->GetPoint(ptIds[0], pts[0]);
+          ids[0] = ptIds[0];
+          for (j = 0; j < numPts-2; j++)//creates triangles; assumes poly is convex
+            {
+            points->GetPoint(ptIds[j+1], pts[1]);
+            points->GetPoint(ptIds[j+2], pts[2]);
+            ids[1] = ptIds[j+1];
+            ids[2] = ptIds[j+2];
+            this->AddTriangle(bins, ids, pts);
+            }
+          break;
+
+        case VTK_TRIANGLE_STRIP:
+          if (numPts < 2)
+            {
+            break;
+            }
+          points->GetPoint(ptIds[0], pts[0]);
+          points->GetPoint(ptIds[1], pts[1]);
+          ids[0] = ptIds[0];
+          ids[1] = ptIds[1];
+          odd = 0;
+          for (j = 2; j < numPts; ++j)
+            {
+            points->GetPoint(ptIds[j], pts[2]);
+            ids[2] = ptIds[j];
+            this->AddTriangle(bins, ids, pts);
+            pts[odd][0] = pts[2][0];
+            pts[odd][1] = pts[2][1];
+            pts[odd][2] = pts[2][2];
+            ids[odd] = ids[2];
+            // Toggle odd.
+            odd = odd ? 0 : 1;
+            }
+          break;
+        }
+
+      if (bins.size() > vtkQuadricClusteringMaxLocalBins)
+        {
+        this->Lock.Lock();
+        this->Merge(bins);
+        this->Lock.Unlock();
+        bins.clear();
+        }
+      }
+  }
+
+  // Add the quadric of a triangle (given by its point ids) to each of its
+  // three corner bins.
+  void AddTriangle(vtkQuadricClusteringBinMap& bins, const vtkIdType *ids,
+                   double pts[3][3])
+  {
+    const vtkIdType *pointBins = this->Cells->BinIds;
+    vtkIdType binIds[3] =
+      { pointBins[ids[0]], pointBins[ids[1]], pointBins[ids[2]] };
+
+    // Special condition for fast execution.
+    // Only add triangles that traverse three bins to quadrics.
+    if (this->Cells->IsIgnored(binIds))
+      {
+      return;
+      }
+
+    double quadric[9];
+    ComputeTriangleQuadric(pts[0], pts[1], pts[2], quadric);
+    for (int i = 0; i < 3; ++i)
+      {
+      AddBinQuadric(bins[binIds[i]], 2, quadric);
+      }
+  }
+
+  // Merge the bins of a thread into the bins of the filter.
+  void Merge(vtkQuadricClusteringBinMap& local)
+  {
+    vtkQuadricClusteringBinMap& bins = *this->Cells->Bins;
+    vtkQuadricClusteringBinMapIterator bin;
+    for (bin = local.begin(); bin != local.end(); ++bin)
+      {
+      MergeBinQuadric(bins[bin->first], bin->second);
+      }
+  }
+
+  void Reduce()
+  {
+    vtkSMPThreadLocal<vtkQuadricClusteringBinMap>::iterator itr;
+    for (itr = this->Bins.begin(); itr != this->Bins.end(); ++itr)
+      {
+      this->Merge(*itr);
+      }
+  }
+
+private:
+  vtkQuadricClusteringCells *Cells;
+  vtkSMPThreadLocal<vtkQuadricClusteringBinMap> Bins;
+  vtkSimpleCriticalSection Lock;
+};
+
+//----------------------------------------------------------------------------
+// Finds the bins of the primitives of a batch of cells.  The primitives that
+// are ignored get no bins.
+class vtkQuadricClusteringBinFinder
+{
+public:
+  vtkQuadricClusteringBinFinder(vtkQuadricClusteringCells *cells)
+    : Cells(cells)
+  {
+  }
+
+  vtkQuadricClusteringBinMap::value_type *Find(vtkIdType ptId)
+  {
+    vtkQuadricClusteringBinMapIterator bin =
+      this->Cells->Bins->find(this->Cells->BinIds[ptId]);
+    return (bin != this->Cells->Bins->end() ? &(*bin) : NULL);
+  }
+
+  // Set the bins of a primitive, given by its point ids.
+  void SetBins(vtkIdType primId, const vtkIdType *ids)
+  {
+    vtkQuadricClusteringCells *cells = this->Cells;
+    int n = cells->PrimitiveSize;
+    vtkQuadricClusteringBinMap::value_type **entries =
+      &cells->BatchBins[n*(primId - cells->BatchOffset)];
+    vtkIdType binIds[3];
+    for (int i = 0; i < n; i++)
+      {
+      binIds[i] = cells->BinIds[ids[i]];
+      }
+    if (cells->IsIgnored(binIds))
+      {
+      entries[0] = NULL;
+      return;
+      }
+    for (int i = 0; i < n; i++)
+      {
+      entries[i] = this->Find(ids[i]);
+      if (entries[i] == NULL)
+        {
+        entries[0] = NULL;
+        return;
+        }
+      }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkQuadricClusteringCells *cells = this->Cells;
+    double pt0[3], pt1[3];
+    vtkIdType ids[3];
+    vtkIdType j;
+    int odd;  // Used to flip order of every other triangle in a strip.
+
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      const vtkIdType *cell = cells->Cells + cells->Locations[cellId];
+      vtkIdType numPts = cell[0];
+      const vtkIdType *ptIds = cell + 1;
+      vtkIdType primId = cells->Offsets[cellId];
+
+      switch (cells->CellType)
+        {
+        case VTK_VERTEX:
+          for (j = 0; j < numPts; ++j)
+            {
+            this->SetBins(primId++, ptIds + j);
+            }
+          break;
+
+        case VTK_LINE:
+          for (j = 1; j < numPts; ++j)
+            {
+            // Coincident points add neither a quadric nor an edge.
+            cells->Points->GetPoint(ptIds[j-1], pt0);
+            cells->Points->GetPoint(ptIds[j], pt1);
+            if (vtkMath::Distance2BetweenPoints(pt0, pt1) != 0.0)
+              {
+              this->SetBins(primId++, ptIds + j - 1);
+              }
+            else
+              {
+              cells->BatchBins[2*(primId++ - cells->BatchOffset)] = NULL;
+              }
+            }
+          break;
+
+        case VTK_POLYGON:
+          ids[0] = (numPts > 0 ? ptIds[0] : 0);
+          for (j = 0; j < numPts-2; j++)
+            {
+            ids[1] = ptIds[j+1];
+            ids[2] = ptIds[j+2];
+            this->SetBins(primId++, ids);
+            }
+          break;
+
+        case VTK_TRIANGLE_STRIP:
+          if (numPts < 2)
+            {
+            break;
+            }
+          ids[0] = ptIds[0];
+          ids[1] = ptIds[1];
+          odd = 0;
+          for (j = 2; j < numPts; ++j)
+            {
+            ids[2] = ptIds[j];
+            this->SetBins(primId++, ids);
+            ids[odd] = ids[2];
+            // Toggle odd.
+            odd = odd ? 0 : 1;
+            }
+          break;
+        }
+      }
+  }
+
+private:
+  vtkQuadricClusteringCells *Cells;
+};
+}
+
+//----------------------------------------------------------------------------
+vtkQuadricClusteringCells::vtkQuadricClusteringCells(
+  vtkQuadricClustering *self, vtkCellArray *cells, vtkPoints *points,
+  int cellType)
+  : Cells(cells->GetPointer()), Points(points), CellType(cellType),
+    UseInternalTriangles(self->UseInternalTriangles), BinIds(NULL),
+    Bins(self->Bins), BatchBegin(0), BatchEnd(0), BatchOffset(0)
+{
+  switch (cellType)
+    {
+    case VTK_VERTEX:
+      this->PrimitiveSize = 1;
+      break;
+    case VTK_LINE:
+      this->PrimitiveSize = 2;
+      break;
+    default:
+      this->PrimitiveSize = 3;
+      break;
+    }
+
+  // Find the location of each cell, so that the cells can be traversed by
+  // several threads, and the index of its first primitive.
+  vtkIdType numCells = cells->GetNumberOfCells();
+  this->Locations.resize(numCells);
+  this->Offsets.resize(numCells + 1);
+  vtkIdType cellId, loc, numPrims;
+  for (cellId = 0, loc = 0, numPrims = 0; cellId < numCells; cellId++)
+    {
+    vtkIdType numPts = this->Cells[loc];
+    this->Locations[cellId] = loc;
+    this->Offsets[cellId] = numPrims;
+    numPts -= this->PrimitiveSize - 1;
+    numPrims += (numPts > 0 ? numPts : 0);
+    loc += this->Cells[loc] + 1;
+    }
+  this->Offsets[numCells] = numPrims;
+
+  if (numCells > 0)
+    {
+    this->BinIds = self->PointBins->GetBinIds(self, points);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkQuadricClusteringCells::Accumulate()
+{
+  vtkQuadricClusteringAccumulator accumulator(this);
+  vtkSMPTools::For(0, this->GetNumberOfCells(), accumulator);
+}
+
+//----------------------------------------------------------------------------
+void vtkQuadricClusteringCells::GetPrimitives(vtkIdType cellId,
+                                              vtkIdType& first,
+                                              vtkIdType& last)
+{
+  if (cellId < this->BatchBegin || cellId >= this->BatchEnd)
+    {
+    this->BatchBegin = cellId;
+    this->BatchEnd = cellId + vtkQuadricClusteringBatchSize;
+    if (this->BatchEnd > this->GetNumberOfCells())
+      {
+      this->BatchEnd = this->GetNumberOfCells();
+      }
+    this->BatchOffset = this->Offsets[this->BatchBegin];
+    this->BatchBins.resize(this->PrimitiveSize*
+      (this->Offsets[this->BatchEnd] - this->BatchOffset));
+    vtkQuadricClusteringBinFinder finder(this);
+    vtkSMPTools::For(this->BatchBegin, this->BatchEnd, finder);
+    }
+  first = this->Offsets[cellId];
+  last = this->Offsets[cellId + 1];
+}
+
+//----------------------------------------------------------------------------
+// Computes the representative points of the bins that have an output point.
+class vtkQuadricClusteringRepresentativePoints
+{
+public:
+  vtkQuadricClusteringRepresentativePoints(vtkQuadricClustering *self,
+                                           vtkPoints *points)
+    : Self(self), Points(points)
+  {
+    vtkQuadricClusteringBinMapIterator bin;
+    for (bin = self->Bins->begin(); bin != self->Bins->end(); ++bin)
+      {
+      if (bin->second.VertexId != -1)
+        {
+        this->Bins.push_back(&(*bin));
+        }
+      }
+  }
+
+  vtkIdType GetNumberOfBins()
+  {
+    return static_cast<vtkIdType>(this->Bins.size());
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double newPt[3];
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      vtkQuadricClusteringBinMap::value_type *bin = this->Bins[i];
+      this->Self->ComputeRepresentativePoint(bin->second.Quadric, bin->first,
+                                             newPt);
+      this->Points->SetPoint(bin->second.VertexId, newPt);
+      }
+  }
+
+private:
+  vtkQuadricClustering *Self;
+  vtkPoints *Points;
+  std::vector<vtkQuadricClusteringBinMap::value_type*> Bins;
+};
 
 //----------------------------------------------------------------------------
 // Construct with default NumberOfDivisions to 50, DivisionSpacing to 1
@@ -54,6 +770,9 @@ vtkQuadricClustering::vtkQuadricClustering()
   this->NumberOfYDivisions = 50;
   this->NumberOfZDivisions = 50;
   this->QuadricArray = NULL;
+  this->NumberOfBins = 0;
+  this->Bins = NULL;
+  this->PointBins = NULL;
   this->NumberOfBinsUsed = 0;
   this->AbortExecute = 0;
 
@@ -75,7 +794,6 @@ vtkQuadricClustering::vtkQuadricClustering()
 
   this->PreventDuplicateCells = 1;
   this->CellSet = NULL;
-  this->NumberOfBins = 0;
 
   this->OutputTriangleArray = NULL;
   this->OutputLines = NULL;
@@ -102,10 +820,12 @@ vtkQuadricClustering::~vtkQuadricClustering()
     delete this->CellSet;
     this->CellSet = NULL;
     }
-  if (this->QuadricArray)
+  if (this->Bins)
     {
-    delete [] this->QuadricArray;
-    this->QuadricArray = NULL;
+    delete this->Bins;
+    this->Bins = NULL;
+    delete this->PointBins;
+    this->PointBins = NULL;
     }
   if (this->OutputTriangleArray)
     {
@@ -161,12 +881,12 @@ int vtkQuadricClustering::RequestData(
 
   // Lets limit the number of divisions based on
   // the number of points in the input.
-  int target = input->GetNumberOfPoints();
-  int numDiv = (this->NumberOfXDivisions * this->NumberOfYDivisions
-                  * this->NumberOfZDivisions) / 2;
+  double target = input->GetNumberOfPoints();
+  double numDiv = static_cast<double>(this->NumberOfXDivisions) *
+    this->NumberOfYDivisions * this->NumberOfZDivisions / 2.0;
   if (this->AutoAdjustNumberOfDivisions && numDiv > target)
     {
-    double factor = pow(((double)numDiv/(double)target),0.33333);
+    double factor = pow(numDiv/target,0.33333);
     this->NumberOfDivisions[0] =
       (int)(0.5+(double)(this->NumberOfXDivisions)/factor);
     this->NumberOfDivisions[0] = (this->NumberOfDivisions[0] > 0 ? this->NumberOfDivisions[0] : 1);
@@ -188,7 +908,6 @@ int vtkQuadricClustering::RequestData(
 
   this->StartAppend(input->GetBounds());
   this->UpdateProgress(.2);
-  this->SliceSize = this->NumberOfDivisions[0]*this->NumberOfDivisions[1];
 
   this->Append(input);
   if (this->UseFeatureEdges)
@@ -206,10 +925,12 @@ int vtkQuadricClustering::RequestData(
     }
 
   // Free up some memory.
-  if (this->QuadricArray)
+  if (this->Bins)
     {
-    delete [] this->QuadricArray;
-    this->QuadricArray = NULL;
+    delete this->Bins;
+    this->Bins = NULL;
+    delete this->PointBins;
+    this->PointBins = NULL;
     }
 
   if ( this->Debug )
@@ -230,9 +951,8 @@ void vtkQuadricClustering::StartAppend(double *bounds)
   // If there are duplicate triangles. remove them
   if ( this->PreventDuplicateCells )
     {
+    delete this->CellSet;
     this->CellSet = new vtkQuadricClusteringCellSet;
-    this->NumberOfBins =
-      this->NumberOfDivisions[0]*this->NumberOfDivisions[1]*this->NumberOfDivisions[2];
     }
 
   // Copy over the bounds.
@@ -296,22 +1016,16 @@ void vtkQuadricClustering::StartAppend(double *bounds)
   this->XBinStep = (this->XBinSize > 0.0) ? (1.0/this->XBinSize) : 0.0;
   this->YBinStep = (this->YBinSize > 0.0) ? (1.0/this->YBinSize) : 0.0;
   this->ZBinStep = (this->ZBinSize > 0.0) ? (1.0/this->ZBinSize) : 0.0;
+  this->SliceSize =
+    static_cast<vtkIdType>(this->NumberOfDivisions[0])*this->NumberOfDivisions[1];
 
+  // The bins are allocated as they are visited.
+  this->NumberOfBins = this->SliceSize * this->NumberOfDivisions[2];
   this->NumberOfBinsUsed = 0;
-  if (this->QuadricArray)
-    {
-    delete [] this->QuadricArray;
-    this->QuadricArray = NULL;
-    }
-  this->QuadricArray =
-    new vtkQuadricClustering::PointQuadric[this->NumberOfDivisions[0] *
-                                          this->NumberOfDivisions[1] *
-                                          this->NumberOfDivisions[2]];
-  if (this->QuadricArray == NULL)
-    {
-    vtkErrorMacro("Could not allocate quadric grid.");
-    return;
-    }
+  delete this->Bins;
+  this->Bins = new vtkQuadricClusteringBinMap;
+  delete this->PointBins;
+  this->PointBins = new vtkQuadricClusteringPointBins;
 
   vtkInformation *inInfo = this->GetExecutive()->GetInputInformation(0, 0);
   vtkInformation *outInfo = this->GetExecutive()->GetOutputInformation(0);
@@ -384,13 +1098,20 @@ void vtkQuadricClustering::AddPolygons(vtkCellArray *polys, vtkPoints *points,
                                        int geometryFlag,
                                        vtkPolyData *input, vtkPolyData *output)
 {
-  int j;
-  vtkIdType *ptIds = 0;
-  vtkIdType numPts = 0;
-  double pts0[3], pts1[3], pts2[3];
+  vtkIdType cellId, primId, first, last;
   vtkIdType binIds[3];
+  PointQuadric *bins[3];
+
+  vtkQuadricClusteringCells cells(this, polys, points, VTK_POLYGON);
+  cells.Accumulate();
+  vtkIdType numCells = cells.GetNumberOfCells();
+  if (!geometryFlag)
+    {
+    this->InCellCount += numCells;
+    return;
+    }
 
-  double total = polys->GetNumberOfCells();
+  double total = numCells;
   double curr = 0;
   double step = total / 10;
   if (step < 1000.0)
@@ -399,17 +1120,16 @@ void vtkQuadricClustering::AddPolygons(vtkCellArray *polys, vtkPoints *points,
     }
   double cstep = step;
 
-  for ( polys->InitTraversal(); polys->GetNextCell(numPts, ptIds); )
+  // Now add the triangles to the geometry, in the order of the input.
+  for (cellId = 0; cellId < numCells; cellId++)
     {
-    points->GetPoint(ptIds[0],pts0);
-    binIds[0] = this->HashPoint(pts0);
-    for (j=0; j < numPts-2; j++)//creates triangles; assumes poly is convex
+    cells.GetPrimitives(cellId, first, last);
+    for (primId = first; primId < last; primId++)
       {
-      points->GetPoint(ptIds[j+1],pts1);
-      binIds[1] = this->HashPoint(pts1);
-      points->GetPoint(ptIds[j+2],pts2);
-      binIds[2] = this->HashPoint(pts2);
-      this->AddTriangle(binIds, pts0, pts1, pts2, geometryFlag, input, output);
+      if (cells.GetBins(primId, binIds, bins))
+        {
+        this->InsertTriangle(binIds, bins, input, output);
+        }
       }
     ++this->InCellCount;
     if ( curr > cstep )
@@ -426,66 +1146,46 @@ void vtkQuadricClustering::AddStrips(vtkCellArray *strips, vtkPoints *points,
                                      int geometryFlag,
                                      vtkPolyData *input, vtkPolyData *output)
 {
-  int j;
-  vtkIdType *ptIds = 0;
-  vtkIdType numPts = 0;
-  double pts[3][3];
+  vtkIdType cellId, primId, first, last;
   vtkIdType binIds[3];
-  int odd;  // Used to flip order of every other triangle in a strip.
+  PointQuadric *bins[3];
+
+  vtkQuadricClusteringCells cells(this, strips, points, VTK_TRIANGLE_STRIP);
+  cells.Accumulate();
+  vtkIdType numCells = cells.GetNumberOfCells();
+  if (!geometryFlag)
+    {
+    this->InCellCount += numCells;
+    return;
+    }
 
-  for ( strips->InitTraversal(); strips->GetNextCell(numPts, ptIds); )
+  // Now add the triangles to the geometry, in the order of the input.
+  for (cellId = 0; cellId < numCells; cellId++)
     {
-    points->GetPoint(ptIds[0], pts[0]);
-    binIds[0] = this->HashPoint(pts[0]);
-    points->GetPoint(ptIds[1], pts[1]);
-    binIds[1] = this->HashPoint(pts[1]);
-    // This internal loop handles triangle strips.
-    odd = 0;
-    for (j = 2; j < numPts; ++j)
+    cells.GetPrimitives(cellId, first, last);
+    for (primId = first; primId < last; primId++)
       {
-      points->GetPoint(ptIds[j], pts[2]);
-      binIds[2] = this->HashPoint(pts[2]);
-      this->AddTriangle(binIds, pts[0], pts[1], pts[2], geometryFlag, input,
-                        output);
-      pts[odd][0] = pts[2][0];
-      pts[odd][1] = pts[2][1];
-      pts[odd][2] = pts[2][2];
-      binIds[odd] = binIds[2];
-      // Toggle odd.
-      odd = odd ? 0 : 1;
+      if (cells.GetBins(primId, binIds, bins))
+        {
+        this->InsertTriangle(binIds, bins, input, output);
+        }
       }
     ++this->InCellCount;
     }
 }
 
-//----------------------------------------------------------------------------
-inline void vtkQuadricClustering::InitializeQuadric(double quadric[9])
-{
-  quadric[0] = 0.0;
-  quadric[1] = 0.0;
-  quadric[2] = 0.0;
-  quadric[3] = 0.0;
-  quadric[4] = 0.0;
-  quadric[5] = 0.0;
-  quadric[6] = 0.0;
-  quadric[7] = 0.0;
-  quadric[8] = 0.0;
-}
-
 //----------------------------------------------------------------------------
 // The error function is the volume (squared) of the tetrahedron formed by the
-// triangle and the point.  We ignore constant factors across all coefficents,
-// and the constant coefficient.
-// If geomertyFlag is 1 then the triangle is added to the output.  Otherwise,
-// only the quadric is affected.
-void vtkQuadricClustering::AddTriangle(vtkIdType *binIds, double *pt0, double *pt1,
-                                       double *pt2, int geometryFlag,
-                                       vtkPolyData *input, vtkPolyData *output)
+// triangle and the point.  If geometryFlag is 1 then the triangle is added
+// to the output.  Otherwise, only the quadric is affected.
+void vtkQuadricClustering::AddTriangle(vtkIdType *binIds, double *pt0,
+                                       double *pt1, double *pt2,
+                                       int geometryFlag, vtkPolyData *input,
+                                       vtkPolyData *output)
 {
   int i;
-  vtkIdType triPtIds[3];
-  double quadric[9], quadric4x4[4][4];
-  vtkIdType minIdx, midIdx, maxIdx, idx;
+  double quadric[9];
+  PointQuadric *bins[3];
 
   // Special condition for fast execution.
   // Only add triangles that traverse three bins to quadrics.
@@ -498,120 +1198,64 @@ void vtkQuadricClustering::AddTriangle(vtkIdType *binIds, double *pt0, double *p
       }
     }
 
-  // Compute the quadric.
-  vtkTriangle::ComputeQuadric(pt0, pt1, pt2, quadric4x4);
-  quadric[0] = quadric4x4[0][0];
-  quadric[1] = quadric4x4[0][1];
-  quadric[2] = quadric4x4[0][2];
-  quadric[3] = quadric4x4[0][3];
-  quadric[4] = quadric4x4[1][1];
-  quadric[5] = quadric4x4[1][2];
-  quadric[6] = quadric4x4[1][3];
-  quadric[7] = quadric4x4[2][2];
-  quadric[8] = quadric4x4[2][3];
+  ComputeTriangleQuadric(pt0, pt1, pt2, quadric);
+  for (i = 0; i < 3; i++)
+    {
+    bins[i] = &(*this->Bins)[binIds[i]];
+    AddBinQuadric(*bins[i], 2, quadric);
+    }
+
+  if (geometryFlag)
+    {
+    this->InsertTriangle(binIds, bins, input, output);
+    }
+}
 
-  // Add the quadric to each of the three corner bins.
-  for (i = 0; i < 3; ++i)
+//----------------------------------------------------------------------------
+// Add the triangle to the output, unless two of its vertices are in the
+// same bin.  Its quadric has already been added to the bins.
+void vtkQuadricClustering::InsertTriangle(const vtkIdType binIds[3],
+                                          PointQuadric *bins[3],
+                                          vtkPolyData *input,
+                                          vtkPolyData *output)
+{
+  int i;
+  vtkIdType triPtIds[3];
+
+  // Now add the triangle to the geometry.
+  for (i = 0; i < 3; i++)
     {
-    // If the current quadric is not initialized, then clear it out.
-    if (this->QuadricArray[binIds[i]].Dimension > 2)
+    // Get the vertex from each bin.
+    if (bins[i]->VertexId == -1)
       {
-      this->QuadricArray[binIds[i]].Dimension = 2;
-      // Initialize the coeff
-      this->InitializeQuadric(this->QuadricArray[binIds[i]].Quadric);
-      }
-    if (this->QuadricArray[binIds[i]].Dimension == 2)
-      { // Points and segments supercede triangles.
-      this->AddQuadric(binIds[i], quadric);
+      bins[i]->VertexId = this->NumberOfBinsUsed;
+      this->NumberOfBinsUsed++;
       }
+    triPtIds[i] = bins[i]->VertexId;
     }
-
-  if (geometryFlag)
+  // This comparison could just as well be on triPtIds.
+  if (binIds[0] != binIds[1] && binIds[0] != binIds[2] &&
+      binIds[1] != binIds[2])
     {
-    // Now add the triangle to the geometry.
-    for (i = 0; i < 3; i++)
+    if ( this->PreventDuplicateCells )
       {
-      // Get the vertex from each bin.
-      if (this->QuadricArray[binIds[i]].VertexId == -1)
+      vtkQuadricClusteringTriangle triangle;
+      triangle.Ids[0] = binIds[0];
+      triangle.Ids[1] = binIds[1];
+      triangle.Ids[2] = binIds[2];
+      std::sort(triangle.Ids, triangle.Ids + 3);
+      if ( !this->CellSet->insert(triangle).second )
         {
-        this->QuadricArray[binIds[i]].VertexId = this->NumberOfBinsUsed;
-        this->NumberOfBinsUsed++;
+        return; // a duplicate
         }
-      triPtIds[i] = this->QuadricArray[binIds[i]].VertexId;
       }
-    // This comparison could just as well be on triPtIds.
-    if (binIds[0] != binIds[1] && binIds[0] != binIds[2] &&
-        binIds[1] != binIds[2])
+    this->OutputTriangleArray->InsertNextCell(3, triPtIds);
+    if (this->CopyCellData && input)
       {
-      if ( this->PreventDuplicateCells )
-        {
-        minIdx = ( binIds[0]<binIds[1] ? (binIds[0]<binIds[2] ? 0 : 2) :
-                   (binIds[1]<binIds[2] ? 1 : 2) );
-        midIdx = 0;
-        maxIdx = 0;
-        switch ( minIdx )
-          {
-          case 0:
-            if ( binIds[1] > binIds[2] )
-              {
-              maxIdx = 1;
-              midIdx = 2;
-              }
-            else
-              {
-              maxIdx = 2;
-              midIdx = 1;
-              }
-            break;
-          case 1:
-            if ( binIds[0] > binIds[2] )
-              {
-              maxIdx = 0;
-              midIdx = 2;
-              }
-            else
-              {
-              maxIdx = 2;
-              midIdx = 0;
-              }
-            break;
-          case 2:
-            if ( binIds[0] > binIds[1] )
-              {
-              maxIdx = 0;
-              midIdx = 1;
-              }
-            else
-              {
-              maxIdx = 1;
-              midIdx = 0;
-              }
-            break;
-          }
-        idx = binIds[minIdx] + this->NumberOfBins*binIds[midIdx] +
-              this->NumberOfBins*this->NumberOfBins*binIds[maxIdx];
-        if ( this->CellSet->find(idx) == this->CellSet->end() )
-          {
-          this->CellSet->insert(idx);
-          this->OutputTriangleArray->InsertNextCell(3, triPtIds);
-          if (this->CopyCellData && input)
-            {
-            output->GetCellData()->
-              CopyData(input->GetCellData(), this->InCellCount,this->OutCellCount++);
-            }//if cell data
-          }//if not a duplicate
-        }
-      else //don't check for duplicates
-        {
-        this->OutputTriangleArray->InsertNextCell(3, triPtIds);
-        if (this->CopyCellData && input)
-          {
-          output->GetCellData()->
-            CopyData(input->GetCellData(), this->InCellCount,this->OutCellCount++);
-          }//if cell data
-        }//don't check for duplicates
-      }//if not duplicate vertices
-    }//if this should be inserted
+      output->GetCellData()->
+        CopyData(input->GetCellData(), this->InCellCount,this->OutCellCount++);
+      }//if cell data
+    }//if not duplicate vertices
 }
 
 //----------------------------------------------------------------------------
@@ -619,143 +1263,94 @@ void vtkQuadricClustering::AddEdges(vtkCellArray *edges, vtkPoints *points,
                                     int geometryFlag,
                                     vtkPolyData *input, vtkPolyData *output)
 {
-  int j;
-  vtkIdType numCells, i;
-  vtkIdType *ptIds = 0;
-  vtkIdType numPts = 0;
-  double pt0[3], pt1[3];
+  vtkIdType cellId, primId, first, last;
   vtkIdType binIds[2];
+  PointQuadric *bins[2];
 
   // Add the edges to the error fuction.
-  numCells = edges->GetNumberOfCells();
-  edges->InitTraversal();
-  for (i = 0; i < numCells; ++i)
+  vtkQuadricClusteringCells cells(this, edges, points, VTK_LINE);
+  cells.Accumulate();
+  vtkIdType numCells = cells.GetNumberOfCells();
+  if (!geometryFlag)
+    {
+    this->InCellCount += numCells;
+    return;
+    }
+
+  // Now add the edges to the geometry, in the order of the input.
+  for (cellId = 0; cellId < numCells; cellId++)
     {
-    edges->GetNextCell(numPts, ptIds);
-    if(numPts != 0)
+    cells.GetPrimitives(cellId, first, last);
+    for (primId = first; primId < last; primId++)
       {
-      points->GetPoint(ptIds[0], pt0);
-      binIds[0] = this->HashPoint(pt0);
-      // This internal loop handles line strips.
-      for (j = 1; j < numPts; ++j)
+      if (cells.GetBins(primId, binIds, bins))
         {
-        points->GetPoint(ptIds[j], pt1);
-        binIds[1] = this->HashPoint(pt1);
-        this->AddEdge(binIds, pt0, pt1, geometryFlag, input, output);
-        pt0[0] = pt1[0];
-        pt0[1] = pt1[1];
-        pt0[2] = pt1[2];
-        binIds[0] = binIds[1];
+        this->InsertEdge(binIds, bins, input, output);
         }
       }
     ++this->InCellCount;
     }
 }
+
 //----------------------------------------------------------------------------
 // The error function is the square of the area of the triangle formed by the
-// edge and the point.  We ignore constants across all terms.
-// If geometryFlag is 1 then the edge is added to the output.  Otherwise,
-// only the quadric is affected.
+// edge and the point.  If geometryFlag is 1 then the edge is added to the
+// output.  Otherwise, only the quadric is affected.
 void vtkQuadricClustering::AddEdge(vtkIdType *binIds, double *pt0, double *pt1,
                                    int geometryFlag,
                                    vtkPolyData *input, vtkPolyData *output)
 {
-  int   i;
-  vtkIdType edgePtIds[2];
-  double length2, tmp;
-  double d[3];
-  double m[3];  // The mid point of the segement.(p1 or p2 could be used also).
-  double md;    // The dot product of m and d.
-  double q[9];
-
-  // Compute quadric for line segment.
-  // Line segment quadric is the area (squared) of the triangle (seg,pt)
-  // Compute the direction vector of the segment.
-  d[0] = pt1[0] - pt0[0];
-  d[1] = pt1[1] - pt0[1];
-  d[2] = pt1[2] - pt0[2];
-
-  // Compute the length^2 of the line segement.
-  length2 = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+  int i;
+  double quadric[9];
+  PointQuadric *bins[2];
 
-  if (length2 == 0.0)
-    { // Coincident points.  Avoid divide by zero.
+  if (!ComputeEdgeQuadric(pt0, pt1, quadric))
+    { // Coincident points add neither a quadric nor an edge.
     return;
     }
 
-  // Normalize the direction vector.
-  tmp = 1.0 / sqrt(length2);
-  d[0] = d[0] * tmp;
-  d[1] = d[1] * tmp;
-  d[2] = d[2] * tmp;
-
-  // Compute the mid point of the segment.
-  m[0] = 0.5 * (pt1[0] + pt0[0]);
-  m[1] = 0.5 * (pt1[1] + pt0[1]);
-  m[2] = 0.5 * (pt1[2] + pt0[2]);
+  for (i = 0; i < 2; i++)
+    {
+    bins[i] = &(*this->Bins)[binIds[i]];
+    AddBinQuadric(*bins[i], 1, quadric);
+    }
 
-  // Compute dot(m, d);
-  md = m[0]*d[0] + m[1]*d[1] + m[2]*d[2];
+  if (geometryFlag)
+    {
+    this->InsertEdge(binIds, bins, input, output);
+    }
+}
 
-  // We save nine coefficients of the error function cooresponding to:
-  // 0: Px^2
-  // 1: PxPy
-  // 2: PxPz
-  // 3: Px
-  // 4: Py^2
-  // 5: PyPz
-  // 6: Py
-  // 7: Pz^2
-  // 8: Pz
-  // We ignore the constant because it disappears with the derivative.
-  q[0] = length2*(1.0 - d[0]*d[0]);
-  q[1] = -length2*(d[0]*d[1]);
-  q[2] = -length2*(d[0]*d[2]);
-  q[3] = length2*(d[0]*md - m[0]);
-  q[4] = length2*(1.0 - d[1]*d[1]);
-  q[5] = -length2*(d[1]*d[2]);
-  q[6] = length2*(d[1]*md - m[1]);
-  q[7] = length2*(1.0 - d[2]*d[2]);
-  q[8] = length2*(d[2]*md - m[2]);
+//----------------------------------------------------------------------------
+// Add the edge to the output, unless its vertices are in the same bin.
+// Its quadric has already been added to the bins.
+void vtkQuadricClustering::InsertEdge(const vtkIdType binIds[2],
+                                      PointQuadric *bins[2],
+                                      vtkPolyData *input, vtkPolyData *output)
+{
+  int   i;
+  vtkIdType edgePtIds[2];
 
-  for (i = 0; i < 2; ++i)
+  // Now add the edge to the geometry.
+  for (i = 0; i < 2; i++)
     {
-    // If the current quadric is from triangles (or not initialized), then clear it out.
-    if (this->QuadricArray[binIds[i]].Dimension > 1)
+    // Get the vertex from each bin.
+    if (bins[i]->VertexId == -1)
       {
-      this->QuadricArray[binIds[i]].Dimension = 1;
-      // Initialize the coeff
-      this->InitializeQuadric(this->QuadricArray[binIds[i]].Quadric);
-      }
-    if (this->QuadricArray[binIds[i]].Dimension == 1)
-      { // Points supercede segements.
-      this->AddQuadric(binIds[i], q);
+      bins[i]->VertexId = this->NumberOfBinsUsed;
+      this->NumberOfBinsUsed++;
       }
+    edgePtIds[i] = bins[i]->VertexId;
     }
-
-  if (geometryFlag)
+  // This comparison could just as well be on edgePtIds.
+  if (binIds[0] != binIds[1])
     {
-    // Now add the edge to the geometry.
-    for (i = 0; i < 2; i++)
-      {
-      // Get the vertex from each bin.
-      if (this->QuadricArray[binIds[i]].VertexId == -1)
-        {
-        this->QuadricArray[binIds[i]].VertexId = this->NumberOfBinsUsed;
-        this->NumberOfBinsUsed++;
-        }
-      edgePtIds[i] = this->QuadricArray[binIds[i]].VertexId;
-      }
-    // This comparison could just as well be on edgePtIds.
-    if (binIds[0] != binIds[1])
+    this->OutputLines->InsertNextCell(2, edgePtIds);
+    if (this->CopyCellData && input)
       {
-      this->OutputLines->InsertNextCell(2, edgePtIds);
-      if (this->CopyCellData && input)
-        {
-        output->GetCellData()->
-          CopyData(input->GetCellData(),this->InCellCount,
-                   this->OutCellCount++);
-        }
+      output->GetCellData()->
+        CopyData(input->GetCellData(),this->InCellCount,
+                 this->OutCellCount++);
       }
     }
 }
@@ -765,14 +1360,19 @@ void vtkQuadricClustering::AddVertices(vtkCellArray *verts, vtkPoints *points,
                                        int geometryFlag, vtkPolyData *input,
                                        vtkPolyData *output)
 {
-  int j;
-  vtkIdType numCells, i;
-  vtkIdType *ptIds = 0;
-  vtkIdType numPts = 0;
-  double pt[3];
+  vtkIdType cellId, primId, first, last;
   vtkIdType binId;
+  PointQuadric *bin;
+
+  vtkQuadricClusteringCells cells(this, verts, points, VTK_VERTEX);
+  cells.Accumulate();
+  vtkIdType numCells = cells.GetNumberOfCells();
+  if (!geometryFlag)
+    {
+    this->InCellCount += numCells;
+    return;
+    }
 
-  numCells = verts->GetNumberOfCells();
   double cstep = (double)numCells / 10.0;
   if (cstep < 1000.0)
     {
@@ -781,16 +1381,17 @@ void vtkQuadricClustering::AddVertices(vtkCellArray *verts, vtkPoints *points,
   double next = cstep;
   double curr = 0;
 
-  verts->InitTraversal();
-  for (i = 0; i < numCells; ++i)
+  // Now add the vertices to the geometry, in the order of the input.
+  for (cellId = 0; cellId < numCells; cellId++)
     {
-    verts->GetNextCell(numPts, ptIds);
+    cells.GetPrimitives(cellId, first, last);
     // Can there be poly vertices?
-    for (j = 0; j < numPts; ++j)
+    for (primId = first; primId < last; primId++)
       {
-      points->GetPoint(ptIds[j], pt);
-      binId = this->HashPoint(pt);
-      this->AddVertex(binId, pt, geometryFlag, input, output);
+      if (cells.GetBins(primId, &binId, &bin))
+        {
+        this->InsertVertex(bin, input, output);
+        }
       }
     ++this->InCellCount;
 
@@ -805,75 +1406,59 @@ void vtkQuadricClustering::AddVertices(vtkCellArray *verts, vtkPoints *points,
 
 //----------------------------------------------------------------------------
 // The error function is the length (point to vert) squared.
-// We ignore constants across all terms.
 // If geomertyFlag is 1 then the vert is added to the output.  Otherwise,
 // only the quadric is affected.
 void vtkQuadricClustering::AddVertex(vtkIdType binId, double *pt,
                                      int geometryFlag,
                                      vtkPolyData *input, vtkPolyData *output)
 {
-  double q[9];
+  double quadric[9];
 
-  // Compute quadric for the vertex.
+  ComputeVertexQuadric(pt, quadric);
+  PointQuadric *bin = &(*this->Bins)[binId];
+  AddBinQuadric(*bin, 0, quadric);
 
-  // We save nine coefficients of the error function cooresponding to:
-  // 0: Px^2
-  // 1: PxPy
-  // 2: PxPz
-  // 3: Px
-  // 4: Py^2
-  // 5: PyPz
-  // 6: Py
-  // 7: Pz^2
-  // 8: Pz
-  // We ignore the constant because it disappears with the derivative.
-  q[0] = 1.0;
-  q[1] = 0.0;
-  q[2] = 0.0;
-  q[3] = -pt[0];
-  q[4] = 1.0;
-  q[5] = 0.0;
-  q[6] = -pt[1];
-  q[7] = 1.0;
-  q[8] = -pt[2];
-
-  // If the current quadric is from triangles, edges (or not initialized),
-  // then clear it out.
-  if (this->QuadricArray[binId].Dimension > 0)
+  if (geometryFlag)
     {
-    this->QuadricArray[binId].Dimension = 0;
-    // Initialize the coeff
-    this->InitializeQuadric(this->QuadricArray[binId].Quadric);
-    }
-  if (this->QuadricArray[binId].Dimension == 0)
-    { // Points supercede all other types of quadrics.
-    this->AddQuadric(binId, q);
+    this->InsertVertex(bin, input, output);
     }
+}
 
-  if (geometryFlag)
+//----------------------------------------------------------------------------
+// Add the vertex to the output, if its bin does not have a vertex yet.
+// Its quadric has already been added to the bin.
+void vtkQuadricClustering::InsertVertex(PointQuadric *bin, vtkPolyData *input,
+                                        vtkPolyData *output)
+{
+  // Now add the vert to the geometry.
+  // Get the vertex from the bin.
+  if (bin->VertexId == -1)
     {
-    // Now add the vert to the geometry.
-    // Get the vertex from the bin.
-    if (this->QuadricArray[binId].VertexId == -1)
-      {
-      this->QuadricArray[binId].VertexId = this->NumberOfBinsUsed;
-      this->NumberOfBinsUsed++;
+    bin->VertexId = this->NumberOfBinsUsed;
+    this->NumberOfBinsUsed++;
 
-      if (this->CopyCellData && input)
-        {
-        output->GetCellData()->
-          CopyData(input->GetCellData(), this->InCellCount,
-                   this->OutCellCount++);
-        }
+    if (this->CopyCellData && input)
+      {
+      output->GetCellData()->
+        CopyData(input->GetCellData(), this->InCellCount,
+                 this->OutCellCount++);
       }
     }
 }
 
 //----------------------------------------------------------------------------
-void vtkQuadricClustering::AddQuadric(vtkIdType binId, double quadric[9])
+void vtkQuadricClustering::InitializeQuadric(double quadric[9])
 {
-  double *q = this->QuadricArray[binId].Quadric;
+  for (int i = 0; i < 9; i++)
+    {
+    quadric[i] = 0.0;
+    }
+}
 
+//----------------------------------------------------------------------------
+void vtkQuadricClustering::AddQuadric(vtkIdType binId, double quadric[9])
+{
+  double *q = (*this->Bins)[binId].Quadric;
   for (int i=0; i<9; i++)
     {
     q[i] += (quadric[i] * 100000000.0);
@@ -919,7 +1504,8 @@ vtkIdType vtkQuadricClustering::HashPoint(double point[3])
     }
 
   // vary x fastest, then y, then z
-  binId = xBinCoord + yBinCoord*this->NumberOfDivisions[0] +
+  binId = xBinCoord +
+    static_cast<vtkIdType>(yBinCoord)*this->NumberOfDivisions[0] +
     zBinCoord*this->SliceSize;
 
   return binId;
@@ -939,18 +1525,7 @@ void vtkQuadricClustering::EndAppend()
   vtkPolyData *output = vtkPolyData::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType i, numBuckets;
-  int abortExecute=0;
   vtkPoints *outputPoints;
-  double newPt[3];
-  numBuckets = this->NumberOfDivisions[0] * this->NumberOfDivisions[1] *
-                this->NumberOfDivisions[2];
-  double step = (double)numBuckets / 10.0;
-  if (step < 1000.0)
-    {
-    step = 1000.0;
-    }
-  double cstep = 0;
 
   // Check for mis use of the Append methods.
   if (this->OutputTriangleArray == NULL || this->OutputLines == NULL)
@@ -966,25 +1541,14 @@ void vtkQuadricClustering::EndAppend()
     this->CellSet = NULL;
     }
 
-  // Compute the representative points for each bin
+  // Compute the representative points for each bin, in parallel.
   outputPoints = vtkPoints::New();
-  for (i = 0; !abortExecute && i < numBuckets; i++ )
-    {
-    if (cstep > step)
-      {
-      cstep = 0;
-      vtkDebugMacro(<<"Finding point in bin #" << i);
-      this->UpdateProgress (0.8+0.2*i/numBuckets);
-      abortExecute = this->GetAbortExecute();
-      }
-    ++cstep;
-
-    if (this->QuadricArray[i].VertexId != -1)
-      {
-      this->ComputeRepresentativePoint(this->QuadricArray[i].Quadric, i, newPt);
-      outputPoints->InsertPoint(this->QuadricArray[i].VertexId, newPt);
-      }
-    }
+  outputPoints->SetNumberOfPoints(this->NumberOfBinsUsed);
+  vtkQuadricClusteringRepresentativePoints representativePoints(this,
+                                                                outputPoints);
+  vtkSMPTools::For(0, representativePoints.GetNumberOfBins(),
+                   representativePoints);
+  this->UpdateProgress(0.9);
 
   // Set up the output data object.
   output->SetPoints(outputPoints);
@@ -1010,11 +1574,13 @@ void vtkQuadricClustering::EndAppend()
   // (in case the user calls this method directly).
   output->DataHasBeenGenerated();
 
-  // Free the quadric array.
-  if (this->QuadricArray)
+  // Free the bins.
+  if (this->Bins)
     {
-    delete [] this->QuadricArray;
-    this->QuadricArray = NULL;
+    delete this->Bins;
+    this->Bins = NULL;
+    delete this->PointBins;
+    this->PointBins = NULL;
     }
 }
 
@@ -1264,9 +1830,9 @@ void vtkQuadricClustering::EndAppendUsingPoints(vtkPolyData *input,
   vtkIdType   outPtId;
   vtkPoints   *inputPoints;
   vtkPoints   *outputPoints;
-  vtkIdType   numPoints, numBins;
+  vtkIdType   numPoints;
   vtkIdType   binId;
-  double       *minError, e, pt[3];
+  double       e, pt[3];
   double       *q;
 
   inputPoints = input->GetPoints();
@@ -1295,41 +1861,37 @@ void vtkQuadricClustering::EndAppendUsingPoints(vtkPolyData *input,
   output->GetPointData()->
     CopyAllocate(input->GetPointData(), this->NumberOfBinsUsed);
 
-  // Allocate and initialize an array to hold errors for each bin.
-  numBins = this->NumberOfDivisions[0] * this->NumberOfDivisions[1]
-                  * this->NumberOfDivisions[2];
-  minError = new double[numBins];
-  for (i = 0; i < numBins; ++i)
-    {
-    minError[i] = VTK_DOUBLE_MAX;
-    }
+  // Allocate and initialize an array to hold errors for each output point.
+  std::vector<double> minError(this->NumberOfBinsUsed, VTK_DOUBLE_MAX);
 
-  // Loop through the input points.
+  // Loop through the input points, whose bins are usually known already.
   numPoints = inputPoints->GetNumberOfPoints();
+  const vtkIdType *binIds = this->PointBins->GetBinIds(this, inputPoints);
   for (i = 0; i < numPoints; ++i)
     {
     inputPoints->GetPoint(i, pt);
-    binId = this->HashPoint(pt);
-    outPtId = this->QuadricArray[binId].VertexId;
+    binId = binIds[i];
+    vtkQuadricClusteringBinMapIterator bin = this->Bins->find(binId);
     // Sanity check.
-    if (outPtId == -1)
+    if (bin == this->Bins->end() || bin->second.VertexId == -1)
       {
       // This condition happens when there are points in the input that are
       // not used in any triangles, and therefore are never added to the
       // 3D hash structure.
       continue;
       }
+    outPtId = bin->second.VertexId;
 
     // Compute the error for this point.  Note: the constant term is ignored.
     // It will be the same for every point in this bin, and it
     // is not stored in the quadric array anyway.
-    q = this->QuadricArray[binId].Quadric;
+    q = bin->second.Quadric;
     e = q[0]*pt[0]*pt[0] + 2.0*q[1]*pt[0]*pt[1] + 2.0*q[2]*pt[0]*pt[2] + 2.0*q[3]*pt[0]
           + q[4]*pt[1]*pt[1] + 2.0*q[5]*pt[1]*pt[2] + 2.0*q[6]*pt[1]
           + q[7]*pt[2]*pt[2] + 2.0*q[8]*pt[2];
-    if (e < minError[binId])
+    if (e < minError[outPtId])
       {
-      minError[binId] = e;
+      minError[outPtId] = e;
       outputPoints->InsertPoint(outPtId, pt);
 
       // Since this is the same point as the input point, copy point data here too.
@@ -1352,13 +1914,13 @@ void vtkQuadricClustering::EndAppendUsingPoints(vtkPolyData *input,
 
   this->EndAppendVertexGeometry(input, output);
 
-  if (this->QuadricArray)
+  if (this->Bins)
     {
-    delete [] this->QuadricArray;
-    this->QuadricArray = NULL;
+    delete this->Bins;
+    this->Bins = NULL;
+    delete this->PointBins;
+    this->PointBins = NULL;
     }
-
-  delete [] minError;
 }
 
 //----------------------------------------------------------------------------
@@ -1371,7 +1933,6 @@ void vtkQuadricClustering::EndAppendVertexGeometry(vtkPolyData *input,
   vtkIdType *tmp = NULL;
   int        tmpLength = 0;
   int        tmpIdx;
-  double pt[3];
   int j;
   vtkIdType *ptIds = 0;
   vtkIdType numPts = 0;
@@ -1379,7 +1940,13 @@ void vtkQuadricClustering::EndAppendVertexGeometry(vtkPolyData *input,
   vtkIdType binId, cellId, outCellId;
 
   inVerts = input->GetVerts();
+  if (inVerts->GetNumberOfCells() == 0)
+    {
+    return;
+    }
   outVerts = vtkCellArray::New();
+  const vtkIdType *binIds =
+    this->PointBins->GetBinIds(this, input->GetPoints());
 
   for (cellId=0, inVerts->InitTraversal(); inVerts->GetNextCell(numPts, ptIds); cellId++)
     {
@@ -1395,13 +1962,13 @@ void vtkQuadricClustering::EndAppendVertexGeometry(vtkPolyData *input,
     tmpIdx = 0;
     for (j = 0; j < numPts; ++j)
       {
-      input->GetPoint(ptIds[j], pt);
-      binId = this->HashPoint(pt);
-      outPtId = this->QuadricArray[binId].VertexId;
+      binId = binIds[ptIds[j]];
+      vtkQuadricClusteringBinMapIterator bin = this->Bins->find(binId);
+      outPtId = (bin != this->Bins->end() ? bin->second.VertexId : -1);
       if (outPtId >= 0)
         {
-        // Do not use this point.  Destroy infomration in Quadric array.
-        this->QuadricArray[binId].VertexId = -1;
+        // Do not use this point.  Destroy infomration in the bin.
+        bin->second.VertexId = -1;
         tmp[tmpIdx] = outPtId;
         ++tmpIdx;
         }
@@ -1439,7 +2006,7 @@ void vtkQuadricClustering::AppendFeatureQuadrics(vtkPolyData *pd,
   vtkCellArray *edges;
   vtkIdType i;
   vtkIdType binId;
-  double featurePt[3];
+  double featurePt[3], quadric[9];
 
   // Find the boundary edges.
   input->ShallowCopy(pd);
@@ -1458,7 +2025,8 @@ void vtkQuadricClustering::AppendFeatureQuadrics(vtkPolyData *pd,
         {
         this->FeaturePoints->GetPoint(i, featurePt);
         binId = this->HashPoint(featurePt);
-        this->AddVertex(binId, featurePt, 0, input, output);
+        ComputeVertexQuadric(featurePt, quadric);
+        AddBinQuadric((*this->Bins)[binId], 0, quadric);
         }
       }
     }
@@ -56,6 +56,14 @@
 // this approach does not fit into the visualization architecture and requires
 // manual control, it has the advantage that extremely large data can be
 // processed in pieces and appended to the filter piece-by-piece.
+//
+// The quadrics are accumulated in parallel (using vtkSMPTools) into
+// per-thread sparse maps of the visited bins, which are merged whenever
+// they grow large. Only the bins that are visited are stored, so that very
+// fine subdivisions (e.g., 2048x2048x2048 bins) can be used. The bins of
+// the output cells are also found in parallel, and only the numbering of
+// the output points and the removal of the duplicate cells are done
+// serially, so that the output is the same as with the serial algorithm.
 
 
 // .SECTION Caveats
@@ -86,7 +94,9 @@
 class vtkCellArray;
 class vtkFeatureEdges;
 class vtkPoints;
+class vtkQuadricClusteringBinMap;
 class vtkQuadricClusteringCellSet;
+class vtkQuadricClusteringPointBins;
 
 
 class VTKFILTERSCORE_EXPORT vtkQuadricClustering : public vtkPolyDataAlgorithm
@@ -232,7 +242,9 @@ protected:
 
   // Description:
   // Add triangles to the quadric array.  If geometry flag is on then
-  // triangles are added to the output.
+  // triangles are added to the output.  The quadrics of the cells are
+  // accumulated in parallel, and the output cells are then generated in
+  // the order of the input cells.
   void AddPolygons(vtkCellArray *polys, vtkPoints *points, int geometryFlag,
                    vtkPolyData *input, vtkPolyData *output);
   void AddStrips(vtkCellArray *strips, vtkPoints *points, int geometryFlag,
@@ -334,7 +346,11 @@ protected:
   };
   //ETX
 
+  // The bins are no longer stored in a dense array, so QuadricArray is
+  // always NULL: only the visited bins are stored, in Bins.
   PointQuadric* QuadricArray;
+  vtkQuadricClusteringBinMap *Bins; //PIMPLd sparse map of the bins
+  vtkQuadricClusteringPointBins *PointBins; //PIMPLd bins of the input points
   vtkIdType NumberOfBinsUsed;
 
   // Have to make these instance variables if we are going to allow
@@ -351,6 +367,20 @@ protected:
   int OutCellCount;
 
 private:
+  friend class vtkQuadricClusteringBinMap;
+  friend class vtkQuadricClusteringCells;
+  friend class vtkQuadricClusteringPointBins;
+  friend class vtkQuadricClusteringRepresentativePoints;
+
+  // Add a triangle, an edge or a vertex whose quadric has already been
+  // added to its bins to the output, if it is not degenerate.
+  void InsertTriangle(const vtkIdType binIds[3], PointQuadric *bins[3],
+                      vtkPolyData *input, vtkPolyData *output);
+  void InsertEdge(const vtkIdType binIds[2], PointQuadric *bins[2],
+                  vtkPolyData *input, vtkPolyData *output);
+  void InsertVertex(PointQuadric *bin, vtkPolyData *input,
+                    vtkPolyData *output);
+
   vtkQuadricClustering(const vtkQuadricClustering&);  // Not implemented.
   void operator=(const vtkQuadricClustering&);  // Not implemented.
 };
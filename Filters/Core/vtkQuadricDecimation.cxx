@@ -53,10 +53,163 @@
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
 #include "vtkPriorityQueue.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangle.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkQuadricDecimation);
 
+//----------------------------------------------------------------------------
+// Decimates spatial blocks of the working mesh of a vtkQuadricDecimation,
+// each block with a filter of its thread. The points of the decimated
+// blocks are written back to the working mesh (the locked points, which are
+// shared with other blocks, are left untouched), and their remaining
+// triangles are returned.
+class vtkQuadricDecimationBlocks
+{
+public:
+  vtkQuadricDecimationBlocks(
+    vtkQuadricDecimation *self,
+    const std::vector<std::vector<vtkIdType> >& blockTriangles,
+    const std::vector<unsigned char>& lockedPoints, double targetReduction,
+    std::vector<std::vector<vtkIdType> >& triangles)
+    : Self(self), BlockTriangles(blockTriangles), LockedPoints(lockedPoints),
+      TargetReduction(targetReduction), Triangles(triangles)
+  {
+  }
+
+  void Initialize()
+  {
+    vtkQuadricDecimation *decimator = this->Decimators.Local();
+    decimator->AttributeErrorMetric = this->Self->AttributeErrorMetric;
+    decimator->NumberOfComponents = this->Self->NumberOfComponents;
+    if (decimator->NumberOfComponents > 0)
+      {
+      for (int i = 0; i < 6; i++)
+        {
+        decimator->AttributeComponents[i] = this->Self->AttributeComponents[i];
+        decimator->AttributeScale[i] = this->Self->AttributeScale[i];
+        }
+      }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkQuadricDecimation *decimator = this->Decimators.Local();
+    vtkPoints *meshPoints = this->Self->Mesh->GetPoints();
+    vtkPointData *meshPD = this->Self->Mesh->GetPointData();
+    vtkIdType i, cellId, npts, *pts, tri[3];
+    double x[3];
+    int j;
+
+    for (vtkIdType blockId = begin; blockId < end; blockId++)
+      {
+      const std::vector<vtkIdType>& blockTris = this->BlockTriangles[blockId];
+      if (blockTris.empty())
+        {
+        continue;
+        }
+
+      // The points of the block, whose ids in the block are their indices
+      // in this sorted list.
+      std::vector<vtkIdType> ptIds(blockTris);
+      std::sort(ptIds.begin(), ptIds.end());
+      ptIds.erase(std::unique(ptIds.begin(), ptIds.end()), ptIds.end());
+      vtkIdType numPts = static_cast<vtkIdType>(ptIds.size());
+
+      vtkPolyData *block = vtkPolyData::New();
+      vtkPoints *points = vtkPoints::New(meshPoints->GetDataType());
+      points->SetNumberOfPoints(numPts);
+      std::vector<unsigned char> locked(numPts);
+      for (i = 0; i < numPts; i++)
+        {
+        meshPoints->GetPoint(ptIds[i], x);
+        points->SetPoint(i, x);
+        locked[i] = this->LockedPoints[ptIds[i]];
+        }
+      block->SetPoints(points);
+      points->Delete();
+      vtkPointData *blockPD = block->GetPointData();
+      if (decimator->NumberOfComponents > 0)
+        {
+        blockPD->CopyAllocate(meshPD, numPts);
+        for (i = 0; i < numPts; i++)
+          {
+          blockPD->CopyData(meshPD, ptIds[i], i);
+          }
+        }
+
+      vtkCellArray *polys = vtkCellArray::New();
+      polys->Allocate(4 * blockTris.size() / 3);
+      for (size_t t = 0; t < blockTris.size(); t += 3)
+        {
+        for (j = 0; j < 3; j++)
+          {
+          tri[j] = std::lower_bound(ptIds.begin(), ptIds.end(),
+                                    blockTris[t+j]) - ptIds.begin();
+          }
+        polys->InsertNextCell(3, tri);
+        }
+      block->SetPolys(polys);
+      polys->Delete();
+      block->BuildCells();
+      block->BuildLinks();
+
+      decimator->Mesh = block;
+      decimator->DecimateMesh(this->TargetReduction, &locked[0]);
+      decimator->Mesh = NULL;
+
+      // Keep the remaining triangles, and write the points back.
+      std::vector<vtkIdType>& triangles = this->Triangles[blockId];
+      for (cellId = 0; cellId < block->GetNumberOfCells(); cellId++)
+        {
+        if (block->GetCellType(cellId) != VTK_EMPTY_CELL)
+          {
+          block->GetCellPoints(cellId, npts, pts);
+          for (j = 0; j < 3; j++)
+            {
+            triangles.push_back(ptIds[pts[j]]);
+            }
+          }
+        }
+      for (i = 0; i < numPts; i++)
+        {
+        if (!locked[i])
+          {
+          block->GetPoints()->GetPoint(i, x);
+          meshPoints->SetPoint(ptIds[i], x);
+          for (j = 0; j < vtkDataSetAttributes::NUM_ATTRIBUTES; j++)
+            {
+            vtkDataArray *attribute = blockPD->GetAttribute(j);
+            if (attribute)
+              {
+              meshPD->GetAttribute(j)->SetTuple(ptIds[i], i, attribute);
+              }
+            }
+          }
+        }
+
+      block->DeleteLinks();
+      block->Delete();
+      }
+  }
+
+  void Reduce()
+  {
+  }
+
+private:
+  vtkQuadricDecimation *Self;
+  const std::vector<std::vector<vtkIdType> >& BlockTriangles;
+  const std::vector<unsigned char>& LockedPoints;
+  double TargetReduction;
+  std::vector<std::vector<vtkIdType> >& Triangles;
+  vtkSMPThreadLocalObject<vtkQuadricDecimation> Decimators;
+};
+
 
 //----------------------------------------------------------------------------
 vtkQuadricDecimation::vtkQuadricDecimation()
@@ -86,6 +239,12 @@ vtkQuadricDecimation::vtkQuadricDecimation()
   this->TensorsWeight = 0.1;
 
   this->ActualReduction = 0.0;
+
+  this->BlockDivisions[0] = 1;
+  this->BlockDivisions[1] = 1;
+  this->BlockDivisions[2] = 1;
+  this->Mesh = NULL;
+  this->LockedPoints = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -185,20 +344,13 @@ int vtkQuadricDecimation::RequestData(
   vtkPolyData *output = vtkPolyData::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType numPts = input->GetNumberOfPoints();
   vtkIdType numTris = input->GetNumberOfPolys();
-  vtkIdType edgeId, i;
-  int j;
-  double cost;
-  double *x;
+  vtkIdType i;
   vtkCellArray *polys;
   vtkDataArray *attrib;
   vtkPoints *points;
   vtkPointData *pointData;
-  vtkIdType endPtIds[2];
   vtkIdList *outputCellList;
-  vtkIdType npts, *pts;
-  vtkIdType numDeletedTris=0;
 
   // check some assuptiona about the data
   if (input->GetPolys() == NULL || input->GetPoints() == NULL ||
@@ -233,8 +385,97 @@ int vtkQuadricDecimation::RequestData(
     }
   pointData->Delete();
   this->Mesh->GetFieldData()->PassData(input->GetFieldData());
-  this->Mesh->BuildCells();
-  this->Mesh->BuildLinks();
+
+  this->NumberOfComponents = 0;
+  if (this->AttributeErrorMetric)
+    {
+    this->ComputeNumberOfComponents();
+    }
+
+  // The blocks are decimated to twice the requested number of triangles,
+  // and the final pass decimates the seams between the blocks.
+  double targetReduction = this->TargetReduction;
+  double blockReduction = 2.0 * this->TargetReduction - 1.0;
+  if (this->BlockDivisions[0]*this->BlockDivisions[1]*this->BlockDivisions[2] > 1
+      && numTris > 0 && blockReduction > 0.0)
+    {
+    // The links of the whole mesh are only built for the final pass, once
+    // the blocks have been decimated.
+    this->DecimateBlocks(blockReduction);
+    vtkIdType numBlockTris = this->Mesh->GetNumberOfPolys();
+    targetReduction = (numBlockTris > 0 ? 1.0 -
+      (1.0 - this->TargetReduction) * numTris / numBlockTris : 0.0);
+    targetReduction = (targetReduction > 0.0 ? targetReduction : 0.0);
+    }
+  else
+    {
+    this->Mesh->BuildCells();
+    this->Mesh->BuildLinks();
+    }
+
+  this->DecimateMesh(targetReduction, NULL);
+
+  // copy the simplified mesh from the working mesh to the output mesh
+  for (i = 0; i < this->Mesh->GetNumberOfCells(); i++)
+    {
+    if (this->Mesh->GetCell(i)->GetCellType() != VTK_EMPTY_CELL)
+      {
+      outputCellList->InsertNextId(i);
+      }
+    }
+
+  output->Reset();
+  output->Allocate(this->Mesh, outputCellList->GetNumberOfIds());
+  output->GetPointData()->CopyAllocate(this->Mesh->GetPointData(),1);
+  output->CopyCells(this->Mesh, outputCellList);
+
+  this->Mesh->DeleteLinks();
+  this->Mesh->Delete();
+  this->Mesh = NULL;
+  outputCellList->Delete();
+
+  if (targetReduction != this->TargetReduction)
+    {
+    // The reduction of the final pass is not the one of the input triangles.
+    this->ActualReduction =
+      1.0 - static_cast<double>(output->GetNumberOfPolys()) / numTris;
+    }
+
+  // renormalize, clamp attributes
+  if (this->AttributeErrorMetric)
+    {
+    if (NULL != (attrib = output->GetPointData()->GetNormals()))
+      {
+      for (i = 0; i < attrib->GetNumberOfTuples(); i++)
+        {
+        vtkMath::Normalize(attrib->GetTuple3(i));
+        }
+      }
+    // might want to add clamping texture coordinates??
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// Decimates the working mesh until the target reduction of its triangles is
+// reached. The edges with a locked point (if lockedPoints is given) are not
+// collapsed.
+void vtkQuadricDecimation::DecimateMesh(double targetReduction,
+                                        const unsigned char *lockedPoints)
+{
+  vtkIdType numPts = this->Mesh->GetNumberOfPoints();
+  vtkIdType numTris = this->Mesh->GetNumberOfPolys();
+  vtkIdType edgeId, i;
+  int j;
+  double cost;
+  double *x;
+  vtkIdType endPtIds[2];
+  vtkIdType npts, *pts;
+  vtkIdType numDeletedTris=0;
+
+  this->LockedPoints = lockedPoints;
+
 
   this->ErrorQuadrics =
     new vtkQuadricDecimation::ErrorQuadric[numPts];
@@ -263,11 +504,6 @@ int vtkQuadricDecimation::RequestData(
 
   this->UpdateProgress(0.1);
 
-  this->NumberOfComponents = 0;
-  if (this->AttributeErrorMetric)
-    {
-    this->ComputeNumberOfComponents();
-    }
   x = new double [3+this->NumberOfComponents];
   this->CollapseCellIds = vtkIdList::New();
   this->TempX = new double [3+this->NumberOfComponents];
@@ -311,7 +547,7 @@ int vtkQuadricDecimation::RequestData(
 
   int abort = 0;
   while ( !abort && edgeId >= 0 && cost < VTK_DOUBLE_MAX &&
-         this->ActualReduction < this->TargetReduction )
+         this->ActualReduction < targetReduction )
     {
     if ( ! (this->NumberOfEdgeCollapses % 10000) )
       {
@@ -371,38 +607,96 @@ int vtkQuadricDecimation::RequestData(
   delete [] this->TempA;
   delete [] this->TempData;
 
-  // copy the simplified mesh from the working mesh to the output mesh
-  for (i = 0; i < this->Mesh->GetNumberOfCells(); i++)
+
+  this->LockedPoints = NULL;
+}
+
+//----------------------------------------------------------------------------
+// Distributes the triangles of the working mesh among the blocks by their
+// centers, and decimates the blocks concurrently, their shared points being
+// locked. The working mesh is then made of the remaining triangles.
+void vtkQuadricDecimation::DecimateBlocks(double targetReduction)
+{
+  vtkIdType numPts = this->Mesh->GetNumberOfPoints();
+  vtkIdType numTris = this->Mesh->GetNumberOfPolys();
+  vtkIdType numBlocks = static_cast<vtkIdType>(this->BlockDivisions[0]) *
+    this->BlockDivisions[1] * this->BlockDivisions[2];
+  vtkIdType blockId, npts, *pts;
+  double bounds[6], center[3], x[3];
+  int j, ijk[3];
+
+  // The triangles are read from the cell array, since the cells and the
+  // links of the whole mesh are not built.
+  this->Mesh->GetBounds(bounds);
+  std::vector<std::vector<vtkIdType> > blockTriangles(numBlocks);
+  std::vector<vtkIdType> pointBlocks(numPts, -1);
+  std::vector<unsigned char> lockedPoints(numPts, 0);
+  vtkCellArray *inPolys = this->Mesh->GetPolys();
+  for (inPolys->InitTraversal(); inPolys->GetNextCell(npts, pts); )
     {
-    if (this->Mesh->GetCell(i)->GetCellType() != VTK_EMPTY_CELL)
+    center[0] = center[1] = center[2] = 0.0;
+    for (j = 0; j < 3; j++)
       {
-      outputCellList->InsertNextId(i);
+      this->Mesh->GetPoint(pts[j], x);
+      center[0] += x[0] / 3.0;
+      center[1] += x[1] / 3.0;
+      center[2] += x[2] / 3.0;
+      }
+    for (j = 0; j < 3; j++)
+      {
+      double length = bounds[2*j+1] - bounds[2*j];
+      ijk[j] = (length > 0.0 ? static_cast<int>(
+        (center[j] - bounds[2*j]) / length * this->BlockDivisions[j]) : 0);
+      ijk[j] = (ijk[j] < 0 ? 0 : (ijk[j] >= this->BlockDivisions[j] ?
+                                  this->BlockDivisions[j] - 1 : ijk[j]));
+      }
+    blockId = ijk[0] + static_cast<vtkIdType>(this->BlockDivisions[0]) *
+      (ijk[1] + static_cast<vtkIdType>(this->BlockDivisions[1]) * ijk[2]);
+    for (j = 0; j < 3; j++)
+      {
+      blockTriangles[blockId].push_back(pts[j]);
+      if (pointBlocks[pts[j]] == -1)
+        {
+        pointBlocks[pts[j]] = blockId;
+        }
+      else if (pointBlocks[pts[j]] != blockId)
+        {
+        lockedPoints[pts[j]] = 1;
+        }
       }
     }
+  this->UpdateProgress(0.05);
 
-  output->Reset();
-  output->Allocate(this->Mesh, outputCellList->GetNumberOfIds());
-  output->GetPointData()->CopyAllocate(this->Mesh->GetPointData(),1);
-  output->CopyCells(this->Mesh, outputCellList);
+  std::vector<std::vector<vtkIdType> > triangles(numBlocks);
+  vtkQuadricDecimationBlocks decimateBlocks(this, blockTriangles, lockedPoints,
+                                            targetReduction, triangles);
+  vtkSMPTools::For(0, numBlocks, 1, decimateBlocks);
 
+  // the remaining triangles, in the order of the blocks
+  vtkCellArray *polys = vtkCellArray::New();
+  polys->Allocate(4 * numTris / 3 + 1);
+  for (blockId = 0; blockId < numBlocks; blockId++)
+    {
+    for (size_t t = 0; t < triangles[blockId].size(); t += 3)
+      {
+      polys->InsertNextCell(3, &triangles[blockId][t]);
+      }
+    }
   this->Mesh->DeleteLinks();
-  this->Mesh->Delete();
-  outputCellList->Delete();
-
-  // renormalize, clamp attributes
-  if (this->AttributeErrorMetric)
+  this->Mesh->DeleteCells();
+  this->Mesh->SetPolys(polys);
+  polys->Delete();
+  this->Mesh->BuildCells();
+  this->Mesh->BuildLinks();
+  this->Mesh->GetPoints()->Modified();
+  vtkPointData *pointData = this->Mesh->GetPointData();
+  for (j = 0; j < pointData->GetNumberOfArrays(); j++)
     {
-    if (NULL != (attrib = output->GetPointData()->GetNormals()))
+    if (pointData->GetArray(j))
       {
-      for (i = 0; i < attrib->GetNumberOfTuples(); i++)
-        {
-        vtkMath::Normalize(attrib->GetTuple3(i));
-        }
+      pointData->GetArray(j)->Modified();
       }
-    // might want to add clamping texture coordinates??
     }
-
-  return 1;
 }
 
 //----------------------------------------------------------------------------
@@ -803,6 +1097,14 @@ double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
   pointIds[0] = this->EndPoint1List->GetId(edgeId);
   pointIds[1] = this->EndPoint2List->GetId(edgeId);
 
+  // the points shared with other blocks are kept
+  if (this->LockedPoints && (this->LockedPoints[pointIds[0]] ||
+                             this->LockedPoints[pointIds[1]]))
+    {
+    this->GetPointAttributeArray(pointIds[0], x);
+    return VTK_DOUBLE_MAX;
+    }
+
   for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
     {
     this->TempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
@@ -901,6 +1203,14 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
   pointIds[0] = this->EndPoint1List->GetId(edgeId);
   pointIds[1] = this->EndPoint2List->GetId(edgeId);
 
+  // the points shared with other blocks are kept
+  if (this->LockedPoints && (this->LockedPoints[pointIds[0]] ||
+                             this->LockedPoints[pointIds[1]]))
+    {
+    this->GetPointAttributeArray(pointIds[0], x);
+    return VTK_DOUBLE_MAX;
+    }
+
   for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
     {
     this->TempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
@@ -1373,4 +1683,6 @@ void vtkQuadricDecimation::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Normals Weight: " << this->NormalsWeight << "\n";
   os << indent << "TCoords Weight: " << this->TCoordsWeight << "\n";
   os << indent << "Tensors Weight: " << this->TensorsWeight << "\n";
+  os << indent << "Block Divisions: (" << this->BlockDivisions[0] << ", "
+     << this->BlockDivisions[1] << ", " << this->BlockDivisions[2] << ")\n";
 }
@@ -46,6 +46,15 @@
 // Attributes" is also a good take on the subject especially as it pertains
 // to the error metric applied to attributes.
 //
+// Large meshes can be decimated by spatial blocks (see BlockDivisions). The
+// triangles are then distributed among the blocks by their centers, and the
+// blocks are decimated independently and concurrently (using vtkSMPTools),
+// with the vertices they share with other blocks locked. Each block only
+// needs the links and edges of its own triangles. The blocks are decimated
+// to twice the requested number of triangles, and a final pass over the
+// merged mesh, where the vertices of the seams between the blocks are no
+// longer locked, completes the decimation.
+//
 // .SECTION Thanks
 // Thanks to Bradley Lowekamp of the National Library of Medicine/NIH for
 // contributing this class.
@@ -125,12 +134,31 @@ public:
   // filter has executed.
   vtkGetMacro(ActualReduction, double);
 
+  // Description:
+  // Set/Get the number of spatial blocks along each axis in which the mesh
+  // is decimated independently and concurrently before the seams between
+  // the blocks are decimated. By default there is a single block, and the
+  // whole mesh is decimated in a single pass.
+  vtkSetVector3Macro(BlockDivisions, int);
+  vtkGetVector3Macro(BlockDivisions, int);
+
 protected:
   vtkQuadricDecimation();
   ~vtkQuadricDecimation();
 
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
 
+  // Description:
+  // Collapse the edges of the working mesh until the given reduction of its
+  // triangles is reached. The edges using a locked point (if lockedPoints is
+  // not NULL) are not collapsed.
+  void DecimateMesh(double targetReduction, const unsigned char *lockedPoints);
+
+  // Description:
+  // Decimate the blocks of the working mesh concurrently, and replace its
+  // triangles with the ones of the decimated blocks.
+  void DecimateBlocks(double targetReduction);
+
   // Description:
   // Do the dirty work of eliminating the edge; return the number of
   // triangles deleted.
@@ -201,6 +229,8 @@ protected:
   double TCoordsWeight;
   double TensorsWeight;
 
+  int BlockDivisions[3];
+
   int               NumberOfEdgeCollapses;
   vtkEdgeTable     *Edges;
   vtkIdList        *EndPoint1List;
@@ -209,6 +239,7 @@ protected:
   vtkDoubleArray   *TargetPoints;
   int               NumberOfComponents;
   vtkPolyData      *Mesh;
+  const unsigned char *LockedPoints;
 
   //BTX
   struct ErrorQuadric
@@ -230,6 +261,8 @@ protected:
   double *TempData;
 
 private:
+  friend class vtkQuadricDecimationBlocks;
+
   vtkQuadricDecimation(const vtkQuadricDecimation&);  // Not implemented.
   void operator=(const vtkQuadricDecimation&);  // Not implemented.
 };
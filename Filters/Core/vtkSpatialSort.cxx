@@ -0,0 +1,224 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSpatialSort.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkSpatialSort.h"
+
+#include "vtkIdList.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+vtkStandardNewMacro(vtkSpatialSort);
+
+namespace
+{
+typedef std::pair<vtkTypeUInt64, vtkIdType> vtkSpatialSortKey;
+
+// The keys hold the round of the point in their 5 high bits, and its index
+// along the Hilbert curve in the 58 low bits.
+const int VTK_SPATIAL_SORT_MAX_ROUND = 31;
+const int VTK_SPATIAL_SORT_ROUND_SHIFT = 58;
+
+// The index along the Hilbert curve of a point of integer coordinates of
+// the given number of bits (J. Skilling, "Programming the Hilbert curve",
+// AIP Conference Proceedings 707, 2004).
+vtkTypeUInt64 HilbertIndex(unsigned int x[3], int dimension, int bits)
+{
+  unsigned int m = 1U << (bits - 1), p, q, t;
+  int i;
+
+  // inverse undo
+  for (q = m; q > 1; q >>= 1)
+    {
+    p = q - 1;
+    for (i = 0; i < dimension; i++)
+      {
+      if (x[i] & q)
+        {
+        x[0] ^= p;
+        }
+      else
+        {
+        t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+        }
+      }
+    }
+
+  // Gray encode
+  for (i = 1; i < dimension; i++)
+    {
+    x[i] ^= x[i-1];
+    }
+  t = 0;
+  for (q = m; q > 1; q >>= 1)
+    {
+    if (x[dimension-1] & q)
+      {
+      t ^= q - 1;
+      }
+    }
+  for (i = 0; i < dimension; i++)
+    {
+    x[i] ^= t;
+    }
+
+  // interleave the bits of the transposed index
+  vtkTypeUInt64 index = 0;
+  for (int b = bits - 1; b >= 0; b--)
+    {
+    for (i = 0; i < dimension; i++)
+      {
+      index = (index << 1) | ((x[i] >> b) & 1);
+      }
+    }
+  return index;
+}
+
+// The round of a point: the last round holds half of the points, the one
+// before a quarter, and so on. The distribution depends on the point id
+// only, through an integer hash.
+int Round(vtkIdType id, int numRounds)
+{
+  vtkTypeUInt32 h = static_cast<vtkTypeUInt32>(id);
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  int zeros = 0;
+  while (zeros < numRounds - 1 && !(h & 1))
+    {
+    h >>= 1;
+    zeros++;
+    }
+  return numRounds - 1 - zeros;
+}
+
+class vtkSpatialSortKeys
+{
+public:
+  vtkSpatialSortKeys(vtkPoints *points, int dimension, int numRounds,
+                     std::vector<vtkSpatialSortKey>& keys)
+    : Points(points), Dimension(dimension), NumberOfRounds(numRounds),
+      Keys(keys)
+  {
+    this->Bits = (dimension == 2 ? 29 : 19);
+    double *bounds = points->GetBounds();
+    double resolution = static_cast<double>((1U << this->Bits) - 1);
+    for (int i = 0; i < 3; i++)
+      {
+      this->Origin[i] = bounds[2*i];
+      double length = bounds[2*i+1] - bounds[2*i];
+      this->Scale[i] = (length > 0.0 ? resolution / length : 0.0);
+      }
+    this->MaxCoordinate = (1U << this->Bits) - 1;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double x[3];
+    unsigned int coords[3];
+    for (vtkIdType ptId = begin; ptId < end; ptId++)
+      {
+      this->Points->GetPoint(ptId, x);
+      for (int i = 0; i < this->Dimension; i++)
+        {
+        // written so that a NaN coordinate goes to 0 rather than to the
+        // (undefined) conversion
+        double c = (x[i] - this->Origin[i]) * this->Scale[i];
+        coords[i] = (c > 0.0 ? (c < this->MaxCoordinate ?
+          static_cast<unsigned int>(c) : this->MaxCoordinate) : 0);
+        }
+      vtkTypeUInt64 key = HilbertIndex(coords, this->Dimension, this->Bits);
+      if (this->NumberOfRounds > 1)
+        {
+        key |= static_cast<vtkTypeUInt64>(Round(ptId, this->NumberOfRounds))
+          << VTK_SPATIAL_SORT_ROUND_SHIFT;
+        }
+      this->Keys[ptId] = vtkSpatialSortKey(key, ptId);
+      }
+  }
+
+private:
+  vtkPoints *Points;
+  int Dimension;
+  int NumberOfRounds;
+  std::vector<vtkSpatialSortKey>& Keys;
+  int Bits;
+  unsigned int MaxCoordinate;
+  double Origin[3];
+  double Scale[3];
+};
+}
+
+//----------------------------------------------------------------------------
+void vtkSpatialSort::HilbertSort(vtkPoints *points, int dimension,
+                                 vtkIdList *order)
+{
+  vtkSpatialSort::Sort(points, dimension, false, order);
+}
+
+//----------------------------------------------------------------------------
+void vtkSpatialSort::BRIOSort(vtkPoints *points, int dimension,
+                              vtkIdList *order)
+{
+  vtkSpatialSort::Sort(points, dimension, true, order);
+}
+
+//----------------------------------------------------------------------------
+void vtkSpatialSort::Sort(vtkPoints *points, int dimension, bool rounds,
+                          vtkIdList *order)
+{
+  vtkIdType numPts = points->GetNumberOfPoints();
+  order->SetNumberOfIds(numPts);
+  if (numPts == 0)
+    {
+    return;
+    }
+  dimension = (dimension == 2 ? 2 : 3);
+
+  // as many rounds as halvings of the points, with at least a few points
+  // in the first round
+  int numRounds = 1;
+  if (rounds)
+    {
+    for (vtkIdType n = numPts; n > 16 && numRounds < VTK_SPATIAL_SORT_MAX_ROUND;
+         n /= 2)
+      {
+      numRounds++;
+      }
+    }
+
+  std::vector<vtkSpatialSortKey> keys(numPts);
+  vtkSpatialSortKeys computeKeys(points, dimension, numRounds, keys);
+  vtkSMPTools::For(0, numPts, computeKeys);
+  std::sort(keys.begin(), keys.end());
+
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    order->SetId(i, keys[i].second);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSpatialSort::PrintSelf(ostream &os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+}
@@ -0,0 +1,75 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSpatialSort.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkSpatialSort - spatially coherent orderings of points
+// .SECTION Description
+// vtkSpatialSort provides static methods computing orders of a list of
+// points in which consecutive points are close to each other. They are
+// used by incremental algorithms which locate each point starting from the
+// previous one, such as vtkDelaunay2D and vtkDelaunay3D.
+//
+// HilbertSort() orders the points along a Hilbert curve covering their
+// bounding box. BRIOSort() computes a biased randomized insertion order
+// (Amenta, Choi and Rote): the points are distributed at random among
+// rounds of doubling size, and the points of each round are ordered along
+// the Hilbert curve. This keeps the locality of the Hilbert order while
+// avoiding the degenerate configurations of a purely spatial one. The
+// orders are reproducible: the random distribution only depends on the
+// point ids.
+//
+// The keys of the points are computed in parallel (using vtkSMPTools).
+
+// .SECTION See Also
+// vtkDelaunay2D vtkDelaunay3D vtkSortDataArray
+
+#ifndef __vtkSpatialSort_h
+#define __vtkSpatialSort_h
+
+#include "vtkFiltersCoreModule.h" // For export macro
+#include "vtkObject.h"
+
+class vtkIdList;
+class vtkPoints;
+
+class VTKFILTERSCORE_EXPORT vtkSpatialSort : public vtkObject
+{
+public:
+  vtkTypeMacro(vtkSpatialSort, vtkObject);
+  static vtkSpatialSort *New();
+  virtual void PrintSelf(ostream &os, vtkIndent indent);
+
+  // Description:
+  // Fill order with the ids of the points sorted along a Hilbert curve.
+  // The dimension is 2 (the z coordinate is then ignored) or 3.
+  static void HilbertSort(vtkPoints *points, int dimension, vtkIdList *order);
+
+  // Description:
+  // Fill order with the ids of the points in a biased randomized insertion
+  // order, whose rounds are sorted along a Hilbert curve. The dimension is
+  // 2 (the z coordinate is then ignored) or 3.
+  static void BRIOSort(vtkPoints *points, int dimension, vtkIdList *order);
+
+protected:
+  vtkSpatialSort() {}
+  ~vtkSpatialSort() {}
+
+  static void Sort(vtkPoints *points, int dimension, bool rounds,
+                   vtkIdList *order);
+
+private:
+  vtkSpatialSort(const vtkSpatialSort &);  // Not implemented.
+  void operator=(const vtkSpatialSort &);  // Not implemented.
+};
+
+#endif
@@ -14,21 +14,58 @@
 =========================================================================*/
 #include "vtkThreshold.h"
 
-#include "vtkCell.h"
 #include "vtkCellData.h"
+#include "vtkCellSubsetExtractor.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkMath.h"
 
 #include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkThreshold);
 
+namespace
+{
+// Return true if the scalars can be read concurrently.
+bool vtkThresholdIsThreadSafe(vtkDataArray *array)
+{
+  return array->GetDataType() != VTK_BIT && array->HasStandardMemoryLayout();
+}
+}
+
+// Flags the cells satisfying the criterion.
+class vtkThresholdKeepCells
+{
+public:
+  vtkThreshold *Filter;
+  vtkDataSet *Input;
+  vtkDataArray *Scalars;
+  int UsePointScalars;
+  signed char *KeepCells;
+
+  vtkSMPThreadLocalObject<vtkIdList> CellPoints;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *cellPts = this->CellPoints.Local();
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      this->Input->GetCellPoints(cellId, cellPts);
+      this->KeepCells[cellId] = static_cast<signed char>(
+        this->Filter->KeepCell(this->Scalars, this->UsePointScalars, cellId,
+                               cellPts));
+      }
+  }
+};
+
 // Construct with lower threshold=0, upper threshold=1, and threshold
 // function=upper AllScalars=1.
 vtkThreshold::vtkThreshold()
@@ -105,17 +142,9 @@ int vtkThreshold::RequestData(
   vtkUnstructuredGrid *output = vtkUnstructuredGrid::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType cellId, newCellId;
-  vtkIdList *cellPts, *pointMap;
-  vtkIdList *newCellPts;
-  vtkCell *cell;
   vtkPoints *newPoints;
-  int i, ptId, newId, numPts;
-  int numCellPts;
-  double x[3];
-  vtkPointData *pd=input->GetPointData(), *outPD=output->GetPointData();
-  vtkCellData *cd=input->GetCellData(), *outCD=output->GetCellData();
-  int keepCell, usePointScalars;
+  vtkIdType numPts, numCells;
+  int usePointScalars;
 
   vtkDebugMacro(<< "Executing threshold filter");
 
@@ -133,13 +162,11 @@ int vtkThreshold::RequestData(
     return 1;
     }
 
-  outPD->CopyGlobalIdsOn();
-  outPD->CopyAllocate(pd);
-  outCD->CopyGlobalIdsOn();
-  outCD->CopyAllocate(cd);
+  output->GetPointData()->CopyGlobalIdsOn();
+  output->GetCellData()->CopyGlobalIdsOn();
 
   numPts = input->GetNumberOfPoints();
-  output->Allocate(input->GetNumberOfCells());
+  numCells = input->GetNumberOfCells();
 
   newPoints = vtkPoints::New();
 
@@ -165,104 +192,86 @@ int vtkThreshold::RequestData(
     newPoints->SetDataType(VTK_DOUBLE);
     }
 
-  newPoints->Allocate(numPts);
+  // are we using pointScalars?
+  usePointScalars = (inScalars->GetNumberOfTuples() == numPts);
 
-  pointMap = vtkIdList::New(); //maps old point ids into new
-  pointMap->SetNumberOfIds(numPts);
-  for (i=0; i < numPts; i++)
+  // Check that the scalars of each cell satisfy the threshold criterion
+  std::vector<signed char> keepCells(numCells > 0 ? numCells : 1);
+  if (numCells > 0)
     {
-    pointMap->SetId(i,-1);
+    // Build the cells (of vtkPolyData) before they are used concurrently.
+    vtkIdList *cellPts = vtkIdList::New();
+    input->GetCellPoints(0, cellPts);
+    cellPts->Delete();
+
+    vtkThresholdKeepCells keeper;
+    keeper.Filter = this;
+    keeper.Input = input;
+    keeper.Scalars = inScalars;
+    keeper.UsePointScalars = usePointScalars;
+    keeper.KeepCells = &keepCells[0];
+    if (vtkThresholdIsThreadSafe(inScalars))
+      {
+      vtkSMPTools::For(0, numCells, keeper);
+      }
+    else
+      {
+      keeper(0, numCells);
+      }
     }
+  this->UpdateProgress(0.5);
 
-  newCellPts = vtkIdList::New();
+  // Copy the cells satisfying the criterion and the points they use.
+  vtkCellSubsetExtractor::Extract(input, &keepCells[0], newPoints, output);
 
-  // are we using pointScalars?
-  usePointScalars = (inScalars->GetNumberOfTuples() == numPts);
+  vtkDebugMacro(<< "Extracted " << output->GetNumberOfCells()
+                << " number of cells.");
 
-  // Check that the scalars of each cell satisfy the threshold criterion
-  for (cellId=0; cellId < input->GetNumberOfCells(); cellId++)
-    {
-    cell = input->GetCell(cellId);
-    cellPts = cell->GetPointIds();
-    numCellPts = cell->GetNumberOfPoints();
+  newPoints->Delete();
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkThreshold::KeepCell( vtkDataArray *scalars, int usePointScalars,
+                            vtkIdType cellId, vtkIdList* cellPts )
+{
+  int i, keepCell;
+  int numCellPts = cellPts->GetNumberOfIds();
 
-    if ( usePointScalars )
+  if ( usePointScalars )
+    {
+    if (this->AllScalars)
       {
-      if (this->AllScalars)
-        {
-        keepCell = 1;
-        for ( i=0; keepCell && (i < numCellPts); i++)
-          {
-          ptId = cellPts->GetId(i);
-          keepCell = this->EvaluateComponents( inScalars, ptId );
-          }
-        }
-      else
+      keepCell = 1;
+      for ( i=0; keepCell && (i < numCellPts); i++)
         {
-        if(!this->UseContinuousCellRange)
-          {
-          keepCell = 0;
-          for ( i=0; (!keepCell) && (i < numCellPts); i++)
-            {
-            ptId = cellPts->GetId(i);
-            keepCell = this->EvaluateComponents( inScalars, ptId );
-            }
-          }
-        else
-          {
-          keepCell = this->EvaluateCell(inScalars, cellPts, numCellPts);
-          }
+        keepCell = this->EvaluateComponents( scalars, cellPts->GetId(i) );
         }
       }
-    else //use cell scalars
-      {
-      keepCell = this->EvaluateComponents( inScalars, cellId );
-      }
-
-    if (  numCellPts > 0 && keepCell )
+    else
       {
-      // satisfied thresholding (also non-empty cell, i.e. not VTK_EMPTY_CELL)
-      for (i=0; i < numCellPts; i++)
+      if(!this->UseContinuousCellRange)
         {
-        ptId = cellPts->GetId(i);
-        if ( (newId = pointMap->GetId(ptId)) < 0 )
+        keepCell = 0;
+        for ( i=0; (!keepCell) && (i < numCellPts); i++)
           {
-          input->GetPoint(ptId, x);
-          newId = newPoints->InsertNextPoint(x);
-          pointMap->SetId(ptId,newId);
-          outPD->CopyData(pd,ptId,newId);
+          keepCell = this->EvaluateComponents( scalars, cellPts->GetId(i) );
           }
-        newCellPts->InsertId(i,newId);
         }
-      // special handling for polyhedron cells
-      if (vtkUnstructuredGrid::SafeDownCast(input) &&
-          input->GetCellType(cellId) == VTK_POLYHEDRON)
+      else
         {
-        newCellPts->Reset();
-        vtkUnstructuredGrid::SafeDownCast(input)->
-          GetFaceStream(cellId, newCellPts);
-        vtkUnstructuredGrid::ConvertFaceStreamPointIds(
-          newCellPts, pointMap->GetPointer(0));
+        keepCell = this->EvaluateCell(scalars, cellPts, numCellPts);
         }
-      newCellId = output->InsertNextCell(cell->GetCellType(),newCellPts);
-      outCD->CopyData(cd,cellId,newCellId);
-      newCellPts->Reset();
-      } // satisfied thresholding
-    } // for all cells
-
-  vtkDebugMacro(<< "Extracted " << output->GetNumberOfCells()
-                << " number of cells.");
-
-  // now clean up / update ourselves
-  pointMap->Delete();
-  newCellPts->Delete();
-
-  output->SetPoints(newPoints);
-  newPoints->Delete();
-
-  output->Squeeze();
+      }
+    }
+  else //use cell scalars
+    {
+    keepCell = this->EvaluateComponents( scalars, cellId );
+    }
 
-  return 1;
+  // also reject empty cells, i.e. VTK_EMPTY_CELL
+  return ( numCellPts > 0 && keepCell );
 }
 
 int vtkThreshold::EvaluateCell( vtkDataArray *scalars,vtkIdList* cellPts, int numCellPts )
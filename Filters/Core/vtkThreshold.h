@@ -27,6 +27,11 @@
 //
 // By default only the first scalar value is used in the decision. Use the ComponentMode
 // and SelectedComponent ivars to control this behavior.
+//
+// The criterion is evaluated on the cells in parallel, and the cells that
+// satisfy it are copied with their points and data (see
+// vtkCellSubsetExtractor). The output cells, and the output points, keep
+// the order of their ids in the input.
 
 // .SECTION See Also
 // vtkThresholdPoints vtkThresholdTextureCoords
@@ -48,6 +53,7 @@
 
 class vtkDataArray;
 class vtkIdList;
+class vtkThresholdKeepCells;
 
 class VTKFILTERSCORE_EXPORT vtkThreshold : public vtkUnstructuredGridAlgorithm
 {
@@ -184,6 +190,16 @@ protected:
   int EvaluateComponents( vtkDataArray *scalars, vtkIdType id );
   int EvaluateCell( vtkDataArray *scalars, vtkIdList* cellPts, int numCellPts );
   int EvaluateCell( vtkDataArray *scalars, int c, vtkIdList* cellPts, int numCellPts );
+
+  // Description:
+  // Return whether the cell, whose points are given, satisfies the
+  // criterion. This is called concurrently on the cells of the input.
+  int KeepCell( vtkDataArray *scalars, int usePointScalars, vtkIdType cellId,
+                vtkIdList* cellPts );
+
+  //BTX
+  friend class vtkThresholdKeepCells;
+  //ETX
 private:
   vtkThreshold(const vtkThreshold&);  // Not implemented.
   void operator=(const vtkThreshold&);  // Not implemented.
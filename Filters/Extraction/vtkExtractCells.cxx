@@ -19,16 +19,14 @@
 
 #include "vtkExtractCells.h"
 
-#include "vtkCellArray.h"
+#include "vtkCell.h"
+#include "vtkCellSubsetExtractor.h"
+#include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
-#include "vtkIntArray.h"
-#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
-#include "vtkCell.h"
 #include "vtkPoints.h"
 #include "vtkPointData.h"
 #include "vtkCellData.h"
-#include "vtkIntArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
@@ -36,7 +34,7 @@
 vtkStandardNewMacro(vtkExtractCells);
 
 #include <set>
-#include <algorithm>
+#include <vector>
 
 class vtkExtractCellsSTLCloak
 {
@@ -47,8 +45,6 @@ public:
 //----------------------------------------------------------------------------
 vtkExtractCells::vtkExtractCells()
 {
-  this->SubSetUGridCellArraySize = 0;
-  this->InputIsUgrid = 0;
   this->CellList = new vtkExtractCellsSTLCloak;
 }
 
@@ -126,22 +122,8 @@ int vtkExtractCells::RequestData(
   vtkUnstructuredGrid *output = vtkUnstructuredGrid::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  this->InputIsUgrid =
-    ((vtkUnstructuredGrid::SafeDownCast(input)) != NULL);
-
-  int numCellsInput = input->GetNumberOfCells();
-  int numCells = static_cast<int>(this->CellList->IdTypeSet.size());
-
-  if (numCells == numCellsInput)
-    {
-    #if 0
-    this->Copy(input, output);
-
-    return;
-   #else
-    // The Copy method seems to have a bug, causing codes using ExtractCells to die
-    #endif
-    }
+  vtkIdType numCellsInput = input->GetNumberOfCells();
+  vtkIdType numCells = static_cast<vtkIdType>(this->CellList->IdTypeSet.size());
 
   vtkPointData *PD = input->GetPointData();
   vtkCellData *CD = input->GetCellData();
@@ -167,405 +149,52 @@ int vtkExtractCells::RequestData(
 
     return 1;
     }
-  vtkPointData *newPD = output->GetPointData();
-  vtkCellData *newCD  = output->GetCellData();
-
-  vtkIdList *ptIdMap = reMapPointIds(input);
-
-  vtkIdType numPoints = ptIdMap->GetNumberOfIds();
-
-  newPD->CopyGlobalIdsOn();
-  newPD->CopyAllocate(PD, numPoints);
-
-  newCD->CopyGlobalIdsOn();
-  newCD->CopyAllocate(CD, numCells);
-
-  vtkPoints *pts = vtkPoints::New();
-  if(vtkPointSet* inputPS = vtkPointSet::SafeDownCast(input))
-    {
-    // preserve input datatype
-    pts->SetDataType(inputPS->GetPoints()->GetDataType());
-    }
-  pts->SetNumberOfPoints(numPoints);
-
-  for (vtkIdType newId =0; newId<numPoints; newId++)
-    {
-    vtkIdType oldId = ptIdMap->GetId(newId);
-
-    pts->SetPoint(newId, input->GetPoint(oldId));
-
-    newPD->CopyData(PD, oldId, newId);
-    }
-
-  output->SetPoints(pts);
-  pts->Delete();
-
-  if (this->InputIsUgrid)
-    {
-    this->CopyCellsUnstructuredGrid(ptIdMap, input, output);
-    }
-  else
-    {
-    this->CopyCellsDataSet(ptIdMap, input, output);
-    }
-
-  ptIdMap->Delete();
-
-  output->Squeeze();
-
-  return 1;
-}
-
-//----------------------------------------------------------------------------
-void vtkExtractCells::Copy(vtkDataSet *input, vtkUnstructuredGrid *output)
-{
-  int i;
-
-  if (this->InputIsUgrid)
-    {
-    output->DeepCopy(vtkUnstructuredGrid::SafeDownCast(input));
-    return;
-    }
-
-  int numCells = input->GetNumberOfCells();
-
-  vtkPointData *PD = input->GetPointData();
-  vtkCellData *CD = input->GetCellData();
-
-  vtkPointData *newPD = output->GetPointData();
-  vtkCellData *newCD  = output->GetCellData();
-
-  int numPoints = input->GetNumberOfPoints();
-
-  output->Allocate(numCells);
-
-  newPD->CopyAllocate(PD, numPoints);
-
-  newCD->CopyAllocate(CD, numCells);
-
-  vtkPoints *pts = vtkPoints::New();
-  pts->SetNumberOfPoints(numPoints);
-
-  for (i=0; i<numPoints; i++)
-    {
-    pts->SetPoint(i, input->GetPoint(i));
-    }
-  newPD->DeepCopy(PD);
-
-  output->SetPoints(pts);
-
-  pts->Delete();
-
-  vtkIdList *cellPoints = vtkIdList::New();
-
-  for (vtkIdType cellId=0; cellId < numCells; cellId++)
-    {
-    input->GetCellPoints(cellId, cellPoints);
-
-    output->InsertNextCell(input->GetCellType(cellId), cellPoints);
-    }
-  newCD->DeepCopy(CD);
-
-  cellPoints->Delete();
-
-  output->Squeeze();
-
-  return;
-}
-
-//----------------------------------------------------------------------------
-vtkIdType vtkExtractCells::findInSortedList(vtkIdList *idList, vtkIdType id)
-{
-  vtkIdType numids = idList->GetNumberOfIds();
-
-  if (numids < 8) return idList->IsId(id);
-
-  int L, R, M;
-  L=0;
-  R=numids-1;
-
-  vtkIdType *ids = idList->GetPointer(0);
-
-  int loc = -1;
-
-  while (R > L)
-    {
-    if (R == L+1)
-      {
-      if (ids[R] == id)
-        {
-        loc = R;
-        }
-      else if (ids[L] == id)
-        {
-        loc = L;
-        }
-      break;
-      }
-
-    M = (R + L) / 2;
-
-    if (ids[M] > id)
-      {
-      R = M;
-      continue;
-      }
-    else if (ids[M] < id)
-      {
-      L = M;
-      continue;
-      }
-    else
-      {
-      loc = M;
-      break;
-      }
-    }
-  return loc;
-}
-
-//----------------------------------------------------------------------------
-vtkIdList *vtkExtractCells::reMapPointIds(vtkDataSet *grid)
-{
-  int totalPoints = grid->GetNumberOfPoints();
-
-  char *temp = new char [totalPoints];
-
-  if (!temp)
-    {
-    vtkErrorMacro(<< "vtkExtractCells::reMapPointIds memory allocation");
-    return NULL;
-    }
-  memset(temp, 0, totalPoints);
-
-  int numberOfIds = 0;
-  int i;
-  vtkIdType id;
-  vtkIdList *ptIds = vtkIdList::New();
-  std::set<vtkIdType>::iterator cellPtr;
-
-  if (!this->InputIsUgrid)
-    {
-    for (cellPtr = this->CellList->IdTypeSet.begin();
-         cellPtr != this->CellList->IdTypeSet.end();
-         ++cellPtr)
-      {
-      grid->GetCellPoints(*cellPtr, ptIds);
-
-      vtkIdType nIds = ptIds->GetNumberOfIds();
-
-      vtkIdType *ptId = ptIds->GetPointer(0);
-
-      for (i=0; i<nIds; i++)
-        {
-        id = *ptId++;
-
-        if (temp[id] == 0)
-          {
-          numberOfIds++;
-          temp[id] = 1;
-          }
-        }
-      }
-    }
-  else
-    {
-    vtkUnstructuredGrid *ugrid = vtkUnstructuredGrid::SafeDownCast(grid);
-
-    this->SubSetUGridCellArraySize = 0;
-
-    vtkIdType *cellArray = ugrid->GetCells()->GetPointer();
-    vtkIdType *locs = ugrid->GetCellLocationsArray()->GetPointer(0);
-
-    this->SubSetUGridCellArraySize = 0;
-    vtkIdType maxid = ugrid->GetCellLocationsArray()->GetMaxId();
-
-    for (cellPtr = this->CellList->IdTypeSet.begin();
-         cellPtr != this->CellList->IdTypeSet.end();
-         ++cellPtr)
-      {
-      if (*cellPtr > maxid) continue;
-
-      int loc = locs[*cellPtr];
-
-      vtkIdType nIds = cellArray[loc++];
-
-      this->SubSetUGridCellArraySize += (1 + nIds);
-
-      for (i=0; i<nIds; i++)
-        {
-        id = cellArray[loc++];
-
-        if (temp[id] == 0)
-          {
-          numberOfIds++;
-          temp[id] = 1;
-          }
-        }
-      }
-    }
-
-  ptIds->SetNumberOfIds(numberOfIds);
-  int next=0;
-
-  for (id=0; id<totalPoints; id++)
-    {
-    if (temp[id]) ptIds->SetId(next++, id);
-    }
-
-  delete [] temp;
-
-  return ptIds;
-}
-
-//----------------------------------------------------------------------------
-void vtkExtractCells::CopyCellsDataSet(vtkIdList *ptMap, vtkDataSet *input,
-                                       vtkUnstructuredGrid *output)
-{
-  output->Allocate(this->CellList->IdTypeSet.size());
-
-  vtkCellData *oldCD = input->GetCellData();
-  vtkCellData *newCD = output->GetCellData();
-
-  // We only create vtkOriginalCellIds for the output data set if it does not
-  // exist in the input data set.  If it is in the input data set then we
-  // let CopyData() take care of copying it over.
-  vtkIdTypeArray *origMap = 0;
-  if(oldCD->GetArray("vtkOriginalCellIds") == 0)
-    {
-    origMap = vtkIdTypeArray::New();
-    origMap->SetNumberOfComponents(1);
-    origMap->SetName("vtkOriginalCellIds");
-    newCD->AddArray(origMap);
-    origMap->Delete();
-    }
-
-  vtkIdList *cellPoints = vtkIdList::New();
 
+  // Flag the cells of the list, ignoring the invalid ids.
+  std::vector<signed char> cellFlags(numCellsInput > 0 ? numCellsInput : 1, 0);
   std::set<vtkIdType>::iterator cellPtr;
-
   for (cellPtr = this->CellList->IdTypeSet.begin();
        cellPtr != this->CellList->IdTypeSet.end();
        ++cellPtr)
     {
-    vtkIdType cellId = *cellPtr;
-
-    input->GetCellPoints(cellId, cellPoints);
-
-    for (int i=0; i < cellPoints->GetNumberOfIds(); i++)
+    if (*cellPtr >= 0 && *cellPtr < numCellsInput)
       {
-      vtkIdType oldId = cellPoints->GetId(i);
-
-      vtkIdType newId = vtkExtractCells::findInSortedList(ptMap, oldId);
-
-      cellPoints->SetId(i, newId);
-      }
-    int newId = output->InsertNextCell(input->GetCellType(cellId), cellPoints);
-
-    newCD->CopyData(oldCD, cellId, newId);
-    if(origMap)
-      {
-      origMap->InsertNextValue(cellId);
+      cellFlags[*cellPtr] = 1;
       }
     }
 
-  cellPoints->Delete();
-
-  return;
-}
+  output->GetPointData()->CopyGlobalIdsOn();
+  output->GetCellData()->CopyGlobalIdsOn();
 
-//----------------------------------------------------------------------------
-void vtkExtractCells::CopyCellsUnstructuredGrid(vtkIdList *ptMap,
-                                                vtkDataSet *input,
-                                                vtkUnstructuredGrid *output)
-{
-  vtkUnstructuredGrid *ugrid = vtkUnstructuredGrid::SafeDownCast(input);
-  if (ugrid == NULL)
+  vtkPoints *pts = vtkPoints::New();
+  vtkPointSet* inputPS = vtkPointSet::SafeDownCast(input);
+  if (inputPS && inputPS->GetPoints())
     {
-    this->CopyCellsDataSet(ptMap, input, output);
-    return;
+    // preserve input datatype
+    pts->SetDataType(inputPS->GetPoints()->GetDataType());
     }
 
-  vtkCellData *oldCD = input->GetCellData();
-  vtkCellData *newCD = output->GetCellData();
-
   // We only create vtkOriginalCellIds for the output data set if it does not
   // exist in the input data set.  If it is in the input data set then we
   // let CopyData() take care of copying it over.
   vtkIdTypeArray *origMap = 0;
-  if(oldCD->GetArray("vtkOriginalCellIds") == 0)
+  if(CD->GetArray("vtkOriginalCellIds") == 0)
     {
     origMap = vtkIdTypeArray::New();
     origMap->SetNumberOfComponents(1);
     origMap->SetName("vtkOriginalCellIds");
-    newCD->AddArray(origMap);
-    origMap->Delete();
     }
 
-  int numCells = static_cast<int>(this->CellList->IdTypeSet.size());
-
-  vtkCellArray *cellArray = vtkCellArray::New();                 // output
-  vtkIdTypeArray *newcells = vtkIdTypeArray::New();
-  newcells->SetNumberOfValues(this->SubSetUGridCellArraySize);
-  cellArray->SetCells(numCells, newcells);
-  int cellArrayIdx = 0;
-
-  vtkIdTypeArray *locationArray = vtkIdTypeArray::New();
-  locationArray->SetNumberOfValues(numCells);
+  vtkCellSubsetExtractor::Extract(input, &cellFlags[0], pts, output, origMap);
 
-  vtkUnsignedCharArray *typeArray = vtkUnsignedCharArray::New();
-  typeArray->SetNumberOfValues(numCells);
-
-  int nextCellId = 0;
-
-  std::set<vtkIdType>::iterator cellPtr;                           // input
-  vtkIdType *cells = ugrid->GetCells()->GetPointer();
-  vtkIdType maxid = ugrid->GetCellLocationsArray()->GetMaxId();
-  vtkIdType *locs = ugrid->GetCellLocationsArray()->GetPointer(0);
-  vtkUnsignedCharArray *types = ugrid->GetCellTypesArray();
-
-  for (cellPtr = this->CellList->IdTypeSet.begin();
-       cellPtr != this->CellList->IdTypeSet.end();
-       ++cellPtr)
+  if (origMap)
     {
-    if (*cellPtr > maxid) continue;
-
-    int oldCellId = *cellPtr;
-
-    int loc = locs[oldCellId];
-    int size = static_cast<int>(cells[loc]);
-    vtkIdType *pts = cells + loc + 1;
-    unsigned char type = types->GetValue(oldCellId);
-
-    locationArray->SetValue(nextCellId, cellArrayIdx);
-    typeArray->SetValue(nextCellId, type);
-
-    newcells->SetValue(cellArrayIdx++, size);
-
-    for (int i=0; i<size; i++)
-      {
-      vtkIdType oldId = *pts++;
-      vtkIdType newId = vtkExtractCells::findInSortedList(ptMap, oldId);
-
-      newcells->SetValue(cellArrayIdx++, newId);
-      }
-
-    newCD->CopyData(oldCD, oldCellId, nextCellId);
-    if(origMap)
-      {
-      origMap->InsertNextValue(oldCellId);
-      }
-    nextCellId++;
+    output->GetCellData()->AddArray(origMap);
+    origMap->Delete();
     }
+  pts->Delete();
 
-  output->SetCells(typeArray, locationArray, cellArray);
-
-  typeArray->Delete();
-  locationArray->Delete();
-  newcells->Delete();
-  cellArray->Delete();
-
-  return;
+  return 1;
 }
 
 //----------------------------------------------------------------------------
@@ -71,20 +71,8 @@ protected:
 
 private:
 
-  void Copy(vtkDataSet *input, vtkUnstructuredGrid *output);
-  static vtkIdType findInSortedList(vtkIdList *idList, vtkIdType id);
-  vtkIdList *reMapPointIds(vtkDataSet *grid);
-
-  void CopyCellsDataSet(vtkIdList *ptMap, vtkDataSet *input,
-                        vtkUnstructuredGrid *output);
-  void CopyCellsUnstructuredGrid(vtkIdList *ptMap, vtkDataSet *input,
-                                 vtkUnstructuredGrid *output);
-
   vtkExtractCellsSTLCloak *CellList;
 
-  int SubSetUGridCellArraySize;
-  char InputIsUgrid;
-
   vtkExtractCells(const vtkExtractCells&); // Not implemented
   void operator=(const vtkExtractCells&); // Not implemented
 };
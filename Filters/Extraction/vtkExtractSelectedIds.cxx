@@ -16,6 +16,7 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkCellSubsetExtractor.h"
 #include "vtkCellType.h"
 #include "vtkExtractCells.h"
 #include "vtkIdList.h"
@@ -135,30 +136,17 @@ static void vtkExtractSelectedIdsCopyPoints(vtkDataSet* input,
 {
   vtkPoints* newPts = vtkPoints::New();
 
-  vtkIdType i, numPts = input->GetNumberOfPoints();
-
   vtkIdTypeArray* originalPtIds = vtkIdTypeArray::New();
   originalPtIds->SetNumberOfComponents(1);
   originalPtIds->SetName("vtkOriginalPointIds");
 
-  vtkPointData* inPD = input->GetPointData();
   vtkPointData* outPD = output->GetPointData();
   outPD->SetCopyGlobalIds(1);
-  outPD->CopyAllocate(inPD);
 
-  for (i = 0; i < numPts; i++)
-    {
-    if (inArray[i] > 0)
-      {
-      pointMap[i] = newPts->InsertNextPoint(input->GetPoint(i));
-      outPD->CopyData(inPD, i, pointMap[i]);
-      originalPtIds->InsertNextValue(i);
-      }
-    else
-      {
-      pointMap[i] = -1;
-      }
-    }
+  vtkIdType numNewPts =
+    vtkCellSubsetExtractor::MapPoints(input, NULL, inArray, pointMap);
+  vtkCellSubsetExtractor::CopyPoints(input, pointMap, numNewPts, newPts,
+    outPD, originalPtIds);
 
   outPD->AddArray(originalPtIds);
   originalPtIds->Delete();
@@ -219,6 +207,23 @@ void vtkExtractSelectedIdsCopyCells(vtkDataSet* input, T* output,
   ptIds->Delete();
 }
 
+// Unstructured grids are written directly, at their exact size
+static void vtkExtractSelectedIdsCopyCells(vtkDataSet* input,
+  vtkUnstructuredGrid* output, signed char* inArray, vtkIdType* pointMap)
+{
+  output->GetCellData()->SetCopyGlobalIds(1);
+
+  vtkIdTypeArray* originalIds = vtkIdTypeArray::New();
+  originalIds->SetNumberOfComponents(1);
+  originalIds->SetName("vtkOriginalCellIds");
+
+  vtkCellSubsetExtractor::CopyCells(input, inArray, pointMap, output,
+    originalIds);
+
+  output->GetCellData()->AddArray(originalIds);
+  originalIds->Delete();
+}
+
 namespace
 {
   template <class T>
@@ -768,7 +773,7 @@ int vtkExtractSelectedIds::ExtractCells(
       }
     else
       {
-      vtkExtractSelectedIdsCopyCells<vtkUnstructuredGrid>(input,
+      vtkExtractSelectedIdsCopyCells(input,
         vtkUnstructuredGrid::SafeDownCast(output),
         cellInArray->GetPointer(0), pointMap);
       }
@@ -968,7 +973,7 @@ int vtkExtractSelectedIds::ExtractPoints(
         }
       else
         {
-        vtkExtractSelectedIdsCopyCells<vtkUnstructuredGrid>(input,
+        vtkExtractSelectedIdsCopyCells(input,
           vtkUnstructuredGrid::SafeDownCast(output),
           cellInArray->GetPointer(0), pointMap);
         }
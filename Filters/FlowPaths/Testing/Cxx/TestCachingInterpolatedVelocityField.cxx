@@ -0,0 +1,261 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCachingInterpolatedVelocityField.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks vtkCachingInterpolatedVelocityField on sheared hexahedra and
+// tetrahedra carrying a linear velocity field, which the interpolation
+// reproduces exactly: along a path (where the neighbors of the cached cell
+// are searched), for pairs of nearby points and for many points evaluated
+// with a single call.
+
+#include "vtkCachingInterpolatedVelocityField.h"
+#include "vtkCellType.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <vector>
+
+namespace
+{
+void Velocity(const double x[3], double v[3])
+{
+  v[0] = 1.0 + 0.5 * x[1] - 0.2 * x[2];
+  v[1] = -0.3 * x[0] + 2.0;
+  v[2] = 0.1 * x[0] + 0.4 * x[1] + 0.25 * x[2];
+}
+
+// Shear the grid, so that the cells are not aligned with the axes, and set
+// the velocity field on it.
+void SetUp(vtkUnstructuredGrid* grid)
+{
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(grid->GetNumberOfPoints());
+  vtkNew<vtkDoubleArray> velocity;
+  velocity->SetName("Velocity");
+  velocity->SetNumberOfComponents(3);
+  velocity->SetNumberOfTuples(grid->GetNumberOfPoints());
+  double x[3], v[3];
+  for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); i++)
+    {
+    grid->GetPoint(i, x);
+    x[0] += 0.3 * x[1];
+    x[2] += 0.2 * x[0];
+    points->SetPoint(i, x);
+    Velocity(x, v);
+    velocity->SetTuple(i, v);
+    }
+  grid->SetPoints(points.GetPointer());
+  grid->GetPointData()->AddArray(velocity.GetPointer());
+}
+
+bool Check(const double x[3], const double f[3])
+{
+  double v[3];
+  Velocity(x, v);
+  if (fabs(v[0] - f[0]) > 1e-8 || fabs(v[1] - f[1]) > 1e-8 ||
+      fabs(v[2] - f[2]) > 1e-8)
+    {
+    cerr << "Wrong velocity at " << x[0] << " " << x[1] << " " << x[2]
+         << ": " << f[0] << " " << f[1] << " " << f[2] << endl;
+    return false;
+    }
+  return true;
+}
+
+int TestGrid(vtkUnstructuredGrid* grid, const char* name)
+{
+  SetUp(grid);
+  vtkNew<vtkCachingInterpolatedVelocityField> ivf;
+  ivf->SelectVectors("Velocity");
+  ivf->SetDataSet(0, grid, true, NULL);
+
+  // A path crossing many cells: after the first point, the cells are found
+  // in the cache or among the neighbors of the cached cell.
+  double x[3], f[3];
+  for (int i = 0; i <= 500; i++)
+    {
+    double t = i / 500.0;
+    x[0] = 1.0 + 6.0 * t + 0.3 * (1.0 + 3.0 * t);
+    x[1] = 1.0 + 3.0 * t;
+    x[2] = 4.0 + 2.0 * sin(6.0 * t) + 0.2 * x[0];
+    if (!ivf->FunctionValues(x, f))
+      {
+      cerr << name << ": point " << i << " not found" << endl;
+      return EXIT_FAILURE;
+      }
+    if (!Check(x, f))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  if (ivf->GetNeighborCacheHit() == 0 || ivf->GetCellCacheHit() == 0)
+    {
+    cerr << name << ": neighbors of the cached cell were not used" << endl;
+    return EXIT_FAILURE;
+    }
+
+  // Pairs of nearby points, some of them outside of the grid: the second
+  // point of a pair, searched from the cell of the first one, must be found
+  // where a search from scratch finds it.
+  vtkNew<vtkCachingInterpolatedVelocityField> reference;
+  reference->SelectVectors("Velocity");
+  reference->SetDataSet(0, grid, true, NULL);
+  vtkMath::RandomSeed(1234);
+  int numInside = 0;
+  for (int i = 0; i < 2000; i++)
+    {
+    x[0] = vtkMath::Random(-1.0, 13.0);
+    x[1] = vtkMath::Random(0.0, 9.0);
+    x[2] = vtkMath::Random(0.0, 12.0);
+    ivf->ClearLastCellInfo();
+    ivf->FunctionValues(x, f);
+    for (int j = 0; j < 3; j++)
+      {
+      x[j] += vtkMath::Random(-0.6, 0.6);
+      }
+    int inside = ivf->FunctionValues(x, f);
+    reference->ClearLastCellInfo();
+    if (inside != reference->FunctionValues(x, f))
+      {
+      cerr << name << ": point " << i << " inside in one search only" << endl;
+      return EXIT_FAILURE;
+      }
+    if (inside && !Check(x, f))
+      {
+      return EXIT_FAILURE;
+      }
+    numInside += inside;
+    }
+  if (numInside == 0 || numInside == 2000)
+    {
+    cerr << name << ": unexpected number of points inside" << endl;
+    return EXIT_FAILURE;
+    }
+
+  // Many points at once, some of them outside of the grid. The first pass
+  // has no cached cells, the second one starts from the cells found by the
+  // first one.
+  const int numPoints = 2000;
+  std::vector<double> points(3 * numPoints), values(3 * numPoints);
+  std::vector<vtkIdType> cellIds(numPoints, -1);
+  std::vector<int> datasetIds(numPoints, 0);
+  int expectedInside = 0;
+  for (int i = 0; i < numPoints; i++)
+    {
+    double* p = &points[3 * i];
+    p[0] = vtkMath::Random(-1.0, 13.0);
+    p[1] = vtkMath::Random(0.0, 9.0);
+    p[2] = vtkMath::Random(0.0, 12.0);
+    reference->ClearLastCellInfo();
+    expectedInside += reference->FunctionValues(p, f);
+    }
+  for (int pass = 0; pass < 2; pass++)
+    {
+    numInside = ivf->FunctionValues(numPoints, &points[0], &values[0],
+                                    &cellIds[0], &datasetIds[0]);
+    if (numInside != expectedInside)
+      {
+      cerr << name << ": " << numInside << " points inside instead of "
+           << expectedInside << endl;
+      return EXIT_FAILURE;
+      }
+    for (int i = 0; i < numPoints; i++)
+      {
+      if (cellIds[i] >= 0 && !Check(&points[3 * i], &values[3 * i]))
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    // move the points slightly, into neighbor cells for some of them
+    expectedInside = 0;
+    for (int i = 0; i < numPoints; i++)
+      {
+      double* p = &points[3 * i];
+      p[0] += 0.01;
+      p[1] += 0.01;
+      p[2] += 0.01;
+      reference->ClearLastCellInfo();
+      expectedInside += reference->FunctionValues(p, f);
+      }
+    }
+
+  // the links are not built on the input
+  if (grid->GetCellLinks())
+    {
+    cerr << name << ": the input grid was modified" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+}
+
+int TestCachingInterpolatedVelocityField(int vtkNotUsed(argc),
+                                         char *vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(11, 9, 10);
+  image->SetSpacing(1.0, 1.0, 1.0);
+
+  // the voxels of the image, as hexahedra
+  int dims[3];
+  image->GetDimensions(dims);
+  vtkNew<vtkUnstructuredGrid> hexGrid;
+  vtkNew<vtkPoints> hexPoints;
+  hexPoints->SetNumberOfPoints(image->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+    {
+    hexPoints->SetPoint(i, image->GetPoint(i));
+    }
+  hexGrid->SetPoints(hexPoints.GetPointer());
+  hexGrid->Allocate(image->GetNumberOfCells());
+  for (int k = 0; k < dims[2] - 1; k++)
+    {
+    for (int j = 0; j < dims[1] - 1; j++)
+      {
+      for (int i = 0; i < dims[0] - 1; i++)
+        {
+        vtkIdType id = i + dims[0] * (j + dims[1] * k);
+        vtkIdType sliceSize = dims[0] * dims[1];
+        vtkIdType pts[8] = { id, id + 1, id + 1 + dims[0], id + dims[0],
+                             id + sliceSize, id + 1 + sliceSize,
+                             id + 1 + dims[0] + sliceSize,
+                             id + dims[0] + sliceSize };
+        hexGrid->InsertNextCell(VTK_HEXAHEDRON, 8, pts);
+        }
+      }
+    }
+  if (TestGrid(hexGrid.GetPointer(), "Hexahedra") != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputData(image.GetPointer());
+  tetrahedra->Update();
+  vtkNew<vtkUnstructuredGrid> tetGrid;
+  tetGrid->DeepCopy(tetrahedra->GetOutput());
+  if (TestGrid(tetGrid.GetPointer(), "Tetrahedra") != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,256 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestParticleTracerBlockStreaming.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkParticleTracer gives the same particles when only the
+// blocks around the particles are loaded (BlockStreaming) as when the whole
+// multiblock dataset is, with and without a block cache, and that fewer
+// blocks are then produced by the source.
+
+#include "vtkCompositeDataPipeline.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkMultiBlockDataSetAlgorithm.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkParticleTracer.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+
+#include <set>
+#include <vector>
+
+// 6x2 blocks of unit size, carrying a velocity field that changes with
+// time. The source gives the bounding boxes of the blocks in its meta-data
+// and only produces the requested blocks.
+class TestBlockSource : public vtkMultiBlockDataSetAlgorithm
+{
+public:
+  static TestBlockSource *New();
+  vtkTypeMacro(TestBlockSource,vtkMultiBlockDataSetAlgorithm);
+
+  vtkGetMacro(NumberOfBlocksLoaded, int);
+
+  enum { NX = 6, NY = 2 };
+
+protected:
+  TestBlockSource()
+  {
+    this->SetNumberOfInputPorts(0);
+    this->NumberOfBlocksLoaded = 0;
+  }
+
+  int RequestInformation(vtkInformation *,
+                         vtkInformationVector **,
+                         vtkInformationVector *outputVector)
+  {
+    vtkInformation *outInfo = outputVector->GetInformationObject(0);
+    double timeSteps[10];
+    for (int i = 0; i < 10; i++)
+      {
+      timeSteps[i] = i;
+      }
+    double range[2] = { 0, 9 };
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_STEPS(), timeSteps, 10);
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_RANGE(), range, 2);
+
+    vtkNew<vtkMultiBlockDataSet> metaData;
+    metaData->SetNumberOfBlocks(NX * NY);
+    for (int j = 0; j < NY; j++)
+      {
+      for (int i = 0; i < NX; i++)
+        {
+        double bounds[6] = { i, i + 1.0, j, j + 1.0, 0.0, 1.0 };
+        metaData->GetMetaData(i + NX * j)->Set(vtkDataObject::BOUNDING_BOX(),
+                                               bounds, 6);
+        }
+      }
+    outInfo->Set(vtkCompositeDataPipeline::COMPOSITE_DATA_META_DATA(),
+                 metaData.GetPointer());
+    return 1;
+  }
+
+  int RequestData(vtkInformation *,
+                  vtkInformationVector **,
+                  vtkInformationVector *outputVector)
+  {
+    vtkInformation *outInfo = outputVector->GetInformationObject(0);
+    vtkMultiBlockDataSet *output = vtkMultiBlockDataSet::SafeDownCast(
+      outInfo->Get(vtkDataObject::DATA_OBJECT()));
+    double t = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
+    output->GetInformation()->Set(vtkDataObject::DATA_TIME_STEP(), t);
+
+    // flat index i+1 is block i
+    std::set<int> requested;
+    bool all = !outInfo->Has(vtkCompositeDataPipeline::UPDATE_COMPOSITE_INDICES());
+    if (!all)
+      {
+      int *indices =
+        outInfo->Get(vtkCompositeDataPipeline::UPDATE_COMPOSITE_INDICES());
+      requested.insert(indices, indices +
+        outInfo->Length(vtkCompositeDataPipeline::UPDATE_COMPOSITE_INDICES()));
+      }
+
+    output->SetNumberOfBlocks(NX * NY);
+    for (int b = 0; b < NX * NY; b++)
+      {
+      if (!all && requested.find(b + 1) == requested.end())
+        {
+        continue;
+        }
+      vtkNew<vtkImageData> image;
+      image->SetDimensions(5, 5, 5);
+      image->SetSpacing(0.25, 0.25, 0.25);
+      image->SetOrigin(b % NX, b / NX, 0.0);
+      vtkNew<vtkDoubleArray> velocity;
+      velocity->SetName("Velocity");
+      velocity->SetNumberOfComponents(3);
+      velocity->SetNumberOfTuples(image->GetNumberOfPoints());
+      double x[3];
+      for (vtkIdType p = 0; p < image->GetNumberOfPoints(); p++)
+        {
+        image->GetPoint(p, x);
+        velocity->SetTuple3(p, 0.5 + 0.05 * t, 0.1 * (1.0 - x[1]),
+                            0.05 * (0.5 - x[2]) * (1.0 + 0.1 * t));
+        }
+      image->GetPointData()->SetVectors(velocity.GetPointer());
+      output->SetBlock(b, image.GetPointer());
+      this->NumberOfBlocksLoaded++;
+      }
+    return 1;
+  }
+
+private:
+  TestBlockSource(const TestBlockSource&); // Not implemented.
+  void operator=(const TestBlockSource&);  // Not implemented.
+
+  int NumberOfBlocksLoaded;
+};
+
+vtkStandardNewMacro(TestBlockSource);
+
+namespace
+{
+// the positions of the particles, by particle id
+bool GetParticles(vtkPolyData* particles, std::vector<double>& positions)
+{
+  vtkDataArray* ids = particles->GetPointData()->GetArray("ParticleId");
+  if (!ids || particles->GetNumberOfPoints() == 0)
+    {
+    return false;
+    }
+  positions.assign(3 * particles->GetNumberOfPoints(), -1.0);
+  for (vtkIdType i = 0; i < particles->GetNumberOfPoints(); i++)
+    {
+    int id = static_cast<int>(ids->GetTuple1(i));
+    if (id < 0 || id >= particles->GetNumberOfPoints())
+      {
+      return false;
+      }
+    particles->GetPoint(i, &positions[3 * id]);
+    }
+  return true;
+}
+
+int Trace(int blockStreaming, unsigned long cacheLimit,
+          std::vector<double>& positions, TestBlockSource* source)
+{
+  vtkNew<vtkPoints> seedPoints;
+  for (int i = 0; i < 8; i++)
+    {
+    seedPoints->InsertNextPoint(0.2, 0.1 + 0.24 * i, 0.2 + 0.08 * i);
+    }
+  vtkNew<vtkPolyData> seeds;
+  seeds->SetPoints(seedPoints.GetPointer());
+
+  vtkNew<vtkParticleTracer> tracer;
+  tracer->SetInputConnection(0, source->GetOutputPort());
+  tracer->SetInputData(1, seeds.GetPointer());
+  tracer->SetForceReinjectionEveryNSteps(3);
+  tracer->SetBlockStreaming(blockStreaming);
+  tracer->SetBlockCacheLimit(cacheLimit);
+  tracer->SetTerminationTime(7.0);
+  tracer->Update();
+  if (!GetParticles(tracer->GetOutput(), positions))
+    {
+    cerr << "No particles with BlockStreaming " << blockStreaming << endl;
+    return EXIT_FAILURE;
+    }
+
+  // continue the tracing, from the particles computed so far
+  tracer->SetTerminationTime(8.0);
+  tracer->Update();
+  std::vector<double> more;
+  if (!GetParticles(tracer->GetOutput(), more))
+    {
+    cerr << "No particles after continuing the tracing" << endl;
+    return EXIT_FAILURE;
+    }
+  positions.insert(positions.end(), more.begin(), more.end());
+  return EXIT_SUCCESS;
+}
+}
+
+int TestParticleTracerBlockStreaming(int vtkNotUsed(argc),
+                                     char *vtkNotUsed(argv)[])
+{
+  vtkNew<TestBlockSource> wholeSource;
+  std::vector<double> expected;
+  if (Trace(0, 0, expected, wholeSource.GetPointer()) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned long cacheLimits[2] = { 1048576, 0 };
+  for (int c = 0; c < 2; c++)
+    {
+    vtkNew<TestBlockSource> source;
+    std::vector<double> positions;
+    if (Trace(1, cacheLimits[c], positions, source.GetPointer()) != EXIT_SUCCESS)
+      {
+      return EXIT_FAILURE;
+      }
+    if (positions.size() != expected.size())
+      {
+      cerr << "Wrong number of particles: " << positions.size() / 3
+           << " instead of " << expected.size() / 3 << endl;
+      return EXIT_FAILURE;
+      }
+    for (size_t i = 0; i < positions.size(); i++)
+      {
+      if (fabs(positions[i] - expected[i]) > 1e-6)
+        {
+        cerr << "Wrong particle position " << positions[i] << " instead of "
+             << expected[i] << " with cache limit " << cacheLimits[c] << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    cout << "Cache limit " << cacheLimits[c] << ": "
+         << source->GetNumberOfBlocksLoaded() << " blocks loaded instead of "
+         << wholeSource->GetNumberOfBlocksLoaded() << endl;
+    if (source->GetNumberOfBlocksLoaded() >=
+        wholeSource->GetNumberOfBlocksLoaded())
+      {
+      cerr << "The blocks around the particles only should be loaded" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
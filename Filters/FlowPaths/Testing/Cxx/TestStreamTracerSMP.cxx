@@ -0,0 +1,268 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestStreamTracerSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkStreamTracer gives the same streamlines when the seeds are
+// integrated concurrently as when ForceSerialExecution is on, for each
+// integrator and interpolator, on an image, a structured grid and a
+// multiblock dataset. Also checks that the concurrent integration reports
+// its progress and builds the cell locators once.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCellLocator.h"
+#include "vtkCellLocatorInterpolatedVelocityField.h"
+#include "vtkCommand.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkImageDataToPointSet.h"
+#include "vtkMath.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkStreamTracer.h"
+#include "vtkStructuredGrid.h"
+
+#include <algorithm>
+
+// A cell locator that counts how many times it is built.
+class vtkCountingCellLocator : public vtkCellLocator
+{
+public:
+  static vtkCountingCellLocator *New();
+  vtkTypeMacro(vtkCountingCellLocator, vtkCellLocator);
+
+  static int NumberOfBuilds;
+
+protected:
+  virtual void BuildLocatorInternal()
+  {
+    NumberOfBuilds++;
+    this->Superclass::BuildLocatorInternal();
+  }
+};
+
+vtkStandardNewMacro(vtkCountingCellLocator);
+int vtkCountingCellLocator::NumberOfBuilds = 0;
+
+namespace
+{
+// Counts the progress events reported during the execution.
+class ProgressObserver : public vtkCommand
+{
+public:
+  static ProgressObserver *New() { return new ProgressObserver; }
+
+  virtual void Execute(vtkObject*, unsigned long, void* callData)
+  {
+    double progress = *static_cast<double*>(callData);
+    if (progress > 0.0 && progress < 1.0)
+      {
+      this->NumberOfEvents++;
+      }
+  }
+
+  int NumberOfEvents;
+
+protected:
+  ProgressObserver() : NumberOfEvents(0) {}
+};
+
+bool CompareArrays(vtkDataArray* a1, vtkDataArray* a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return false;
+    }
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int j = 0; j < a1->GetNumberOfComponents(); j++)
+      {
+      if (a1->GetComponent(i, j) != a2->GetComponent(i, j))
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+bool CompareData(vtkDataSetAttributes* serial, vtkDataSetAttributes* parallel)
+{
+  if (serial->GetNumberOfArrays() != parallel->GetNumberOfArrays())
+    {
+    return false;
+    }
+  for (int i = 0; i < serial->GetNumberOfArrays(); i++)
+    {
+    vtkDataArray* array = serial->GetArray(i);
+    if (array &&
+        !CompareArrays(array, parallel->GetArray(array->GetName())))
+      {
+      cerr << "Array " << array->GetName() << " differs" << endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+int CompareOutputs(vtkStreamTracer* tracer, const char* mode)
+{
+  tracer->ForceSerialExecutionOn();
+  tracer->Update();
+  vtkNew<vtkPolyData> serial;
+  serial->DeepCopy(tracer->GetOutput());
+
+  tracer->ForceSerialExecutionOff();
+  tracer->Update();
+  vtkPolyData* parallel = tracer->GetOutput();
+
+  if (serial->GetNumberOfLines() < 2 ||
+      serial->GetNumberOfPoints() != parallel->GetNumberOfPoints() ||
+      !CompareArrays(serial->GetPoints()->GetData(),
+                     parallel->GetPoints()->GetData()))
+    {
+    cerr << mode << ": points differ" << endl;
+    return EXIT_FAILURE;
+    }
+  vtkCellArray* serialLines = serial->GetLines();
+  vtkCellArray* parallelLines = parallel->GetLines();
+  if (serialLines->GetNumberOfConnectivityEntries() !=
+      parallelLines->GetNumberOfConnectivityEntries() ||
+      !std::equal(serialLines->GetPointer(),
+                  serialLines->GetPointer() +
+                  serialLines->GetNumberOfConnectivityEntries(),
+                  parallelLines->GetPointer()))
+    {
+    cerr << mode << ": lines differ" << endl;
+    return EXIT_FAILURE;
+    }
+  if (!CompareData(serial->GetPointData(), parallel->GetPointData()) ||
+      !CompareData(serial->GetCellData(), parallel->GetCellData()))
+    {
+    cerr << mode << ": attributes differ" << endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int TestStreamTracerSMP(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  // A swirling field, so that streamlines cross many cells before leaving
+  // the domain.
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(21, 21, 21);
+  image->SetSpacing(0.5, 0.5, 0.5);
+  image->SetOrigin(-5.0, -5.0, -5.0);
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("Velocity");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(image->GetNumberOfPoints());
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  scalars->SetNumberOfTuples(image->GetNumberOfPoints());
+  double x[3];
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+    {
+    image->GetPoint(i, x);
+    vectors->SetTuple3(i, 0.1 * x[0] - x[1], x[0] + 0.05 * x[1],
+                       0.2 * sin(x[2]) + 0.1);
+    scalars->SetValue(i, x[0] * x[1]);
+    }
+  image->GetPointData()->SetVectors(vectors.GetPointer());
+  image->GetPointData()->AddArray(scalars.GetPointer());
+
+  vtkNew<vtkImageDataToPointSet> toPointSet;
+  toPointSet->SetInputData(image.GetPointer());
+  toPointSet->Update();
+
+  vtkNew<vtkImageData> shifted;
+  shifted->DeepCopy(image.GetPointer());
+  shifted->SetOrigin(5.0, -5.0, -5.0);
+  vtkNew<vtkMultiBlockDataSet> blocks;
+  blocks->SetNumberOfBlocks(2);
+  blocks->SetBlock(0, image.GetPointer());
+  blocks->SetBlock(1, shifted.GetPointer());
+
+  vtkNew<vtkPoints> seedPoints;
+  vtkMath::RandomSeed(1234);
+  for (int i = 0; i < 100; i++)
+    {
+    seedPoints->InsertNextPoint(vtkMath::Random(-5.5, 5.5),
+                                vtkMath::Random(-5.5, 5.5),
+                                vtkMath::Random(-5.5, 5.5));
+    }
+  vtkNew<vtkPolyData> seeds;
+  seeds->SetPoints(seedPoints.GetPointer());
+
+  vtkDataObject* inputs[3] =
+    { image.GetPointer(), toPointSet->GetOutput(), blocks.GetPointer() };
+  const char* inputNames[3] = { "Image", "StructuredGrid", "MultiBlock" };
+  const char* integratorNames[3] = { "RK2", "RK4", "RK45" };
+
+  vtkNew<vtkStreamTracer> tracer;
+  tracer->SetSourceData(seeds.GetPointer());
+  tracer->SetIntegrationDirectionToBoth();
+  tracer->SetMaximumPropagation(30);
+  tracer->SetComputeVorticity(true);
+  for (int input = 0; input < 3; input++)
+    {
+    tracer->SetInputData(inputs[input]);
+    for (int integrator = 0; integrator < 3; integrator++)
+      {
+      tracer->SetIntegratorType(integrator);
+      for (int interpolator = 0; interpolator < 2; interpolator++)
+        {
+        tracer->SetInterpolatorType(interpolator);
+        cout << inputNames[input] << " " << integratorNames[integrator]
+             << (interpolator ? " CellLocator" : " DataSetPointLocator")
+             << endl;
+        if (CompareOutputs(tracer.GetPointer(), inputNames[input]) !=
+            EXIT_SUCCESS)
+          {
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  // The threads share the locator of the interpolator.
+  vtkNew<vtkCountingCellLocator> locator;
+  vtkNew<vtkCellLocatorInterpolatedVelocityField> interpolator;
+  interpolator->SetCellLocatorPrototype(locator.GetPointer());
+  vtkNew<ProgressObserver> observer;
+  tracer->SetInputData(toPointSet->GetOutput());
+  tracer->SetInterpolatorPrototype(interpolator.GetPointer());
+  tracer->AddObserver(vtkCommand::ProgressEvent, observer.GetPointer());
+  vtkCountingCellLocator::NumberOfBuilds = 0;
+  tracer->Update();
+  if (vtkCountingCellLocator::NumberOfBuilds != 1)
+    {
+    cerr << "The cell locator was built "
+         << vtkCountingCellLocator::NumberOfBuilds << " times" << endl;
+    return EXIT_FAILURE;
+    }
+  if (observer->NumberOfEvents == 0)
+    {
+    cerr << "No progress reported" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -24,10 +24,17 @@
 #include "vtkSmartPointer.h"
 #include "vtkFloatArray.h"
 #include "vtkDoubleArray.h"
+#include "vtkCellLinks.h"
+#include "vtkCellType.h"
+#include "vtkHexahedron.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkUnstructuredGrid.h"
 
 #include "vtkCellLocator.h"
 #define Custom_TreeType vtkCellLocator
 
+#include <algorithm>
 #include <vector>
 #ifdef JB_BSP_TREE
  #include "vtkModifiedBSPTree.h"
@@ -37,6 +44,143 @@
 //---------------------------------------------------------------------------
 vtkStandardNewMacro(vtkCachingInterpolatedVelocityField);
 //---------------------------------------------------------------------------
+namespace
+{
+// Same as vtkTetra::EvaluatePosition and vtkHexahedron::EvaluatePosition
+// (without the closest point), reading the points of the cell directly.
+// Other cells go through the virtual vtkCell::EvaluatePosition.
+int EvaluatePosition(vtkGenericCell *cell, double x[3], double pcoords[3],
+                     double *weights)
+{
+  int cellType = cell->GetCellType();
+  vtkDataArray *points = cell->Points->GetData();
+  if ((cellType != VTK_TETRA && cellType != VTK_HEXAHEDRON) ||
+      points->GetDataType() != VTK_DOUBLE)
+    {
+    int subId;
+    double dist2;
+    return cell->EvaluatePosition(x, 0, subId, pcoords, dist2, weights);
+    }
+  double *pts = static_cast<vtkDoubleArray *>(points)->GetPointer(0);
+  int i, j;
+
+  if (cellType == VTK_TETRA)
+    {
+    double rhs[3], c1[3], c2[3], c3[3];
+    double det, p4;
+    pcoords[0] = pcoords[1] = pcoords[2] = 0.0;
+    for (i=0; i<3; i++)
+      {
+      rhs[i] = x[i] - pts[i];
+      c1[i] = pts[3+i] - pts[i];
+      c2[i] = pts[6+i] - pts[i];
+      c3[i] = pts[9+i] - pts[i];
+      }
+    if ( (det = vtkMath::Determinant3x3(c1,c2,c3)) == 0.0 )
+      {
+      return -1;
+      }
+    pcoords[0] = vtkMath::Determinant3x3 (rhs,c2,c3) / det;
+    pcoords[1] = vtkMath::Determinant3x3 (c1,rhs,c3) / det;
+    pcoords[2] = vtkMath::Determinant3x3 (c1,c2,rhs) / det;
+    p4 = 1.0 - pcoords[0] - pcoords[1] - pcoords[2];
+    weights[0] = p4;
+    weights[1] = pcoords[0];
+    weights[2] = pcoords[1];
+    weights[3] = pcoords[2];
+    return ( pcoords[0] >= -0.001 && pcoords[0] <= 1.001 &&
+             pcoords[1] >= -0.001 && pcoords[1] <= 1.001 &&
+             pcoords[2] >= -0.001 && pcoords[2] <= 1.001 &&
+             p4 >= -0.001 && p4 <= 1.001 ) ? 1 : 0;
+    }
+
+  // Newton's method, as in vtkHexahedron
+  const double diverged = 1.e6;
+  const int maxIteration = 10;
+  const double convergedTolerance = 1.e-03;
+  const double outsideTolerance = 1.e-06;
+  double params[3], fcol[3], rcol[3], scol[3], tcol[3];
+  double d, derivs[24];
+  int iteration, converged;
+  pcoords[0] = pcoords[1] = pcoords[2] = params[0] = params[1] = params[2]=0.5;
+  for (iteration=converged=0;
+       !converged && (iteration < maxIteration);  iteration++)
+    {
+    vtkHexahedron::InterpolationFunctions(pcoords, weights);
+    vtkHexahedron::InterpolationDerivs(pcoords, derivs);
+    for (i=0; i<3; i++)
+      {
+      fcol[i] = rcol[i] = scol[i] = tcol[i] = 0.0;
+      }
+    for (i=0; i<8; i++)
+      {
+      const double *pt = pts + 3*i;
+      for (j=0; j<3; j++)
+        {
+        fcol[j] += pt[j] * weights[i];
+        rcol[j] += pt[j] * derivs[i];
+        scol[j] += pt[j] * derivs[i+8];
+        tcol[j] += pt[j] * derivs[i+16];
+        }
+      }
+    for (i=0; i<3; i++)
+      {
+      fcol[i] -= x[i];
+      }
+    d=vtkMath::Determinant3x3(rcol,scol,tcol);
+    if ( fabs(d) < 1.e-20)
+      {
+      return -1;
+      }
+    pcoords[0] = params[0] - vtkMath::Determinant3x3 (fcol,scol,tcol) / d;
+    pcoords[1] = params[1] - vtkMath::Determinant3x3 (rcol,fcol,tcol) / d;
+    pcoords[2] = params[2] - vtkMath::Determinant3x3 (rcol,scol,fcol) / d;
+    if ( ((fabs(pcoords[0]-params[0])) < convergedTolerance) &&
+         ((fabs(pcoords[1]-params[1])) < convergedTolerance) &&
+         ((fabs(pcoords[2]-params[2])) < convergedTolerance) )
+      {
+      converged = 1;
+      }
+    else if ((fabs(pcoords[0]) > diverged) ||
+             (fabs(pcoords[1]) > diverged) ||
+             (fabs(pcoords[2]) > diverged))
+      {
+      return -1;
+      }
+    else
+      {
+      params[0] = pcoords[0];
+      params[1] = pcoords[1];
+      params[2] = pcoords[2];
+      }
+    }
+  if ( !converged )
+    {
+    return -1;
+    }
+  vtkHexahedron::InterpolationFunctions(pcoords, weights);
+  double lowerlimit = 0.0-outsideTolerance;
+  double upperlimit = 1.0+outsideTolerance;
+  return ( pcoords[0] >= lowerlimit && pcoords[0] <= upperlimit &&
+           pcoords[1] >= lowerlimit && pcoords[1] <= upperlimit &&
+           pcoords[2] >= lowerlimit && pcoords[2] <= upperlimit ) ? 1 : 0;
+}
+
+// Orders points by dataset, then by cached cell.
+class CachedCellLess
+{
+public:
+  const vtkIdType *CellIds;
+  const int *DataSetIds;
+  bool operator()(int a, int b) const
+    {
+    return this->DataSetIds[a] < this->DataSetIds[b] ||
+      (this->DataSetIds[a] == this->DataSetIds[b] &&
+       this->CellIds[a] < this->CellIds[b]);
+    }
+};
+}
+//---------------------------------------------------------------------------
 const double IVFDataSetInfo::TOLERANCE_SCALE = 1.0E-8;
 //---------------------------------------------------------------------------
 IVFDataSetInfo::IVFDataSetInfo()
@@ -45,6 +189,9 @@ IVFDataSetInfo::IVFDataSetInfo()
   this->VelocityDouble = NULL;
   this->DataSet        = NULL;
   this->Cell           = NULL;
+  this->Grid           = NULL;
+  this->LinkedGrid     = NULL;
+  this->LinkedGridMTime = 0;
   this->BSPTree        = NULL;
   this->Tolerance      = 0.0;
   this->StaticDataSet  = false;
@@ -54,9 +201,17 @@ void IVFDataSetInfo::SetDataSet(vtkDataSet *data, char *velocity, bool staticdat
 {
   this->VelocityFloat  = NULL;
   this->VelocityDouble = NULL;
+  vtkUnstructuredGrid *grid = vtkUnstructuredGrid::SafeDownCast(data);
+  // the links are kept when the same grid is set again, unmodified, e.g.
+  // the second time step of a particle tracer becoming the first one
+  if (!grid || grid != this->Grid ||
+      grid->GetMTime() != this->LinkedGridMTime) {
+    this->LinkedGrid = NULL;
+  }
   this->DataSet        = data;
   this->Cell           = vtkSmartPointer<vtkGenericCell>::New();
   this->StaticDataSet  = staticdataset;
+  this->Grid           = grid;
   if (locator) {
     this->BSPTree = locator;
   }
@@ -83,12 +238,30 @@ void IVFDataSetInfo::SetDataSet(vtkDataSet *data, char *velocity, bool staticdat
   }
 }
 //---------------------------------------------------------------------------
+vtkCellLinks *IVFDataSetInfo::GetCellLinks()
+{
+  if (!this->LinkedGrid) {
+    // the links are used to find the neighbors of the cached cell, they
+    // are built on a shallow copy to leave the input unmodified
+    this->LinkedGrid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    this->LinkedGrid->ShallowCopy(this->Grid);
+    if (!this->LinkedGrid->GetCellLinks()) {
+      this->LinkedGrid->BuildLinks();
+    }
+    this->LinkedGridMTime = this->Grid->GetMTime();
+  }
+  return this->LinkedGrid->GetCellLinks();
+}
+//---------------------------------------------------------------------------
 IVFDataSetInfo::IVFDataSetInfo(const IVFDataSetInfo &ivfci)
 {
   this->VelocityFloat  = ivfci.VelocityFloat;
   this->VelocityDouble = ivfci.VelocityDouble;
   this->DataSet        = ivfci.DataSet;
   this->Cell           = ivfci.Cell;
+  this->Grid           = ivfci.Grid;
+  this->LinkedGrid     = ivfci.LinkedGrid;
+  this->LinkedGridMTime = ivfci.LinkedGridMTime;
   this->BSPTree        = ivfci.BSPTree;
   this->Tolerance      = ivfci.Tolerance;
   this->StaticDataSet  = ivfci.StaticDataSet;
@@ -100,6 +273,9 @@ IVFDataSetInfo &IVFDataSetInfo::operator=(const IVFDataSetInfo &ivfci)
   this->VelocityDouble = ivfci.VelocityDouble;
   this->DataSet        = ivfci.DataSet;
   this->Cell           = ivfci.Cell;
+  this->Grid           = ivfci.Grid;
+  this->LinkedGrid     = ivfci.LinkedGrid;
+  this->LinkedGridMTime = ivfci.LinkedGridMTime;
   this->BSPTree        = ivfci.BSPTree;
   this->Tolerance      = ivfci.Tolerance;
   this->StaticDataSet  = ivfci.StaticDataSet;
@@ -115,6 +291,7 @@ vtkCachingInterpolatedVelocityField::vtkCachingInterpolatedVelocityField()
   this->VectorsSelection = NULL;
   this->TempCell         = vtkGenericCell::New();
   this->CellCacheHit     = 0;
+  this->NeighborCacheHit = 0;
   this->DataSetCacheHit  = 0;
   this->CacheMiss        = 0;
   this->LastCacheIndex   = 0;
@@ -143,6 +320,13 @@ void vtkCachingInterpolatedVelocityField::SetDataSet(int I, vtkDataSet* dataset,
 //---------------------------------------------------------------------------
 void vtkCachingInterpolatedVelocityField::SetLastCellInfo(vtkIdType c, int datasetindex)
 {
+  if (c != -1 && (datasetindex >= static_cast<int>(this->CacheList.size()) ||
+                  !this->CacheList[datasetindex].DataSet))
+  {
+    // no dataset at this index, e.g. its block is not loaded at this time
+    this->ClearLastCellInfo();
+    return;
+  }
   if ((this->LastCacheIndex != datasetindex) || (this->LastCellId != c))
   {
     this->LastCacheIndex = datasetindex;
@@ -191,7 +375,7 @@ int vtkCachingInterpolatedVelocityField::FunctionValues(double* x, double* f)
        this->LastCacheIndex++)
     {
     IVFDataSetInfo *data = &this->CacheList[this->LastCacheIndex];
-    if (data==this->Cache) continue;
+    if (data==this->Cache || !data->DataSet) continue;
     //
     this->LastCellId = -1;
     if (this->FunctionValues(data, x, f))
@@ -214,10 +398,8 @@ int vtkCachingInterpolatedVelocityField::InsideTest(double* x)
   // Test using whatever cached information we have
   if (this->Cache) {
     // check the last cell
-    int subId;
-    if (this->LastCellId!=-1 && this->Cache->Cell->EvaluatePosition(
-        x, 0, subId, this->Cache->PCoords,
-        this->Cache->Tolerance, &this->Weights[0])==1) return 1;
+    if (this->LastCellId!=-1 && EvaluatePosition(this->Cache->Cell,
+        x, this->Cache->PCoords, &this->Weights[0])==1) return 1;
     // check this dataset
     if (this->InsideTest(this->Cache, x)) return 1;
   }
@@ -230,7 +412,7 @@ int vtkCachingInterpolatedVelocityField::InsideTest(double* x)
        this->LastCacheIndex++)
     {
     IVFDataSetInfo *data = &this->CacheList[this->LastCacheIndex];
-    if (data==this->Cache) continue;
+    if (data==this->Cache || !data->DataSet) continue;
     //
     this->LastCellId = -1;
     if (this->InsideTest(data,  x))
@@ -260,7 +442,6 @@ int vtkCachingInterpolatedVelocityField::FunctionValues(
   IVFDataSetInfo *data, double *x, double *f)
 {
   int    subId;
-  double dist2;
 
   if (this->LastCellId>=0)
     {
@@ -268,13 +449,26 @@ int vtkCachingInterpolatedVelocityField::FunctionValues(
     if (data->BSPTree && !data->BSPTree->InsideCellBounds(x, this->LastCellId)) {
       inbox = false;
     }
-    if (inbox && data->Cell->EvaluatePosition(
-      x, 0, subId, data->PCoords, dist2, &this->Weights[0])==1)
+    // the evaluation also tells which face the point left the cell through
+    int inside = -1;
+    if (inbox || data->Grid)
+      {
+      inside = EvaluatePosition(
+        data->Cell, x, data->PCoords, &this->Weights[0]);
+      }
+    if (inbox && inside==1)
       {
       this->FastCompute(data, f);
       this->CellCacheHit++;
       return 1;
       }
+    // the point has most likely moved to a neighbor of the cell
+    if (data->Grid && inside==0 && this->FindCellByWalking(data, x))
+      {
+      this->FastCompute(data, f);
+      this->NeighborCacheHit++;
+      return 1;
+      }
     }
 
   // we need to search the whole dataset
@@ -314,6 +508,151 @@ int vtkCachingInterpolatedVelocityField::FunctionValues(
   return 1;
 }
 //---------------------------------------------------------------------------
+int vtkCachingInterpolatedVelocityField::FindCellByWalking(
+  IVFDataSetInfo *data, double *x)
+{
+  // most steps end in the next cell, a few cells is enough
+  const int maxSteps = 4;
+  vtkCellLinks *links = data->GetCellLinks();
+  double *weights = &this->Weights[0];
+  vtkIdType cellId = this->LastCellId;
+  int ret = 0;
+  for (int step=0; step<maxSteps && ret==0; step++)
+    {
+    // the points of the face x is beyond
+    vtkIdType *cellPts = data->Cell->PointIds->GetPointer(0);
+    vtkIdType facePts[3];
+    int cellType = data->Cell->GetCellType();
+    if (cellType == VTK_TETRA)
+      {
+      // the face opposite to the point of smallest weight
+      int opposite = 0;
+      for (int i=1; i<4; i++)
+        {
+        if (weights[i] < weights[opposite])
+          {
+          opposite = i;
+          }
+        }
+      for (int i=0, j=0; i<4; i++)
+        {
+        if (i != opposite)
+          {
+          facePts[j++] = cellPts[i];
+          }
+        }
+      }
+    else if (cellType == VTK_HEXAHEDRON)
+      {
+      // the face of the parametric coordinate farthest outside of [0,1]
+      int faceId = 0;
+      double maxDistance = 0.0;
+      for (int i=0; i<3; i++)
+        {
+        double pc = data->PCoords[i];
+        if (-pc > maxDistance)
+          {
+          maxDistance = -pc;
+          faceId = 2*i;
+          }
+        if (pc - 1.0 > maxDistance)
+          {
+          maxDistance = pc - 1.0;
+          faceId = 2*i + 1;
+          }
+        }
+      int *face = vtkHexahedron::GetFaceArray(faceId);
+      for (int i=0; i<3; i++)
+        {
+        facePts[i] = cellPts[face[i]];
+        }
+      }
+    else
+      {
+      break;
+      }
+
+    // the other cell using the face
+    vtkIdType neighbor = -1;
+    vtkIdType *cells = links->GetCells(facePts[0]);
+    int numCells = links->GetNcells(facePts[0]);
+    for (int i=0; i<numCells && neighbor<0; i++)
+      {
+      if (cells[i] == cellId)
+        {
+        continue;
+        }
+      vtkIdType npts, *pts;
+      data->Grid->GetCellPoints(cells[i], npts, pts);
+      int numShared = 0;
+      for (vtkIdType j=0; j<npts; j++)
+        {
+        if (pts[j] == facePts[1] || pts[j] == facePts[2])
+          {
+          numShared++;
+          }
+        }
+      if (numShared == 2)
+        {
+        neighbor = cells[i];
+        }
+      }
+    if (neighbor < 0)
+      {
+      // x is outside of the grid, or the cells are not linear
+      break;
+      }
+    cellId = neighbor;
+    data->Grid->GetCell(cellId, data->Cell);
+    ret = EvaluatePosition(data->Cell, x, data->PCoords, weights);
+    }
+  if (ret == 1 && cellId != this->LastCellId)
+    {
+    this->LastCellId = cellId;
+    return 1;
+    }
+  return 0;
+}
+//---------------------------------------------------------------------------
+int vtkCachingInterpolatedVelocityField::FunctionValues(
+  int numPoints, double *x, double *f, vtkIdType *cellIds, int *datasetIds)
+{
+  // visit the points grouped by cell so that the cached cell is reused
+  std::vector<int> order(numPoints);
+  for (int i=0; i<numPoints; i++)
+    {
+    order[i] = i;
+    }
+  CachedCellLess less;
+  less.CellIds = cellIds;
+  less.DataSetIds = datasetIds;
+  std::stable_sort(order.begin(), order.end(), less);
+
+  int numInside = 0;
+  for (int i=0; i<numPoints; i++)
+    {
+    int p = order[i];
+    // without a cached cell, start from the cell of the previous point,
+    // seeds are usually close to each other
+    if (cellIds[p] >= 0)
+      {
+      this->SetLastCellInfo(cellIds[p], datasetIds[p]);
+      }
+    if (this->FunctionValues(x + 3*p, f + 3*p))
+      {
+      cellIds[p] = this->LastCellId;
+      datasetIds[p] = this->LastCacheIndex;
+      numInside++;
+      }
+    else
+      {
+      cellIds[p] = -1;
+      f[3*p] = f[3*p+1] = f[3*p+2] = 0.0;
+      }
+    }
+  return numInside;
+}
+//---------------------------------------------------------------------------
 void vtkCachingInterpolatedVelocityField::FastCompute(
   IVFDataSetInfo *data, double f[3])
 {
@@ -427,6 +766,7 @@ void vtkCachingInterpolatedVelocityField::PrintSelf(ostream& os, vtkIndent inden
     }
 
   os << indent << "Cell Cache hit: " << this->CellCacheHit << endl;
+  os << indent << "Neighbor Cache hit: " << this->NeighborCacheHit << endl;
   os << indent << "DataSet Cache hit: " << this->DataSetCacheHit << endl;
   os << indent << "Cache miss: " << this->CacheMiss << endl;
   os << indent << "VectorsSelection: "
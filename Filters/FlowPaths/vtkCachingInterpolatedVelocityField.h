@@ -27,6 +27,19 @@
 // integration, the next evaluation is usually in the same or a neighbour
 // cell. For this reason, vtkCachingInterpolatedVelocityField stores the last
 // cell id. If caching is turned on, it uses this id as the starting point.
+// For unstructured grids of linear tetrahedra and hexahedra, when the point
+// has left the last cell, the neighbor across the face it went through is
+// tried before the cell locator is searched (walking a few cells further
+// if needed). The neighbors are found through the cell links of the grid,
+// which are built on a shallow copy of it the first time they are needed,
+// and kept for as long as the same, unmodified grid is set again. These
+// cells are also evaluated inline, without going through
+// vtkCell::EvaluatePosition().
+//
+// Many points, for instance the seeds of a particle tracer, can be
+// evaluated with a single call. Each point then carries its own cached
+// cell, and points are visited grouped by cell so that the cells are
+// fetched once.
 
 // .SECTION Caveats
 // vtkCachingInterpolatedVelocityField is not thread safe. A new instance should
@@ -53,6 +66,8 @@ class vtkDataArray;
 class vtkPointData;
 class vtkGenericCell;
 class vtkAbstractCellLocator;
+class vtkCellLinks;
+class vtkUnstructuredGrid;
 //BTX
 //---------------------------------------------------------------------------
 class IVFDataSetInfo;
@@ -77,6 +92,17 @@ public:
   virtual int FunctionValues(double* x, double* f);
   virtual int InsideTest(double* x);
 
+  // Description:
+  // Evaluate the velocity field at numPoints points. x and f hold three
+  // values per point. cellIds and datasetIds hold the cell cached for each
+  // point (-1 if there is none, the search then starts from the cell of the
+  // point evaluated before it), which is used as the starting guess of the
+  // search and is updated with the cell containing the point (-1 if the
+  // point is outside of all datasets, in which case f is set to 0).
+  // Returns the number of points inside the data.
+  int FunctionValues(int numPoints, double* x, double* f,
+                     vtkIdType* cellIds, int* datasetIds);
+
   // Description:
   // Add a dataset used by the interpolation function evaluation.
   virtual void SetDataSet(int I, vtkDataSet* dataset, bool staticdataset, vtkAbstractCellLocator *locator);
@@ -107,7 +133,10 @@ public:
 
   // Description:
   // Caching statistics.
+  // NeighborCacheHit counts the points which were found by walking from
+  // the last cell to its neighbors.
   vtkGetMacro(CellCacheHit, int);
+  vtkGetMacro(NeighborCacheHit, int);
   vtkGetMacro(DataSetCacheHit, int);
   vtkGetMacro(CacheMiss, int);
 
@@ -117,6 +146,7 @@ protected:
 
   vtkGenericCell          *TempCell;
   int                      CellCacheHit;
+  int                      NeighborCacheHit;
   int                      DataSetCacheHit;
   int                      CacheMiss;
   int                      LastCacheIndex;
@@ -135,6 +165,12 @@ protected:
   int FunctionValues(IVFDataSetInfo *cache, double *x, double *f);
   int InsideTest(IVFDataSetInfo *cache, double* x);
 
+  // Description:
+  // Walk from the last cell, which has been evaluated at x and does not
+  // contain it, towards x through the faces x is beyond. On success the
+  // cell, its id, parametric coordinates and weights are cached.
+  int FindCellByWalking(IVFDataSetInfo *cache, double* x);
+
 //BTX
   friend class vtkTemporalInterpolatedVelocityField;
   // Description:
@@ -170,6 +206,9 @@ public:
   vtkSmartPointer<vtkDataSet>             DataSet;
   vtkSmartPointer<vtkAbstractCellLocator> BSPTree;
   vtkSmartPointer<vtkGenericCell>         Cell;
+  vtkUnstructuredGrid                    *Grid; // DataSet, if unstructured
+  vtkSmartPointer<vtkUnstructuredGrid>    LinkedGrid; // Grid, with links
+  unsigned long                           LinkedGridMTime;
   double                                  PCoords[3];
   float                                  *VelocityFloat;
   double                                 *VelocityDouble;
@@ -179,6 +218,8 @@ public:
   IVFDataSetInfo(const IVFDataSetInfo &ivfci);
   IVFDataSetInfo &operator=(const IVFDataSetInfo &ivfci);
   void SetDataSet(vtkDataSet *data, char *velocity, bool staticdataset, vtkAbstractCellLocator *locator);
+  // the cell links of Grid, built on a shallow copy when first needed
+  vtkCellLinks *GetCellLinks();
   //
   static const double TOLERANCE_SCALE;
 };
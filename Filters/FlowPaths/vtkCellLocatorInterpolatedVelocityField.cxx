@@ -271,6 +271,47 @@ void vtkCellLocatorInterpolatedVelocityField::AddDataSet( vtkDataSet * dataset )
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkCellLocatorInterpolatedVelocityField::BuildLocators()
+{
+  vtkGenericCell * cell = vtkGenericCell::New();
+  std::vector< double > weights;
+  for ( size_t i = 0; i < this->CellLocators->size(); i ++ )
+    {
+    // the locators are lazy: they are built by their first query
+    vtkAbstractCellLocator * locator = ( *this->CellLocators )[i].GetPointer();
+    vtkDataSet * ds = ( *this->DataSets )[i];
+    if ( locator && ds->GetNumberOfPoints() > 0 )
+      {
+      double x[3], pcoords[3];
+      weights.resize( ds->GetMaxCellSize() > 0 ? ds->GetMaxCellSize() : 1 );
+      ds->GetPoint( 0, x );
+      locator->FindCell( x, 0.0, cell, pcoords, &weights[0] );
+      }
+    }
+  cell->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkCellLocatorInterpolatedVelocityField::ShareDataSets
+  ( vtkCompositeInterpolatedVelocityField * from )
+{
+  vtkCellLocatorInterpolatedVelocityField * other =
+    vtkCellLocatorInterpolatedVelocityField::SafeDownCast( from );
+  if ( !other )
+    {
+    this->Superclass::ShareDataSets( from );
+    return;
+    }
+
+  for ( size_t i = 0; i < other->DataSets->size(); i ++ )
+    {
+    // replace the locator created (but not built) by AddDataSet()
+    this->AddDataSet( ( *other->DataSets )[i] );
+    this->CellLocators->back() = ( *other->CellLocators )[i];
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkCellLocatorInterpolatedVelocityField::CopyParameters
   ( vtkAbstractInterpolatedVelocityField * from )
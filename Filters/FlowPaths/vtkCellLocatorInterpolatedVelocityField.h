@@ -36,7 +36,7 @@
 
 // .SECTION Caveats
 //  vtkCellLocatorInterpolatedVelocityField is not thread safe. A new instance
-//  should be created by each thread.
+//  should be created by each thread, see ShareDataSets().
 
 // .SECTION See Also
 //  vtkCompositeInterpolatedVelocityField vtkInterpolatedVelocityField
@@ -89,6 +89,16 @@ public:
   // DOES NOT CHANGE THE REFERENCE COUNT OF dataset FOR THREAD SAFETY REASONS.
   virtual void AddDataSet( vtkDataSet * dataset );
 
+  // Description:
+  // Build the cell locators of the datasets, which are otherwise built on
+  // their first use.
+  virtual void BuildLocators();
+
+  // Description:
+  // Add the datasets of another velocity field, sharing its cell locators
+  // when it is a vtkCellLocatorInterpolatedVelocityField.
+  virtual void ShareDataSets( vtkCompositeInterpolatedVelocityField * from );
+
   // Description:
   // Evaluate the velocity field f at point (x, y, z).
   virtual int FunctionValues( double * x, double * f );
@@ -41,6 +41,35 @@ vtkCompositeInterpolatedVelocityField::~vtkCompositeInterpolatedVelocityField()
     }
 }
 
+void vtkCompositeInterpolatedVelocityField::BuildLocators()
+{
+  vtkGenericCell * cell = vtkGenericCell::New();
+  std::vector< double > weights;
+  for ( size_t i = 0; i < this->DataSets->size(); i ++ )
+    {
+    vtkDataSet * ds = ( *this->DataSets )[i];
+    if ( ds && ds->GetNumberOfCells() > 0 )
+      {
+      double x[3], pcoords[3];
+      int    subId;
+      weights.resize( ds->GetMaxCellSize() > 0 ? ds->GetMaxCellSize() : 1 );
+      ds->GetCell( 0, cell );
+      ds->GetPoint( cell->GetPointId( 0 ), x );
+      ds->FindCell( x, NULL, cell, -1, 0.0, subId, pcoords, &weights[0] );
+      }
+    }
+  cell->Delete();
+}
+
+void vtkCompositeInterpolatedVelocityField::ShareDataSets
+  ( vtkCompositeInterpolatedVelocityField * from )
+{
+  for ( size_t i = 0; i < from->DataSets->size(); i ++ )
+    {
+    this->AddDataSet( ( *from->DataSets )[i] );
+    }
+}
+
 void vtkCompositeInterpolatedVelocityField::PrintSelf( ostream & os, vtkIndent indent )
 {
   this->Superclass::PrintSelf( os, indent );
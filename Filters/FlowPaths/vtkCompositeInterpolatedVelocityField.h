@@ -54,7 +54,7 @@
 //
 // .SECTION Caveats
 //  vtkCompositeInterpolatedVelocityField is not thread safe. A new instance
-//  should be created by each thread.
+//  should be created by each thread, see ShareDataSets().
 
 // .SECTION See Also
 //  vtkInterpolatedVelocityField vtkCellLocatorInterpolatedVelocityField
@@ -102,6 +102,20 @@ public:
   // dataset FOR THREAD SAFETY REASONS.
   virtual void AddDataSet( vtkDataSet * dataset ) = 0;
 
+  // Description:
+  // Build the structures used to locate cells in the datasets, i.e. the
+  // point locators that vtkDataSet::FindCell() builds on its first call,
+  // so that they are only read by the following evaluations.
+  virtual void BuildLocators();
+
+  // Description:
+  // Add the datasets of another velocity field, sharing the structures
+  // that it uses to locate cells in them. This velocity field keeps its own
+  // cell and weight caches: once the structures have been built with
+  // BuildLocators(), velocity fields sharing them can be evaluated from
+  // different threads.
+  virtual void ShareDataSets( vtkCompositeInterpolatedVelocityField * from );
+
 
 protected:
   vtkCompositeInterpolatedVelocityField();
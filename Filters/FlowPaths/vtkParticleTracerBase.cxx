@@ -19,6 +19,7 @@
 #include "vtkCellData.h"
 #include "vtkCharArray.h"
 #include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataPipeline.h"
 #include "vtkDoubleArray.h"
 #include "vtkExecutive.h"
 #include "vtkGenericCell.h"
@@ -52,6 +53,8 @@
 
 #include <functional>
 #include <algorithm>
+#include <cmath>
+#include <map>
 #ifdef DEBUGPARTICLETRACE
 #define Assert(x) assert(x)
 #define PRINT(x) cout<<__LINE__<<": "<<x<<endl;
@@ -85,6 +88,7 @@ ParticleTracerSetMacro(ComputeVorticity, bool);
 ParticleTracerSetMacro(RotationScale, double)
 ParticleTracerSetMacro(ForceReinjectionEveryNSteps,int);
 ParticleTracerSetMacro(TerminalSpeed, double);
+ParticleTracerSetMacro(BlockStreaming, int);
 
 namespace
 {
@@ -108,6 +112,170 @@ namespace
   }
 };
 
+//---------------------------------------------------------------------------
+// The blocks of the input used with BlockStreaming, and the blocks loaded so
+// far, by time step and block.
+class vtkParticleTracerBaseBlocks
+{
+public:
+  vtkParticleTracerBaseBlocks()
+  {
+    this->Restricted = false;
+    this->FetchStep  = -1;
+    this->SeedPass   = false;
+    this->SeedStep   = -1;
+    this->Size       = 0;
+    this->UseCount   = 0;
+  }
+
+  void Clear()
+  {
+    this->Cache.clear();
+    this->Order.clear();
+    this->Size = 0;
+  }
+
+  bool IsCached(int timeStep, int block)
+  {
+    return this->Cache.find(std::make_pair(timeStep, block)) != this->Cache.end();
+  }
+
+  struct CachedBlock
+  {
+    vtkSmartPointer<vtkDataSet> Data;
+    unsigned long Size;
+    unsigned long LastUse;
+  };
+  typedef std::map<std::pair<int, int>, CachedBlock> CacheType;
+
+  // Mark a cached block as the most recently used one.
+  void Use(CacheType::iterator it)
+  {
+    this->Order.erase(it->second.LastUse);
+    it->second.LastUse = ++this->UseCount;
+    this->Order[it->second.LastUse] = it;
+  }
+
+  // Bin the blocks, grown by a small tolerance, in a uniform grid over
+  // their bounds, with about one block per cell.
+  void BuildIndex()
+  {
+    int numBlocks = static_cast<int>(this->FlatIndices.size());
+    this->Delta.resize(numBlocks);
+    double range[6] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX,
+                        -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+    for (int b=0; b<numBlocks; b++)
+      {
+      const double* bb = &this->Bounds[6*b];
+      this->Delta[b] = 1.0E-6*std::max(bb[1]-bb[0], std::max(bb[3]-bb[2], bb[5]-bb[4]));
+      for (int i=0; i<3; i++)
+        {
+        range[2*i] = std::min(range[2*i], bb[2*i]-this->Delta[b]);
+        range[2*i+1] = std::max(range[2*i+1], bb[2*i+1]+this->Delta[b]);
+        }
+      }
+    int n = static_cast<int>(ceil(pow(static_cast<double>(numBlocks), 1.0/3.0)));
+    for (int i=0; i<3; i++)
+      {
+      this->GridOrigin[i] = range[2*i];
+      this->GridDims[i] = (numBlocks>0 && range[2*i+1]>range[2*i]) ? n : 1;
+      this->GridSpacing[i] = this->GridDims[i]>1 ?
+        (range[2*i+1]-range[2*i])/this->GridDims[i] : 1.0;
+      }
+    this->Grid.assign(this->GridDims[0]*this->GridDims[1]*this->GridDims[2],
+                      std::vector<int>());
+    for (int b=0; b<numBlocks; b++)
+      {
+      int cells[6];
+      this->GetCells(&this->Bounds[6*b], this->Delta[b], cells);
+      for (int k=cells[4]; k<=cells[5]; k++)
+        {
+        for (int j=cells[2]; j<=cells[3]; j++)
+          {
+          for (int i=cells[0]; i<=cells[1]; i++)
+            {
+            this->Grid[i+this->GridDims[0]*(j+this->GridDims[1]*k)].push_back(b);
+            }
+          }
+        }
+      }
+  }
+
+  // Mark the blocks within their tolerance plus d of the box bb.
+  void FindBlocks(const double bb[6], double d, std::vector<char>& marks)
+  {
+    int cells[6];
+    this->GetCells(bb, d, cells);
+    for (int k=cells[4]; k<=cells[5]; k++)
+      {
+      for (int j=cells[2]; j<=cells[3]; j++)
+        {
+        for (int i=cells[0]; i<=cells[1]; i++)
+          {
+          const std::vector<int>& cell =
+            this->Grid[i+this->GridDims[0]*(j+this->GridDims[1]*k)];
+          for (size_t c=0; c<cell.size(); c++)
+            {
+            int b = cell[c];
+            const double* ob = &this->Bounds[6*b];
+            double e = d + this->Delta[b];
+            if (!marks[b] &&
+                bb[0]<=ob[1]+e && bb[1]>=ob[0]-e &&
+                bb[2]<=ob[3]+e && bb[3]>=ob[2]-e &&
+                bb[4]<=ob[5]+e && bb[5]>=ob[4]-e)
+              {
+              marks[b] = 1;
+              }
+            }
+          }
+        }
+      }
+  }
+
+  // flat index, bounding box and tolerance of each leaf of the input
+  std::vector<unsigned int> FlatIndices;
+  std::vector<double>       Bounds;
+  std::vector<double>       Delta;
+  // whether blocks were requested in this pass: the cached data then has
+  // one block per leaf of the input
+  bool                      Restricted;
+  // the blocks needed at the current time step
+  std::vector<int>          Needed;
+  // the previous time step, if its missing blocks are loaded in this pass
+  int                       FetchStep;
+  // whether only the seeds are updated in this pass, and the time step
+  // for which they were
+  bool                      SeedPass;
+  int                       SeedStep;
+  CacheType                 Cache;
+  // the cached blocks, from the least to the most recently used
+  typedef std::map<unsigned long, CacheType::iterator> OrderType;
+  OrderType                 Order;
+  unsigned long             Size;
+  unsigned long             UseCount;
+
+private:
+  // The range of grid cells covered by the box bb grown by d.
+  void GetCells(const double bb[6], double d, int cells[6])
+  {
+    for (int i=0; i<3; i++)
+      {
+      for (int j=0; j<2; j++)
+        {
+        double x = (bb[2*i+j] + (j ? d : -d) - this->GridOrigin[i])/this->GridSpacing[i];
+        x = x>0.0 ? (x<this->GridDims[i]-1 ? x : this->GridDims[i]-1) : 0.0;
+        cells[2*i+j] = static_cast<int>(x);
+        }
+      }
+  }
+
+  // the blocks overlapping each grid cell
+  double                         GridOrigin[3];
+  double                         GridSpacing[3];
+  int                            GridDims[3];
+  std::vector<std::vector<int> > Grid;
+};
+
 //---------------------------------------------------------------------------
 vtkParticleTracerBase::vtkParticleTracerBase()
 {
@@ -157,6 +325,10 @@ vtkParticleTracerBase::vtkParticleTracerBase()
 
   this->SetIntegratorType(RUNGE_KUTTA4);
   this->DisableResetCache = 0;
+
+  this->BlockStreaming  = 0;
+  this->BlockCacheLimit = 1048576;
+  this->Blocks          = new vtkParticleTracerBaseBlocks;
 }
 
 //---------------------------------------------------------------------------
@@ -170,6 +342,7 @@ vtkParticleTracerBase::~vtkParticleTracerBase()
 
   this->SetIntegrator(0);
   this->SetInterpolatorPrototype(0);
+  delete this->Blocks;
 }
 
 //----------------------------------------------------------------------------
@@ -354,6 +527,10 @@ int vtkParticleTracerBase::RequestUpdateExtent(
           {
           PRINT("Reset cache of because upstream is newer")
             this->ResetCache();
+          if (i==0)
+            {
+            this->Blocks->Clear();
+            }
           }
         }
       }
@@ -377,9 +554,172 @@ int vtkParticleTracerBase::RequestUpdateExtent(
       }
     }
 
+  this->RequestBlocks(inputVector);
+
   return 1;
 }
 
+//---------------------------------------------------------------------------
+void vtkParticleTracerBase::RequestBlocks(vtkInformationVector** inputVector)
+{
+  vtkParticleTracerBaseBlocks* blocks = this->Blocks;
+  blocks->Restricted = false;
+  blocks->FetchStep = -1;
+  blocks->SeedPass = false;
+
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkCompositeDataSet* meta = inInfo ? vtkCompositeDataSet::SafeDownCast(
+    inInfo->Get(vtkCompositeDataPipeline::COMPOSITE_DATA_META_DATA())) : NULL;
+  if (!this->BlockStreaming || !meta)
+    {
+    return;
+    }
+
+  // the blocks can be requested only if all have a bounding box
+  std::vector<unsigned int> flatIndices;
+  std::vector<double> blockBounds;
+  vtkSmartPointer<vtkCompositeDataIterator> iter;
+  iter.TakeReference(meta->NewIterator());
+  iter->SetSkipEmptyNodes(false);
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+    vtkInformation* metaData =
+      iter->HasCurrentMetaData() ? iter->GetCurrentMetaData() : NULL;
+    if (!metaData || !metaData->Has(vtkDataObject::BOUNDING_BOX()))
+      {
+      vtkDebugMacro("No bounding box for block " << iter->GetCurrentFlatIndex()
+                    << ", all the blocks are loaded.");
+      return;
+      }
+    double* bb = metaData->Get(vtkDataObject::BOUNDING_BOX());
+    flatIndices.push_back(iter->GetCurrentFlatIndex());
+    blockBounds.insert(blockBounds.end(), bb, bb+6);
+    }
+  if (flatIndices != blocks->FlatIndices || blockBounds != blocks->Bounds)
+    {
+    blocks->Clear();
+    blocks->FlatIndices.swap(flatIndices);
+    blocks->Bounds.swap(blockBounds);
+    blocks->BuildIndex();
+    }
+  blocks->Restricted = true;
+  blocks->Needed.clear();
+
+  std::vector<int> requested;
+  int noBlock = 0;
+  if ((this->HasCache && this->CurrentTime == this->TerminationTime) ||
+      this->CurrentTimeStep >= static_cast<int>(this->InputTimeValues.size()))
+    {
+    // the output is already computed
+    inInfo->Set(vtkCompositeDataPipeline::UPDATE_COMPOSITE_INDICES(), &noBlock, 0);
+    return;
+    }
+
+  // The blocks containing the particles at the start of this step, and the
+  // seeds if they are injected at this step. The seeds are taken from the
+  // bounding box of a seed input when it gives one, otherwise from its data
+  // when it is up to date; if not, the seeds are updated first in a pass of
+  // their own, in which no block is loaded.
+  int numBlocks = static_cast<int>(blocks->FlatIndices.size());
+  std::vector<char> occupied(numBlocks, 0);
+  bool injection = this->CurrentTimeStep==this->StartTimeStep ||
+    (this->ForceReinjectionEveryNSteps>0 &&
+     (this->CurrentTimeStep-this->StartTimeStep)%this->ForceReinjectionEveryNSteps==0);
+  for (int i=0; injection && i<inputVector[1]->GetNumberOfInformationObjects(); i++)
+    {
+    vtkInformation* seedInfo = inputVector[1]->GetInformationObject(i);
+    if (seedInfo->Has(vtkDataObject::BOUNDING_BOX()))
+      {
+      blocks->FindBlocks(seedInfo->Get(vtkDataObject::BOUNDING_BOX()), 0.0, occupied);
+      continue;
+      }
+    vtkDataSet* seeds = vtkDataSet::SafeDownCast(seedInfo->Get(vtkDataObject::DATA_OBJECT()));
+    int port;
+    vtkAlgorithm* seedAlgorithm = this->GetInputAlgorithm(1, i, port);
+    vtkStreamingDemandDrivenPipeline* sddp =
+      vtkStreamingDemandDrivenPipeline::SafeDownCast(seedAlgorithm->GetExecutive());
+    if (sddp)
+      {
+      sddp->UpdatePipelineMTime();
+      }
+    if (blocks->SeedStep!=this->CurrentTimeStep &&
+        (!seeds || (sddp && seeds->GetUpdateTime()<sddp->GetPipelineMTime())))
+      {
+      blocks->SeedPass = true;
+      blocks->SeedStep = this->CurrentTimeStep;
+      inInfo->Set(vtkCompositeDataPipeline::UPDATE_COMPOSITE_INDICES(), &noBlock, 0);
+      return;
+      }
+    for (vtkIdType j=0; seeds && j<seeds->GetNumberOfPoints(); j++)
+      {
+      double p[3];
+      seeds->GetPoint(j, p);
+      double x[6] = { p[0], p[0], p[1], p[1], p[2], p[2] };
+      blocks->FindBlocks(x, 0.0, occupied);
+      }
+    }
+  for (ParticleListIterator it = this->ParticleHistories.begin();
+       it != this->ParticleHistories.end(); ++it)
+    {
+    const double* p = it->CurrentPosition.x;
+    double x[6] = { p[0], p[0], p[1], p[1], p[2], p[2] };
+    blocks->FindBlocks(x, 0.0, occupied);
+    }
+
+  // the blocks touching them
+  std::vector<char> needed(numBlocks, 0);
+  for (int o=0; o<numBlocks; o++)
+    {
+    if (occupied[o])
+      {
+      blocks->FindBlocks(&blocks->Bounds[6*o], blocks->Delta[o], needed);
+      }
+    }
+  for (int b=0; b<numBlocks; b++)
+    {
+    if (needed[b])
+      {
+      blocks->Needed.push_back(b);
+      }
+    }
+
+  // The particles are interpolated between the previous and the current
+  // time step: the needed blocks missing at the previous time step are
+  // loaded first, in a pass of their own.
+  int timeStep = this->CurrentTimeStep;
+  if (this->CurrentTimeStep>this->StartTimeStep)
+    {
+    for (size_t i=0; i<blocks->Needed.size(); i++)
+      {
+      if (!blocks->IsCached(this->CurrentTimeStep-1, blocks->Needed[i]))
+        {
+        requested.push_back(blocks->FlatIndices[blocks->Needed[i]]);
+        }
+      }
+    if (!requested.empty())
+      {
+      timeStep = blocks->FetchStep = this->CurrentTimeStep-1;
+      inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP(),
+                  this->InputTimeValues[timeStep]);
+      }
+    }
+  if (requested.empty())
+    {
+    for (size_t i=0; i<blocks->Needed.size(); i++)
+      {
+      if (!blocks->IsCached(timeStep, blocks->Needed[i]))
+        {
+        requested.push_back(blocks->FlatIndices[blocks->Needed[i]]);
+        }
+      }
+    }
+  vtkDebugMacro("Requesting " << requested.size() << " blocks of time step "
+                << timeStep << ", " << blocks->Needed.size() << " needed");
+  inInfo->Set(vtkCompositeDataPipeline::UPDATE_COMPOSITE_INDICES(),
+              requested.empty() ? &noBlock : &requested[0],
+              static_cast<int>(requested.size()));
+}
+
 //---------------------------------------------------------------------------
 int vtkParticleTracerBase::InitializeInterpolator()
 {
@@ -456,10 +796,14 @@ int vtkParticleTracerBase::InitializeInterpolator()
           inp->ComputeBounds();
           inp->GetBounds(&bbox.b[0]);
           this->CachedBounds[T].push_back(bbox);
-          bool static_dataset = (this->StaticMesh != 0);
+          // the blocks loaded around the particles change with time
+          bool static_dataset = (this->StaticMesh != 0) && !this->Blocks->Restricted;
           this->AllFixedGeometry = this->AllFixedGeometry && static_dataset;
-          // add the dataset to the interpolator
-          this->Interpolator->SetDataSetAtTime(index++, T, this->GetCacheDataTime(T), inp, static_dataset);
+          // add the dataset to the interpolator, with the same index at all
+          // time steps if it is one of the blocks loaded around the particles
+          int datasetIndex = this->Blocks->Restricted ?
+            static_cast<int>(anotherIterP->GetCurrentFlatIndex())-1 : index++;
+          this->Interpolator->SetDataSetAtTime(datasetIndex, T, this->GetCacheDataTime(T), inp, static_dataset);
           if (!this->DataReferenceT[T])
             {
             this->DataReferenceT[T] = inp;
@@ -477,7 +821,8 @@ int vtkParticleTracerBase::InitializeInterpolator()
                   << numValidInputBlocks[0] << " " << numValidInputBlocks[1]);
     return VTK_ERROR;
     }
-  if (numValidInputBlocks[0] != numValidInputBlocks[1] && this->StaticMesh)
+  if (numValidInputBlocks[0] != numValidInputBlocks[1] && this->StaticMesh &&
+      !this->Blocks->Restricted)
     {
     vtkErrorMacro("StaticMesh is set to True but the number of datasets is different between time steps "
                   << numValidInputBlocks[0] << " " << numValidInputBlocks[1]);
@@ -488,7 +833,7 @@ int vtkParticleTracerBase::InitializeInterpolator()
   vtkDebugMacro("AllFixedGeometry " << this->AllFixedGeometry);
 
   // force optimizations if StaticMesh is set.
-  if (this->StaticMesh)
+  if (this->StaticMesh && !this->Blocks->Restricted)
     {
     vtkDebugMacro("Static Mesh optimizations Forced ON");
     this->AllFixedGeometry = 1;
@@ -532,7 +877,19 @@ int vtkParticleTracerBase::UpdateDataCache(vtkDataObject *data)
   vtkDataSet           *dsInput = vtkDataSet::SafeDownCast(data);
   vtkMultiBlockDataSet *mbInput = vtkMultiBlockDataSet::SafeDownCast(data);
 
-  if (dsInput)
+  if (this->Blocks->Restricted)
+    {
+    // the blocks loaded around the particles, each at the index of its leaf
+    // in the input; the previous time step gets the blocks loaded for it
+    // in the previous pass
+    this->CacheBlocks(data, this->CurrentTimeStep);
+    if (i==1)
+      {
+      this->AddCachedBlocks(this->CachedData[0], this->CurrentTimeStep-1);
+      }
+    this->AddCachedBlocks(this->CachedData[i], this->CurrentTimeStep);
+    }
+  else if (dsInput)
     {
     vtkSmartPointer<vtkDataSet> copy;
     copy.TakeReference(dsInput->NewInstance());
@@ -567,9 +924,105 @@ int vtkParticleTracerBase::UpdateDataCache(vtkDataObject *data)
     {
     this->CachedData[1] = this->CachedData[0];
     }
+  if (this->Blocks->Restricted)
+    {
+    this->EvictBlocks();
+    }
   return 1;
 }
 
+//---------------------------------------------------------------------------
+void vtkParticleTracerBase::CacheBlocks(vtkDataObject* data, int timeStep)
+{
+  vtkCompositeDataSet* input = vtkCompositeDataSet::SafeDownCast(data);
+  if (!input)
+    {
+    return;
+    }
+  vtkParticleTracerBaseBlocks* blocks = this->Blocks;
+  std::map<unsigned int, int> blockOfFlatIndex;
+  for (size_t i=0; i<blocks->Needed.size(); i++)
+    {
+    blockOfFlatIndex[blocks->FlatIndices[blocks->Needed[i]]] = blocks->Needed[i];
+    }
+
+  vtkSmartPointer<vtkCompositeDataIterator> iter;
+  iter.TakeReference(input->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+    vtkDataSet *ds = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+    std::map<unsigned int, int>::iterator b =
+      blockOfFlatIndex.find(iter->GetCurrentFlatIndex());
+    if (!ds || b==blockOfFlatIndex.end() || blocks->IsCached(timeStep, b->second))
+      {
+      continue;
+      }
+    vtkParticleTracerBaseBlocks::CacheType::iterator it = blocks->Cache.insert(
+      std::make_pair(std::make_pair(timeStep, b->second),
+                     vtkParticleTracerBaseBlocks::CachedBlock())).first;
+    it->second.Data.TakeReference(ds->NewInstance());
+    it->second.Data->ShallowCopy(ds);
+    it->second.Size = ds->GetActualMemorySize();
+    it->second.LastUse = 0;
+    blocks->Use(it);
+    blocks->Size += it->second.Size;
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkParticleTracerBase::AddCachedBlocks(vtkMultiBlockDataSet* data, int timeStep)
+{
+  vtkParticleTracerBaseBlocks* blocks = this->Blocks;
+  if (data->GetNumberOfBlocks()<blocks->FlatIndices.size())
+    {
+    data->SetNumberOfBlocks(static_cast<unsigned int>(blocks->FlatIndices.size()));
+    }
+  for (size_t i=0; i<blocks->Needed.size(); i++)
+    {
+    vtkParticleTracerBaseBlocks::CacheType::iterator it =
+      blocks->Cache.find(std::make_pair(timeStep, blocks->Needed[i]));
+    if (it!=blocks->Cache.end())
+      {
+      data->SetBlock(blocks->Needed[i], it->second.Data);
+      blocks->Use(it);
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkParticleTracerBase::EvictBlocks()
+{
+  vtkParticleTracerBaseBlocks* blocks = this->Blocks;
+  while (blocks->Size>this->BlockCacheLimit)
+    {
+    // the least recently used block, which is not in use
+    vtkParticleTracerBaseBlocks::OrderType::iterator oldest = blocks->Order.begin();
+    for (; oldest!=blocks->Order.end(); ++oldest)
+      {
+      vtkParticleTracerBaseBlocks::CacheType::iterator it = oldest->second;
+      unsigned int block = static_cast<unsigned int>(it->first.second);
+      bool used = false;
+      for (int T=0; T<2; T++)
+        {
+        used = used || (this->CachedData[T] &&
+                        block<this->CachedData[T]->GetNumberOfBlocks() &&
+                        this->CachedData[T]->GetBlock(block)==it->second.Data.GetPointer());
+        }
+      if (!used)
+        {
+        break;
+        }
+      }
+    if (oldest==blocks->Order.end())
+      {
+      break;
+      }
+    blocks->Size -= oldest->second->second.Size;
+    blocks->Cache.erase(oldest->second);
+    blocks->Order.erase(oldest);
+    }
+}
+
 //---------------------------------------------------------------------------
 bool vtkParticleTracerBase::InsideBounds(double point[])
 {
@@ -607,28 +1060,53 @@ void vtkParticleTracerBase::TestParticles(
   vtkParticleTracerBaseNamespace::ParticleVector &candidates,
   std::vector<int> &passed)
 {
+  // the candidates inside the bounds are searched all at once, most seeds
+  // are then found in the neighbors of the previous seed's cell
+  std::vector<int> inBounds;
+  std::vector<double> x;
   int i = 0;
   for (ParticleIterator it=candidates.begin(); it!=candidates.end(); ++it, ++i)
     {
-    ParticleInformation &info = (*it);
-    double *pos = &info.CurrentPosition.x[0];
+    double *pos = &(*it).CurrentPosition.x[0];
     // if outside bounds, reject instantly
     if (this->InsideBounds(pos))
       {
-      // since this is first test, avoid bad cache tests
-      this->Interpolator->ClearCache();
-      info.LocationState = this->Interpolator->TestPoint(pos);
-      if (info.LocationState==ID_OUTSIDE_ALL /*|| location==ID_OUTSIDE_T0*/)
-        {
-        // can't really use this particle.
-        vtkDebugMacro(<< "TestParticles rejected particle");
-        }
-      else
-        {
-        // get the cached ids and datasets from the TestPoint call
-        this->Interpolator->GetCachedCellIds(info.CachedCellId, info.CachedDataSetId);
-        passed.push_back(i);
-        }
+      inBounds.push_back(i);
+      x.insert(x.end(), pos, pos + 3);
+      }
+    }
+  int numInBounds = static_cast<int>(inBounds.size());
+  if (numInBounds==0)
+    {
+    return;
+    }
+  std::vector<vtkIdType> cellIds(2*numInBounds);
+  std::vector<int> datasetIds(2*numInBounds);
+  this->Interpolator->FindCachedCellIds(
+    numInBounds, &x[0], &cellIds[0], &datasetIds[0]);
+
+  for (int j=0; j<numInBounds; j++)
+    {
+    ParticleInformation &info = candidates[inBounds[j]];
+    if (cellIds[2*j]==-1 && cellIds[2*j+1]==-1)
+      {
+      vtkDebugMacro(<< "TestParticles rejected particle");
+      continue;
+      }
+    // start from the cells found above
+    this->Interpolator->SetCachedCellIds(&cellIds[2*j], &datasetIds[2*j]);
+    info.LocationState =
+      this->Interpolator->TestPoint(&info.CurrentPosition.x[0]);
+    if (info.LocationState==ID_OUTSIDE_ALL /*|| location==ID_OUTSIDE_T0*/)
+      {
+      // can't really use this particle.
+      vtkDebugMacro(<< "TestParticles rejected particle");
+      }
+    else
+      {
+      // get the cached ids and datasets from the TestPoint call
+      this->Interpolator->GetCachedCellIds(info.CachedCellId, info.CachedDataSetId);
+      passed.push_back(inBounds[j]);
       }
     }
 }
@@ -1024,7 +1502,25 @@ int vtkParticleTracerBase::RequestData(
     return 1; //nothing to be done
     }
 
+  if(this->Blocks->SeedPass)
+    {
+    // only the seeds were updated in this pass
+    this->Blocks->SeedPass = false;
+    request->Set(vtkStreamingDemandDrivenPipeline::CONTINUE_EXECUTING(), 1);
+    return 1;
+    }
+
+  if(this->Blocks->FetchStep>=0)
+    {
+    // only blocks of the previous time step were loaded in this pass
+    this->CacheBlocks(inInfo->Get(vtkDataObject::DATA_OBJECT()), this->Blocks->FetchStep);
+    this->Blocks->FetchStep = -1;
+    request->Set(vtkStreamingDemandDrivenPipeline::CONTINUE_EXECUTING(), 1);
+    return 1;
+    }
+
   bool finished = this->CurrentTimeStep==this->TerminationTimeStep;
+  this->Blocks->SeedStep = -1;
   ProcessInput(inputVector);
 
   if(this->FirstIteration)
@@ -1262,6 +1758,8 @@ void vtkParticleTracerBase::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "StaticMesh: " << this->StaticMesh << endl;
   os << indent << "TerminationTime: " << this->TerminationTime << endl;
   os << indent << "StaticSeeds: " << this->StaticSeeds << endl;
+  os << indent << "BlockStreaming: " << this->BlockStreaming << endl;
+  os << indent << "BlockCacheLimit: " << this->BlockCacheLimit << endl;
 }
 
 //---------------------------------------------------------------------------
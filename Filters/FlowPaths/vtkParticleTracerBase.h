@@ -47,6 +47,7 @@ class vtkInitialValueProblemSolver;
 class vtkIntArray;
 class vtkMultiBlockDataSet;
 class vtkMultiProcessController;
+class vtkParticleTracerBaseBlocks;
 class vtkPointData;
 class vtkPoints;
 class vtkPolyData;
@@ -217,6 +218,27 @@ public:
   void AddSourceConnection(vtkAlgorithmOutput* input);
   void RemoveAllSources();
 
+  // Description:
+  // If BlockStreaming is set and the input is a composite dataset whose
+  // meta-data gives the bounding box of each block (as the one of
+  // vtkXMLMultiBlockDataReader does), only the blocks containing particles
+  // or seeds, and the blocks touching them, are requested from the input
+  // at each time step. The particles must not travel farther than these
+  // neighbor blocks during one time step. The StaticMesh optimizations are
+  // not used for these blocks.
+  // The default is that BlockStreaming is 0.
+  void SetBlockStreaming(int);
+  vtkGetMacro(BlockStreaming, int);
+  vtkBooleanMacro(BlockStreaming, int);
+
+  // Description:
+  // The blocks loaded with BlockStreaming are kept for the following time
+  // steps and tracings. When their size exceeds BlockCacheLimit (in
+  // kibibytes), the least recently used ones that are not needed at the
+  // current time step are released. The default is 1048576 (1 GiB).
+  vtkSetMacro(BlockCacheLimit, unsigned long);
+  vtkGetMacro(BlockCacheLimit, unsigned long);
+
  protected:
   vtkSmartPointer<vtkPolyData> Output; //managed by child classes
   vtkSmartPointer<vtkPointData> ProtoPD;
@@ -292,6 +314,11 @@ public:
   int InitializeInterpolator();
   int UpdateDataCache(vtkDataObject *td);
 
+  // Description:
+  // With BlockStreaming, compute the blocks needed at the current time step
+  // and request the ones that are not cached yet.
+  void RequestBlocks(vtkInformationVector** inputVector);
+
   // Description : Test the list of particles to see if they are
   // inside our data. Add good ones to passed list and set count to the
   // number that passed
@@ -414,6 +441,14 @@ private:
 
   bool SetTerminationTimeNoModify(double t);
 
+  // Description:
+  // Add the blocks of data to the block cache, for the given time step, set
+  // the cached blocks needed at this time step in the given dataset, and
+  // release blocks when the cache is too large.
+  void CacheBlocks(vtkDataObject* data, int timeStep);
+  void AddCachedBlocks(vtkMultiBlockDataSet* data, int timeStep);
+  void EvictBlocks();
+
   //Parameters of tracing
   vtkInitialValueProblemSolver* Integrator;
   double IntegrationStep;
@@ -427,6 +462,11 @@ private:
   int           StaticMesh;
   int           StaticSeeds;
 
+  // Loading of the input blocks around the particles
+  int           BlockStreaming;
+  unsigned long BlockCacheLimit;
+  vtkParticleTracerBaseBlocks* Blocks;
+
   std::vector<double>  InputTimeValues;
   double StartTime;
   double TerminationTime;
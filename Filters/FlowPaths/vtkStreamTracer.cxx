@@ -15,11 +15,13 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkStreamTracer.h"
 
 #include "vtkAMRInterpolatedVelocityField.h"
+#include "vtkAtomicInt.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataPipeline.h"
 #include "vtkCompositeDataSet.h"
+#include "vtkCompositeInterpolatedVelocityField.h"
 #include "vtkDataSetAttributes.h"
 #include "vtkDoubleArray.h"
 #include "vtkExecutive.h"
@@ -35,6 +37,7 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkCellLocatorInterpolatedVelocityField.h"
 #include "vtkMath.h"
 #include "vtkMultiBlockDataSet.h"
+#include "vtkMultiThreader.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkOverlappingAMR.h"
@@ -45,6 +48,8 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkRungeKutta2.h"
 #include "vtkRungeKutta4.h"
 #include "vtkRungeKutta45.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 
 #include <vector>
@@ -112,6 +117,7 @@ vtkStreamTracer::vtkStreamTracer()
 
   this->ComputeVorticity = true;
   this->RotationScale    = 1.0;
+  this->ForceSerialExecution = false;
 
   this->LastUsedStepSize = 0.0;
 
@@ -653,96 +659,125 @@ int vtkStreamTracer::CheckInputs(vtkAbstractInterpolatedVelocityField*& func,
   return VTK_OK;
 }
 
-void vtkStreamTracer::Integrate(vtkPointData *input0Data,
-                                vtkPolyData* output,
-                                vtkDataArray* seedSource,
-                                vtkIdList* seedIds,
-                                vtkIntArray* integrationDirections,
-                                double lastPoint[3],
-                                vtkAbstractInterpolatedVelocityField* func,
-                                int maxCellSize,
-                                int vecType,
-                                const char *vecName,
-                                double& inPropagation,
-                                vtkIdType& inNumSteps)
+// Integrates streamlines one at a time, appending their points and point
+// attributes to its own arrays. vtkStreamTracer::Integrate uses one of these
+// to integrate the seeds serially, or one per thread (each with its own
+// velocity field) to integrate them concurrently.
+class vtkStreamTracerLineIntegrator
 {
-  int i;
-  vtkIdType numLines = seedIds->GetNumberOfIds();
-  double propagation = inPropagation;
-  vtkIdType numSteps = inNumSteps;
-
-  // Useful pointers
-  vtkDataSetAttributes* outputPD = output->GetPointData();
-  vtkDataSetAttributes* outputCD = output->GetCellData();
-  vtkPointData* inputPD;
-  vtkDataSet* input;
-  vtkDataArray* inVectors;
-
-  int direction=1;
-
-  if (this->GetIntegrator() == 0)
+public:
+  // The outcome of the integration of one streamline.
+  struct Line
+  {
+    double Propagation;
+    vtkIdType NumberOfSteps;
+    vtkIdType FirstPoint;
+    vtkIdType NumberOfPoints;
+    int ReasonForTermination;
+    bool Started;
+    bool Aborted;
+    bool HasLastPoint;
+    double LastPoint[3];
+    bool HasLastUsedStepSize;
+    double LastUsedStepSize;
+    vtkStreamTracerLineIntegrator* Integrator;
+
+    Line() : Propagation(0.0), NumberOfSteps(0), FirstPoint(0),
+      NumberOfPoints(0), ReasonForTermination(vtkStreamTracer::OUT_OF_LENGTH),
+      Started(false), Aborted(false), HasLastPoint(false),
+      HasLastUsedStepSize(false), LastUsedStepSize(0.0), Integrator(0)
     {
-    vtkErrorMacro("No integrator is specified.");
-    return;
     }
+  };
 
-  double* weights = 0;
-  if ( maxCellSize > 0 )
-    {
-    weights = new double[maxCellSize];
-    }
+  vtkStreamTracerLineIntegrator(vtkStreamTracer* tracer,
+                                vtkAbstractInterpolatedVelocityField* func,
+                                int maxCellSize,
+                                int vecType,
+                                const char* vecName,
+                                vtkDataSetAttributes* input0Data,
+                                vtkDataSetAttributes* pointData);
+
+  // Integrate the streamline starting at seed, from line.Propagation and
+  // line.NumberOfSteps. Returns false, without inserting any point, if the
+  // seed is outside of the domain or if the streamline is already at its
+  // maximum length or number of steps.
+  bool IntegrateLine(double seed[3], int direction, Line& line,
+                     vtkIdType currentLine, vtkIdType numLines,
+                     bool reportProgress);
+
+  // Append the points of a line integrated by another integrator. Returns
+  // the id of the first appended point.
+  vtkIdType AppendLine(const Line& line);
+
+  vtkStreamTracer* Tracer;
+  vtkSmartPointer<vtkAbstractInterpolatedVelocityField> Func;
+  vtkSmartPointer<vtkInitialValueProblemSolver> Integrator;
+  vtkSmartPointer<vtkGenericCell> Cell;
+  std::vector<double> Weights;
+  int VecType;
+  const char* VecName;
+
+  vtkSmartPointer<vtkPoints> Points;
+  vtkSmartPointer<vtkDataSetAttributes> PointData;
+  vtkSmartPointer<vtkDoubleArray> Time;
+  vtkSmartPointer<vtkDoubleArray> VelocityVectors;
+  vtkSmartPointer<vtkDoubleArray> CellVectors;
+  vtkSmartPointer<vtkDoubleArray> Vorticity;
+  vtkSmartPointer<vtkDoubleArray> Rotation;
+  vtkSmartPointer<vtkDoubleArray> AngularVelocity;
+};
+
+vtkStreamTracerLineIntegrator::vtkStreamTracerLineIntegrator(
+  vtkStreamTracer* tracer,
+  vtkAbstractInterpolatedVelocityField* func,
+  int maxCellSize,
+  int vecType,
+  const char* vecName,
+  vtkDataSetAttributes* input0Data,
+  vtkDataSetAttributes* pointData)
+  : Tracer(tracer), Func(func), Weights(maxCellSize > 0 ? maxCellSize : 1),
+    VecType(vecType), VecName(vecName)
+{
+  // Create a new integrator, the type is the same as Integrator
+  this->Integrator.TakeReference(tracer->GetIntegrator()->NewInstance());
+  this->Integrator->SetFunctionSet(func);
 
   // Used in GetCell()
-  vtkGenericCell* cell = vtkGenericCell::New();
-
-  // Create a new integrator, the type is the same as Integrator
-  vtkInitialValueProblemSolver* integrator =
-    this->GetIntegrator()->NewInstance();
-  integrator->SetFunctionSet(func);
+  this->Cell = vtkSmartPointer<vtkGenericCell>::New();
 
   // Since we do not know what the total number of points
   // will be, we do not allocate any. This is important for
   // cases where a lot of streamers are used at once. If we
   // were to allocate any points here, potentially, we can
   // waste a lot of memory if a lot of streamers are used.
-  // Always insert the first point
-  vtkPoints* outputPoints = vtkPoints::New();
-  vtkCellArray* outputLines = vtkCellArray::New();
+  this->Points = vtkSmartPointer<vtkPoints>::New();
 
   // We will keep track of integration time in this array
-  vtkDoubleArray* time = vtkDoubleArray::New();
-  time->SetName("IntegrationTime");
-
-  // This array explains why the integration stopped
-  vtkIntArray* retVals = vtkIntArray::New();
-  retVals->SetName("ReasonForTermination");
+  this->Time = vtkSmartPointer<vtkDoubleArray>::New();
+  this->Time->SetName("IntegrationTime");
 
-  vtkSmartPointer<vtkDoubleArray> velocityVectors;
   if(vecType != vtkDataObject::POINT)
     {
-    velocityVectors = vtkSmartPointer<vtkDoubleArray>::New();
-    velocityVectors->SetName(vecName);
-    velocityVectors->SetNumberOfComponents(3);
+    this->VelocityVectors = vtkSmartPointer<vtkDoubleArray>::New();
+    this->VelocityVectors->SetName(vecName);
+    this->VelocityVectors->SetNumberOfComponents(3);
     }
-  vtkDoubleArray* cellVectors = 0;
-  vtkDoubleArray* vorticity = 0;
-  vtkDoubleArray* rotation = 0;
-  vtkDoubleArray* angularVel = 0;
-  if (this->ComputeVorticity)
+  if (tracer->ComputeVorticity)
     {
-    cellVectors = vtkDoubleArray::New();
-    cellVectors->SetNumberOfComponents(3);
-    cellVectors->Allocate(3*VTK_CELL_SIZE);
+    this->CellVectors = vtkSmartPointer<vtkDoubleArray>::New();
+    this->CellVectors->SetNumberOfComponents(3);
+    this->CellVectors->Allocate(3*VTK_CELL_SIZE);
 
-    vorticity = vtkDoubleArray::New();
-    vorticity->SetName("Vorticity");
-    vorticity->SetNumberOfComponents(3);
+    this->Vorticity = vtkSmartPointer<vtkDoubleArray>::New();
+    this->Vorticity->SetName("Vorticity");
+    this->Vorticity->SetNumberOfComponents(3);
 
-    rotation = vtkDoubleArray::New();
-    rotation->SetName("Rotation");
+    this->Rotation = vtkSmartPointer<vtkDoubleArray>::New();
+    this->Rotation->SetName("Rotation");
 
-    angularVel = vtkDoubleArray::New();
-    angularVel->SetName("AngularVelocity");
+    this->AngularVelocity = vtkSmartPointer<vtkDoubleArray>::New();
+    this->AngularVelocity->SetName("AngularVelocity");
     }
 
   // We will interpolate all point attributes of the input on each point of
@@ -760,103 +795,268 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
   //       as a consequence a large number of such small vtkPolyData objects
   //       are needed to represent a streamline, consuming up the memory before
   //       the intermediate memory is timely released.
-  outputPD->InterpolateAllocate( input0Data,
-                                 this->MaximumNumberOfSteps );
+  this->PointData = pointData;
+  if (!pointData)
+    {
+    this->PointData = vtkSmartPointer<vtkPointData>::New();
+    }
+  this->PointData->InterpolateAllocate( input0Data,
+                                        tracer->MaximumNumberOfSteps );
+}
 
-  vtkIdType numPtsTotal=0;
-  double velocity[3];
+bool vtkStreamTracerLineIntegrator::IntegrateLine(double seed[3],
+                                                  int direction,
+                                                  Line& line,
+                                                  vtkIdType currentLine,
+                                                  vtkIdType numLines,
+                                                  bool reportProgress)
+{
+  int i;
+  vtkStreamTracer* tracer = this->Tracer;
+  vtkAbstractInterpolatedVelocityField* func = this->Func;
+  vtkInitialValueProblemSolver* integrator = this->Integrator;
+  vtkGenericCell* cell = this->Cell;
+  double* weights = &this->Weights[0];
+  int vecType = this->VecType;
+  double propagation = line.Propagation;
+  vtkIdType numSteps = line.NumberOfSteps;
+  double progress;
 
-  int shouldAbort = 0;
+  // Useful pointers
+  vtkPointData* inputPD;
+  vtkDataSet* input;
+  vtkDataArray* inVectors;
+
+  // temporary variables used in the integration
+  double point1[3], point2[3], pcoords[3], vort[3], omega, velocity[3];
+  vtkIdType index, numPts=0;
+
+  // Clear the last cell to avoid starting a search from
+  // the last point in the streamline
+  func->ClearLastCellId();
+
+  // Initial point
+  memcpy(point1, seed, 3*sizeof(double));
+  memcpy(point2, point1, 3*sizeof(double));
+  if (!func->FunctionValues(point1, velocity))
+    {
+    return false;
+    }
+
+  if ( propagation >= tracer->MaximumPropagation ||
+       numSteps    >  tracer->MaximumNumberOfSteps)
+    {
+    return false;
+    }
 
-  for(int currentLine = 0; currentLine < numLines; currentLine++)
+  line.Started = true;
+  line.Integrator = this;
+  line.FirstPoint = this->Points->GetNumberOfPoints();
+
+  numPts++;
+  vtkIdType nextPoint = this->Points->InsertNextPoint(point1);
+  this->Time->InsertNextValue(0.0);
+
+  // We will always pass an arc-length step size to the integrator.
+  // If the user specifies a step size in cell length unit, we will
+  // have to convert it to arc length.
+  vtkStreamTracer::IntervalInformation stepSize;  // either positive or negative
+  stepSize.Unit  = vtkStreamTracer::LENGTH_UNIT;
+  stepSize.Interval = 0;
+  vtkStreamTracer::IntervalInformation aStep; // always positive
+  aStep.Unit = vtkStreamTracer::LENGTH_UNIT;
+  double step, minStep=0, maxStep=0;
+  double stepTaken, accumTime=0;
+  double speed;
+  double cellLength;
+  int retVal=vtkStreamTracer::OUT_OF_LENGTH, tmp;
+
+  // Make sure we use the dataset found by the vtkAbstractInterpolatedVelocityField
+  input = func->GetLastDataSet();
+  inputPD = input->GetPointData();
+  inVectors = input->GetAttributesAsFieldData(vecType)->GetArray(this->VecName);
+  // Convert intervals to arc-length unit
+  input->GetCell(func->GetLastCellId(), cell);
+  cellLength = sqrt(static_cast<double>(cell->GetLength2()));
+  speed = vtkMath::Norm(velocity);
+  // Never call conversion methods if speed == 0
+  if ( speed != 0.0 )
     {
+    tracer->ConvertIntervals( stepSize.Interval, minStep, maxStep,
+                              direction, cellLength );
+    }
 
-    double progress = static_cast<double>(currentLine)/numLines;
-    this->UpdateProgress(progress);
+  // Interpolate all point attributes on first point
+  func->GetLastWeights(weights);
+  InterpolatePoint(this->PointData, inputPD, nextPoint, cell->PointIds, weights, tracer->HasMatchingPointAttributes);
+  if(vecType != vtkDataObject::POINT)
+    {
+    this->VelocityVectors->InsertNextTuple(velocity);
+    }
 
-    switch (integrationDirections->GetValue(currentLine))
+  // Compute vorticity if required
+  // This can be used later for streamribbon generation.
+  if (tracer->ComputeVorticity)
+    {
+    if(vecType == vtkDataObject::POINT)
       {
-      case FORWARD:
-        direction = 1;
-        break;
-      case BACKWARD:
-        direction = -1;
+      inVectors->GetTuples(cell->PointIds, this->CellVectors);
+      func->GetLastLocalCoordinates(pcoords);
+      tracer->CalculateVorticity(cell, pcoords, this->CellVectors, vort);
+      }
+    else
+      {
+      vort[0] = 0;
+      vort[1] = 0;
+      vort[2] = 0;
+      }
+    this->Vorticity->InsertNextTuple(vort);
+    // rotation
+    // local rotation = vorticity . unit tangent ( i.e. velocity/speed )
+    if (speed != 0.0)
+      {
+      omega = vtkMath::Dot(vort, velocity);
+      omega /= speed;
+      omega *= tracer->RotationScale;
+      }
+    else
+      {
+      omega = 0.0;
+      }
+    this->AngularVelocity->InsertNextValue(omega);
+    this->Rotation->InsertNextValue(0.0);
+    }
+
+  double error = 0;
+  // Integrate until the maximum propagation length is reached,
+  // maximum number of steps is reached or until a boundary is encountered.
+  // Begin Integration
+  while ( propagation < tracer->MaximumPropagation )
+    {
+
+    if (numSteps > tracer->MaximumNumberOfSteps)
+      {
+      retVal = vtkStreamTracer::OUT_OF_STEPS;
+      break;
+      }
+
+    if ( numSteps++ % 1000 == 1 )
+      {
+      if (reportProgress)
+        {
+        progress =
+          ( currentLine + propagation / tracer->MaximumPropagation ) / numLines;
+        tracer->UpdateProgress(progress);
+        }
+
+      if (tracer->GetAbortExecute())
+        {
+        line.Aborted = true;
         break;
+        }
       }
 
-    // temporary variables used in the integration
-    double point1[3], point2[3], pcoords[3], vort[3], omega;
-    vtkIdType index, numPts=0;
+    // Never call conversion methods if speed == 0
+    if ( (speed == 0) || (speed <= tracer->TerminalSpeed) )
+      {
+      retVal = vtkStreamTracer::STAGNATION;
+      break;
+      }
 
-    // Clear the last cell to avoid starting a search from
-    // the last point in the streamline
-    func->ClearLastCellId();
+    // If, with the next step, propagation will be larger than
+    // max, reduce it so that it is (approximately) equal to max.
+    aStep.Interval = fabs( stepSize.Interval );
 
-    // Initial point
-    seedSource->GetTuple(seedIds->GetId(currentLine), point1);
-    memcpy(point2, point1, 3*sizeof(double));
-    if (!func->FunctionValues(point1, velocity))
+    if ( ( propagation + aStep.Interval ) > tracer->MaximumPropagation )
       {
-      continue;
+      aStep.Interval = tracer->MaximumPropagation - propagation;
+      if ( stepSize.Interval >= 0 )
+        {
+        stepSize.Interval = vtkStreamTracer::ConvertToLength( aStep, cellLength );
+        }
+      else
+        {
+        stepSize.Interval = vtkStreamTracer::ConvertToLength( aStep, cellLength ) * ( -1.0 );
+        }
+      maxStep = stepSize.Interval;
       }
+    line.HasLastUsedStepSize = true;
+    line.LastUsedStepSize = stepSize.Interval;
 
-    if ( propagation >= this->MaximumPropagation ||
-         numSteps    >  this->MaximumNumberOfSteps)
+    // Calculate the next step using the integrator provided
+    // Break if the next point is out of bounds.
+    func->SetNormalizeVector( true );
+    tmp = integrator->ComputeNextStep( point1, point2, 0, stepSize.Interval,
+                                       stepTaken, minStep, maxStep,
+                                       tracer->MaximumError, error );
+    func->SetNormalizeVector( false );
+    if ( tmp != 0 )
       {
-      continue;
+      retVal = tmp;
+      line.HasLastPoint = true;
+      memcpy(line.LastPoint, point2, 3*sizeof(double));
+      break;
       }
 
-    numPts++;
-    numPtsTotal++;
-    vtkIdType nextPoint = outputPoints->InsertNextPoint(point1);
-    time->InsertNextValue(0.0);
-
-    // We will always pass an arc-length step size to the integrator.
-    // If the user specifies a step size in cell length unit, we will
-    // have to convert it to arc length.
-    IntervalInformation stepSize;  // either positive or negative
-    stepSize.Unit  = LENGTH_UNIT;
-    stepSize.Interval = 0;
-    IntervalInformation aStep; // always positive
-    aStep.Unit = LENGTH_UNIT;
-    double step, minStep=0, maxStep=0;
-    double stepTaken, accumTime=0;
-    double speed;
-    double cellLength;
-    int retVal=OUT_OF_LENGTH, tmp;
+    // This is the next starting point
+    for(i=0; i<3; i++)
+      {
+      point1[i] = point2[i];
+      }
+
+    // Interpolate the velocity at the next point
+    if ( !func->FunctionValues(point2, velocity) )
+      {
+      retVal = vtkStreamTracer::OUT_OF_DOMAIN;
+      line.HasLastPoint = true;
+      memcpy(line.LastPoint, point2, 3*sizeof(double));
+      break;
+      }
+
+    // It is not enough to use the starting point for stagnation calculation
+    // Use average speed to check if it is below stagnation threshold
+    double speed2 = vtkMath::Norm(velocity);
+    if ( (speed+speed2)/2 <= tracer->TerminalSpeed )
+      {
+      retVal = vtkStreamTracer::STAGNATION;
+      break;
+      }
+
+    accumTime += stepTaken / speed;
+    // Calculate propagation (using the same units as MaximumPropagation
+    propagation += fabs( stepSize.Interval );
 
     // Make sure we use the dataset found by the vtkAbstractInterpolatedVelocityField
     input = func->GetLastDataSet();
     inputPD = input->GetPointData();
-    inVectors = input->GetAttributesAsFieldData(vecType)->GetArray(vecName);
-    // Convert intervals to arc-length unit
+    inVectors = input->GetAttributesAsFieldData(vecType)->GetArray(this->VecName);
+
+
+    // Point is valid. Insert it.
+    numPts++;
+    nextPoint = this->Points->InsertNextPoint(point1);
+    this->Time->InsertNextValue(accumTime);
+
+    // Calculate cell length and speed to be used in unit conversions
     input->GetCell(func->GetLastCellId(), cell);
     cellLength = sqrt(static_cast<double>(cell->GetLength2()));
-    speed = vtkMath::Norm(velocity);
-    // Never call conversion methods if speed == 0
-    if ( speed != 0.0 )
-      {
-      this->ConvertIntervals( stepSize.Interval, minStep, maxStep,
-                              direction, cellLength );
-      }
-
-    // Interpolate all point attributes on first point
+    speed = speed2;
+    // Interpolate all point attributes on current point
     func->GetLastWeights(weights);
-    InterpolatePoint(outputPD, inputPD, nextPoint, cell->PointIds, weights, this->HasMatchingPointAttributes);
+    InterpolatePoint(this->PointData, inputPD, nextPoint, cell->PointIds, weights, tracer->HasMatchingPointAttributes);
     if(vecType != vtkDataObject::POINT)
       {
-      velocityVectors->InsertNextTuple(velocity);
+      this->VelocityVectors->InsertNextTuple(velocity);
       }
-
     // Compute vorticity if required
     // This can be used later for streamribbon generation.
-    if (this->ComputeVorticity)
+    if (tracer->ComputeVorticity)
       {
       if(vecType == vtkDataObject::POINT)
         {
-        inVectors->GetTuples(cell->PointIds, cellVectors);
+        inVectors->GetTuples(cell->PointIds, this->CellVectors);
         func->GetLastLocalCoordinates(pcoords);
-        vtkStreamTracer::CalculateVorticity(cell, pcoords, cellVectors, vort);
+        tracer->CalculateVorticity(cell, pcoords, this->CellVectors, vort);
         }
       else
         {
@@ -864,225 +1064,327 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
         vort[1] = 0;
         vort[2] = 0;
         }
-      vorticity->InsertNextTuple(vort);
+      this->Vorticity->InsertNextTuple(vort);
       // rotation
-      // local rotation = vorticity . unit tangent ( i.e. velocity/speed )
-      if (speed != 0.0)
+      // angular velocity = vorticity . unit tangent ( i.e. velocity/speed )
+      // rotation = sum ( angular velocity * stepSize )
+      omega = vtkMath::Dot(vort, velocity);
+      omega /= speed;
+      omega *= tracer->RotationScale;
+      index = this->AngularVelocity->InsertNextValue(omega);
+      this->Rotation->InsertNextValue(this->Rotation->GetValue(index-1) +
+                                      (this->AngularVelocity->GetValue(index-1) + omega)/2 *
+                                      (accumTime - this->Time->GetValue(index-1)));
+      }
+
+    // Never call conversion methods if speed == 0
+    if ( (speed == 0) || (speed <= tracer->TerminalSpeed) )
+      {
+      retVal = vtkStreamTracer::STAGNATION;
+      break;
+      }
+
+    // Convert all intervals to arc length
+    tracer->ConvertIntervals( step, minStep, maxStep, direction, cellLength );
+
+
+    // If the solver is adaptive and the next step size (stepSize.Interval)
+    // that the solver wants to use is smaller than minStep or larger
+    // than maxStep, re-adjust it. This has to be done every step
+    // because minStep and maxStep can change depending on the cell
+    // size (unless it is specified in arc length unit)
+    if (integrator->IsAdaptive())
+      {
+      if (fabs(stepSize.Interval) < fabs(minStep))
         {
-        omega = vtkMath::Dot(vort, velocity);
-        omega /= speed;
-        omega *= this->RotationScale;
+        stepSize.Interval = fabs( minStep ) *
+                              stepSize.Interval / fabs( stepSize.Interval );
         }
-      else
+      else if (fabs(stepSize.Interval) > fabs(maxStep))
         {
-        omega = 0.0;
+        stepSize.Interval = fabs( maxStep ) *
+                              stepSize.Interval / fabs( stepSize.Interval );
         }
-      angularVel->InsertNextValue(omega);
-      rotation->InsertNextValue(0.0);
       }
-
-    double error = 0;
-    // Integrate until the maximum propagation length is reached,
-    // maximum number of steps is reached or until a boundary is encountered.
-    // Begin Integration
-    while ( propagation < this->MaximumPropagation )
+    else
       {
+      stepSize.Interval = step;
+      }
 
-      if (numSteps > this->MaximumNumberOfSteps)
-        {
-        retVal = OUT_OF_STEPS;
-        break;
-        }
+    // End Integration
+    }
 
-      if ( numSteps++ % 1000 == 1 )
-        {
-        progress =
-          ( currentLine + propagation / this->MaximumPropagation ) / numLines;
-        this->UpdateProgress(progress);
+  line.Propagation = propagation;
+  line.NumberOfSteps = numSteps;
+  line.NumberOfPoints = numPts;
+  line.ReasonForTermination = retVal;
+  return true;
+}
 
-        if (this->GetAbortExecute())
-          {
-          shouldAbort = 1;
-          break;
-          }
-        }
+vtkIdType vtkStreamTracerLineIntegrator::AppendLine(const Line& line)
+{
+  vtkStreamTracerLineIntegrator* from = line.Integrator;
+  vtkIdType firstPoint = this->Points->GetNumberOfPoints();
+  int numArrays = this->PointData->GetNumberOfArrays();
+  for (vtkIdType i=line.FirstPoint; i < line.FirstPoint+line.NumberOfPoints; i++)
+    {
+    vtkIdType nextPoint = this->Points->InsertNextPoint(from->Points->GetPoint(i));
+    // Both point data were allocated from the same input point data, their
+    // arrays match
+    for (int j=0; j < numArrays; j++)
+      {
+      this->PointData->GetAbstractArray(j)->InsertTuple(
+        nextPoint, i, from->PointData->GetAbstractArray(j));
+      }
+    this->Time->InsertNextTuple(i, from->Time);
+    if (this->VelocityVectors)
+      {
+      this->VelocityVectors->InsertNextTuple(i, from->VelocityVectors);
+      }
+    if (this->Vorticity)
+      {
+      this->Vorticity->InsertNextTuple(i, from->Vorticity);
+      this->Rotation->InsertNextTuple(i, from->Rotation);
+      this->AngularVelocity->InsertNextTuple(i, from->AngularVelocity);
+      }
+    }
+  return firstPoint;
+}
 
-      // Never call conversion methods if speed == 0
-      if ( (speed == 0) || (speed <= this->TerminalSpeed) )
-        {
-        retVal = STAGNATION;
-        break;
-        }
+namespace
+{
+// Integrates a range of the seeds with the thread's own copy of the velocity
+// field and integrator. The lines stay in the thread's integrator until they
+// are gathered, in the order of the seeds, by vtkStreamTracer::Integrate.
+// Progress is reported, line by line, by the thread that called For().
+class vtkStreamTracerIntegrateLines
+{
+public:
+  vtkStreamTracer* Tracer;
+  vtkCompositeInterpolatedVelocityField* Func;
+  vtkMultiThreaderIDType CallingThread;
+  vtkAtomicInt<vtkTypeInt64> NumberOfIntegratedLines;
+  int MaxCellSize;
+  int VecType;
+  const char* VecName;
+  vtkDataSetAttributes* Input0Data;
+  vtkDataArray* SeedSource;
+  vtkIdList* SeedIds;
+  vtkIntArray* IntegrationDirections;
+  std::vector<vtkStreamTracerLineIntegrator::Line>* Lines;
+  vtkSMPThreadLocal<vtkStreamTracerLineIntegrator*> Integrators;
+
+  vtkStreamTracerIntegrateLines() : NumberOfIntegratedLines(0),
+    Integrators(NULL)
+  {
+  }
 
-      // If, with the next step, propagation will be larger than
-      // max, reduce it so that it is (approximately) equal to max.
-      aStep.Interval = fabs( stepSize.Interval );
+  ~vtkStreamTracerIntegrateLines()
+  {
+    vtkSMPThreadLocal<vtkStreamTracerLineIntegrator*>::iterator iter;
+    for (iter = this->Integrators.begin(); iter != this->Integrators.end();
+         ++iter)
+      {
+      delete *iter;
+      }
+  }
 
-      if ( ( propagation + aStep.Interval ) > this->MaximumPropagation )
-        {
-        aStep.Interval = this->MaximumPropagation - propagation;
-        if ( stepSize.Interval >= 0 )
-          {
-          stepSize.Interval = this->ConvertToLength( aStep, cellLength );
-          }
-        else
-          {
-          stepSize.Interval = this->ConvertToLength( aStep, cellLength ) * ( -1.0 );
-          }
-        maxStep = stepSize.Interval;
-        }
-      this->LastUsedStepSize = stepSize.Interval;
-
-      // Calculate the next step using the integrator provided
-      // Break if the next point is out of bounds.
-      func->SetNormalizeVector( true );
-      tmp = integrator->ComputeNextStep( point1, point2, 0, stepSize.Interval,
-                                         stepTaken, minStep, maxStep,
-                                         this->MaximumError, error );
-      func->SetNormalizeVector( false );
-      if ( tmp != 0 )
+  void Initialize()
+  {
+    // A vtkCompositeInterpolatedVelocityField is not thread safe: each
+    // thread uses its own, with the same parameters, that shares the
+    // datasets and their locators.
+    vtkCompositeInterpolatedVelocityField* func = this->Func->NewInstance();
+    func->CopyParameters(this->Func);
+    func->ShareDataSets(this->Func);
+    func->SelectVectors(this->Func->GetVectorsType(),
+                        this->Func->GetVectorsSelection());
+    this->Integrators.Local() = new vtkStreamTracerLineIntegrator(
+      this->Tracer, func, this->MaxCellSize, this->VecType, this->VecName,
+      this->Input0Data, NULL);
+    func->Delete();
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkStreamTracerLineIntegrator* integrator = this->Integrators.Local();
+    vtkIdType numLines = static_cast<vtkIdType>(this->Lines->size());
+    double seed[3];
+    for (vtkIdType currentLine=begin; currentLine < end; currentLine++)
+      {
+      if (this->Tracer->GetAbortExecute())
         {
-        retVal = tmp;
-        memcpy(lastPoint, point2, 3*sizeof(double));
         break;
         }
-
-      // This is the next starting point
-      for(i=0; i<3; i++)
+      int direction =
+        (this->IntegrationDirections->GetValue(currentLine) ==
+         vtkStreamTracer::BACKWARD) ? -1 : 1;
+      this->SeedSource->GetTuple(this->SeedIds->GetId(currentLine), seed);
+      integrator->IntegrateLine(seed, direction, (*this->Lines)[currentLine],
+                                currentLine, numLines, false);
+      vtkTypeInt64 numIntegrated = ++this->NumberOfIntegratedLines;
+      if (vtkMultiThreader::ThreadsEqual(vtkMultiThreader::GetCurrentThreadID(),
+                                         this->CallingThread))
         {
-        point1[i] = point2[i];
+        this->Tracer->UpdateProgress(
+          static_cast<double>(numIntegrated)/numLines);
         }
+      }
+  }
 
-      // Interpolate the velocity at the next point
-      if ( !func->FunctionValues(point2, velocity) )
-        {
-        retVal = OUT_OF_DOMAIN;
-        memcpy(lastPoint, point2, 3*sizeof(double));
-        break;
-        }
+  void Reduce()
+  {
+  }
+};
+}
 
-      // It is not enough to use the starting point for stagnation calculation
-      // Use average speed to check if it is below stagnation threshold
-      double speed2 = vtkMath::Norm(velocity);
-      if ( (speed+speed2)/2 <= this->TerminalSpeed )
-        {
-        retVal = STAGNATION;
-        break;
-        }
+void vtkStreamTracer::Integrate(vtkPointData *input0Data,
+                                vtkPolyData* output,
+                                vtkDataArray* seedSource,
+                                vtkIdList* seedIds,
+                                vtkIntArray* integrationDirections,
+                                double lastPoint[3],
+                                vtkAbstractInterpolatedVelocityField* func,
+                                int maxCellSize,
+                                int vecType,
+                                const char *vecName,
+                                double& inPropagation,
+                                vtkIdType& inNumSteps)
+{
+  vtkIdType i;
+  vtkIdType numLines = seedIds->GetNumberOfIds();
+  double propagation = inPropagation;
+  vtkIdType numSteps = inNumSteps;
 
-      accumTime += stepTaken / speed;
-      // Calculate propagation (using the same units as MaximumPropagation
-      propagation += fabs( stepSize.Interval );
-
-      // Make sure we use the dataset found by the vtkAbstractInterpolatedVelocityField
-      input = func->GetLastDataSet();
-      inputPD = input->GetPointData();
-      inVectors = input->GetAttributesAsFieldData(vecType)->GetArray(vecName);
-
-
-      // Point is valid. Insert it.
-      numPts++;
-      numPtsTotal++;
-      nextPoint = outputPoints->InsertNextPoint(point1);
-      time->InsertNextValue(accumTime);
-
-      // Calculate cell length and speed to be used in unit conversions
-      input->GetCell(func->GetLastCellId(), cell);
-      cellLength = sqrt(static_cast<double>(cell->GetLength2()));
-      speed = speed2;
-      // Interpolate all point attributes on current point
-      func->GetLastWeights(weights);
-      InterpolatePoint(outputPD, inputPD, nextPoint, cell->PointIds, weights, this->HasMatchingPointAttributes);
-      if(vecType != vtkDataObject::POINT)
-        {
-        velocityVectors->InsertNextTuple(velocity);
-        }
-      // Compute vorticity if required
-      // This can be used later for streamribbon generation.
-      if (this->ComputeVorticity)
-        {
-        if(vecType == vtkDataObject::POINT)
-          {
-          inVectors->GetTuples(cell->PointIds, cellVectors);
-          func->GetLastLocalCoordinates(pcoords);
-          vtkStreamTracer::CalculateVorticity(cell, pcoords, cellVectors, vort);
-          }
-        else
-          {
-          vort[0] = 0;
-          vort[1] = 0;
-          vort[2] = 0;
-          }
-        vorticity->InsertNextTuple(vort);
-        // rotation
-        // angular velocity = vorticity . unit tangent ( i.e. velocity/speed )
-        // rotation = sum ( angular velocity * stepSize )
-        omega = vtkMath::Dot(vort, velocity);
-        omega /= speed;
-        omega *= this->RotationScale;
-        index = angularVel->InsertNextValue(omega);
-        rotation->InsertNextValue(rotation->GetValue(index-1) +
-                                  (angularVel->GetValue(index-1) + omega)/2 *
-                                  (accumTime - time->GetValue(index-1)));
-        }
+  // Useful pointers
+  vtkDataSetAttributes* outputPD = output->GetPointData();
+  vtkDataSetAttributes* outputCD = output->GetCellData();
 
-      // Never call conversion methods if speed == 0
-      if ( (speed == 0) || (speed <= this->TerminalSpeed) )
-        {
-        retVal = STAGNATION;
-        break;
-        }
+  int direction=1;
+
+  if (this->GetIntegrator() == 0)
+    {
+    vtkErrorMacro("No integrator is specified.");
+    return;
+    }
 
-      // Convert all intervals to arc length
-      this->ConvertIntervals( step, minStep, maxStep, direction, cellLength );
+  // The streamline points and their attributes are accumulated here,
+  // point attributes directly in the output.
+  vtkStreamTracerLineIntegrator lines(this, func, maxCellSize, vecType,
+                                      vecName, input0Data, outputPD);
 
+  vtkCellArray* outputLines = vtkCellArray::New();
+
+  // This array explains why the integration stopped
+  vtkIntArray* retVals = vtkIntArray::New();
+  retVals->SetName("ReasonForTermination");
 
-      // If the solver is adaptive and the next step size (stepSize.Interval)
-      // that the solver wants to use is smaller than minStep or larger
-      // than maxStep, re-adjust it. This has to be done every step
-      // because minStep and maxStep can change depending on the cell
-      // size (unless it is specified in arc-length unit)
-      if (integrator->IsAdaptive())
+  // Several seeds starting from scratch (i.e. not a streamline continued
+  // from another process) are integrated concurrently, each thread with its
+  // own copy of the velocity field.
+  std::vector<vtkStreamTracerLineIntegrator::Line> integratedLines;
+  vtkStreamTracerIntegrateLines integrateLines;
+  bool concurrent = !this->ForceSerialExecution && numLines > 1 &&
+    propagation == 0.0 && numSteps == 0 && this->HasMatchingPointAttributes &&
+    vtkCompositeInterpolatedVelocityField::SafeDownCast(func) != NULL;
+  int shouldAbort = 0;
+  if (concurrent)
+    {
+    // Build the structures used to locate cells in the datasets (point
+    // or cell locators, links) once, before the threads share them.
+    vtkCompositeInterpolatedVelocityField* compositeFunc =
+      vtkCompositeInterpolatedVelocityField::SafeDownCast(func);
+    compositeFunc->BuildLocators();
+
+    integratedLines.resize(numLines);
+    integrateLines.Tracer = this;
+    integrateLines.Func = compositeFunc;
+    integrateLines.CallingThread = vtkMultiThreader::GetCurrentThreadID();
+    integrateLines.MaxCellSize = maxCellSize;
+    integrateLines.VecType = vecType;
+    integrateLines.VecName = vecName;
+    integrateLines.Input0Data = input0Data;
+    integrateLines.SeedSource = seedSource;
+    integrateLines.SeedIds = seedIds;
+    integrateLines.IntegrationDirections = integrationDirections;
+    integrateLines.Lines = &integratedLines;
+    vtkSMPTools::For(0, numLines, 1, integrateLines);
+    shouldAbort = this->GetAbortExecute();
+    }
+
+  for(vtkIdType currentLine = 0; currentLine < numLines && !shouldAbort;
+      currentLine++)
+    {
+    vtkStreamTracerLineIntegrator::Line line;
+    vtkIdType firstPoint;
+    if (concurrent)
+      {
+      line = integratedLines[currentLine];
+      if (!line.Started)
         {
-        if (fabs(stepSize.Interval) < fabs(minStep))
-          {
-          stepSize.Interval = fabs( minStep ) *
-                                stepSize.Interval / fabs( stepSize.Interval );
-          }
-        else if (fabs(stepSize.Interval) > fabs(maxStep))
-          {
-          stepSize.Interval = fabs( maxStep ) *
-                                stepSize.Interval / fabs( stepSize.Interval );
-          }
+        continue;
         }
-      else
+      }
+    else
+      {
+      double progress = static_cast<double>(currentLine)/numLines;
+      this->UpdateProgress(progress);
+
+      switch (integrationDirections->GetValue(currentLine))
         {
-        stepSize.Interval = step;
+        case FORWARD:
+          direction = 1;
+          break;
+        case BACKWARD:
+          direction = -1;
+          break;
         }
 
-      // End Integration
+      double seed[3];
+      seedSource->GetTuple(seedIds->GetId(currentLine), seed);
+      line.Propagation = propagation;
+      line.NumberOfSteps = numSteps;
+      if (!lines.IntegrateLine(seed, direction, line, currentLine, numLines,
+                               true))
+        {
+        continue;
+        }
       }
 
-    if (shouldAbort)
+    if (line.HasLastPoint)
+      {
+      memcpy(lastPoint, line.LastPoint, 3*sizeof(double));
+      }
+    if (line.HasLastUsedStepSize)
+      {
+      this->LastUsedStepSize = line.LastUsedStepSize;
+      }
+    if (line.Aborted)
       {
+      shouldAbort = 1;
       break;
       }
 
-    if (numPts > 1)
+    firstPoint = line.FirstPoint;
+    if (line.Integrator != &lines)
       {
-      outputLines->InsertNextCell(numPts);
-      for (i=numPtsTotal-numPts; i<numPtsTotal; i++)
+      firstPoint = lines.AppendLine(line);
+      }
+    if (line.NumberOfPoints > 1)
+      {
+      outputLines->InsertNextCell(line.NumberOfPoints);
+      for (i=firstPoint; i<firstPoint+line.NumberOfPoints; i++)
         {
         outputLines->InsertCellPoint(i);
         }
-      retVals->InsertNextValue(retVal);
+      retVals->InsertNextValue(line.ReasonForTermination);
       }
 
     // Initialize these to 0 before starting the next line.
     // The values passed in the function call are only used
     // for the first line.
-    inPropagation = propagation;
-    inNumSteps = numSteps;
+    inPropagation = line.Propagation;
+    inNumSteps = line.NumberOfSteps;
 
     propagation = 0;
     numSteps = 0;
@@ -1091,20 +1393,20 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
   if (!shouldAbort)
     {
     // Create the output polyline
-    output->SetPoints(outputPoints);
-    outputPD->AddArray(time);
+    output->SetPoints(lines.Points);
+    outputPD->AddArray(lines.Time);
     if(vecType != vtkDataObject::POINT)
       {
-      outputPD->AddArray(velocityVectors);
+      outputPD->AddArray(lines.VelocityVectors);
       }
-    if (vorticity)
+    if (lines.Vorticity)
       {
-      outputPD->AddArray(vorticity);
-      outputPD->AddArray(rotation);
-      outputPD->AddArray(angularVel);
+      outputPD->AddArray(lines.Vorticity);
+      outputPD->AddArray(lines.Rotation);
+      outputPD->AddArray(lines.AngularVelocity);
       }
 
-    vtkIdType numPts = outputPoints->GetNumberOfPoints();
+    vtkIdType numPts = lines.Points->GetNumberOfPoints();
     if ( numPts > 1 )
       {
       // Assign geometry and attributes
@@ -1118,30 +1420,9 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
       }
     }
 
-  if (vorticity)
-    {
-    vorticity->Delete();
-    rotation->Delete();
-    angularVel->Delete();
-    }
-
-  if (cellVectors)
-    {
-    cellVectors->Delete();
-    }
   retVals->Delete();
-
-  outputPoints->Delete();
   outputLines->Delete();
 
-  time->Delete();
-
-
-  integrator->Delete();
-  cell->Delete();
-
-  delete[] weights;
-
   output->Squeeze();
   return;
 }
@@ -1356,6 +1637,8 @@ void vtkStreamTracer::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Vorticity computation: "
      << (this->ComputeVorticity ? " On" : " Off") << endl;
   os << indent << "Rotation scale: " << this->RotationScale << endl;
+  os << indent << "Force serial execution: "
+     << (this->ForceSerialExecution ? "On" : "Off") << endl;
 }
 
 vtkExecutive* vtkStreamTracer::CreateDefaultExecutive()
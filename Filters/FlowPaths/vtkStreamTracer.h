@@ -299,6 +299,18 @@ public:
   // vtkPointSet::FindCell() coupled with vtkPointLocator).
   void SetInterpolatorType( int interpType );
 
+  // Description:
+  // When several seeds are traced, they are integrated concurrently (with
+  // vtkSMPTools), each thread using its own copy of the velocity field
+  // interpolator and integrator. The copies share the datasets and their
+  // cell locators, which are built once. The output does not depend on the
+  // number of threads: the streamlines are stored in the order of the seeds.
+  // Turn this on to integrate the seeds one after the other, for instance
+  // with interpolators that can not be used concurrently. Off by default.
+  vtkSetMacro(ForceSerialExecution, bool);
+  vtkGetMacro(ForceSerialExecution, bool);
+  vtkBooleanMacro(ForceSerialExecution, bool);
+
 protected:
 
   vtkStreamTracer();
@@ -383,6 +395,7 @@ protected:
 
   bool ComputeVorticity;
   double RotationScale;
+  bool ForceSerialExecution;
 
   vtkAbstractInterpolatedVelocityField * InterpolatorPrototype;
 
@@ -390,6 +403,7 @@ protected:
   bool HasMatchingPointAttributes; //does the point data in the multiblocks have the same attributes?
 
   friend class PStreamTracerUtils;
+  friend class vtkStreamTracerLineIntegrator;
 
 private:
   vtkStreamTracer(const vtkStreamTracer&);  // Not implemented.
@@ -69,7 +69,9 @@ void vtkTemporalInterpolatedVelocityField::SetDataSetAtTime(int I, int N, double
   // when the datasets for the second time set are added, set the static flag
   if (N==1)
     {
-    bool is_static = staticdataset && this->ivf[0]->CacheList[I].StaticDataSet;
+    bool is_static = staticdataset &&
+      static_cast<size_t>(I)<this->ivf[0]->CacheList.size() &&
+      this->ivf[0]->CacheList[I].StaticDataSet;
     if (static_cast<size_t>(I)>=this->StaticDataSets.size())
       {
       this->StaticDataSets.resize(I+1,is_static);
@@ -87,7 +89,9 @@ void vtkTemporalInterpolatedVelocityField::SetDataSetAtTime(int I, int N, double
 //---------------------------------------------------------------------------
 bool vtkTemporalInterpolatedVelocityField::IsStatic(int datasetIndex)
 {
-  return this->StaticDataSets[datasetIndex];
+  // the datasets set at the first time step only are not static
+  return static_cast<size_t>(datasetIndex)<this->StaticDataSets.size() &&
+    this->StaticDataSets[datasetIndex];
 }
 //---------------------------------------------------------------------------
 void vtkTemporalInterpolatedVelocityField::SetVectorsSelection(const char *v)
@@ -133,6 +137,51 @@ bool vtkTemporalInterpolatedVelocityField::GetCachedCellIds(vtkIdType id[2], int
   return ((id[0]>=0) && (id[1]>=0));
 }
 //---------------------------------------------------------------------------
+void vtkTemporalInterpolatedVelocityField::FindCachedCellIds(
+  int numPoints, double* x, vtkIdType* cellIds, int* datasetIds)
+{
+  if (numPoints<=0)
+    {
+    return;
+    }
+  std::vector<double> f(3*numPoints);
+  std::vector<vtkIdType> ids(numPoints, -1);
+  std::vector<int> ds(numPoints, 0);
+  this->ivf[0]->FunctionValues(numPoints, x, &f[0], &ids[0], &ds[0]);
+  // a static dataset has the same cells at T1, the other points are
+  // searched again
+  std::vector<int> pointsT1;
+  std::vector<double> xT1;
+  for (int i=0; i<numPoints; i++)
+    {
+    cellIds[2*i]    = ids[i];
+    datasetIds[2*i] = (ids[i]==-1) ? 0 : ds[i];
+    if (ids[i]!=-1 && this->IsStatic(ds[i]))
+      {
+      cellIds[2*i+1]    = ids[i];
+      datasetIds[2*i+1] = ds[i];
+      }
+    else
+      {
+      pointsT1.push_back(i);
+      xT1.insert(xT1.end(), x + 3*i, x + 3*i + 3);
+      }
+    }
+  int numPointsT1 = static_cast<int>(pointsT1.size());
+  if (numPointsT1==0)
+    {
+    return;
+    }
+  ids.assign(numPointsT1, -1);
+  ds.assign(numPointsT1, 0);
+  this->ivf[1]->FunctionValues(numPointsT1, &xT1[0], &f[0], &ids[0], &ds[0]);
+  for (int i=0; i<numPointsT1; i++)
+    {
+    cellIds[2*pointsT1[i]+1]    = ids[i];
+    datasetIds[2*pointsT1[i]+1] = (ids[i]==-1) ? 0 : ds[i];
+    }
+}
+//---------------------------------------------------------------------------
 void vtkTemporalInterpolatedVelocityField::AdvanceOneTimeStep()
 {
   for (unsigned int i=0; i<this->ivf[0]->CacheList.size(); i++)
@@ -99,6 +99,14 @@ public:
   bool GetCachedCellIds(vtkIdType id[2], int ds[2]);
   void SetCachedCellIds(vtkIdType id[2], int ds[2]);
 
+  // Description:
+  // Find the cells containing numPoints points (three coordinates each) at
+  // both times with a single search, e.g. for the seeds of a particle
+  // tracer. cellIds and datasetIds receive two values per point, as
+  // GetCachedCellIds() does. The cell id is -1 where the point is outside.
+  void FindCachedCellIds(int numPoints, double* x,
+                         vtkIdType* cellIds, int* datasetIds);
+
   // Description:
   // Set the last cell id to -1 so that the next search does not
   // start from the previous cell
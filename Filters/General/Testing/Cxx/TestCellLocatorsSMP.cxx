@@ -0,0 +1,214 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellLocatorsSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkCellLocator and vtkCellTreeLocator give the same answers
+// when queried concurrently through vtkSMPTools (one vtkGenericCell per
+// thread) as when queried serially.
+
+#include "vtkCellLocator.h"
+#include "vtkCellTreeLocator.h"
+#include "vtkGenericCell.h"
+#include "vtkImageData.h"
+#include "vtkImageDataToPointSet.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSphereSource.h"
+#include "vtkStructuredGrid.h"
+
+#include <vector>
+
+namespace
+{
+const int NumberOfQueries = 2000;
+
+void GetQueryPoint(vtkIdType i, double x[3])
+{
+  // deterministic, scattered points covering (and exceeding) [0,10]^3
+  x[0] = -0.5 + 11.0 * ((i * 37) % NumberOfQueries) / NumberOfQueries;
+  x[1] = -0.5 + 11.0 * ((i * 53) % NumberOfQueries) / NumberOfQueries;
+  x[2] = -0.5 + 11.0 * ((i * 71) % NumberOfQueries) / NumberOfQueries;
+}
+
+void GetQueryLine(vtkIdType i, double p1[3], double p2[3])
+{
+  double theta = 2.0 * vtkMath::Pi() * i / NumberOfQueries;
+  double phi = vtkMath::Pi() * ((i * 17) % NumberOfQueries) / NumberOfQueries;
+  p1[0] = p1[1] = p1[2] = 0.0;
+  p2[0] = 2.0 * sin(phi) * cos(theta);
+  p2[1] = 2.0 * sin(phi) * sin(theta);
+  p2[2] = 2.0 * cos(phi);
+}
+
+class FindCellFunctor
+{
+public:
+  vtkAbstractCellLocator* Locator;
+  vtkIdType* Result;
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkGenericCell* cell = this->Cell.Local();
+    double x[3], pcoords[3], weights[8];
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      GetQueryPoint(i, x);
+      this->Result[i] =
+        this->Locator->FindCell(x, 0.0, cell, pcoords, weights);
+      }
+  }
+};
+
+class IntersectFunctor
+{
+public:
+  vtkAbstractCellLocator* Locator;
+  vtkIdType* Result;
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkGenericCell* cell = this->Cell.Local();
+    double p1[3], p2[3], t, x[3], pcoords[3];
+    int subId;
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      GetQueryLine(i, p1, p2);
+      vtkIdType cellId = -1;
+      if (!this->Locator->IntersectWithLine(p1, p2, 0.001, t, x, pcoords,
+                                            subId, cellId, cell))
+        {
+        cellId = -1;
+        }
+      this->Result[i] = cellId;
+      }
+  }
+};
+
+int TestLocator(vtkAbstractCellLocator* locator, vtkDataSet* volume,
+                vtkDataSet* surface, int cacheCellBounds)
+{
+  std::vector<vtkIdType> serial(NumberOfQueries);
+  std::vector<vtkIdType> parallel(NumberOfQueries);
+  vtkNew<vtkGenericCell> cell;
+
+  // FindCell
+  locator->SetDataSet(volume);
+  locator->SetCacheCellBounds(cacheCellBounds);
+  locator->BuildLocator();
+
+  double x[3], pcoords[3], weights[8];
+  int numFound = 0;
+  for (vtkIdType i = 0; i < NumberOfQueries; i++)
+    {
+    GetQueryPoint(i, x);
+    serial[i] = locator->FindCell(x, 0.0, cell.GetPointer(), pcoords, weights);
+    numFound += (serial[i] >= 0);
+    }
+  if (numFound == 0)
+    {
+    cerr << locator->GetClassName() << ": no cell found by FindCell" << endl;
+    return EXIT_FAILURE;
+    }
+
+  FindCellFunctor findCell;
+  findCell.Locator = locator;
+  findCell.Result = &parallel[0];
+  vtkSMPTools::For(0, NumberOfQueries, findCell);
+  if (serial != parallel)
+    {
+    cerr << locator->GetClassName()
+         << ": concurrent FindCell differs from serial FindCell" << endl;
+    return EXIT_FAILURE;
+    }
+
+  // IntersectWithLine
+  locator->SetDataSet(surface);
+  locator->BuildLocator();
+
+  double p1[3], p2[3], t;
+  int subId;
+  for (vtkIdType i = 0; i < NumberOfQueries; i++)
+    {
+    GetQueryLine(i, p1, p2);
+    vtkIdType cellId = -1;
+    if (!locator->IntersectWithLine(p1, p2, 0.001, t, x, pcoords, subId,
+                                    cellId, cell.GetPointer()))
+      {
+      cellId = -1;
+      }
+    if (cellId < 0)
+      {
+      cerr << locator->GetClassName() << ": line " << i
+           << " does not hit the sphere" << endl;
+      return EXIT_FAILURE;
+      }
+    serial[i] = cellId;
+    }
+
+  IntersectFunctor intersect;
+  intersect.Locator = locator;
+  intersect.Result = &parallel[0];
+  vtkSMPTools::For(0, NumberOfQueries, intersect);
+  if (serial != parallel)
+    {
+    cerr << locator->GetClassName() << ": concurrent IntersectWithLine "
+         << "differs from serial IntersectWithLine" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+}
+
+int TestCellLocatorsSMP(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(21, 21, 21);
+  image->SetSpacing(0.5, 0.5, 0.5);
+
+  vtkNew<vtkImageDataToPointSet> toPointSet;
+  toPointSet->SetInputData(image.GetPointer());
+  toPointSet->Update();
+  vtkStructuredGrid* volume = toPointSet->GetOutput();
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(64);
+  sphere->SetPhiResolution(64);
+  sphere->Update();
+  vtkPolyData* surface = sphere->GetOutput();
+
+  int retVal = EXIT_SUCCESS;
+  for (int cache = 0; cache < 2; cache++)
+    {
+    vtkNew<vtkCellLocator> cellLocator;
+    if (TestLocator(cellLocator.GetPointer(), volume, surface, cache) !=
+        EXIT_SUCCESS)
+      {
+      retVal = EXIT_FAILURE;
+      }
+
+    vtkNew<vtkCellTreeLocator> cellTreeLocator;
+    if (TestLocator(cellTreeLocator.GetPointer(), volume, surface, cache) !=
+        EXIT_SUCCESS)
+      {
+      retVal = EXIT_FAILURE;
+      }
+    }
+
+  return retVal;
+}
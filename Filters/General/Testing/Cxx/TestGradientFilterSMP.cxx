@@ -0,0 +1,309 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestGradientFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the gradients, vorticity and Q-criterion computed by
+// vtkGradientFilter for a linear vector field, which all the paths
+// reproduce exactly: on tetrahedra, hexahedra and wedges (which have their
+// own kernels), on voxels (which go through vtkCell::Derivatives()), with
+// and without FasterApproximation, and by finite differences on the points
+// and cells of an image and a structured grid. Also checks that the
+// filter reports its progress.
+
+#include "vtkAppendFilter.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkCommand.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkGradientFilter.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkImageDataToPointSet.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkStructuredGrid.h"
+#include "vtkUnstructuredGrid.h"
+
+namespace
+{
+const double A[3][3] = { {  1.0,  0.5, -0.2 },
+                         { -0.3,  2.0,  0.7 },
+                         {  0.1,  0.4,  0.25 } };
+
+void Velocity(const double x[3], double v[3])
+{
+  for (int i = 0; i < 3; i++)
+    {
+    v[i] = A[i][0] * x[0] + A[i][1] * x[1] + A[i][2] * x[2] + i;
+    }
+}
+
+// Shears the points of a point set, so that the cells are not aligned
+// with the axes.
+void Shear(vtkPointSet* grid)
+{
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(grid->GetNumberOfPoints());
+  double x[3];
+  for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); i++)
+    {
+    grid->GetPoint(i, x);
+    x[0] += 0.3 * x[1];
+    x[2] += 0.2 * x[0];
+    points->SetPoint(i, x);
+    }
+  grid->SetPoints(points.GetPointer());
+}
+
+// Sets the velocity at the points, and at the cell centers (which are the
+// averages of the cell points, as the field is linear).
+void SetVelocity(vtkDataSet* grid)
+{
+  vtkNew<vtkDoubleArray> pointVelocity;
+  pointVelocity->SetName("Velocity");
+  pointVelocity->SetNumberOfComponents(3);
+  pointVelocity->SetNumberOfTuples(grid->GetNumberOfPoints());
+  double x[3], v[3];
+  for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); i++)
+    {
+    grid->GetPoint(i, x);
+    Velocity(x, v);
+    pointVelocity->SetTuple(i, v);
+    }
+  grid->GetPointData()->AddArray(pointVelocity.GetPointer());
+
+  vtkNew<vtkDoubleArray> cellVelocity;
+  cellVelocity->SetName("Velocity");
+  cellVelocity->SetNumberOfComponents(3);
+  cellVelocity->SetNumberOfTuples(grid->GetNumberOfCells());
+  vtkNew<vtkIdList> ptIds;
+  for (vtkIdType i = 0; i < grid->GetNumberOfCells(); i++)
+    {
+    grid->GetCellPoints(i, ptIds.GetPointer());
+    double c[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType j = 0; j < ptIds->GetNumberOfIds(); j++)
+      {
+      grid->GetPoint(ptIds->GetId(j), x);
+      c[0] += x[0] / ptIds->GetNumberOfIds();
+      c[1] += x[1] / ptIds->GetNumberOfIds();
+      c[2] += x[2] / ptIds->GetNumberOfIds();
+      }
+    Velocity(c, v);
+    cellVelocity->SetTuple(i, v);
+    }
+  grid->GetCellData()->AddArray(cellVelocity.GetPointer());
+}
+
+bool Check(vtkDataSetAttributes* data, vtkIdType numTuples, const char* name)
+{
+  vtkDataArray* gradients = data->GetArray("Gradients");
+  vtkDataArray* vorticity = data->GetArray("Vorticity");
+  vtkDataArray* qCriterion = data->GetArray("Q-criterion");
+  if (!gradients || !vorticity || !qCriterion ||
+      gradients->GetNumberOfTuples() != numTuples)
+    {
+    cerr << name << ": missing output arrays" << endl;
+    return false;
+    }
+
+  double expectedVorticity[3] = { A[2][1] - A[1][2], A[0][2] - A[2][0],
+                                  A[1][0] - A[0][1] };
+  double omega = 0.0, strain = 0.0;
+  for (int i = 0; i < 3; i++)
+    {
+    for (int j = 0; j < 3; j++)
+      {
+      omega += 0.25 * (A[i][j] - A[j][i]) * (A[i][j] - A[j][i]);
+      strain += 0.25 * (A[i][j] + A[j][i]) * (A[i][j] + A[j][i]);
+      }
+    }
+  double expectedQ = 0.5 * (omega - strain);
+
+  for (vtkIdType t = 0; t < numTuples; t++)
+    {
+    for (int c = 0; c < 9; c++)
+      {
+      if (fabs(gradients->GetComponent(t, c) - A[c / 3][c % 3]) > 1e-8)
+        {
+        cerr << name << ": wrong gradient " << gradients->GetComponent(t, c)
+             << " instead of " << A[c / 3][c % 3] << " for tuple " << t
+             << endl;
+        return false;
+        }
+      }
+    for (int c = 0; c < 3; c++)
+      {
+      if (fabs(vorticity->GetComponent(t, c) - expectedVorticity[c]) > 1e-8)
+        {
+        cerr << name << ": wrong vorticity for tuple " << t << endl;
+        return false;
+        }
+      }
+    if (fabs(qCriterion->GetComponent(t, 0) - expectedQ) > 1e-8)
+      {
+      cerr << name << ": wrong Q-criterion for tuple " << t << endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// Counts the progress events between 0 and 1.
+class ProgressObserver : public vtkCommand
+{
+public:
+  static ProgressObserver *New() { return new ProgressObserver; }
+
+  virtual void Execute(vtkObject*, unsigned long, void* callData)
+  {
+    double progress = *static_cast<double*>(callData);
+    if (progress > 0.0 && progress < 1.0)
+      {
+      this->NumberOfEvents++;
+      }
+  }
+
+  int NumberOfEvents;
+
+protected:
+  ProgressObserver() : NumberOfEvents(0) {}
+};
+
+int TestGrid(vtkDataSet* grid, const char* name)
+{
+  SetVelocity(grid);
+
+  vtkNew<vtkGradientFilter> gradients;
+  vtkNew<ProgressObserver> observer;
+  gradients->AddObserver(vtkCommand::ProgressEvent, observer.GetPointer());
+  gradients->SetInputData(grid);
+  gradients->SetComputeVorticity(1);
+  gradients->SetComputeQCriterion(1);
+
+  gradients->SetInputScalars(vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                             "Velocity");
+  for (int faster = 0; faster < 2; faster++)
+    {
+    gradients->SetFasterApproximation(faster);
+    gradients->Update();
+    if (!Check(gradients->GetOutput()->GetPointData(),
+               grid->GetNumberOfPoints(), name))
+      {
+      cerr << "Point gradients, FasterApproximation " << faster << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Cell data is only differentiated exactly on structured datasets, as it
+  // is averaged to the points otherwise.
+  if (grid->IsA("vtkImageData") || grid->IsA("vtkStructuredGrid"))
+    {
+    gradients->SetInputScalars(vtkDataObject::FIELD_ASSOCIATION_CELLS,
+                               "Velocity");
+    gradients->Update();
+    if (!Check(gradients->GetOutput()->GetCellData(),
+               grid->GetNumberOfCells(), name))
+      {
+      cerr << "Cell gradients" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  if (observer->NumberOfEvents == 0)
+    {
+    cerr << name << ": no progress reported" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+}
+
+int TestGradientFilterSMP(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(9, 8, 7);
+  image->SetSpacing(1.0, 0.5, 0.75);
+  image->SetOrigin(-1.0, 2.0, 0.5);
+
+  // the voxels of the image, as voxels and as hexahedra and wedges
+  vtkNew<vtkAppendFilter> voxels;
+  voxels->SetInputData(image.GetPointer());
+  voxels->Update();
+  vtkUnstructuredGrid* voxelGrid = voxels->GetOutput();
+
+  int dims[3];
+  image->GetDimensions(dims);
+  vtkNew<vtkUnstructuredGrid> hexGrid;
+  vtkNew<vtkUnstructuredGrid> wedgeGrid;
+  hexGrid->SetPoints(voxelGrid->GetPoints());
+  wedgeGrid->SetPoints(voxelGrid->GetPoints());
+  hexGrid->Allocate(image->GetNumberOfCells());
+  wedgeGrid->Allocate(2 * image->GetNumberOfCells());
+  vtkIdType sliceSize = dims[0] * dims[1];
+  for (int k = 0; k < dims[2] - 1; k++)
+    {
+    for (int j = 0; j < dims[1] - 1; j++)
+      {
+      for (int i = 0; i < dims[0] - 1; i++)
+        {
+        vtkIdType id = i + dims[0] * (j + dims[1] * k);
+        vtkIdType pts[8] = { id, id + 1, id + 1 + dims[0], id + dims[0],
+                             id + sliceSize, id + 1 + sliceSize,
+                             id + 1 + dims[0] + sliceSize,
+                             id + dims[0] + sliceSize };
+        hexGrid->InsertNextCell(VTK_HEXAHEDRON, 8, pts);
+        vtkIdType wedge1[6] = { pts[0], pts[1], pts[3],
+                                pts[4], pts[5], pts[7] };
+        vtkIdType wedge2[6] = { pts[1], pts[2], pts[3],
+                                pts[5], pts[6], pts[7] };
+        wedgeGrid->InsertNextCell(VTK_WEDGE, 6, wedge1);
+        wedgeGrid->InsertNextCell(VTK_WEDGE, 6, wedge2);
+        }
+      }
+    }
+  Shear(hexGrid.GetPointer());
+  Shear(wedgeGrid.GetPointer());
+
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputData(image.GetPointer());
+  tetrahedra->Update();
+  vtkNew<vtkUnstructuredGrid> tetGrid;
+  tetGrid->DeepCopy(tetrahedra->GetOutput());
+  Shear(tetGrid.GetPointer());
+
+  vtkNew<vtkImageDataToPointSet> toPointSet;
+  toPointSet->SetInputData(image.GetPointer());
+  toPointSet->Update();
+  vtkNew<vtkStructuredGrid> structuredGrid;
+  structuredGrid->DeepCopy(toPointSet->GetOutput());
+  Shear(structuredGrid.GetPointer());
+
+  vtkNew<vtkUnstructuredGrid> voxelCopy;
+  voxelCopy->DeepCopy(voxelGrid);
+
+  if (TestGrid(tetGrid.GetPointer(), "Tetrahedra") != EXIT_SUCCESS ||
+      TestGrid(hexGrid.GetPointer(), "Hexahedra") != EXIT_SUCCESS ||
+      TestGrid(wedgeGrid.GetPointer(), "Wedges") != EXIT_SUCCESS ||
+      TestGrid(voxelCopy.GetPointer(), "Voxels") != EXIT_SUCCESS ||
+      TestGrid(image.GetPointer(), "Image") != EXIT_SUCCESS ||
+      TestGrid(structuredGrid.GetPointer(), "StructuredGrid") != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
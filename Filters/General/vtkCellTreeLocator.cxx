@@ -29,6 +29,8 @@
 #include "vtkPolyData.h"
 #include "vtkBoundingBox.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 
 vtkStandardNewMacro(vtkCellTreeLocator);
 
@@ -226,6 +228,49 @@ class vtkCellTreeBuilder
       unsigned int Ind;
       };
 
+    // Fills the per-cell bounds in parallel and accumulates the bounds of
+    // the whole dataset per thread.
+    struct InitializeCells
+      {
+      vtkDataSet* DataSet;
+      double (*CellBounds)[6];
+      PerCell* PC;
+      vtkSMPThreadLocal<vtkBoundingBox> BBox;
+
+      InitializeCells( vtkDataSet* ds, double (*cellBounds)[6], PerCell* pc ) :
+        DataSet(ds), CellBounds(cellBounds), PC(pc) {}
+
+      void operator()( vtkIdType begin, vtkIdType end )
+        {
+        double cellBounds[6];
+        vtkBoundingBox& bbox = this->BBox.Local();
+        for( vtkIdType i=begin; i<end; ++i )
+          {
+          PerCell& pc = this->PC[i];
+          pc.Ind = i;
+
+          double *boundsPtr = cellBounds;
+          if (this->CellBounds)
+            {
+            boundsPtr = this->CellBounds[i];
+            }
+          else
+            {
+            this->DataSet->GetCellBounds(i, boundsPtr);
+            }
+
+          for( int d=0; d<3; ++d )
+            {
+            pc.Min[d] = boundsPtr[2*d+0];
+            pc.Max[d] = boundsPtr[2*d+1];
+            }
+          // accumulate the single precision values used by the tree
+          bbox.AddPoint( pc.Min[0], pc.Min[1], pc.Min[2] );
+          bbox.AddPoint( pc.Max[0], pc.Max[1], pc.Max[2] );
+          }
+        }
+      };
+
     struct CenterOrder
       {
       unsigned int d;
@@ -451,52 +496,28 @@ class vtkCellTreeBuilder
         {
         vtkGenericWarningMacro("Too many cells.");
         }
-      double cellBounds[6];
       this->m_pc.resize(size);
 
-      float min[3] =
-        {
-        std::numeric_limits<float>::max(),
-        std::numeric_limits<float>::max(),
-        std::numeric_limits<float>::max()
-        };
+      // vtkDataSet::GetCellBounds() is only thread safe once it has been
+      // called from a single thread.
+      double cellBounds[6];
+      ds->GetCellBounds(0, cellBounds);
 
-      float max[3] =
-        {
-        -std::numeric_limits<float>::max(),
-        -std::numeric_limits<float>::max(),
-        -std::numeric_limits<float>::max(),
-        };
+      InitializeCells initializer( ds, ctl->CellBounds, &this->m_pc[0] );
+      vtkSMPTools::For( 0, size, initializer );
 
-      for( vtkIdType i=0; i<size; ++i )
+      vtkBoundingBox bbox;
+      vtkSMPThreadLocal<vtkBoundingBox>::iterator iter;
+      for( iter = initializer.BBox.begin(); iter != initializer.BBox.end(); ++iter )
         {
-        this->m_pc[i].Ind = i;
-
-        double *boundsPtr = cellBounds;
-        if (ctl->CellBounds)
-          {
-          boundsPtr = ctl->CellBounds[i];
-          }
-        else
-          {
-          ds->GetCellBounds(i, boundsPtr);
-          }
-
-        for( int d=0; d<3; ++d )
-          {
-          this->m_pc[i].Min[d] = boundsPtr[2*d+0];
-          this->m_pc[i].Max[d] = boundsPtr[2*d+1];
-
-          if( this->m_pc[i].Min[d] < min[d] )
-            {
-            min[d] = this->m_pc[i].Min[d];
-            }
+        bbox.AddBox( *iter );
+        }
 
-          if( this->m_pc[i].Max[d] > max[d] )  /// This can be m_pc[i].max[d] instead of min
-            {
-            max[d] = this->m_pc[i].Max[d];
-            }
-          }
+      float min[3], max[3];
+      for( int d=0; d<3; ++d )
+        {
+        min[d] = static_cast<float>( bbox.GetMinPoint()[d] );
+        max[d] = static_cast<float>( bbox.GetMaxPoint()[d] );
         }
 
       ct.DataBBox[0] = min[0];
@@ -707,6 +728,14 @@ namespace
 }
 typedef std::pair<double, int> Intersection;
 
+int vtkCellTreeLocator::IntersectWithLine(double p1[3], double p2[3], double tol,
+  double& t, double x[3], double pcoords[3],
+  int &subId, vtkIdType &cellId)
+{
+  return this->IntersectWithLine(p1, p2, tol, t, x, pcoords, subId, cellId,
+                                 this->GenericCell);
+}
+
 int vtkCellTreeLocator::IntersectWithLine(double p1[3],
                                           double p2[3],
                                           double tol,
@@ -714,20 +743,8 @@ int vtkCellTreeLocator::IntersectWithLine(double p1[3],
                                           double x[3],
                                           double pcoords[3],
                                           int &subId,
-                                          vtkIdType &cellId,
+                                          vtkIdType &cellIds,
                                           vtkGenericCell *cell)
-{
-  int hit = this->IntersectWithLine(p1, p2, tol, t, x, pcoords, subId, cellId);
-  if (hit)
-    {
-    this->DataSet->GetCell(cellId, cell);
-    }
-  return hit;
-}
-
-int vtkCellTreeLocator::IntersectWithLine(double p1[3], double p2[3], double tol,
-  double& t, double x[3], double pcoords[3],
-  int &subId, vtkIdType &cellIds)
 {
   //
   vtkCellTreeNode  *node, *near, *far;
@@ -840,7 +857,7 @@ int vtkCellTreeLocator::IntersectWithLine(double p1[3], double p2[3], double tol
       ctmin = _tmin; ctmax = _tmax;
       if (this->RayMinMaxT(boundsPtr, p1, ray_vec, ctmin, ctmax))
         {
-        if (this->IntersectCellInternal(cell_ID, p1, p2, tol, t_hit, ipt, pcoords, subId))
+        if (this->IntersectCellInternal(cell_ID, p1, p2, tol, t_hit, ipt, pcoords, subId, cell))
           {
           if (t_hit<closest_intersection)
             {
@@ -861,6 +878,8 @@ int vtkCellTreeLocator::IntersectWithLine(double p1[3], double p2[3], double tol
   if (HIT)
     {
     t = closest_intersection;
+    // the cell may have been overwritten by later candidates
+    this->DataSet->GetCell(cellIds, cell);
     }
   //
   return HIT;
@@ -1257,8 +1276,23 @@ int vtkCellTreeLocator::IntersectCellInternal(
   double pcoords[3],
   int &subId)
 {
-  this->DataSet->GetCell(cell_ID, this->GenericCell);
-  return this->GenericCell->IntersectWithLine(const_cast<double*>(p1), const_cast<double*>(p2), tol, t, ipt, pcoords, subId);
+  return this->IntersectCellInternal(cell_ID, p1, p2, tol, t, ipt, pcoords,
+                                     subId, this->GenericCell);
+}
+//----------------------------------------------------------------------------
+int vtkCellTreeLocator::IntersectCellInternal(
+  vtkIdType cell_ID,
+  const double p1[3],
+  const double p2[3],
+  const double tol,
+  double &t,
+  double ipt[3],
+  double pcoords[3],
+  int &subId,
+  vtkGenericCell *cell)
+{
+  this->DataSet->GetCell(cell_ID, cell);
+  return cell->IntersectWithLine(const_cast<double*>(p1), const_cast<double*>(p2), tol, t, ipt, pcoords, subId);
 }
 //----------------------------------------------------------------------------
 void vtkCellTreeLocator::FreeSearchStructure(void)
@@ -60,13 +60,18 @@ class VTKFILTERSGENERAL_EXPORT vtkCellTreeLocator : public vtkAbstractCellLocato
 
      // Description:
     // Test a point to find if it is inside a cell. Returns the cellId if inside
-    // or -1 if not.
+    // or -1 if not. Only the supplied cell and weights are written to, so
+    // once the locator is built several threads may query it concurrently,
+    // each with its own cell and weights.
     virtual vtkIdType FindCell(double pos[3], double vtkNotUsed, vtkGenericCell *cell,  double pcoords[3],
                                        double* weights );
 
     // Description:
     // Return intersection point (if any) AND the cell which was intersected by
     // the finite line. The cell is returned as a cell id and as a generic cell.
+    // The supplied cell is also used as scratch space during the traversal,
+    // which makes this signature safe to call concurrently (one cell per
+    // thread) once the locator is built.
     virtual int IntersectWithLine(double a0[3], double a1[3], double tol,
                                       double& t, double x[3], double pcoords[3],
                                       int &subId, vtkIdType &cellId,
@@ -225,6 +230,18 @@ protected:
     double pcoords[3],
     int &subId);
 
+  // Description:
+  // Same as above but uses the supplied cell rather than the locator's
+  // internal one. This is the version invoked by IntersectWithLine.
+  virtual int IntersectCellInternal( vtkIdType cell_ID,  const double p1[3],
+    const double p2[3],
+    const double tol,
+    double &t,
+    double ipt[3],
+    double pcoords[3],
+    int &subId,
+    vtkGenericCell *cell);
+
 
     int NumberOfBuckets;
 
@@ -25,6 +25,8 @@
 #include "vtkCellDataToPointData.h"
 #include "vtkDataArray.h"
 #include "vtkDataSet.h"
+#include "vtkGenericCell.h"
+#include "vtkHexahedron.h"
 #include "vtkIdList.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
@@ -33,11 +35,17 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkPoints.h"
 #include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGrid.h"
+#include "vtkTetra.h"
 #include "vtkUnstructuredGrid.h"
+#include "vtkWedge.h"
 
 #include <vector>
 
@@ -73,24 +81,39 @@ namespace
     qCriterion[0] = (t1 - t2) / 2;
   }
 
+  // Runs the functor over the range [0, n) in chunks, updating the progress
+  // of the filter and checking for an abort between the chunks.
+  template<class Functor>
+  void vtkGradientFilterFor(vtkAlgorithm *self, vtkIdType n, Functor &functor)
+  {
+    vtkIdType chunk = n/20 + 1;
+    for (vtkIdType begin = 0; begin < n && !self->GetAbortExecute();
+         begin += chunk)
+      {
+      self->UpdateProgress(static_cast<double>(begin)/n);
+      vtkSMPTools::For(begin, (n - begin > chunk ? begin + chunk : n), functor);
+      }
+  }
+
   // Functions for unstructured grids and polydatas
   template<class data_type>
   void ComputePointGradientsUG(
-    vtkDataSet *structure, data_type *array, data_type *gradients,
+    vtkAlgorithm *self, vtkDataSet *structure, data_type *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion);
 
   int GetCellParametricData(
     vtkIdType pointId, double pointCoord[3], vtkCell *cell, int & subId,
-    double parametricCoord[3]);
+    double parametricCoord[3], std::vector<double> &weights);
 
   template<class data_type>
   void ComputeCellGradientsUG(
-    vtkDataSet *structure, data_type *array, data_type *gradients,
+    vtkAlgorithm *self, vtkDataSet *structure, data_type *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion);
 
   // Functions for image data and structured grids
   template<class Grid, class data_type>
-  void ComputeGradientsSG(Grid output, data_type* array, data_type* gradients,
+  void ComputeGradientsSG(vtkAlgorithm *self, Grid output,
+                          data_type* array, data_type* gradients,
                           int numberOfInputComponents, int fieldAssociation,
                           data_type* vorticity, data_type* qCriterion);
 
@@ -109,9 +132,11 @@ namespace
   }
 
   // generic way to get the coordinate for either a cell (using
-  // the parametric center) or a point
+  // the parametric center) or a point. The cells of the structured
+  // datasets it is used for have at most 8 points.
   void GetGridEntityCoordinate(vtkDataSet* grid, int fieldAssociation,
-                               vtkIdType index, double coords[3])
+                               vtkIdType index, vtkGenericCell* cell,
+                               double coords[3])
   {
     if(fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS)
       {
@@ -119,11 +144,10 @@ namespace
       }
     else
       {
-      vtkCell* cell = grid->GetCell(index);
-      double pcoords[3];
+      grid->GetCell(index, cell);
+      double pcoords[3], weights[8];
       int subId = cell->GetParametricCenter(pcoords);
-      std::vector<double> weights(cell->GetNumberOfPoints()+1);
-      cell->EvaluateLocation(subId, pcoords, coords, &weights[0]);
+      cell->EvaluateLocation(subId, pcoords, coords, weights);
       }
   }
 } // end anonymous namespace
@@ -383,7 +407,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
       switch (array->GetDataType())
         {
         vtkTemplateMacro(ComputePointGradientsUG(
-                           input,
+                           this, input,
                            static_cast<VTK_TT *>(array->GetVoidPointer(0)),
                            static_cast<VTK_TT *>(gradients->GetVoidPointer(0)),
                            numberOfInputComponents,
@@ -413,12 +437,21 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
       cellGradients->SetName(gradients->GetName());
       cellGradients->SetNumberOfComponents(3*array->GetNumberOfComponents());
       cellGradients->SetNumberOfTuples(input->GetNumberOfCells());
+      // vorticity and Q-criterion are also computed on the cells first
+      if(vorticity)
+        {
+        vorticity->SetNumberOfTuples(input->GetNumberOfCells());
+        }
+      if(qCriterion)
+        {
+        qCriterion->SetNumberOfTuples(input->GetNumberOfCells());
+        }
 
       switch (array->GetDataType())
         {
         vtkTemplateMacro(
           ComputeCellGradientsUG(
-            input, static_cast<VTK_TT *>(array->GetVoidPointer(0)),
+            this, input, static_cast<VTK_TT *>(array->GetVoidPointer(0)),
             static_cast<VTK_TT *>(cellGradients->GetVoidPointer(0)),
             numberOfInputComponents,
             (vorticity == NULL ? NULL :
@@ -449,9 +482,15 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
       vtkDataArray *pointGradients
         = cd2pd->GetOutput()->GetPointData()->GetArray(gradients->GetName());
       output->GetPointData()->AddArray(pointGradients);
+      if(vorticity)
+        {
+        output->GetPointData()->AddArray(
+          cd2pd->GetOutput()->GetPointData()->GetArray(vorticity->GetName()));
+        }
       if(qCriterion)
         {
-        output->GetPointData()->AddArray(qCriterion);
+        output->GetPointData()->AddArray(
+          cd2pd->GetOutput()->GetPointData()->GetArray(qCriterion->GetName()));
         }
       cd2pd->Delete();
       dummy->Delete();
@@ -478,7 +517,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
     switch (pointScalars->GetDataType())
       {
       vtkTemplateMacro(ComputeCellGradientsUG(
-                         input,
+                         this, input,
                          static_cast<VTK_TT *>(pointScalars->GetVoidPointer(0)),
                          static_cast<VTK_TT *>(gradients->GetVoidPointer(0)),
                          numberOfInputComponents,
@@ -558,7 +597,7 @@ int vtkGradientFilter::ComputeRegularGridGradient(
     switch (array->GetDataType())
       {
       vtkTemplateMacro(ComputeGradientsSG(
-                         structuredGrid,
+                         this, structuredGrid,
                          static_cast<VTK_TT *>(array->GetVoidPointer(0)),
                          static_cast<VTK_TT *>(gradients->GetVoidPointer(0)),
                          numberOfInputComponents, fieldAssociation,
@@ -573,7 +612,7 @@ int vtkGradientFilter::ComputeRegularGridGradient(
     switch (array->GetDataType())
       {
       vtkTemplateMacro(ComputeGradientsSG(
-                         imageData,
+                         this, imageData,
                          static_cast<VTK_TT *>(array->GetVoidPointer(0)),
                          static_cast<VTK_TT *>(gradients->GetVoidPointer(0)),
                          numberOfInputComponents, fieldAssociation,
@@ -588,7 +627,7 @@ int vtkGradientFilter::ComputeRegularGridGradient(
     switch (array->GetDataType())
       {
       vtkTemplateMacro(ComputeGradientsSG(
-                         rectilinearGrid,
+                         this, rectilinearGrid,
                          static_cast<VTK_TT *>(array->GetVoidPointer(0)),
                          static_cast<VTK_TT *>(gradients->GetVoidPointer(0)),
                          numberOfInputComponents, fieldAssociation,
@@ -633,107 +672,253 @@ int vtkGradientFilter::ComputeRegularGridGradient(
 
 namespace {
 //-----------------------------------------------------------------------------
-  template<class data_type>
-  void ComputePointGradientsUG(
-    vtkDataSet *structure, data_type *array, data_type *gradients,
-    int numberOfInputComponents, data_type* vorticity, data_type* qCriterion)
+  // Derivatives of all the components of a linear cell at pcoords, computed
+  // as TCell::Derivatives() does but with the Jacobian inverted once for all
+  // the components. derivs holds 3*numberOfInputComponents values, which are
+  // zero if the cell is degenerate.
+  template<class TCell, int NumberOfCellPoints, class data_type>
+  void ComputeLinearCellDerivatives(
+    vtkCell *cell, double pcoords[3], data_type *array,
+    int numberOfInputComponents, double *derivs)
   {
-    vtkIdList* currentPoint = vtkIdList::New();
-    currentPoint->SetNumberOfIds(1);
-    vtkIdList* cellsOnPoint = vtkIdList::New();
+    double functionDerivs[3*NumberOfCellPoints];
+    TCell::InterpolationDerivs(pcoords, functionDerivs);
+
+    double *m[3], m0[3], m1[3], m2[3], x[3];
+    m[0] = m0; m[1] = m1; m[2] = m2;
+    for (int i = 0; i < 3; i++)
+      {
+      m0[i] = m1[i] = m2[i] = 0.0;
+      }
+    vtkPoints *points = cell->GetPoints();
+    for (int j = 0; j < NumberOfCellPoints; j++)
+      {
+      points->GetPoint(j, x);
+      for (int i = 0; i < 3; i++)
+        {
+        m0[i] += x[i] * functionDerivs[j];
+        m1[i] += x[i] * functionDerivs[NumberOfCellPoints + j];
+        m2[i] += x[i] * functionDerivs[2*NumberOfCellPoints + j];
+        }
+      }
 
-    vtkIdType numpts = structure->GetNumberOfPoints();
-    std::vector<data_type> g(3*numberOfInputComponents);
+    double *jI[3], j0[3], j1[3], j2[3];
+    jI[0] = j0; jI[1] = j1; jI[2] = j2;
+    int tmp1[3];
+    double tmp2[3];
+    if (vtkMath::InvertMatrix(m, jI, 3, tmp1, tmp2) == 0)
+      {
+      for (int i = 0; i < 3*numberOfInputComponents; i++)
+        {
+        derivs[i] = 0.0;
+        }
+      return;
+      }
+
+    vtkIdType pointIds[NumberOfCellPoints];
+    for (int i = 0; i < NumberOfCellPoints; i++)
+      {
+      pointIds[i] = cell->GetPointId(i)*numberOfInputComponents;
+      }
+    for (int k = 0; k < numberOfInputComponents; k++)
+      {
+      double sum[3] = {0.0, 0.0, 0.0};
+      for (int i = 0; i < NumberOfCellPoints; i++)
+        {
+        double value = static_cast<double>(array[pointIds[i] + k]);
+        sum[0] += functionDerivs[i] * value;
+        sum[1] += functionDerivs[NumberOfCellPoints + i] * value;
+        sum[2] += functionDerivs[2*NumberOfCellPoints + i] * value;
+        }
+      for (int j = 0; j < 3; j++)
+        {
+        derivs[3*k + j] = sum[0]*jI[j][0] + sum[1]*jI[j][1] + sum[2]*jI[j][2];
+        }
+      }
+  }
 
-    int numberOfOutputComponents = 3*numberOfInputComponents;
+//-----------------------------------------------------------------------------
+  // Derivatives of all the components of the cell at pcoords. Linear
+  // tetrahedra, hexahedra and wedges are handled without virtual calls,
+  // other cells through vtkCell::Derivatives(). values is scratch space.
+  template<class data_type>
+  void ComputeCellDerivatives(
+    vtkCell *cell, int subId, double pcoords[3], data_type *array,
+    int numberOfInputComponents, std::vector<double> &values, double *derivs)
+  {
+    switch (cell->GetCellType())
+      {
+      case VTK_TETRA:
+        ComputeLinearCellDerivatives<vtkTetra, 4>(
+          cell, pcoords, array, numberOfInputComponents, derivs);
+        return;
+      case VTK_HEXAHEDRON:
+        ComputeLinearCellDerivatives<vtkHexahedron, 8>(
+          cell, pcoords, array, numberOfInputComponents, derivs);
+        return;
+      case VTK_WEDGE:
+        ComputeLinearCellDerivatives<vtkWedge, 6>(
+          cell, pcoords, array, numberOfInputComponents, derivs);
+        return;
+      }
 
-    for (vtkIdType point = 0; point < numpts; point++)
+    int numberOfCellPoints = cell->GetNumberOfPoints();
+    values.resize(numberOfCellPoints*numberOfInputComponents);
+    for (int i = 0; i < numberOfCellPoints; i++)
       {
-      currentPoint->SetId(0, point);
-      double pointcoords[3];
-      structure->GetPoint(point, pointcoords);
-      // Get all cells touching this point.
-      structure->GetCellNeighbors(-1, currentPoint, cellsOnPoint);
-      vtkIdType numCellNeighbors = cellsOnPoint->GetNumberOfIds();
-      vtkIdType numValidCellNeighbors = 0;
-
-      for(int i=0;i<numberOfInputComponents*3;i++)
+      data_type *tuple = array + cell->GetPointId(i)*numberOfInputComponents;
+      for (int k = 0; k < numberOfInputComponents; k++)
         {
-        g[i] = 0;
+        values[i*numberOfInputComponents + k] = static_cast<double>(tuple[k]);
         }
+      }
+    cell->Derivatives(subId, pcoords, &values[0], numberOfInputComponents,
+                      derivs);
+  }
 
-      // Iterate on all cells and find all points connected to current point
-      // by an edge.
-      for (vtkIdType neighbor = 0; neighbor < numCellNeighbors; neighbor++)
+//-----------------------------------------------------------------------------
+  // Averages, at each point, the derivatives of the cells using the point.
+  template<class data_type>
+  class PointGradientsUG
+  {
+  public:
+    vtkDataSet *Structure;
+    data_type *Array;
+    data_type *Gradients;
+    int NumberOfInputComponents;
+    data_type *Vorticity;
+    data_type *QCriterion;
+
+    vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+    vtkSMPThreadLocalObject<vtkIdList> CellsOnPoint;
+    vtkSMPThreadLocal<std::vector<double> > Values;
+    vtkSMPThreadLocal<std::vector<double> > Derivatives;
+    vtkSMPThreadLocal<std::vector<data_type> > G;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      vtkGenericCell *cell = this->Cell.Local();
+      vtkIdList *cellsOnPoint = this->CellsOnPoint.Local();
+      std::vector<double> &values = this->Values.Local();
+      std::vector<double> &derivative = this->Derivatives.Local();
+      std::vector<data_type> &g = this->G.Local();
+
+      int numberOfOutputComponents = 3*this->NumberOfInputComponents;
+      derivative.resize(numberOfOutputComponents);
+      g.resize(numberOfOutputComponents);
+
+      for (vtkIdType point = begin; point < end; point++)
         {
-        vtkCell *cell = structure->GetCell(cellsOnPoint->GetId(neighbor));
-        int subId;
-        double parametricCoord[3];
-        if(GetCellParametricData(point, pointcoords, cell,
-                                 subId, parametricCoord))
+        double pointcoords[3];
+        this->Structure->GetPoint(point, pointcoords);
+        // Get all cells touching this point.
+        this->Structure->GetPointCells(point, cellsOnPoint);
+        vtkIdType numCellNeighbors = cellsOnPoint->GetNumberOfIds();
+
+        for(int i=0;i<numberOfOutputComponents;i++)
           {
-          numValidCellNeighbors++;
-          for(int InputComponent=0;InputComponent<numberOfInputComponents;InputComponent++)
+          g[i] = 0;
+          }
+
+        for (vtkIdType neighbor = 0; neighbor < numCellNeighbors; neighbor++)
+          {
+          this->Structure->GetCell(cellsOnPoint->GetId(neighbor), cell);
+          int subId;
+          double parametricCoord[3];
+          if(GetCellParametricData(point, pointcoords, cell,
+                                   subId, parametricCoord, values))
             {
-            int NumberOfCellPoints = cell->GetNumberOfPoints();
-            std::vector<double> values(NumberOfCellPoints);
-            // Get values of Array at cell points.
-            for (int i = 0; i < NumberOfCellPoints; i++)
+            // Get derivative of cell at point.
+            ComputeCellDerivatives(cell, subId, parametricCoord, this->Array,
+                                   this->NumberOfInputComponents, values,
+                                   &derivative[0]);
+            for(int i=0;i<numberOfOutputComponents;i++)
               {
-              values[i] = static_cast<double>(
-                array[cell->GetPointId(i)*numberOfInputComponents+InputComponent]);
+              g[i] += static_cast<data_type>(derivative[i]);
               }
+            } // if(GetCellParametricData())
+          } // iterating over neighbors
 
-            double derivative[3];
-            // Get derivative of cell at point.
-            cell->Derivatives(subId, parametricCoord, &values[0], 1, derivative);
-
-            g[InputComponent*3] += static_cast<data_type>(derivative[0]);
-            g[InputComponent*3+1] += static_cast<data_type>(derivative[1]);
-            g[InputComponent*3+2] += static_cast<data_type>(derivative[2]);
-            } // iterating over Components
-          } // if(GetCellParametricData())
-        } // iterating over neighbors
+        if (numCellNeighbors > 0)
+          {
+          for(int i=0;i<numberOfOutputComponents;i++)
+            {
+            g[i] /= numCellNeighbors;
+            }
+          }
 
-      if (numCellNeighbors > 0)
-        {
-        for(int i=0;i<3*numberOfInputComponents;i++)
+        if(this->Vorticity)
           {
-          g[i] /= numCellNeighbors;
+          ComputeVorticityFromGradient(&g[0], this->Vorticity+3*point);
           }
-        }
+        if(this->QCriterion)
+          {
+          ComputeQCriterionFromGradient(&g[0], this->QCriterion+point);
+          }
+        for(int i=0;i<numberOfOutputComponents;i++)
+          {
+          this->Gradients[point*numberOfOutputComponents+i] = g[i];
+          }
+        }  // iterating over points in grid
+    }
+  };
 
-      if(vorticity)
-        {
-        ComputeVorticityFromGradient(&g[0], vorticity+3*point);
-        }
-      if(qCriterion)
-        {
-        ComputeQCriterionFromGradient(&g[0], qCriterion+point);
-        }
-      for(int i=0;i<numberOfOutputComponents;i++)
-        {
-        gradients[point*numberOfOutputComponents+i] = g[i];
-        }
-      }  // iterating over points in grid
+//-----------------------------------------------------------------------------
+  // GetCell(vtkIdType, vtkGenericCell*) and GetPointCells() are only thread
+  // safe once they have been called from a single thread, which builds the
+  // cells and links of the dataset.
+  void PrepareForThreading(vtkDataSet *structure)
+  {
+    if (structure->GetNumberOfCells() > 0)
+      {
+      vtkGenericCell *cell = vtkGenericCell::New();
+      structure->GetCell(0, cell);
+      cell->Delete();
+      }
+    if (structure->GetNumberOfPoints() > 0)
+      {
+      double x[3];
+      structure->GetPoint(0, x);
+      vtkIdList *cells = vtkIdList::New();
+      structure->GetPointCells(0, cells);
+      cells->Delete();
+      }
+  }
 
-    currentPoint->Delete();
-    cellsOnPoint->Delete();
+//-----------------------------------------------------------------------------
+  template<class data_type>
+  void ComputePointGradientsUG(
+    vtkAlgorithm *self, vtkDataSet *structure, data_type *array, data_type *gradients,
+    int numberOfInputComponents, data_type* vorticity, data_type* qCriterion)
+  {
+    PrepareForThreading(structure);
+
+    PointGradientsUG<data_type> functor;
+    functor.Structure = structure;
+    functor.Array = array;
+    functor.Gradients = gradients;
+    functor.NumberOfInputComponents = numberOfInputComponents;
+    functor.Vorticity = vorticity;
+    functor.QCriterion = qCriterion;
+    vtkGradientFilterFor(self, structure->GetNumberOfPoints(), functor);
   }
 
 //-----------------------------------------------------------------------------
   int GetCellParametricData(vtkIdType pointId, double pointCoord[3],
-                            vtkCell *cell, int &subId, double parametricCoord[3])
+                            vtkCell *cell, int &subId, double parametricCoord[3],
+                            std::vector<double> &weights)
   {
     // Watch out for degenerate cells.  They make the derivative calculation
     // fail.
     vtkIdList *pointIds = cell->GetPointIds();
     int timesPointRegistered = 0;
+    int cellPointId = -1;
     for (int i = 0; i < pointIds->GetNumberOfIds(); i++)
       {
       if (pointId == pointIds->GetId(i))
         {
         timesPointRegistered++;
+        cellPointId = i;
         }
       }
     if (timesPointRegistered != 1)
@@ -742,104 +927,152 @@ namespace {
       return 0;
       }
 
+    // The parametric coordinates of the vertices of linear cells are known.
+    int cellType = cell->GetCellType();
+    if (cellType == VTK_TETRA || cellType == VTK_HEXAHEDRON ||
+        cellType == VTK_WEDGE)
+      {
+      double *pcoords = cell->GetParametricCoords() + 3*cellPointId;
+      parametricCoord[0] = pcoords[0];
+      parametricCoord[1] = pcoords[1];
+      parametricCoord[2] = pcoords[2];
+      subId = 0;
+      return 1;
+      }
+
     double dummy;
-    int numpoints = cell->GetNumberOfPoints();
-    std::vector<double> values(numpoints);
+    weights.resize(cell->GetNumberOfPoints());
     // Get parametric position of point.
     cell->EvaluatePosition(pointCoord, NULL, subId, parametricCoord,
-                           dummy, &values[0]/*Really another dummy.*/);
+                           dummy, &weights[0]);
 
     return 1;
   }
 
 //-----------------------------------------------------------------------------
+  // Computes the derivatives of each cell at its parametric center.
   template<class data_type>
-    void ComputeCellGradientsUG(
-      vtkDataSet *structure, data_type *array, data_type *gradients,
-      int numberOfInputComponents, data_type* vorticity, data_type* qCriterion)
+  class CellGradientsUG
   {
-    vtkIdType numcells = structure->GetNumberOfCells();
-    std::vector<double> values(8);
-    for (vtkIdType cellid = 0; cellid < numcells; cellid++)
-      {
-      vtkCell *cell = structure->GetCell(cellid);
+  public:
+    vtkDataSet *Structure;
+    data_type *Array;
+    data_type *Gradients;
+    int NumberOfInputComponents;
+    data_type *Vorticity;
+    data_type *QCriterion;
+
+    vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+    vtkSMPThreadLocal<std::vector<double> > Values;
+    vtkSMPThreadLocal<std::vector<double> > Derivatives;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      vtkGenericCell *cell = this->Cell.Local();
+      std::vector<double> &values = this->Values.Local();
+      std::vector<double> &derivative = this->Derivatives.Local();
 
-      int subId;
-      double cellCenter[3];
-      subId = cell->GetParametricCenter(cellCenter);
+      int numberOfOutputComponents = 3*this->NumberOfInputComponents;
+      derivative.resize(numberOfOutputComponents);
 
-      int numpoints = cell->GetNumberOfPoints();
-      if(static_cast<size_t>(numpoints) > values.size())
+      for (vtkIdType cellid = begin; cellid < end; cellid++)
         {
-        values.resize(numpoints);
-        }
-      double derivative[3];
-      for(int inputComponent=0;inputComponent<numberOfInputComponents;
-          inputComponent++)
-        {
-        for (int i = 0; i < numpoints; i++)
+        this->Structure->GetCell(cellid, cell);
+
+        double cellCenter[3];
+        int subId = cell->GetParametricCenter(cellCenter);
+
+        ComputeCellDerivatives(cell, subId, cellCenter, this->Array,
+                               this->NumberOfInputComponents, values,
+                               &derivative[0]);
+        data_type *gradients =
+          this->Gradients + cellid*numberOfOutputComponents;
+        for(int i=0;i<numberOfOutputComponents;i++)
           {
-          values[i] = static_cast<double>(
-            array[cell->GetPointId(i)*numberOfInputComponents+inputComponent]);
+          gradients[i] = static_cast<data_type>(derivative[i]);
+          }
+        if(this->Vorticity)
+          {
+          ComputeVorticityFromGradient(gradients, this->Vorticity+3*cellid);
+          }
+        if(this->QCriterion)
+          {
+          ComputeQCriterionFromGradient(gradients, this->QCriterion+cellid);
           }
-
-        cell->Derivatives(subId, cellCenter, &values[0], 1, derivative);
-        gradients[cellid*3*numberOfInputComponents+inputComponent*3] =
-          static_cast<data_type>(derivative[0]);
-        gradients[cellid*3*numberOfInputComponents+inputComponent*3+1] =
-          static_cast<data_type>(derivative[1]);
-        gradients[cellid*3*numberOfInputComponents+inputComponent*3+2] =
-          static_cast<data_type>(derivative[2]);
-        }
-      if(vorticity)
-        {
-        ComputeVorticityFromGradient(gradients+3*cellid*numberOfInputComponents, vorticity+3*cellid);
-        }
-      if(qCriterion)
-        {
-        ComputeQCriterionFromGradient(gradients+3*cellid*numberOfInputComponents, qCriterion+cellid);
         }
-      }
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  template<class data_type>
+    void ComputeCellGradientsUG(
+      vtkAlgorithm *self, vtkDataSet *structure, data_type *array, data_type *gradients,
+      int numberOfInputComponents, data_type* vorticity, data_type* qCriterion)
+  {
+    PrepareForThreading(structure);
+
+    CellGradientsUG<data_type> functor;
+    functor.Structure = structure;
+    functor.Array = array;
+    functor.Gradients = gradients;
+    functor.NumberOfInputComponents = numberOfInputComponents;
+    functor.Vorticity = vorticity;
+    functor.QCriterion = qCriterion;
+    vtkGradientFilterFor(self, structure->GetNumberOfCells(), functor);
   }
 
 //-----------------------------------------------------------------------------
+  // Finite differences on the rows (lines of constant j and k) of a
+  // structured dataset.
   template<class Grid, class data_type>
-  void ComputeGradientsSG(Grid output, data_type* array, data_type* gradients,
-                          int numberOfInputComponents, int fieldAssociation,
-                          data_type* vorticity, data_type* qCriterion)
+  class GradientsSG
   {
-    int i, j, k, idx, idx2, ii, inputComponent;
-    double xp[3], xm[3], factor;
-    xp[0] = xp[1] = xp[2] = xm[0] = xm[1] = xm[2] = factor = 0;
-    double xxi, yxi, zxi, xeta, yeta, zeta, xzeta, yzeta, zzeta;
-    xxi = yxi = zxi = xeta = yeta = zeta = xzeta = yzeta = zzeta = 0;
-    double aj, xix, xiy, xiz, etax, etay, etaz, zetax, zetay, zetaz;
-    aj = xix = xiy = xiz = etax = etay = etaz = zetax = zetay = zetaz = 0;
-    // for finite differencing -- the values on the "plus" side and
-    // "minus" side of the point to be computed at
-    std::vector<double> plusvalues(numberOfInputComponents);
-    std::vector<double> minusvalues(numberOfInputComponents);
-
-    std::vector<double> dValuesdXi(numberOfInputComponents);
-    std::vector<double> dValuesdEta(numberOfInputComponents);
-    std::vector<double> dValuesdZeta(numberOfInputComponents);
-
-    int dims[3];
-    output->GetDimensions(dims);
-    if(fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_CELLS)
-      {
-      // reduce the dimensions by 1 for cells
-      for(i=0;i<3;i++)
-        {
-        dims[i]--;
-        }
-      }
-    int ijsize = dims[0]*dims[1];
-
-    for (k=0; k<dims[2]; k++)
-      {
-      for (j=0; j<dims[1]; j++)
+  public:
+    Grid Output;
+    data_type *Array;
+    data_type *Gradients;
+    int NumberOfInputComponents;
+    int FieldAssociation;
+    data_type *Vorticity;
+    data_type *QCriterion;
+    int Dims[3];
+
+    vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+    vtkSMPThreadLocal<std::vector<double> > Values;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      int i, j, k, idx, idx2, ii, inputComponent;
+      double xp[3], xm[3], factor;
+      xp[0] = xp[1] = xp[2] = xm[0] = xm[1] = xm[2] = factor = 0;
+      double xxi, yxi, zxi, xeta, yeta, zeta, xzeta, yzeta, zzeta;
+      xxi = yxi = zxi = xeta = yeta = zeta = xzeta = yzeta = zzeta = 0;
+      double aj, xix, xiy, xiz, etax, etay, etaz, zetax, zetay, zetaz;
+      aj = xix = xiy = xiz = etax = etay = etaz = zetax = zetay = zetaz = 0;
+
+      Grid output = this->Output;
+      data_type *array = this->Array;
+      data_type *gradients = this->Gradients;
+      int numberOfInputComponents = this->NumberOfInputComponents;
+      int fieldAssociation = this->FieldAssociation;
+      const int *dims = this->Dims;
+      int ijsize = dims[0]*dims[1];
+      vtkGenericCell *cell = this->Cell.Local();
+
+      // for finite differencing -- the values on the "plus" side and
+      // "minus" side of the point to be computed at
+      std::vector<double> &values = this->Values.Local();
+      values.resize(5*numberOfInputComponents);
+      double *plusvalues = &values[0];
+      double *minusvalues = plusvalues + numberOfInputComponents;
+      double *dValuesdXi = minusvalues + numberOfInputComponents;
+      double *dValuesdEta = dValuesdXi + numberOfInputComponents;
+      double *dValuesdZeta = dValuesdEta + numberOfInputComponents;
+
+      for (vtkIdType row = begin; row < end; row++)
         {
+        j = static_cast<int>(row % dims[1]);
+        k = static_cast<int>(row / dims[1]);
         for (i=0; i<dims[0]; i++)
           {
           //  Xi derivatives.
@@ -862,8 +1095,8 @@ namespace {
             factor = 1.0;
             idx = (i+1) + j*dims[0] + k*ijsize;
             idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -876,8 +1109,8 @@ namespace {
             factor = 1.0;
             idx = i + j*dims[0] + k*ijsize;
             idx2 = i-1 + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -890,8 +1123,8 @@ namespace {
             factor = 0.5;
             idx = (i+1) + j*dims[0] + k*ijsize;
             idx2 = (i-1) + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -929,8 +1162,8 @@ namespace {
             factor = 1.0;
             idx = i + (j+1)*dims[0] + k*ijsize;
             idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -943,8 +1176,8 @@ namespace {
             factor = 1.0;
             idx = i + j*dims[0] + k*ijsize;
             idx2 = i + (j-1)*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -957,8 +1190,8 @@ namespace {
             factor = 0.5;
             idx = i + (j+1)*dims[0] + k*ijsize;
             idx2 = i + (j-1)*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -996,8 +1229,8 @@ namespace {
             factor = 1.0;
             idx = i + j*dims[0] + (k+1)*ijsize;
             idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -1010,8 +1243,8 @@ namespace {
             factor = 1.0;
             idx = i + j*dims[0] + k*ijsize;
             idx2 = i + j*dims[0] + (k-1)*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -1024,8 +1257,8 @@ namespace {
             factor = 0.5;
             idx = i + j*dims[0] + (k+1)*ijsize;
             idx2 = i + j*dims[0] + (k-1)*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
+            GetGridEntityCoordinate(output, fieldAssociation, idx, cell, xp);
+            GetGridEntityCoordinate(output, fieldAssociation, idx2, cell, xm);
             for(inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
               {
@@ -1087,17 +1320,58 @@ namespace {
               zetaz*dValuesdZeta[inputComponent]);
             }
 
-          if(vorticity)
+          if(this->Vorticity)
             {
-            ComputeVorticityFromGradient(gradients+idx*numberOfInputComponents*3, vorticity+3*idx);
+            ComputeVorticityFromGradient(gradients+idx*numberOfInputComponents*3, this->Vorticity+3*idx);
             }
-          if(qCriterion)
+          if(this->QCriterion)
             {
-            ComputeQCriterionFromGradient(gradients+idx*numberOfInputComponents*3, qCriterion+idx);
+            ComputeQCriterionFromGradient(gradients+idx*numberOfInputComponents*3, this->QCriterion+idx);
             }
           }
         }
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  template<class Grid, class data_type>
+  void ComputeGradientsSG(vtkAlgorithm *self, Grid output,
+                          data_type* array, data_type* gradients,
+                          int numberOfInputComponents, int fieldAssociation,
+                          data_type* vorticity, data_type* qCriterion)
+  {
+    GradientsSG<Grid, data_type> functor;
+    functor.Output = output;
+    functor.Array = array;
+    functor.Gradients = gradients;
+    functor.NumberOfInputComponents = numberOfInputComponents;
+    functor.FieldAssociation = fieldAssociation;
+    functor.Vorticity = vorticity;
+    functor.QCriterion = qCriterion;
+
+    int *dims = functor.Dims;
+    output->GetDimensions(dims);
+    if(fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_CELLS)
+      {
+      // reduce the dimensions by 1 for cells
+      for(int i=0;i<3;i++)
+        {
+        dims[i]--;
+        }
       }
+    if (dims[0] <= 0 || dims[1] <= 0 || dims[2] <= 0)
+      {
+      return;
+      }
+
+    // The coordinates of the points and cells are thread safe once they
+    // have been computed from a single thread.
+    double x[3];
+    vtkGenericCell *cell = vtkGenericCell::New();
+    GetGridEntityCoordinate(output, fieldAssociation, 0, cell, x);
+    cell->Delete();
+
+    vtkGradientFilterFor(self, static_cast<vtkIdType>(dims[1])*dims[2], functor);
   }
 
 } // end anonymous namespace
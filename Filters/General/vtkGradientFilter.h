@@ -29,6 +29,9 @@
 // output tuple will be {du/dx, du/dy, du/dz, dv/dx, dv/dy, dv/dz, dw/dx,
 // dw/dy, dw/dz} for an input array {u, v, w}. There are also the options
 // to additionally compute the vorticity and Q criterion of a vector field.
+// The gradients are computed in parallel with vtkSMPTools: by finite
+// differences on structured datasets, and from the derivatives of the cells
+// otherwise.
 
 #ifndef __vtkGradientFilter_h
 #define __vtkGradientFilter_h
@@ -0,0 +1,325 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestFFTPlan.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks vtkFFTPlan against a direct computation of the discrete Fourier
+// transform for sizes of every kind (powers of two, products of small
+// primes, large primes), vtkImageFFT / vtkImageRFFT on a volume, with
+// all the axes at once and one axis per iteration, one vtkImageFFT updated
+// for many sizes, and vtkTableFFT on real and complex arrays.
+
+#include "vtkDoubleArray.h"
+#include "vtkFFTPlan.h"
+#include "vtkImageData.h"
+#include "vtkImageFFT.h"
+#include "vtkImageRFFT.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTableFFT.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+typedef std::vector<vtkImageComplex> ComplexVector;
+
+// Gives access to the transform of a single array.
+class TableFFT : public vtkTableFFT
+{
+public:
+  static TableFFT *New();
+  vtkTypeMacro(TableFFT, vtkTableFFT);
+
+  vtkSmartPointer<vtkDataArray> Transform(vtkDataArray *input)
+  {
+    return this->DoFFT(input);
+  }
+};
+vtkStandardNewMacro(TableFFT);
+
+ComplexVector DirectDFT(const ComplexVector& x, int sign)
+{
+  int n = static_cast<int>(x.size());
+  ComplexVector y(n);
+  for (int k = 0; k < n; k++)
+    {
+    double re = 0.0;
+    double im = 0.0;
+    for (int j = 0; j < n; j++)
+      {
+      double angle = -sign*2.0*vtkMath::Pi()*
+        static_cast<double>((static_cast<long>(j)*k) % n)/n;
+      re += x[j].Real*cos(angle) - x[j].Imag*sin(angle);
+      im += x[j].Real*sin(angle) + x[j].Imag*cos(angle);
+      }
+    y[k].Real = re;
+    y[k].Imag = im;
+    }
+  return y;
+}
+
+bool Compare(const ComplexVector& a, const vtkImageComplex *b,
+             double tol, const char *what, int n)
+{
+  for (size_t k = 0; k < a.size(); k++)
+    {
+    if (fabs(a[k].Real - b[k].Real) > tol ||
+        fabs(a[k].Imag - b[k].Imag) > tol)
+      {
+      cerr << what << " of size " << n << ": wrong coefficient " << k
+           << ": (" << b[k].Real << ", " << b[k].Imag << ") instead of ("
+           << a[k].Real << ", " << a[k].Imag << ")" << endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+bool TestSize(int n)
+{
+  ComplexVector x(n);
+  std::vector<double> real(n);
+  for (int i = 0; i < n; i++)
+    {
+    x[i].Real = static_cast<double>((i*7919)%101)/50.0 - 1.0;
+    x[i].Imag = static_cast<double>((i*104729)%97)/48.0 - 1.0;
+    real[i] = x[i].Real;
+    }
+  double tol = 1e-10*n;
+
+  vtkFFTPlan plan;
+  plan.Initialize(n, 1);
+  ComplexVector work(plan.GetWorkSize());
+
+  // forward
+  ComplexVector data = x;
+  plan.Forward(&data[0], &work[0]);
+  if (!Compare(DirectDFT(x, 1), &data[0], tol, "Forward", n))
+    {
+    return false;
+    }
+
+  // backward, back to the samples
+  plan.Backward(&data[0], &work[0]);
+  if (!Compare(x, &data[0], tol, "Backward", n))
+    {
+    return false;
+    }
+
+  // real samples
+  ComplexVector realX(n);
+  for (int i = 0; i < n; i++)
+    {
+    realX[i].Real = real[i];
+    realX[i].Imag = 0.0;
+    }
+  plan.ForwardReal(&real[0], &data[0], &work[0]);
+  return Compare(DirectDFT(realX, 1), &data[0], tol, "ForwardReal", n);
+}
+
+// The discrete Fourier transform of an image along its three axes.
+ComplexVector DirectImageDFT(vtkImageData *image, int sign)
+{
+  int dims[3];
+  image->GetDimensions(dims);
+  int nc = image->GetNumberOfScalarComponents();
+  float *ptr = static_cast<float *>(image->GetScalarPointer());
+  vtkIdType n = image->GetNumberOfPoints();
+  ComplexVector data(n);
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    data[i].Real = ptr[i*nc];
+    data[i].Imag = (nc > 1 ? ptr[i*nc + 1] : 0.0);
+    }
+  vtkIdType incs[3] = { 1, dims[0], static_cast<vtkIdType>(dims[0])*dims[1] };
+  for (int axis = 0; axis < 3; axis++)
+    {
+    int a1 = (axis + 1) % 3;
+    int a2 = (axis + 2) % 3;
+    for (int j = 0; j < dims[a1]; j++)
+      {
+      for (int k = 0; k < dims[a2]; k++)
+        {
+        ComplexVector line(dims[axis]);
+        vtkIdType start = j*incs[a1] + k*incs[a2];
+        for (int i = 0; i < dims[axis]; i++)
+          {
+          line[i] = data[start + i*incs[axis]];
+          }
+        line = DirectDFT(line, sign);
+        for (int i = 0; i < dims[axis]; i++)
+          {
+          data[start + i*incs[axis]] = line[i];
+          }
+        }
+      }
+    }
+  return data;
+}
+
+// Compare the extent of image with the expected values over wExt.
+bool CompareImage(const ComplexVector& expected, const int wExt[6],
+                  vtkImageData *image, const int extent[6], double tol,
+                  const char *what)
+{
+  int dims[3] = { wExt[1] - wExt[0] + 1, wExt[3] - wExt[2] + 1,
+                  wExt[5] - wExt[4] + 1 };
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      for (int x = extent[0]; x <= extent[1]; x++)
+        {
+        double *value =
+          static_cast<double *>(image->GetScalarPointer(x, y, z));
+        const vtkImageComplex& e = expected[
+          ((z - wExt[4])*dims[1] + (y - wExt[2]))*dims[0] + (x - wExt[0])];
+        if (fabs(value[0] - e.Real) > tol || fabs(value[1] - e.Imag) > tol)
+          {
+          cerr << what << ": wrong value at " << x << " " << y << " " << z
+               << ": (" << value[0] << ", " << value[1] << ") instead of ("
+               << e.Real << ", " << e.Imag << ")" << endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+}
+
+int TestFFTPlan(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  const int sizes[] = { 1, 2, 3, 4, 5, 6, 7, 8, 11, 12, 13, 16, 17, 30, 49,
+                        97, 100, 128, 143, 210, 243, 256, 1000, 1031 };
+  for (size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++)
+    {
+    if (!TestSize(sizes[i]))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A volume with a prime size, real and complex
+  for (int nc = 1; nc <= 2; nc++)
+    {
+    vtkNew<vtkImageData> image;
+    image->SetExtent(2, 13, -3, 13, 0, 9);
+    image->AllocateScalars(VTK_FLOAT, nc);
+    float *ptr = static_cast<float *>(image->GetScalarPointer());
+    for (vtkIdType i = 0; i < image->GetNumberOfPoints()*nc; i++)
+      {
+      ptr[i] = static_cast<float>((i*7919)%101) - 50.0f;
+      }
+    ComplexVector expected = DirectImageDFT(image.GetPointer(), 1);
+    double tol = 1e-6*image->GetNumberOfPoints()*50.0;
+
+    // all the axes at once
+    vtkNew<vtkImageFFT> fft;
+    fft->SetInputData(image.GetPointer());
+    fft->Update();
+    if (!CompareImage(expected, image->GetExtent(), fft->GetOutput(),
+                      image->GetExtent(), tol, "vtkImageFFT"))
+      {
+      return EXIT_FAILURE;
+      }
+
+    // one axis per iteration, for an update extent smaller than the image
+    int subExtent[6] = { 4, 9, -3, 13, 2, 5 };
+    vtkNew<vtkImageFFT> subFFT;
+    subFFT->SetInputData(image.GetPointer());
+    subFFT->UpdateInformation();
+    vtkStreamingDemandDrivenPipeline::SetUpdateExtent(
+      subFFT->GetOutputInformation(0), subExtent);
+    subFFT->Update();
+    if (!CompareImage(expected, image->GetExtent(), subFFT->GetOutput(),
+                      subExtent, tol, "vtkImageFFT (update extent)"))
+      {
+      return EXIT_FAILURE;
+      }
+
+    // back to the image
+    vtkNew<vtkImageRFFT> rfft;
+    rfft->SetInputConnection(fft->GetOutputPort());
+    rfft->Update();
+    ComplexVector samples(image->GetNumberOfPoints());
+    for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+      {
+      samples[i].Real = ptr[i*nc];
+      samples[i].Imag = (nc > 1 ? ptr[i*nc + 1] : 0.0);
+      }
+    if (!CompareImage(samples, image->GetExtent(), rfft->GetOutput(),
+                      image->GetExtent(), 1e-6, "vtkImageRFFT"))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // One filter for many sizes, more than the plans that it keeps
+  vtkNew<vtkImageFFT> lineFFT;
+  for (int n = 2; n <= 24; n++)
+    {
+    vtkNew<vtkImageData> line;
+    line->SetExtent(0, n - 1, 0, 1, 0, 0);
+    line->AllocateScalars(VTK_FLOAT, 1);
+    float *ptr = static_cast<float *>(line->GetScalarPointer());
+    for (int i = 0; i < 2*n; i++)
+      {
+      ptr[i] = static_cast<float>((i*7919)%101) - 50.0f;
+      }
+    lineFFT->SetInputData(line.GetPointer());
+    lineFFT->Update();
+    if (!CompareImage(DirectImageDFT(line.GetPointer(), 1),
+                      line->GetExtent(), lineFFT->GetOutput(),
+                      line->GetExtent(), 1e-9*n*50.0, "vtkImageFFT (sizes)"))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // vtkTableFFT: real samples, and complex ones for two components
+  for (int nc = 1; nc <= 2; nc++)
+    {
+    int n = 30;
+    vtkNew<vtkDoubleArray> array;
+    array->SetNumberOfComponents(nc);
+    array->SetNumberOfTuples(n);
+    ComplexVector x(n);
+    for (int i = 0; i < n; i++)
+      {
+      x[i].Real = static_cast<double>((i*7919)%101)/50.0 - 1.0;
+      x[i].Imag = (nc > 1 ? static_cast<double>((i*104729)%97)/48.0 - 1.0 :
+                            0.0);
+      array->SetComponent(i, 0, x[i].Real);
+      if (nc > 1)
+        {
+        array->SetComponent(i, 1, x[i].Imag);
+        }
+      }
+    vtkNew<TableFFT> tableFFT;
+    vtkSmartPointer<vtkDataArray> frequencies =
+      tableFFT->Transform(array.GetPointer());
+    if (!Compare(DirectDFT(x, 1), reinterpret_cast<vtkImageComplex *>(
+                   vtkDoubleArray::SafeDownCast(frequencies)->GetPointer(0)),
+                 1e-10*n, (nc > 1 ? "vtkTableFFT (complex)" : "vtkTableFFT"),
+                 n))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
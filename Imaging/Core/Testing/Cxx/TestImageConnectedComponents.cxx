@@ -0,0 +1,214 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageConnectedComponents.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the labels, sizes and extents of vtkImageConnectedComponents
+// against a flood fill, for every connectivity, on binary and label
+// volumes and on a single slice, with many blocks.
+
+#include "vtkIdTypeArray.h"
+#include "vtkImageConnectedComponents.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+
+#include <vector>
+
+namespace
+{
+void MakeImage(vtkImageData *image, const int extent[6], int numberOfValues)
+{
+  image->SetExtent(const_cast<int *>(extent));
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 2);
+  unsigned char *ptr =
+    static_cast<unsigned char *>(image->GetScalarPointer());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+    {
+    // the second component is labeled, about half of it is background
+    unsigned int h = static_cast<unsigned int>(i)*2654435761u;
+    h ^= h >> 15;
+    ptr[2*i] = 7;
+    ptr[2*i + 1] = static_cast<unsigned char>(
+      (h % 100) < 45 ? 0 : 1 + (h >> 8) % numberOfValues);
+    }
+}
+
+// Label the regions by flood fill, from their first voxel in memory order.
+std::vector<int> FloodFill(vtkImageData *image, int connectivity)
+{
+  int dims[3];
+  image->GetDimensions(dims);
+  unsigned char *ptr =
+    static_cast<unsigned char *>(image->GetScalarPointer());
+  vtkIdType n = image->GetNumberOfPoints();
+  std::vector<int> labels(n, 0);
+  int count = 0;
+  for (vtkIdType seed = 0; seed < n; seed++)
+    {
+    if (ptr[2*seed + 1] == 0 || labels[seed] != 0)
+      {
+      continue;
+      }
+    labels[seed] = ++count;
+    std::vector<vtkIdType> stack(1, seed);
+    while (!stack.empty())
+      {
+      vtkIdType i = stack.back();
+      stack.pop_back();
+      int p[3] = { static_cast<int>(i % dims[0]),
+                   static_cast<int>((i / dims[0]) % dims[1]),
+                   static_cast<int>(i / (dims[0]*dims[1])) };
+      for (int dz = -1; dz <= 1; dz++)
+        {
+        for (int dy = -1; dy <= 1; dy++)
+          {
+          for (int dx = -1; dx <= 1; dx++)
+            {
+            int order = (dx != 0) + (dy != 0) + (dz != 0);
+            int q[3] = { p[0] + dx, p[1] + dy, p[2] + dz };
+            if (order == 0 || (order == 2 && connectivity < 18) ||
+                (order == 3 && connectivity < 26) ||
+                q[0] < 0 || q[0] >= dims[0] || q[1] < 0 || q[1] >= dims[1] ||
+                q[2] < 0 || q[2] >= dims[2])
+              {
+              continue;
+              }
+            vtkIdType j = (static_cast<vtkIdType>(q[2])*dims[1] + q[1])*
+              dims[0] + q[0];
+            if (labels[j] == 0 && ptr[2*j + 1] == ptr[2*i + 1])
+              {
+              labels[j] = count;
+              stack.push_back(j);
+              }
+            }
+          }
+        }
+      }
+    }
+  return labels;
+}
+
+bool Check(vtkImageData *image, int connectivity, const char *what)
+{
+  vtkNew<vtkImageConnectedComponents> components;
+  components->SetInputData(image);
+  components->SetConnectivity(connectivity);
+  components->SetActiveComponent(1);
+  components->Update();
+
+  std::vector<int> expected = FloodFill(image, connectivity);
+  vtkImageData *output = components->GetOutput();
+  int *labels = static_cast<int *>(output->GetScalarPointer());
+  int count = 0;
+  for (size_t i = 0; i < expected.size(); i++)
+    {
+    if (labels[i] != expected[i])
+      {
+      cerr << what << " (" << connectivity << "-connectivity): wrong label "
+           << labels[i] << " instead of " << expected[i] << " at " << i
+           << endl;
+      return false;
+      }
+    count = (expected[i] > count ? expected[i] : count);
+    }
+  if (components->GetNumberOfRegions() != count)
+    {
+    cerr << what << ": " << components->GetNumberOfRegions()
+         << " regions instead of " << count << endl;
+    return false;
+    }
+
+  // sizes and extents
+  std::vector<vtkIdType> sizes(count, 0);
+  std::vector<int> extents(6*count);
+  for (int label = 0; label < count; label++)
+    {
+    for (int axis = 0; axis < 3; axis++)
+      {
+      extents[6*label + 2*axis] = VTK_INT_MAX;
+      extents[6*label + 2*axis + 1] = VTK_INT_MIN;
+      }
+    }
+  int *extent = output->GetExtent();
+  int dims[3];
+  output->GetDimensions(dims);
+  for (size_t i = 0; i < expected.size(); i++)
+    {
+    if (expected[i] == 0)
+      {
+      continue;
+      }
+    int label = expected[i] - 1;
+    int p[3] = { static_cast<int>(i % dims[0]) + extent[0],
+                 static_cast<int>((i / dims[0]) % dims[1]) + extent[2],
+                 static_cast<int>(i / (dims[0]*dims[1])) + extent[4] };
+    sizes[label]++;
+    for (int axis = 0; axis < 3; axis++)
+      {
+      int& lo = extents[6*label + 2*axis];
+      int& hi = extents[6*label + 2*axis + 1];
+      lo = (p[axis] < lo ? p[axis] : lo);
+      hi = (p[axis] > hi ? p[axis] : hi);
+      }
+    }
+  for (int label = 0; label < count; label++)
+    {
+    if (components->GetRegionSizes()->GetValue(label) != sizes[label])
+      {
+      cerr << what << ": wrong size for region " << label + 1 << endl;
+      return false;
+      }
+    for (int c = 0; c < 6; c++)
+      {
+      if (components->GetRegionExtents()->GetComponent(label, c) !=
+          extents[6*label + c])
+        {
+        cerr << what << ": wrong extent for region " << label + 1 << endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+int TestImageConnectedComponents(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  // many blocks, for the merges across block boundaries
+  int threads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(5);
+
+  const int volume[6] = { -2, 17, 3, 17, 0, 22 };
+  const int slice[6] = { 0, 40, -5, 33, 4, 4 };
+  const int connectivities[3] = { 6, 18, 26 };
+  bool success = true;
+  for (int c = 0; c < 3 && success; c++)
+    {
+    for (int numberOfValues = 1; numberOfValues <= 3 && success;
+         numberOfValues += 2)
+      {
+      vtkNew<vtkImageData> image;
+      MakeImage(image.GetPointer(), volume, numberOfValues);
+      success = Check(image.GetPointer(), connectivities[c], "Volume");
+
+      vtkNew<vtkImageData> image2D;
+      MakeImage(image2D.GetPointer(), slice, numberOfValues);
+      success = success &&
+        Check(image2D.GetPointer(), connectivities[c], "Slice");
+      }
+    }
+
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(threads);
+  return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,193 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageEuclideanDistance.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks vtkImageEuclideanDistance against a brute force computation of the
+// squared distances, on an anisotropic volume, with and without
+// initialization, with a maximum distance, for a signed distance and for a
+// dimensionality of 2, and against Saito's algorithm on an isotropic volume.
+
+#include "vtkImageData.h"
+#include "vtkImageEuclideanDistance.h"
+#include "vtkNew.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+const int Extent[6] = { -3, 15, 2, 14, 0, 8 };
+const double Spacing[3] = { 1.0, 0.5, 2.5 };
+
+void MakeImage(vtkImageData *image, const double spacing[3])
+{
+  image->SetExtent(const_cast<int *>(Extent));
+  image->SetSpacing(const_cast<double *>(spacing));
+  image->AllocateScalars(VTK_SHORT, 1);
+  short *ptr = static_cast<short *>(image->GetScalarPointer());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+    {
+    // mostly non-zero, with a few zero voxels and a few small values
+    int v = static_cast<int>((i*7919)%97);
+    ptr[i] = static_cast<short>(v < 4 ? 0 : v % 5);
+    }
+}
+
+// The minimum over the voxels q of start(q) plus the squared distance to q,
+// along the axes below dimensionality, where start is the input value or
+// given by the mask.
+std::vector<double> BruteForce(vtkImageData *image, int initialize,
+                               int complement, double maxDist,
+                               int dimensionality)
+{
+  int dims[3];
+  image->GetDimensions(dims);
+  double *spacing = image->GetSpacing();
+  short *ptr = static_cast<short *>(image->GetScalarPointer());
+  vtkIdType n = image->GetNumberOfPoints();
+  std::vector<double> start(n);
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    start[i] = ptr[i];
+    if (initialize)
+      {
+      start[i] = ((ptr[i] == 0) != (complement != 0) ? 0.0 : maxDist);
+      }
+    }
+  std::vector<double> result(n);
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    int p[3] = { static_cast<int>(i % dims[0]),
+                 static_cast<int>((i / dims[0]) % dims[1]),
+                 static_cast<int>(i / (dims[0]*dims[1])) };
+    double best = start[i];
+    for (vtkIdType j = 0; j < n; j++)
+      {
+      int q[3] = { static_cast<int>(j % dims[0]),
+                   static_cast<int>((j / dims[0]) % dims[1]),
+                   static_cast<int>(j / (dims[0]*dims[1])) };
+      double d = start[j];
+      bool reachable = true;
+      for (int axis = 0; axis < 3; axis++)
+        {
+        double delta = (p[axis] - q[axis])*spacing[axis];
+        reachable = reachable && (axis < dimensionality || delta == 0.0);
+        d += delta*delta;
+        }
+      if (reachable && d < best)
+        {
+        best = d;
+        }
+      }
+    result[i] = best;
+    }
+  return result;
+}
+
+bool Compare(const std::vector<double>& expected, vtkImageData *output,
+             const char *what)
+{
+  double *ptr = static_cast<double *>(output->GetScalarPointer());
+  for (size_t i = 0; i < expected.size(); i++)
+    {
+    if (fabs(ptr[i] - expected[i]) > 1e-9*(1.0 + fabs(expected[i])))
+      {
+      cerr << what << ": wrong value at " << i << ": " << ptr[i]
+           << " instead of " << expected[i] << endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int TestImageEuclideanDistance(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> image;
+  MakeImage(image.GetPointer(), Spacing);
+  const double unitSpacing[3] = { 1.0, 1.0, 1.0 };
+  vtkNew<vtkImageData> isotropic;
+  MakeImage(isotropic.GetPointer(), unitSpacing);
+
+  for (int initialize = 0; initialize <= 1; initialize++)
+    {
+    for (int bounded = 0; bounded <= 1; bounded++)
+      {
+      double maxDist = (bounded ? 6.0 : VTK_INT_MAX);
+      vtkNew<vtkImageEuclideanDistance> distance;
+      distance->SetInputData(image.GetPointer());
+      distance->SetInitialize(initialize);
+      distance->SetMaximumDistance(maxDist);
+      distance->Update();
+      std::vector<double> expected =
+        BruteForce(image.GetPointer(), initialize, 0, maxDist, 3);
+      if (!Compare(expected, distance->GetOutput(), "Felzenszwalb"))
+        {
+        return EXIT_FAILURE;
+        }
+
+      // Saito's algorithm takes the input as a mask for its first axis
+      if (initialize)
+        {
+        vtkNew<vtkImageEuclideanDistance> saito;
+        saito->SetInputData(isotropic.GetPointer());
+        saito->SetAlgorithmToSaito();
+        saito->SetMaximumDistance(maxDist);
+        saito->Update();
+        distance->SetInputData(isotropic.GetPointer());
+        distance->Update();
+        if (!Compare(BruteForce(isotropic.GetPointer(), 1, 0, maxDist, 3),
+                     saito->GetOutput(), "Saito") ||
+            !Compare(BruteForce(isotropic.GetPointer(), 1, 0, maxDist, 3),
+                     distance->GetOutput(), "Felzenszwalb (isotropic)"))
+          {
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  // a signed distance, negative outside of the mask
+  vtkNew<vtkImageEuclideanDistance> signedDistance;
+  signedDistance->SetInputData(image.GetPointer());
+  signedDistance->SignedDistanceOn();
+  signedDistance->Update();
+  std::vector<double> inside =
+    BruteForce(image.GetPointer(), 1, 0, VTK_INT_MAX, 3);
+  std::vector<double> outside =
+    BruteForce(image.GetPointer(), 1, 1, VTK_INT_MAX, 3);
+  for (size_t i = 0; i < inside.size(); i++)
+    {
+    if (inside[i] == 0.0)
+      {
+      inside[i] = -outside[i];
+      }
+    }
+  if (!Compare(inside, signedDistance->GetOutput(), "Signed distance"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // along x and y only
+  vtkNew<vtkImageEuclideanDistance> planar;
+  planar->SetInputData(image.GetPointer());
+  planar->SetDimensionality(2);
+  planar->Update();
+  if (!Compare(BruteForce(image.GetPointer(), 1, 0, VTK_INT_MAX, 2),
+               planar->GetOutput(), "Dimensionality 2"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,246 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageHistogramIncremental.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the joint histogram and the statistics of vtkImageAccumulate
+// against a direct count, with and without a stencil, and checks the
+// percentiles and the incremental updates of vtkImageHistogram against
+// sorted values and a new execution of the filter.
+
+#include "vtkIdTypeArray.h"
+#include "vtkImageAccumulate.h"
+#include "vtkImageData.h"
+#include "vtkImageHistogram.h"
+#include "vtkImageStencilData.h"
+#include "vtkNew.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+void MakeImage(vtkImageData *image, int numberOfComponents)
+{
+  image->SetExtent(-4, 45, 2, 31, 0, 16);
+  image->AllocateScalars(VTK_SHORT, numberOfComponents);
+  short *ptr = static_cast<short *>(image->GetScalarPointer());
+  vtkIdType n = image->GetNumberOfPoints()*numberOfComponents;
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    unsigned int h = static_cast<unsigned int>(i)*2654435761u;
+    h ^= h >> 13;
+    ptr[i] = static_cast<short>(static_cast<int>(h % 700) - 100);
+    }
+}
+
+// Keep the voxels with an even x + y + z.
+void MakeStencil(vtkImageStencilData *stencil, const int extent[6])
+{
+  stencil->SetExtent(const_cast<int *>(extent));
+  stencil->AllocateExtents();
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      for (int x = extent[0] + ((extent[0] + y + z) & 1); x <= extent[1];
+           x += 2)
+        {
+        stencil->InsertNextExtent(x, x, y, z);
+        }
+      }
+    }
+}
+
+bool CheckAccumulate(bool useStencil)
+{
+  vtkNew<vtkImageData> image;
+  MakeImage(image.GetPointer(), 2);
+  vtkNew<vtkImageStencilData> stencil;
+  MakeStencil(stencil.GetPointer(), image->GetExtent());
+
+  vtkNew<vtkImageAccumulate> accumulate;
+  accumulate->SetInputData(image.GetPointer());
+  if (useStencil)
+    {
+    accumulate->SetStencilData(stencil.GetPointer());
+    }
+  accumulate->SetComponentOrigin(-50.0, -100.0, 0.0);
+  accumulate->SetComponentSpacing(10.0, 25.0, 1.0);
+  accumulate->SetComponentExtent(0, 49, 0, 19, 0, 0);
+  accumulate->Update();
+
+  std::vector<int> expected(50*20, 0);
+  double sum[2] = { 0.0, 0.0 };
+  double minimum[2] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MAX };
+  double maximum[2] = { VTK_DOUBLE_MIN, VTK_DOUBLE_MIN };
+  vtkIdType count = 0;
+  int *extent = image->GetExtent();
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      for (int x = extent[0]; x <= extent[1]; x++)
+        {
+        if (useStencil && !stencil->IsInside(x, y, z))
+          {
+          continue;
+          }
+        short *ptr = static_cast<short *>(image->GetScalarPointer(x, y, z));
+        int i = static_cast<int>(std::floor((ptr[0] + 50.0)/10.0));
+        int j = static_cast<int>(std::floor((ptr[1] + 100.0)/25.0));
+        if (i >= 0 && i < 50 && j >= 0 && j < 20)
+          {
+          expected[j*50 + i]++;
+          }
+        for (int c = 0; c < 2; c++)
+          {
+          sum[c] += ptr[c];
+          minimum[c] = std::min(minimum[c], static_cast<double>(ptr[c]));
+          maximum[c] = std::max(maximum[c], static_cast<double>(ptr[c]));
+          count++;
+          }
+        }
+      }
+    }
+
+  int *histogram = static_cast<int *>(
+    accumulate->GetOutput()->GetScalarPointer());
+  for (int k = 0; k < 50*20; k++)
+    {
+    if (histogram[k] != expected[k])
+      {
+      cerr << "Accumulate: bin " << k << " has " << histogram[k]
+           << " instead of " << expected[k] << endl;
+      return false;
+      }
+    }
+  for (int c = 0; c < 2; c++)
+    {
+    if (accumulate->GetMin()[c] != minimum[c] ||
+        accumulate->GetMax()[c] != maximum[c] ||
+        std::fabs(accumulate->GetMean()[c] - sum[c]/count) > 1e-10)
+      {
+      cerr << "Accumulate: wrong statistics for component " << c << endl;
+      return false;
+      }
+    }
+  if (accumulate->GetVoxelCount() != count)
+    {
+    cerr << "Accumulate: voxel count " << accumulate->GetVoxelCount()
+         << " instead of " << count << endl;
+    return false;
+    }
+  return true;
+}
+
+bool CompareHistograms(vtkImageHistogram *histogram,
+                       vtkImageHistogram *expected, const char *what)
+{
+  vtkIdTypeArray *a = histogram->GetHistogram();
+  vtkIdTypeArray *b = expected->GetHistogram();
+  if (a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+      histogram->GetTotal() != expected->GetTotal())
+    {
+    cerr << what << ": wrong size or total" << endl;
+    return false;
+    }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); i++)
+    {
+    if (a->GetValue(i) != b->GetValue(i))
+      {
+      cerr << what << ": bin " << i << " has " << a->GetValue(i)
+           << " instead of " << b->GetValue(i) << endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+bool CheckHistogram()
+{
+  vtkNew<vtkImageData> image;
+  MakeImage(image.GetPointer(), 1);
+
+  vtkNew<vtkImageHistogram> histogram;
+  histogram->SetInputData(image.GetPointer());
+  histogram->AutomaticBinningOn();
+  histogram->GenerateHistogramImageOff();
+  histogram->Update();
+
+  // with unit bins, the percentiles are the sorted values
+  short *ptr = static_cast<short *>(image->GetScalarPointer());
+  std::vector<short> values(ptr, ptr + image->GetNumberOfPoints());
+  std::sort(values.begin(), values.end());
+  const double percentiles[6] = { 0.0, 1.0, 25.0, 50.0, 99.5, 100.0 };
+  for (int k = 0; k < 6; k++)
+    {
+    size_t rank = static_cast<size_t>(
+      percentiles[k]*0.01*(values.size() - 1));
+    if (histogram->GetPercentile(percentiles[k]) != values[rank])
+      {
+      cerr << "Percentile " << percentiles[k] << ": "
+           << histogram->GetPercentile(percentiles[k]) << " instead of "
+           << values[rank] << endl;
+      return false;
+      }
+    }
+
+  // modify a block, then compare with a new histogram with the same bins
+  const int block[6] = { 10, 20, -5, 9, 3, 7 };
+  histogram->RemoveExtentFromHistogram(block);
+  for (int z = block[4]; z <= block[5]; z++)
+    {
+    for (int y = 2; y <= block[3]; y++)
+      {
+      for (int x = block[0]; x <= block[1]; x++)
+        {
+        short *voxel = static_cast<short *>(image->GetScalarPointer(x, y, z));
+        *voxel = static_cast<short>(5*x - 3*y + z);
+        }
+      }
+    }
+  histogram->AddExtentToHistogram(block);
+
+  vtkNew<vtkImageHistogram> expected;
+  expected->SetInputData(image.GetPointer());
+  expected->SetNumberOfBins(histogram->GetNumberOfBins());
+  expected->SetBinOrigin(histogram->GetBinOrigin());
+  expected->SetBinSpacing(histogram->GetBinSpacing());
+  expected->GenerateHistogramImageOff();
+  expected->Update();
+  if (!CompareHistograms(histogram.GetPointer(), expected.GetPointer(),
+                         "Incremental"))
+    {
+    return false;
+    }
+
+  // the percentiles follow the modified histogram
+  if (histogram->GetPercentile(50.0) != expected->GetPercentile(50.0))
+    {
+    cerr << "Percentile after the update: "
+         << histogram->GetPercentile(50.0) << " instead of "
+         << expected->GetPercentile(50.0) << endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int TestImageHistogramIncremental(int vtkNotUsed(argc),
+                                  char *vtkNotUsed(argv)[])
+{
+  bool success = (CheckAccumulate(false) && CheckAccumulate(true) &&
+                  CheckHistogram());
+  return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,229 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageInterpolatorBatch.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that interpolating a row of points gives the same values as
+// interpolating the points one at a time, for every interpolation and
+// border mode, for a volume and a single slice, and checks an oblique
+// vtkImageReslice against the interpolator.
+
+#include "vtkDataArray.h"
+#include "vtkImageBSplineInterpolator.h"
+#include "vtkImageData.h"
+#include "vtkImageInterpolator.h"
+#include "vtkImageReslice.h"
+#include "vtkMatrix4x4.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+const int Volume[6] = { -3, 20, 2, 18, 0, 11 };
+const int Slice[6] = { -3, 20, 2, 18, 4, 4 };
+
+void MakeImage(vtkImageData *image, int scalarType,
+               const int extent[6] = Volume)
+{
+  image->SetExtent(const_cast<int *>(extent));
+  image->SetSpacing(0.9, 1.1, 1.3);
+  image->SetOrigin(-2.0, 3.5, 1.0);
+  image->AllocateScalars(scalarType, 2);
+  vtkIdType n = image->GetNumberOfPoints();
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    unsigned int h = static_cast<unsigned int>(i)*2654435761u;
+    h ^= h >> 13;
+    image->GetPointData()->GetScalars()->SetComponent(i, 0, h % 1000);
+    image->GetPointData()->GetScalars()->SetComponent(i, 1, (h >> 10) % 50);
+    }
+}
+
+template<class F>
+bool CheckBatch(vtkAbstractImageInterpolator *interpolator,
+                const int extent[6], const char *what)
+{
+  // points inside and outside of the extent, some of them on the grid,
+  // and around the slice for a single slice
+  const int n = 150;
+  std::vector<F> points(3*n);
+  for (int i = 0; i < n; i++)
+    {
+    points[3*i] = static_cast<F>(-4.7 + 0.17*i);
+    points[3*i + 1] = static_cast<F>(1.5 + 0.11*i);
+    points[3*i + 2] = static_cast<F>((i % 7 == 0) ? 3 : 12.3 - 0.09*i);
+    if (extent[4] == extent[5])
+      {
+      points[3*i + 2] = static_cast<F>(
+        extent[4] + ((i % 7 == 0) ? 0.0 : 0.03*(i % 11) - 0.15));
+      }
+    }
+
+  int m = interpolator->GetNumberOfComponents();
+  std::vector<F> batch(m*n);
+  interpolator->InterpolateIJK(&points[0], &batch[0], n);
+  for (int i = 0; i < n; i++)
+    {
+    F value[2];
+    interpolator->InterpolateIJK(&points[3*i], value);
+    for (int c = 0; c < m; c++)
+      {
+      if (std::fabs(value[c] - batch[m*i + c]) >
+          1e-5*(1.0 + std::fabs(value[c])))
+        {
+        cerr << what << ": " << batch[m*i + c] << " instead of " << value[c]
+             << " at point " << i << endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+bool CheckInterpolator(vtkAbstractImageInterpolator *interpolator,
+                       const char *what)
+{
+  bool success = true;
+  for (int scalarType = VTK_FLOAT; success && scalarType != 0;
+       scalarType = (scalarType == VTK_FLOAT ? VTK_SHORT : 0))
+    {
+    for (int e = 0; success && e < 2; e++)
+      {
+      const int *extent = (e == 0 ? Volume : Slice);
+      vtkNew<vtkImageData> image;
+      MakeImage(image.GetPointer(), scalarType, extent);
+      for (int border = VTK_IMAGE_BORDER_CLAMP;
+           success && border <= VTK_IMAGE_BORDER_MIRROR; border++)
+        {
+        interpolator->SetBorderMode(border);
+        interpolator->Initialize(image.GetPointer());
+        success = (CheckBatch<double>(interpolator, extent, what) &&
+                   CheckBatch<float>(interpolator, extent, what));
+        }
+      interpolator->ReleaseData();
+      }
+    }
+  return success;
+}
+
+// An oblique reslice must give the same values as the interpolator, and
+// the background where the points are out of bounds.
+bool CheckReslice(int interpolationMode, bool perspective)
+{
+  vtkNew<vtkImageData> image;
+  MakeImage(image.GetPointer(), VTK_SHORT);
+
+  vtkNew<vtkMatrix4x4> axes;
+  double angle = 0.4;
+  axes->SetElement(0, 0, cos(angle));
+  axes->SetElement(0, 1, -sin(angle));
+  axes->SetElement(1, 0, sin(angle)*cos(0.3));
+  axes->SetElement(1, 1, cos(angle)*cos(0.3));
+  axes->SetElement(1, 2, -sin(0.3));
+  axes->SetElement(2, 0, sin(angle)*sin(0.3));
+  axes->SetElement(2, 1, cos(angle)*sin(0.3));
+  axes->SetElement(2, 2, cos(0.3));
+  axes->SetElement(0, 3, 7.1);
+  axes->SetElement(1, 3, 11.3);
+  axes->SetElement(2, 3, 8.2);
+  if (perspective)
+    {
+    axes->SetElement(3, 2, 0.01);
+    }
+
+  vtkNew<vtkImageInterpolator> interpolator;
+  interpolator->SetInterpolationMode(interpolationMode);
+
+  vtkNew<vtkImageReslice> reslice;
+  reslice->SetInputData(image.GetPointer());
+  reslice->SetInterpolator(interpolator.GetPointer());
+  reslice->SetInterpolationMode(interpolationMode);
+  reslice->SetResliceAxes(axes.GetPointer());
+  reslice->SetOutputScalarType(VTK_FLOAT);
+  reslice->SetOutputSpacing(0.7, 0.8, 1.0);
+  reslice->SetOutputOrigin(-12.0, -10.0, -2.0);
+  reslice->SetOutputExtent(0, 44, 0, 34, 0, 3);
+  reslice->SetBackgroundLevel(-5.0);
+  reslice->Update();
+  vtkImageData *output = reslice->GetOutput();
+
+  vtkNew<vtkImageInterpolator> check;
+  check->SetInterpolationMode(interpolationMode);
+  check->SetOutValue(-5.0);
+  check->SetTolerance(0.5);
+  check->Initialize(image.GetPointer());
+  int *extent = output->GetExtent();
+  int mismatches = 0;
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      for (int x = extent[0]; x <= extent[1]; x++)
+        {
+        double p[4] = { -12.0 + 0.7*x, -10.0 + 0.8*y, -2.0 + 1.0*z, 1.0 };
+        double q[4];
+        axes->MultiplyPoint(p, q);
+        double point[3] = { q[0]/q[3], q[1]/q[3], q[2]/q[3] };
+        double value[2];
+        check->Interpolate(point, value);
+        float *out = static_cast<float *>(output->GetScalarPointer(x, y, z));
+        for (int c = 0; c < 2; c++)
+          {
+          if (std::fabs(out[c] - value[c]) > 1e-2*(1.0 + std::fabs(value[c])))
+            {
+            // points exactly on the bounds can go either way
+            mismatches++;
+            }
+          }
+        }
+      }
+    }
+  if (mismatches > 4)
+    {
+    cerr << "Reslice (mode " << interpolationMode << ", perspective "
+         << perspective << "): " << mismatches << " wrong values" << endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int TestImageInterpolatorBatch(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  bool success = true;
+  for (int mode = VTK_NEAREST_INTERPOLATION;
+       success && mode <= VTK_CUBIC_INTERPOLATION; mode++)
+    {
+    vtkNew<vtkImageInterpolator> interpolator;
+    interpolator->SetInterpolationMode(mode);
+    success = CheckInterpolator(interpolator.GetPointer(),
+                                interpolator->GetInterpolationModeAsString());
+    }
+
+  for (int degree = 0; success && degree <= 5; degree += 3)
+    {
+    vtkNew<vtkImageBSplineInterpolator> interpolator;
+    interpolator->SetSplineDegree(degree);
+    success = CheckInterpolator(interpolator.GetPointer(), "BSpline");
+    }
+
+  for (int mode = VTK_NEAREST_INTERPOLATION;
+       success && mode <= VTK_CUBIC_INTERPOLATION; mode++)
+    {
+    success = (CheckReslice(mode, false) && CheckReslice(mode, true));
+    }
+
+  return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,268 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImagePyramid.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks every level of vtkImagePyramid against the linear and cubic
+// kernels applied to the previous level, checks that the voxels of each
+// level are centered on the blocks of input voxels that they cover, for
+// odd dimensions, single slices and 64-bit data, and checks that the
+// Lanczos kernel reproduces a ramp away from the edges.
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkImageInterpolator.h"
+#include "vtkImagePyramid.h"
+#include "vtkImageSincInterpolator.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+
+#include <cmath>
+
+namespace
+{
+// The weights of the kernels at the midpoint between the samples 0 and 1,
+// for the samples -1, 0, 1 and 2.
+const double LinearWeights[4] = { 0.0, 0.5, 0.5, 0.0 };
+const double CubicWeights[4] = { -0.0625, 0.5625, 0.5625, -0.0625 };
+
+void MakeImage(vtkImageData *image, const int extent[6], int scalarType)
+{
+  image->SetExtent(const_cast<int *>(extent));
+  image->SetSpacing(0.5, 0.8, 1.5);
+  image->SetOrigin(-3.0, 2.0, 7.0);
+  image->AllocateScalars(scalarType, 2);
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+    {
+    unsigned int h = static_cast<unsigned int>(i)*2654435761u;
+    h ^= h >> 13;
+    scalars->SetComponent(i, 0, h % 1000);
+    scalars->SetComponent(i, 1, (h >> 10) % 7);
+    }
+}
+
+// The value of a voxel of the level that follows prev, with the kernel
+// weights and the samples past the edges clamped to the edges.
+double Reference(vtkImageData *prev, const int id[3], int c,
+                 const double weights[4])
+{
+  int *ext = prev->GetExtent();
+  int first[3];
+  int count[3];
+  for (int i = 0; i < 3; i++)
+    {
+    bool reduced = (ext[2*i+1] > ext[2*i]);
+    first[i] = (reduced ? 2*id[i] - 1 : 0);
+    count[i] = (reduced ? 4 : 1);
+    }
+
+  double sum = 0.0;
+  for (int k = 0; k < count[2]; k++)
+    {
+    for (int j = 0; j < count[1]; j++)
+      {
+      for (int i = 0; i < count[0]; i++)
+        {
+        int l[3] = { i, j, k };
+        int idx[3];
+        double w = 1.0;
+        for (int a = 0; a < 3; a++)
+          {
+          int n = ext[2*a+1] - ext[2*a] + 1;
+          int x = first[a] + l[a];
+          idx[a] = ext[2*a] + (x < 0 ? 0 : (x >= n ? n - 1 : x));
+          w *= (count[a] == 4 ? weights[l[a]] : 1.0);
+          }
+        sum += w*prev->GetScalarComponentAsDouble(idx[0], idx[1], idx[2], c);
+        }
+      }
+    }
+  return sum;
+}
+
+bool Check(vtkImageData *image, vtkAbstractImageInterpolator *interpolator,
+           const double weights[4], const char *what)
+{
+  const int levels = 6;
+  vtkNew<vtkImagePyramid> pyramid;
+  pyramid->SetNumberOfLevels(levels);
+  if (interpolator)
+    {
+    pyramid->SetInterpolator(interpolator);
+    }
+  pyramid->SetInputData(image);
+  pyramid->Update();
+
+  int scalarType = image->GetScalarType();
+  bool isFloat = (scalarType == VTK_FLOAT || scalarType == VTK_DOUBLE);
+  int *inExt = image->GetExtent();
+
+  // the size of the blocks of input voxels covered by the current level
+  int block[3] = { 1, 1, 1 };
+  vtkImageData *prev = image;
+  for (int level = 1; level < levels; level++)
+    {
+    int prevDims[3];
+    prev->GetDimensions(prevDims);
+    for (int i = 0; i < 3; i++)
+      {
+      block[i] *= (prevDims[i] > 1 ? 2 : 1);
+      }
+
+    vtkImageData *output = pyramid->GetOutput(level);
+    int *extent = output->GetExtent();
+    int dims[3];
+    output->GetDimensions(dims);
+    for (int i = 0; i < 3; i++)
+      {
+      if (dims[i] != (prevDims[i] > 1 ? (prevDims[i] + 1)/2 : 1))
+        {
+        cerr << what << ": wrong dimensions at level " << level << endl;
+        return false;
+        }
+      }
+
+    for (int z = 0; z < dims[2]; z++)
+      {
+      for (int y = 0; y < dims[1]; y++)
+        {
+        for (int x = 0; x < dims[0]; x++)
+          {
+          // the voxel must be at the center of the input block
+          int id[3] = { x, y, z };
+          for (int i = 0; i < 3; i++)
+            {
+            double point = output->GetOrigin()[i] +
+              output->GetSpacing()[i]*(extent[2*i] + id[i]);
+            double center = image->GetOrigin()[i] + image->GetSpacing()[i]*
+              (inExt[2*i] + id[i]*block[i] + 0.5*(block[i] - 1));
+            if (std::fabs(point - center) > 1e-9)
+              {
+              cerr << what << ": voxel " << x << " " << y << " " << z
+                   << " of level " << level << " is misplaced" << endl;
+              return false;
+              }
+            }
+
+          // integer data is rounded at every level
+          for (int c = 0; c < 2; c++)
+            {
+            double expected = Reference(prev, id, c, weights);
+            double value = output->GetScalarComponentAsDouble(
+              x + extent[0], y + extent[2], z + extent[4], c);
+            double tol = (isFloat ? 1e-3 : 0.5 + 1e-9);
+            if (std::fabs(value - expected) > tol)
+              {
+              cerr << what << ": " << value << " instead of " << expected
+                   << " at level " << level << endl;
+              return false;
+              }
+            }
+          }
+        }
+      }
+
+    prev = output;
+    }
+  return true;
+}
+
+// An antialiased Lanczos kernel is symmetric about the new voxels and
+// sums to one, so it must reproduce a ramp where it does not reach the
+// edges.
+bool CheckSinc()
+{
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 39, 0, 29, 0, 19);
+  image->AllocateScalars(VTK_FLOAT, 1);
+  float *ptr = static_cast<float *>(image->GetScalarPointer());
+  for (int z = 0; z < 20; z++)
+    {
+    for (int y = 0; y < 30; y++)
+      {
+      for (int x = 0; x < 40; x++)
+        {
+        *ptr++ = static_cast<float>(x + 2*y + 3*z);
+        }
+      }
+    }
+
+  vtkNew<vtkImageSincInterpolator> sinc;
+  sinc->SetWindowFunctionToLanczos();
+  sinc->SetWindowHalfWidth(3);
+  sinc->AntialiasingOn();
+  vtkNew<vtkImagePyramid> pyramid;
+  pyramid->SetNumberOfLevels(2);
+  pyramid->SetInterpolator(sinc.GetPointer());
+  pyramid->SetInputData(image.GetPointer());
+  pyramid->Update();
+
+  vtkImageData *output = pyramid->GetOutput(1);
+  int *dims = image->GetDimensions();
+  int *extent = output->GetExtent();
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      for (int x = extent[0]; x <= extent[1]; x++)
+        {
+        double p[3] = { 2*x + 0.5, 2*y + 0.5, 2*z + 0.5 };
+        bool inside = true;
+        for (int i = 0; i < 3; i++)
+          {
+          inside &= (p[i] >= 6.0 && p[i] <= dims[i] - 7.0);
+          }
+        double value = output->GetScalarComponentAsDouble(x, y, z, 0);
+        double expected = p[0] + 2*p[1] + 3*p[2];
+        if (inside && std::fabs(value - expected) > 1e-3)
+          {
+          cerr << "Sinc: " << value << " instead of " << expected
+               << " at " << x << " " << y << " " << z << endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+}
+
+int TestImagePyramid(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  const int volume[6] = { 3, 39, -2, 19, 1, 11 };
+  const int slice[6] = { 0, 64, 0, 33, 5, 5 };
+  const int types[3] = { VTK_FLOAT, VTK_SHORT, VTK_LONG_LONG };
+
+  vtkNew<vtkImageInterpolator> cubic;
+  cubic->SetInterpolationModeToCubic();
+
+  bool success = true;
+  for (int t = 0; success && t < 3; t++)
+    {
+    vtkNew<vtkImageData> image;
+    MakeImage(image.GetPointer(), volume, types[t]);
+    vtkNew<vtkImageData> image2D;
+    MakeImage(image2D.GetPointer(), slice, types[t]);
+
+    success = (Check(image.GetPointer(), NULL, LinearWeights, "Volume") &&
+               Check(image2D.GetPointer(), NULL, LinearWeights, "Slice") &&
+               Check(image.GetPointer(), cubic.GetPointer(), CubicWeights,
+                     "Cubic volume") &&
+               Check(image2D.GetPointer(), cubic.GetPointer(), CubicWeights,
+                     "Cubic slice"));
+    }
+
+  success = success && CheckSinc();
+
+  return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,221 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageRankSelector.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the rank statistics of vtkImageRankSelector (through
+// vtkImageMedian3D, vtkImageRange3D and directly) against sorted
+// neighborhoods, for the histogram and the selection algorithms, with NaN
+// values in the float data.
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkImageEllipsoidSource.h"
+#include "vtkImageMedian3D.h"
+#include "vtkImageRange3D.h"
+#include "vtkImageRankSelector.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+const int Extent[6] = { -2, 20, 0, 14, 3, 11 };
+
+void MakeImage(vtkImageData *image, int type, int nc)
+{
+  image->SetExtent(const_cast<int *>(Extent));
+  image->AllocateScalars(type, nc);
+  vtkDataArray *array = image->GetPointData()->GetScalars();
+  for (vtkIdType i = 0; i < array->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < nc; c++)
+      {
+      // a few repeated values, and negative ones for signed types
+      double v = ((i*7919 + c*31)%211) - 50;
+      if (type == VTK_UNSIGNED_CHAR || type == VTK_UNSIGNED_SHORT)
+        {
+        v += 50;
+        }
+      else if (type == VTK_FLOAT)
+        {
+        v = (i % 37 == 5 ? std::sqrt(-1.0) : 0.25*v);
+        }
+      else if (type == VTK_SHORT)
+        {
+        v *= 97;
+        }
+      array->SetComponent(i, c, v);
+      }
+    }
+}
+
+// The order of the samples, with NaN after all the numbers.
+bool Less(double a, double b)
+{
+  return (a < b || (a == a && b != b));
+}
+
+bool Same(double a, double b)
+{
+  return (a == b || (a != a && b != b));
+}
+
+// The sorted samples of the neighborhood of (x,y,z), clipped at the extent,
+// and the last sample visited in x, y, z order.
+std::vector<double> Neighborhood(vtkImageData *image, int x, int y, int z,
+                                 int c, const int size[3],
+                                 const unsigned char *mask, double *last)
+{
+  std::vector<double> values;
+  for (int k = 0; k < size[2]; k++)
+    {
+    for (int j = 0; j < size[1]; j++)
+      {
+      for (int i = 0; i < size[0]; i++)
+        {
+        int p[3] = { x + i - size[0]/2, y + j - size[1]/2, z + k - size[2]/2 };
+        bool center = (i == size[0]/2 && j == size[1]/2 && k == size[2]/2);
+        if (p[0] < Extent[0] || p[0] > Extent[1] ||
+            p[1] < Extent[2] || p[1] > Extent[3] ||
+            p[2] < Extent[4] || p[2] > Extent[5] ||
+            (mask && !center && !mask[(k*size[1] + j)*size[0] + i]))
+          {
+          continue;
+          }
+        values.push_back(image->GetScalarComponentAsDouble(p[0], p[1], p[2],
+                                                           c));
+        }
+      }
+    }
+  *last = values.back();
+  std::sort(values.begin(), values.end(), Less);
+  return values;
+}
+
+// Compare output with the statistic of the sorted neighborhoods.
+bool Compare(vtkImageData *input, vtkImageData *output, const int size[3],
+             const unsigned char *mask, int statistic, double percentile,
+             const char *what)
+{
+  int nc = input->GetNumberOfScalarComponents();
+  for (int z = Extent[4]; z <= Extent[5]; z++)
+    {
+    for (int y = Extent[2]; y <= Extent[3]; y++)
+      {
+      for (int x = Extent[0]; x <= Extent[1]; x++)
+        {
+        for (int c = 0; c < nc; c++)
+          {
+          double last;
+          std::vector<double> v =
+            Neighborhood(input, x, y, z, c, size, mask, &last);
+          int n = static_cast<int>(v.size());
+          // for an even count, the median of all but the last sample
+          double expected = v[n/2];
+          if (n % 2 == 0 && !Less(last, expected))
+            {
+            expected = v[n/2 - 1];
+            }
+          if (statistic == vtkImageRankSelector::RANGE)
+            {
+            expected = v[n - 1] - v[0];
+            }
+          else if (statistic == vtkImageRankSelector::PERCENTILE)
+            {
+            expected = v[static_cast<int>(percentile*0.01*(n - 1) + 0.5)];
+            }
+          double value = output->GetScalarComponentAsDouble(x, y, z, c);
+          if (!Same(value, expected))
+            {
+            cerr << what << ": wrong value at " << x << " " << y << " " << z
+                 << ": " << value << " instead of " << expected << endl;
+            return false;
+            }
+          }
+        }
+      }
+    }
+  return true;
+}
+}
+
+int TestImageRankSelector(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  // the types of the histogram (8 and 16 bits) and selection algorithms
+  const int types[4] = { VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_UNSIGNED_SHORT,
+                         VTK_FLOAT };
+  // small and large kernels, with an even size
+  const int sizes[2][3] = { { 3, 3, 1 }, { 7, 4, 5 } };
+  for (int t = 0; t < 4; t++)
+    {
+    for (int s = 0; s < 2; s++)
+      {
+      vtkNew<vtkImageData> image;
+      MakeImage(image.GetPointer(), types[t], (s == 0 ? 2 : 1));
+
+      vtkNew<vtkImageMedian3D> median;
+      median->SetInputData(image.GetPointer());
+      median->SetKernelSize(sizes[s][0], sizes[s][1], sizes[s][2]);
+      median->Update();
+      if (!Compare(image.GetPointer(), median->GetOutput(), sizes[s], 0,
+                   vtkImageRankSelector::MEDIAN, 0.0, "vtkImageMedian3D"))
+        {
+        return EXIT_FAILURE;
+        }
+
+      vtkNew<vtkImageRange3D> range;
+      range->SetInputData(image.GetPointer());
+      range->SetKernelSize(sizes[s][0], sizes[s][1], sizes[s][2]);
+      range->Update();
+      vtkNew<vtkImageEllipsoidSource> ellipse;
+      ellipse->SetWholeExtent(0, sizes[s][0] - 1, 0, sizes[s][1] - 1,
+                              0, sizes[s][2] - 1);
+      ellipse->SetCenter(0.5*(sizes[s][0] - 1), 0.5*(sizes[s][1] - 1),
+                         0.5*(sizes[s][2] - 1));
+      ellipse->SetRadius(0.5*sizes[s][0], 0.5*sizes[s][1],
+                         0.5*sizes[s][2]);
+      ellipse->Update();
+      if (!Compare(image.GetPointer(), range->GetOutput(), sizes[s],
+                   static_cast<unsigned char *>(
+                     ellipse->GetOutput()->GetScalarPointer()),
+                   vtkImageRankSelector::RANGE, 0.0, "vtkImageRange3D"))
+        {
+        return EXIT_FAILURE;
+        }
+
+      // a percentile, directly
+      vtkNew<vtkImageData> output;
+      output->SetExtent(const_cast<int *>(Extent));
+      output->AllocateScalars(types[t], image->GetNumberOfScalarComponents());
+      int middle[3] = { sizes[s][0]/2, sizes[s][1]/2, sizes[s][2]/2 };
+      vtkImageRankSelector selector;
+      selector.SetKernel(sizes[s], middle);
+      selector.SetStatistic(vtkImageRankSelector::PERCENTILE);
+      selector.SetPercentile(80.0);
+      selector.SetWholeExtent(Extent);
+      if (!selector.Execute(median.GetPointer(), image.GetPointer(),
+                            image->GetPointData()->GetScalars(),
+                            output.GetPointer(), Extent, 0) ||
+          !Compare(image.GetPointer(), output.GetPointer(), sizes[s], 0,
+                   vtkImageRankSelector::PERCENTILE, 80.0, "Percentile"))
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
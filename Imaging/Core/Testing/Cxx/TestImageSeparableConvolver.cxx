@@ -0,0 +1,287 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageSeparableConvolver.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks vtkImageGaussianSmooth (kernels clipped and renormalized at the
+// boundaries) and vtkImageSeparableConvolution (edges replicated) against
+// a direct computation of the 3D convolution. Also checks that
+// vtkImageSeparableConvolver keeps the center of even kernels at
+// (size - 1)/2, and that vtkImageSeparableConvolution still rejects them.
+
+#include "vtkCommand.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkImageGaussianSmooth.h"
+#include "vtkImageSeparableConvolution.h"
+#include "vtkImageSeparableConvolver.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkTestErrorObserver.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+const int Size[3] = { 23, 17, 9 };
+
+// An image with varied values, nc components.
+void MakeImage(vtkImageData* image, int nc)
+{
+  image->SetExtent(0, Size[0] - 1, 0, Size[1] - 1, 0, Size[2] - 1);
+  image->AllocateScalars(VTK_FLOAT, nc);
+  float* ptr = static_cast<float*>(image->GetScalarPointer());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints()*nc; i++)
+    {
+    ptr[i] = static_cast<float>((i*7919)%101) - 50.0f;
+    }
+}
+
+// The weights of input samples 0..n-1 for output sample i.
+typedef std::vector<double> Weights;
+
+Weights GaussianWeights(int i, int n, double sd, int radius)
+{
+  Weights w(n, 0.0);
+  double sum = 0.0;
+  for (int j = i - radius; j <= i + radius; j++)
+    {
+    if (j >= 0 && j < n)
+      {
+      w[j] = exp(-static_cast<double>((j - i)*(j - i))/(2.0*sd*sd));
+      sum += w[j];
+      }
+    }
+  for (int j = 0; j < n; j++)
+    {
+    w[j] /= sum;
+    }
+  return w;
+}
+
+Weights ReplicateWeights(int i, int n, const std::vector<double>& kernel)
+{
+  Weights w(n, 0.0);
+  int size = static_cast<int>(kernel.size());
+  int center = (size - 1)/2;
+  // a convolution: output i gets input m with kernel[center + i - m]
+  for (int m = i - center; m <= i + center; m++)
+    {
+    int clamped = (m < 0 ? 0 : (m >= n ? n - 1 : m));
+    w[clamped] += kernel[center + i - m];
+    }
+  return w;
+}
+
+// The weights of input samples 0..n-1 for output sample i of
+// vtkImageSeparableConvolver, which correlates, replicating the edges.
+Weights CorrelationWeights(int i, int n, const std::vector<double>& kernel)
+{
+  Weights w(n, 0.0);
+  int size = static_cast<int>(kernel.size());
+  int center = (size - 1)/2;
+  for (int k = 0; k < size; k++)
+    {
+    int m = i + k - center;
+    int clamped = (m < 0 ? 0 : (m >= n ? n - 1 : m));
+    w[clamped] += kernel[k];
+    }
+  return w;
+}
+
+// Compare the output over the given extent, or over the whole image.
+bool Compare(vtkImageData* input, vtkImageData* output,
+             std::vector<Weights> weights[3], const char* name,
+             const int* extent = 0)
+{
+  int whole[6] = { 0, Size[0] - 1, 0, Size[1] - 1, 0, Size[2] - 1 };
+  if (!extent)
+    {
+    extent = whole;
+    }
+  int nc = input->GetNumberOfScalarComponents();
+  float* in = static_cast<float*>(input->GetScalarPointer());
+  float* out = static_cast<float*>(output->GetScalarPointer());
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      for (int x = extent[0]; x <= extent[1]; x++)
+        {
+        for (int c = 0; c < nc; c++)
+          {
+          double expected = 0.0;
+          for (int k = 0; k < Size[2]; k++)
+            {
+            for (int j = 0; j < Size[1]; j++)
+              {
+              double wyz = weights[2][z][k]*weights[1][y][j];
+              if (wyz == 0.0)
+                {
+                continue;
+                }
+              for (int i = 0; i < Size[0]; i++)
+                {
+                expected += wyz*weights[0][x][i]*
+                  in[((k*Size[1] + j)*Size[0] + i)*nc + c];
+                }
+              }
+            }
+          double value = out[((z*Size[1] + y)*Size[0] + x)*nc + c];
+          if (fabs(value - expected) > 1e-3*(1.0 + fabs(expected)))
+            {
+            cerr << name << ": wrong value at " << x << " " << y << " "
+                 << z << ": " << value << " instead of " << expected << endl;
+            return false;
+            }
+          }
+        }
+      }
+    }
+  return true;
+}
+}
+
+int TestImageSeparableConvolver(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  // Gaussian smoothing, with several components and a kernel larger than
+  // the image along z
+  vtkNew<vtkImageData> image;
+  MakeImage(image.GetPointer(), 3);
+  double sd[3] = { 1.5, 2.5, 4.0 };
+  vtkNew<vtkImageGaussianSmooth> gaussian;
+  gaussian->SetInputData(image.GetPointer());
+  gaussian->SetStandardDeviations(sd);
+  gaussian->SetRadiusFactors(1.5, 1.5, 3.0);
+  gaussian->Update();
+
+  std::vector<Weights> weights[3];
+  for (int axis = 0; axis < 3; axis++)
+    {
+    int radius = static_cast<int>(sd[axis]*gaussian->GetRadiusFactors()[axis]);
+    for (int i = 0; i < Size[axis]; i++)
+      {
+      weights[axis].push_back(
+        GaussianWeights(i, Size[axis], sd[axis], radius));
+      }
+    }
+  if (!Compare(image.GetPointer(), gaussian->GetOutput(), weights,
+               "vtkImageGaussianSmooth"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // The same with small pieces
+  gaussian->EnableSMPOn();
+  gaussian->SetSplitModeToBlock();
+  gaussian->SetDesiredBytesPerPiece(1024);
+  gaussian->Update();
+  if (!Compare(image.GetPointer(), gaussian->GetOutput(), weights,
+               "vtkImageGaussianSmooth (SMP)"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Separable convolution with non symmetric kernels, the z kernel being
+  // larger than the image
+  vtkNew<vtkImageData> scalar;
+  MakeImage(scalar.GetPointer(), 1);
+  vtkNew<vtkFloatArray> kernels[3];
+  int sizes[3] = { 5, 3, 21 };
+  std::vector<double> values[3];
+  for (int axis = 0; axis < 3; axis++)
+    {
+    for (int i = 0; i < sizes[axis]; i++)
+      {
+      values[axis].push_back(1.0 + i*(axis + 1) % 4);
+      kernels[axis]->InsertNextValue(values[axis][i]);
+      }
+    weights[axis].clear();
+    for (int i = 0; i < Size[axis]; i++)
+      {
+      weights[axis].push_back(
+        ReplicateWeights(i, Size[axis], values[axis]));
+      }
+    }
+  vtkNew<vtkImageSeparableConvolution> convolution;
+  convolution->SetInputData(scalar.GetPointer());
+  convolution->SetXKernel(kernels[0].GetPointer());
+  convolution->SetYKernel(kernels[1].GetPointer());
+  convolution->SetZKernel(kernels[2].GetPointer());
+  convolution->Update();
+  if (!Compare(scalar.GetPointer(), convolution->GetOutput(), weights,
+               "vtkImageSeparableConvolution"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Even kernels, given to the convolver directly, for a piece of the
+  // image: the input only covers the piece grown by size/2 samples
+  int evenSizes[3] = { 4, 6, 2 };
+  int piece[6] = { 5, 15, 4, 11, 3, 6 };
+  int inExt[6];
+  int wholeExt[6] = { 0, Size[0] - 1, 0, Size[1] - 1, 0, Size[2] - 1 };
+  vtkImageSeparableConvolver convolver;
+  convolver.SetWholeExtent(wholeExt);
+  convolver.SetBoundaryMode(vtkImageSeparableConvolver::REPLICATE);
+  for (int axis = 0; axis < 3; axis++)
+    {
+    values[axis].clear();
+    for (int i = 0; i < evenSizes[axis]; i++)
+      {
+      values[axis].push_back(1.0 + (i*(axis + 2)) % 5);
+      }
+    convolver.SetKernel(axis, &values[axis][0], evenSizes[axis]);
+    weights[axis].clear();
+    for (int i = 0; i < Size[axis]; i++)
+      {
+      weights[axis].push_back(
+        CorrelationWeights(i, Size[axis], values[axis]));
+      }
+    int radius = evenSizes[axis]/2;
+    inExt[2*axis] = (piece[2*axis] - radius > 0 ?
+                     piece[2*axis] - radius : 0);
+    inExt[2*axis+1] = (piece[2*axis+1] + radius < Size[axis] - 1 ?
+                       piece[2*axis+1] + radius : Size[axis] - 1);
+    }
+  vtkNew<vtkImageData> cropped;
+  cropped->SetExtent(inExt);
+  cropped->AllocateScalars(VTK_FLOAT, 1);
+  cropped->CopyAndCastFrom(scalar.GetPointer(), inExt);
+  vtkNew<vtkImageData> convolved;
+  convolved->SetExtent(wholeExt);
+  convolved->AllocateScalars(VTK_FLOAT, 1);
+  if (!convolver.Execute(convolution.GetPointer(), cropped.GetPointer(),
+                         convolved.GetPointer(), piece, 0) ||
+      !Compare(scalar.GetPointer(), convolved.GetPointer(), weights,
+               "vtkImageSeparableConvolver (even kernels)", piece))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // The filter reports even kernels as errors, as it always did
+  vtkNew<vtkTest::ErrorObserver> errorObserver;
+  convolution->AddObserver(vtkCommand::ErrorEvent,
+                           errorObserver.GetPointer());
+  kernels[0]->InsertNextValue(1.0f);
+  convolution->Modified();
+  convolution->Update();
+  if (!errorObserver->GetError())
+    {
+    cerr << "vtkImageSeparableConvolution: no error for an even kernel"
+         << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
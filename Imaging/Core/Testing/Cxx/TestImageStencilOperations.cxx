@@ -0,0 +1,349 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageStencilOperations.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the copy, Add, Subtract, Replace, Clip and RemoveExtent operations
+// of vtkImageStencilData against voxel masks, through IsInside() and
+// vtkImageStencilIterator, and the rasterization of a closed box by
+// vtkPolyDataToImageStencil.
+
+#include "vtkCellArray.h"
+#include "vtkImageData.h"
+#include "vtkImageStencilData.h"
+#include "vtkImageStencilIterator.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataToImageStencil.h"
+
+#include <vector>
+
+namespace
+{
+// The box in which the masks are defined, larger than all the stencils.
+const int Bounds[6] = { -8, 50, -8, 26, -2, 16 };
+
+class Mask
+{
+public:
+  Mask() : Values(static_cast<size_t>(59*35*19), false) {}
+
+  std::vector<bool>::reference operator()(int x, int y, int z)
+  {
+    return this->Values[((z - Bounds[4])*35 + (y - Bounds[2]))*59 +
+                        (x - Bounds[0])];
+  }
+
+  std::vector<bool> Values;
+};
+
+bool Inside(const int extent[6], int x, int y, int z)
+{
+  return (x >= extent[0] && x <= extent[1] && y >= extent[2] &&
+          y <= extent[3] && z >= extent[4] && z <= extent[5]);
+}
+
+// Fill a stencil with random extents, with empty rows and full rows.
+void MakeStencil(vtkImageStencilData *stencil, const int extent[6],
+                 unsigned int seed, Mask& mask)
+{
+  stencil->SetExtent(const_cast<int *>(extent));
+  stencil->AllocateExtents();
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      seed = seed*1664525u + 1013904223u;
+      unsigned int row = (seed >> 16) % 8;
+      if (row == 0)
+        {
+        continue;
+        }
+      int x = extent[0] + static_cast<int>((seed >> 8) % 4);
+      if (row == 1)
+        {
+        x = extent[0];
+        }
+      while (x <= extent[1])
+        {
+        seed = seed*1664525u + 1013904223u;
+        int r2 = x + static_cast<int>((seed >> 16) % 6);
+        if (row == 1 || r2 > extent[1])
+          {
+          r2 = extent[1];
+          }
+        stencil->InsertNextExtent(x, r2, y, z);
+        for (int i = x; i <= r2; i++)
+          {
+          mask(i, y, z) = true;
+          }
+        x = r2 + 2 + static_cast<int>((seed >> 8) % 5);
+        }
+      }
+    }
+}
+
+bool Compare(vtkImageStencilData *stencil, Mask& mask, const char *what)
+{
+  for (int z = Bounds[4]; z <= Bounds[5]; z++)
+    {
+    for (int y = Bounds[2]; y <= Bounds[3]; y++)
+      {
+      for (int x = Bounds[0]; x <= Bounds[1]; x++)
+        {
+        if ((stencil->IsInside(x, y, z) != 0) != mask(x, y, z))
+          {
+          cerr << what << ": wrong voxel " << x << " " << y << " " << z
+               << endl;
+          return false;
+          }
+        }
+      }
+    }
+
+  // the iterator must see the same voxels
+  int extent[6];
+  stencil->GetExtent(extent);
+  vtkNew<vtkImageData> image;
+  image->SetExtent(extent);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char *base =
+    static_cast<unsigned char *>(image->GetScalarPointer());
+  vtkImageStencilIterator<unsigned char> iter(image.GetPointer(), stencil,
+                                              extent);
+  int dims[3];
+  image->GetDimensions(dims);
+  while (!iter.IsAtEnd())
+    {
+    for (unsigned char *ptr = iter.BeginSpan(); ptr != iter.EndSpan(); ptr++)
+      {
+      vtkIdType i = ptr - base;
+      int x = extent[0] + static_cast<int>(i % dims[0]);
+      int y = extent[2] + static_cast<int>((i / dims[0]) % dims[1]);
+      int z = extent[4] + static_cast<int>(i / (dims[0]*dims[1]));
+      if (iter.IsInStencil() != mask(x, y, z))
+        {
+        cerr << what << ": wrong span at " << x << " " << y << " " << z
+             << endl;
+        return false;
+        }
+      }
+    iter.NextSpan();
+    }
+  return true;
+}
+
+// Rasterize a closed box made of quads, with faces between the voxels.
+bool CheckRasterizer()
+{
+  const double lo[3] = { 2.3, 3.6, 1.2 };
+  const double hi[3] = { 10.7, 12.4, 8.8 };
+  vtkNew<vtkPoints> points;
+  for (int i = 0; i < 8; i++)
+    {
+    points->InsertNextPoint((i & 1) ? hi[0] : lo[0], (i & 2) ? hi[1] : lo[1],
+                            (i & 4) ? hi[2] : lo[2]);
+    }
+  const vtkIdType faces[6][4] = { { 0, 2, 3, 1 }, { 4, 5, 7, 6 },
+                                  { 0, 1, 5, 4 }, { 2, 6, 7, 3 },
+                                  { 0, 4, 6, 2 }, { 1, 3, 7, 5 } };
+  vtkNew<vtkCellArray> polys;
+  for (int i = 0; i < 6; i++)
+    {
+    polys->InsertNextCell(4, faces[i]);
+    }
+  vtkNew<vtkPolyData> box;
+  box->SetPoints(points.GetPointer());
+  box->SetPolys(polys.GetPointer());
+
+  vtkNew<vtkPolyDataToImageStencil> rasterizer;
+  rasterizer->SetInputData(box.GetPointer());
+  rasterizer->SetOutputWholeExtent(0, 15, 0, 15, 0, 11);
+  rasterizer->Update();
+
+  const int inside[6] = { 3, 10, 4, 12, 2, 8 };
+  Mask mask;
+  for (int z = inside[4]; z <= inside[5]; z++)
+    {
+    for (int y = inside[2]; y <= inside[3]; y++)
+      {
+      for (int x = inside[0]; x <= inside[1]; x++)
+        {
+        mask(x, y, z) = true;
+        }
+      }
+    }
+  return Compare(rasterizer->GetOutput(), mask, "Rasterizer");
+}
+}
+
+int TestImageStencilOperations(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  const int extent1[6] = { 0, 40, -3, 20, 2, 12 };
+  const int extent2[6] = { 5, 30, 0, 15, 4, 10 };
+  const int extent3[6] = { -5, 45, 4, 25, 0, 8 };
+
+  Mask mask1;
+  vtkNew<vtkImageStencilData> stencil1;
+  MakeStencil(stencil1.GetPointer(), extent1, 1u, mask1);
+  Mask mask2;
+  vtkNew<vtkImageStencilData> stencil2;
+  MakeStencil(stencil2.GetPointer(), extent2, 2u, mask2);
+  Mask mask3;
+  vtkNew<vtkImageStencilData> stencil3;
+  MakeStencil(stencil3.GetPointer(), extent3, 3u, mask3);
+  if (!Compare(stencil1.GetPointer(), mask1, "InsertNextExtent"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // a copy, and the lists of a copy can still grow
+  vtkNew<vtkImageStencilData> copy;
+  copy->DeepCopy(stencil1.GetPointer());
+  if (!Compare(copy.GetPointer(), mask1, "DeepCopy"))
+    {
+    return EXIT_FAILURE;
+    }
+  Mask copyMask = mask1;
+  for (int z = extent1[4]; z <= extent1[5]; z++)
+    {
+    for (int i = 0; i < 3; i++)
+      {
+      int r1 = 3 + 13*i;
+      copy->InsertAndMergeExtent(r1, r1 + 1, z + 3, z);
+      copyMask(r1, z + 3, z) = true;
+      copyMask(r1 + 1, z + 3, z) = true;
+      }
+    // split an extent in the middle of a row
+    copy->RemoveExtent(20, 21, 5, z);
+    copyMask(20, 5, z) = false;
+    copyMask(21, 5, z) = false;
+    // remove several neighboring extents at once
+    copy->RemoveExtent(8, 31, 9, z);
+    for (int x = 8; x <= 31; x++)
+      {
+      copyMask(x, 9, z) = false;
+      }
+    }
+  if (!Compare(copy.GetPointer(), copyMask, "InsertAndMergeExtent"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  Mask expected;
+  int x, y, z;
+
+  // add within the extent, then with a larger extent
+  vtkNew<vtkImageStencilData> sum;
+  sum->DeepCopy(copy.GetPointer());
+  sum->Add(stencil2.GetPointer());
+  for (size_t i = 0; i < expected.Values.size(); i++)
+    {
+    expected.Values[i] = copyMask.Values[i] || mask2.Values[i];
+    }
+  if (!Compare(sum.GetPointer(), expected, "Add"))
+    {
+    return EXIT_FAILURE;
+    }
+  sum->Add(stencil3.GetPointer());
+  for (size_t i = 0; i < expected.Values.size(); i++)
+    {
+    expected.Values[i] = expected.Values[i] || mask3.Values[i];
+    }
+  if (!Compare(sum.GetPointer(), expected, "Add (larger extent)"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // subtract
+  vtkNew<vtkImageStencilData> difference;
+  difference->DeepCopy(copy.GetPointer());
+  difference->Subtract(stencil3.GetPointer());
+  for (size_t i = 0; i < expected.Values.size(); i++)
+    {
+    expected.Values[i] = copyMask.Values[i] && !mask3.Values[i];
+    }
+  if (!Compare(difference.GetPointer(), expected, "Subtract"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // the rows that were rebuilt in place can still grow
+  for (z = extent1[4]; z <= extent1[5]; z++)
+    {
+    for (x = 1; x < 40; x += 3)
+      {
+      difference->InsertAndMergeExtent(x, x, 6, z);
+      expected(x, 6, z) = true;
+      }
+    }
+  if (!Compare(difference.GetPointer(), expected, "Subtract, then insert"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // replace within the intersection of the extents
+  vtkNew<vtkImageStencilData> replaced;
+  replaced->DeepCopy(stencil1.GetPointer());
+  replaced->Replace(stencil3.GetPointer());
+  for (z = Bounds[4]; z <= Bounds[5]; z++)
+    {
+    for (y = Bounds[2]; y <= Bounds[3]; y++)
+      {
+      for (x = Bounds[0]; x <= Bounds[1]; x++)
+        {
+        expected(x, y, z) = ((Inside(extent1, x, y, z) &&
+                              Inside(extent3, x, y, z)) ?
+                             mask3(x, y, z) : mask1(x, y, z));
+        }
+      }
+    }
+  if (!Compare(replaced.GetPointer(), expected, "Replace"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // clip, which keeps the extent
+  int clipExtent[6] = { 7, 33, -1, 9, 0, 10 };
+  vtkNew<vtkImageStencilData> clipped;
+  clipped->DeepCopy(copy.GetPointer());
+  if (!clipped->Clip(clipExtent))
+    {
+    cerr << "Clip did not report a change" << endl;
+    return EXIT_FAILURE;
+    }
+  for (z = Bounds[4]; z <= Bounds[5]; z++)
+    {
+    for (y = Bounds[2]; y <= Bounds[3]; y++)
+      {
+      for (x = Bounds[0]; x <= Bounds[1]; x++)
+        {
+        expected(x, y, z) = (copyMask(x, y, z) &&
+                             Inside(clipExtent, x, y, z));
+        }
+      }
+    }
+  if (!Compare(clipped.GetPointer(), expected, "Clip"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // the original stencils are unchanged
+  if (!Compare(stencil1.GetPointer(), mask1, "Unchanged stencil") ||
+      !Compare(stencil3.GetPointer(), mask3, "Unchanged stencil"))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return (CheckRasterizer() ? EXIT_SUCCESS : EXIT_FAILURE);
+}
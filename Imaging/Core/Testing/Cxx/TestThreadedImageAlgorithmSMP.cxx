@@ -0,0 +1,153 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestThreadedImageAlgorithmSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the SMP execution of vtkThreadedImageAlgorithm, in all the
+// split modes, gives the same output as the vtkMultiThreader execution,
+// also for vtkImageBSplineCoefficients, which overrides SplitExtent, and
+// for vtkImageBlend, which iterates over pieces cropped in x with a
+// vtkImageStencilIterator.
+
+#include "vtkDataArray.h"
+#include "vtkImageBlend.h"
+#include "vtkImageData.h"
+#include "vtkImageDifference.h"
+#include "vtkImageBSplineCoefficients.h"
+#include "vtkImageGaussianSource.h"
+#include "vtkImageReslice.h"
+#include "vtkImageShiftScale.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkTransform.h"
+
+namespace
+{
+bool SameScalars(vtkImageData* a, vtkImageData* b)
+{
+  vtkDataArray* sa = a->GetPointData()->GetScalars();
+  vtkDataArray* sb = b->GetPointData()->GetScalars();
+  if (!sa || !sb || sa->GetNumberOfTuples() != sb->GetNumberOfTuples() ||
+      sa->GetNumberOfTuples() == 0)
+    {
+    return false;
+    }
+  for (vtkIdType i = 0; i < sa->GetNumberOfTuples(); i++)
+    {
+    if (sa->GetComponent(i, 0) != sb->GetComponent(i, 0))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// Run the filter in both modes on an image of the given size, and compare.
+// The image is connected to the filter numberOfInputs times.
+bool TestFilter(vtkThreadedImageAlgorithm* filter, int nx, int ny, int nz,
+                int numberOfInputs = 1)
+{
+  vtkNew<vtkImageGaussianSource> source;
+  source->SetWholeExtent(0, nx - 1, 0, ny - 1, 0, nz - 1);
+  source->SetCenter(nx / 3.0, ny / 2.0, nz / 2.0);
+  source->SetMaximum(255.0);
+  source->SetStandardDeviation(nx / 4.0);
+  filter->SetInputConnection(source->GetOutputPort());
+  for (int i = 1; i < numberOfInputs; i++)
+    {
+    filter->AddInputConnection(source->GetOutputPort());
+    }
+
+  filter->EnableSMPOff();
+  filter->Update();
+  vtkNew<vtkImageData> expected;
+  expected->DeepCopy(filter->GetOutput());
+
+  filter->EnableSMPOn();
+  filter->SetDesiredBytesPerPiece(512);
+  for (int mode = vtkThreadedImageAlgorithm::SLAB;
+       mode <= vtkThreadedImageAlgorithm::BLOCK; mode++)
+    {
+    filter->SetSplitMode(mode);
+    filter->Modified();
+    filter->Update();
+    if (!SameScalars(expected.GetPointer(), filter->GetOutput()))
+      {
+      cerr << filter->GetClassName() << ": wrong output in split mode "
+           << mode << " for a " << nx << "x" << ny << "x" << nz
+           << " image" << endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int TestThreadedImageAlgorithmSMP(int vtkNotUsed(argc),
+                                  char *vtkNotUsed(argv)[])
+{
+  if (vtkThreadedImageAlgorithm::GetGlobalDefaultEnableSMP())
+    {
+    cerr << "SMP should be off by default" << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkImageShiftScale> shiftScale;
+  shiftScale->SetShift(-10.0);
+  shiftScale->SetScale(0.5);
+  shiftScale->SetOutputScalarTypeToShort();
+
+  vtkNew<vtkTransform> rotation;
+  rotation->Translate(20.0, 15.0, 5.0);
+  rotation->RotateZ(30.0);
+  rotation->Translate(-20.0, -15.0, -5.0);
+  vtkNew<vtkImageReslice> reslice;
+  reslice->SetResliceTransform(rotation.GetPointer());
+  reslice->SetInterpolationModeToLinear();
+
+  // this filter must not be split along the axis that it is processing
+  vtkNew<vtkImageBSplineCoefficients> coefficients;
+  coefficients->SetSplineDegree(3);
+
+  // the pieces must be cropped in x and span several slices, so that the
+  // stencil iterator has to step to the next slice of a cropped extent
+  vtkNew<vtkImageBlend> blend;
+  blend->SetOpacity(1, 0.5);
+  blend->SetMinimumPieceSize(16, 1, 5);
+
+  // the errors of this filter are accumulated per thread
+  vtkNew<vtkImageDifference> difference;
+  difference->EnableSMPOn();
+  if (difference->GetEnableSMP())
+    {
+    cerr << "SMP should not be enabled for vtkImageDifference" << endl;
+    return EXIT_FAILURE;
+    }
+
+  int sizes[3][3] = { { 40, 30, 10 }, { 70, 50, 1 }, { 200, 1, 1 } };
+  for (int i = 0; i < 3; i++)
+    {
+    if (!TestFilter(shiftScale.GetPointer(),
+                    sizes[i][0], sizes[i][1], sizes[i][2]) ||
+        !TestFilter(reslice.GetPointer(),
+                    sizes[i][0], sizes[i][1], sizes[i][2]) ||
+        !TestFilter(coefficients.GetPointer(),
+                    sizes[i][0], sizes[i][1], sizes[i][2]) ||
+        !TestFilter(blend.GetPointer(),
+                    sizes[i][0], sizes[i][1], sizes[i][2], 2))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
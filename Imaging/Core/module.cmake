@@ -18,7 +18,9 @@ vtk_module(vtkImagingCore
     vtkInteractionImage
     vtkImagingMath # Move tests
     vtkImagingStencil # Move tests
+    vtkImagingFourier # Move tests
     vtkImagingGeneral # Move tests
+    vtkImagingMorphological # Move tests
     vtkImagingSources
     vtkImagingStatistics # Move tests
     vtkRenderingImage # Move tests
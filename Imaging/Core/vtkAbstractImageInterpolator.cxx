@@ -85,6 +85,8 @@ vtkAbstractImageInterpolator::vtkAbstractImageInterpolator()
     &(vtkInterpolateNOP<double>::InterpolationFunc);
   this->InterpolationFuncFloat =
     &(vtkInterpolateNOP<float>::InterpolationFunc);
+  this->BatchInterpolationFuncDouble = NULL;
+  this->BatchInterpolationFuncFloat = NULL;
   this->RowInterpolationFuncDouble =
     &(vtkInterpolateNOP<double>::RowInterpolationFunc);
   this->RowInterpolationFuncFloat =
@@ -301,6 +303,8 @@ void vtkAbstractImageInterpolator::Update()
       &(vtkInterpolateNOP<double>::InterpolationFunc);
     this->InterpolationFuncFloat =
       &(vtkInterpolateNOP<float>::InterpolationFunc);
+    this->BatchInterpolationFuncDouble = NULL;
+    this->BatchInterpolationFuncFloat = NULL;
     this->RowInterpolationFuncDouble =
       &(vtkInterpolateNOP<double>::RowInterpolationFunc);
     this->RowInterpolationFuncFloat =
@@ -380,6 +384,10 @@ void vtkAbstractImageInterpolator::Update()
   // get the functions that will perform the interpolation
   this->GetInterpolationFunc(&this->InterpolationFuncDouble);
   this->GetInterpolationFunc(&this->InterpolationFuncFloat);
+  this->BatchInterpolationFuncDouble = NULL;
+  this->BatchInterpolationFuncFloat = NULL;
+  this->GetBatchInterpolationFunc(&this->BatchInterpolationFuncDouble);
+  this->GetBatchInterpolationFunc(&this->BatchInterpolationFuncFloat);
   this->GetRowInterpolationFunc(&this->RowInterpolationFuncDouble);
   this->GetRowInterpolationFunc(&this->RowInterpolationFuncFloat);
 }
@@ -454,6 +462,18 @@ void vtkAbstractImageInterpolator::GetInterpolationFunc(
 {
 }
 
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::GetBatchInterpolationFunc(
+  void (**)(vtkInterpolationInfo *, const double *, double *, int))
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkAbstractImageInterpolator::GetBatchInterpolationFunc(
+  void (**)(vtkInterpolationInfo *, const float *, float *, int))
+{
+}
+
 //----------------------------------------------------------------------------
 void vtkAbstractImageInterpolator::GetRowInterpolationFunc(
   void (**)(vtkInterpolationWeights *, int, int, int, double *, int))
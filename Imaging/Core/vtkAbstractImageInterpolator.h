@@ -128,6 +128,15 @@ public:
   void InterpolateIJK(const double point[3], double *value);
   void InterpolateIJK(const float point[3], float *value);
 
+  // Description:
+  // Interpolate a row of n points, given as consecutive x,y,z structured
+  // coords, and store the values for each point consecutively.  This is
+  // equivalent to calling InterpolateIJK for each point, but the
+  // interpolators can compute the indices and weights of many points at
+  // once.  The points must have been checked with CheckBoundsIJK.
+  void InterpolateIJK(const double *points, double *values, int n);
+  void InterpolateIJK(const float *points, float *values, int n);
+
   // Description:
   // Check an x,y,z point to see if it is within the bounds for the
   // structured coords of the image.  This is meant to be called prior
@@ -236,6 +245,16 @@ protected:
     void (**floatfunc)(
       vtkInterpolationInfo *, const float [3], float *));
 
+  // Description:
+  // Get the functions that interpolate many points at once.  These
+  // are optional, the default is to leave the function NULL.
+  virtual void GetBatchInterpolationFunc(
+    void (**doublefunc)(
+      vtkInterpolationInfo *, const double *, double *, int));
+  virtual void GetBatchInterpolationFunc(
+    void (**floatfunc)(
+      vtkInterpolationInfo *, const float *, float *, int));
+
   // Description:
   // Get the row interpolation functions.
   virtual void GetRowInterpolationFunc(
@@ -266,6 +285,11 @@ protected:
   void (*InterpolationFuncFloat)(
     vtkInterpolationInfo *info, const float point[3], float *outPtr);
 
+  void (*BatchInterpolationFuncDouble)(
+    vtkInterpolationInfo *info, const double *points, double *outPtr, int n);
+  void (*BatchInterpolationFuncFloat)(
+    vtkInterpolationInfo *info, const float *points, float *outPtr, int n);
+
   void (*RowInterpolationFuncDouble)(
     vtkInterpolationWeights *weights, int idX, int idY, int idZ,
     double *outPtr, int n);
@@ -291,6 +315,42 @@ inline void vtkAbstractImageInterpolator::InterpolateIJK(
   this->InterpolationFuncFloat(this->InterpolationInfo, point, value);
 }
 
+inline void vtkAbstractImageInterpolator::InterpolateIJK(
+  const double *points, double *values, int n)
+{
+  if (this->BatchInterpolationFuncDouble)
+    {
+    this->BatchInterpolationFuncDouble(
+      this->InterpolationInfo, points, values, n);
+    return;
+    }
+  int numscalars = this->GetNumberOfComponents();
+  for (int i = 0; i < n; i++)
+    {
+    this->InterpolationFuncDouble(this->InterpolationInfo, points, values);
+    points += 3;
+    values += numscalars;
+    }
+}
+
+inline void vtkAbstractImageInterpolator::InterpolateIJK(
+  const float *points, float *values, int n)
+{
+  if (this->BatchInterpolationFuncFloat)
+    {
+    this->BatchInterpolationFuncFloat(
+      this->InterpolationInfo, points, values, n);
+    return;
+    }
+  int numscalars = this->GetNumberOfComponents();
+  for (int i = 0; i < n; i++)
+    {
+    this->InterpolationFuncFloat(this->InterpolationInfo, points, values);
+    points += 3;
+    values += numscalars;
+    }
+}
+
 inline bool vtkAbstractImageInterpolator::CheckBoundsIJK(const double x[3])
 {
   double *bounds = this->StructuredBoundsDouble;
@@ -0,0 +1,139 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageAxisLines.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageAxisLines - transform all the lines of an image along an axis
+// .SECTION Description
+// This is a private helper of the filters that transform an image one axis
+// at a time, such as vtkImageFourierFilter and vtkImageEuclideanDistance.
+// The image is a contiguous array of Size[0]*Size[1]*Size[2] samples of
+// type T.  Every line along the given axis is copied into a buffer, given
+// to the line operation, and copied back, the lines being processed in
+// parallel with vtkSMPTools.  The lines of axes 1 and 2 are copied in
+// batches of neighbors along x, so that every sample read or written is
+// part of a contiguous run of the batch size.
+//
+// The line operation is called as op(line, n) from several threads at
+// once, and must transform the n samples of the line in place.
+
+#ifndef __vtkImageAxisLines_h
+#define __vtkImageAxisLines_h
+
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+
+#include <vector>
+
+static const int vtkImageAxisLinesBatchSize = 8;
+
+template <class T, class LineOp>
+class vtkImageAxisLinesFunctor
+{
+public:
+  T *Data;
+  int Size[3];
+  int Axis;
+  LineOp *Operation;
+  vtkSMPThreadLocal<std::vector<T> > Lines;
+
+  // The number of batches of lines to process.
+  vtkIdType GetNumberOfBatches() const
+  {
+    if (this->Axis == 0)
+      {
+      return static_cast<vtkIdType>(this->Size[1])*this->Size[2];
+      }
+    int batches = (this->Size[0] + vtkImageAxisLinesBatchSize - 1)/
+      vtkImageAxisLinesBatchSize;
+    return static_cast<vtkIdType>(batches)*this->Size[3 - this->Axis];
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int n = this->Size[this->Axis];
+    int batchSize = (this->Axis == 0 ? 1 : vtkImageAxisLinesBatchSize);
+    std::vector<T>& buffer = this->Lines.Local();
+    buffer.resize(static_cast<size_t>(batchSize)*n);
+    T *lines = &buffer[0];
+    vtkIdType rowSize = this->Size[0];
+    vtkIdType sliceSize = rowSize*this->Size[1];
+
+    if (this->Axis == 0)
+      {
+      for (vtkIdType idx = begin; idx < end; ++idx)
+        {
+        T *row = this->Data + idx*rowSize;
+        for (int k = 0; k < n; ++k)
+          {
+          lines[k] = row[k];
+          }
+        (*this->Operation)(lines, n);
+        for (int k = 0; k < n; ++k)
+          {
+          row[k] = lines[k];
+          }
+        }
+      return;
+      }
+
+    vtkIdType stride = (this->Axis == 1 ? rowSize : sliceSize);
+    vtkIdType otherStride = (this->Axis == 1 ? sliceSize : rowSize);
+    int batches = (this->Size[0] + batchSize - 1)/batchSize;
+    for (vtkIdType idx = begin; idx < end; ++idx)
+      {
+      int x = static_cast<int>(idx % batches)*batchSize;
+      int count = this->Size[0] - x;
+      count = (count < batchSize ? count : batchSize);
+      T *base = this->Data + (idx / batches)*otherStride + x;
+      for (int k = 0; k < n; ++k)
+        {
+        const T *ptr = base + k*stride;
+        for (int b = 0; b < count; ++b)
+          {
+          lines[b*n + k] = ptr[b];
+          }
+        }
+      for (int b = 0; b < count; ++b)
+        {
+        (*this->Operation)(lines + b*n, n);
+        }
+      for (int k = 0; k < n; ++k)
+        {
+        T *ptr = base + k*stride;
+        for (int b = 0; b < count; ++b)
+          {
+          ptr[b] = lines[b*n + k];
+          }
+        }
+      }
+  }
+};
+
+// Transform all the lines of the image along the axis with op.
+template <class T, class LineOp>
+void vtkImageAxisLinesTransform(T *data, const int size[3], int axis,
+                                LineOp *op)
+{
+  vtkImageAxisLinesFunctor<T, LineOp> functor;
+  functor.Data = data;
+  functor.Axis = axis;
+  functor.Operation = op;
+  for (int i = 0; i < 3; ++i)
+    {
+    functor.Size[i] = size[i];
+    }
+  vtkSMPTools::For(0, functor.GetNumberOfBatches(), functor);
+}
+
+#endif
+// VTK-HeaderTest-Exclude: vtkImageAxisLines.h
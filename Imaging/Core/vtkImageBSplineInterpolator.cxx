@@ -261,6 +261,9 @@ struct vtkImageBSplineInterpolate
 {
   static void BSpline(
     vtkInterpolationInfo *info, const F point[3], F *outPtr);
+
+  static void BSplineBatch(
+    vtkInterpolationInfo *info, const F *points, F *outPtr, int n);
 };
 
 //----------------------------------------------------------------------------
@@ -442,6 +445,132 @@ void vtkImageBSplineInterpolate<F, T>::BSpline(
   while (--numscalars);
 }
 
+//----------------------------------------------------------------------------
+// Interpolation of many points at once.  The points whose kernel is
+// entirely within the extent need no border handling, so the kernel is
+// addressed with constant strides, while the other points are interpolated
+// with the point function.  Along an axis with a single sample, the kernel
+// is that single sample, as for the point function, and the points at
+// index 0 are inside.
+template <class F, class T>
+void vtkImageBSplineInterpolate<F, T>::BSplineBatch(
+  vtkInterpolationInfo *info, const F *points, F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+
+#ifdef VTK_BSPLINE_USE_KERNEL_TABLE
+  // kernel lookup table
+  float *kernel = static_cast<float *>(info->ExtraInfo);
+#endif
+
+  // size of kernel is degree of spline plus one
+  int degree = info->InterpolationMode;
+  int m = degree + 1;
+
+  // index to kernel midpoint position
+  int m2 = (degree >> 1);
+
+  // offset for odd-size kernels
+  F offset = 0.5*(m & 1);
+
+  vtkIdType inIncX = inInc[0];
+  vtkIdType inIncY = inInc[1];
+  vtkIdType inIncZ = inInc[2];
+
+  // the degree of the kernel, the first kernel element relative to the
+  // point, and the last index of the first kernel element, for each axis
+  int degrees[3];
+  int shift[3];
+  int maxId[3];
+  for (int a = 0; a < 3; a++)
+    {
+    int single = (inExt[2*a] == inExt[2*a + 1]);
+    degrees[a] = (single ? 0 : degree);
+    shift[a] = (single ? 0 : m2);
+    maxId[a] = inExt[2*a + 1] - inExt[2*a] - degrees[a];
+    }
+  int mX = degrees[0] + 1;
+  int mY = degrees[1] + 1;
+  int mZ = degrees[2] + 1;
+
+  F fX[VTK_BSPLINE_KERNEL_SIZE_MAX];
+  F fY[VTK_BSPLINE_KERNEL_SIZE_MAX];
+  F fZ[VTK_BSPLINE_KERNEL_SIZE_MAX];
+
+  for (int i = 0; i < n; i++)
+    {
+    const F *point = points + 3*i;
+    F fx, fy, fz;
+    int inIdX0 = vtkInterpolationMath::Floor(point[0] + offset, fx);
+    int inIdY0 = vtkInterpolationMath::Floor(point[1] + offset, fy);
+    int inIdZ0 = vtkInterpolationMath::Floor(point[2] + offset, fz);
+
+    inIdX0 -= shift[0] + inExt[0];
+    inIdY0 -= shift[1] + inExt[2];
+    inIdZ0 -= shift[2] + inExt[4];
+
+    if (degree == 0 ||
+        !((inIdX0 >= 0) & (inIdX0 <= maxId[0]) &
+          (inIdY0 >= 0) & (inIdY0 <= maxId[1]) &
+          (inIdZ0 >= 0) & (inIdZ0 <= maxId[2])))
+      {
+      vtkImageBSplineInterpolate<F, T>::BSpline(info, point, outPtr);
+      outPtr += numscalars;
+      continue;
+      }
+
+    fx -= offset;
+    fy -= offset;
+    fz -= offset;
+
+#ifdef VTK_BSPLINE_USE_KERNEL_TABLE
+    vtkBSplineInterpWeights(kernel, fX, fx, degrees[0]);
+    vtkBSplineInterpWeights(kernel, fY, fy, degrees[1]);
+    vtkBSplineInterpWeights(kernel, fZ, fz, degrees[2]);
+#else
+    vtkImageBSplineInternals::GetInterpolationWeights(fX, fx, degrees[0]);
+    vtkImageBSplineInternals::GetInterpolationWeights(fY, fy, degrees[1]);
+    vtkImageBSplineInternals::GetInterpolationWeights(fZ, fz, degrees[2]);
+#endif
+
+    const T *tmpInPtr =
+      inPtr + (inIdX0*inIncX + inIdY0*inIncY + inIdZ0*inIncZ);
+
+    int c = numscalars;
+    do // loop over components
+      {
+      F val = 0;
+      const T *zPtr = tmpInPtr;
+      for (int k = 0; k < mZ; k++) // loop over z
+        {
+        F ifz = fZ[k];
+        const T *yPtr = zPtr;
+        for (int j = 0; j < mY; j++) // loop over y
+          {
+          F fzy = ifz*fY[j];
+          const T *tmpPtr = yPtr;
+          F tmpval = 0;
+          for (int l = 0; l < mX; l++) // loop over x
+            {
+            tmpval += fX[l]*(*tmpPtr);
+            tmpPtr += inIncX;
+            }
+          val += fzy*tmpval;
+          yPtr += inIncY;
+          }
+        zPtr += inIncZ;
+        }
+
+      *outPtr++ = val;
+      tmpInPtr++;
+      }
+    while (--c);
+    }
+}
+
 //----------------------------------------------------------------------------
 // Get the interpolation function for the specified data types
 template<class F>
@@ -460,6 +589,24 @@ void vtkImageBSplineInterpolatorGetInterpolationFunc(
     }
 }
 
+//----------------------------------------------------------------------------
+// Get the batch interpolation function for the specified data types
+template<class F>
+void vtkImageBSplineInterpolatorGetBatchInterpolationFunc(
+  void (**interpolate)(vtkInterpolationInfo *, const F *, F *, int),
+  int dataType)
+{
+  switch (dataType)
+    {
+    vtkTemplateAliasMacro(
+      *interpolate =
+        &(vtkImageBSplineInterpolate<F, VTK_TT>::BSplineBatch)
+      );
+    default:
+      *interpolate = 0;
+    }
+}
+
 //----------------------------------------------------------------------------
 // Interpolation for precomputed weights
 
@@ -776,6 +923,22 @@ void vtkImageBSplineInterpolator::GetInterpolationFunc(
     func, this->InterpolationInfo->ScalarType, this->SplineDegree);
 }
 
+//----------------------------------------------------------------------------
+void vtkImageBSplineInterpolator::GetBatchInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const double *, double *, int))
+{
+  vtkImageBSplineInterpolatorGetBatchInterpolationFunc(
+    func, this->InterpolationInfo->ScalarType);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBSplineInterpolator::GetBatchInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const float *, float *, int))
+{
+  vtkImageBSplineInterpolatorGetBatchInterpolationFunc(
+    func, this->InterpolationInfo->ScalarType);
+}
+
 //----------------------------------------------------------------------------
 void vtkImageBSplineInterpolator::GetRowInterpolationFunc(
   void (**func)(vtkInterpolationWeights *, int, int, int, double *, int))
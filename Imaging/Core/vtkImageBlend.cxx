@@ -552,15 +552,18 @@ static void vtkImageBlendCopyData(vtkImageData *inData, vtkImageData *outData,
 {
   int idxY, idxZ, maxY, maxZ;
   vtkIdType inIncX, inIncY, inIncZ;
+  vtkIdType outIncX, outIncY, outIncZ;
   int rowLength;
-  unsigned char *inPtr, *inPtr1, *outPtr;
+  unsigned char *inPtr, *inPtr1, *outPtr, *outPtr1;
 
   inPtr = static_cast<unsigned char *>(inData->GetScalarPointerForExtent(ext));
   outPtr =
     static_cast<unsigned char *>(outData->GetScalarPointerForExtent(ext));
 
-  // Get increments to march through inData
+  // Get increments to march through inData and outData, the extent can
+  // be a piece of the output that does not span whole rows or slices
   inData->GetIncrements(inIncX, inIncY, inIncZ);
+  outData->GetIncrements(outIncX, outIncY, outIncZ);
 
   // find the region to loop over
   rowLength = (ext[1] - ext[0]+1)*inIncX*inData->GetScalarSize();
@@ -569,16 +572,19 @@ static void vtkImageBlendCopyData(vtkImageData *inData, vtkImageData *outData,
 
   inIncY *= inData->GetScalarSize();
   inIncZ *= inData->GetScalarSize();
+  outIncY *= outData->GetScalarSize();
+  outIncZ *= outData->GetScalarSize();
 
   // Loop through outData pixels
   for (idxZ = 0; idxZ <= maxZ; idxZ++)
     {
     inPtr1 = inPtr + idxZ*inIncZ;
+    outPtr1 = outPtr + idxZ*outIncZ;
     for (idxY = 0; idxY <= maxY; idxY++)
       {
-      memcpy(outPtr,inPtr1,rowLength);
+      memcpy(outPtr1,inPtr1,rowLength);
       inPtr1 += inIncY;
-      outPtr += rowLength;
+      outPtr1 += outIncY;
       }
     }
 }
@@ -35,6 +35,19 @@ vtkImageDifference::vtkImageDifference()
   this->AllowShift = 1;
   this->Averaging = 1;
   this->SetNumberOfInputPorts(2);
+  // the errors are accumulated per thread
+  this->EnableSMP = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageDifference::SetEnableSMP(bool enable)
+{
+  if (enable)
+    {
+    vtkWarningMacro("SetEnableSMP: the errors are accumulated per thread, "
+                    "the SMP execution is not supported.");
+    }
+  this->Superclass::SetEnableSMP(false);
 }
 
 
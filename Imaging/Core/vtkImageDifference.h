@@ -90,6 +90,11 @@ public:
   vtkGetMacro(Averaging,int);
   vtkBooleanMacro(Averaging,int);
 
+  // Description:
+  // The errors are accumulated per thread, for the pieces of the
+  // vtkMultiThreader execution, so the SMP execution cannot be enabled.
+  virtual void SetEnableSMP(bool enable);
+
 protected:
   vtkImageDifference();
   ~vtkImageDifference() {}
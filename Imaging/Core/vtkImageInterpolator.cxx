@@ -28,6 +28,10 @@
 # undef VTK_USE_UINT64
 # define VTK_USE_UINT64 0
 
+// the number of points for which the batch interpolation functions
+// compute the memory offsets and weights together
+#define VTK_INTERPOLATION_BATCH_SIZE 64
+
 vtkStandardNewMacro(vtkImageInterpolator);
 
 //----------------------------------------------------------------------------
@@ -510,6 +514,342 @@ void vtkImageInterpolatorGetInterpolationFunc(
     }
 }
 
+//----------------------------------------------------------------------------
+// Interpolation of many points at once.  For each batch of points, the
+// memory offsets and the weights are computed first.  The points whose
+// kernel is entirely within the extent need no border handling, so the
+// kernel is addressed with constant strides from a single offset, while
+// the other points are interpolated with the point functions above.  Along
+// an axis with a single sample, the points at index 0 are inside, and the
+// kernel stride along that axis is zero, as for the clamped point functions.
+
+template<class F, class T>
+struct vtkImageNLCBatchInterpolate
+{
+  static void Nearest(
+    vtkInterpolationInfo *info, const F *points, F *outPtr, int n);
+
+  static void Trilinear(
+    vtkInterpolationInfo *info, const F *points, F *outPtr, int n);
+
+  static void Tricubic(
+    vtkInterpolationInfo *info, const F *points, F *outPtr, int n);
+};
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCBatchInterpolate<F, T>::Nearest(
+  vtkInterpolationInfo *info, const F *points, F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+
+  vtkIdType offsets[VTK_INTERPOLATION_BATCH_SIZE];
+
+  while (n > 0)
+    {
+    int m = ((n < VTK_INTERPOLATION_BATCH_SIZE) ?
+             n : VTK_INTERPOLATION_BATCH_SIZE);
+
+    // compute the memory offsets, or -1 if outside of the extent
+    for (int i = 0; i < m; i++)
+      {
+      const F *point = points + 3*i;
+      int inIdX0 = vtkInterpolationMath::Round(point[0]) - inExt[0];
+      int inIdY0 = vtkInterpolationMath::Round(point[1]) - inExt[2];
+      int inIdZ0 = vtkInterpolationMath::Round(point[2]) - inExt[4];
+
+      int inside = ((inIdX0 >= 0) & (inIdX0 <= inExt[1] - inExt[0]) &
+                    (inIdY0 >= 0) & (inIdY0 <= inExt[3] - inExt[2]) &
+                    (inIdZ0 >= 0) & (inIdZ0 <= inExt[5] - inExt[4]));
+
+      offsets[i] = (inside ?
+                    inIdX0*inInc[0] + inIdY0*inInc[1] + inIdZ0*inInc[2] :
+                    -1);
+      }
+
+    // gather the values
+    for (int i = 0; i < m; i++)
+      {
+      if (offsets[i] < 0)
+        {
+        vtkImageNLCInterpolate<F, T>::Nearest(info, points + 3*i, outPtr);
+        outPtr += numscalars;
+        continue;
+        }
+      const T *tmpPtr = inPtr + offsets[i];
+      int c = numscalars;
+      do
+        {
+        *outPtr++ = *tmpPtr++;
+        }
+      while (--c);
+      }
+
+    points += 3*m;
+    n -= m;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCBatchInterpolate<F, T>::Trilinear(
+  vtkInterpolationInfo *info, const F *points, F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+
+  // the last index of the first corner, and the offsets to the corners
+  // from the first corner, which are zero along single-sample axes
+  int maxX = inExt[1] - inExt[0];
+  int maxY = inExt[3] - inExt[2];
+  int maxZ = inExt[5] - inExt[4];
+  vtkIdType inIncX = (maxX > 0 ? inInc[0] : 0);
+  vtkIdType i01 = (maxZ > 0 ? inInc[2] : 0);
+  vtkIdType i10 = (maxY > 0 ? inInc[1] : 0);
+  vtkIdType i11 = i10 + i01;
+  maxX -= (maxX > 0);
+  maxY -= (maxY > 0);
+  maxZ -= (maxZ > 0);
+
+  vtkIdType offsets[VTK_INTERPOLATION_BATCH_SIZE];
+  F fractions[VTK_INTERPOLATION_BATCH_SIZE][3];
+
+  while (n > 0)
+    {
+    int m = ((n < VTK_INTERPOLATION_BATCH_SIZE) ?
+             n : VTK_INTERPOLATION_BATCH_SIZE);
+
+    // compute the offsets of the first corners, or -1 if a corner is
+    // outside of the extent
+    for (int i = 0; i < m; i++)
+      {
+      const F *point = points + 3*i;
+      F *f = fractions[i];
+      int inIdX0 = vtkInterpolationMath::Floor(point[0], f[0]) - inExt[0];
+      int inIdY0 = vtkInterpolationMath::Floor(point[1], f[1]) - inExt[2];
+      int inIdZ0 = vtkInterpolationMath::Floor(point[2], f[2]) - inExt[4];
+
+      int inside = ((inIdX0 >= 0) & (inIdX0 <= maxX) &
+                    (inIdY0 >= 0) & (inIdY0 <= maxY) &
+                    (inIdZ0 >= 0) & (inIdZ0 <= maxZ));
+
+      offsets[i] = (inside ?
+                    inIdX0*inInc[0] + inIdY0*inInc[1] + inIdZ0*inInc[2] :
+                    -1);
+      }
+
+    // gather and blend the values
+    for (int i = 0; i < m; i++)
+      {
+      if (offsets[i] < 0)
+        {
+        vtkImageNLCInterpolate<F, T>::Trilinear(info, points + 3*i, outPtr);
+        outPtr += numscalars;
+        continue;
+        }
+
+      F fx = fractions[i][0];
+      F fy = fractions[i][1];
+      F fz = fractions[i][2];
+
+      F rx = 1 - fx;
+      F ry = 1 - fy;
+      F rz = 1 - fz;
+
+      F ryrz = ry*rz;
+      F fyrz = fy*rz;
+      F ryfz = ry*fz;
+      F fyfz = fy*fz;
+
+      const T *inPtr0 = inPtr + offsets[i];
+      const T *inPtr1 = inPtr0 + inIncX;
+
+      int c = numscalars;
+      do
+        {
+        *outPtr++ = (rx*(ryrz*inPtr0[0] + ryfz*inPtr0[i01] +
+                         fyrz*inPtr0[i10] + fyfz*inPtr0[i11]) +
+                     fx*(ryrz*inPtr1[0] + ryfz*inPtr1[i01] +
+                         fyrz*inPtr1[i10] + fyfz*inPtr1[i11]));
+        inPtr0++;
+        inPtr1++;
+        }
+      while (--c);
+      }
+
+    points += 3*m;
+    n -= m;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class F, class T>
+void vtkImageNLCBatchInterpolate<F, T>::Tricubic(
+  vtkInterpolationInfo *info, const F *points, F *outPtr, int n)
+{
+  const T *inPtr = static_cast<const T *>(info->Pointer);
+  int *inExt = info->Extent;
+  vtkIdType *inInc = info->Increments;
+  int numscalars = info->NumberOfComponents;
+
+  // the kernel strides, the first kernel element relative to the point,
+  // and the last index of the first kernel element, for each axis
+  int single[3];
+  int shift[3];
+  int maxId[3];
+  vtkIdType inIncs[3];
+  for (int a = 0; a < 3; a++)
+    {
+    single[a] = (inExt[2*a] == inExt[2*a + 1]);
+    shift[a] = 1 - single[a];
+    maxId[a] = (single[a] ? 0 : inExt[2*a + 1] - inExt[2*a] - 3);
+    inIncs[a] = (single[a] ? 0 : inInc[a]);
+    }
+  vtkIdType inIncX = inIncs[0];
+  vtkIdType inIncY = inIncs[1];
+  vtkIdType inIncZ = inIncs[2];
+
+  // the range of kernel weights used along y and z
+  int j1 = single[1];
+  int j2 = 3 - 2*single[1];
+  int k1 = single[2];
+  int k2 = 3 - 2*single[2];
+
+  vtkIdType offsets[VTK_INTERPOLATION_BATCH_SIZE];
+  F weights[VTK_INTERPOLATION_BATCH_SIZE][12];
+
+  while (n > 0)
+    {
+    int m = ((n < VTK_INTERPOLATION_BATCH_SIZE) ?
+             n : VTK_INTERPOLATION_BATCH_SIZE);
+
+    // compute the offsets of the first kernel element and the weights,
+    // the offset is -1 if the kernel is not within the extent
+    for (int i = 0; i < m; i++)
+      {
+      const F *point = points + 3*i;
+      F fx, fy, fz;
+      int inIdX0 = (vtkInterpolationMath::Floor(point[0], fx) - inExt[0] -
+                    shift[0]);
+      int inIdY0 = (vtkInterpolationMath::Floor(point[1], fy) - inExt[2] -
+                    shift[1]);
+      int inIdZ0 = (vtkInterpolationMath::Floor(point[2], fz) - inExt[4] -
+                    shift[2]);
+
+      int inside = ((inIdX0 >= 0) & (inIdX0 <= maxId[0]) &
+                    (inIdY0 >= 0) & (inIdY0 <= maxId[1]) &
+                    (inIdZ0 >= 0) & (inIdZ0 <= maxId[2]));
+
+      offsets[i] = (inside ?
+                    inIdX0*inInc[0] + inIdY0*inInc[1] + inIdZ0*inInc[2] :
+                    -1);
+
+      // like the point function, use only the middle weight along single
+      // slices in y and z
+      vtkTricubicInterpWeights(&weights[i][0], fx);
+      vtkTricubicInterpWeights(&weights[i][4], fy);
+      vtkTricubicInterpWeights(&weights[i][8], fz);
+      weights[i][5] = (single[1] ? 1 : weights[i][5]);
+      weights[i][9] = (single[2] ? 1 : weights[i][9]);
+      }
+
+    // gather and blend the values
+    for (int i = 0; i < m; i++)
+      {
+      if (offsets[i] < 0)
+        {
+        vtkImageNLCInterpolate<F, T>::Tricubic(info, points + 3*i, outPtr);
+        outPtr += numscalars;
+        continue;
+        }
+
+      const F *fX = &weights[i][0];
+      const F *fY = &weights[i][4];
+      const F *fZ = &weights[i][8];
+      const T *tmpInPtr = inPtr + offsets[i];
+
+      int c = numscalars;
+      do // loop over components
+        {
+        F val = 0;
+        const T *zPtr = tmpInPtr;
+        for (int k = k1; k <= k2; k++) // loop over z
+          {
+          F ifz = fZ[k];
+          const T *tmpPtr = zPtr;
+          for (int j = j1; j <= j2; j++) // loop over y
+            {
+            F fzy = ifz*fY[j];
+            val += fzy*(fX[0]*tmpPtr[0] +
+                        fX[1]*tmpPtr[inIncX] +
+                        fX[2]*tmpPtr[2*inIncX] +
+                        fX[3]*tmpPtr[3*inIncX]);
+            tmpPtr += inIncY;
+            }
+          zPtr += inIncZ;
+          }
+
+        *outPtr++ = val;
+        tmpInPtr++;
+        }
+      while (--c);
+      }
+
+    points += 3*m;
+    n -= m;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Get the batch interpolation function for the specified data types
+template<class F>
+void vtkImageInterpolatorGetBatchInterpolationFunc(
+  void (**interpolate)(vtkInterpolationInfo *, const F *, F *, int),
+  int dataType, int interpolationMode)
+{
+  switch (interpolationMode)
+    {
+    case VTK_NEAREST_INTERPOLATION:
+      switch (dataType)
+        {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCBatchInterpolate<F, VTK_TT>::Nearest)
+          );
+        default:
+          *interpolate = 0;
+        }
+      break;
+    case VTK_LINEAR_INTERPOLATION:
+      switch (dataType)
+        {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCBatchInterpolate<F, VTK_TT>::Trilinear)
+          );
+        default:
+          *interpolate = 0;
+        }
+      break;
+    case VTK_CUBIC_INTERPOLATION:
+      switch (dataType)
+        {
+        vtkTemplateAliasMacro(
+          *interpolate =
+            &(vtkImageNLCBatchInterpolate<F, VTK_TT>::Tricubic)
+          );
+        default:
+          *interpolate = 0;
+        }
+      break;
+    }
+}
+
 //----------------------------------------------------------------------------
 // Interpolation for precomputed weights
 
@@ -1011,7 +1351,7 @@ void vtkImageInterpolatorPrecomputeWeights(
               }
             for (int jj = 0; jj < step; jj++)
               {
-              positions[step*i + jj] = minExt + jj;
+              positions[step*i + jj] = (minExt + jj)*inInc;
               constants[step*i + jj] = gg[jj];
               }
             }
@@ -1062,6 +1402,22 @@ void vtkImageInterpolator::GetInterpolationFunc(
     func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
 }
 
+//----------------------------------------------------------------------------
+void vtkImageInterpolator::GetBatchInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const double *, double *, int))
+{
+  vtkImageInterpolatorGetBatchInterpolationFunc(
+    func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageInterpolator::GetBatchInterpolationFunc(
+  void (**func)(vtkInterpolationInfo *, const float *, float *, int))
+{
+  vtkImageInterpolatorGetBatchInterpolationFunc(
+    func, this->InterpolationInfo->ScalarType, this->InterpolationMode);
+}
+
 //----------------------------------------------------------------------------
 void vtkImageInterpolator::GetRowInterpolationFunc(
   void (**func)(vtkInterpolationWeights *, int, int, int, double *, int))
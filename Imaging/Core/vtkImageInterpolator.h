@@ -102,6 +102,15 @@ protected:
     void (**floatfunc)(
       vtkInterpolationInfo *, const float [3], float *));
 
+  // Description:
+  // Get the functions that interpolate many points at once.
+  virtual void GetBatchInterpolationFunc(
+    void (**doublefunc)(
+      vtkInterpolationInfo *, const double *, double *, int));
+  virtual void GetBatchInterpolationFunc(
+    void (**floatfunc)(
+      vtkInterpolationInfo *, const float *, float *, int));
+
   // Description:
   // Get the row interpolation functions.
   virtual void GetRowInterpolationFunc(
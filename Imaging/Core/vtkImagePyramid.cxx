@@ -0,0 +1,595 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImagePyramid.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImagePyramid.h"
+
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkImageInterpolator.h"
+#include "vtkImageInterpolatorInternals.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTemplateAliasMacro.h"
+#include "vtkTypeTraits.h"
+
+#include <math.h>
+#include <vector>
+
+vtkStandardNewMacro(vtkImagePyramid);
+vtkCxxSetObjectMacro(vtkImagePyramid,Interpolator,vtkAbstractImageInterpolator);
+
+//----------------------------------------------------------------------------
+vtkImagePyramid::vtkImagePyramid()
+{
+  this->Interpolator = NULL;
+  this->SetNumberOfOutputPorts(8);
+}
+
+//----------------------------------------------------------------------------
+vtkImagePyramid::~vtkImagePyramid()
+{
+  this->SetInterpolator(NULL);
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractImageInterpolator *vtkImagePyramid::GetInterpolator()
+{
+  if (this->Interpolator == NULL)
+    {
+    vtkImageInterpolator *i = vtkImageInterpolator::New();
+    i->SetInterpolationModeToLinear();
+    this->Interpolator = i;
+    }
+
+  return this->Interpolator;
+}
+
+//----------------------------------------------------------------------------
+unsigned long int vtkImagePyramid::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+  unsigned long time;
+
+  if (this->Interpolator != NULL)
+    {
+    time = this->Interpolator->GetMTime();
+    mTime = ( time > mTime ? time : mTime );
+    }
+
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkImagePyramid::SetNumberOfLevels(int levels)
+{
+  levels = (levels > 1 ? levels : 1);
+  if (levels != this->GetNumberOfOutputPorts())
+    {
+    this->SetNumberOfOutputPorts(levels);
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImagePyramid::ComputeNextLevel(
+  int dims[3], double origin[3], double spacing[3])
+{
+  for (int i = 0; i < 3; i++)
+    {
+    if (dims[i] > 1)
+      {
+      // the new samples are centered between pairs of samples, the last
+      // one of an odd dimension being centered past the last sample
+      dims[i] = (dims[i] + 1)/2;
+      origin[i] += 0.5*spacing[i];
+      spacing[i] *= 2.0;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkImagePyramid::RequestInformation(
+  vtkInformation *, vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+
+  int extent[6];
+  double spacing[3];
+  double origin[3];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+  inInfo->Get(vtkDataObject::SPACING(), spacing);
+  inInfo->Get(vtkDataObject::ORIGIN(), origin);
+
+  int scalarType = VTK_DOUBLE;
+  int numComponents = 1;
+  vtkInformation *scalarInfo = vtkDataObject::GetActiveFieldInformation(
+    inInfo, vtkDataObject::FIELD_ASSOCIATION_POINTS,
+    vtkDataSetAttributes::SCALARS);
+  if (scalarInfo)
+    {
+    scalarType = scalarInfo->Get(vtkDataObject::FIELD_ARRAY_TYPE());
+    if (scalarInfo->Has(vtkDataObject::FIELD_NUMBER_OF_COMPONENTS()))
+      {
+      numComponents = scalarInfo->Get(
+        vtkDataObject::FIELD_NUMBER_OF_COMPONENTS());
+      }
+    }
+
+  // level 0 is the input
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent, 6);
+  outInfo->Set(vtkDataObject::SPACING(), spacing, 3);
+  outInfo->Set(vtkDataObject::ORIGIN(), origin, 3);
+  vtkDataObject::SetPointDataActiveScalarInfo(
+    outInfo, scalarType, numComponents);
+
+  // the other levels start at index zero
+  int dims[3];
+  for (int i = 0; i < 3; i++)
+    {
+    dims[i] = extent[2*i+1] - extent[2*i] + 1;
+    origin[i] += extent[2*i]*spacing[i];
+    }
+
+  int levels = this->GetNumberOfOutputPorts();
+  for (int level = 1; level < levels; level++)
+    {
+    vtkImagePyramid::ComputeNextLevel(dims, origin, spacing);
+    for (int i = 0; i < 3; i++)
+      {
+      extent[2*i] = 0;
+      extent[2*i+1] = dims[i] - 1;
+      }
+    outInfo = outputVector->GetInformationObject(level);
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent, 6);
+    outInfo->Set(vtkDataObject::SPACING(), spacing, 3);
+    outInfo->Set(vtkDataObject::ORIGIN(), origin, 3);
+    vtkDataObject::SetPointDataActiveScalarInfo(
+      outInfo, scalarType, numComponents);
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// Every level is computed from the whole input.
+int vtkImagePyramid::RequestUpdateExtent(
+  vtkInformation *, vtkInformationVector **inputVector,
+  vtkInformationVector *)
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  int extent[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), extent, 6);
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+namespace {
+
+// Clamp to the range of integer data and round to the nearest integer,
+// since the cubic and sinc kernels can overshoot.
+template<class T>
+void vtkImagePyramidConvert(double v, T &u)
+{
+  double vmin = static_cast<double>(vtkTypeTraits<T>::Min());
+  double vmax = static_cast<double>(vtkTypeTraits<T>::Max());
+  if (v <= vmin)
+    {
+    u = vtkTypeTraits<T>::Min();
+    }
+  else if (v >= vmax)
+    {
+    u = vtkTypeTraits<T>::Max();
+    }
+  else
+    {
+    u = static_cast<T>(floor(v + 0.5));
+    }
+}
+
+void vtkImagePyramidConvert(double v, float &u)
+{
+  u = static_cast<float>(v);
+}
+
+void vtkImagePyramidConvert(double v, double &u)
+{
+  u = v;
+}
+
+//----------------------------------------------------------------------------
+// Add N weighted input rows to a row of sums, or assign them to it, in
+// one pass so that each value of the sums is loaded and stored once.
+template<class T, int N>
+void vtkImagePyramidSumRowsFixed(
+  double *row, vtkIdType n, const T *const *rows, const double *w,
+  bool assign)
+{
+  if (assign)
+    {
+    for (vtkIdType i = 0; i < n; i++)
+      {
+      double sum = w[0]*rows[0][i];
+      for (int k = 1; k < N; k++)
+        {
+        sum += w[k]*rows[k][i];
+        }
+      row[i] = sum;
+      }
+    }
+  else
+    {
+    for (vtkIdType i = 0; i < n; i++)
+      {
+      double sum = row[i];
+      for (int k = 0; k < N; k++)
+        {
+        sum += w[k]*rows[k][i];
+        }
+      row[i] = sum;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Add up to four weighted input rows to a row of sums, or assign them.
+template<class T>
+void vtkImagePyramidSumRows(
+  double *row, vtkIdType n, const T *const *rows, const double *w,
+  int count, bool assign)
+{
+  switch (count)
+    {
+    case 1:
+      vtkImagePyramidSumRowsFixed<T, 1>(row, n, rows, w, assign);
+      break;
+    case 2:
+      vtkImagePyramidSumRowsFixed<T, 2>(row, n, rows, w, assign);
+      break;
+    case 3:
+      vtkImagePyramidSumRowsFixed<T, 3>(row, n, rows, w, assign);
+      break;
+    case 4:
+      vtkImagePyramidSumRowsFixed<T, 4>(row, n, rows, w, assign);
+      break;
+    default:
+      if (assign)
+        {
+        for (vtkIdType i = 0; i < n; i++)
+          {
+          row[i] = 0.0;
+          }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Filter a row along X with a kernel of fixed size K, for the common
+// kernel sizes, so that the kernel loop can be unrolled.
+template<class T, int K>
+void vtkImagePyramidFilterXFixed(
+  const double *row, T *outPtr, int nc, int n,
+  const vtkIdType *a, const double *f)
+{
+  for (int idX = 0; idX < n; ++idX)
+    {
+    for (int c = 0; c < nc; ++c)
+      {
+      double sum = f[0]*row[a[0] + c];
+      for (int k = 1; k < K; k++)
+        {
+        sum += f[k]*row[a[k] + c];
+        }
+      vtkImagePyramidConvert(sum, outPtr[c]);
+      }
+    a += K;
+    f += K;
+    outPtr += nc;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Filter a row along X into n voxels of the new level.  A kernel of size
+// one, as for nearest neighbor interpolation or an axis that is not
+// reduced, has a unit weight that might not be stored.
+template<class T>
+void vtkImagePyramidFilterX(
+  const double *row, T *outPtr, int nc, int n,
+  const vtkIdType *a, const double *f, int kernelSize)
+{
+  // linear, cubic and 6-tap sinc kernels
+  switch (kernelSize)
+    {
+    case 1:
+      for (int idX = 0; idX < n; ++idX)
+        {
+        for (int c = 0; c < nc; ++c)
+          {
+          vtkImagePyramidConvert(row[a[idX] + c], outPtr[c]);
+          }
+        outPtr += nc;
+        }
+      return;
+    case 2:
+      vtkImagePyramidFilterXFixed<T, 2>(row, outPtr, nc, n, a, f);
+      return;
+    case 4:
+      vtkImagePyramidFilterXFixed<T, 4>(row, outPtr, nc, n, a, f);
+      return;
+    case 6:
+      vtkImagePyramidFilterXFixed<T, 6>(row, outPtr, nc, n, a, f);
+      return;
+    }
+
+  for (int idX = 0; idX < n; ++idX)
+    {
+    for (int c = 0; c < nc; ++c)
+      {
+      double sum = 0.0;
+      for (int k = 0; k < kernelSize; k++)
+        {
+        sum += f[k]*row[a[k] + c];
+        }
+      vtkImagePyramidConvert(sum, outPtr[c]);
+      }
+    a += kernelSize;
+    f += kernelSize;
+    outPtr += nc;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Samples a range of rows of the new level, the rows being numbered along
+// Y and then along Z, with the weights precomputed by the interpolator.
+// The input rows under the Y and Z kernels are summed into a buffer with
+// contiguous loops over up to four rows at a time, and the buffer is then
+// filtered along X.  A missing weight table, as for nearest neighbor
+// interpolation, means unit weights.
+template<class T>
+class vtkImagePyramidFunctor
+{
+public:
+  const T *InPtr;
+  int InRowLength;
+  T *OutPtr;
+  int OutDims[3];
+  int NumberOfComponents;
+  vtkInterpolationWeights *Weights;
+
+  vtkSMPThreadLocal<std::vector<double> > Rows;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int nc = this->NumberOfComponents;
+    vtkIdType rowLength = static_cast<vtkIdType>(this->InRowLength)*nc;
+    std::vector<double>& buffer = this->Rows.Local();
+    buffer.resize(rowLength);
+    double *row = &buffer[0];
+
+    const vtkInterpolationWeights *weights = this->Weights;
+    int kernelSize[3];
+    const vtkIdType *positions[3];
+    const double *constants[3];
+    for (int j = 0; j < 3; j++)
+      {
+      kernelSize[j] = weights->KernelSize[j];
+      positions[j] = weights->Positions[j];
+      constants[j] = static_cast<const double *>(weights->Weights[j]);
+      }
+
+    for (vtkIdType idRow = begin; idRow < end; ++idRow)
+      {
+      int idY = static_cast<int>(idRow % this->OutDims[1]);
+      int idZ = static_cast<int>(idRow / this->OutDims[1]);
+      const vtkIdType *aY = positions[1] + idY*kernelSize[1];
+      const vtkIdType *aZ = positions[2] + idZ*kernelSize[2];
+      const double *fY =
+        (constants[1] ? constants[1] + idY*kernelSize[1] : NULL);
+      const double *fZ =
+        (constants[2] ? constants[2] + idZ*kernelSize[2] : NULL);
+
+      // sum the input rows along Y and Z, up to four rows per pass
+      const T *rows[4];
+      double rowWeights[4];
+      int count = 0;
+      bool assign = true;
+      for (int kz = 0; kz < kernelSize[2]; kz++)
+        {
+        double wz = (fZ ? fZ[kz] : 1.0);
+        for (int ky = 0; ky < kernelSize[1]; ky++)
+          {
+          double w = wz*(fY ? fY[ky] : 1.0);
+          if (w != 0)
+            {
+            rows[count] = this->InPtr + aY[ky] + aZ[kz];
+            rowWeights[count++] = w;
+            if (count == 4)
+              {
+              vtkImagePyramidSumRows(row, rowLength, rows, rowWeights,
+                                     count, assign);
+              count = 0;
+              assign = false;
+              }
+            }
+          }
+        }
+      if (count > 0 || assign)
+        {
+        vtkImagePyramidSumRows(row, rowLength, rows, rowWeights,
+                               count, assign);
+        }
+
+      // filter the sum along X
+      vtkImagePyramidFilterX(
+        row, this->OutPtr + idRow*this->OutDims[0]*nc, nc,
+        this->OutDims[0], positions[0], constants[0], kernelSize[0]);
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Compute one level from the previous one, in groups of rows so that the
+// progress can be reported and the execution aborted between the groups.
+template<class T>
+void vtkImagePyramidExecute(vtkImagePyramid *self, vtkImageData *inData,
+                            vtkImageData *outData,
+                            vtkInterpolationWeights *weights,
+                            const T *inPtr, T *outPtr,
+                            double progress, double progressScale)
+{
+  vtkImagePyramidFunctor<T> functor;
+  functor.InPtr = inPtr;
+  functor.InRowLength = inData->GetDimensions()[0];
+  functor.OutPtr = outPtr;
+  functor.NumberOfComponents = inData->GetNumberOfScalarComponents();
+  functor.Weights = weights;
+  outData->GetDimensions(functor.OutDims);
+
+  vtkIdType numberOfRows = functor.OutDims[1];
+  numberOfRows *= functor.OutDims[2];
+  vtkIdType groupSize = numberOfRows/20 + 1;
+  vtkIdType minGroupSize =
+    4*vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  groupSize = (groupSize > minGroupSize ? groupSize : minGroupSize);
+  for (vtkIdType begin = 0; begin < numberOfRows; begin += groupSize)
+    {
+    if (self->GetAbortExecute())
+      {
+      break;
+      }
+    vtkIdType end = begin + groupSize;
+    end = (end < numberOfRows ? end : numberOfRows);
+    vtkSMPTools::For(begin, end, functor);
+    self->UpdateProgress(progress + progressScale*end/numberOfRows);
+    }
+}
+
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImagePyramid::RequestData(
+  vtkInformation *, vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkImageData *inData = vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *outData = vtkImageData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  outData->ShallowCopy(inData);
+
+  if (inData->GetPointData()->GetScalars() == NULL)
+    {
+    vtkErrorMacro("RequestData: the input has no scalars");
+    return 0;
+    }
+
+  vtkAbstractImageInterpolator *interpolator = this->GetInterpolator();
+  if (!interpolator->IsSeparable())
+    {
+    vtkErrorMacro("RequestData: the interpolator must be separable");
+    return 0;
+    }
+
+  // each level is computed from the previous one
+  int levels = this->GetNumberOfOutputPorts();
+  vtkImageData *prevData = inData;
+  for (int level = 1; level < levels && !this->GetAbortExecute(); level++)
+    {
+    outInfo = outputVector->GetInformationObject(level);
+    outData = vtkImageData::SafeDownCast(
+      outInfo->Get(vtkDataObject::DATA_OBJECT()));
+    int extent[6];
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+    outData->SetExtent(extent);
+    outData->AllocateScalars(prevData->GetScalarType(),
+                             prevData->GetNumberOfScalarComponents());
+
+    // map the new voxels to the centers of pairs of previous voxels
+    int prevExtent[6];
+    prevData->GetExtent(prevExtent);
+    double matrix[16];
+    for (int i = 0; i < 3; i++)
+      {
+      double factor = (prevExtent[2*i+1] > prevExtent[2*i] ? 2.0 : 1.0);
+      matrix[4*i+0] = matrix[4*i+1] = matrix[4*i+2] = 0.0;
+      matrix[4*i+i] = factor;
+      matrix[4*i+3] = prevExtent[2*i] + 0.5*(factor - 1.0);
+      matrix[12+i] = 0.0;
+      }
+    matrix[15] = 1.0;
+
+    // the interpolator only provides the weights, so it is given the
+    // geometry of the level without its scalars, which makes any scalar
+    // type acceptable; the clip extent is not used, since the border mode
+    // of the interpolator takes care of the samples past the edges
+    vtkNew<vtkImageData> geometry;
+    geometry->SetExtent(prevExtent);
+    geometry->SetOrigin(prevData->GetOrigin());
+    geometry->SetSpacing(prevData->GetSpacing());
+    vtkNew<vtkDoubleArray> noScalars;
+    noScalars->SetNumberOfComponents(prevData->GetNumberOfScalarComponents());
+    geometry->GetPointData()->SetScalars(noScalars.GetPointer());
+    interpolator->Initialize(geometry.GetPointer());
+    int clipExt[6];
+    vtkInterpolationWeights *weights;
+    interpolator->PrecomputeWeightsForExtent(
+      matrix, extent, clipExt, weights);
+
+    void *inPtr = prevData->GetScalarPointer();
+    void *outPtr = outData->GetScalarPointer();
+    double progress = static_cast<double>(level - 1)/(levels - 1);
+    double progressScale = 1.0/(levels - 1);
+    switch (prevData->GetScalarType())
+      {
+      vtkTemplateAliasMacro(
+        vtkImagePyramidExecute(
+          this, prevData, outData, weights,
+          static_cast<const VTK_TT *>(inPtr),
+          static_cast<VTK_TT *>(outPtr), progress, progressScale));
+      default:
+        vtkErrorMacro("RequestData: Unknown ScalarType");
+        interpolator->FreePrecomputedWeights(weights);
+        interpolator->ReleaseData();
+        return 0;
+      }
+
+    interpolator->FreePrecomputedWeights(weights);
+    interpolator->ReleaseData();
+    prevData = outData;
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImagePyramid::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfLevels: " << this->GetNumberOfLevels() << "\n";
+  os << indent << "Interpolator: " << this->Interpolator << "\n";
+}
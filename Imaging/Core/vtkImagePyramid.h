@@ -0,0 +1,95 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImagePyramid.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImagePyramid - Generate a power-of-two pyramid of an image.
+// .SECTION Description
+// vtkImagePyramid produces all the levels of a mip chain of its input in
+// one execution, one level per output port.  Level 0 is the input, and
+// each following level is the previous one reduced by a factor of two
+// along every axis with more than one sample.  The voxels of a level are
+// centered between pairs of voxels of the previous level, and are
+// sampled with the separable kernel of the interpolator: the default
+// linear interpolator averages each 2x2x2 block, while a cubic
+// vtkImageInterpolator or a vtkImageSincInterpolator with Antialiasing
+// gives a sharper reduction.  An odd dimension is rounded up, the last
+// voxel being computed with the border mode of the interpolator.  Each
+// level is computed from the previous level rather than from the input,
+// and the rows of a level are computed in parallel with vtkSMPTools.
+// The levels are meant for multi-resolution viewers and level-of-detail
+// rendering.
+// .SECTION Caveats
+// Only the scalars are reduced, and only the weights of the interpolator
+// are used, so all the components are reduced whatever the component
+// range of the interpolator.  64-bit integers are interpolated as doubles.
+// .SECTION See Also
+// vtkImageResize vtkImageShrink3D vtkImageInterpolator
+
+#ifndef __vtkImagePyramid_h
+#define __vtkImagePyramid_h
+
+#include "vtkImagingCoreModule.h" // For export macro
+#include "vtkImageAlgorithm.h"
+
+class vtkAbstractImageInterpolator;
+
+class VTKIMAGINGCORE_EXPORT vtkImagePyramid : public vtkImageAlgorithm
+{
+public:
+  static vtkImagePyramid *New();
+  vtkTypeMacro(vtkImagePyramid, vtkImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Set the number of levels, counting the input as level 0.  This is also
+  // the number of output ports, and GetOutput(level) gives the image for
+  // a level.  The levels past the one where the image has been reduced to
+  // a single voxel are single voxels.  The default is 8 levels.
+  void SetNumberOfLevels(int levels);
+  int GetNumberOfLevels() { return this->GetNumberOfOutputPorts(); }
+
+  // Description:
+  // Set the interpolator whose kernel samples each level.  The interpolator
+  // must be separable.  The default is a linear vtkImageInterpolator.
+  virtual void SetInterpolator(vtkAbstractImageInterpolator *sampler);
+  virtual vtkAbstractImageInterpolator *GetInterpolator();
+
+  // Description:
+  // Get the modified time of the filter.
+  unsigned long int GetMTime();
+
+protected:
+  vtkImagePyramid();
+  ~vtkImagePyramid();
+
+  virtual int RequestInformation(vtkInformation *, vtkInformationVector **,
+                                 vtkInformationVector *);
+  virtual int RequestUpdateExtent(vtkInformation *, vtkInformationVector **,
+                                  vtkInformationVector *);
+  virtual int RequestData(vtkInformation *, vtkInformationVector **,
+                          vtkInformationVector *);
+
+  // Description:
+  // Compute the dimensions, origin and spacing of the level that follows
+  // the given level.
+  static void ComputeNextLevel(int dims[3], double origin[3],
+                               double spacing[3]);
+
+  vtkAbstractImageInterpolator *Interpolator;
+
+private:
+  vtkImagePyramid(const vtkImagePyramid&);  // Not implemented.
+  void operator=(const vtkImagePyramid&);  // Not implemented.
+};
+
+#endif
@@ -34,6 +34,9 @@
 
 #include <math.h>
 
+// the number of values that are filtered at a time along Y or Z
+#define VTK_RESIZE_BLOCK_SIZE 64
+
 vtkStandardNewMacro(vtkImageResize);
 vtkCxxSetObjectMacro(vtkImageResize,Interpolator,vtkAbstractImageInterpolator);
 
@@ -361,6 +364,32 @@ VTK_RESIZE_CONVERT_INT_CLAMP(vtkTypeInt32, -2147483648.0, 2147483647.0);
 VTK_RESIZE_CONVERT_FLOAT(vtkTypeFloat32);
 VTK_RESIZE_CONVERT_FLOAT(vtkTypeFloat64);
 
+//----------------------------------------------------------------------------
+// Apply a 1D filter with a kernel of fixed size K in the X direction, for
+// the common kernel sizes, so that the kernel loop can be unrolled.
+template<class T, int K>
+void vtkImageResizeFilterXFixed(
+  const T *inPtr, double *outPtr, int ncomp, int pixelCounter,
+  const vtkIdType *a, const double *f)
+{
+  do
+    {
+    for (int i = 0; i < ncomp; i++)
+      {
+      double val = f[0]*inPtr[a[0] + i];
+      for (int k = 1; k < K; k++)
+        {
+        val += f[k]*inPtr[a[k] + i];
+        }
+      outPtr[i] = val;
+      }
+    outPtr += ncomp;
+    a += K;
+    f += K;
+    }
+  while (--pixelCounter);
+}
+
 //----------------------------------------------------------------------------
 // Apply a 1D filter in the X direction.
 // The inPtr parameter must be positioned at the correct slice.
@@ -371,6 +400,23 @@ void vtkImageResizeFilterX(
 {
   int pixelCounter = extent[1] - extent[0] + 1;
 
+  // linear, cubic and 6-tap sinc kernels
+  switch (kernelSize)
+    {
+    case 2:
+      vtkImageResizeFilterXFixed<T, 2>(
+        inPtr, outPtr, ncomp, pixelCounter, a, f);
+      return;
+    case 4:
+      vtkImageResizeFilterXFixed<T, 4>(
+        inPtr, outPtr, ncomp, pixelCounter, a, f);
+      return;
+    case 6:
+      vtkImageResizeFilterXFixed<T, 6>(
+        inPtr, outPtr, ncomp, pixelCounter, a, f);
+      return;
+    }
+
   if (kernelSize == 1)
     {
     do
@@ -440,24 +486,39 @@ void vtkImageResizeFilterYOrZ(
     }
   else
     {
-    // apply the filter to one row of the image
-    int i = 0;
+    // apply the filter to one row of the image, a block of values at a
+    // time, with the kernel loop outside so that the inner loops run over
+    // contiguous values and can be vectorized
+    double sum[VTK_RESIZE_BLOCK_SIZE];
+    vtkIdType i = 0;
     do
       {
-      double **tmpPtr = rowPtr;
-      const double *g = f;
-      double val = (*g++)*((*tmpPtr++)[i]);
-      int k = kernelSize - 1;
-      do
+      int n = VTK_RESIZE_BLOCK_SIZE;
+      n = (rowCounter < n ? static_cast<int>(rowCounter) : n);
+      const double *inPtr = rowPtr[0] + i;
+      double g = f[0];
+      for (int j = 0; j < n; j++)
         {
-        val += (*g++)*((*tmpPtr++)[i]);
+        sum[j] = g*inPtr[j];
         }
-      while (--k);
-      i++;
-      vtkImageResizeConvert(val, *outPtr);
-      outPtr++;
+      for (int k = 1; k < kernelSize; k++)
+        {
+        inPtr = rowPtr[k] + i;
+        g = f[k];
+        for (int j = 0; j < n; j++)
+          {
+          sum[j] += g*inPtr[j];
+          }
+        }
+      for (int j = 0; j < n; j++)
+        {
+        vtkImageResizeConvert(sum[j], outPtr[j]);
+        }
+      outPtr += n;
+      i += n;
+      rowCounter -= n;
       }
-    while (--rowCounter);
+    while (rowCounter);
     }
 }
 
@@ -2115,11 +2115,16 @@ void vtkImageResliceExecute(vtkImageReslice *self,
   inInvSpacing[1] = F(1.0/temp[1]);
   inInvSpacing[2] = F(1.0/temp[2]);
 
-  // allocate an output row of type double
+  // allocate an output row of type double, and a row of points and
+  // of bounds checks
   F *floatPtr = 0;
+  F *rowPoints = 0;
+  bool *rowInBounds = 0;
   if (!optimizeNearest)
     {
     floatPtr = new F [inComponents*(outExt[1] - outExt[0] + nsamples)];
+    rowPoints = new F [3*(outExt[1] - outExt[0] + 1)];
+    rowInBounds = new bool [outExt[1] - outExt[0] + 1];
     }
 
   // set color for area outside of input volume extent
@@ -2172,15 +2177,49 @@ void vtkImageResliceExecute(vtkImageReslice *self,
         {
         if (!optimizeNearest)
           {
-          bool wasInBounds = 1;
-          bool isInBounds = 1;
-          int startIdX = idXmin;
-          int idX = idXmin;
-          F *tmpPtr = floatPtr;
+          if (nsamples == 1)
+            {
+            // compute the row of points, each run of points that are
+            // within the bounds is interpolated as a batch below
+            F *pointPtr = rowPoints;
+            for (int idX = idXmin; idX <= idXmax; idX++)
+              {
+              F inPoint[4];
+              inPoint[0] = inPoint1[0] + idX*xAxis[0];
+              inPoint[1] = inPoint1[1] + idX*xAxis[1];
+              inPoint[2] = inPoint1[2] + idX*xAxis[2];
+              inPoint[3] = inPoint1[3] + idX*xAxis[3];
+
+              if (perspective)
+                { // only do perspective if necessary
+                F f = 1/inPoint[3];
+                inPoint[0] *= f;
+                inPoint[1] *= f;
+                inPoint[2] *= f;
+                }
 
-          while (startIdX <= idXmax)
+              if (newtrans)
+                { // apply the AbstractTransform if there is one
+                vtkResliceApplyTransform(newtrans, inPoint, inOrigin,
+                                         inInvSpacing);
+                }
+
+              pointPtr[0] = inPoint[0];
+              pointPtr[1] = inPoint[1];
+              pointPtr[2] = inPoint[2];
+              pointPtr += 3;
+              }
+
+            for (int idX = idXmin; idX <= idXmax; idX++)
+              {
+              rowInBounds[idX - idXmin] =
+                interpolator->CheckBoundsIJK(rowPoints + 3*(idX - idXmin));
+              }
+            }
+          else
             {
-            for (; idX <= idXmax && isInBounds == wasInBounds; idX++)
+            F *tmpPtr = floatPtr;
+            for (int idX = idXmin; idX <= idXmax; idX++)
               {
               F inPoint2[4];
               inPoint2[0] = inPoint1[0] + idX*xAxis[0];
@@ -2189,43 +2228,38 @@ void vtkImageResliceExecute(vtkImageReslice *self,
               inPoint2[3] = inPoint1[3] + idX*xAxis[3];
 
               F inPoint3[4];
-              F *inPoint = inPoint2;
-              isInBounds = 0;
+              bool isInBounds = 0;
 
               int sampleCount = 0;
               for (int sample = 0; sample < nsamples; sample++)
                 {
-                if (nsamples > 1)
-                  {
-                  double s = sample - 0.5*(nsamples - 1);
-                  s *= slabSampleSpacing;
-                  inPoint3[0] = inPoint2[0] + s*zAxis[0];
-                  inPoint3[1] = inPoint2[1] + s*zAxis[1];
-                  inPoint3[2] = inPoint2[2] + s*zAxis[2];
-                  inPoint3[3] = inPoint2[3] + s*zAxis[3];
-                  inPoint = inPoint3;
-                  }
+                double s = sample - 0.5*(nsamples - 1);
+                s *= slabSampleSpacing;
+                inPoint3[0] = inPoint2[0] + s*zAxis[0];
+                inPoint3[1] = inPoint2[1] + s*zAxis[1];
+                inPoint3[2] = inPoint2[2] + s*zAxis[2];
+                inPoint3[3] = inPoint2[3] + s*zAxis[3];
 
                 if (perspective)
                   { // only do perspective if necessary
-                  F f = 1/inPoint[3];
-                  inPoint[0] *= f;
-                  inPoint[1] *= f;
-                  inPoint[2] *= f;
+                  F f = 1/inPoint3[3];
+                  inPoint3[0] *= f;
+                  inPoint3[1] *= f;
+                  inPoint3[2] *= f;
                   }
 
                 if (newtrans)
                   { // apply the AbstractTransform if there is one
-                  vtkResliceApplyTransform(newtrans, inPoint, inOrigin,
+                  vtkResliceApplyTransform(newtrans, inPoint3, inOrigin,
                                            inInvSpacing);
                   }
 
-                if (interpolator->CheckBoundsIJK(inPoint))
+                if (interpolator->CheckBoundsIJK(inPoint3))
                   {
                   // do the interpolation
                   sampleCount++;
                   isInBounds = 1;
-                  interpolator->InterpolateIJK(inPoint, tmpPtr);
+                  interpolator->InterpolateIJK(inPoint3, tmpPtr);
                   tmpPtr += inComponents;
                   }
                 }
@@ -2237,16 +2271,32 @@ void vtkImageResliceExecute(vtkImageReslice *self,
                 }
               tmpPtr += inComponents;
 
-              // set "was in" to "is in" if first pixel
-              wasInBounds = ((idX > idXmin) ? wasInBounds : isInBounds);
+              rowInBounds[idX - idXmin] = isInBounds;
               }
+            }
 
-            // write a segment to the output
-            int endIdX = idX - 1 - (isInBounds != wasInBounds);
+          // write the segments to the output
+          int startIdX = idXmin;
+          while (startIdX <= idXmax)
+            {
+            bool isInBounds = rowInBounds[startIdX - idXmin];
+            int endIdX = startIdX;
+            while (endIdX < idXmax &&
+                   rowInBounds[endIdX + 1 - idXmin] == isInBounds)
+              {
+              endIdX++;
+              }
             int numpixels = endIdX - startIdX + 1;
+            F *tmpPtr = floatPtr + inComponents*(startIdX - idXmin);
 
-            if (wasInBounds)
+            if (isInBounds)
               {
+              if (nsamples == 1)
+                {
+                interpolator->InterpolateIJK(
+                  rowPoints + 3*(startIdX - idXmin), tmpPtr, numpixels);
+                }
+
               if (outputStencil)
                 {
                 outputStencil->InsertNextExtent(startIdX, endIdX, idY, idZ);
@@ -2254,15 +2304,14 @@ void vtkImageResliceExecute(vtkImageReslice *self,
 
               if (rescaleScalars)
                 {
-                vtkImageResliceRescaleScalars(floatPtr, inComponents,
-                                              idXmax - idXmin + 1,
+                vtkImageResliceRescaleScalars(tmpPtr, inComponents,
+                                              numpixels,
                                               scalarShift, scalarScale);
                 }
 
               if (convertScalars)
                 {
-                (self->*convertScalars)(tmpPtr - inComponents*(idX-startIdX),
-                                        outPtr,
+                (self->*convertScalars)(tmpPtr, outPtr,
                                         vtkTypeTraits<F>::VTKTypeID(),
                                         inComponents, numpixels,
                                         startIdX, idY, idZ, threadId);
@@ -2272,8 +2321,7 @@ void vtkImageResliceExecute(vtkImageReslice *self,
                 }
               else
                 {
-                convertpixels(outPtr, tmpPtr - inComponents*(idX - startIdX),
-                              outComponents, numpixels);
+                convertpixels(outPtr, tmpPtr, outComponents, numpixels);
                 }
               }
             else
@@ -2281,8 +2329,7 @@ void vtkImageResliceExecute(vtkImageReslice *self,
               setpixels(outPtr, background, outComponents, numpixels);
               }
 
-            startIdX += numpixels;
-            wasInBounds = isInBounds;
+            startIdX = endIdX + 1;
             }
           }
         else // optimize for nearest-neighbor interpolation
@@ -2348,6 +2395,8 @@ void vtkImageResliceExecute(vtkImageReslice *self,
   if (!optimizeNearest)
     {
     delete [] floatPtr;
+    delete [] rowPoints;
+    delete [] rowInBounds;
     }
 }
 
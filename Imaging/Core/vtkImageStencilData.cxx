@@ -22,12 +22,25 @@
 #include "vtkDataArray.h"
 #include "vtkObjectFactory.h"
 #include "vtkMath.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 
 #include <math.h>
 #include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageStencilData);
 
+// The operations of BuildExtentLists()
+enum
+{
+  VTK_STENCIL_COPY,
+  VTK_STENCIL_ADD,
+  VTK_STENCIL_SUBTRACT,
+  VTK_STENCIL_REPLACE,
+  VTK_STENCIL_CLIP
+};
+
 //----------------------------------------------------------------------------
 vtkImageStencilData::vtkImageStencilData()
 {
@@ -42,6 +55,8 @@ vtkImageStencilData::vtkImageStencilData()
   this->NumberOfExtentEntries = 0;
   this->ExtentLists = NULL;
   this->ExtentListLengths = NULL;
+  this->ExtentPool = NULL;
+  this->ExtentPoolSize = 0;
 
   this->Extent[0] = 0;
   this->Extent[1] = -1;
@@ -90,26 +105,7 @@ void vtkImageStencilData::PrintSelf(ostream& os, vtkIndent indent)
 //----------------------------------------------------------------------------
 void vtkImageStencilData::Initialize()
 {
-  if (this->ExtentLists)
-    {
-    int n = this->NumberOfExtentEntries;
-    for (int i = 0; i < n; i++)
-      {
-      if (this->ExtentLists[i] != &this->ExtentListLengths[n + 2*i])
-        {
-        delete [] this->ExtentLists[i];
-        }
-      }
-    delete [] this->ExtentLists;
-    }
-  this->ExtentLists = NULL;
-  this->NumberOfExtentEntries = 0;
-
-  if (this->ExtentListLengths)
-    {
-    delete [] this->ExtentListLengths;
-    }
-  this->ExtentListLengths = NULL;
+  this->DeleteExtentLists();
 
   if(this->Information)
     {
@@ -197,53 +193,16 @@ void vtkImageStencilData::InternalImageStencilDataCopy(vtkImageStencilData *s)
   this->SetSpacing(s->Spacing);
   this->SetOrigin(s->Origin);
 
-  // delete old data
-  if (this->ExtentLists)
-    {
-    int n = this->NumberOfExtentEntries;
-    for (int i = 0; i < n; i++)
-      {
-      if (this->ExtentLists[i] != &this->ExtentListLengths[n + 2*i])
-        {
-        delete [] this->ExtentLists[i];
-        }
-      }
-    delete [] this->ExtentLists;
-    }
-  this->ExtentLists = NULL;
-  this->NumberOfExtentEntries = 0;
-
-  if (this->ExtentListLengths)
+  if (s->NumberOfExtentEntries == 0)
     {
-    delete [] this->ExtentListLengths;
+    // no data to copy
+    this->DeleteExtentLists();
+    memcpy(this->Extent, s->GetExtent(), 6*sizeof(int));
+    return;
     }
-  this->ExtentListLengths = NULL;
 
-  // copy new data
-  if (s->NumberOfExtentEntries != 0)
-    {
-    this->NumberOfExtentEntries = s->NumberOfExtentEntries;
-    int n = this->NumberOfExtentEntries;
-    this->ExtentListLengths = new int[3*n];
-    this->ExtentLists = new int *[n];
-    for (int i = 0; i < n; i++)
-      {
-      this->ExtentListLengths[i] = s->ExtentListLengths[i];
-      int m = this->ExtentListLengths[i];
-      int clistmaxlen = 1;
-      do { clistmaxlen *= 2; } while (m > clistmaxlen);
-      this->ExtentLists[i] = &this->ExtentListLengths[n + 2*i];
-      if (clistmaxlen > 2)
-        {
-        this->ExtentLists[i] = new int[clistmaxlen];
-        }
-      for (int j = 0; j < m; j++)
-        {
-        this->ExtentLists[i][j] = s->ExtentLists[i][j];
-        }
-      }
-    }
-  memcpy(this->Extent, s->GetExtent(), 6*sizeof(int));
+  // copy the lists of all the rows into contiguous storage
+  this->BuildExtentLists(s->Extent, s, NULL, VTK_STENCIL_COPY, s->Extent);
 }
 
 //----------------------------------------------------------------------------
@@ -257,23 +216,9 @@ void vtkImageStencilData::AllocateExtents()
   int numEntries = ySize*zSize;
   if (numEntries != this->NumberOfExtentEntries)
     {
-    if (this->NumberOfExtentEntries != 0)
-      {
-      int n = this->NumberOfExtentEntries;
-      for (int i = 0; i < n; i++)
-        {
-        if (this->ExtentLists[i] != &this->ExtentListLengths[n + 2*i])
-          {
-          delete [] this->ExtentLists[i];
-          }
-        }
-      delete [] this->ExtentLists;
-      delete [] this->ExtentListLengths;
-      }
+    this->DeleteExtentLists();
 
     this->NumberOfExtentEntries = numEntries;
-    this->ExtentLists = NULL;
-    this->ExtentListLengths = NULL;
 
     if (numEntries)
       {
@@ -292,13 +237,13 @@ void vtkImageStencilData::AllocateExtents()
     {
     for (int i = 0; i < numEntries; i++)
       {
-      if (this->ExtentLists[i] != &this->ExtentListLengths[numEntries + 2*i])
-        {
-        delete [] this->ExtentLists[i];
-        }
+      this->FreeExtentList(i);
       this->ExtentLists[i] = &this->ExtentListLengths[numEntries + 2*i];
       this->ExtentListLengths[i] = 0;
       }
+    delete [] this->ExtentPool;
+    this->ExtentPool = NULL;
+    this->ExtentPoolSize = 0;
     }
 }
 
@@ -443,7 +388,7 @@ int vtkImageStencilData::IsInside( int xIdx, int yIdx, int zIdx )
       continue;
       }
 
-    if (xIdx <= clist[iter++])
+    if (xIdx < clist[iter++])
       {
       return 1;
       }
@@ -462,15 +407,15 @@ void vtkImageStencilData::Fill( void )
   int n = this->NumberOfExtentEntries;
   for (int i = 0; i < n; i++)
     {
-    if (this->ExtentLists[i] != &this->ExtentListLengths[n + 2*i])
-      {
-      delete [] this->ExtentLists[i];
-      }
+    this->FreeExtentList(i);
     this->ExtentLists[i] = &this->ExtentListLengths[n + 2*i];
     this->ExtentLists[i][0] = r1;
     this->ExtentLists[i][1] = r2 + 1;
     this->ExtentListLengths[i] = 2;
     }
+  delete [] this->ExtentPool;
+  this->ExtentPool = NULL;
+  this->ExtentPoolSize = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -505,11 +450,7 @@ void vtkImageStencilData::InsertNextExtent(int r1, int r2, int yIdx, int zIdx)
         {
         newclist[k] = clist[k];
         }
-      int n = this->NumberOfExtentEntries;
-      if (clist != &this->ExtentListLengths[n + 2*incr])
-        {
-        delete [] clist;
-        }
+      this->FreeExtentList(incr);
       clist = newclist;
       }
     }
@@ -579,11 +520,7 @@ void vtkImageStencilData::InsertAndMergeExtent(int r1, int r2,
       {
       newclist[k] = clist[k];
       }
-    int n = this->NumberOfExtentEntries;
-    if (clist != &this->ExtentListLengths[n + 2*incr])
-      {
-      delete [] clist;
-      }
+    this->FreeExtentList(incr);
     clist = newclist;
     }
 
@@ -670,12 +607,8 @@ void vtkImageStencilData::RemoveExtent(int r1, int r2, int yIdx, int zIdx)
     {
     // remove the whole row.
     clistlen = 0;
-    int n = this->NumberOfExtentEntries;
-    if (clist != &this->ExtentListLengths[n + 2*incr])
-      {
-      delete [] clist;
-      clist = &this->ExtentListLengths[n + 2*incr];
-      }
+    this->FreeExtentList(incr);
+    clist = &this->ExtentListLengths[this->NumberOfExtentEntries + 2*incr];
     return;
     }
 
@@ -689,12 +622,8 @@ void vtkImageStencilData::RemoveExtent(int r1, int r2, int yIdx, int zIdx)
 
       if (clistlen == 0)
         {
-        int n = this->NumberOfExtentEntries;
-        if (clist != &this->ExtentListLengths[n + 2*incr])
-          {
-          delete [] clist;
-          clist = &this->ExtentListLengths[n + 2*incr];
-          }
+        this->FreeExtentList(incr);
+        clist = &this->ExtentListLengths[this->NumberOfExtentEntries + 2*incr];
         return;
         }
 
@@ -720,10 +649,7 @@ void vtkImageStencilData::RemoveExtent(int r1, int r2, int yIdx, int zIdx)
           {
           newclist[m-2] = clist[m];
           }
-        if (clist != &this->ExtentListLengths[n + 2*incr])
-          {
-          delete [] clist;
-          }
+        this->FreeExtentList(incr);
         clist = newclist;
         }
       else
@@ -734,11 +660,10 @@ void vtkImageStencilData::RemoveExtent(int r1, int r2, int yIdx, int zIdx)
           }
         }
 
+      // the next entry is now at k, look at it again
       length = clistlen;
-      if (k >= length)
-        {
-        return;
-        }
+      k -= 2;
+      continue;
       }
 
     if ((r1 >= clist[k] && r1 < clist[k+1]) ||
@@ -770,16 +695,18 @@ void vtkImageStencilData::RemoveExtent(int r1, int r2, int yIdx, int zIdx)
               {
               newclist[m] = clist[m];
               }
-            int n = this->NumberOfExtentEntries;
-            if (clist != &this->ExtentListLengths[n + 2*incr])
-              {
-              delete [] clist;
-              }
+            this->FreeExtentList(incr);
             clist = newclist;
             }
-          clist[clistlen] = r2+1;
-          clist[clistlen+1] = tmp;
+          // insert the remainder after this extent, to keep the list sorted
+          for (int m = clistlen - 1; m >= k+2; m--)
+            {
+            clist[m+2] = clist[m];
+            }
+          clist[k+2] = r2+1;
+          clist[k+3] = tmp;
           clistlen += 2;
+          return;
           }
         }
       else
@@ -807,49 +734,499 @@ vtkImageStencilData* vtkImageStencilData::GetData(vtkInformationVector* v,
 }
 
 //----------------------------------------------------------------------------
-void vtkImageStencilData::InternalAdd( vtkImageStencilData * stencil1 )
+// The union of the sorted extent list "a" with the sorted extent list "b"
+// clipped to [bmin,bmax), in which the extents that touch or overlap are
+// joined.  The lists hold half-open extents, and "out" must have room for
+// alen + blen values.
+static int vtkImageStencilDataUnion(
+  const int *a, int alen, const int *b, int blen, int bmin, int bmax,
+  int *out)
 {
-  int extent[6], extent1[6], extent2[6], r1, r2, idy, idz, iter=0;
-  stencil1->GetExtent(extent1);
-  this->GetExtent(extent2);
+  int n = 0;
+  int i = 0;
+  int j = 0;
+  for (;;)
+    {
+    // skip the extents of b that are clipped away
+    while (j < blen && (b[j] >= bmax || b[j+1] <= bmin || b[j+1] <= b[j]))
+      {
+      j += 2;
+      }
 
-  extent[0] = (extent1[0] < extent2[0]) ? extent2[0] : extent1[0];
-  extent[1] = (extent1[1] > extent2[1]) ? extent2[1] : extent1[1];
-  extent[2] = (extent1[2] < extent2[2]) ? extent2[2] : extent1[2];
-  extent[3] = (extent1[3] > extent2[3]) ? extent2[3] : extent1[3];
-  extent[4] = (extent1[4] < extent2[4]) ? extent2[4] : extent1[4];
-  extent[5] = (extent1[5] > extent2[5]) ? extent2[5] : extent1[5];
+    // take the extent that starts first
+    int r1, r2;
+    if (i < alen && (j >= blen || a[i] <= (b[j] > bmin ? b[j] : bmin)))
+      {
+      r1 = a[i];
+      r2 = a[i+1];
+      i += 2;
+      }
+    else if (j < blen)
+      {
+      r1 = (b[j] > bmin ? b[j] : bmin);
+      r2 = (b[j+1] < bmax ? b[j+1] : bmax);
+      j += 2;
+      }
+    else
+      {
+      break;
+      }
+
+    if (n > 0 && r1 <= out[n-1])
+      {
+      out[n-1] = (r2 > out[n-1] ? r2 : out[n-1]);
+      }
+    else if (r1 < r2)
+      {
+      out[n] = r1;
+      out[n+1] = r2;
+      n += 2;
+      }
+    }
+
+  return n;
+}
+
+//----------------------------------------------------------------------------
+// The difference of the sorted extent list "a" and the sorted extent list
+// "b" clipped to [bmin,bmax).  The lists hold half-open extents, and "out"
+// must have room for alen + blen values.
+static int vtkImageStencilDataDifference(
+  const int *a, int alen, const int *b, int blen, int bmin, int bmax,
+  int *out)
+{
+  int n = 0;
+  int j = 0;
+  for (int i = 0; i < alen; i += 2)
+    {
+    int r1 = a[i];
+    int r2 = a[i+1];
+
+    // skip the extents of b that end before this extent of a
+    while (j < blen && (b[j+1] <= r1 || b[j+1] <= bmin))
+      {
+      j += 2;
+      }
+
+    // cut the extents of b out of this extent of a
+    for (int k = j; k < blen && r1 < r2; k += 2)
+      {
+      int s1 = (b[k] > bmin ? b[k] : bmin);
+      int s2 = (b[k+1] < bmax ? b[k+1] : bmax);
+      if (s1 >= r2 || s1 >= bmax)
+        {
+        break;
+        }
+      if (s2 <= s1)
+        {
+        continue;
+        }
+      if (s1 > r1)
+        {
+        out[n] = r1;
+        out[n+1] = s1;
+        n += 2;
+        }
+      r1 = (s2 > r1 ? s2 : r1);
+      }
+
+    if (r1 < r2)
+      {
+      out[n] = r1;
+      out[n+1] = r2;
+      n += 2;
+      }
+    }
+
+  return n;
+}
+
+//----------------------------------------------------------------------------
+// Whether a list was allocated for its row alone, i.e. whether it is
+// neither stored in place nor in the pool.
+static bool vtkImageStencilDataOwnsList(
+  const int *list, const int *inPlace, const int *pool, size_t poolSize)
+{
+  return (list != inPlace && (list < pool || list >= pool + poolSize));
+}
+
+//----------------------------------------------------------------------------
+// The capacity of a list, which is the smallest power of two that is not
+// less than its length, as InsertNextExtent() expects.  Lists that fit in
+// two values are stored in place.
+static int vtkImageStencilDataCapacity(int length)
+{
+  int capacity = 2;
+  while (length > capacity)
+    {
+    capacity *= 2;
+    }
+  return capacity;
+}
+
+//----------------------------------------------------------------------------
+// The rows of a stencil, as seen by BuildExtentLists().
+struct vtkImageStencilDataRows
+{
+  int Extent[6];
+  int NumberOfEntries;
+  int **Lists;
+  int *Lengths;
+
+  // Get the list of row (y,z), or return false if it is not in the extent.
+  bool GetRow(int y, int z, const int *&list, int &length) const
+    {
+    if (this->Lists == 0 ||
+        y < this->Extent[2] || y > this->Extent[3] ||
+        z < this->Extent[4] || z > this->Extent[5])
+      {
+      return false;
+      }
+    int incr = (z - this->Extent[4])*(this->Extent[3] - this->Extent[2] + 1) +
+      (y - this->Extent[2]);
+    if (incr >= this->NumberOfEntries)
+      {
+      return false;
+      }
+    list = this->Lists[incr];
+    length = this->Lengths[incr];
+    return true;
+    }
+};
+
+//----------------------------------------------------------------------------
+// Build a range of rows.  Without Lists, only compute their Lengths.
+class vtkImageStencilDataBuildFunctor
+{
+public:
+  int Operation;
+  int Extent[6];
+  int Range[6];
+  vtkImageStencilDataRows Source;
+  vtkImageStencilDataRows Other;
+  int *Lengths;
+  int **Lists;
+  vtkSMPThreadLocal<std::vector<int> > Scratch;
+
+  // Compute one row into "out", with "tmp" as workspace.
+  int BuildRow(const int *a, int alen, const int *b, int blen,
+               bool inRange, int *out, int *tmp)
+    {
+    if (this->Operation == VTK_STENCIL_COPY || !inRange)
+      {
+      if (this->Operation == VTK_STENCIL_CLIP)
+        {
+        return 0;
+        }
+      std::copy(a, a + alen, out);
+      return alen;
+      }
+
+    int xmin = this->Range[0];
+    int xmax = this->Range[1] + 1;
+    switch (this->Operation)
+      {
+      case VTK_STENCIL_ADD:
+        return vtkImageStencilDataUnion(a, alen, b, blen, xmin, xmax, out);
+      case VTK_STENCIL_SUBTRACT:
+        return vtkImageStencilDataDifference(
+          a, alen, b, blen, xmin, xmax, out);
+      case VTK_STENCIL_REPLACE:
+        {
+        int span[2];
+        span[0] = xmin;
+        span[1] = xmax;
+        int m = vtkImageStencilDataDifference(
+          a, alen, span, 2, xmin, xmax, tmp);
+        return vtkImageStencilDataUnion(tmp, m, b, blen, xmin, xmax, out);
+        }
+      }
+
+    // VTK_STENCIL_CLIP
+    return vtkImageStencilDataUnion(0, 0, a, alen, xmin, xmax, out);
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    std::vector<int>& scratch = this->Scratch.Local();
+    int ySize = this->Extent[3] - this->Extent[2] + 1;
+
+    for (vtkIdType i = begin; i < end; i++)
+      {
+      int y = this->Extent[2] + static_cast<int>(i % ySize);
+      int z = this->Extent[4] + static_cast<int>(i / ySize);
+
+      const int *a = 0;
+      int alen = 0;
+      this->Source.GetRow(y, z, a, alen);
+      if (this->Lists == 0 && this->Operation == VTK_STENCIL_COPY)
+        {
+        this->Lengths[i] = alen;
+        continue;
+        }
+
+      bool inRange = (y >= this->Range[2] && y <= this->Range[3] &&
+                      z >= this->Range[4] && z <= this->Range[5]);
+      const int *b = 0;
+      int blen = 0;
+      if (inRange && this->Operation != VTK_STENCIL_CLIP)
+        {
+        this->Other.GetRow(y, z, b, blen);
+        }
+
+      // room for the row, and for the workspace of Replace()
+      size_t m = static_cast<size_t>(alen + blen + 2);
+      if (scratch.size() < 2*m)
+        {
+        scratch.resize(2*m);
+        }
+
+      if (this->Lists)
+        {
+        this->BuildRow(a, alen, b, blen, inRange, this->Lists[i],
+                       &scratch[m]);
+        }
+      else
+        {
+        this->Lengths[i] = this->BuildRow(a, alen, b, blen, inRange,
+                                          &scratch[0], &scratch[m]);
+        }
+      }
+    }
+};
 
-  bool modified = false;
-  for (idz=extent[4]; idz<=extent[5]; idz++, iter=0)
+//----------------------------------------------------------------------------
+// Rebuild the rows of a stencil that are within the range, in place.  The
+// rows are built in the workspace, then copied back into their list, which
+// is only reallocated if its capacity changes.
+class vtkImageStencilDataUpdateFunctor
+{
+public:
+  vtkImageStencilDataBuildFunctor *Builder;
+  int NumberOfEntries;
+  int *Lengths;
+  int **Lists;
+  const int *Pool;
+  size_t PoolSize;
+  vtkSMPThreadLocal<std::vector<int> > Scratch;
+
+  void operator()(vtkIdType begin, vtkIdType end)
     {
-    for (idy = extent[2]; idy <= extent[3]; idy++, iter=0)
+    std::vector<int>& scratch = this->Scratch.Local();
+    const int *range = this->Builder->Range;
+    const int *extent = this->Builder->Extent;
+    int ySize = range[3] - range[2] + 1;
+
+    for (vtkIdType r = begin; r < end; r++)
       {
-      int moreSubExtents = 1;
-      while( moreSubExtents )
+      int y = range[2] + static_cast<int>(r % ySize);
+      int z = range[4] + static_cast<int>(r / ySize);
+      int i = (z - extent[4])*(extent[3] - extent[2] + 1) + (y - extent[2]);
+
+      int *&list = this->Lists[i];
+      int &length = this->Lengths[i];
+      const int *b = 0;
+      int blen = 0;
+      this->Builder->Other.GetRow(y, z, b, blen);
+
+      size_t m = static_cast<size_t>(length + blen + 2);
+      if (scratch.size() < 2*m)
         {
-        moreSubExtents = stencil1->GetNextExtent(
-          r1, r2, extent[0], extent[1], idy, idz, iter);
+        scratch.resize(2*m);
+        }
+      int newLength = this->Builder->BuildRow(
+        list, length, b, blen, true, &scratch[0], &scratch[m]);
 
-        if (r1 <= r2 ) // sanity check
+      int capacity = vtkImageStencilDataCapacity(newLength);
+      if (capacity != vtkImageStencilDataCapacity(length))
+        {
+        int *inPlace = &this->Lengths[this->NumberOfEntries + 2*i];
+        if (vtkImageStencilDataOwnsList(list, inPlace, this->Pool,
+                                        this->PoolSize))
           {
-          this->InsertAndMergeExtent(r1, r2, idy, idz);
-          modified = true;
+          delete [] list;
           }
+        list = (capacity > 2 ? new int[capacity] : inPlace);
         }
+      std::copy(&scratch[0], &scratch[0] + newLength, list);
+      length = newLength;
       }
     }
+};
+
+//----------------------------------------------------------------------------
+void vtkImageStencilData::BuildExtentLists(
+  const int extent[6], vtkImageStencilData *source,
+  vtkImageStencilData *other, int operation, const int range[6])
+{
+  vtkImageStencilDataBuildFunctor functor;
+  functor.Operation = operation;
+  for (int k = 0; k < 6; k++)
+    {
+    functor.Extent[k] = extent[k];
+    functor.Range[k] = range[k];
+    functor.Source.Extent[k] = source->Extent[k];
+    functor.Other.Extent[k] = (other ? other->Extent[k] : 0);
+    }
+  functor.Source.NumberOfEntries = source->NumberOfExtentEntries;
+  functor.Other.NumberOfEntries = (other ? other->NumberOfExtentEntries : 0);
+  functor.Source.Lists = source->ExtentLists;
+  functor.Source.Lengths = source->ExtentListLengths;
+  functor.Other.Lists = (other ? other->ExtentLists : 0);
+  functor.Other.Lengths = (other ? other->ExtentListLengths : 0);
+
+  int ySize = extent[3] - extent[2] + 1;
+  int zSize = extent[5] - extent[4] + 1;
+  int n = (ySize > 0 && zSize > 0 ? ySize*zSize : 0);
+
+  int *lengths = NULL;
+  int **lists = NULL;
+  int *pool = NULL;
+  size_t poolSize = 0;
+
+  if (n > 0)
+    {
+    // first compute the length of every row
+    lengths = new int[3*n];
+    lists = new int *[n];
+    functor.Lengths = lengths;
+    functor.Lists = NULL;
+    vtkSMPTools::For(0, n, functor);
+
+    // the lists that do not fit in place are stored in the pool
+    std::vector<int> capacities(n, 0);
+    for (int i = 0; i < n; i++)
+      {
+      int capacity = vtkImageStencilDataCapacity(lengths[i]);
+      if (capacity > 2)
+        {
+        capacities[i] = capacity;
+        poolSize += capacity;
+        }
+      }
+    if (poolSize)
+      {
+      pool = new int[poolSize];
+      }
+    size_t offset = 0;
+    for (int i = 0; i < n; i++)
+      {
+      lists[i] = &lengths[n + 2*i];
+      if (capacities[i])
+        {
+        lists[i] = pool + offset;
+        offset += capacities[i];
+        }
+      }
+
+    // then build the rows into their storage
+    functor.Lists = lists;
+    vtkSMPTools::For(0, n, functor);
+    }
+
+  // the source might be this stencil, so delete the old lists last
+  this->DeleteExtentLists();
+  this->NumberOfExtentEntries = n;
+  this->ExtentListLengths = lengths;
+  this->ExtentLists = lists;
+  this->ExtentPool = pool;
+  this->ExtentPoolSize = poolSize;
+  memcpy(this->Extent, functor.Extent, 6*sizeof(int));
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStencilData::UpdateExtentLists(
+  vtkImageStencilData *other, int operation, const int range[6])
+{
+  vtkImageStencilDataBuildFunctor builder;
+  builder.Operation = operation;
+  for (int k = 0; k < 6; k++)
+    {
+    builder.Extent[k] = this->Extent[k];
+    builder.Range[k] = range[k];
+    builder.Other.Extent[k] = other->Extent[k];
+    }
+  builder.Other.NumberOfEntries = other->NumberOfExtentEntries;
+  builder.Other.Lists = other->ExtentLists;
+  builder.Other.Lengths = other->ExtentListLengths;
+
+  vtkImageStencilDataUpdateFunctor functor;
+  functor.Builder = &builder;
+  functor.NumberOfEntries = this->NumberOfExtentEntries;
+  functor.Lengths = this->ExtentListLengths;
+  functor.Lists = this->ExtentLists;
+  functor.Pool = this->ExtentPool;
+  functor.PoolSize = this->ExtentPoolSize;
+
+  vtkIdType n = static_cast<vtkIdType>(range[3] - range[2] + 1)*
+    (range[5] - range[4] + 1);
+  vtkSMPTools::For(0, n, functor);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStencilData::FreeExtentList(int incr)
+{
+  int *clist = this->ExtentLists[incr];
+  if (vtkImageStencilDataOwnsList(
+        clist, &this->ExtentListLengths[this->NumberOfExtentEntries + 2*incr],
+        this->ExtentPool, this->ExtentPoolSize))
+    {
+    delete [] clist;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStencilData::DeleteExtentLists()
+{
+  if (this->ExtentLists)
+    {
+    int n = this->NumberOfExtentEntries;
+    for (int i = 0; i < n; i++)
+      {
+      this->FreeExtentList(i);
+      }
+    delete [] this->ExtentLists;
+    }
+  this->ExtentLists = NULL;
+  this->NumberOfExtentEntries = 0;
+
+  delete [] this->ExtentListLengths;
+  this->ExtentListLengths = NULL;
+
+  delete [] this->ExtentPool;
+  this->ExtentPool = NULL;
+  this->ExtentPoolSize = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStencilData::InternalAdd( vtkImageStencilData * stencil1 )
+{
+  int extent[6], extent1[6], extent2[6];
+  stencil1->GetExtent(extent1);
+  this->GetExtent(extent2);
+
+  extent[0] = (extent1[0] < extent2[0]) ? extent2[0] : extent1[0];
+  extent[1] = (extent1[1] > extent2[1]) ? extent2[1] : extent1[1];
+  extent[2] = (extent1[2] < extent2[2]) ? extent2[2] : extent1[2];
+  extent[3] = (extent1[3] > extent2[3]) ? extent2[3] : extent1[3];
+  extent[4] = (extent1[4] < extent2[4]) ? extent2[4] : extent1[4];
+  extent[5] = (extent1[5] > extent2[5]) ? extent2[5] : extent1[5];
 
-  if (modified)
+  if (extent[0] > extent[1] ||
+      extent[2] > extent[3] ||
+      extent[4] > extent[5])
     {
-    this->Modified();
+    return;
     }
+
+  this->UpdateExtentLists(stencil1, VTK_STENCIL_ADD, extent);
+  this->Modified();
 }
 
 //----------------------------------------------------------------------------
 void vtkImageStencilData::Add( vtkImageStencilData * stencil1 )
 {
-  int extent[6], extent1[6], extent2[6], r1, r2, idy, idz, iter=0;
+  int extent[6], extent1[6], extent2[6];
   stencil1->GetExtent(extent1);
   this->GetExtent(extent2);
 
@@ -864,18 +1241,12 @@ void vtkImageStencilData::Add( vtkImageStencilData * stencil1 )
     {
 
     // Extents of stencil1 are entirely within the Self's extents. There
-    // is no need to re-allocate the extent lists.
+    // is no need to enlarge the stencil.
 
     this->InternalAdd(stencil1);
     return;
     }
 
-  // Need to reallocate extent lists.
-  // 1. We will create a temporary stencil data.
-  // 2. Copy Self into this temporary stencil.
-  // 3. Reallocate Self's extents to match the resized stencil.
-  // 4. Merge stencil data from both into the Self.
-
   // Find the smallest bounding box large enough to hold both stencils.
   extent[0] = (extent1[0] > extent2[0]) ? extent2[0] : extent1[0];
   extent[1] = (extent1[1] < extent2[1]) ? extent2[1] : extent1[1];
@@ -884,57 +1255,15 @@ void vtkImageStencilData::Add( vtkImageStencilData * stencil1 )
   extent[4] = (extent1[4] > extent2[4]) ? extent2[4] : extent1[4];
   extent[5] = (extent1[5] < extent2[5]) ? extent2[5] : extent1[5];
 
-  vtkImageStencilData *tmp = vtkImageStencilData::New();
-  tmp->DeepCopy(this);
-
-  this->SetExtent(extent);
-  this->AllocateExtents(); // Reallocate extents.
-
-  for (idz=extent2[4]; idz<=extent2[5]; idz++, iter=0)
-    {
-    for (idy = extent2[2]; idy <= extent2[3]; idy++, iter=0)
-      {
-      int moreSubExtents = 1;
-      while( moreSubExtents )
-        {
-        moreSubExtents = tmp->GetNextExtent(
-          r1, r2, extent[0], extent[1], idy, idz, iter);
-
-        if (r1 <= r2 ) // sanity check
-          {
-          this->InsertAndMergeExtent(r1, r2, idy, idz);
-          }
-        }
-      }
-    }
-
-  tmp->Delete();
-
-  for (idz=extent1[4]; idz<=extent1[5]; idz++, iter=0)
-    {
-    for (idy = extent1[2]; idy <= extent1[3]; idy++, iter=0)
-      {
-      int moreSubExtents = 1;
-      while( moreSubExtents )
-        {
-        moreSubExtents = stencil1->GetNextExtent(
-          r1, r2, extent[0], extent[1], idy, idz, iter);
-
-        if (r1 <= r2 ) // sanity check
-          {
-          this->InsertAndMergeExtent(r1, r2, idy, idz);
-          }
-        }
-      }
-    }
-
+  // Build the rows of the enlarged stencil from the rows of both stencils.
+  this->BuildExtentLists(extent, this, stencil1, VTK_STENCIL_ADD, extent);
   this->Modified();
 }
 
 //----------------------------------------------------------------------------
 void vtkImageStencilData::Subtract( vtkImageStencilData * stencil1 )
 {
-  int extent[6], extent1[6], extent2[6], r1, r2, idy, idz, iter=0;
+  int extent[6], extent1[6], extent2[6];
   stencil1->GetExtent(extent1);
   this->GetExtent(extent2);
 
@@ -954,31 +1283,14 @@ void vtkImageStencilData::Subtract( vtkImageStencilData * stencil1 )
   extent[4] = (extent1[4] < extent2[4]) ? extent2[4] : extent1[4];
   extent[5] = (extent1[5] > extent2[5]) ? extent2[5] : extent1[5];
 
-  for (idz=extent[4]; idz<=extent[5]; idz++, iter=0)
-    {
-    for (idy = extent[2]; idy <= extent[3]; idy++, iter=0)
-      {
-      int moreSubExtents = 1;
-      while( moreSubExtents )
-        {
-        moreSubExtents = stencil1->GetNextExtent(
-          r1, r2, extent[0], extent[1], idy, idz, iter);
-
-        if (r1 <= r2 ) // sanity check
-          {
-          this->RemoveExtent(r1, r2, idy, idz);
-          }
-        }
-      }
-    }
-
+  this->UpdateExtentLists(stencil1, VTK_STENCIL_SUBTRACT, extent);
   this->Modified();
 }
 
 //----------------------------------------------------------------------------
 void vtkImageStencilData::Replace( vtkImageStencilData * stencil1 )
 {
-  int extent[6], extent1[6], extent2[6], r1, r2, idy, idz, iter=0;
+  int extent[6], extent1[6], extent2[6];
   stencil1->GetExtent(extent1);
   this->GetExtent(extent2);
 
@@ -998,33 +1310,14 @@ void vtkImageStencilData::Replace( vtkImageStencilData * stencil1 )
   extent[4] = (extent1[4] < extent2[4]) ? extent2[4] : extent1[4];
   extent[5] = (extent1[5] > extent2[5]) ? extent2[5] : extent1[5];
 
-  for (idz=extent[4]; idz<=extent[5]; idz++, iter=0)
-    {
-    for (idy = extent[2]; idy <= extent[3]; idy++, iter=0)
-      {
-      this->RemoveExtent(extent[0], extent[1], idy, idz);
-
-      int moreSubExtents = 1;
-      while( moreSubExtents )
-        {
-        moreSubExtents = stencil1->GetNextExtent(
-          r1, r2, extent[0], extent[1], idy, idz, iter);
-
-        if (r1 <= r2 ) // sanity check
-          {
-          this->InsertAndMergeExtent(r1, r2, idy, idz);
-          }
-        }
-      }
-    }
-
+  this->UpdateExtentLists(stencil1, VTK_STENCIL_REPLACE, extent);
   this->Modified();
 }
 
 //----------------------------------------------------------------------------
 int vtkImageStencilData::Clip( int extent[6] )
 {
-  int currentExtent[6], idy, idz;
+  int currentExtent[6];
   this->GetExtent( currentExtent );
 
   if (vtkMath::ExtentIsWithinOtherExtent( currentExtent, extent ))
@@ -1033,40 +1326,10 @@ int vtkImageStencilData::Clip( int extent[6] )
     return 0;
     }
 
-  bool removeXLeft  = (extent[0] > currentExtent[0]);
-  bool removeXRight = (extent[1] < currentExtent[1]);
-  bool remove = false, removed = false;
+  // Discard the rows outside of the extent, and clip the others in x.
+  this->BuildExtentLists(currentExtent, this, NULL, VTK_STENCIL_CLIP, extent);
 
-  for (idz=currentExtent[4]; idz<=currentExtent[5]; idz++)
-    {
-    remove = (idz < extent[4] || idz > extent[5]);
-    for (idy = currentExtent[2]; idy <= currentExtent[3]; idy++)
-      {
-      if (remove || idy < extent[2] || idy > extent[3])
-        {
-        // Remove everything at Y = idy, Z = idz.
-        this->RemoveExtent( currentExtent[0],currentExtent[1], idy, idz );
-        removed |= true;
-        }
-      else
-        {
-        if (removeXLeft)
-          {
-          // Clip on the left at Y = idy, Z = idz.
-          this->RemoveExtent( currentExtent[0], extent[0]-1, idy, idz );
-          removed |= true;
-          }
-        if (removeXRight)
-          {
-          // Clip on the right at Y = idy, Z = idz.
-          this->RemoveExtent( extent[1]+1, currentExtent[1], idy, idz );
-          removed |= true;
-          }
-        }
-      }
-    }
-
-  return (removed ? 1 : 0);
+  return 1;
 }
 
 //----------------------------------------------------------------------------
@@ -18,6 +18,11 @@
 // efficient both in terms of speed and storage space.  The stencil extents
 // are stored for each x-row across the image (multiple extents per row if
 // necessary) and can be retrieved via the GetNextExtent() method.
+//
+// The Add(), Subtract(), Replace() and Clip() operations and the copies
+// rebuild all the rows in parallel, and store the resulting extents in a
+// single contiguous block of memory rather than with one allocation per
+// row.
 // .SECTION see also
 // vtkImageStencilSource vtkImageStencil
 
@@ -168,6 +173,31 @@ protected:
   void CollapseAdditionalIntersections(int r2, int idx, int *clist,
     int &clistlen);
 
+  // Description:
+  // Build the extent lists for the given extent in parallel, from the
+  // rows of the source and, within the range, of the other stencil.
+  // The operation is one of the operations defined in the .cxx file.
+  // The source and the other stencil can be this stencil.
+  void BuildExtentLists(const int extent[6], vtkImageStencilData *source,
+                        vtkImageStencilData *other, int operation,
+                        const int range[6]);
+
+  // Description:
+  // Rebuild in parallel the rows of this stencil that are within the
+  // range, from their lists and from the rows of the other stencil.  The
+  // other rows are left as they are.  The range must be within the extent.
+  void UpdateExtentLists(vtkImageStencilData *other, int operation,
+                         const int range[6]);
+
+  // Description:
+  // Free the list of row "incr" if it was allocated for that row alone,
+  // i.e. if it is neither stored in place nor in the ExtentPool.
+  void FreeExtentList(int incr);
+
+  // Description:
+  // Free all of the extent lists.
+  void DeleteExtentLists();
+
   // Description:
   // The Spacing and Origin of the data.
   double Spacing[3];
@@ -181,6 +211,12 @@ protected:
   int *ExtentListLengths;
   int **ExtentLists;
 
+  // Description:
+  // The contiguous storage for the lists that were built together by
+  // BuildExtentLists(), and its size.
+  int *ExtentPool;
+  size_t ExtentPoolSize;
+
 private:
   vtkImageStencilData(const vtkImageStencilData&);  // Not implemented.
   void operator=(const vtkImageStencilData&);  // Not implemented.
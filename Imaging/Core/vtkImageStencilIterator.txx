@@ -23,6 +23,8 @@
 #include "vtkImageStencilData.h"
 #include "vtkAlgorithm.h"
 
+#include <algorithm>
+
 //----------------------------------------------------------------------------
 class vtkImageStencilIteratorFriendship
 {
@@ -88,6 +90,9 @@ void vtkImageStencilIterator<DType>::Initialize(
   image->GetContinuousIncrements(
     extent, tmp, this->RowEndIncrement, this->SliceEndIncrement);
 
+  // the continuous slice increment is taken after the row end increment
+  this->SliceEndIncrement += this->RowEndIncrement;
+
   this->Pointer = static_cast<DType *>(
     image->GetScalarPointerForExtent(extent));
 
@@ -259,19 +264,11 @@ vtkImageStencilIterator<DType>::vtkImageStencilIterator(
 template <class DType>
 void vtkImageStencilIterator<DType>::SetSpanState(int idX)
 {
-  // Find the span that includes idX
-  bool inStencil = false;
+  // Find the span that includes idX, the spans are sorted
   int *spans = *this->SpanListPointer;
   int n = *this->SpanCountPointer;
-  int i;
-  for (i = 0; i < n; i++)
-    {
-    if (spans[i] > idX)
-      {
-      break;
-      }
-    inStencil = !inStencil;
-    }
+  int i = static_cast<int>(std::upper_bound(spans, spans + n, idX) - spans);
+  bool inStencil = ((i & 1) != 0);
 
   // Set the primary span state variables
   this->SpanIndexX = i;
@@ -339,7 +336,26 @@ void vtkImageStencilIterator<DType>::NextSpan()
         {
         this->SpanCountPointer += spanIncr;
         this->SpanListPointer += spanIncr;
-        this->SetSpanState(this->SpanMinX);
+
+        // Fast path for rows that are empty or that are a single span
+        // across the whole extent, the pointers are already set
+        int n = *this->SpanCountPointer;
+        int *spans = *this->SpanListPointer;
+        if (n == 0)
+          {
+          this->SpanIndexX = 0;
+          this->InStencil = false;
+          }
+        else if (n == 2 && spans[0] <= this->SpanMinX &&
+                 spans[1] > this->SpanMaxX)
+          {
+          this->SpanIndexX = 1;
+          this->InStencil = true;
+          }
+        else
+          {
+          this->SetSpanState(this->SpanMinX);
+          }
         }
       else
         {
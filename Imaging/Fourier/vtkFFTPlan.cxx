@@ -0,0 +1,508 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkFFTPlan.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkFFTPlan.h"
+
+#include "vtkMath.h"
+
+#include <math.h>
+
+// The largest prime factor transformed by the Stockham algorithm, larger
+// ones use Bluestein's algorithm.
+static const int vtkFFTPlanMaxRadix = 13;
+
+namespace
+{
+//----------------------------------------------------------------------------
+inline vtkImageComplex vtkFFTMake(double real, double imag)
+{
+  vtkImageComplex c;
+  c.Real = real;
+  c.Imag = imag;
+  return c;
+}
+
+inline vtkImageComplex vtkFFTAdd(const vtkImageComplex& a,
+                                 const vtkImageComplex& b)
+{
+  return vtkFFTMake(a.Real + b.Real, a.Imag + b.Imag);
+}
+
+inline vtkImageComplex vtkFFTSub(const vtkImageComplex& a,
+                                 const vtkImageComplex& b)
+{
+  return vtkFFTMake(a.Real - b.Real, a.Imag - b.Imag);
+}
+
+inline vtkImageComplex vtkFFTMul(const vtkImageComplex& a,
+                                 const vtkImageComplex& b)
+{
+  return vtkFFTMake(a.Real*b.Real - a.Imag*b.Imag,
+                    a.Real*b.Imag + a.Imag*b.Real);
+}
+
+inline vtkImageComplex vtkFFTConj(const vtkImageComplex& a)
+{
+  return vtkFFTMake(a.Real, -a.Imag);
+}
+
+// a*(-i)
+inline vtkImageComplex vtkFFTMulMinusI(const vtkImageComplex& a)
+{
+  return vtkFFTMake(a.Imag, -a.Real);
+}
+
+// exp(-2*pi*i*k/n)
+inline vtkImageComplex vtkFFTRoot(vtkTypeInt64 k, vtkTypeInt64 n)
+{
+  double angle = -2.0*vtkMath::Pi()*static_cast<double>(k % n)/n;
+  return vtkFFTMake(cos(angle), sin(angle));
+}
+
+//----------------------------------------------------------------------------
+// The butterflies of one stage of the Stockham algorithm: the sequences
+// of x, of length p*m with stride s, are split into p sequences of length
+// m with stride s*p into y. The twiddle factors of the stage are tw[i*(p-1)
+// + j-1] = exp(-2*pi*i*j/(p*m)).
+void vtkFFTRadix2(const vtkImageComplex *x, vtkImageComplex *y,
+                  int m, int s, const vtkImageComplex *tw)
+{
+  for (int i = 0; i < m; ++i)
+    {
+    vtkImageComplex t1 = tw[i];
+    const vtkImageComplex *x0 = x + s*i;
+    const vtkImageComplex *x1 = x + s*(i + m);
+    vtkImageComplex *y0 = y + s*2*i;
+    vtkImageComplex *y1 = y0 + s;
+    for (int q = 0; q < s; ++q)
+      {
+      vtkImageComplex a = x0[q];
+      vtkImageComplex b = x1[q];
+      y0[q] = vtkFFTAdd(a, b);
+      y1[q] = vtkFFTMul(vtkFFTSub(a, b), t1);
+      }
+    }
+}
+
+void vtkFFTRadix3(const vtkImageComplex *x, vtkImageComplex *y,
+                  int m, int s, const vtkImageComplex *tw)
+{
+  const double c = -0.5;
+  const double sn = 0.5*sqrt(3.0);
+  for (int i = 0; i < m; ++i)
+    {
+    vtkImageComplex t1 = tw[2*i];
+    vtkImageComplex t2 = tw[2*i + 1];
+    for (int q = 0; q < s; ++q)
+      {
+      vtkImageComplex a0 = x[q + s*i];
+      vtkImageComplex a1 = x[q + s*(i + m)];
+      vtkImageComplex a2 = x[q + s*(i + 2*m)];
+      vtkImageComplex u = vtkFFTAdd(a1, a2);
+      vtkImageComplex v = vtkFFTSub(a1, a2);
+      vtkImageComplex w = vtkFFTMake(a0.Real + c*u.Real, a0.Imag + c*u.Imag);
+      vtkImageComplex r = vtkFFTMulMinusI(vtkFFTMake(sn*v.Real, sn*v.Imag));
+      vtkImageComplex *yi = y + q + s*3*i;
+      yi[0] = vtkFFTAdd(a0, u);
+      yi[s] = vtkFFTMul(vtkFFTAdd(w, r), t1);
+      yi[2*s] = vtkFFTMul(vtkFFTSub(w, r), t2);
+      }
+    }
+}
+
+void vtkFFTRadix4(const vtkImageComplex *x, vtkImageComplex *y,
+                  int m, int s, const vtkImageComplex *tw)
+{
+  for (int i = 0; i < m; ++i)
+    {
+    vtkImageComplex t1 = tw[3*i];
+    vtkImageComplex t2 = tw[3*i + 1];
+    vtkImageComplex t3 = tw[3*i + 2];
+    for (int q = 0; q < s; ++q)
+      {
+      vtkImageComplex a0 = x[q + s*i];
+      vtkImageComplex a1 = x[q + s*(i + m)];
+      vtkImageComplex a2 = x[q + s*(i + 2*m)];
+      vtkImageComplex a3 = x[q + s*(i + 3*m)];
+      vtkImageComplex u0 = vtkFFTAdd(a0, a2);
+      vtkImageComplex u1 = vtkFFTSub(a0, a2);
+      vtkImageComplex u2 = vtkFFTAdd(a1, a3);
+      vtkImageComplex u3 = vtkFFTMulMinusI(vtkFFTSub(a1, a3));
+      vtkImageComplex *yi = y + q + s*4*i;
+      yi[0] = vtkFFTAdd(u0, u2);
+      yi[s] = vtkFFTMul(vtkFFTAdd(u1, u3), t1);
+      yi[2*s] = vtkFFTMul(vtkFFTSub(u0, u2), t2);
+      yi[3*s] = vtkFFTMul(vtkFFTSub(u1, u3), t3);
+      }
+    }
+}
+
+void vtkFFTRadix5(const vtkImageComplex *x, vtkImageComplex *y,
+                  int m, int s, const vtkImageComplex *tw)
+{
+  const double c1 = cos(0.4*vtkMath::Pi());
+  const double c2 = cos(0.8*vtkMath::Pi());
+  const double s1 = sin(0.4*vtkMath::Pi());
+  const double s2 = sin(0.8*vtkMath::Pi());
+  for (int i = 0; i < m; ++i)
+    {
+    const vtkImageComplex *t = tw + 4*i;
+    for (int q = 0; q < s; ++q)
+      {
+      vtkImageComplex a0 = x[q + s*i];
+      vtkImageComplex a1 = x[q + s*(i + m)];
+      vtkImageComplex a2 = x[q + s*(i + 2*m)];
+      vtkImageComplex a3 = x[q + s*(i + 3*m)];
+      vtkImageComplex a4 = x[q + s*(i + 4*m)];
+      vtkImageComplex u1 = vtkFFTAdd(a1, a4);
+      vtkImageComplex u2 = vtkFFTAdd(a2, a3);
+      vtkImageComplex u3 = vtkFFTSub(a1, a4);
+      vtkImageComplex u4 = vtkFFTSub(a2, a3);
+      vtkImageComplex w1 = vtkFFTMake(a0.Real + c1*u1.Real + c2*u2.Real,
+                                      a0.Imag + c1*u1.Imag + c2*u2.Imag);
+      vtkImageComplex w2 = vtkFFTMake(a0.Real + c2*u1.Real + c1*u2.Real,
+                                      a0.Imag + c2*u1.Imag + c1*u2.Imag);
+      vtkImageComplex r1 = vtkFFTMulMinusI(
+        vtkFFTMake(s1*u3.Real + s2*u4.Real, s1*u3.Imag + s2*u4.Imag));
+      vtkImageComplex r2 = vtkFFTMulMinusI(
+        vtkFFTMake(s2*u3.Real - s1*u4.Real, s2*u3.Imag - s1*u4.Imag));
+      vtkImageComplex *yi = y + q + s*5*i;
+      yi[0] = vtkFFTAdd(a0, vtkFFTAdd(u1, u2));
+      yi[s] = vtkFFTMul(vtkFFTAdd(w1, r1), t[0]);
+      yi[2*s] = vtkFFTMul(vtkFFTAdd(w2, r2), t[1]);
+      yi[3*s] = vtkFFTMul(vtkFFTSub(w2, r2), t[2]);
+      yi[4*s] = vtkFFTMul(vtkFFTSub(w1, r1), t[3]);
+      }
+    }
+}
+
+// Any radix p up to vtkFFTPlanMaxRadix, roots[k] = exp(-2*pi*i*k/p).
+void vtkFFTRadixN(const vtkImageComplex *x, vtkImageComplex *y,
+                  int p, int m, int s, const vtkImageComplex *tw,
+                  const vtkImageComplex *roots)
+{
+  vtkImageComplex a[vtkFFTPlanMaxRadix];
+  for (int i = 0; i < m; ++i)
+    {
+    const vtkImageComplex *t = tw + (p - 1)*i;
+    for (int q = 0; q < s; ++q)
+      {
+      for (int k = 0; k < p; ++k)
+        {
+        a[k] = x[q + s*(i + k*m)];
+        }
+      vtkImageComplex *yi = y + q + s*p*i;
+      for (int j = 0; j < p; ++j)
+        {
+        vtkImageComplex b = a[0];
+        for (int k = 1; k < p; ++k)
+          {
+          b = vtkFFTAdd(b, vtkFFTMul(a[k], roots[(j*k) % p]));
+          }
+        yi[j*s] = (j == 0 ? b : vtkFFTMul(b, t[j - 1]));
+        }
+      }
+    }
+}
+}
+
+//----------------------------------------------------------------------------
+vtkFFTPlan::vtkFFTPlan()
+{
+  this->Size = 0;
+  this->WorkSize = 0;
+  this->ConvolutionPlan = 0;
+  this->HalfPlan = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkFFTPlan::~vtkFFTPlan()
+{
+  this->Clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkFFTPlan::Clear()
+{
+  delete this->ConvolutionPlan;
+  this->ConvolutionPlan = 0;
+  delete this->HalfPlan;
+  this->HalfPlan = 0;
+  this->Stages.clear();
+  this->Twiddles.clear();
+  this->Roots.clear();
+  this->Chirp.clear();
+  this->ChirpSpectrum.clear();
+  this->RealTwiddles.clear();
+  this->Size = 0;
+  this->WorkSize = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkFFTPlan::Initialize(int n, int real)
+{
+  this->Clear();
+  if (n <= 0)
+    {
+    return;
+    }
+  this->Size = n;
+  this->WorkSize = n;
+
+  // factor the size, radix 4 first
+  std::vector<int> factors;
+  int rest = n;
+  while (rest % 4 == 0)
+    {
+    factors.push_back(4);
+    rest /= 4;
+    }
+  for (int f = 2; f*f <= rest; f += (f == 2 ? 1 : 2))
+    {
+    while (rest % f == 0)
+      {
+      factors.push_back(f);
+      rest /= f;
+      }
+    }
+  if (rest > 1)
+    {
+    factors.push_back(rest);
+    }
+
+  if (!factors.empty() && factors.back() > vtkFFTPlanMaxRadix)
+    {
+    // Bluestein: X[j] = w[j] * sum of (x[k]*w[k]) * conj(w[j-k]) with
+    // w[k] = exp(-pi*i*k*k/n), a convolution computed with a power of two
+    int m = 1;
+    while (m < 2*n - 1)
+      {
+      m *= 2;
+      }
+    this->ConvolutionPlan = new vtkFFTPlan;
+    this->ConvolutionPlan->Initialize(m);
+    this->Chirp.resize(n);
+    for (int k = 0; k < n; ++k)
+      {
+      vtkTypeInt64 k2 = static_cast<vtkTypeInt64>(k)*k;
+      this->Chirp[k] = vtkFFTRoot(k2, 2*static_cast<vtkTypeInt64>(n));
+      }
+    this->ChirpSpectrum.assign(m, vtkFFTMake(0.0, 0.0));
+    this->ChirpSpectrum[0] = vtkFFTConj(this->Chirp[0]);
+    for (int k = 1; k < n; ++k)
+      {
+      this->ChirpSpectrum[k] = vtkFFTConj(this->Chirp[k]);
+      this->ChirpSpectrum[m - k] = vtkFFTConj(this->Chirp[k]);
+      }
+    std::vector<vtkImageComplex> work(this->ConvolutionPlan->GetWorkSize());
+    this->ConvolutionPlan->Forward(&this->ChirpSpectrum[0], &work[0]);
+    for (int k = 0; k < m; ++k)
+      {
+      this->ChirpSpectrum[k].Real /= m;
+      this->ChirpSpectrum[k].Imag /= m;
+      }
+    this->WorkSize = m + this->ConvolutionPlan->GetWorkSize();
+    }
+  else
+    {
+    int length = n;
+    for (size_t f = 0; f < factors.size(); ++f)
+      {
+      Stage stage;
+      stage.Radix = factors[f];
+      stage.Length = length;
+      stage.TwiddleOffset = this->Twiddles.size();
+      stage.RootOffset = this->Roots.size();
+      int p = stage.Radix;
+      int m = length/p;
+      for (int i = 0; i < m; ++i)
+        {
+        for (int j = 1; j < p; ++j)
+          {
+          this->Twiddles.push_back(
+            vtkFFTRoot(static_cast<vtkTypeInt64>(i)*j, length));
+          }
+        }
+      if (p != 2 && p != 3 && p != 4 && p != 5)
+        {
+        for (int k = 0; k < p; ++k)
+          {
+          this->Roots.push_back(vtkFFTRoot(k, p));
+          }
+        }
+      this->Stages.push_back(stage);
+      length = m;
+      }
+    }
+
+  // real sequences of even size are packed into complex ones
+  if (real && n % 2 == 0)
+    {
+    int h = n/2;
+    this->HalfPlan = new vtkFFTPlan;
+    this->HalfPlan->Initialize(h);
+    this->RealTwiddles.resize(h + 1);
+    for (int k = 0; k <= h; ++k)
+      {
+      this->RealTwiddles[k] = vtkFFTRoot(k, n);
+      }
+    int realWorkSize = h + this->HalfPlan->GetWorkSize();
+    if (realWorkSize > this->WorkSize)
+      {
+      this->WorkSize = realWorkSize;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkFFTPlan::Stockham(vtkImageComplex *data, vtkImageComplex *work) const
+{
+  vtkImageComplex *x = data;
+  vtkImageComplex *y = work;
+  int s = 1;
+  for (size_t i = 0; i < this->Stages.size(); ++i)
+    {
+    const Stage& stage = this->Stages[i];
+    int p = stage.Radix;
+    int m = stage.Length/p;
+    const vtkImageComplex *tw = &this->Twiddles[0] + stage.TwiddleOffset;
+    switch (p)
+      {
+      case 2:
+        vtkFFTRadix2(x, y, m, s, tw);
+        break;
+      case 3:
+        vtkFFTRadix3(x, y, m, s, tw);
+        break;
+      case 4:
+        vtkFFTRadix4(x, y, m, s, tw);
+        break;
+      case 5:
+        vtkFFTRadix5(x, y, m, s, tw);
+        break;
+      default:
+        vtkFFTRadixN(x, y, p, m, s, tw, &this->Roots[0] + stage.RootOffset);
+        break;
+      }
+    s *= p;
+    vtkImageComplex *tmp = x;
+    x = y;
+    y = tmp;
+    }
+  if (x != data)
+    {
+    for (int k = 0; k < this->Size; ++k)
+      {
+      data[k] = x[k];
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkFFTPlan::Bluestein(vtkImageComplex *data, vtkImageComplex *work) const
+{
+  int n = this->Size;
+  int m = this->ConvolutionPlan->GetSize();
+  vtkImageComplex *a = work;
+  vtkImageComplex *convolutionWork = work + m;
+  for (int k = 0; k < n; ++k)
+    {
+    a[k] = vtkFFTMul(data[k], this->Chirp[k]);
+    }
+  for (int k = n; k < m; ++k)
+    {
+    a[k] = vtkFFTMake(0.0, 0.0);
+    }
+  this->ConvolutionPlan->Forward(a, convolutionWork);
+  // the inverse transform, as the conjugate of the forward one
+  for (int k = 0; k < m; ++k)
+    {
+    a[k] = vtkFFTConj(vtkFFTMul(a[k], this->ChirpSpectrum[k]));
+    }
+  this->ConvolutionPlan->Forward(a, convolutionWork);
+  for (int k = 0; k < n; ++k)
+    {
+    data[k] = vtkFFTMul(vtkFFTConj(a[k]), this->Chirp[k]);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkFFTPlan::Forward(vtkImageComplex *data, vtkImageComplex *work) const
+{
+  if (this->ConvolutionPlan)
+    {
+    this->Bluestein(data, work);
+    }
+  else
+    {
+    this->Stockham(data, work);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkFFTPlan::Backward(vtkImageComplex *data, vtkImageComplex *work) const
+{
+  int n = this->Size;
+  for (int k = 0; k < n; ++k)
+    {
+    data[k].Imag = -data[k].Imag;
+    }
+  this->Forward(data, work);
+  for (int k = 0; k < n; ++k)
+    {
+    data[k].Real = data[k].Real/n;
+    data[k].Imag = -data[k].Imag/n;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkFFTPlan::ForwardReal(const double *in, vtkImageComplex *out,
+                             vtkImageComplex *work) const
+{
+  int n = this->Size;
+  if (!this->HalfPlan)
+    {
+    for (int k = 0; k < n; ++k)
+      {
+      out[k] = vtkFFTMake(in[k], 0.0);
+      }
+    this->Forward(out, work);
+    return;
+    }
+
+  // transform the even and odd samples as one complex sequence z, then
+  // separate them: X[k] = E[k] + exp(-2*pi*i*k/n)*O[k]
+  int h = n/2;
+  vtkImageComplex *z = work;
+  for (int k = 0; k < h; ++k)
+    {
+    z[k] = vtkFFTMake(in[2*k], in[2*k + 1]);
+    }
+  this->HalfPlan->Forward(z, work + h);
+  for (int k = 0; k <= h; ++k)
+    {
+    vtkImageComplex zk = z[k % h];
+    vtkImageComplex zc = vtkFFTConj(z[(h - k) % h]);
+    vtkImageComplex e = vtkFFTAdd(zk, zc);
+    vtkImageComplex o = vtkFFTMulMinusI(vtkFFTSub(zk, zc));
+    vtkImageComplex x = vtkFFTAdd(e, vtkFFTMul(this->RealTwiddles[k], o));
+    x.Real *= 0.5;
+    x.Imag *= 0.5;
+    out[k] = x;
+    if (k > 0 && k < h)
+      {
+      out[n - k] = vtkFFTConj(x);
+      }
+    }
+}
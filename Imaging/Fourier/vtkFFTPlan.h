@@ -0,0 +1,112 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkFFTPlan.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkFFTPlan - Planned fast Fourier transforms of a given size
+// .SECTION Description
+// vtkFFTPlan computes the discrete Fourier transforms of sequences of a
+// given size, for vtkImageFFT, vtkImageRFFT and vtkTableFFT. Initialize
+// factors the size and computes the twiddle factors once; the transforms
+// then only read the plan, so one plan can be used by several threads at
+// once, each with its own work space.
+//
+// The size is factored into radices 4, 2, 3 and 5 (which have dedicated
+// butterflies) and other primes up to 13, transformed by a self sorting
+// (Stockham) algorithm. Sizes with a larger prime factor are transformed
+// with Bluestein's algorithm, as a convolution computed with a power of two
+// transform. The transform of real sequences of even size is computed with
+// a complex transform of half the size.
+// .SECTION See Also
+// vtkImageFFT vtkImageRFFT vtkTableFFT
+
+#ifndef __vtkFFTPlan_h
+#define __vtkFFTPlan_h
+
+#include "vtkImagingFourierModule.h" // For export macro
+#include "vtkImageFourierFilter.h" // For vtkImageComplex
+
+#include <vector> // For the twiddle factors
+
+class VTKIMAGINGFOURIER_EXPORT vtkFFTPlan
+{
+public:
+  vtkFFTPlan();
+  ~vtkFFTPlan();
+
+  // Description:
+  // Prepare the transforms of n samples. If real is set, also prepare the
+  // transform of real sequences (see ForwardReal).
+  void Initialize(int n, int real = 0);
+
+  // Description:
+  // The number of samples of the transforms.
+  int GetSize() const { return this->Size; }
+
+  // Description:
+  // The number of complex numbers of work space the transforms need.
+  int GetWorkSize() const { return this->WorkSize; }
+
+  // Description:
+  // Replace data by its transform, X[k] = sum of x[j]*exp(-2*pi*i*j*k/n).
+  // The work space must hold GetWorkSize() numbers.
+  void Forward(vtkImageComplex *data, vtkImageComplex *work) const;
+
+  // Description:
+  // Replace data by its inverse transform,
+  // x[j] = sum of X[k]*exp(2*pi*i*j*k/n) / n.
+  void Backward(vtkImageComplex *data, vtkImageComplex *work) const;
+
+  // Description:
+  // Compute into out the n coefficients of the transform of the n real
+  // samples of in.
+  void ForwardReal(const double *in, vtkImageComplex *out,
+                   vtkImageComplex *work) const;
+
+protected:
+  //BTX
+  struct Stage
+  {
+    int Radix;
+    int Length;
+    size_t TwiddleOffset;
+    size_t RootOffset;
+  };
+
+  int Size;
+  int WorkSize;
+  std::vector<Stage> Stages;
+  std::vector<vtkImageComplex> Twiddles;
+  std::vector<vtkImageComplex> Roots;
+
+  // Bluestein's algorithm: the chirp, and the transform of its conjugate
+  // (divided by the size of the convolution)
+  vtkFFTPlan *ConvolutionPlan;
+  std::vector<vtkImageComplex> Chirp;
+  std::vector<vtkImageComplex> ChirpSpectrum;
+
+  // Real sequences: the plan of half the size, and exp(-2*pi*i*k/n)
+  vtkFFTPlan *HalfPlan;
+  std::vector<vtkImageComplex> RealTwiddles;
+  //ETX
+
+  void Clear();
+  void Stockham(vtkImageComplex *data, vtkImageComplex *work) const;
+  void Bluestein(vtkImageComplex *data, vtkImageComplex *work) const;
+
+private:
+  vtkFFTPlan(const vtkFFTPlan&);  // Not implemented.
+  void operator=(const vtkFFTPlan&);  // Not implemented.
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkFFTPlan.h
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkImageFFT.h"
 
+#include "vtkFFTPlan.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -21,6 +22,7 @@
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageFFT);
 
@@ -67,7 +69,6 @@ void vtkImageFFTExecute(vtkImageFFT *self,
                         int id)
 {
   vtkImageComplex *inComplex;
-  vtkImageComplex *outComplex;
   vtkImageComplex *pComplex;
   //
   int inMin0, inMax0;
@@ -102,9 +103,12 @@ void vtkImageFFTExecute(vtkImageFFT *self,
     return;
     }
 
-  // Allocate the arrays of complex numbers
-  inComplex = new vtkImageComplex[inSize0];
-  outComplex = new vtkImageComplex[inSize0];
+  // Allocate the arrays of complex numbers, and plan the transforms
+  std::vector<vtkImageComplex> work(inSize0);
+  inComplex = &work[0];
+  vtkFFTPlan plan;
+  plan.Initialize(inSize0);
+  std::vector<vtkImageComplex> planWork(plan.GetWorkSize());
 
   target = static_cast<unsigned long>((outMax2-outMin2+1)*(outMax1-outMin1+1)
                                       * self->GetNumberOfIterations() / 50.0);
@@ -143,11 +147,11 @@ void vtkImageFFTExecute(vtkImageFFT *self,
         }
 
       // Call the method that performs the fft
-      self->ExecuteFft(inComplex, outComplex, inSize0);
+      plan.Forward(inComplex, &planWork[0]);
 
       // copy into output
       outPtr0 = outPtr1;
-      pComplex = outComplex + (outMin0 - inMin0);
+      pComplex = inComplex + (outMin0 - inMin0);
       for (idx0 = outMin0; idx0 <= outMax0; ++idx0)
         {
         *outPtr0 = static_cast<double>(pComplex->Real);
@@ -161,12 +165,24 @@ void vtkImageFFTExecute(vtkImageFFT *self,
     inPtr2 += inInc2;
     outPtr2 += outInc2;
     }
-
-  delete [] inComplex;
-  delete [] outComplex;
 }
 
 
+//----------------------------------------------------------------------------
+// Transform all the axes at once when the whole extent is requested along
+// them, otherwise one axis per iteration.
+int vtkImageFFT::RequestData(vtkInformation* request,
+                             vtkInformationVector** inputVector,
+                             vtkInformationVector* outputVector)
+{
+  this->TrimPlans();
+  if (this->TransformAllAxes(inputVector, outputVector, 0))
+    {
+    return 1;
+    }
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
 //----------------------------------------------------------------------------
 // This method is passed input and output Datas, and executes the fft
 // algorithm to fill the output from the input.
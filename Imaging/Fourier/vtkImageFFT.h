@@ -17,11 +17,14 @@
 // vtkImageFFT implements a  fast Fourier transform.  The input
 // can have real or complex data in any components and data types, but
 // the output is always complex doubles with real values in component0, and
-// imaginary values in component1.  The filter is fastest for images that
-// have power of two sizes.  The filter uses a butterfly diagram for each
-// prime factor of the dimension.  This makes images with prime number dimensions
-// (i.e. 17x17) much slower to compute.  Multi dimensional (i.e volumes)
-// FFT's are decomposed so that each axis executes serially.
+// imaginary values in component1.  The transforms are computed by
+// vtkFFTPlan: sizes with factors 2, 3 and 5 are the fastest, and sizes with
+// large prime factors (i.e. 17x17) go through a power of two transform.
+// When the whole extent is requested, all the axes are transformed at once,
+// the lines of each axis in parallel; otherwise multi dimensional (i.e
+// volumes) FFT's are decomposed so that each axis executes serially.
+// .SECTION See Also
+// vtkFFTPlan
 
 
 #ifndef __vtkImageFFT_h
@@ -58,6 +61,10 @@ protected:
   virtual int IterativeRequestUpdateExtent(vtkInformation* in,
                                            vtkInformation* out);
 
+  virtual int RequestData(vtkInformation* request,
+                          vtkInformationVector** inputVector,
+                          vtkInformationVector* outputVector);
+
   virtual void ThreadedRequestData(
     vtkInformation* vtkNotUsed( request ),
     vtkInformationVector** inputVector,
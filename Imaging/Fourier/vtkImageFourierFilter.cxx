@@ -14,8 +14,89 @@
 =========================================================================*/
 #include "vtkImageFourierFilter.h"
 
+#include "vtkFFTPlan.h"
+#include "vtkImageAxisLines.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSimpleCriticalSection.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+
+#include <map>
 #include <math.h>
+#include <utility>
+#include <vector>
+
+// The number of plans kept between updates: enough for the axes of a
+// volume and the real transform of its first axis.
+static const size_t vtkImageFourierFilterMaxPlans = 8;
+
+//----------------------------------------------------------------------------
+// The plans made by GetPlan, by size and real flag. The threads of the
+// filter share them, a plan being only read once it has been made.
+class vtkImageFourierFilterPlans
+{
+public:
+  typedef std::map<std::pair<int, int>, vtkFFTPlan *> MapType;
+  MapType Map;
+  vtkSimpleCriticalSection Lock;
+
+  ~vtkImageFourierFilterPlans()
+  {
+    this->Clear();
+  }
+
+  void Clear()
+  {
+    for (MapType::iterator it = this->Map.begin(); it != this->Map.end(); ++it)
+      {
+      delete it->second;
+      }
+    this->Map.clear();
+  }
+};
+
+//----------------------------------------------------------------------------
+vtkImageFourierFilter::vtkImageFourierFilter()
+{
+  this->Plans = new vtkImageFourierFilterPlans;
+}
+
+//----------------------------------------------------------------------------
+vtkImageFourierFilter::~vtkImageFourierFilter()
+{
+  delete this->Plans;
+}
+
+//----------------------------------------------------------------------------
+const vtkFFTPlan *vtkImageFourierFilter::GetPlan(int n, int real)
+{
+  this->Plans->Lock.Lock();
+  vtkFFTPlan *&plan = this->Plans->Map[std::make_pair(n, real)];
+  if (!plan)
+    {
+    plan = new vtkFFTPlan;
+    plan->Initialize(n, real);
+    }
+  const vtkFFTPlan *result = plan;
+  this->Plans->Lock.Unlock();
+  return result;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFourierFilter::TrimPlans()
+{
+  this->Plans->Lock.Lock();
+  if (this->Plans->Map.size() > vtkImageFourierFilterMaxPlans)
+    {
+    this->Plans->Clear();
+    }
+  this->Plans->Lock.Unlock();
+}
 
 /*=========================================================================
         Vectors of complex numbers.
@@ -144,70 +225,34 @@ void vtkImageFourierFilter::ExecuteFftStepN(vtkImageComplex *p_in,
 
 //----------------------------------------------------------------------------
 // This function calculates the whole fft (or rfft) of an array.
-// The contents of the input array are changed.
-// It is engineered for no decimation so input and output cannot be equal.
+// The result is computed with a vtkFFTPlan, which has replaced
+// ExecuteFftStep2 and ExecuteFftStepN, and which is made once per size;
+// in is left unchanged.
 // (fb = 1) => fft, (fb = -1) => rfft;
 void vtkImageFourierFilter::ExecuteFftForwardBackward(vtkImageComplex *in,
                                                       vtkImageComplex *out,
                                                       int N, int fb)
 {
-  vtkImageComplex *p1, *p2, *p3;
-  int block_size = 1;
-  int rest_size = N;
-  int n = 2;
-  int idx;
-
-  // If this is a reverse transform (scale accordingly).
-  if(fb == -1)
+  if (N <= 0)
     {
-    p1 = in;
-    for(idx = 0; idx < N; ++idx)
-      {
-      p1->Real = p1->Real / N;
-      p1->Imag = p1->Imag / N;
-      ++p1;
-      }
+    return;
     }
-  p1 = in;
-  p2 = out;
-  while(block_size < N && n <= N)
+  const vtkFFTPlan *plan = this->GetPlan(N, 0);
+  std::vector<vtkImageComplex> work(plan->GetWorkSize());
+  for (int idx = 0; idx < N; ++idx)
     {
-    if((rest_size % n) == 0)
-      {
-      // n is a prime factor, perform one "butterfly" stage of the fft.
-      if(n == 2)
-        {
-        this->ExecuteFftStep2(p1, p2, N, block_size, fb);
-        }
-      else
-        {
-        this->ExecuteFftStepN(p1, p2, N, block_size, n, fb);
-        }
-      block_size = block_size * n;
-      rest_size = rest_size / n;
-      // switch input and output.
-      p3 = p1;
-      p1 = p2;
-      p2 = p3;
-      }
-    else
-      {
-      // n is not a prime factor. increment n to see if n+1 is.
-      ++n;
-      }
+    out[idx] = in[idx];
     }
-  // If the results ended up in the input, copy to output.
-  if(p1 != out)
+  if (fb == -1)
     {
-    for(n = 0; n < N; ++n)
-      {
-      *out++ = *p1++;
-      }
+    plan->Backward(out, &work[0]);
+    }
+  else
+    {
+    plan->Forward(out, &work[0]);
     }
 }
 
-
-
 //----------------------------------------------------------------------------
 // This function calculates the whole fft of an array.
 // The contents of the input array are changed.
@@ -228,4 +273,204 @@ void vtkImageFourierFilter::ExecuteRfft(vtkImageComplex *in,
   this->ExecuteFftForwardBackward(in, out, N, -1);
 }
 
+//----------------------------------------------------------------------------
+// Transform the lines of the first axis, read from the input, into the
+// output (which has the same extent, and two double components).
+template <class T>
+class vtkImageFourierFilterFirstAxisFunctor
+{
+public:
+  const T *InPtr;
+  vtkIdType InIncrements[3];
+  int NumberOfComponents;
+  vtkImageComplex *OutPtr;
+  int Size[3];
+  const vtkFFTPlan *Plan;
+  int Backward;
+  vtkSMPThreadLocal<std::vector<vtkImageComplex> > Work;
+  vtkSMPThreadLocal<std::vector<double> > Real;
 
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<vtkImageComplex>& work = this->Work.Local();
+    work.resize(this->Plan->GetWorkSize());
+    std::vector<double>& realRow = this->Real.Local();
+    int n = this->Size[0];
+    int useReal = (!this->Backward && this->NumberOfComponents == 1);
+    if (useReal)
+      {
+      realRow.resize(n);
+      }
+    vtkIdType inc0 = this->InIncrements[0];
+    for (vtkIdType row = begin; row < end; ++row)
+      {
+      const T *inPtr = this->InPtr +
+        (row % this->Size[1])*this->InIncrements[1] +
+        (row / this->Size[1])*this->InIncrements[2];
+      vtkImageComplex *outPtr = this->OutPtr + row*n;
+      if (useReal)
+        {
+        for (int i = 0; i < n; ++i)
+          {
+          realRow[i] = static_cast<double>(inPtr[i*inc0]);
+          }
+        this->Plan->ForwardReal(&realRow[0], outPtr, &work[0]);
+        continue;
+        }
+      for (int i = 0; i < n; ++i)
+        {
+        outPtr[i].Real = static_cast<double>(inPtr[i*inc0]);
+        outPtr[i].Imag = 0.0;
+        if (this->NumberOfComponents > 1)
+          { // yes we have an imaginary input
+          outPtr[i].Imag = static_cast<double>(inPtr[i*inc0 + 1]);
+          }
+        }
+      if (this->Backward)
+        {
+        this->Plan->Backward(outPtr, &work[0]);
+        }
+      else
+        {
+        this->Plan->Forward(outPtr, &work[0]);
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageFourierFilterFirstAxis(const T *inPtr, vtkIdType inInc[3],
+                                    int numberOfComponents,
+                                    vtkImageComplex *outPtr, int size[3],
+                                    const vtkFFTPlan *plan, int backward)
+{
+  vtkImageFourierFilterFirstAxisFunctor<T> functor;
+  functor.InPtr = inPtr;
+  functor.NumberOfComponents = numberOfComponents;
+  functor.OutPtr = outPtr;
+  functor.Plan = plan;
+  functor.Backward = backward;
+  for (int i = 0; i < 3; ++i)
+    {
+    functor.InIncrements[i] = inInc[i];
+    functor.Size[i] = size[i];
+    }
+  vtkSMPTools::For(0, static_cast<vtkIdType>(size[1])*size[2], functor);
+}
+
+//----------------------------------------------------------------------------
+// Transform a line of axis 1 or 2 in place, for vtkImageAxisLinesTransform.
+class vtkImageFourierFilterLineOp
+{
+public:
+  const vtkFFTPlan *Plan;
+  int Backward;
+  vtkSMPThreadLocal<std::vector<vtkImageComplex> > Work;
+
+  void operator()(vtkImageComplex *line, int)
+  {
+    std::vector<vtkImageComplex>& work = this->Work.Local();
+    work.resize(this->Plan->GetWorkSize());
+    if (this->Backward)
+      {
+      this->Plan->Backward(line, &work[0]);
+      }
+    else
+      {
+      this->Plan->Forward(line, &work[0]);
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+int vtkImageFourierFilter::TransformAllAxes(vtkInformationVector **inputVector,
+                                            vtkInformationVector *outputVector,
+                                            int backward)
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *inData = vtkImageData::GetData(inInfo);
+  vtkImageData *outData = vtkImageData::GetData(outInfo);
+  int *wExt = inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT());
+  int *uExt = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT());
+  if (!inData || !outData || !wExt || !uExt ||
+      !inData->GetPointData()->GetScalars() ||
+      inData->GetNumberOfScalarComponents() < 1)
+    {
+    return 0;
+    }
+
+  int outExt[6];
+  int *inExt = inData->GetExtent();
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    outExt[2*axis] = uExt[2*axis];
+    outExt[2*axis + 1] = uExt[2*axis + 1];
+    if ((axis < this->Dimensionality &&
+         (outExt[2*axis] != wExt[2*axis] ||
+          outExt[2*axis + 1] != wExt[2*axis + 1])) ||
+        outExt[2*axis] < inExt[2*axis] ||
+        outExt[2*axis + 1] > inExt[2*axis + 1] ||
+        outExt[2*axis] > outExt[2*axis + 1])
+      {
+      return 0;
+      }
+    }
+
+  this->AllocateOutputData(outData, outInfo, outExt);
+  if (outData->GetScalarType() != VTK_DOUBLE ||
+      outData->GetNumberOfScalarComponents() != 2)
+    {
+    vtkErrorMacro(<< "Execute: Output must be two double components.");
+    return 0;
+    }
+  this->CopyAttributeData(inData, outData, inputVector);
+
+  int size[3];
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    size[axis] = outExt[2*axis + 1] - outExt[2*axis] + 1;
+    }
+  int numberOfComponents = inData->GetNumberOfScalarComponents();
+  vtkImageComplex *outPtr = static_cast<vtkImageComplex *>(
+    outData->GetScalarPointerForExtent(outExt));
+
+  // The first axis, from the input
+  this->UpdateProgress(0.0);
+  const vtkFFTPlan *plan =
+    this->GetPlan(size[0], !backward && numberOfComponents == 1);
+  void *inPtr = inData->GetScalarPointerForExtent(outExt);
+  vtkIdType *inInc = inData->GetIncrements();
+  switch (inData->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageFourierFilterFirstAxis(static_cast<VTK_TT *>(inPtr), inInc,
+                                     numberOfComponents, outPtr, size,
+                                     plan, backward));
+    default:
+      vtkErrorMacro(<< "Execute: Unknown ScalarType");
+      return 1;
+    }
+
+  // The other axes, in place
+  for (int axis = 1; axis < this->Dimensionality; ++axis)
+    {
+    this->UpdateProgress(static_cast<double>(axis)/this->Dimensionality);
+    if (this->AbortExecute)
+      {
+      break;
+      }
+    if (size[axis] == 1)
+      {
+      continue;
+      }
+    vtkImageFourierFilterLineOp op;
+    op.Plan = this->GetPlan(size[axis], 0);
+    op.Backward = backward;
+    vtkImageAxisLinesTransform(outPtr, size, axis, &op);
+    }
+  this->UpdateProgress(1.0);
+
+  return 1;
+}
@@ -84,6 +84,9 @@ typedef struct{
 /******************* End of COMPLEX number stuff ********************/
 //ETX
 
+class vtkFFTPlan;
+class vtkImageFourierFilterPlans;
+
 class VTKIMAGINGFOURIER_EXPORT vtkImageFourierFilter : public vtkImageDecomposeFilter
 {
 public:
@@ -109,8 +112,8 @@ public:
   //ETX
 
 protected:
-  vtkImageFourierFilter() {}
-  ~vtkImageFourierFilter() {}
+  vtkImageFourierFilter();
+  ~vtkImageFourierFilter();
 
   //BTX
   void ExecuteFftStep2(vtkImageComplex *p_in, vtkImageComplex *p_out,
@@ -119,6 +122,31 @@ protected:
                        int N, int bsize, int n, int fb);
   void ExecuteFftForwardBackward(vtkImageComplex *in, vtkImageComplex *out,
                                  int N, int fb);
+
+  // Description:
+  // Transform the axes up to the dimensionality straight from the input
+  // into the output, without the intermediate image of each iteration: the
+  // lines of the first axis are read from the input, the other axes are
+  // transformed in place in the output. This is done when the update
+  // extent covers the whole extent along the transformed axes, otherwise
+  // nothing is done and 0 is returned.
+  int TransformAllAxes(vtkInformationVector **inputVector,
+                       vtkInformationVector *outputVector, int backward);
+
+  // Description:
+  // Get the plan of the transforms of n samples (see vtkFFTPlan), which is
+  // made on the first request and then kept. This can be called by several
+  // threads at once.
+  const vtkFFTPlan *GetPlan(int n, int real);
+
+  // Description:
+  // Delete the plans kept by GetPlan when there are more than a few of
+  // them, so that a filter updated with many different sizes does not keep
+  // all their plans. This is called at the start of RequestData, when no
+  // plan is in use.
+  void TrimPlans();
+
+  vtkImageFourierFilterPlans *Plans;
   //ETX
 private:
   vtkImageFourierFilter(const vtkImageFourierFilter&);  // Not implemented.
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkImageRFFT.h"
 
+#include "vtkFFTPlan.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -21,6 +22,7 @@
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageRFFT);
 
@@ -68,7 +70,6 @@ void vtkImageRFFTExecute(vtkImageRFFT *self,
                          int id)
 {
   vtkImageComplex *inComplex;
-  vtkImageComplex *outComplex;
   vtkImageComplex *pComplex;
   //
   int inMin0, inMax0;
@@ -103,9 +104,12 @@ void vtkImageRFFTExecute(vtkImageRFFT *self,
     return;
     }
 
-  // Allocate the arrays of complex numbers
-  inComplex = new vtkImageComplex[inSize0];
-  outComplex = new vtkImageComplex[inSize0];
+  // Allocate the arrays of complex numbers, and plan the transforms
+  std::vector<vtkImageComplex> work(inSize0);
+  inComplex = &work[0];
+  vtkFFTPlan plan;
+  plan.Initialize(inSize0);
+  std::vector<vtkImageComplex> planWork(plan.GetWorkSize());
 
   target = static_cast<unsigned long>((outMax2-outMin2+1)*(outMax1-outMin1+1)
                                       * self->GetNumberOfIterations() / 50.0);
@@ -144,11 +148,11 @@ void vtkImageRFFTExecute(vtkImageRFFT *self,
         }
 
       // Call the method that performs the RFFT
-      self->ExecuteRfft(inComplex, outComplex, inSize0);
+      plan.Backward(inComplex, &planWork[0]);
 
       // copy into output
       outPtr0 = outPtr1;
-      pComplex = outComplex + (outMin0 - inMin0);
+      pComplex = inComplex + (outMin0 - inMin0);
       for (idx0 = outMin0; idx0 <= outMax0; ++idx0)
         {
         *outPtr0 = static_cast<double>(pComplex->Real);
@@ -162,14 +166,26 @@ void vtkImageRFFTExecute(vtkImageRFFT *self,
     inPtr2 += inInc2;
     outPtr2 += outInc2;
     }
-
-  delete [] inComplex;
-  delete [] outComplex;
 }
 
 
 
 
+//----------------------------------------------------------------------------
+// Transform all the axes at once when the whole extent is requested along
+// them, otherwise one axis per iteration.
+int vtkImageRFFT::RequestData(vtkInformation* request,
+                              vtkInformationVector** inputVector,
+                              vtkInformationVector* outputVector)
+{
+  this->TrimPlans();
+  if (this->TransformAllAxes(inputVector, outputVector, 1))
+    {
+    return 1;
+    }
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
 //----------------------------------------------------------------------------
 // This method is passed input and output Datas, and executes the RFFT
 // algorithm to fill the output from the input.
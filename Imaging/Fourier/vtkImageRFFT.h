@@ -17,17 +17,18 @@
 // vtkImageRFFT implements the reverse fast Fourier transform.  The input
 // can have real or complex data in any components and data types, but
 // the output is always complex doubles with real values in component0, and
-// imaginary values in component1.  The filter is fastest for images that
-// have power of two sizes.  The filter uses a butterfly fitlers for each
-// prime factor of the dimension.  This makes images with prime number dimensions
-// (i.e. 17x17) much slower to compute.  Multi dimensional (i.e volumes)
-// FFT's are decomposed so that each axis executes in series.
+// imaginary values in component1.  The transforms are computed by
+// vtkFFTPlan: sizes with factors 2, 3 and 5 are the fastest, and sizes with
+// large prime factors (i.e. 17x17) go through a power of two transform.
+// When the whole extent is requested, all the axes are transformed at once,
+// the lines of each axis in parallel; otherwise multi dimensional (i.e
+// volumes) FFT's are decomposed so that each axis executes in series.
 // In most cases the RFFT will produce an image whose imaginary values are all
 // zero's. In this case vtkImageExtractComponents can be used to remove
 // this imaginary components leaving only the real image.
 
 // .SECTION See Also
-// vtkImageExtractComponenents
+// vtkImageExtractComponenents vtkFFTPlan
 
 
 
@@ -64,6 +65,10 @@ protected:
   virtual int IterativeRequestUpdateExtent(vtkInformation* in,
                                            vtkInformation* out);
 
+  virtual int RequestData(vtkInformation* request,
+                          vtkInformationVector** inputVector,
+                          vtkInformationVector* outputVector);
+
   virtual void ThreadedRequestData(
     vtkInformation* vtkNotUsed( request ),
     vtkInformationVector** inputVector,
@@ -23,10 +23,9 @@
 #include "vtkTableFFT.h"
 
 #include "vtkDataArray.h"
-#include "vtkImageData.h"
-#include "vtkImageFFT.h"
+#include "vtkDoubleArray.h"
+#include "vtkFFTPlan.h"
 #include "vtkObjectFactory.h"
-#include "vtkPointData.h"
 #include "vtkTable.h"
 
 #include "vtkSmartPointer.h"
@@ -34,6 +33,7 @@
   vtkSmartPointer<type> name = vtkSmartPointer<type>::New()
 
 #include <string.h>
+#include <vector>
 
 #include <vtksys/SystemTools.hxx>
 using namespace vtksys;
@@ -99,17 +99,41 @@ int vtkTableFFT::RequestData(vtkInformation *vtkNotUsed(request),
 //-----------------------------------------------------------------------------
 vtkSmartPointer<vtkDataArray> vtkTableFFT::DoFFT(vtkDataArray *input)
 {
-  // Build an image data containing the input data.
-  VTK_CREATE(vtkImageData, imgInput);
-  imgInput->SetDimensions(input->GetNumberOfTuples(), 1, 1);
-  imgInput->SetScalarType(input->GetDataType(), input->GetInformation());
-  imgInput->GetPointData()->SetScalars(input);
-
-  // Compute the FFT
-  VTK_CREATE(vtkImageFFT, fft);
-  fft->SetInputData(imgInput);
-  fft->Update();
+  // Transform the samples directly with a plan: real samples with the real
+  // transform, and the first two components as complex samples otherwise,
+  // as vtkImageFFT does
+  int n = static_cast<int>(input->GetNumberOfTuples());
+  VTK_CREATE(vtkDoubleArray, frequencies);
+  frequencies->SetNumberOfComponents(2);
+  frequencies->SetNumberOfTuples(n);
+  if (n > 0)
+    {
+    vtkImageComplex *out =
+      reinterpret_cast<vtkImageComplex *>(frequencies->GetPointer(0));
+    int real = (input->GetNumberOfComponents() == 1);
+    vtkFFTPlan plan;
+    plan.Initialize(n, real);
+    std::vector<vtkImageComplex> work(plan.GetWorkSize());
+    if (real)
+      {
+      std::vector<double> samples(n);
+      for (int i = 0; i < n; i++)
+        {
+        samples[i] = input->GetComponent(i, 0);
+        }
+      plan.ForwardReal(&samples[0], out, &work[0]);
+      }
+    else
+      {
+      for (int i = 0; i < n; i++)
+        {
+        out[i].Real = input->GetComponent(i, 0);
+        out[i].Imag = input->GetComponent(i, 1);
+        }
+      plan.Forward(out, &work[0]);
+      }
+    }
 
   // Return the result
-  return vtkSmartPointer<vtkDataArray>(fft->GetOutput()->GetPointData()->GetScalars());
+  return frequencies;
 }
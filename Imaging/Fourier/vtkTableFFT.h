@@ -25,12 +25,13 @@
 // .SECTION Description
 //
 // vtkTableFFT performs the Fast Fourier Transform on the columns of a table.
-// Internally, it shoves each column into an image data and then uses
-// vtkImageFFT to perform the actual FFT.
+// Each column is transformed as a real sequence with a vtkFFTPlan, the
+// engine of vtkImageFFT; the output columns have two components, the real
+// and imaginary parts.
 //
 // .SECTION See Also
 //
-// vtkImageFFT
+// vtkImageFFT vtkFFTPlan
 //
 
 #ifndef __vtkTableFFT_h
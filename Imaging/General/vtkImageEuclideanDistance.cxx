@@ -14,13 +14,17 @@
 =========================================================================*/
 #include "vtkImageEuclideanDistance.h"
 
+#include "vtkImageAxisLines.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageEuclideanDistance);
 
@@ -31,7 +35,8 @@ vtkImageEuclideanDistance::vtkImageEuclideanDistance()
   this->MaximumDistance = VTK_INT_MAX;
   this->Initialize = 1;
   this->ConsiderAnisotropy = 1;
-  this->Algorithm = VTK_EDT_SAITO;
+  this->SignedDistance = 0;
+  this->Algorithm = VTK_EDT_FELZENSZWALB;
 }
 
 //----------------------------------------------------------------------------
@@ -554,6 +559,222 @@ static void vtkImageEuclideanDistanceExecuteSaitoCached(
   free(temp);
   free(sq);
 }
+//----------------------------------------------------------------------------
+// Execute the algorithm of Felzenszwalb and Huttenlocher along one line:
+// d[q] is the minimum over p of f[p] + weight*(q - p)^2, the lower
+// envelope of the parabolas rooted at every sample. The envelope is built
+// in linear time: v holds the roots of its parabolas (n values) and z the
+// boundaries between them (n + 1 values).
+//
+// P. F. Felzenszwalb and D. P. Huttenlocher. Distance transforms of sampled
+// functions. Theory of Computing, 8(19). pp. 415--428, 2012.
+//
+static void vtkImageEuclideanDistanceEnvelope(const double *f, int n,
+                                              double weight, double *d,
+                                              int *v, double *z)
+{
+  int q;
+  if (weight <= 0.0)
+    { // samples at the same place
+    double minimum = f[0];
+    for (q = 1; q < n; ++q)
+      {
+      minimum = (f[q] < minimum ? f[q] : minimum);
+      }
+    for (q = 0; q < n; ++q)
+      {
+      d[q] = minimum;
+      }
+    return;
+    }
+
+  int k = 0;
+  v[0] = 0;
+  z[0] = -VTK_DOUBLE_MAX;
+  z[1] = VTK_DOUBLE_MAX;
+  for (q = 1; q < n; ++q)
+    {
+    double s;
+    for (;;)
+      {
+      // where the parabola of q crosses the last one of the envelope
+      int p = v[k];
+      s = 0.5*((f[q] - f[p])/(weight*(q - p)) + (q + p));
+      if (s > z[k] || k == 0)
+        {
+        break;
+        }
+      --k;
+      }
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = VTK_DOUBLE_MAX;
+    }
+
+  k = 0;
+  for (q = 0; q < n; ++q)
+    {
+    while (z[k + 1] < q)
+      {
+      ++k;
+      }
+    double dq = q - v[k];
+    d[q] = f[v[k]] + weight*dq*dq;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Transform a line in place, for vtkImageAxisLinesTransform.  For signed
+// distances, the positive samples hold the distance to the outside and the
+// negative ones minus the distance to the inside.  Every voxel is a zero
+// of one of the two transforms, so both are kept in one image and the
+// line is transformed twice.
+class vtkImageEuclideanDistanceLineOp
+{
+public:
+  double Weight;
+  int Signed;
+  vtkSMPThreadLocal<std::vector<double> > Work;
+  vtkSMPThreadLocal<std::vector<int> > Roots;
+
+  void operator()(double *line, int n)
+  {
+    std::vector<double>& work = this->Work.Local();
+    work.resize(3*n + 1);
+    double *f = &work[0];
+    double *d = f + n;
+    double *z = d + n;
+    std::vector<int>& roots = this->Roots.Local();
+    roots.resize(n);
+    int k;
+    if (!this->Signed)
+      {
+      for (k = 0; k < n; ++k)
+        {
+        f[k] = line[k];
+        }
+      vtkImageEuclideanDistanceEnvelope(f, n, this->Weight, line,
+                                        &roots[0], z);
+      return;
+      }
+
+    for (k = 0; k < n; ++k)
+      {
+      f[k] = (line[k] > 0.0 ? line[k] : 0.0);
+      }
+    vtkImageEuclideanDistanceEnvelope(f, n, this->Weight, d, &roots[0], z);
+    for (k = 0; k < n; ++k)
+      {
+      f[k] = (line[k] < 0.0 ? -line[k] : 0.0);
+      line[k] = (line[k] > 0.0 ? d[k] : 0.0);
+      }
+    vtkImageEuclideanDistanceEnvelope(f, n, this->Weight, d, &roots[0], z);
+    for (k = 0; k < n; ++k)
+      {
+      line[k] = (line[k] > 0.0 ? line[k] : -d[k]);
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Transform the axes up to the dimensionality in place.
+static void vtkImageEuclideanDistanceTransformAxes(
+  vtkImageEuclideanDistance *self, double *data, const int size[3],
+  const double weights[3], int signedDistance)
+{
+  int dimensionality = self->GetDimensionality();
+  for (int axis = 0; axis < dimensionality; ++axis)
+    {
+    self->UpdateProgress(static_cast<double>(axis)/dimensionality);
+    if (self->GetAbortExecute())
+      {
+      break;
+      }
+    if (size[axis] == 1)
+      {
+      continue;
+      }
+    vtkImageEuclideanDistanceLineOp op;
+    op.Weight = weights[axis];
+    op.Signed = signedDistance;
+    vtkImageAxisLinesTransform(data, size, axis, &op);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Fill the output with the starting values of the transform: the input
+// values (COPY), or 0 for zero voxels and the maximum distance for the
+// others (MASK), or minus the maximum distance for zero voxels and the
+// maximum distance for the others (SIGNED).
+enum
+{
+  VTK_EDT_COPY = 0,
+  VTK_EDT_MASK = 1,
+  VTK_EDT_SIGNED = 2
+};
+
+template <class T>
+class vtkImageEuclideanDistanceStartFunctor
+{
+public:
+  const T *InPtr;
+  vtkIdType InIncrements[3];
+  double *OutPtr;
+  int Size[3];
+  int Mode;
+  double MaximumDistance;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int n = this->Size[0];
+    vtkIdType inc0 = this->InIncrements[0];
+    double inside = this->MaximumDistance;
+    double outside = (this->Mode == VTK_EDT_MASK ? 0.0 :
+                      -this->MaximumDistance);
+    for (vtkIdType row = begin; row < end; ++row)
+      {
+      const T *inPtr = this->InPtr +
+        (row % this->Size[1])*this->InIncrements[1] +
+        (row / this->Size[1])*this->InIncrements[2];
+      double *outPtr = this->OutPtr + row*n;
+      if (this->Mode == VTK_EDT_COPY)
+        {
+        for (int i = 0; i < n; ++i)
+          {
+          outPtr[i] = static_cast<double>(inPtr[i*inc0]);
+          }
+        }
+      else
+        {
+        for (int i = 0; i < n; ++i)
+          {
+          outPtr[i] = (inPtr[i*inc0] == 0 ? outside : inside);
+          }
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageEuclideanDistanceStart(const T *inPtr, vtkIdType inInc[3],
+                                    double *outPtr, int size[3], int mode,
+                                    double maximumDistance)
+{
+  vtkImageEuclideanDistanceStartFunctor<T> functor;
+  functor.InPtr = inPtr;
+  functor.OutPtr = outPtr;
+  functor.Mode = mode;
+  functor.MaximumDistance = maximumDistance;
+  for (int i = 0; i < 3; ++i)
+    {
+    functor.InIncrements[i] = inInc[i];
+    functor.Size[i] = size[i];
+    }
+  vtkSMPTools::For(0, static_cast<vtkIdType>(size[1])*size[2], functor);
+}
+
 //----------------------------------------------------------------------------
 void vtkImageEuclideanDistance::AllocateOutputScalars(vtkImageData *outData,
                                                       int outExt[6],
@@ -662,6 +883,86 @@ int vtkImageEuclideanDistance::IterativeRequestData(
 }
 
 
+//----------------------------------------------------------------------------
+// The Felzenszwalb algorithm transforms all the axes in place in the
+// output, the others go through the iterations of the superclass.
+int vtkImageEuclideanDistance::RequestData(
+  vtkInformation* request,
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  if (this->Algorithm != VTK_EDT_FELZENSZWALB)
+    {
+    return this->Superclass::RequestData(request, inputVector, outputVector);
+    }
+
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkImageData *inData = vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *outData = vtkImageData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  int outExt[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), outExt);
+  this->AllocateOutputScalars(outData, outExt, outInfo);
+
+  vtkDebugMacro(<<"Executing image euclidean distance");
+
+  void *inPtr = inData->GetScalarPointerForExtent(outExt);
+  double *outPtr = static_cast<double *>(outData->GetScalarPointer());
+
+  if (!inPtr)
+    {
+    vtkErrorMacro(<< "Execute: No scalars for update extent.")
+    return 1;
+    }
+
+  // this filter expects that the output be doubles.
+  if (outData->GetScalarType() != VTK_DOUBLE)
+    {
+    vtkErrorMacro(<< "Execute: Output must be be type double.");
+    return 1;
+    }
+
+  // this filter expects input to have 1 components
+  if (outData->GetNumberOfScalarComponents() != 1 )
+    {
+    vtkErrorMacro(<< "Execute: Cannot handle more than 1 components");
+    return 1;
+    }
+
+  int size[3];
+  double weights[3];
+  double *spacing = outData->GetSpacing();
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    size[axis] = outExt[2*axis + 1] - outExt[2*axis] + 1;
+    weights[axis] = (this->ConsiderAnisotropy ? spacing[axis]*spacing[axis] :
+                     1.0);
+    }
+  vtkIdType *inInc = inData->GetIncrements();
+  int signedDistance = (this->Initialize && this->SignedDistance);
+  int mode = (signedDistance ? VTK_EDT_SIGNED :
+              (this->Initialize ? VTK_EDT_MASK : VTK_EDT_COPY));
+
+  switch (inData->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageEuclideanDistanceStart(static_cast<VTK_TT *>(inPtr), inInc,
+                                     outPtr, size, mode,
+                                     this->MaximumDistance));
+    default:
+      vtkErrorMacro(<< "Execute: Unknown ScalarType");
+      return 1;
+    }
+  vtkImageEuclideanDistanceTransformAxes(this, outPtr, size, weights,
+                                         signedDistance);
+  this->UpdateProgress(1.0);
+
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 // For streaming and threads.  Splits output update extent into num pieces.
 // This method needs to be called num times.  Results must not overlap for
@@ -739,11 +1040,18 @@ void vtkImageEuclideanDistance::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Consider Anisotropy: "
      << (this->ConsiderAnisotropy ? "On\n" : "Off\n");
 
+  os << indent << "Signed Distance: "
+     << (this->SignedDistance ? "On\n" : "Off\n");
+
   os << indent << "Initialize: " << this->Initialize << "\n";
   os << indent << "Maximum Distance: " << this->MaximumDistance << "\n";
 
   os << indent << "Algorithm: ";
-  if ( this->Algorithm == VTK_EDT_SAITO )
+  if ( this->Algorithm == VTK_EDT_FELZENSZWALB )
+    {
+    os << "Felzenszwalb\n";
+    }
+  else if ( this->Algorithm == VTK_EDT_SAITO )
     {
     os << "Saito\n";
     }
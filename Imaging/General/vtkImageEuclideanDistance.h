@@ -14,23 +14,34 @@
 =========================================================================*/
 // .NAME vtkImageEuclideanDistance - computes 3D Euclidean DT
 // .SECTION Description
-// vtkImageEuclideanDistance implements the Euclidean DT using
-// Saito's algorithm. The distance map produced contains the square of the
-// Euclidean distance values.
+// vtkImageEuclideanDistance implements the exact Euclidean DT. The
+// distance map produced contains the square of the Euclidean distance
+// values.
 //
-// The algorithm has a o(n^(D+1)) complexity over nxnx...xn images in D
-// dimensions. It is very efficient on relatively small images. Cuisenaire's
-// algorithms should be used instead if n >> 500. These are not implemented
-// yet.
+// The default algorithm is the one of Felzenszwalb and Huttenlocher, which
+// is also the second phase of Meijster's algorithm: along every line, the
+// distance is the lower envelope of the parabolas rooted at each sample, which
+// is built in linear time. The transform therefore has a o(n^D) complexity
+// over nxnx...xn images in D dimensions. All the axes are processed in
+// place in the output, without the intermediate image of each iteration, and
+// the lines of every axis are processed in parallel with vtkSMPTools.
 //
-// For the special case of images where the slice-size is a multiple of
+// Saito's algorithm has a o(n^(D+1)) complexity and is single threaded. For
+// the special case of images where the slice-size is a multiple of
 // 2^N with a large N (typically for 256x256 slices), Saito's algorithm
 // encounters a lot of cache conflicts during the 3rd iteration which can
-// slow it very significantly. In that case, one should use
-// ::SetAlgorithmToSaitoCached() instead for better performance.
+// slow it very significantly. In that case, ::SetAlgorithmToSaitoCached()
+// performs better.
 //
 // References:
 //
+// P. F. Felzenszwalb and D. P. Huttenlocher. Distance transforms of sampled
+// functions. Theory of Computing, 8(19). pp. 415--428, 2012.
+//
+// A. Meijster, J. B. T. M. Roerdink and W. H. Hesselink. A general algorithm
+// for computing distance transforms in linear time. Mathematical Morphology
+// and its Applications to Image and Signal Processing. pp. 331--340, 2000.
+//
 // T. Saito and J.I. Toriwaki. New algorithms for Euclidean distance
 // transformations of an n-dimensional digitised picture with applications.
 // Pattern Recognition, 27(11). pp. 1551--1565, 1994.
@@ -48,6 +59,7 @@
 
 #define VTK_EDT_SAITO_CACHED 0
 #define VTK_EDT_SAITO 1
+#define VTK_EDT_FELZENSZWALB 2
 
 class VTKIMAGINGGENERAL_EXPORT vtkImageEuclideanDistance : public vtkImageDecomposeFilter
 {
@@ -89,13 +101,25 @@ public:
   vtkSetMacro(MaximumDistance, double);
   vtkGetMacro(MaximumDistance, double);
 
+  // Description:
+  // Used with Initialize on to compute a signed distance map: non-zero
+  // voxels get the squared distance to the nearest zero voxel, as usual,
+  // and zero voxels get minus the squared distance to the nearest non-zero
+  // voxel. Both distances are bounded by MaximumDistance. Only computed by
+  // the Felzenszwalb algorithm. Off by default.
+  vtkSetMacro(SignedDistance, int);
+  vtkGetMacro(SignedDistance, int);
+  vtkBooleanMacro(SignedDistance, int);
+
   // Description:
   // Selects a Euclidean DT algorithm.
-  // 1. Saito
-  // 2. Saito-cached
-  // More algorithms will be added later on.
+  // 1. Felzenszwalb (the default)
+  // 2. Saito
+  // 3. Saito-cached
   vtkSetMacro(Algorithm, int);
   vtkGetMacro(Algorithm, int);
+  void SetAlgorithmToFelzenszwalb ()
+    { this->SetAlgorithm(VTK_EDT_FELZENSZWALB); }
   void SetAlgorithmToSaito ()
     { this->SetAlgorithm(VTK_EDT_SAITO); }
   void SetAlgorithmToSaitoCached ()
@@ -112,6 +136,7 @@ protected:
   double MaximumDistance;
   int Initialize;
   int ConsiderAnisotropy;
+  int SignedDistance;
   int Algorithm;
 
   // Replaces "EnlargeOutputUpdateExtent"
@@ -124,6 +149,13 @@ protected:
   virtual int IterativeRequestUpdateExtent(vtkInformation* in,
                                            vtkInformation* out);
 
+  // Description:
+  // The Felzenszwalb algorithm processes all the axes at once, the others
+  // go through one iteration per axis.
+  virtual int RequestData(vtkInformation* request,
+                          vtkInformationVector** inputVector,
+                          vtkInformationVector* outputVector);
+
 private:
   vtkImageEuclideanDistance(const vtkImageEuclideanDistance&);  // Not implemented.
   void operator=(const vtkImageEuclideanDistance&);  // Not implemented.
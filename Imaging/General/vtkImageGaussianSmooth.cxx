@@ -15,12 +15,14 @@
 #include "vtkImageGaussianSmooth.h"
 
 #include "vtkImageData.h"
+#include "vtkImageSeparableConvolver.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageGaussianSmooth);
 
@@ -142,248 +144,50 @@ void vtkImageGaussianSmooth::InternalRequestUpdateExtent(int *inExt,
 }
 
 //----------------------------------------------------------------------------
-// For a given position along the convolution axis, this method loops over
-// all other axes, and performs the convolution. Boundary conditions handled
-// previously.
-template <class T>
-void
-vtkImageGaussianSmoothExecute(vtkImageGaussianSmooth *self, int axis,
-                              double *kernel, int kernelSize,
-                              vtkImageData *inData, T *inPtrC,
-                              vtkImageData *outData, int outExt[6],
-                              T *outPtrC, int *pcycle, int target,
-                              int *pcount, int total)
-{
-  int maxC, max0 = 0, max1 = 0;
-  int idxC, idx0, idx1, idxK;
-  vtkIdType *inIncs, *outIncs;
-  vtkIdType inInc0 = 0, inInc1 = 0, inIncK, outInc0 = 0, outInc1 = 0;
-  T *outPtr1, *outPtr0;
-  T *inPtr1, *inPtr0, *inPtrK;
-  double *ptrK, sum;
-
-  // I am counting on the fact that tight loops (component on outside)
-  // is more important than cache misses from shuffled access.
-
-  // Do the correct shuffling of the axes (increments, extents)
-  inIncs = inData->GetIncrements();
-  outIncs = outData->GetIncrements();
-  inIncK = inIncs[axis];
-  maxC = outData->GetNumberOfScalarComponents();
-  switch (axis)
-    {
-    case 0:
-      inInc0 = inIncs[1];  inInc1 = inIncs[2];
-      outInc0 = outIncs[1];  outInc1 = outIncs[2];
-      max0 = outExt[3] - outExt[2] + 1;   max1 = outExt[5] - outExt[4] + 1;
-      break;
-    case 1:
-      inInc0 = inIncs[0];  inInc1 = inIncs[2];
-      outInc0 = outIncs[0];  outInc1 = outIncs[2];
-      max0 = outExt[1] - outExt[0] + 1;   max1 = outExt[5] - outExt[4] + 1;
-      break;
-    case 2:
-      inInc0 = inIncs[0];  inInc1 = inIncs[1];
-      outInc0 = outIncs[0];  outInc1 = outIncs[1];
-      max0 = outExt[1] - outExt[0] + 1;   max1 = outExt[3] - outExt[2] + 1;
-      break;
-    }
-
-  for (idxC = 0; idxC < maxC; ++idxC)
-    {
-    inPtr1 = inPtrC;
-    outPtr1 = outPtrC;
-    for (idx1 = 0; !self->AbortExecute && idx1 < max1; ++idx1)
-      {
-      inPtr0 = inPtr1;
-      outPtr0 = outPtr1;
-      for (idx0 = 0; idx0 < max0; ++idx0)
-        {
-        inPtrK = inPtr0;
-        ptrK = kernel;
-        sum = 0.0;
-        // too bad this short loop has to be the inner most loop
-        for (idxK = 0; idxK < kernelSize; ++idxK)
-          {
-          sum += *ptrK * static_cast<double>(*inPtrK);
-          ++ptrK;
-          inPtrK += inIncK;
-          }
-        *outPtr0 = static_cast<T>(sum);
-        inPtr0 += inInc0;
-        outPtr0 += outInc0;
-        }
-      inPtr1 += inInc1;
-      outPtr1 += outInc1;
-      // we finished a row ... do we update ???
-      if (total)
-        { // yes this is the main thread
-        *pcycle += max0;
-        if (*pcycle > target)
-          { // yes
-          *pcycle -= target;
-          *pcount += target;
-          self->UpdateProgress(static_cast<double>(*pcount) /
-                               static_cast<double>(total));
-          //fprintf(stderr, "count: %d, total: %d, progress: %f\n",
-          //*pcount, total, (double)(*pcount) / (double)total);
-          }
-        }
-      }
-
-    ++inPtrC;
-    ++outPtrC;
-    }
-}
-
-//----------------------------------------------------------------------------
-template <class T>
-size_t vtkImageGaussianSmoothGetTypeSize(T*)
-{
-  return sizeof(T);
-}
-
-//----------------------------------------------------------------------------
-// This method convolves over one axis. It loops over the convolved axis,
-// and handles boundary conditions.
+// This method convolves over one axis, the kernel being clipped at the
+// boundaries of the whole extent.
+#ifndef VTK_LEGACY_REMOVE
 void vtkImageGaussianSmooth::ExecuteAxis(int axis,
-                                         vtkImageData *inData, int inExt[6],
+                                         vtkImageData *inData,
+                                         int vtkNotUsed(inExt)[6],
                                          vtkImageData *outData, int outExt[6],
-                                         int *pcycle, int target,
-                                         int *pcount, int total,
+                                         int *vtkNotUsed(pcycle),
+                                         int vtkNotUsed(target),
+                                         int *vtkNotUsed(pcount), int total,
                                          vtkInformation *inInfo)
 {
-  int idxA, max;
-  int wholeExtent[6], wholeMax, wholeMin;
-  double *kernel;
-  // previousClip and currentClip rembers that the previous was not clipped
-  // keeps from recomputing kernels for center pixels.
-  int kernelSize = 0;
-  int kernelLeftClip, kernelRightClip;
-  int previousClipped, currentClipped;
-  int radius, size;
-  void *inPtr;
-  void *outPtr;
-  int coords[3];
-  vtkIdType *outIncs, outIncA;
-
-  // Get the correct starting pointer of the output
-  outPtr = outData->GetScalarPointerForExtent(outExt);
-  outIncs = outData->GetIncrements();
-  outIncA = outIncs[axis];
-
-  // trick to account for the scalar type of the output(used to be only float)
-  switch (outData->GetScalarType())
-    {
-    vtkTemplateMacro(
-      outIncA *= vtkImageGaussianSmoothGetTypeSize(static_cast<VTK_TT*>(0))
-      );
-    default:
-      vtkErrorMacro("Unknown scalar type");
-      return;
-    }
+  VTK_LEGACY_BODY(vtkImageGaussianSmooth::ExecuteAxis, "VTK 6.2");
 
-  // Determine default starting position of input
-  coords[0] = inExt[0];
-  coords[1] = inExt[2];
-  coords[2] = inExt[4];
+  int wholeExt[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
 
-  // get whole extent for boundary checking ...
-  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
-  wholeMin = wholeExtent[axis*2];
-  wholeMax = wholeExtent[axis*2+1];
-
-  // allocate memory for the kernel
-  radius = static_cast<int>(this->StandardDeviations[axis]
-                            * this->RadiusFactors[axis]);
-  size = 2*radius + 1;
-  kernel = new double[size];
-
-  // loop over the convolution axis
-  previousClipped = currentClipped = 1;
-  max = outExt[axis*2+1];
-  for (idxA = outExt[axis*2]; idxA <= max; ++idxA)
+  int radius = static_cast<int>(this->StandardDeviations[axis]
+                                * this->RadiusFactors[axis]);
+  std::vector<double> kernel(2*radius + 1);
+  this->ComputeKernel(&kernel[0], -radius, radius,
+                      this->StandardDeviations[axis]);
+
+  vtkImageSeparableConvolver convolver;
+  convolver.SetWholeExtent(wholeExt);
+  convolver.SetBoundaryMode(vtkImageSeparableConvolver::RENORMALIZE);
+  convolver.SetKernel(axis, &kernel[0], 2*radius + 1);
+  if (!convolver.Execute(this, inData, outData, outExt, (total != 0)))
     {
-    // left boundary condition
-    coords[axis] = idxA - radius;
-    kernelLeftClip = wholeMin - coords[axis];
-    if (kernelLeftClip > 0)
-      { // front of kernel is cut off ("kernelStart" samples)
-      coords[axis] += kernelLeftClip;
-      }
-    else
-      {
-      kernelLeftClip = 0;
-      }
-    // Right boundary condition
-    kernelRightClip = (idxA + radius) - wholeMax;
-    if (kernelRightClip < 0)
-      {
-      kernelRightClip = 0;
-      }
-
-    // We can only use previous kernel if it is not clipped and new
-    // kernel is also not clipped.
-    currentClipped = kernelLeftClip + kernelRightClip;
-    if (currentClipped || previousClipped)
-      {
-      this->ComputeKernel(kernel, -radius+kernelLeftClip,
-                          radius-kernelRightClip,
-                          static_cast<double>(this->StandardDeviations[axis]));
-      kernelSize = size - kernelLeftClip - kernelRightClip;
-      }
-    previousClipped = currentClipped;
-
-    /* now do the convolution on the rest of the axes */
-    inPtr = inData->GetScalarPointer(coords);
-    switch (inData->GetScalarType())
-      {
-      vtkTemplateMacro(
-        vtkImageGaussianSmoothExecute(this, axis, kernel, kernelSize,
-                                      inData, static_cast<VTK_TT*>(inPtr),
-                                      outData, outExt,
-                                      static_cast<VTK_TT*>(outPtr),
-                                      pcycle, target, pcount, total)
-        );
-      default:
-        vtkErrorMacro("Unknown scalar type");
-        return;
-      }
-    outPtr = static_cast<void *>(
-      static_cast<unsigned char *>(outPtr) + outIncA);
+    vtkErrorMacro("Unknown scalar type");
     }
-
-  // get rid of temporary kernel
-  delete [] kernel;
 }
+#endif
 
 //----------------------------------------------------------------------------
 // This method decomposes the gaussian and smooths along each axis.
 void vtkImageGaussianSmooth::ThreadedRequestData(
   vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector,
-  vtkInformationVector *outputVector,
+  vtkInformationVector *vtkNotUsed(outputVector),
   vtkImageData ***inData,
   vtkImageData **outData,
   int outExt[6], int id)
 {
-  int inExt[6];
-  int target, count, total, cycle;
-
-  // for feed back, determine line target to get 50 progress update
-  // update is called every target lines. Progress is computed from
-  // the number of pixels processed so far.
-  count = 0; target = 0; total = 0; cycle = 0;
-  if (id == 0)
-    {
-    // determine the number of pixels.
-    total = this->Dimensionality * (outExt[1] - outExt[0] + 1)
-      * (outExt[3] - outExt[2] + 1) * (outExt[5] - outExt[4] + 1)
-      * inData[0][0]->GetNumberOfScalarComponents();
-    // pixels per update (50 updates)
-    target = total / 50;
-    }
-
   // this filter expects that input is the same type as output.
   if (inData[0][0]->GetScalarType() != outData[0]->GetScalarType())
     {
@@ -394,70 +198,25 @@ void vtkImageGaussianSmooth::ThreadedRequestData(
     return;
     }
 
-  // Decompose
+  // Decompose: the axes are convolved within cache sized tiles of the
+  // output, the kernels being clipped at the boundaries of the whole extent
   vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
-  vtkInformation *outInfo = outputVector->GetInformationObject(0);
   int wholeExt[6];
   inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
-  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt);
-  this->InternalRequestUpdateExtent(inExt, wholeExt);
 
-  switch (this->Dimensionality)
+  vtkImageSeparableConvolver convolver;
+  convolver.SetWholeExtent(wholeExt);
+  convolver.SetBoundaryMode(vtkImageSeparableConvolver::RENORMALIZE);
+  for (int axis = 0; axis < this->Dimensionality && axis < 3; ++axis)
     {
-    case 1:
-      this->ExecuteAxis(0, inData[0][0], inExt, outData[0], outExt,
-                        &cycle, target, &count, total, inInfo);
-      break;
-    case 2:
-      int tempExt[6];
-      vtkImageData *tempData;
-      // compute intermediate extent
-      tempExt[0] = inExt[0];  tempExt[1] = inExt[1];
-      tempExt[2] = outExt[2];  tempExt[3] = outExt[3];
-      tempExt[4] = inExt[4];  tempExt[5] = inExt[5];
-      // create a temp data for intermediate results
-      tempData = vtkImageData::New();
-      tempData->SetExtent(tempExt);
-      tempData->AllocateScalars(inData[0][0]->GetScalarType(),
-                                inData[0][0]->GetNumberOfScalarComponents());
-      this->ExecuteAxis(1, inData[0][0], inExt, tempData, tempExt,
-                        &cycle, target, &count, total, inInfo);
-      this->ExecuteAxis(0, tempData, tempExt, outData[0], outExt,
-                        &cycle, target, &count, total, inInfo);
-      // release temporary data
-      tempData->Delete();
-      break;
-    case 3:
-      // we do z first because it is most likely smallest
-      int temp0Ext[6], temp1Ext[6];
-      vtkImageData *temp0Data, *temp1Data;
-      // compute intermediate extents
-      temp0Ext[0] = inExt[0];  temp0Ext[1] = inExt[1];
-      temp0Ext[2] = inExt[2];  temp0Ext[3] = inExt[3];
-      temp0Ext[4] = outExt[4];  temp0Ext[5] = outExt[5];
-
-      temp1Ext[0] = inExt[0];  temp1Ext[1] = inExt[1];
-      temp1Ext[2] = outExt[2];  temp1Ext[3] = outExt[3];
-      temp1Ext[4] = outExt[4];  temp1Ext[5] = outExt[5];
-
-      // create a temp data for intermediate results
-      temp0Data = vtkImageData::New();
-      temp0Data->SetExtent(temp0Ext);
-      temp0Data->AllocateScalars(inData[0][0]->GetScalarType(),
-                                 inData[0][0]->GetNumberOfScalarComponents());
-
-      temp1Data = vtkImageData::New();
-      temp1Data->SetExtent(temp1Ext);
-      temp1Data->AllocateScalars(inData[0][0]->GetScalarType(),
-                                 inData[0][0]->GetNumberOfScalarComponents());
-      this->ExecuteAxis(2, inData[0][0], inExt, temp0Data, temp0Ext,
-                        &cycle, target, &count, total, inInfo);
-      this->ExecuteAxis(1, temp0Data, temp0Ext, temp1Data, temp1Ext,
-                        &cycle, target, &count, total, inInfo);
-      temp0Data->Delete();
-      this->ExecuteAxis(0, temp1Data, temp1Ext, outData[0], outExt,
-                        &cycle, target, &count, total, inInfo);
-      temp1Data->Delete();
-      break;
+    int radius = static_cast<int>(this->StandardDeviations[axis]
+                                  * this->RadiusFactors[axis]);
+    std::vector<double> kernel(2*radius + 1);
+    this->ComputeKernel(&kernel[0], -radius, radius,
+                        this->StandardDeviations[axis]);
+    convolver.SetKernel(axis, &kernel[0], 2*radius + 1);
     }
+
+  // for feed back, only the first thread reports the progress
+  convolver.Execute(this, inData[0][0], outData[0], outExt, (id == 0));
 }
@@ -16,6 +16,8 @@
 // .SECTION Description
 // vtkImageGaussianSmooth implements a convolution of the input image
 // with a gaussian. Supports from one to three dimensional convolutions.
+// The axes are convolved one after the other within cache sized tiles of
+// the output (see vtkImageSeparableConvolver).
 
 #ifndef __vtkImageGaussianSmooth_h
 #define __vtkImageGaussianSmooth_h
@@ -81,10 +83,16 @@ protected:
   void ComputeKernel(double *kernel, int min, int max, double std);
   virtual int RequestUpdateExtent (vtkInformation *, vtkInformationVector **, vtkInformationVector *);
   void InternalRequestUpdateExtent(int *, int*);
-  void ExecuteAxis(int axis, vtkImageData *inData, int inExt[6],
-                   vtkImageData *outData, int outExt[6],
-                   int *pcycle, int target, int *pcount, int total,
-                   vtkInformation *inInfo);
+
+  // Description:
+  // @deprecated The axes are convolved together by ThreadedRequestData,
+  // this convolves a single axis over outExt and ignores the progress
+  // arguments other than total.
+  VTK_LEGACY(void ExecuteAxis(int axis, vtkImageData *inData, int inExt[6],
+                              vtkImageData *outData, int outExt[6],
+                              int *pcycle, int target, int *pcount, int total,
+                              vtkInformation *inInfo));
+
   void ThreadedRequestData(vtkInformation *request,
                            vtkInformationVector **inputVector,
                            vtkInformationVector *outputVector,
@@ -15,13 +15,12 @@
 #include "vtkImageHybridMedian2D.h"
 
 #include "vtkImageData.h"
+#include "vtkImageRankSelector.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include <vector>
-#include <algorithm>
-#include <numeric>
 
 vtkStandardNewMacro(vtkImageHybridMedian2D);
 
@@ -54,6 +53,7 @@ void vtkImageHybridMedian2DExecute(vtkImageHybridMedian2D *self,
   T *outPtr0, *outPtr1, *outPtrC, *ptr;
   T median1, median2, temp;
   std::vector<T> array;
+  array.reserve(9);
   unsigned long count = 0;
   unsigned long target;
 
@@ -151,8 +151,9 @@ void vtkImageHybridMedian2DExecute(vtkImageHybridMedian2D *self,
             array.push_back( *ptr );
             }
 
-          std::sort(array.begin(),array.end());
-          median1 = array[static_cast<unsigned int>(0.5*array.size())];
+          median1 = vtkImageRankSelector::Select(
+            &array[0], static_cast<int>(array.size()),
+            static_cast<int>(array.size()/2));
 
           // compute median of x neighborhood
           // note that y axis direction is up in vtk images, not down
@@ -209,8 +210,9 @@ void vtkImageHybridMedian2DExecute(vtkImageHybridMedian2D *self,
             array.push_back( *ptr );
             }
 
-          std::sort(array.begin(),array.end());
-          median2 = array[static_cast<unsigned int>(0.5*array.size())];
+          median2 = vtkImageRankSelector::Select(
+            &array[0], static_cast<int>(array.size()),
+            static_cast<int>(array.size()/2));
 
           // Compute the median of the three. (med1, med2 and center)
           if (median1 > median2)
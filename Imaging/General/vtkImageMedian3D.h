@@ -18,7 +18,13 @@
 // median value from a rectangular neighborhood around that pixel.
 // Neighborhoods can be no more than 3 dimensional.  Setting one
 // axis of the neighborhood kernelSize to 1 changes the filter
-// into a 2D median.
+// into a 2D median.  The neighborhood is clipped at the boundaries of the
+// image; for an even number of samples, the median is that of the samples
+// other than the last one visited, as described in
+// vtkImageRankSelector::SetStatistic.  8 and 16 bit integer data is filtered with a sliding histogram,
+// whose cost grows with the area of the kernel rather than its volume.
+// .SECTION See Also
+// vtkImageRankSelector
 
 
 #ifndef __vtkImageMedian3D_h
@@ -14,13 +14,18 @@
 =========================================================================*/
 #include "vtkImageRange3D.h"
 
+#include "vtkDataArray.h"
 #include "vtkImageData.h"
 #include "vtkImageEllipsoidSource.h"
+#include "vtkImageRankSelector.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+#include <vector>
+
 vtkStandardNewMacro(vtkImageRange3D);
 
 //----------------------------------------------------------------------------
@@ -116,174 +121,8 @@ int vtkImageRange3D::RequestInformation (vtkInformation *request,
 }
 
 //----------------------------------------------------------------------------
-// This templated function executes the filter on any region,
-// whether it needs boundary checking or not.
-// If the filter needs to be faster, the function could be duplicated
-// for strictly center (no boundary ) processing.
-template <class T>
-void vtkImageRange3DExecute(vtkImageRange3D *self,
-                            vtkImageData *mask,
-                            vtkImageData *inData, T *inPtr,
-                            vtkImageData *outData, int *outExt,
-                            float *outPtr, int id,
-                            vtkInformation *inInfo)
-{
-  int *kernelMiddle, *kernelSize;
-  // For looping though output (and input) pixels.
-  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
-  int outIdx0, outIdx1, outIdx2;
-  vtkIdType inInc0, inInc1, inInc2;
-  vtkIdType outInc0, outInc1, outInc2;
-  T *inPtr0, *inPtr1, *inPtr2;
-  float *outPtr0, *outPtr1, *outPtr2;
-  int numComps, outIdxC;
-  // For looping through hood pixels
-  int hoodMin0, hoodMax0, hoodMin1, hoodMax1, hoodMin2, hoodMax2;
-  int hoodIdx0, hoodIdx1, hoodIdx2;
-  T *hoodPtr0, *hoodPtr1, *hoodPtr2;
-  // For looping through the mask.
-  unsigned char *maskPtr, *maskPtr0, *maskPtr1, *maskPtr2;
-  vtkIdType maskInc0, maskInc1, maskInc2;
-  // The extent of the whole input image
-  int inImageMin0, inImageMin1, inImageMin2;
-  int inImageMax0, inImageMax1, inImageMax2;
-  int inImageExt[6];
-  // to compute the range
-  T pixelMin, pixelMax;
-  unsigned long count = 0;
-  unsigned long target;
-
-  // Get information to march through data
-  inData->GetIncrements(inInc0, inInc1, inInc2);
-  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inImageExt);
-  inImageMin0 = inImageExt[0];
-  inImageMax0 = inImageExt[1];
-  inImageMin1 = inImageExt[2];
-  inImageMax1 = inImageExt[3];
-  inImageMin2 = inImageExt[4];
-  inImageMax2 = inImageExt[5];
-  outData->GetIncrements(outInc0, outInc1, outInc2);
-  outMin0 = outExt[0];   outMax0 = outExt[1];
-  outMin1 = outExt[2];   outMax1 = outExt[3];
-  outMin2 = outExt[4];   outMax2 = outExt[5];
-  numComps = outData->GetNumberOfScalarComponents();
-
-  // Get ivars of this object (easier than making friends)
-  kernelSize = self->GetKernelSize();
-  kernelMiddle = self->GetKernelMiddle();
-  hoodMin0 = - kernelMiddle[0];
-  hoodMin1 = - kernelMiddle[1];
-  hoodMin2 = - kernelMiddle[2];
-  hoodMax0 = hoodMin0 + kernelSize[0] - 1;
-  hoodMax1 = hoodMin1 + kernelSize[1] - 1;
-  hoodMax2 = hoodMin2 + kernelSize[2] - 1;
-
-  // Setup mask info
-  maskPtr = static_cast<unsigned char *>(mask->GetScalarPointer());
-  mask->GetIncrements(maskInc0, maskInc1, maskInc2);
-
-  // in and out should be marching through corresponding pixels.
-  inPtr = static_cast<T *>(
-    inData->GetScalarPointer(outMin0, outMin1, outMin2));
-
-  target = static_cast<unsigned long>(numComps*(outMax2-outMin2+1)*
-                                      (outMax1-outMin1+1)/50.0);
-  target++;
-
-  // loop through components
-  for (outIdxC = 0; outIdxC < numComps; ++outIdxC)
-    {
-    // loop through pixels of output
-    outPtr2 = outPtr;
-    inPtr2 = inPtr;
-    for (outIdx2 = outMin2; outIdx2 <= outMax2; ++outIdx2)
-      {
-      outPtr1 = outPtr2;
-      inPtr1 = inPtr2;
-      for (outIdx1 = outMin1;
-           !self->AbortExecute && outIdx1 <= outMax1; ++outIdx1)
-        {
-        if (!id)
-          {
-          if (!(count%target))
-            {
-            self->UpdateProgress(count/(50.0*target));
-            }
-          count++;
-          }
-
-        outPtr0 = outPtr1;
-        inPtr0 = inPtr1;
-        for (outIdx0 = outMin0; outIdx0 <= outMax0; ++outIdx0)
-          {
-          // Find min and max
-          pixelMin = pixelMax = *inPtr0;
-          // loop through neighborhood pixels
-          // as sort of a hack to handle boundaries,
-          // input pointer will be marching through data that does not exist.
-          hoodPtr2 = inPtr0 - kernelMiddle[0] * inInc0
-            - kernelMiddle[1] * inInc1 - kernelMiddle[2] * inInc2;
-          maskPtr2 = maskPtr;
-          for (hoodIdx2 = hoodMin2; hoodIdx2 <= hoodMax2; ++hoodIdx2)
-            {
-            hoodPtr1 = hoodPtr2;
-            maskPtr1 = maskPtr2;
-            for (hoodIdx1 = hoodMin1; hoodIdx1 <= hoodMax1; ++hoodIdx1)
-              {
-              hoodPtr0 = hoodPtr1;
-              maskPtr0 = maskPtr1;
-              for (hoodIdx0 = hoodMin0; hoodIdx0 <= hoodMax0; ++hoodIdx0)
-                {
-                // A quick but rather expensive way to handle boundaries
-                if ( outIdx0 + hoodIdx0 >= inImageMin0 &&
-                     outIdx0 + hoodIdx0 <= inImageMax0 &&
-                     outIdx1 + hoodIdx1 >= inImageMin1 &&
-                     outIdx1 + hoodIdx1 <= inImageMax1 &&
-                     outIdx2 + hoodIdx2 >= inImageMin2 &&
-                     outIdx2 + hoodIdx2 <= inImageMax2)
-                  {
-                  if (*maskPtr0)
-                    {
-                    if (*hoodPtr0 < pixelMin)
-                      {
-                      pixelMin = *hoodPtr0;
-                      }
-                    if (*hoodPtr0 > pixelMax)
-                      {
-                      pixelMax = *hoodPtr0;
-                      }
-                    }
-                  }
-
-                hoodPtr0 += inInc0;
-                maskPtr0 += maskInc0;
-                }
-              hoodPtr1 += inInc1;
-              maskPtr1 += maskInc1;
-              }
-            hoodPtr2 += inInc2;
-            maskPtr2 += maskInc2;
-            }
-          *outPtr0 = static_cast<float>(pixelMax - pixelMin);
-
-          inPtr0 += inInc0;
-          outPtr0 += outInc0;
-          }
-        inPtr1 += inInc1;
-        outPtr1 += outInc1;
-        }
-      inPtr2 += inInc2;
-      outPtr2 += outInc2;
-      }
-    ++inPtr;
-    ++outPtr;
-    }
-}
-
-//----------------------------------------------------------------------------
-// This method contains the first switch statement that calls the correct
-// templated function for the input and output Data types.
-// It hanldes image boundaries, so the image does not shrink.
+// The range is computed by a vtkImageRankSelector, over the ellipsoid
+// clipped at the image boundaries, so the image does not shrink.
 void vtkImageRange3D::ThreadedRequestData(
   vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector,
@@ -292,12 +131,9 @@ void vtkImageRange3D::ThreadedRequestData(
   vtkImageData **outData,
   int outExt[6], int id)
 {
-  int inExt[6], wholeExt[6];
+  int wholeExt[6];
   vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
   inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
-  this->InternalRequestUpdateExtent(inExt,outExt,wholeExt);
-  void *inPtr = inData[0][0]->GetScalarPointerForExtent(inExt);
-  void *outPtr = outData[0]->GetScalarPointerForExtent(outExt);
   vtkImageData *mask;
 
   // Error checking on mask
@@ -317,15 +153,25 @@ void vtkImageRange3D::ThreadedRequestData(
     return;
     }
 
-  switch (inData[0][0]->GetScalarType())
+  // The range over the ellipsoid, which always includes the center
+  vtkIdType maskSize = static_cast<vtkIdType>(this->KernelSize[0])*
+    this->KernelSize[1]*this->KernelSize[2];
+  unsigned char *maskPtr = static_cast<unsigned char *>(
+    mask->GetScalarPointer());
+  std::vector<unsigned char> footprint(maskPtr, maskPtr + maskSize);
+  footprint[(static_cast<vtkIdType>(this->KernelMiddle[2])*
+             this->KernelSize[1] + this->KernelMiddle[1])*
+            this->KernelSize[0] + this->KernelMiddle[0]] = 1;
+
+  vtkImageRankSelector selector;
+  selector.SetKernel(this->KernelSize, this->KernelMiddle, &footprint[0]);
+  selector.SetStatistic(vtkImageRankSelector::RANGE);
+  selector.SetWholeExtent(wholeExt);
+  vtkDataArray *inArray = inData[0][0]->GetPointData()->GetScalars();
+  if (!inArray ||
+      !selector.Execute(this, inData[0][0], inArray, outData[0], outExt, id))
     {
-    vtkTemplateMacro(
-      vtkImageRange3DExecute(this, mask, inData[0][0],
-                             static_cast<VTK_TT *>(inPtr), outData[0], outExt,
-                             static_cast<float *>(outPtr), id, inInfo));
-    default:
-      vtkErrorMacro(<< "Execute: Unknown ScalarType");
-      return;
+    vtkErrorMacro(<< "Execute: Unknown ScalarType");
     }
 }
 
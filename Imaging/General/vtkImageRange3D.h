@@ -16,7 +16,10 @@
 // .SECTION Description
 // vtkImageRange3D replaces a pixel with the maximum minus minimum over
 // an ellipsoidal neighborhood.  If KernelSize of an axis is 1, no processing
-// is done on that axis.
+// is done on that axis.  The extremes of 8 and 16 bit integer data are
+// tracked in a histogram that slides along x.
+// .SECTION See Also
+// vtkImageRankSelector
 
 
 #ifndef __vtkImageRange3D_h
@@ -0,0 +1,570 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageRankSelector.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageRankSelector.h"
+
+#include "vtkAlgorithm.h"
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+
+#include <limits>
+
+// The smallest neighborhood for which the histogram is used with 16 bit
+// data, smaller ones are faster to gather and select.
+static const int vtkImageRankSelectorMinimumHistogramVolume = 64;
+
+namespace
+{
+// The histogram bins of the types that have few enough values: Bits is the
+// number of bits of the bin index, zero for other types.
+template <class T, int B>
+struct vtkIRSBinsBase
+{
+  enum { Bits = B };
+  static int Index(T v)
+  {
+    return static_cast<int>(v) -
+      static_cast<int>(std::numeric_limits<T>::min());
+  }
+  static T Value(int i)
+  {
+    return static_cast<T>(
+      i + static_cast<int>(std::numeric_limits<T>::min()));
+  }
+};
+
+template <class T>
+struct vtkIRSBins
+{
+  enum { Bits = 0 };
+  static int Index(T) { return 0; }
+  static T Value(int) { return T(); }
+};
+
+template <>
+struct vtkIRSBins<char> : public vtkIRSBinsBase<char, 8> {};
+template <>
+struct vtkIRSBins<signed char> : public vtkIRSBinsBase<signed char, 8> {};
+template <>
+struct vtkIRSBins<unsigned char> : public vtkIRSBinsBase<unsigned char, 8> {};
+template <>
+struct vtkIRSBins<short> : public vtkIRSBinsBase<short, 16> {};
+template <>
+struct vtkIRSBins<unsigned short> :
+  public vtkIRSBinsBase<unsigned short, 16> {};
+
+//----------------------------------------------------------------------------
+// A histogram with fine bins grouped into coarse ones. The position of up
+// to two ranks is kept as the coarse bin that holds it and the number of
+// samples below that bin, so that a rank is found from its previous
+// position by walking the coarse bins, then the fine bins of one coarse bin.
+class vtkIRSHistogram
+{
+public:
+  void Initialize(int bits)
+  {
+    this->Shift = bits/2;
+    this->Fine.assign(static_cast<size_t>(1) << bits, 0);
+    this->Coarse.assign(static_cast<size_t>(1) << (bits - this->Shift), 0);
+    this->Count = 0;
+    for (int t = 0; t < 2; ++t)
+      {
+      this->Position[t] = 0;
+      this->Below[t] = 0;
+      }
+  }
+
+  void Add(int i)
+  {
+    int c = i >> this->Shift;
+    ++this->Fine[i];
+    ++this->Coarse[c];
+    ++this->Count;
+    this->Below[0] += (c < this->Position[0]);
+    this->Below[1] += (c < this->Position[1]);
+  }
+
+  void Remove(int i)
+  {
+    int c = i >> this->Shift;
+    --this->Fine[i];
+    --this->Coarse[c];
+    --this->Count;
+    this->Below[0] -= (c < this->Position[0]);
+    this->Below[1] -= (c < this->Position[1]);
+  }
+
+  // The bin of the sample of the given rank, found with the tracker t.
+  int Select(int t, int rank)
+  {
+    int c = this->Position[t];
+    int below = this->Below[t];
+    while (below + this->Coarse[c] <= rank)
+      {
+      below += this->Coarse[c];
+      ++c;
+      }
+    while (below > rank)
+      {
+      --c;
+      below -= this->Coarse[c];
+      }
+    this->Position[t] = c;
+    this->Below[t] = below;
+    int i = c << this->Shift;
+    for (int r = rank - below; r >= this->Fine[i]; ++i)
+      {
+      r -= this->Fine[i];
+      }
+    return i;
+  }
+
+  int Count;
+
+protected:
+  std::vector<int> Fine;
+  std::vector<int> Coarse;
+  int Shift;
+  int Position[2];
+  int Below[2];
+};
+
+//----------------------------------------------------------------------------
+// The rank of a statistic among n samples (for RANGE, of the minimum).
+int vtkIRSRank(int statistic, double percentile, int n)
+{
+  switch (statistic)
+    {
+    case vtkImageRankSelector::MEDIAN:
+      return n/2;
+    case vtkImageRankSelector::MAXIMUM:
+      return n - 1;
+    case vtkImageRankSelector::PERCENTILE:
+      {
+      int rank = static_cast<int>(percentile*0.01*(n - 1) + 0.5);
+      return (rank < 0 ? 0 : (rank > n - 1 ? n - 1 : rank));
+      }
+    }
+  return 0;
+}
+
+// The median of an even number of samples, from the two middle values and
+// the last sample visited, as described in SetStatistic.
+template <class T>
+T vtkIRSEvenMedian(T lower, T upper, T last)
+{
+  return (vtkImageRankSelector::Less<T>()(last, upper) ? upper : lower);
+}
+
+// The parameters of an execution, with the runs of the neighborhood that
+// are inside the bounds for the current row.
+template <class T>
+struct vtkIRSRow
+{
+  int Statistic;
+  double Percentile;
+  int Bounds[6];
+  std::vector<const T *> Rows;
+  std::vector<int> Min;
+  std::vector<int> Max;
+  int NumberOfComponents;
+  int InMin0;
+};
+
+//----------------------------------------------------------------------------
+// One row of output samples of one component, from a sliding histogram.
+template <class T, class TO>
+void vtkIRSHistogramRow(vtkIRSRow<T>& row, vtkIRSHistogram& hist,
+                        int x0, int x1, TO *outPtr, vtkIdType outInc0)
+{
+  typedef vtkIRSBins<T> Bins;
+  int nc = row.NumberOfComponents;
+  int lo = row.Bounds[0];
+  int hi = row.Bounds[1];
+  size_t nruns = row.Rows.size();
+  for (size_t r = 0; r < nruns; ++r)
+    {
+    int first = (x0 + row.Min[r] > lo ? x0 + row.Min[r] : lo);
+    int last = (x0 + row.Max[r] < hi ? x0 + row.Max[r] : hi);
+    const T *ptr = row.Rows[r];
+    for (int x = first; x <= last; ++x)
+      {
+      hist.Add(Bins::Index(ptr[(x - row.InMin0)*nc]));
+      }
+    }
+
+  for (int x = x0; x <= x1; ++x)
+    {
+    if (x > x0)
+      {
+      for (size_t r = 0; r < nruns; ++r)
+        {
+        const T *ptr = row.Rows[r];
+        int leave = x - 1 + row.Min[r];
+        int enter = x + row.Max[r];
+        if (leave >= lo && leave <= hi)
+          {
+          hist.Remove(Bins::Index(ptr[(leave - row.InMin0)*nc]));
+          }
+        if (enter >= lo && enter <= hi)
+          {
+          hist.Add(Bins::Index(ptr[(enter - row.InMin0)*nc]));
+          }
+        }
+      }
+    int n = hist.Count;
+    if (n == 0)
+      {
+      *outPtr = TO();
+      }
+    else if (row.Statistic == vtkImageRankSelector::RANGE)
+      {
+      T minimum = Bins::Value(hist.Select(0, 0));
+      T maximum = Bins::Value(hist.Select(1, n - 1));
+      *outPtr = static_cast<TO>(static_cast<double>(maximum) -
+                                static_cast<double>(minimum));
+      }
+    else if (row.Statistic == vtkImageRankSelector::MEDIAN && n % 2 == 0)
+      {
+      // the last sample is at the end of the last run that is not empty
+      T last = T();
+      for (size_t r = nruns; r-- > 0; )
+        {
+        int end = (x + row.Max[r] < hi ? x + row.Max[r] : hi);
+        if (end >= lo && end >= x + row.Min[r])
+          {
+          last = row.Rows[r][(end - row.InMin0)*nc];
+          break;
+          }
+        }
+      T lower = Bins::Value(hist.Select(1, n/2 - 1));
+      T upper = Bins::Value(hist.Select(0, n/2));
+      *outPtr = static_cast<TO>(vtkIRSEvenMedian(lower, upper, last));
+      }
+    else
+      {
+      *outPtr = static_cast<TO>(Bins::Value(
+        hist.Select(0, vtkIRSRank(row.Statistic, row.Percentile, n))));
+      }
+    outPtr += outInc0;
+    }
+
+  // empty the histogram for the next row
+  for (size_t r = 0; r < nruns; ++r)
+    {
+    int first = (x1 + row.Min[r] > lo ? x1 + row.Min[r] : lo);
+    int last = (x1 + row.Max[r] < hi ? x1 + row.Max[r] : hi);
+    const T *ptr = row.Rows[r];
+    for (int x = first; x <= last; ++x)
+      {
+      hist.Remove(Bins::Index(ptr[(x - row.InMin0)*nc]));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// One row of output samples of one component, gathering the samples.
+template <class T, class TO>
+void vtkIRSGatherRow(vtkIRSRow<T>& row, std::vector<T>& values,
+                     int x0, int x1, TO *outPtr, vtkIdType outInc0)
+{
+  vtkImageRankSelector::Less<T> less;
+  int nc = row.NumberOfComponents;
+  int lo = row.Bounds[0];
+  int hi = row.Bounds[1];
+  size_t nruns = row.Rows.size();
+  for (int x = x0; x <= x1; ++x)
+    {
+    int n = 0;
+    for (size_t r = 0; r < nruns; ++r)
+      {
+      int first = (x + row.Min[r] > lo ? x + row.Min[r] : lo);
+      int last = (x + row.Max[r] < hi ? x + row.Max[r] : hi);
+      const T *ptr = row.Rows[r] + (first - row.InMin0)*nc;
+      for (int i = first; i <= last; ++i)
+        {
+        values[n++] = *ptr;
+        ptr += nc;
+        }
+      }
+    if (n == 0)
+      {
+      *outPtr = TO();
+      }
+    else if (row.Statistic == vtkImageRankSelector::RANGE ||
+             row.Statistic == vtkImageRankSelector::MINIMUM ||
+             row.Statistic == vtkImageRankSelector::MAXIMUM)
+      {
+      T minimum = values[0];
+      T maximum = values[0];
+      for (int i = 1; i < n; ++i)
+        {
+        minimum = (less(values[i], minimum) ? values[i] : minimum);
+        maximum = (less(maximum, values[i]) ? values[i] : maximum);
+        }
+      if (row.Statistic == vtkImageRankSelector::RANGE)
+        {
+        *outPtr = static_cast<TO>(static_cast<double>(maximum) -
+                                  static_cast<double>(minimum));
+        }
+      else
+        {
+        *outPtr = static_cast<TO>(
+          row.Statistic == vtkImageRankSelector::MINIMUM ? minimum : maximum);
+        }
+      }
+    else if (row.Statistic == vtkImageRankSelector::MEDIAN && n % 2 == 0)
+      {
+      T last = values[n - 1];
+      T upper = vtkImageRankSelector::Select(&values[0], n, n/2);
+      T lower = values[0];
+      for (int i = 1; i < n/2; ++i)
+        {
+        lower = (less(lower, values[i]) ? values[i] : lower);
+        }
+      *outPtr = static_cast<TO>(vtkIRSEvenMedian(lower, upper, last));
+      }
+    else
+      {
+      *outPtr = static_cast<TO>(vtkImageRankSelector::Select(
+        &values[0], n, vtkIRSRank(row.Statistic, row.Percentile, n)));
+      }
+    outPtr += outInc0;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T, class TO>
+void vtkIRSExecute(vtkAlgorithm *self,
+                   const std::vector<vtkImageRankSelector::Run>& runs,
+                   vtkIRSRow<T>& row, const T *inPtr, const int inExt[6],
+                   TO *outPtr, const vtkIdType outInc[3],
+                   const int outExt[6], int id)
+{
+  int nc = row.NumberOfComponents;
+  vtkIdType inInc1 = static_cast<vtkIdType>(inExt[1] - inExt[0] + 1)*nc;
+  vtkIdType inInc2 = inInc1*(inExt[3] - inExt[2] + 1);
+  row.InMin0 = inExt[0];
+
+  // the largest neighborhood, and the choice of algorithm
+  int volume = 0;
+  for (size_t r = 0; r < runs.size(); ++r)
+    {
+    volume += runs[r].Max - runs[r].Min + 1;
+    }
+  typedef vtkIRSBins<T> Bins;
+  int useHistogram = (Bins::Bits == 8 ||
+    (Bins::Bits == 16 &&
+     volume >= vtkImageRankSelectorMinimumHistogramVolume));
+  vtkIRSHistogram hist;
+  std::vector<T> values;
+  if (useHistogram)
+    {
+    hist.Initialize(Bins::Bits);
+    }
+  else
+    {
+    values.resize(volume + 1);
+    }
+
+  unsigned long count = 0;
+  unsigned long target = static_cast<unsigned long>(
+    nc*(outExt[5] - outExt[4] + 1)*(outExt[3] - outExt[2] + 1)/50.0);
+  target++;
+
+  for (int c = 0; c < nc; ++c)
+    {
+    for (int z = outExt[4]; z <= outExt[5]; ++z)
+      {
+      for (int y = outExt[2]; !self->AbortExecute && y <= outExt[3]; ++y)
+        {
+        if (!id)
+          {
+          if (!(count%target))
+            {
+            self->UpdateProgress(count/(50.0*target));
+            }
+          count++;
+          }
+        row.Rows.clear();
+        row.Min.clear();
+        row.Max.clear();
+        for (size_t r = 0; r < runs.size(); ++r)
+          {
+          int ry = y + runs[r].Y;
+          int rz = z + runs[r].Z;
+          if (ry >= row.Bounds[2] && ry <= row.Bounds[3] &&
+              rz >= row.Bounds[4] && rz <= row.Bounds[5])
+            {
+            row.Rows.push_back(inPtr + (ry - inExt[2])*inInc1 +
+                               (rz - inExt[4])*inInc2 + c);
+            row.Min.push_back(runs[r].Min);
+            row.Max.push_back(runs[r].Max);
+            }
+          }
+        TO *outRow = outPtr + (y - outExt[2])*outInc[1] +
+          (z - outExt[4])*outInc[2] + c;
+        if (useHistogram)
+          {
+          vtkIRSHistogramRow(row, hist, outExt[0], outExt[1], outRow,
+                             outInc[0]);
+          }
+        else
+          {
+          vtkIRSGatherRow(row, values, outExt[0], outExt[1], outRow,
+                          outInc[0]);
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+int vtkIRSExecuteInput(vtkAlgorithm *self,
+                       const std::vector<vtkImageRankSelector::Run>& runs,
+                       int statistic, double percentile, const int bounds[6],
+                       int nc, const T *inPtr, const int inExt[6],
+                       vtkImageData *outData, int sameType,
+                       const int outExt[6], int id)
+{
+  vtkIRSRow<T> row;
+  row.Statistic = statistic;
+  row.Percentile = percentile;
+  row.NumberOfComponents = nc;
+  for (int i = 0; i < 6; ++i)
+    {
+    row.Bounds[i] = bounds[i];
+    }
+
+  vtkIdType outInc[3];
+  outData->GetIncrements(outInc);
+  void *outPtr =
+    outData->GetScalarPointerForExtent(const_cast<int *>(outExt));
+  if (sameType)
+    {
+    vtkIRSExecute(self, runs, row, inPtr, inExt, static_cast<T *>(outPtr),
+                  outInc, outExt, id);
+    }
+  else if (outData->GetScalarType() == VTK_FLOAT)
+    {
+    vtkIRSExecute(self, runs, row, inPtr, inExt,
+                  static_cast<float *>(outPtr), outInc, outExt, id);
+    }
+  else
+    {
+    return 0;
+    }
+  return 1;
+}
+}
+
+//----------------------------------------------------------------------------
+vtkImageRankSelector::vtkImageRankSelector()
+{
+  this->Statistic = MEDIAN;
+  this->Percentile = 50.0;
+  for (int i = 0; i < 3; ++i)
+    {
+    this->WholeExtent[2*i] = 0;
+    this->WholeExtent[2*i + 1] = -1;
+    }
+  int size[3] = { 1, 1, 1 };
+  int middle[3] = { 0, 0, 0 };
+  this->SetKernel(size, middle);
+}
+
+//----------------------------------------------------------------------------
+vtkImageRankSelector::~vtkImageRankSelector()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRankSelector::SetKernel(const int size[3], const int middle[3],
+                                     const unsigned char *mask)
+{
+  this->Runs.clear();
+  for (int k = 0; k < size[2]; ++k)
+    {
+    for (int j = 0; j < size[1]; ++j)
+      {
+      const unsigned char *maskRow =
+        (mask ? mask + (static_cast<vtkIdType>(k)*size[1] + j)*size[0] : 0);
+      int i = 0;
+      while (i < size[0])
+        {
+        if (maskRow && !maskRow[i])
+          {
+          ++i;
+          continue;
+          }
+        Run run;
+        run.Y = j - middle[1];
+        run.Z = k - middle[2];
+        run.Min = i - middle[0];
+        while (i < size[0] && (!maskRow || maskRow[i]))
+          {
+          ++i;
+          }
+        run.Max = i - 1 - middle[0];
+        this->Runs.push_back(run);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRankSelector::SetWholeExtent(const int extent[6])
+{
+  for (int i = 0; i < 6; ++i)
+    {
+    this->WholeExtent[i] = extent[i];
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkImageRankSelector::Execute(vtkAlgorithm *self, vtkImageData *inData,
+                                  vtkDataArray *inArray,
+                                  vtkImageData *outData,
+                                  const int outExt[6], int id)
+{
+  int *inExt = inData->GetExtent();
+  int nc = inArray->GetNumberOfComponents();
+  if (outData->GetNumberOfScalarComponents() != nc)
+    {
+    return 0;
+    }
+  int sameType = (outData->GetScalarType() == inArray->GetDataType());
+  void *inPtr = inArray->GetVoidPointer(0);
+
+  // the neighborhood is clipped by the whole extent and the input extent
+  int bounds[6];
+  for (int i = 0; i < 3; ++i)
+    {
+    bounds[2*i] = (this->WholeExtent[2*i] > inExt[2*i] ?
+                   this->WholeExtent[2*i] : inExt[2*i]);
+    bounds[2*i + 1] = (this->WholeExtent[2*i + 1] < inExt[2*i + 1] ?
+                       this->WholeExtent[2*i + 1] : inExt[2*i + 1]);
+    }
+
+  switch (inArray->GetDataType())
+    {
+    vtkTemplateMacro(
+      return vtkIRSExecuteInput(self, this->Runs, this->Statistic,
+                                this->Percentile, bounds, nc,
+                                static_cast<const VTK_TT *>(inPtr), inExt,
+                                outData, sameType, outExt, id));
+    }
+  return 0;
+}
@@ -0,0 +1,169 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageRankSelector.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageRankSelector - Rank statistics over image neighborhoods
+// .SECTION Description
+// vtkImageRankSelector is the rank filter engine shared by vtkImageMedian3D,
+// vtkImageRange3D and vtkImageHybridMedian2D. It replaces every sample by a
+// rank statistic (median, minimum, maximum, max - min or a percentile) of
+// the samples of a neighborhood, which is a box or any mask, clipped at the
+// boundaries of the whole extent.
+//
+// The neighborhood is stored as runs of samples along x. For 8 and 16 bit
+// integer data, the samples of the neighborhood are counted in a two level
+// histogram that slides along x: moving to the next sample only adds the
+// samples entering the runs and removes the ones leaving them, and the rank
+// is found from the previous one by walking the coarse bins. The cost per
+// sample therefore grows with the number of runs rather than with the
+// volume of the neighborhood. For other types the samples are gathered and
+// the rank is selected in linear time.
+// .SECTION See Also
+// vtkImageMedian3D vtkImageRange3D vtkImageHybridMedian2D
+
+#ifndef __vtkImageRankSelector_h
+#define __vtkImageRankSelector_h
+
+#include "vtkImagingGeneralModule.h" // For export macro
+#include "vtkSystemIncludes.h"
+
+#include <algorithm> // For nth_element
+#include <vector> // For the runs
+
+class vtkAlgorithm;
+class vtkDataArray;
+class vtkImageData;
+
+class VTKIMAGINGGENERAL_EXPORT vtkImageRankSelector
+{
+public:
+  vtkImageRankSelector();
+  ~vtkImageRankSelector();
+
+  //BTX
+  enum StatisticEnum
+  {
+    MEDIAN = 0,
+    MINIMUM = 1,
+    MAXIMUM = 2,
+    RANGE = 3,
+    PERCENTILE = 4
+  };
+  //ETX
+
+  // Description:
+  // Set the neighborhood: a box of the given size, the output sample being
+  // at middle within the box. If mask is not NULL, only the samples of the
+  // box for which mask (of the size of the box, x fastest) is not zero are
+  // part of the neighborhood.
+  void SetKernel(const int size[3], const int middle[3],
+                 const unsigned char *mask = 0);
+
+  // Description:
+  // Set the statistic: MEDIAN (the default), MINIMUM, MAXIMUM, RANGE (the
+  // maximum minus the minimum) or PERCENTILE (the sample of rank
+  // Percentile/100*(n-1), rounded, for n samples). For an odd n, the median
+  // is the sample of rank n/2. For an even n, it is the median of the
+  // samples other than the last one visited (x fastest, then y, then z),
+  // which is the lower middle value if the last sample is at least the
+  // upper middle value, and the upper middle value otherwise: this is what
+  // vtkImageMedian3D has always computed. NaN is ordered after all the
+  // other values.
+  void SetStatistic(int statistic) { this->Statistic = statistic; }
+  int GetStatistic() const { return this->Statistic; }
+  void SetPercentile(double p) { this->Percentile = p; }
+  double GetPercentile() const { return this->Percentile; }
+
+  // Description:
+  // Set the whole extent of the input, at the boundaries of which the
+  // neighborhood is clipped.
+  void SetWholeExtent(const int extent[6]);
+
+  // Description:
+  // Compute the statistic over outExt into outData, for the samples of
+  // inArray, the point data of inData. The output must have the type of
+  // the input, or be float, and the same number of components; every
+  // component is processed separately. Abort is checked on self for every
+  // row, and progress is reported on it if id is zero. Return 0 for
+  // unsupported scalar types.
+  int Execute(vtkAlgorithm *self, vtkImageData *inData,
+              vtkDataArray *inArray, vtkImageData *outData,
+              const int outExt[6], int id);
+
+  //BTX
+  // Description:
+  // The order of the samples: the usual one, except that NaN comes after
+  // all the other values, so that the order is defined for any data.
+  template <class T>
+  struct Less
+  {
+    bool operator()(T a, T b) const { return (a < b); }
+  };
+
+  // Description:
+  // Replace values by a permutation of them in which the value of the given
+  // rank is at its place in sorted order, and return it.
+  template <class T>
+  static T Select(T *values, int n, int rank)
+  {
+    std::nth_element(values, values + rank, values + n, Less<T>());
+    return values[rank];
+  }
+
+  // Description:
+  // A run of the neighborhood: the samples from x + Min to x + Max of the
+  // row at y + Y, z + Z around the output sample (x, y, z).
+  struct Run
+  {
+    int Y;
+    int Z;
+    int Min;
+    int Max;
+  };
+  //ETX
+
+protected:
+  //BTX
+  std::vector<Run> Runs;
+  //ETX
+  int Statistic;
+  double Percentile;
+  int WholeExtent[6];
+
+private:
+  vtkImageRankSelector(const vtkImageRankSelector&);  // Not implemented.
+  void operator=(const vtkImageRankSelector&);  // Not implemented.
+};
+
+//BTX
+template <>
+struct vtkImageRankSelector::Less<float>
+{
+  bool operator()(float a, float b) const
+  {
+    return (a < b || (a == a && b != b));
+  }
+};
+
+template <>
+struct vtkImageRankSelector::Less<double>
+{
+  bool operator()(double a, double b) const
+  {
+    return (a < b || (a == a && b != b));
+  }
+};
+//ETX
+
+#endif
+// VTK-HeaderTest-Exclude: vtkImageRankSelector.h
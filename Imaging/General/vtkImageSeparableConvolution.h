@@ -21,7 +21,11 @@
 // that dimension is skipped.  This filter is designed to efficiently
 // convolve separable filters that can be decomposed into 1 or more 1D
 // convolutions.  It also handles arbitrarly large kernel sizes, and
-// uses edge replication to handle boundaries.
+// uses edge replication to handle boundaries. The convolution itself is
+// done by vtkImageSeparableConvolver, which convolves all the axes up to
+// the Dimensionality in a single pass, so that unlike the other
+// vtkImageDecomposeFilter subclasses, this filter runs one iteration and
+// needs no intermediate image.
 
 #ifndef __vtkImageSeparableConvolution_h
 #define __vtkImageSeparableConvolution_h
@@ -69,6 +73,10 @@ protected:
   vtkFloatArray* YKernel;
   vtkFloatArray* ZKernel;
 
+  // Description:
+  // Get the kernel of an axis.
+  vtkFloatArray* GetKernel(int axis);
+
   virtual int IterativeRequestData(vtkInformation*,
                                    vtkInformationVector**,
                                    vtkInformationVector*);
@@ -78,6 +86,10 @@ protected:
   virtual int IterativeRequestUpdateExtent(vtkInformation* in,
                                            vtkInformation* out);
 
+  // Description:
+  // The axes are all convolved by the same iteration.
+  virtual void SetNumberOfIterations(int num);
+
 private:
   vtkImageSeparableConvolution(const vtkImageSeparableConvolution&);  // Not implemented.
   void operator=(const vtkImageSeparableConvolution&);  // Not implemented.
@@ -0,0 +1,587 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageSeparableConvolver.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageSeparableConvolver.h"
+
+#include "vtkAlgorithm.h"
+#include "vtkImageData.h"
+
+// The size of the intermediate results of a tile, which should fit in the
+// cache of a core.
+static const size_t vtkImageSeparableConvolverTileBytes = 524288;
+
+namespace
+{
+// The type in which the convolution is computed.
+template <class T>
+struct vtkISCWork
+{
+  typedef double Type;
+};
+
+template <>
+struct vtkISCWork<float>
+{
+  typedef float Type;
+};
+
+// A block of samples: the pointer to the first sample of Extent, and the
+// increments (in samples) along each axis. The rows are contiguous.
+template <class T>
+struct vtkISCView
+{
+  T *Ptr;
+  int Extent[6];
+  vtkIdType Inc[3];
+
+  T *Row(int y, int z) const
+  {
+    return this->Ptr + (y - this->Extent[2])*this->Inc[1] +
+      (z - this->Extent[4])*this->Inc[2];
+  }
+};
+
+//----------------------------------------------------------------------------
+// Convolve along y or z: every output row is a weighted sum of input rows.
+template <class TI, class TO, class W>
+void vtkISCConvolveRows(const vtkImageSeparableConvolver::AxisKernel& k,
+                        const W *weights, int axis,
+                        const vtkISCView<TI>& in, const vtkISCView<TO>& out,
+                        int nc, W *acc)
+{
+  int other = 3 - axis;
+  vtkIdType n = static_cast<vtkIdType>(out.Extent[1] - out.Extent[0] + 1)*nc;
+  for (int b = out.Extent[2*other]; b <= out.Extent[2*other+1]; ++b)
+    {
+    for (int a = out.Extent[2*axis]; a <= out.Extent[2*axis+1]; ++a)
+      {
+      int pos = a - k.Min;
+      int first = k.First[pos];
+      int size = k.Size[pos];
+      const W *w = weights + k.Offset[pos];
+      for (int j = 0; j < size; ++j)
+        {
+        const TI *row = (axis == 1 ? in.Row(first + j, b) :
+                                     in.Row(b, first + j));
+        W wj = w[j];
+        if (j == 0)
+          {
+          for (vtkIdType e = 0; e < n; ++e)
+            {
+            acc[e] = wj*static_cast<W>(row[e]);
+            }
+          }
+        else
+          {
+          for (vtkIdType e = 0; e < n; ++e)
+            {
+            acc[e] += wj*static_cast<W>(row[e]);
+            }
+          }
+        }
+      TO *outRow = (axis == 1 ? out.Row(a, b) : out.Row(b, a));
+      for (vtkIdType e = 0; e < n; ++e)
+        {
+        outRow[e] = static_cast<TO>(acc[e]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Convolve along x: away from the boundaries, every output row is a
+// weighted sum of shifted input rows.
+template <class TI, class TO, class W>
+void vtkISCConvolveX(const vtkImageSeparableConvolver::AxisKernel& k,
+                     const W *weights,
+                     const vtkISCView<TI>& in, const vtkISCView<TO>& out,
+                     int nc, W *acc)
+{
+  int x0 = out.Extent[0];
+  int x1 = out.Extent[1];
+  int r = k.Radius;
+  int wholeMax = k.Min + static_cast<int>(k.First.size()) - 1;
+  int lo = (x0 > k.Min + r ? x0 : k.Min + r);
+  int hi = (x1 < wholeMax - r ? x1 : wholeMax - r);
+  vtkIdType n = static_cast<vtkIdType>(x1 - x0 + 1)*nc;
+
+  for (int z = out.Extent[4]; z <= out.Extent[5]; ++z)
+    {
+    for (int y = out.Extent[2]; y <= out.Extent[3]; ++y)
+      {
+      const TI *inRow = in.Row(y, z);
+      if (lo <= hi)
+        {
+        const W *w = weights + k.Offset[lo - k.Min];
+        W *accLo = acc + static_cast<vtkIdType>(lo - x0)*nc;
+        vtkIdType m = static_cast<vtkIdType>(hi - lo + 1)*nc;
+        for (int j = 0; j <= 2*r; ++j)
+          {
+          const TI *src =
+            inRow + static_cast<vtkIdType>(lo - r + j - in.Extent[0])*nc;
+          W wj = w[j];
+          if (j == 0)
+            {
+            for (vtkIdType e = 0; e < m; ++e)
+              {
+              accLo[e] = wj*static_cast<W>(src[e]);
+              }
+            }
+          else
+            {
+            for (vtkIdType e = 0; e < m; ++e)
+              {
+              accLo[e] += wj*static_cast<W>(src[e]);
+              }
+            }
+          }
+        }
+      for (int x = x0; x <= x1; ++x)
+        {
+        if (x == lo && lo <= hi)
+          {
+          x = hi;
+          continue;
+          }
+        int pos = x - k.Min;
+        int first = k.First[pos];
+        int size = k.Size[pos];
+        const W *w = weights + k.Offset[pos];
+        for (int c = 0; c < nc; ++c)
+          {
+          const TI *src =
+            inRow + static_cast<vtkIdType>(first - in.Extent[0])*nc + c;
+          W sum = 0;
+          for (int j = 0; j < size; ++j)
+            {
+            sum += w[j]*static_cast<W>(src[j*nc]);
+            }
+          acc[static_cast<vtkIdType>(x - x0)*nc + c] = sum;
+          }
+        }
+      TO *outRow = out.Row(y, z);
+      for (vtkIdType e = 0; e < n; ++e)
+        {
+        outRow[e] = static_cast<TO>(acc[e]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class TI, class TO, class W>
+void vtkISCConvolve(const vtkImageSeparableConvolver::AxisKernel& k,
+                    const W *weights, int axis,
+                    const vtkISCView<TI>& in, const vtkISCView<TO>& out,
+                    int nc, W *acc)
+{
+  if (axis == 0)
+    {
+    vtkISCConvolveX(k, weights, in, out, nc, acc);
+    }
+  else
+    {
+    vtkISCConvolveRows(k, weights, axis, in, out, nc, acc);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class TI, class TO>
+void vtkISCCopy(const vtkISCView<TI>& in, const vtkISCView<TO>& out, int nc)
+{
+  vtkIdType n = static_cast<vtkIdType>(out.Extent[1] - out.Extent[0] + 1)*nc;
+  for (int z = out.Extent[4]; z <= out.Extent[5]; ++z)
+    {
+    for (int y = out.Extent[2]; y <= out.Extent[3]; ++y)
+      {
+      const TI *inRow = in.Row(y, z);
+      TO *outRow = out.Row(y, z);
+      for (vtkIdType e = 0; e < n; ++e)
+        {
+        outRow[e] = static_cast<TO>(inRow[e]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkISCImageView(vtkImageData *data, const int extent[6],
+                     vtkISCView<T>& view)
+{
+  view.Ptr = static_cast<T *>(
+    data->GetScalarPointerForExtent(const_cast<int *>(extent)));
+  for (int i = 0; i < 6; ++i)
+    {
+    view.Extent[i] = extent[i];
+    }
+  vtkIdType *inc = data->GetIncrements();
+  view.Inc[0] = inc[0];
+  view.Inc[1] = inc[1];
+  view.Inc[2] = inc[2];
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkISCBufferView(std::vector<T>& buffer, const int extent[6], int nc,
+                      vtkISCView<T>& view)
+{
+  vtkIdType nx = extent[1] - extent[0] + 1;
+  vtkIdType ny = extent[3] - extent[2] + 1;
+  vtkIdType nz = extent[5] - extent[4] + 1;
+  size_t size = static_cast<size_t>(nx*ny*nz*nc);
+  if (buffer.size() < size)
+    {
+    buffer.resize(size);
+    }
+  view.Ptr = &buffer[0];
+  for (int i = 0; i < 6; ++i)
+    {
+    view.Extent[i] = extent[i];
+    }
+  view.Inc[0] = nc;
+  view.Inc[1] = nx*nc;
+  view.Inc[2] = nx*ny*nc;
+}
+
+//----------------------------------------------------------------------------
+template <class TI, class TO>
+void vtkISCExecute(vtkAlgorithm *self,
+                   const vtkImageSeparableConvolver::AxisKernel *kernels,
+                   const int *axes, int numberOfAxes,
+                   const int wholeExt[6], vtkImageData *inData,
+                   vtkImageData *outData, const int outExt[6],
+                   int reportProgress)
+{
+  typedef typename vtkISCWork<TI>::Type W;
+
+  int nc = inData->GetNumberOfScalarComponents();
+  std::vector<W> weights[3];
+  for (int i = 0; i < numberOfAxes; ++i)
+    {
+    const std::vector<double>& w = kernels[axes[i]].Weights;
+    weights[axes[i]].assign(w.begin(), w.end());
+    }
+
+  // the input extent needed along each axis
+  int inExt[6];
+  int radius[3] = { 0, 0, 0 };
+  for (int i = 0; i < numberOfAxes; ++i)
+    {
+    radius[axes[i]] = kernels[axes[i]].Radius;
+    }
+  for (int a = 0; a < 3; ++a)
+    {
+    inExt[2*a] = outExt[2*a] - radius[a];
+    inExt[2*a] = (inExt[2*a] > wholeExt[2*a] ? inExt[2*a] : wholeExt[2*a]);
+    inExt[2*a+1] = outExt[2*a+1] + radius[a];
+    inExt[2*a+1] =
+      (inExt[2*a+1] < wholeExt[2*a+1] ? inExt[2*a+1] : wholeExt[2*a+1]);
+    }
+
+  // choose the tiles: whole slices if the intermediate results of a few of
+  // them fit in the cache, otherwise groups of rows
+  int ny = outExt[3] - outExt[2] + 1;
+  int nz = outExt[5] - outExt[4] + 1;
+  size_t rowBytes =
+    static_cast<size_t>(inExt[1] - inExt[0] + 1)*nc*sizeof(TO);
+  size_t tileRows = vtkImageSeparableConvolverTileBytes/rowBytes;
+  int tileY = ny;
+  int tileZ = 1;
+  if (tileRows >= static_cast<size_t>(2*ny + 2*radius[1]))
+    {
+    tileZ = static_cast<int>(tileRows/(2*ny + 2*radius[1]));
+    tileZ = (tileZ < nz ? tileZ : nz);
+    }
+  else
+    {
+    tileY = static_cast<int>(tileRows/2) - radius[1];
+    tileY = (tileY > 2*radius[1] ? tileY : 2*radius[1]);
+    tileY = (tileY > 8 ? tileY : 8);
+    tileY = (tileY < ny ? tileY : ny);
+    }
+
+  std::vector<TO> buffers[2];
+  std::vector<W> acc(static_cast<size_t>(inExt[1] - inExt[0] + 1)*nc);
+  double total = static_cast<double>(outExt[1] - outExt[0] + 1)*ny*nz;
+  double done = 0;
+
+  for (int z = outExt[4]; z <= outExt[5] && !self->AbortExecute; z += tileZ)
+    {
+    for (int y = outExt[2]; y <= outExt[3] && !self->AbortExecute; y += tileY)
+      {
+      int tileExt[6];
+      tileExt[0] = outExt[0];
+      tileExt[1] = outExt[1];
+      tileExt[2] = y;
+      tileExt[3] = (y + tileY - 1 < outExt[3] ? y + tileY - 1 : outExt[3]);
+      tileExt[4] = z;
+      tileExt[5] = (z + tileZ - 1 < outExt[5] ? z + tileZ - 1 : outExt[5]);
+
+      // the input of the tile
+      int ext[6];
+      for (int a = 0; a < 3; ++a)
+        {
+        ext[2*a] = tileExt[2*a] - radius[a];
+        ext[2*a] = (ext[2*a] > wholeExt[2*a] ? ext[2*a] : wholeExt[2*a]);
+        ext[2*a+1] = tileExt[2*a+1] + radius[a];
+        ext[2*a+1] =
+          (ext[2*a+1] < wholeExt[2*a+1] ? ext[2*a+1] : wholeExt[2*a+1]);
+        }
+      vtkISCView<TI> in;
+      vtkISCImageView(inData, ext, in);
+
+      vtkISCView<TO> out;
+      vtkISCImageView(outData, tileExt, out);
+
+      if (numberOfAxes == 0)
+        {
+        vtkISCCopy(in, out, nc);
+        }
+      else if (numberOfAxes == 1)
+        {
+        vtkISCConvolve(kernels[axes[0]], &weights[axes[0]][0], axes[0],
+                       in, out, nc, &acc[0]);
+        }
+      else
+        {
+        // the intermediate results go back and forth between two buffers,
+        // in the output type
+        vtkISCView<TO> temp[2];
+        for (int i = 0; i < numberOfAxes; ++i)
+          {
+          int a = axes[i];
+          ext[2*a] = tileExt[2*a];
+          ext[2*a+1] = tileExt[2*a+1];
+          const W *w = &weights[a][0];
+          if (i == 0)
+            {
+            vtkISCBufferView(buffers[0], ext, nc, temp[0]);
+            vtkISCConvolve(kernels[a], w, a, in, temp[0], nc, &acc[0]);
+            }
+          else if (i < numberOfAxes - 1)
+            {
+            vtkISCBufferView(buffers[i%2], ext, nc, temp[i%2]);
+            vtkISCConvolve(kernels[a], w, a, temp[(i-1)%2], temp[i%2],
+                           nc, &acc[0]);
+            }
+          else
+            {
+            vtkISCConvolve(kernels[a], w, a, temp[(i-1)%2], out,
+                           nc, &acc[0]);
+            }
+          }
+        }
+
+      if (reportProgress)
+        {
+        done += static_cast<double>(tileExt[1] - tileExt[0] + 1)*
+          (tileExt[3] - tileExt[2] + 1)*(tileExt[5] - tileExt[4] + 1);
+        self->UpdateProgress(done/total);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class TI>
+int vtkISCExecuteOutput(vtkAlgorithm *self,
+                        const vtkImageSeparableConvolver::AxisKernel *kernels,
+                        const int *axes, int numberOfAxes,
+                        const int wholeExt[6], vtkImageData *inData,
+                        vtkImageData *outData, const int outExt[6],
+                        int reportProgress, TI *)
+{
+  if (outData->GetScalarType() == inData->GetScalarType())
+    {
+    vtkISCExecute<TI, TI>(self, kernels, axes, numberOfAxes, wholeExt,
+                          inData, outData, outExt, reportProgress);
+    }
+  else if (outData->GetScalarType() == VTK_FLOAT)
+    {
+    vtkISCExecute<TI, float>(self, kernels, axes, numberOfAxes, wholeExt,
+                             inData, outData, outExt, reportProgress);
+    }
+  else
+    {
+    return 0;
+    }
+  return 1;
+}
+
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageSeparableConvolver::vtkImageSeparableConvolver()
+{
+  this->BoundaryMode = RENORMALIZE;
+  for (int i = 0; i < 6; ++i)
+    {
+    this->WholeExtent[i] = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkImageSeparableConvolver::~vtkImageSeparableConvolver()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSeparableConvolver::SetKernel(int axis, const double *weights,
+                                           int size)
+{
+  if (weights && size > 0)
+    {
+    // an even kernel gets a zero weight in front, so that its center
+    // stays at (size-1)/2 and all of its weights are used
+    std::vector<double>& kernel = this->Kernels[axis];
+    kernel.clear();
+    if (size % 2 == 0)
+      {
+      kernel.push_back(0.0);
+      }
+    kernel.insert(kernel.end(), weights, weights + size);
+    }
+  else
+    {
+    this->Kernels[axis].clear();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSeparableConvolver::SetBoundaryMode(int mode)
+{
+  this->BoundaryMode = mode;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSeparableConvolver::SetWholeExtent(const int extent[6])
+{
+  for (int i = 0; i < 6; ++i)
+    {
+    this->WholeExtent[i] = extent[i];
+    }
+}
+
+//----------------------------------------------------------------------------
+// Compute the kernel for every position of the whole extent: the whole
+// kernel away from the boundaries, and its clipped part near them.
+void vtkImageSeparableConvolver::BuildAxisKernel(int axis)
+{
+  const std::vector<double>& kernel = this->Kernels[axis];
+  AxisKernel& k = this->AxisKernels[axis];
+  int size = static_cast<int>(kernel.size());
+  int r = (size - 1)/2;
+  k.Radius = r;
+  k.Min = this->WholeExtent[2*axis];
+  int max = this->WholeExtent[2*axis+1];
+  int n = (max >= k.Min ? max - k.Min + 1 : 0);
+  k.First.resize(n);
+  k.Size.resize(n);
+  k.Offset.resize(n);
+  k.Weights = kernel;
+
+  double kernelSum = 0.0;
+  for (int j = 0; j < size; ++j)
+    {
+    kernelSum += kernel[j];
+    }
+
+  for (int p = k.Min; p <= max; ++p)
+    {
+    int pos = p - k.Min;
+    int lo = p - r;
+    int hi = p + r;
+    if (lo >= k.Min && hi <= max)
+      {
+      k.First[pos] = lo;
+      k.Size[pos] = size;
+      k.Offset[pos] = 0;
+      continue;
+      }
+    int clipLo = (lo > k.Min ? lo : k.Min);
+    int clipHi = (hi < max ? hi : max);
+    k.First[pos] = clipLo;
+    k.Size[pos] = clipHi - clipLo + 1;
+    k.Offset[pos] = k.Weights.size();
+    if (this->BoundaryMode == REPLICATE)
+      {
+      double below = 0.0;
+      double above = 0.0;
+      for (int j = lo; j < clipLo; ++j)
+        {
+        below += kernel[j - lo];
+        }
+      for (int j = clipHi + 1; j <= hi; ++j)
+        {
+        above += kernel[j - lo];
+        }
+      for (int j = clipLo; j <= clipHi; ++j)
+        {
+        k.Weights.push_back(kernel[j - lo]);
+        }
+      k.Weights[k.Offset[pos]] += below;
+      k.Weights.back() += above;
+      }
+    else
+      {
+      double sum = 0.0;
+      for (int j = clipLo; j <= clipHi; ++j)
+        {
+        sum += kernel[j - lo];
+        }
+      double scale = (sum != 0.0 ? kernelSum/sum : 1.0);
+      for (int j = clipLo; j <= clipHi; ++j)
+        {
+        k.Weights.push_back(kernel[j - lo]*scale);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkImageSeparableConvolver::Execute(vtkAlgorithm *self,
+                                        vtkImageData *inData,
+                                        vtkImageData *outData,
+                                        const int outExt[6],
+                                        int reportProgress)
+{
+  if (outExt[1] < outExt[0] || outExt[3] < outExt[2] ||
+      outExt[5] < outExt[4])
+    {
+    return 1;
+    }
+
+  // the axes to convolve, z first, skipping the identity kernels
+  int axes[3];
+  int numberOfAxes = 0;
+  for (int axis = 2; axis >= 0; --axis)
+    {
+    const std::vector<double>& kernel = this->Kernels[axis];
+    if (!kernel.empty() && !(kernel.size() == 1 && kernel[0] == 1.0))
+      {
+      this->BuildAxisKernel(axis);
+      axes[numberOfAxes++] = axis;
+      }
+    }
+
+  switch (inData->GetScalarType())
+    {
+    vtkTemplateMacro(
+      return vtkISCExecuteOutput(self, this->AxisKernels, axes, numberOfAxes,
+                                 this->WholeExtent, inData, outData, outExt,
+                                 reportProgress, static_cast<VTK_TT *>(0)));
+    }
+  return 0;
+}
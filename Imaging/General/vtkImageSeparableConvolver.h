@@ -0,0 +1,122 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageSeparableConvolver.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageSeparableConvolver - Convolution of an image with separable kernels
+// .SECTION Description
+// vtkImageSeparableConvolver is the convolution engine shared by
+// vtkImageGaussianSmooth and vtkImageSeparableConvolution. It convolves an
+// image with one 1D kernel per axis, along z, then y, then x.
+//
+// Instead of running each axis as a pass over the whole extent, the output
+// extent is divided into tiles (a few slices, or a few rows of a slice)
+// small enough for the intermediate results of all the axes to stay in the
+// cache. Every pass works on whole rows: the y and z passes add up weighted
+// input rows, and the x pass adds up shifted rows, so that the inner loops
+// run over contiguous samples and can be vectorized by the compiler. The
+// computation is done in float for float input data, in double otherwise,
+// and the intermediate results are stored in the output type.
+//
+// Near the boundaries of the whole extent, the kernel is either clipped and
+// renormalized, or the edge samples are replicated.
+// .SECTION See Also
+// vtkImageGaussianSmooth vtkImageSeparableConvolution
+
+#ifndef __vtkImageSeparableConvolver_h
+#define __vtkImageSeparableConvolver_h
+
+#include "vtkImagingGeneralModule.h" // For export macro
+#include "vtkSystemIncludes.h"
+
+#include <vector> // For the kernels
+
+class vtkAlgorithm;
+class vtkImageData;
+
+class VTKIMAGINGGENERAL_EXPORT vtkImageSeparableConvolver
+{
+public:
+  vtkImageSeparableConvolver();
+  ~vtkImageSeparableConvolver();
+
+  //BTX
+  enum BoundaryModeEnum
+  {
+    RENORMALIZE = 0,
+    REPLICATE = 1
+  };
+  //ETX
+
+  // Description:
+  // Set the kernel of an axis: output sample i is the sum of
+  // weights[k]*input[i+k-(size-1)/2]. An even kernel is padded with a zero
+  // weight in front, so its radius is size/2 on both sides. A size of zero
+  // (the default) leaves the data unchanged along this axis.
+  void SetKernel(int axis, const double *weights, int size);
+
+  // Description:
+  // Set how the kernels are applied near the boundaries of the whole
+  // extent: either the part of the kernel inside the whole extent is used,
+  // rescaled to the sum of the kernel (RENORMALIZE, the default), or the
+  // samples outside the whole extent take the value of the edge sample
+  // (REPLICATE).
+  void SetBoundaryMode(int mode);
+
+  // Description:
+  // Set the whole extent of the input, at the boundaries of which the
+  // kernels are clipped.
+  void SetWholeExtent(const int extent[6]);
+
+  // Description:
+  // Convolve inData over outExt into outData, which must have the same
+  // scalar type as inData or be float, and the same number of components.
+  // The extent of inData must contain the samples needed to compute outExt.
+  // Abort is checked on self between tiles, and progress is reported on it
+  // if reportProgress is set. Return 0 for unsupported scalar types.
+  int Execute(vtkAlgorithm *self, vtkImageData *inData,
+              vtkImageData *outData, const int outExt[6],
+              int reportProgress);
+
+  //BTX
+  // Description:
+  // The kernel of an axis, for every position of the whole extent: the
+  // first input sample, the number of samples and the offset of the
+  // weights in Weights.
+  struct AxisKernel
+  {
+    int Radius;
+    int Min;
+    std::vector<int> First;
+    std::vector<int> Size;
+    std::vector<size_t> Offset;
+    std::vector<double> Weights;
+  };
+  //ETX
+
+protected:
+  //BTX
+  std::vector<double> Kernels[3];
+  AxisKernel AxisKernels[3];
+  //ETX
+  int BoundaryMode;
+  int WholeExtent[6];
+
+  void BuildAxisKernel(int axis);
+
+private:
+  vtkImageSeparableConvolver(const vtkImageSeparableConvolver&);  // Not implemented.
+  void operator=(const vtkImageSeparableConvolver&);  // Not implemented.
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkImageSeparableConvolver.h
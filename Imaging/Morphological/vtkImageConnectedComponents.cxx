@@ -0,0 +1,553 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageConnectedComponents.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageConnectedComponents.h"
+
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkIntArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+
+#include <algorithm>
+#include <vector>
+
+vtkStandardNewMacro(vtkImageConnectedComponents);
+
+//----------------------------------------------------------------------------
+vtkImageConnectedComponents::vtkImageConnectedComponents()
+{
+  this->Connectivity = 6;
+  this->BackgroundValue = 0.0;
+  this->ActiveComponent = 0;
+  this->NumberOfRegions = 0;
+  this->RegionSizes = vtkIdTypeArray::New();
+  this->RegionExtents = vtkIntArray::New();
+  this->RegionExtents->SetNumberOfComponents(6);
+}
+
+//----------------------------------------------------------------------------
+vtkImageConnectedComponents::~vtkImageConnectedComponents()
+{
+  this->RegionSizes->Delete();
+  this->RegionExtents->Delete();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageConnectedComponents::RequestInformation(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **vtkNotUsed(inputVector),
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_INT, 1);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// The voxels are numbered in memory order. During the union-find, the
+// parent of voxel i is 0 for the background, i + 1 for a root, and j + 1
+// for a voxel j < i of the same region otherwise, so that every root is
+// the first voxel of its region. The image is split into blocks of whole
+// slices (or rows, for a single slice). Each block is labeled separately
+// (LABEL), after which its voxels point straight at the roots of the block.
+// Pairs of neighbor blocks are then merged across their boundary (MERGE),
+// which only links roots, then the roots get the final labels, stored as
+// negative parents, and the labels of the blocks are written (WRITE).
+template <class T, class IT>
+class vtkImageConnectedComponentsLabeler
+{
+public:
+  enum { LABEL, MERGE, WRITE };
+
+  const T *InPtr;
+  vtkIdType InIncrements[3];
+  double Background;
+  IT *Parent;
+  int *OutPtr;
+  int Size[3];
+  int NumberOfNeighbors;
+  int Neighbors[13][3];
+  vtkIdType Offsets[13];
+  vtkIdType InOffsets[13];
+  vtkIdType MaximumOffset;
+  vtkIdType BoundarySize;
+  std::vector<vtkIdType> BlockStarts;
+  std::vector<std::vector<IT> > Roots;
+  std::vector<std::vector<vtkIdType> > RootSizes;
+  std::vector<std::vector<int> > RootExtents;
+  int Pass;
+  int Step;
+
+  // The root of i, with path compression.
+  IT Find(IT i)
+  {
+    IT r = i;
+    while (this->Parent[r] - 1 != r)
+      {
+      r = this->Parent[r] - 1;
+      }
+    while (i != r)
+      {
+      IT next = this->Parent[i] - 1;
+      this->Parent[i] = r + 1;
+      i = next;
+      }
+    return r;
+  }
+
+  // Link the root of the larger index to the other one.
+  void Union(IT i, IT j)
+  {
+    i = this->Find(i);
+    j = this->Find(j);
+    if (i < j)
+      {
+      this->Parent[j] = i + 1;
+      }
+    else if (j < i)
+      {
+      this->Parent[i] = j + 1;
+      }
+  }
+
+  // Whether neighbor k of (x, y, z) is inside the image.
+  bool Inside(int x, int y, int z, int k) const
+  {
+    int nx = x + this->Neighbors[k][0];
+    int ny = y + this->Neighbors[k][1];
+    int nz = z + this->Neighbors[k][2];
+    return (nx >= 0 && nx < this->Size[0] && ny >= 0 && ny < this->Size[1] &&
+            nz >= 0);
+  }
+
+  void LabelBlock(int block)
+  {
+    vtkIdType start = this->BlockStarts[block];
+    vtkIdType end = this->BlockStarts[block + 1];
+    vtkIdType rowSize = this->Size[0];
+    for (vtkIdType row = start/rowSize; row < end/rowSize; ++row)
+      {
+      int y = static_cast<int>(row % this->Size[1]);
+      int z = static_cast<int>(row / this->Size[1]);
+      const T *inRow = this->InPtr + y*this->InIncrements[1] +
+        z*this->InIncrements[2];
+      IT i = static_cast<IT>(row*rowSize);
+      for (int x = 0; x < this->Size[0]; ++x, ++i)
+        {
+        const T *inPtr = inRow + x*this->InIncrements[0];
+        T value = *inPtr;
+        if (static_cast<double>(value) == this->Background)
+          {
+          this->Parent[i] = 0;
+          continue;
+          }
+        // the root of i is the smallest root of the connected neighbors
+        IT root = i;
+        this->Parent[i] = i + 1;
+        bool interior = (x > 0 && x + 1 < this->Size[0] && y > 0 &&
+                         y + 1 < this->Size[1] &&
+                         i - this->MaximumOffset >= start);
+        for (int k = 0; k < this->NumberOfNeighbors; ++k)
+          {
+          IT j = static_cast<IT>(i + this->Offsets[k]);
+          if ((interior || (j >= start && this->Inside(x, y, z, k))) &&
+              inPtr[this->InOffsets[k]] == value &&
+              this->Parent[j] - 1 != root)
+            {
+            IT other = this->Find(j);
+            if (other < root)
+              {
+              this->Parent[root] = other + 1;
+              root = other;
+              }
+            else if (root < other)
+              {
+              this->Parent[other] = root + 1;
+              }
+            }
+          }
+        }
+      }
+
+    // point every voxel at its root, and keep the roots
+    std::vector<IT>& roots = this->Roots[block];
+    roots.clear();
+    for (IT i = static_cast<IT>(start); i < end; ++i)
+      {
+      IT p = this->Parent[i];
+      if (p == i + 1)
+        {
+        roots.push_back(i);
+        }
+      else if (p != 0)
+        {
+        this->Parent[i] = this->Parent[p - 1];
+        }
+      }
+  }
+
+  // Merge the regions across the boundary at the start of a block.
+  void MergeBlock(int block)
+  {
+    vtkIdType start = this->BlockStarts[block];
+    vtkIdType end = std::min(this->BlockStarts[block + 1],
+                             start + this->BoundarySize);
+    vtkIdType rowSize = this->Size[0];
+    for (IT i = static_cast<IT>(start); i < end; ++i)
+      {
+      if (this->Parent[i] == 0)
+        {
+        continue;
+        }
+      int x = static_cast<int>(i % rowSize);
+      vtkIdType row = i / rowSize;
+      int y = static_cast<int>(row % this->Size[1]);
+      int z = static_cast<int>(row / this->Size[1]);
+      const T *inPtr = this->InPtr + x*this->InIncrements[0] +
+        y*this->InIncrements[1] + z*this->InIncrements[2];
+      for (int k = 0; k < this->NumberOfNeighbors; ++k)
+        {
+        IT j = static_cast<IT>(i + this->Offsets[k]);
+        if (j < start && this->Inside(x, y, z, k) &&
+            inPtr[this->InOffsets[k]] == *inPtr)
+          {
+          this->Union(this->Parent[i] - 1, this->Parent[j] - 1);
+          }
+        }
+      }
+  }
+
+  // Write the labels of a block, and the sizes and extents of its roots.
+  void WriteBlock(int block)
+  {
+    vtkIdType start = this->BlockStarts[block];
+    vtkIdType end = this->BlockStarts[block + 1];
+    vtkIdType rowSize = this->Size[0];
+    const std::vector<IT>& roots = this->Roots[block];
+    std::vector<vtkIdType>& sizes = this->RootSizes[block];
+    std::vector<int>& extents = this->RootExtents[block];
+    sizes.assign(roots.size(), 0);
+    extents.resize(6*roots.size());
+    for (size_t k = 0; k < roots.size(); ++k)
+      {
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        extents[6*k + 2*axis] = VTK_INT_MAX;
+        extents[6*k + 2*axis + 1] = VTK_INT_MIN;
+        }
+      }
+    size_t k = 0;
+    for (vtkIdType row = start/rowSize; row < end/rowSize; ++row)
+      {
+      int y = static_cast<int>(row % this->Size[1]);
+      int z = static_cast<int>(row / this->Size[1]);
+      IT i = static_cast<IT>(row*rowSize);
+      for (int x = 0; x < this->Size[0]; ++x, ++i)
+        {
+        IT p = this->Parent[i];
+        if (p == 0)
+          {
+          this->OutPtr[i] = 0;
+          continue;
+          }
+        // a root comes first in its block, so its label is written already
+        IT root = (p < 0 ? i : p - 1);
+        IT label = (p < 0 ? -p : this->Parent[root]);
+        this->Parent[i] = label;
+        this->OutPtr[i] = static_cast<int>(label);
+        if (roots[k] != root)
+          {
+          k = std::lower_bound(roots.begin(), roots.end(), root) -
+            roots.begin();
+          }
+        sizes[k]++;
+        int *extent = &extents[6*k];
+        extent[0] = std::min(extent[0], x);
+        extent[1] = std::max(extent[1], x);
+        extent[2] = std::min(extent[2], y);
+        extent[3] = std::max(extent[3], y);
+        extent[4] = std::min(extent[4], z);
+        extent[5] = std::max(extent[5], z);
+        }
+      }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType idx = begin; idx < end; ++idx)
+      {
+      int block = static_cast<int>(idx);
+      if (this->Pass == LABEL)
+        {
+        this->LabelBlock(block);
+        }
+      else if (this->Pass == MERGE)
+        {
+        // the boundaries between the pairs of groups of Step blocks
+        this->MergeBlock(this->Step*(2*block + 1));
+        }
+      else
+        {
+        this->WriteBlock(block);
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+template <class T, class IT>
+vtkIdType vtkImageConnectedComponentsExecute(
+  vtkImageConnectedComponents *self, const T *inPtr, vtkIdType inInc[3],
+  IT *parent, int *outPtr, const int outExt[6],
+  vtkIdTypeArray *regionSizes, vtkIntArray *regionExtents)
+{
+  typedef vtkImageConnectedComponentsLabeler<T, IT> Labeler;
+  Labeler labeler;
+  labeler.InPtr = inPtr;
+  labeler.Background = self->GetBackgroundValue();
+  labeler.Parent = parent;
+  labeler.OutPtr = outPtr;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    labeler.InIncrements[axis] = inInc[axis];
+    labeler.Size[axis] = outExt[2*axis + 1] - outExt[2*axis] + 1;
+    }
+  vtkIdType rowSize = labeler.Size[0];
+  vtkIdType sliceSize = rowSize*labeler.Size[1];
+
+  // the neighbors which come before a voxel in memory order
+  int connectivity = self->GetConnectivity();
+  labeler.NumberOfNeighbors = 0;
+  for (int dz = -1; dz <= 0; ++dz)
+    {
+    for (int dy = -1; dy <= 1; ++dy)
+      {
+      for (int dx = -1; dx <= 1; ++dx)
+        {
+        int order = (dx != 0) + (dy != 0) + (dz != 0);
+        if ((dz == 0 && (dy > 0 || (dy == 0 && dx >= 0))) ||
+            (order == 2 && connectivity < 18) ||
+            (order == 3 && connectivity < 26))
+          {
+          continue;
+          }
+        int k = labeler.NumberOfNeighbors++;
+        labeler.Neighbors[k][0] = dx;
+        labeler.Neighbors[k][1] = dy;
+        labeler.Neighbors[k][2] = dz;
+        labeler.Offsets[k] = dx + dy*rowSize + dz*sliceSize;
+        labeler.InOffsets[k] = dx*inInc[0] + dy*inInc[1] + dz*inInc[2];
+        }
+      }
+    }
+
+  labeler.MaximumOffset = 0;
+  for (int k = 0; k < labeler.NumberOfNeighbors; ++k)
+    {
+    labeler.MaximumOffset = std::max(labeler.MaximumOffset,
+                                     -labeler.Offsets[k]);
+    }
+
+  // blocks of slices, or of rows for a single slice
+  int units = labeler.Size[2];
+  vtkIdType unitSize = sliceSize;
+  if (units == 1)
+    {
+    units = labeler.Size[1];
+    unitSize = rowSize;
+    }
+  labeler.BoundarySize = unitSize;
+  int numberOfBlocks = std::min(
+    units, 4*vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+  numberOfBlocks = std::max(numberOfBlocks, 1);
+  labeler.BlockStarts.resize(numberOfBlocks + 1);
+  for (int block = 0; block <= numberOfBlocks; ++block)
+    {
+    labeler.BlockStarts[block] = unitSize*
+      (static_cast<vtkIdType>(units)*block/numberOfBlocks);
+    }
+  labeler.Roots.resize(numberOfBlocks);
+  labeler.RootSizes.resize(numberOfBlocks);
+  labeler.RootExtents.resize(numberOfBlocks);
+
+  labeler.Pass = Labeler::LABEL;
+  vtkSMPTools::For(0, numberOfBlocks, 1, labeler);
+  self->UpdateProgress(0.4);
+
+  // merge pairs of blocks, then pairs of pairs, and so on
+  labeler.Pass = Labeler::MERGE;
+  for (labeler.Step = 1; labeler.Step < numberOfBlocks; labeler.Step *= 2)
+    {
+    int numberOfBoundaries = ((numberOfBlocks - 1)/labeler.Step + 1)/2;
+    vtkSMPTools::For(0, numberOfBoundaries, 1, labeler);
+    }
+  self->UpdateProgress(0.5);
+
+  // label the regions in the order of their roots
+  IT count = 0;
+  for (int block = 0; block < numberOfBlocks; ++block)
+    {
+    const std::vector<IT>& roots = labeler.Roots[block];
+    for (size_t k = 0; k < roots.size(); ++k)
+      {
+      IT r = roots[k];
+      IT p = parent[r] - 1;
+      parent[r] = (p == r ? -(++count) : parent[p]);
+      }
+    }
+
+  labeler.Pass = Labeler::WRITE;
+  vtkSMPTools::For(0, numberOfBlocks, 1, labeler);
+  self->UpdateProgress(0.9);
+
+  regionSizes->SetNumberOfTuples(count);
+  regionExtents->SetNumberOfTuples(count);
+  vtkIdType *sizes = regionSizes->GetPointer(0);
+  int *extents = regionExtents->GetPointer(0);
+  for (IT label = 0; label < count; ++label)
+    {
+    sizes[label] = 0;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      extents[6*label + 2*axis] = VTK_INT_MAX;
+      extents[6*label + 2*axis + 1] = VTK_INT_MIN;
+      }
+    }
+  for (int block = 0; block < numberOfBlocks; ++block)
+    {
+    const std::vector<IT>& roots = labeler.Roots[block];
+    for (size_t k = 0; k < roots.size(); ++k)
+      {
+      IT label = parent[roots[k]] - 1;
+      sizes[label] += labeler.RootSizes[block][k];
+      const int *rootExtent = &labeler.RootExtents[block][6*k];
+      int *extent = extents + 6*label;
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        extent[2*axis] = std::min(extent[2*axis],
+                                  rootExtent[2*axis] + outExt[2*axis]);
+        extent[2*axis + 1] = std::max(extent[2*axis + 1],
+                                      rootExtent[2*axis + 1] + outExt[2*axis]);
+        }
+      }
+    }
+
+  return count;
+}
+
+//----------------------------------------------------------------------------
+// The union-find runs in the output, or in a separate array of vtkIdType
+// when the voxels can not be numbered with int.
+template <class T>
+vtkIdType vtkImageConnectedComponentsDispatch(
+  vtkImageConnectedComponents *self, const T *inPtr, vtkIdType inInc[3],
+  int *outPtr, const int outExt[6],
+  vtkIdTypeArray *regionSizes, vtkIntArray *regionExtents)
+{
+  vtkIdType numberOfVoxels = 1;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    numberOfVoxels *= outExt[2*axis + 1] - outExt[2*axis] + 1;
+    }
+  if (numberOfVoxels < VTK_INT_MAX)
+    {
+    return vtkImageConnectedComponentsExecute(
+      self, inPtr, inInc, outPtr, outPtr, outExt, regionSizes,
+      regionExtents);
+    }
+  std::vector<vtkIdType> parent(numberOfVoxels);
+  return vtkImageConnectedComponentsExecute(
+    self, inPtr, inInc, &parent[0], outPtr, outExt, regionSizes,
+    regionExtents);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageConnectedComponents::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+
+  vtkImageData* outData = static_cast<vtkImageData *>(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkImageData* inData = static_cast<vtkImageData *>(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  this->NumberOfRegions = 0;
+  this->RegionSizes->SetNumberOfTuples(0);
+  this->RegionExtents->SetNumberOfTuples(0);
+
+  int outExt[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), outExt);
+  this->AllocateOutputData(outData, outInfo, outExt);
+
+  if (outExt[0] > outExt[1] || outExt[2] > outExt[3] || outExt[4] > outExt[5])
+    {
+    return 1;
+    }
+
+  void *inPtr = inData->GetScalarPointerForExtent(outExt);
+  int *outPtr = static_cast<int *>(outData->GetScalarPointerForExtent(outExt));
+  if (!inPtr)
+    {
+    vtkErrorMacro("Execute: No scalars for update extent.");
+    return 0;
+    }
+
+  int numberOfComponents = inData->GetNumberOfScalarComponents();
+  if (this->ActiveComponent < 0 ||
+      this->ActiveComponent >= numberOfComponents)
+    {
+    vtkErrorMacro("Execute: ActiveComponent " << this->ActiveComponent
+                  << " is not a component of the input.");
+    return 0;
+    }
+
+  vtkIdType inInc[3];
+  inData->GetIncrements(inInc);
+
+  switch (inData->GetScalarType())
+    {
+    vtkTemplateMacro(
+      this->NumberOfRegions = vtkImageConnectedComponentsDispatch(
+        this, static_cast<VTK_TT *>(inPtr) + this->ActiveComponent, inInc,
+        outPtr, outExt, this->RegionSizes, this->RegionExtents));
+
+    default:
+      vtkErrorMacro(<< "Execute: Unknown input ScalarType");
+      return 0;
+    }
+
+  this->UpdateProgress(1.0);
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageConnectedComponents::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Connectivity: " << this->Connectivity << "\n";
+  os << indent << "BackgroundValue: " << this->BackgroundValue << "\n";
+  os << indent << "ActiveComponent: " << this->ActiveComponent << "\n";
+  os << indent << "NumberOfRegions: " << this->NumberOfRegions << "\n";
+}
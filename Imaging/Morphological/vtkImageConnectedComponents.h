@@ -0,0 +1,108 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImageConnectedComponents.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImageConnectedComponents - Label all the connected regions.
+// .SECTION Description
+// vtkImageConnectedComponents labels every connected region of a binary or
+// label image. A region is a maximal set of voxels which have the same
+// value, other than the background value, and which are connected through
+// their faces (6-connectivity), also their edges (18-connectivity) or also
+// their corners (26-connectivity). The output is an int image in which the
+// background is 0 and the regions are numbered from 1, in the order of
+// their first voxel in memory. The regions are found within the update
+// extent. After the filter has executed, the number of voxels and the
+// extent of every region are available.
+//
+// The image is split into blocks of slices (or of rows for a single slice)
+// which are labeled in parallel with a union-find of their voxels. The
+// regions of neighboring blocks are then merged pairwise across the block
+// boundaries, in log2(blocks) parallel steps, and the labels are finally
+// written in parallel.
+// .SECTION See Also
+// vtkImageSeedConnectivity vtkImageThresholdConnectivity vtkImageConnector
+
+#ifndef __vtkImageConnectedComponents_h
+#define __vtkImageConnectedComponents_h
+
+#include "vtkImagingMorphologicalModule.h" // For export macro
+#include "vtkImageAlgorithm.h"
+
+class vtkIdTypeArray;
+class vtkIntArray;
+
+class VTKIMAGINGMORPHOLOGICAL_EXPORT vtkImageConnectedComponents :
+  public vtkImageAlgorithm
+{
+public:
+  static vtkImageConnectedComponents *New();
+  vtkTypeMacro(vtkImageConnectedComponents, vtkImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // The connectivity of the voxels: 6 (faces, the default), 18 (faces and
+  // edges) or 26 (faces, edges and corners).
+  vtkSetMacro(Connectivity, int);
+  vtkGetMacro(Connectivity, int);
+  void SetConnectivityTo6() { this->SetConnectivity(6); }
+  void SetConnectivityTo18() { this->SetConnectivity(18); }
+  void SetConnectivityTo26() { this->SetConnectivity(26); }
+
+  // Description:
+  // The voxels of this value are not part of any region. The default
+  // is 0.
+  vtkSetMacro(BackgroundValue, double);
+  vtkGetMacro(BackgroundValue, double);
+
+  // Description:
+  // For multi-component images, the component which is labeled. The
+  // default is 0.
+  vtkSetMacro(ActiveComponent, int);
+  vtkGetMacro(ActiveComponent, int);
+
+  // Description:
+  // After the filter has executed, the number of regions.
+  vtkGetMacro(NumberOfRegions, vtkIdType);
+
+  // Description:
+  // After the filter has executed, the number of voxels of every region:
+  // tuple i is for the region labeled i + 1.
+  vtkIdTypeArray *GetRegionSizes() { return this->RegionSizes; }
+
+  // Description:
+  // After the filter has executed, the extent (xmin, xmax, ymin, ymax,
+  // zmin, zmax) of every region: tuple i is for the region labeled i + 1.
+  vtkIntArray *GetRegionExtents() { return this->RegionExtents; }
+
+protected:
+  vtkImageConnectedComponents();
+  ~vtkImageConnectedComponents();
+
+  int Connectivity;
+  double BackgroundValue;
+  int ActiveComponent;
+  vtkIdType NumberOfRegions;
+  vtkIdTypeArray *RegionSizes;
+  vtkIntArray *RegionExtents;
+
+  virtual int RequestInformation(vtkInformation *, vtkInformationVector **,
+                                 vtkInformationVector *);
+  virtual int RequestData(vtkInformation *, vtkInformationVector **,
+                          vtkInformationVector *);
+
+private:
+  vtkImageConnectedComponents(const vtkImageConnectedComponents&);  // Not implemented.
+  void operator=(const vtkImageConnectedComponents&);  // Not implemented.
+};
+
+#endif
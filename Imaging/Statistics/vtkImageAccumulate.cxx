@@ -14,16 +14,22 @@
 =========================================================================*/
 #include "vtkImageAccumulate.h"
 
+#include "vtkAtomicInt.h"
 #include "vtkImageData.h"
 #include "vtkImageStencilData.h"
 #include "vtkImageStencilIterator.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+#include <algorithm>
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageAccumulate);
 
@@ -123,8 +129,173 @@ vtkImageStencilData *vtkImageAccumulate::GetStencil()
 }
 
 
+//----------------------------------------------------------------------------
+// The counts and the statistics gathered by one thread.  The first thread
+// counts directly into the output, the others into their own storage.
+struct vtkImageAccumulateThreadData
+{
+  vtkImageAccumulateThreadData() : Bins(0) {}
+
+  int *Bins;
+  std::vector<int> Storage;
+  double Sum[3];
+  double SumSqr[3];
+  double Min[3];
+  double Max[3];
+  vtkIdType VoxelCount;
+};
+
+//----------------------------------------------------------------------------
+// Accumulates slabs of the input, from begin to end along the slowest
+// varying axis of the update extent, into the histogram and statistics
+// of the thread.  The counts saturate at VTK_INT_MAX, like the output.
+// The functor is used for several vtkSMPTools::For calls, and the threads
+// are combined once they are all done.
+template <class T>
+class vtkImageAccumulateFunctor
+{
+public:
+  vtkImageData *InData;
+  vtkImageStencilData *Stencil;
+  int Extent[6];
+  int SplitAxis;
+  bool ReverseStencil;
+  bool IgnoreZero;
+  int NumberOfComponents;
+  int OutExtent[6];
+  vtkIdType OutIncs[3];
+  double Origin[3];
+  double Spacing[3];
+  vtkIdType NumberOfBins;
+  int *Output;
+  vtkAtomicInt<vtkTypeInt32> OutputUsers;
+
+  vtkSMPThreadLocal<vtkImageAccumulateThreadData> Data;
+
+  void Initialize()
+  {
+    vtkImageAccumulateThreadData& data = this->Data.Local();
+    if (data.Bins)
+      {
+      return;
+      }
+    if (++this->OutputUsers == 1)
+      {
+      data.Bins = this->Output;
+      }
+    else
+      {
+      data.Storage.assign(this->NumberOfBins, 0);
+      data.Bins = &data.Storage[0];
+      }
+    for (int idxC = 0; idxC < 3; ++idxC)
+      {
+      data.Sum[idxC] = 0.0;
+      data.SumSqr[idxC] = 0.0;
+      data.Min[idxC] = VTK_DOUBLE_MAX;
+      data.Max[idxC] = VTK_DOUBLE_MIN;
+      }
+    data.VoxelCount = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkImageAccumulateThreadData& data = this->Data.Local();
+    int *outPtr = data.Bins;
+    double *sum = data.Sum;
+    double *sumSqr = data.SumSqr;
+    double *min = data.Min;
+    double *max = data.Max;
+    vtkIdType voxelCount = data.VoxelCount;
+
+    int numC = this->NumberOfComponents;
+    bool ignoreZero = this->IgnoreZero;
+    const int *outExtent = this->OutExtent;
+    const vtkIdType *outIncs = this->OutIncs;
+    const double *origin = this->Origin;
+    const double *spacing = this->Spacing;
+
+    int extent[6];
+    for (int idx = 0; idx < 6; ++idx)
+      {
+      extent[idx] = this->Extent[idx];
+      }
+    extent[2*this->SplitAxis] = static_cast<int>(begin);
+    extent[2*this->SplitAxis + 1] = static_cast<int>(end - 1);
+
+    vtkImageStencilIterator<T> inIter(this->InData, this->Stencil, extent);
+
+    while (!inIter.IsAtEnd())
+      {
+      if (inIter.IsInStencil() ^ this->ReverseStencil)
+        {
+        T *inPtr = inIter.BeginSpan();
+        T *spanEndPtr = inIter.EndSpan();
+
+        while (inPtr != spanEndPtr)
+          {
+          // find the bin for this pixel.
+          bool outOfBounds = false;
+          int *outPtrC = outPtr;
+          for (int idxC = 0; idxC < numC; ++idxC)
+            {
+            double v = static_cast<double>(*inPtr++);
+            if (!ignoreZero || v != 0)
+              {
+              // gather statistics
+              sum[idxC] += v;
+              sumSqr[idxC] += v*v;
+              if (v > max[idxC])
+                {
+                max[idxC] = v;
+                }
+              if (v < min[idxC])
+                {
+                min[idxC] = v;
+                }
+              voxelCount++;
+              }
+
+            // compute the index
+            int outIdx = vtkMath::Floor((v - origin[idxC]) / spacing[idxC]);
+
+            // verify that it is in range
+            if (outIdx >= outExtent[idxC*2] && outIdx <= outExtent[idxC*2+1])
+              {
+              outPtrC += (outIdx - outExtent[idxC*2]) * outIncs[idxC];
+              }
+            else
+              {
+              outOfBounds = true;
+              }
+            }
+
+          // increment the bin
+          if (!outOfBounds)
+            {
+            *outPtrC += (*outPtrC != VTK_INT_MAX);
+            }
+          }
+        }
+
+      inIter.NextSpan();
+      }
+
+    data.VoxelCount = voxelCount;
+  }
+
+  void Reduce()
+  {
+  }
+};
+
 //----------------------------------------------------------------------------
 // This templated function executes the filter for any type of data.
+// The input is split into slabs that are accumulated in parallel, each
+// thread into its own histogram, and the histograms and statistics of
+// the threads are added together at the end.  The slabs are processed in
+// groups, so that the progress can be reported and the execution aborted
+// from the calling thread between the groups.
 template <class T>
 void vtkImageAccumulateExecute(vtkImageAccumulate *self,
                                vtkImageData *inData, T *,
@@ -145,89 +316,92 @@ void vtkImageAccumulateExecute(vtkImageAccumulate *self,
   standardDeviation[0] = standardDeviation[1] = standardDeviation[2] = 0.0;
   *voxelCount = 0;
 
+  vtkImageAccumulateFunctor<T> functor;
+  functor.InData = inData;
+  functor.Stencil = self->GetStencil();
+  functor.ReverseStencil = (self->GetReverseStencil() != 0);
+  functor.IgnoreZero = (self->GetIgnoreZero() != 0);
+
   // input's number of components is used as output dimensionality
-  int numC = inData->GetNumberOfScalarComponents();
+  functor.NumberOfComponents = inData->GetNumberOfScalarComponents();
 
   // get information for output data
-  int outExtent[6];
-  outData->GetExtent(outExtent);
-  vtkIdType outIncs[3];
-  outData->GetIncrements(outIncs);
-  double origin[3];
-  outData->GetOrigin(origin);
-  double spacing[3];
-  outData->GetSpacing(spacing);
-
-  // zero count in every bin
+  outData->GetExtent(functor.OutExtent);
+  outData->GetIncrements(functor.OutIncs);
+  outData->GetOrigin(functor.Origin);
+  outData->GetSpacing(functor.Spacing);
+
   vtkIdType size = 1;
-  size *= (outExtent[1] - outExtent[0] + 1);
-  size *= (outExtent[3] - outExtent[2] + 1);
-  size *= (outExtent[5] - outExtent[4] + 1);
-  for (vtkIdType j = 0; j < size; j++)
+  size *= (functor.OutExtent[1] - functor.OutExtent[0] + 1);
+  size *= (functor.OutExtent[3] - functor.OutExtent[2] + 1);
+  size *= (functor.OutExtent[5] - functor.OutExtent[4] + 1);
+  functor.NumberOfBins = size;
+  functor.Output = outPtr;
+  functor.OutputUsers = 0;
+  std::fill(outPtr, outPtr + size, 0);
+
+  // split along the slowest varying axis that has more than one slice
+  for (int idx = 0; idx < 6; ++idx)
     {
-    outPtr[j] = 0;
+    functor.Extent[idx] = updateExtent[idx];
     }
+  int axis = 2;
+  while (axis > 0 && updateExtent[2*axis] == updateExtent[2*axis + 1])
+    {
+    --axis;
+    }
+  functor.SplitAxis = axis;
 
-  vtkImageStencilData *stencil = self->GetStencil();
-  bool reverseStencil = (self->GetReverseStencil() != 0);
-  bool ignoreZero = (self->GetIgnoreZero() != 0);
-
-  vtkImageStencilIterator<T> inIter(inData, stencil, updateExtent, self);
-
-  while (!inIter.IsAtEnd())
+  if (updateExtent[1] >= updateExtent[0] &&
+      updateExtent[3] >= updateExtent[2] &&
+      updateExtent[5] >= updateExtent[4])
     {
-    if (inIter.IsInStencil() ^ reverseStencil)
+    vtkIdType first = updateExtent[2*axis];
+    vtkIdType last = updateExtent[2*axis + 1] + 1;
+    vtkIdType groupSize = (last - first)/20 + 1;
+    vtkIdType minGroupSize =
+      4*vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+    groupSize = (groupSize > minGroupSize ? groupSize : minGroupSize);
+    for (vtkIdType begin = first; begin < last; begin += groupSize)
       {
-      T *inPtr = inIter.BeginSpan();
-      T *spanEndPtr = inIter.EndSpan();
-
-      while (inPtr != spanEndPtr)
+      if (self->GetAbortExecute())
         {
-        // find the bin for this pixel.
-        bool outOfBounds = false;
-        int *outPtrC = outPtr;
-        for (int idxC = 0; idxC < numC; ++idxC)
-          {
-          double v = static_cast<double>(*inPtr++);
-          if (!ignoreZero || v != 0)
-            {
-            // gather statistics
-            sum[idxC] += v;
-            sumSqr[idxC] += v*v;
-            if (v > max[idxC])
-              {
-              max[idxC] = v;
-              }
-            if (v < min[idxC])
-              {
-              min[idxC] = v;
-              }
-            (*voxelCount)++;
-            }
-
-          // compute the index
-          int outIdx = vtkMath::Floor((v - origin[idxC]) / spacing[idxC]);
-
-          // verify that it is in range
-          if (outIdx >= outExtent[idxC*2] && outIdx <= outExtent[idxC*2+1])
-            {
-            outPtrC += (outIdx - outExtent[idxC*2]) * outIncs[idxC];
-            }
-          else
-            {
-            outOfBounds = true;
-            }
-          }
-
-        // increment the bin
-        if (!outOfBounds)
-          {
-          ++(*outPtrC);
-          }
+        break;
         }
+      vtkIdType end = begin + groupSize;
+      end = (end < last ? end : last);
+      vtkSMPTools::For(begin, end, functor);
+      self->UpdateProgress(static_cast<double>(end - first)/(last - first));
       }
+    }
 
-    inIter.NextSpan();
+  // add the counts of the other threads to the output, in a wide type so
+  // that they cannot overflow before they are clamped
+  typename vtkSMPThreadLocal<vtkImageAccumulateThreadData>::iterator iter;
+  for (iter = functor.Data.begin(); iter != functor.Data.end(); ++iter)
+    {
+    vtkImageAccumulateThreadData& data = *iter;
+    if (data.Bins == 0)
+      {
+      continue;
+      }
+    if (data.Bins != outPtr)
+      {
+      for (vtkIdType j = 0; j < size; j++)
+        {
+        vtkIdType count = static_cast<vtkIdType>(outPtr[j]) + data.Bins[j];
+        outPtr[j] = static_cast<int>(
+          count < VTK_INT_MAX ? count : VTK_INT_MAX);
+        }
+      }
+    for (int idxC = 0; idxC < 3; ++idxC)
+      {
+      sum[idxC] += data.Sum[idxC];
+      sumSqr[idxC] += data.SumSqr[idxC];
+      min[idxC] = (data.Min[idxC] < min[idxC] ? data.Min[idxC] : min[idxC]);
+      max[idxC] = (data.Max[idxC] > max[idxC] ? data.Max[idxC] : max[idxC]);
+      }
+    *voxelCount += data.VoxelCount;
     }
 
   // initialize the statistics
@@ -25,6 +25,14 @@
 // The SetStencil and ReverseStencil functions allow the statistics to be
 // computed on an arbitrary portion of the input data.
 // See the documentation for vtkImageStencilData for more information.
+// With two or three components, the output is the joint histogram of the
+// components: the voxel (i,j,k) of the output counts the pixels whose
+// components fall into the bins i, j and k, e.g. for two images combined
+// with vtkImageAppendComponents.
+// The input is accumulated in parallel with vtkSMPTools.  The first thread
+// counts directly into the output, and each other thread into a histogram
+// of its own that is added to the output at the end.  The counts saturate
+// at VTK_INT_MAX.
 //
 // This filter also supports ignoring pixels with value equal to 0. Using this
 // option with vtkImageMask may result in results being slightly off since 0
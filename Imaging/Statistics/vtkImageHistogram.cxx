@@ -27,6 +27,8 @@
 #include "vtkTemplateAliasMacro.h"
 
 #include <math.h>
+#include <algorithm>
+#include <vector>
 
 // turn off 64-bit ints when templating over all types
 # undef VTK_USE_INT64
@@ -54,6 +56,7 @@ vtkImageHistogram::vtkImageHistogram()
 
   this->Histogram = vtkIdTypeArray::New();
   this->Total = 0;
+  this->CumulativeHistogram = vtkIdTypeArray::New();
 
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(1);
@@ -66,6 +69,10 @@ vtkImageHistogram::~vtkImageHistogram()
     {
     this->Histogram->Delete();
     }
+  if (this->CumulativeHistogram)
+    {
+    this->CumulativeHistogram->Delete();
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -747,6 +754,7 @@ int vtkImageHistogram::RequestData(
 
   // set the total
   this->Total = total;
+  this->Histogram->Modified();
 
   // delete the temporary memory
   for (int j = 0; j < n; j++)
@@ -917,3 +925,108 @@ void vtkImageHistogram::ComputeImageScalarRange(
       vtkErrorMacro(<< "Execute: Unknown ScalarType");
     }
 }
+
+//----------------------------------------------------------------------------
+double vtkImageHistogram::GetPercentile(double percentile)
+{
+  vtkIdType n = this->Histogram->GetNumberOfTuples();
+  if (n == 0 || this->Total <= 0)
+    {
+    return this->BinOrigin;
+    }
+
+  // rebuild the cumulative histogram if the histogram has changed
+  if (this->CumulativeHistogram->GetNumberOfTuples() != n ||
+      this->Histogram->GetMTime() > this->CumulativeHistogramTime)
+    {
+    this->CumulativeHistogram->SetNumberOfComponents(1);
+    this->CumulativeHistogram->SetNumberOfTuples(n);
+    vtkIdType *histogram = this->Histogram->GetPointer(0);
+    vtkIdType *cumulative = this->CumulativeHistogram->GetPointer(0);
+    vtkIdType sum = 0;
+    for (vtkIdType ix = 0; ix < n; ++ix)
+      {
+      sum += histogram[ix];
+      cumulative[ix] = sum;
+      }
+    this->CumulativeHistogramTime.Modified();
+    }
+
+  // find the first bin whose cumulative count exceeds the rank
+  percentile = (percentile > 0.0 ? percentile : 0.0);
+  percentile = (percentile < 100.0 ? percentile : 100.0);
+  vtkIdType rank = static_cast<vtkIdType>(percentile*0.01*(this->Total - 1));
+  vtkIdType *cumulative = this->CumulativeHistogram->GetPointer(0);
+  vtkIdType bin = std::upper_bound(cumulative, cumulative + n, rank) -
+    cumulative;
+  bin = (bin < n ? bin : n - 1);
+
+  return bin*this->BinSpacing + this->BinOrigin;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageHistogram::AddExtentToHistogram(const int extent[6])
+{
+  this->AccumulateExtent(extent, 1);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageHistogram::RemoveExtentFromHistogram(const int extent[6])
+{
+  this->AccumulateExtent(extent, -1);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageHistogram::AccumulateExtent(const int extent[6], int sign)
+{
+  vtkImageData *inData =
+    vtkImageData::SafeDownCast(this->GetInputDataObject(0, 0));
+  int nx = this->NumberOfBins;
+  if (!inData || nx <= 0 || this->Histogram->GetNumberOfTuples() != nx)
+    {
+    vtkErrorMacro("The histogram must be computed with Update() before "
+                  "it can be modified.");
+    return;
+    }
+
+  // only the part of the extent that is within the input
+  int ext[6];
+  int *inExt = inData->GetExtent();
+  for (int i = 0; i < 3; ++i)
+    {
+    ext[2*i] = (extent[2*i] > inExt[2*i] ? extent[2*i] : inExt[2*i]);
+    ext[2*i+1] = (extent[2*i+1] < inExt[2*i+1] ?
+                  extent[2*i+1] : inExt[2*i+1]);
+    if (ext[2*i] > ext[2*i+1])
+      {
+      return;
+      }
+    }
+
+  // count the voxels with the current bins, clamping to the end bins
+  std::vector<vtkIdType> counts(nx, 0);
+  int binRange[2] = { 0, nx - 1 };
+  vtkImageStencilData *stencil = this->GetStencil();
+  void *inPtr = inData->GetScalarPointerForExtent(ext);
+  switch (inData->GetScalarType())
+    {
+    vtkTemplateAliasMacro(
+      vtkImageHistogramExecute(
+        this, inData, stencil, static_cast<VTK_TT *>(inPtr),
+        ext, &counts[0], binRange, this->BinOrigin, this->BinSpacing,
+        this->ActiveComponent, -1));
+    default:
+      vtkErrorMacro(<< "Execute: Unknown ScalarType");
+      return;
+    }
+
+  vtkIdType *histogram = this->Histogram->GetPointer(0);
+  vtkIdType total = 0;
+  for (int ix = 0; ix < nx; ++ix)
+    {
+    histogram[ix] += sign*counts[ix];
+    total += counts[ix];
+    }
+  this->Total += sign*total;
+  this->Histogram->Modified();
+}
@@ -146,6 +146,25 @@ public:
   // voxels times the number of components.
   vtkIdType GetTotal() { return this->Total; }
 
+  // Description:
+  // Get the value below which the given percentage of the histogram lies,
+  // that is, the center of the bin that holds the sample of rank
+  // percentile/100*(Total - 1), rounded down.  The cumulative histogram is
+  // computed once and then searched, so many percentiles can be queried
+  // quickly.  You must call Update() before calling this method.
+  double GetPercentile(double percentile);
+
+  // Description:
+  // Update the histogram for a modified part of the input without
+  // executing the filter again: call RemoveExtentFromHistogram() with the
+  // extent that is about to be modified, modify the voxels, then call
+  // AddExtentToHistogram() with the same extent.  The bins are kept as they
+  // are, so values beyond them are counted in the end bins, and the
+  // histogram image is not regenerated.  You must call Update() before
+  // calling these methods.
+  void AddExtentToHistogram(const int extent[6]);
+  void RemoveExtentFromHistogram(const int extent[6]);
+
   // Description:
   // This is part of the executive, but is public so that it can be accessed
   // by non-member functions.
@@ -177,6 +196,11 @@ protected:
   // this filter requires the range for all components.
   void ComputeImageScalarRange(vtkImageData *data, double range[2]);
 
+  // Description:
+  // Add (sign = 1) or subtract (sign = -1) the counts of the voxels of an
+  // extent of the input to the histogram.
+  void AccumulateExtent(const int extent[6], int sign);
+
   int ActiveComponent;
   int AutomaticBinning;
   int MaximumNumberOfBins;
@@ -192,6 +216,9 @@ protected:
   vtkIdTypeArray *Histogram;
   vtkIdType Total;
 
+  vtkIdTypeArray *CumulativeHistogram;
+  vtkTimeStamp CumulativeHistogramTime;
+
   vtkIdType *ThreadOutput[VTK_MAX_THREADS];
   int ThreadBinRange[VTK_MAX_THREADS][2];
 
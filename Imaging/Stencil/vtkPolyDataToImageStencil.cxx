@@ -63,6 +63,7 @@ POSSIBILITY OF SUCH DAMAGES.
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkSMPTools.h"
 
 #include <math.h>
 
@@ -214,7 +215,9 @@ void vtkPolyDataToImageStencil::PolyDataCutter(
       for (vtkIdType i = 0; i < numCellPts; i++)
         {
         // scalar value is distance from the specified z plane
-        cellScalars->SetValue(i, input->GetPoint(cellIds->GetId(i))[2]);
+        double point[3];
+        input->GetPoint(cellIds->GetId(i), point);
+        cellScalars->SetValue(i, point[2]);
         }
 
       cell->Contour(z, cellScalars, locator,
@@ -510,6 +513,31 @@ void vtkPolyDataToImageStencil::ThreadedExecute(
   locator->Delete();
 }
 
+//----------------------------------------------------------------------------
+// Functor for the slices: every range of slices is rasterized by its own
+// call to ThreadedExecute, and the slices fill disjoint rows of the stencil.
+class vtkPolyDataToImageStencilFunctor
+{
+public:
+  vtkPolyDataToImageStencil *Self;
+  vtkImageStencilData *Data;
+  int Extent[6];
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int extent[6];
+    for (int i = 0; i < 6; i++)
+      {
+      extent[i] = this->Extent[i];
+      }
+    extent[4] = static_cast<int>(begin);
+    extent[5] = static_cast<int>(end - 1);
+    // only the range that starts at the first slice reports progress
+    this->Self->ThreadedExecute(this->Data, extent,
+                                (extent[4] == this->Extent[4] ? 0 : 1));
+  }
+};
+
 //----------------------------------------------------------------------------
 int vtkPolyDataToImageStencil::RequestData(
   vtkInformation *request,
@@ -523,11 +551,25 @@ int vtkPolyDataToImageStencil::RequestData(
   vtkImageStencilData *data = vtkImageStencilData::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  int extent[6];
-  data->GetExtent(extent);
-  // ThreadedExecute is only called from a single thread for
-  // now, but it could as easily be called from ThreadedRequestData
-  this->ThreadedExecute(data, extent, 0);
+  vtkPolyDataToImageStencilFunctor functor;
+  functor.Self = this;
+  functor.Data = data;
+  data->GetExtent(functor.Extent);
+  if (functor.Extent[4] > functor.Extent[5])
+    {
+    return 1;
+    }
+
+  // build the cells and the bounds of the input before the slices are
+  // rasterized in parallel, since both are built on demand
+  vtkPolyData *input = this->GetInput();
+  if (input && input->GetNumberOfCells() > 0)
+    {
+    input->GetCellType(0);
+    input->GetBounds();
+    }
+
+  vtkSMPTools::For(functor.Extent[4], functor.Extent[5] + 1, functor);
 
   return 1;
 }
@@ -50,6 +50,7 @@ POSSIBILITY OF SUCH DAMAGES.
 // The vtkPolyDataToImageStencil class will convert polydata into
 // an image stencil.  The polydata can either be a closed surface
 // mesh or a series of polyline contours (one contour per slice).
+// The Z slices are cut and rasterized in parallel with vtkSMPTools.
 // .SECTION Caveats
 // If contours are provided, the contours must be aligned with the
 // Z planes.  Other contour orientations are not supported.
@@ -112,6 +113,8 @@ protected:
 private:
   vtkPolyDataToImageStencil(const vtkPolyDataToImageStencil&);  // Not implemented.
   void operator=(const vtkPolyDataToImageStencil&);  // Not implemented.
+
+  friend class vtkPolyDataToImageStencilFunctor;
 };
 
 #endif